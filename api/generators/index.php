@@ -76,6 +76,142 @@ function wrap_code_line($line, $width, $language) {
     return join("\n", $lines);
 }
 
+function write_generated_file($filename, $content) {
+    global $checkOnly, $checkFiles, $checkFailures;
+    if (!$checkOnly) {
+        echo "--> Writing '".$filename."'\n";
+        file_put_contents($filename, $content);
+        return;
+    }
+    if (count($checkFiles) && !in_array(basename($filename), $checkFiles)) return;
+
+    // generation dates are not part of the comparison
+    $datePatterns = array('/\d{4}-\d{2}-\d{2}/', '/Copyright \(c\) \d{4}/');
+    $dateReplacements = array('YYYY-MM-DD', 'Copyright (c) YYYY');
+    $existing = file_exists($filename) ? preg_replace($datePatterns, $dateReplacements, file_get_contents($filename)) : false;
+    if ($existing === preg_replace($datePatterns, $dateReplacements, $content)) {
+        echo "--> '".$filename."' matches generated output\n";
+    } else {
+        echo "--> '".$filename."' DIFFERS from generated output\n";
+        $checkFailures++;
+    }
+}
+
+function cpp_packet_view($kind, $className, $item, $fields) {
+    $name = $className.'_'.$item["name"];
+    $accessors = array();
+    $offset = 0;
+    $lengthIndex = -1;
+    foreach ($fields as $field) {
+        switch ($field["type"]) {
+            case "uint8_t":
+                $accessors[] = 'uint8_t '.$field["name"].'() const { return payload_['.$offset.']; }';
+                $offset += 1;
+                break;
+            case "int8_t":
+                $accessors[] = 'int8_t '.$field["name"].'() const { return (int8_t)payload_['.$offset.']; }';
+                $offset += 1;
+                break;
+            case "uint16_t":
+                $accessors[] = 'uint16_t '.$field["name"].'() const { return read_u16(payload_ + '.$offset.'); }';
+                $offset += 2;
+                break;
+            case "uint32_t":
+                $accessors[] = 'uint32_t '.$field["name"].'() const { return read_u32(payload_ + '.$offset.'); }';
+                $offset += 4;
+                break;
+            case "macaddr_t":
+                $accessors[] = 'const uint8_t *'.$field["name"].'() const { return payload_ + '.$offset.'; }';
+                $offset += 6;
+                break;
+            case "btcod_t":
+                $accessors[] = 'const uint8_t *'.$field["name"].'() const { return payload_ + '.$offset.'; }';
+                $offset += 3;
+                break;
+            case "uint8_t[]":
+                $accessors[] = 'bytes '.$field["name"].'() const { bytes b = { payload_ + '.($offset + 1).', payload_['.$offset.'] }; return b; }';
+                $lengthIndex = $offset;
+                $offset += 1;
+                break;
+        }
+    }
+    $lines = array();
+    $lines[] = '/// '.($kind == 'evt' ? $item["doxbrief"] : 'Response to cmd::'.$name.'()');
+    $lines[] = 'struct '.$name.' {';
+    $lines[] = '    enum { packet_type = '.($kind == 'evt' ? 'PACKET_TYPE_EVENT' : 'PACKET_TYPE_COMMAND').', class_id = CLASS_'.strtoupper($className).', id = '.sprintf("0x%02X", $item["id"]).', min_length = '.$offset.' };';
+    $lines[] = '    explicit '.$name.'(const uint8_t *payload) : payload_(payload) {}';
+    if ($lengthIndex >= 0) {
+        $lines[] = '    static bool valid(const uint8_t *payload, size_t length) { return length >= min_length && length >= (size_t)min_length + payload['.$lengthIndex.']; }';
+    } else {
+        $lines[] = '    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }';
+    }
+    foreach ($accessors as $accessor) $lines[] = '    '.$accessor;
+    $lines[] = '    const uint8_t *payload_;';
+    $lines[] = '};';
+    $lines[] = '';
+    return $lines;
+}
+
+function cpp_command_builder($className, $command) {
+    $name = $className.'_'.$command["name"];
+    $args = array('uint8_t *buf');
+    $body = array();
+    $fixedLength = 0;
+    $lengthExtra = '';
+    foreach ($command["parameters"] as $parameter) {
+        $p = $parameter["name"];
+        switch ($parameter["type"]) {
+            case "uint8_t":
+                $args[] = 'uint8_t '.$p;
+                $body[] = '*p++ = '.$p.';';
+                $fixedLength += 1;
+                break;
+            case "int8_t":
+                $args[] = 'int8_t '.$p;
+                $body[] = '*p++ = (uint8_t)'.$p.';';
+                $fixedLength += 1;
+                break;
+            case "uint16_t":
+                $args[] = 'uint16_t '.$p;
+                $body[] = 'p = write_u16(p, '.$p.');';
+                $fixedLength += 2;
+                break;
+            case "uint32_t":
+                $args[] = 'uint32_t '.$p;
+                $body[] = 'p = write_u32(p, '.$p.');';
+                $fixedLength += 4;
+                break;
+            case "macaddr_t":
+                $args[] = 'const uint8_t *'.$p;
+                $body[] = 'p = write_bytes(p, '.$p.', 6);';
+                $fixedLength += 6;
+                break;
+            case "btcod_t":
+                $args[] = 'const uint8_t *'.$p;
+                $body[] = 'p = write_bytes(p, '.$p.', 3);';
+                $fixedLength += 3;
+                break;
+            case "uint8_t[]":
+                $args[] = 'uint8_t '.$p.'_len';
+                $args[] = 'const uint8_t *'.$p.'_data';
+                $body[] = '*p++ = '.$p.'_len;';
+                $body[] = 'p = write_bytes(p, '.$p.'_data, '.$p.'_len);';
+                $fixedLength += 1;
+                $lengthExtra .= ' + '.$p.'_len';
+                break;
+        }
+    }
+    $lines = array();
+    $lines[] = '/// '.$command["doxbrief"];
+    $lines[] = 'inline size_t '.$name.'('.join(', ', $args).') {';
+    $lines[] = '    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_'.strtoupper($className).', '.sprintf("0x%02X", $command["id"]).', '.$fixedLength.$lengthExtra.');';
+    foreach ($body as $statement) $lines[] = '    '.$statement;
+    $lines[] = '    return p - buf;';
+    $lines[] = '}';
+    $lines[] = '';
+    return $lines;
+}
+
 echo '<pre>';
 
 echo "Reading '../kgapi.json'\n";
@@ -105,6 +241,7 @@ $pythonResponseDeclarations = array();
 $pythonEventDeclarations = array();
 $pythonResponseConditions = array();
 $pythonEventConditions = array();
+$pythonStructDefinitions = array();
 $pythonHandlerDefinitions = array();
 $pythonHandlerAssignments = array();
 $pythonFriendlyPacketCommandConditions = array();
@@ -162,6 +299,7 @@ foreach ($kgapi["classes"] as $class) {
             foreach ($class["commands"] as $command) {
                 $classCommands++;
                 $fixedLength = true;
+                $arrayLengthIndex = -1;
                 $payloadHTML = '';
                 $payloadLength = 0;
                 
@@ -248,6 +386,7 @@ foreach ($kgapi["classes"] as $class) {
                             $payloadLength += 3;
                             break;
                         case "uint8_t[]":
+                            $arrayLengthIndex = $payloadLength + 4;
                             $arduinoCommandArgList[] = 'rxPacket['.($payloadLength + 4).']';
                             $arduinoCommandArgList[] = 'rxPacket + '.($payloadLength + 5);
                             $arduinoCommandDefArgList[] = 'uint8_t '.$parameter["name"].'_len';
@@ -273,7 +412,6 @@ foreach ($kgapi["classes"] as $class) {
                                     $pythonFriendlyArgList[] = "'".$parameter["name"]."': ' '.join(['%02X' % b for b in ".$parameter["name"]."_data])";
                                     break;
                             }
-                            $payloadLength++;
                             $pythonGUICommandFields[] = 'self.txt_'.$class["name"].'_'.$command["name"].'_'.$parameter["name"].' = wxm.TextCtrl(self, -1, "", validRequired=False, emptyInvalid=True, mask="*+", formatcodes="F")';
                             $pythonGUICommandFields[] = 'hbox_'.$class["name"].'_'.$command["name"].'.Add(self.txt_'.$class["name"].'_'.$command["name"].'_'.$parameter["name"].', 0, wx.ALIGN_CENTER_VERTICAL | wx.LEFT, 4)';
                             $pythonGUICommandButtonArgs[] = 'len(self.txt_'.$class["name"].'_'.$command["name"].'_'.$parameter["name"].'.GetValue())';
@@ -433,6 +571,7 @@ foreach ($kgapi["classes"] as $class) {
                 
                 $arduinoCommandPayloadLength = $payloadLength;
                 $arduinoCommandFixedLength = $fixedLength;
+                $arduinoCommandArrayLengthIndex = $arrayLengthIndex;
 
                 // append relevant Python source code lines for command
                 $pythonPackList[1] = sprintf("0x%02X", $payloadLength).$pythonLengthExtra;
@@ -704,7 +843,12 @@ foreach ($kgapi["classes"] as $class) {
                 $arduinoCases[$class["id"]][] = 'case KG_PACKET_ID_CMD_'.strtoupper($class["name"].'_'.$command["name"]).': // '.sprintf("0x%02X", $command["id"]);
                 $arduinoCases[$class["id"]][] = '    // '.$class["name"].'_'.$command["name"].'('.join(', ', $arduinoCommandCommentArgList).')('.join(', ', $arduinoResponseCommentArgList).')';
                 $arduinoCases[$class["id"]][] = '    // parameters = '.$arduinoCommandPayloadLength.' '.($arduinoCommandPayloadLength == 1 ? 'byte' : 'bytes');
-                $arduinoCases[$class["id"]][] = '    if (rxPacket[1] '.($arduinoCommandFixedLength ? '!=' : '<').' '.$arduinoCommandPayloadLength.') {';
+                if ($arduinoCommandFixedLength) {
+                    $arduinoCases[$class["id"]][] = '    if (rxPacket[1] != '.$arduinoCommandPayloadLength.') {';
+                } else {
+                    // variable-length data must fill exactly the rest of the packet
+                    $arduinoCases[$class["id"]][] = '    if (rxPacket[1] < '.$arduinoCommandPayloadLength.' || rxPacket[1] != '.$arduinoCommandPayloadLength.' + rxPacket['.$arduinoCommandArrayLengthIndex.']) {';
+                }
                 $arduinoCases[$class["id"]][] = '        // incorrect parameter length';
                 $arduinoCases[$class["id"]][] = '        protocol_error = KG_PROTOCOL_ERROR_PARAMETER_LENGTH;';
                 $arduinoCases[$class["id"]][] = '    } else {';
@@ -762,8 +906,10 @@ foreach ($kgapi["classes"] as $class) {
                 $pythonResponseConditions[] = '    '.($classResponses == 1 ? 'if' : 'elif').' packet_command == '.$command["id"].': # kg_rsp_'.$class["name"].'_'.$command["name"];
                 $pythonFriendlyPacketResponseConditions[] = '    '.($classResponses == 1 ? 'if' : 'elif').' packet_command == '.$command["id"].': # kg_rsp_'.$class["name"].'_'.$command["name"];
                 if (!empty($pythonUnpackList)) {
-                    $pythonResponseConditions[] = '        '.join(', ', $pythonUnpackList).', = struct.unpack(\'<'.$pythonUnpackStr.'\', self.kgapi_rx_payload[:'.$payloadLength.'])';
-                    $pythonFriendlyPacketResponseConditions[] = '        '.join(', ', $pythonUnpackList).', = struct.unpack(\'<'.$pythonUnpackStr.'\', self.kgapi_rx_payload[:'.$payloadLength.'])';
+                    // fixed part of payload is decoded with a precompiled struct.Struct, straight from the payload (no slice)
+                    $pythonStructDefinitions[] = 'kg_rsp_'.$class["name"].'_'.$command["name"].'_struct = struct.Struct(\'<'.$pythonUnpackStr.'\')';
+                    $pythonResponseConditions[] = '        '.join(', ', $pythonUnpackList).', = kg_rsp_'.$class["name"].'_'.$command["name"].'_struct.unpack_from(self.kgapi_rx_payload)';
+                    $pythonFriendlyPacketResponseConditions[] = '        '.join(', ', $pythonUnpackList).', = kg_rsp_'.$class["name"].'_'.$command["name"].'_struct.unpack_from(self.kgapi_rx_payload)';
                 }
                 foreach ($pythonDataExtra as $pde) {
                     $pythonResponseConditions[] = '        '.$pde;
@@ -1082,8 +1228,9 @@ kglib_kg_rsp_'.$class["name"].'_'.$command["name"].' = my_kg_rsp_'.$class["name"
                 $pythonEventConditions[] = '    '.($classEvents == 1 ? 'if' : 'elif').' packet_command == '.$event["id"].': # kg_evt_'.$class["name"].'_'.$event["name"];
                 $pythonFriendlyPacketEventConditions[] = '    '.($classEvents == 1 ? 'if' : 'elif').' packet_command == '.$event["id"].': # kg_evt_'.$class["name"].'_'.$event["name"];
                 if (!empty($pythonUnpackList)) {
-                    $pythonEventConditions[] = '        '.join(', ', $pythonUnpackList).', = struct.unpack(\'<'.$pythonUnpackStr.'\', self.kgapi_rx_payload[:'.$payloadLength.'])';
-                    $pythonFriendlyPacketEventConditions[] = '        '.join(', ', $pythonUnpackList).', = struct.unpack(\'<'.$pythonUnpackStr.'\', self.kgapi_rx_payload[:'.$payloadLength.'])';
+                    $pythonStructDefinitions[] = 'kg_evt_'.$class["name"].'_'.$event["name"].'_struct = struct.Struct(\'<'.$pythonUnpackStr.'\')';
+                    $pythonEventConditions[] = '        '.join(', ', $pythonUnpackList).', = kg_evt_'.$class["name"].'_'.$event["name"].'_struct.unpack_from(self.kgapi_rx_payload)';
+                    $pythonFriendlyPacketEventConditions[] = '        '.join(', ', $pythonUnpackList).', = kg_evt_'.$class["name"].'_'.$event["name"].'_struct.unpack_from(self.kgapi_rx_payload)';
                 }
                 foreach ($pythonDataExtra as $pde) {
                     $pythonEventConditions[] = '        '.$pde;
@@ -1190,6 +1337,12 @@ kglib_kg_evt_'.$class["name"].'_'.$event["name"].' = my_kg_evt_'.$class["name"].
 $now = new DateTime('now', new DateTimeZone('America/New_York'));
 //$now = new DateTime('2014-11-28', new DateTimeZone('America/New_York'));
 
+// "php index.php check [filename ...]" (or "index.php?check") writes nothing, and instead compares
+// the generated output with the files already in the tree (all of them, or only those named)
+$checkOnly = (isset($argv) && count($argv) > 1 && $argv[1] == 'check') || isset($_GET['check']);
+$checkFiles = ($checkOnly && isset($argv)) ? array_slice($argv, 2) : array();
+$checkFailures = 0;
+
 // build Arduino firmware protocol support files from template
 echo "Building KGAPI Reference HTML document\n";
 $templateHTMLRef = file_get_contents("template.kgapi_reference.html");
@@ -1217,8 +1370,7 @@ foreach ($lines as $line) {
     $lines2[] = $line;
 }
 $templateHTMLRef = join("\n", $lines2);
-echo "--> Writing '../../docs/api/html/kgapi_reference.html'\n";
-file_put_contents('../../docs/api/html/kgapi_reference.html', $templateHTMLRef);
+write_generated_file('../../docs/api/html/kgapi_reference.html', $templateHTMLRef);
 
 // build Arduino firmware protocol support files from template
 echo "Building Arduino controller firmware protocol support files\n";
@@ -1323,8 +1475,7 @@ foreach ($kgapi["classes"] as $class) {
         $lines2[] = $line;
     }
     $templateArduino = join("\n", $lines2);
-    echo "--> Writing '../../controller/arduino/keyglove/support_protocol_".$class["name"].".h'\n";
-    file_put_contents('../../controller/arduino/keyglove/support_protocol_'.$class["name"].'.h', $templateArduino);
+    write_generated_file('../../controller/arduino/keyglove/support_protocol_'.$class["name"].'.h', $templateArduino);
 
     // build API command support implementation files
     if ($class["id"] == 0) continue; // skip the "protocol" class, which has no separate support files
@@ -1384,8 +1535,7 @@ foreach ($kgapi["classes"] as $class) {
         $lines2[] = $line;
     }
     $templateArduino = join("\n", $lines2);
-    echo "--> Writing '../../controller/arduino/keyglove/support_protocol_".$class["name"].".cpp'\n";
-    file_put_contents('../../controller/arduino/keyglove/support_protocol_'.$class["name"].'.cpp', $templateArduino);
+    write_generated_file('../../controller/arduino/keyglove/support_protocol_'.$class["name"].'.cpp', $templateArduino);
 }
 
 // build Arduino application stub file from template
@@ -1429,8 +1579,7 @@ foreach ($lines as $line) {
     $lines2[] = $line;
 }
 $templateArduino = join("\n", $lines2);
-echo "--> Writing '../../controller/arduino/keyglove/application_stubs.cpp'\n";
-file_put_contents('../../controller/arduino/keyglove/application_stubs.cpp', $templateArduino);
+write_generated_file('../../controller/arduino/keyglove/application_stubs.cpp', $templateArduino);
 
 // build Python library from template
 echo "Building Python KGLib implementation\n";
@@ -1456,6 +1605,9 @@ foreach ($lines as $line) {
             case "command_definitions":
                 $replacement = join("\n".str_repeat(' ', $indent), $pythonCommandDefinitions);
                 break;
+            case "struct_definitions":
+                $replacement = join("\n".str_repeat(' ', $indent), $pythonStructDefinitions);
+                break;
             case "response_declarations":
                 $replacement = join("\n".str_repeat(' ', $indent), $pythonResponseDeclarations);
                 break;
@@ -1486,8 +1638,7 @@ foreach ($lines as $line) {
     $lines2[] = $line;
 }
 $templatePython = join("\n", $lines2);
-echo "--> Writing '../../host/python/kglib.py'\n";
-file_put_contents('../../host/python/kglib.py', $templatePython);
+write_generated_file('../../host/python/kglib.py', $templatePython);
 
 /*
 // build Python serial demo from template
@@ -1602,7 +1753,89 @@ $templatePython = join("\n", $lines2);
 //file_put_contents('../../host/python/kglib_test_gui.py', $templatePython);
 */
 
+// build C++ host SDK from template
+echo "Building C++ host SDK\n";
+$cppClassIds = array();
+$cppEnumerations = array();
+$cppCommandBuilders = array();
+$cppResponseViews = array();
+$cppEventViews = array();
+$cppClassCount = 0;
+$cppIdCount = 0;
+foreach ($kgapi["classes"] as $class) {
+    $cppClassIds[] = str_pad('CLASS_'.strtoupper($class["name"]), 24, " ", STR_PAD_RIGHT).'= '.sprintf("0x%02X", $class["id"]).',';
+    if ($class["id"] + 1 > $cppClassCount) $cppClassCount = $class["id"] + 1;
+    foreach ($class["enumerations"] as $enumeration) {
+        $cppEnumerations[] = '/// '.strip_tags($enumeration["description"]);
+        $cppEnumerations[] = 'enum {';
+        foreach ($enumeration["values"] as $value) {
+            $cppEnumerations[] = '    '.str_pad(strtoupper($class["name"].'_'.$enumeration["name"].'_'.$value["name"]), 40, " ", STR_PAD_RIGHT).'= '.sprintf("0x%02X", $value["value"]).',  ///< '.$value["description"];
+        }
+        $cppEnumerations[] = '};';
+        $cppEnumerations[] = '';
+    }
+    foreach ($class["commands"] as $command) {
+        if ($command["id"] + 1 > $cppIdCount) $cppIdCount = $command["id"] + 1;
+        $cppCommandBuilders = array_merge($cppCommandBuilders, cpp_command_builder($class["name"], $command));
+        $cppResponseViews = array_merge($cppResponseViews, cpp_packet_view('rsp', $class["name"], $command, $command["returns"]));
+    }
+    foreach ($class["events"] as $event) {
+        if ($event["id"] + 1 > $cppIdCount) $cppIdCount = $event["id"] + 1;
+        $cppEventViews = array_merge($cppEventViews, cpp_packet_view('evt', $class["name"], $event, $event["parameters"]));
+    }
+}
+$cppClassIds[] = str_pad('CLASS_COUNT', 24, " ", STR_PAD_RIGHT).'= '.$cppClassCount.'     ///< One more than the highest class ID';
+
+// drop the trailing blank line after the last entry in each block
+if (end($cppEnumerations) === '') array_pop($cppEnumerations);
+if (end($cppCommandBuilders) === '') array_pop($cppCommandBuilders);
+if (end($cppResponseViews) === '') array_pop($cppResponseViews);
+if (end($cppEventViews) === '') array_pop($cppEventViews);
+
+$templateCpp = file_get_contents("template.cpp.kgapi.h");
+$lines = explode("\n", $templateCpp);
+$lines2 = array();
+foreach ($lines as $line) {
+    $count = preg_match_all('/(.*?)\{%([a-zA-Z0-9_]+)%\}/', $line, $matches);
+    for ($i = 0; $i < $count; $i++) {
+        $indent = 0;
+        if (trim($matches[1][$i]) == "") $indent = strlen($matches[1][$i]);
+        $replacement = false;
+        switch ($matches[2][$i]) {
+            case "date_ymd":
+                $replacement = $now -> format("Y-m-d");
+                break;
+            case "date_year":
+                $replacement = $now -> format("Y");
+                break;
+            case "class_ids":
+                $replacement = join("\n".str_repeat(' ', $indent), $cppClassIds);
+                break;
+            case "id_count":
+                $replacement = $cppIdCount;
+                break;
+            case "enumerations":
+                $replacement = join("\n".str_repeat(' ', $indent), $cppEnumerations);
+                break;
+            case "command_builders":
+                $replacement = join("\n".str_repeat(' ', $indent), $cppCommandBuilders);
+                break;
+            case "response_views":
+                $replacement = join("\n".str_repeat(' ', $indent), $cppResponseViews);
+                break;
+            case "event_views":
+                $replacement = join("\n".str_repeat(' ', $indent), $cppEventViews);
+                break;
+        }
+        if ($replacement !== false) $line = str_replace('{%'.$matches[2][$i].'%}', $replacement, $line);
+    }
+    $lines2[] = $line;
+}
+$templateCpp = join("\n", $lines2);
+write_generated_file('../../host/cpp/libkeyglove/kgapi.h', $templateCpp);
+
 echo "Done!\n";
 echo '</pre>';
+if ($checkFailures) exit(1);
 
 ?>
@@ -0,0 +1,302 @@
+// Keyglove host SDK - KGAPI packet builders, packet views and dispatch table
+// {%date_ymd%} by Jeff Rowberg <jeff@rowberg.net>
+
+/*
+================================================================================
+Keyglove source code is placed under the MIT license
+Copyright (c) {%date_year%} Jeff Rowberg
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+================================================================================
+*/
+
+/**
+ * @file kgapi.h
+ * @brief KGAPI packet builders, packet views and dispatch table
+ * @author Jeff Rowberg
+ * @date {%date_ymd%}
+ *
+ * Everything here works directly on packet bytes in the caller's buffers:
+ *
+ * - keyglove::cmd::<class>_<command>() writes a complete command packet into
+ *   a buffer and returns its length. Multi-byte fields are always written
+ *   little-endian one byte at a time, so the host byte order and alignment
+ *   don't matter.
+ * - keyglove::rsp::<class>_<command> and keyglove::evt::<class>_<event> are
+ *   read-only views over a received payload. Nothing is parsed or copied
+ *   until a field accessor is called, and uint8_t[] fields come back as
+ *   keyglove::bytes pointing into the packet itself.
+ * - keyglove::dispatcher looks up the handler for a packet by type, class and
+ *   ID in a fixed table, so dispatch costs the same for every packet.
+ *
+ * Views and bytes are only valid as long as the buffer they point into.
+ *
+ * This file is autogenerated. Normally it is not necessary to edit this file.
+ */
+
+#ifndef _KEYGLOVE_KGAPI_H_
+#define _KEYGLOVE_KGAPI_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+namespace keyglove {
+
+/* ============== */
+/* PACKET FRAMING */
+/* ============== */
+
+const uint8_t PACKET_TYPE_COMMAND = 0xC0;       ///< Command (host to glove) or its response (glove to host)
+const uint8_t PACKET_TYPE_EVENT = 0x80;         ///< Event (glove to host)
+const uint8_t PACKET_TAG_MASK = 0x38;           ///< First header byte bits holding the command tag (1-7), echoed in the response
+const size_t PACKET_HEADER_SIZE = 4;            ///< Type/tag/length, length, class ID, packet ID
+const size_t PACKET_MAX_SIZE = PACKET_HEADER_SIZE + 2047;   ///< Largest packet the 11-bit length field allows
+const size_t PACKET_TIMESTAMP_SIZE = 4;         ///< Timestamp appended to events when a timestamp mode is set
+
+/**
+ * @brief Get the total length of a packet from its first two bytes
+ */
+inline size_t packet_length(const uint8_t *header) {
+    return PACKET_HEADER_SIZE + (((header[0] & 0x07) << 8) | header[1]);
+}
+
+/**
+ * @brief Check whether a byte can start a packet
+ */
+inline bool packet_start(uint8_t b) {
+    return (b & 0xC0) == PACKET_TYPE_COMMAND || (b & 0xC0) == PACKET_TYPE_EVENT;
+}
+
+/**
+ * @brief Get the timestamp mode of an event (0 if it has no timestamp)
+ *
+ * Events other than protocol errors (class 0x00) and log messages (class
+ * 0xFF) use the tag bits for the glove's timestamp mode, and then end with
+ * a uint32 timestamp which is counted in the packet length.
+ *
+ * @see SYSTEM_TIMESTAMP_MODE_TICKS, SYSTEM_TIMESTAMP_MODE_MICROSECONDS
+ */
+inline uint8_t packet_timestamp_mode(const uint8_t *header) {
+    if ((header[0] & 0xC0) != PACKET_TYPE_EVENT || header[2] == 0x00 || header[2] == 0xFF) return 0;
+    return (header[0] & PACKET_TAG_MASK) >> 3;
+}
+
+/**
+ * @brief Get the timestamp from the end of a timestamped event
+ * @param[in] packet Complete event packet
+ * @param[in] length Packet length
+ * @return Timestamp in the units given by packet_timestamp_mode(), or 0 if there is none
+ */
+inline uint32_t packet_timestamp(const uint8_t *packet, size_t length) {
+    if (!packet_timestamp_mode(packet) || length < PACKET_HEADER_SIZE + PACKET_TIMESTAMP_SIZE) return 0;
+    const uint8_t *p = packet + length - PACKET_TIMESTAMP_SIZE;
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/**
+ * @brief Get the tag of a packet (0 if untagged)
+ *
+ * Responses carry the tag of the command they answer, and so do protocol
+ * errors caused by a tagged command. Other events are never tagged.
+ */
+inline uint8_t packet_tag(const uint8_t *header) {
+    if (packet_timestamp_mode(header)) return 0;
+    return (header[0] & PACKET_TAG_MASK) >> 3;
+}
+
+/**
+ * @brief Tag a command packet built with one of the keyglove::cmd functions
+ * @param[in] packet Command packet
+ * @param[in] tag Tag from 1 to 7, or 0 to remove it
+ */
+inline void set_packet_tag(uint8_t *packet, uint8_t tag) {
+    packet[0] = (packet[0] & ~PACKET_TAG_MASK) | ((tag << 3) & PACKET_TAG_MASK);
+}
+
+inline uint16_t read_u16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+inline uint32_t read_u32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+inline uint8_t *write_u16(uint8_t *p, uint16_t v) {
+    p[0] = v & 0xFF;
+    p[1] = v >> 8;
+    return p + 2;
+}
+
+inline uint8_t *write_u32(uint8_t *p, uint32_t v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = v >> 24;
+    return p + 4;
+}
+
+inline uint8_t *write_bytes(uint8_t *p, const uint8_t *data, size_t length) {
+    memcpy(p, data, length);
+    return p + length;
+}
+
+inline uint8_t *write_header(uint8_t *p, uint8_t type, uint8_t class_id, uint8_t id, size_t payload_length) {
+    p[0] = type | ((payload_length >> 8) & 0x07);
+    p[1] = payload_length & 0xFF;
+    p[2] = class_id;
+    p[3] = id;
+    return p + PACKET_HEADER_SIZE;
+}
+
+/**
+ * @brief Variable-length field inside a received packet (not a copy)
+ */
+struct bytes {
+    const uint8_t *data;
+    uint8_t length;
+};
+
+/* ========================== */
+/* CLASS IDS AND ENUMERATIONS */
+/* ========================== */
+
+enum {
+    {%class_ids%}
+};
+
+const uint8_t ID_COUNT = {%id_count%};     ///< One more than the highest command or event ID in any class
+
+{%enumerations%}
+
+/* ================ */
+/* COMMAND BUILDERS */
+/* ================ */
+
+namespace cmd {
+
+{%command_builders%}
+
+} // namespace cmd
+
+/* ============== */
+/* RESPONSE VIEWS */
+/* ============== */
+
+namespace rsp {
+
+{%response_views%}
+
+} // namespace rsp
+
+/* =========== */
+/* EVENT VIEWS */
+/* =========== */
+
+namespace evt {
+
+{%event_views%}
+
+} // namespace evt
+
+/* ============== */
+/* DISPATCH TABLE */
+/* ============== */
+
+/**
+ * @brief Calls a handler for each received packet from a fixed class/ID table
+ *
+ * Register a handler for any response or event view type, e.g.
+ *
+ *     void on_flex(void *glove, const keyglove::evt::flex_value &v) { ... }
+ *     dispatcher.on<keyglove::evt::flex_value>(on_flex, glove);
+ *
+ * Each glove normally has its own dispatcher, with its own context pointer.
+ * Views of timestamped events don't include the timestamp; the raw packet is
+ * still there for packet_timestamp() if the handler needs it.
+ */
+class dispatcher {
+public:
+    typedef void (*raw_handler)(void *context, const uint8_t *packet, size_t length);
+
+    dispatcher() : unhandled_(0), unhandled_context_(0) {
+        memset(responses_, 0, sizeof(responses_));
+        memset(events_, 0, sizeof(events_));
+    }
+
+    /**
+     * @brief Set or clear (with 0) the handler for one response or event type
+     */
+    template <class View>
+    void on(void (*handler)(void *context, const View &view), void *context = 0) {
+        slot &s = (View::packet_type == PACKET_TYPE_EVENT ? events_ : responses_)[View::class_id][View::id];
+        s.call = handler ? &call<View> : 0;
+        s.handler = (void (*)())handler;
+        s.context = context;
+    }
+
+    /**
+     * @brief Set the handler for packets with no handler of their own, or which are malformed
+     */
+    void on_unhandled(raw_handler handler, void *context = 0) {
+        unhandled_ = handler;
+        unhandled_context_ = context;
+    }
+
+    /**
+     * @brief Pass one complete packet to its handler
+     * @return True if a view handler took the packet
+     */
+    bool dispatch(const uint8_t *packet, size_t length) const {
+        if (length >= PACKET_HEADER_SIZE && length == packet_length(packet) && packet[2] < CLASS_COUNT && packet[3] < ID_COUNT) {
+            const slot &s = ((packet[0] & 0xC0) == PACKET_TYPE_COMMAND ? responses_ : events_)[packet[2]][packet[3]];
+            size_t payload_length = length - PACKET_HEADER_SIZE;
+            if (packet_timestamp_mode(packet)) {
+                payload_length = payload_length >= PACKET_TIMESTAMP_SIZE ? payload_length - PACKET_TIMESTAMP_SIZE : 0;
+            }
+            if (s.call && s.call(s, packet + PACKET_HEADER_SIZE, payload_length)) return true;
+        }
+        if (unhandled_) unhandled_(unhandled_context_, packet, length);
+        return false;
+    }
+
+private:
+    struct slot {
+        bool (*call)(const slot &s, const uint8_t *payload, size_t length);
+        void (*handler)();
+        void *context;
+    };
+
+    template <class View>
+    static bool call(const slot &s, const uint8_t *payload, size_t length) {
+        if (!View::valid(payload, length)) return false;
+        ((void (*)(void *, const View &))s.handler)(s.context, View(payload));
+        return true;
+    }
+
+    slot responses_[CLASS_COUNT][ID_COUNT];
+    slot events_[CLASS_COUNT][ID_COUNT];
+    raw_handler unhandled_;
+    void *unhandled_context_;
+};
+
+} // namespace keyglove
+
+#endif // _KEYGLOVE_KGAPI_H_
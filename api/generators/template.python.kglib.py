@@ -6,6 +6,12 @@ Keyglove Protocol Python interface library
 2014-12-06 by Jeff Rowberg <jeff@rowberg.net>
 
 Changelog:
+    2014-12-20 - Added device clock synchronization and timestamped events
+               - Decode tokenized log records against the kglog_messages dictionary
+    2014-12-14 - Added tagged commands so several can be outstanding at once
+               - Replaced busy-wait in send_and_return() with a condition wait
+               - Read and parse incoming data in whole chunks instead of byte by byte
+               - Decode payloads with precompiled struct.Struct layouts
     2014-12-06 - Separated communication code from parser/generator code
                - Added transparent support for PySerial/PyUSB/PyWinUSB
     2014-09-01 - Added unknown last response/event case for stability
@@ -44,7 +50,14 @@ __license__ = "MIT"
 __version__ = "{%date_ymd%}"
 __email__ = "jeff@rowberg.net"
 
-import struct, platform, sys, threading, time
+import re, struct, platform, sys, threading, time
+
+# log message dictionary generated from the firmware by keyglove_logdict.py
+try:
+    import kglog_messages
+    log_messages = kglog_messages.messages
+except ImportError:
+    log_messages = {}
 
 
 
@@ -134,6 +147,123 @@ class KeygloveEventHandler(object):
     __isub__ = remove
     __call__ = fire
 
+class KeygloveCommand(object):
+
+    """Command sent with KeygloveDevice.submit() which is waiting for its response"""
+
+    def __init__(self, device, tag, callback=None):
+        self.device = device
+        self.tag = tag
+        self.callback = callback
+        self.response = None
+        self.finished = False
+        self.abandoned = False
+
+    def done(self):
+
+        """Check whether the response (or the protocol error caused by this command) has arrived"""
+
+        return self.finished
+
+    def result(self, timeout=None):
+
+        """Wait for and return the response to this command.
+
+        If the command caused a protocol error instead, the error event is
+        returned. If nothing arrives within timeout seconds (None waits forever),
+        or the device is disconnected, None is returned and the tag is freed.
+        """
+
+        timed_out = False
+        with self.device.pending_lock:
+            deadline = None if timeout is None else time.time() + timeout
+            while not self.finished and not self.abandoned:
+                if deadline is None:
+                    self.device.pending_lock.wait()
+                else:
+                    remaining = deadline - time.time()
+                    if remaining <= 0:
+                        break
+                    self.device.pending_lock.wait(remaining)
+            if not self.finished and not self.abandoned:
+                # timed out, so give up on this tag (a late response will be ignored)
+                timed_out = True
+                if self.device.pending_commands.get(self.tag) is self:
+                    del self.device.pending_commands[self.tag]
+                    self.device.responses_pending = max(self.device.responses_pending - 1, 0)
+                self.abandoned = True
+                self.device.pending_lock.notify_all()
+            idle = self.device.responses_pending == 0
+        if timed_out:
+            self.device.on_api_timeout()
+            if idle:
+                self.device.on_api_idle()
+        return self.response
+
+
+
+class KeygloveClock(object):
+
+    """Estimates the offset and drift between the Keyglove's clock and the host's
+
+    Each sample is one system_get_time exchange: the host time just before the
+    command was sent, the host time just after the response arrived, and the
+    device clock readings from the response. The device read its clock
+    somewhere in between, so the midpoint of the round trip is the best guess
+    for the matching host time, and its error is at most half the round trip.
+    Link jitter mostly makes round trips longer, so only the quickest half of
+    the recent samples are used for a least-squares fit of offset and drift.
+    """
+
+    def __init__(self, window=32, min_span=10.0):
+        self.window = window
+        self.min_span = min_span    # device seconds the samples must cover before drift is estimated
+        self.samples = []           # (device seconds, host seconds at midpoint, round trip seconds)
+        self.offset = None          # host seconds minus device seconds at self.reference
+        self.drift = 0.0            # change in offset per device second (i.e. 1e-6 = 1ppm)
+        self.reference = 0.0        # device seconds of the newest sample
+        self.micros = None          # unwrapped device microseconds of the newest sample
+        self.lock = threading.Lock()
+
+    def ready(self):
+        return self.offset != None
+
+    def add_sample(self, host_send, host_recv, seconds, subticks, microseconds):
+        # the 1Hz/100Hz tick counters never wrap in practice, so use them to unwrap the microsecond counter
+        ticks = (seconds * 100 + subticks) * 10000
+        micros = ((ticks - microseconds + 0x80000000) // 0x100000000) * 0x100000000 + microseconds
+        with self.lock:
+            self.micros = micros
+            self.samples.append((micros / 1000000.0, (host_send + host_recv) / 2.0, host_recv - host_send))
+            del self.samples[:-self.window]
+            self.reference = self.samples[-1][0]
+
+            best = sorted(self.samples, key=lambda sample: sample[2])[:max(1, len(self.samples) // 2)]
+            x = [sample[0] - self.reference for sample in best]
+            y = [sample[1] - sample[0] for sample in best]
+            n = len(best)
+            mean_x = sum(x) / n
+            mean_y = sum(y) / n
+            var_x = sum((xi - mean_x) ** 2 for xi in x)
+            # over a short span the slope is all noise, so keep the last drift until there is a useful baseline
+            if n > 1 and max(x) - min(x) >= self.min_span:
+                self.drift = sum((xi - mean_x) * (yi - mean_y) for xi, yi in zip(x, y)) / var_x
+            self.offset = mean_y - self.drift * mean_x
+
+    def unwrap_micros(self, microseconds):
+        # take the 32-bit reading closest to the newest sample (good for about 35 minutes either way)
+        with self.lock:
+            if self.micros == None:
+                return microseconds
+            return self.micros + ((microseconds - self.micros + 0x80000000) % 0x100000000) - 0x80000000
+
+    def to_host(self, device_seconds):
+        # convert device seconds since boot into host time.time() seconds
+        with self.lock:
+            if self.offset == None:
+                return None
+            return device_seconds + self.offset + self.drift * (device_seconds - self.reference)
+
 
 
 class KeygloveDevice(object):
@@ -158,9 +288,15 @@ class KeygloveDevice(object):
         self.description = description
         self.mac = mac
         self.debug = debug
+        self.capture = None     # kgcapture.CaptureWriter (or anything with write(packet, sent)) to record all traffic
 
         self.connected = False
         self.responses_pending = 0
+        self.pending_lock = threading.Condition()
+        self.pending_commands = {}
+        self.last_tag = 0
+        self.clock_thread = None
+        self.clock_stop = threading.Event()
         self.serial_port = None
         self.serial_read_thread = None
         self.pywinusb_output = None
@@ -261,6 +397,14 @@ class KeygloveDevice(object):
         if not self.connected:
             return True
 
+        # nothing outstanding will get a response now
+        with self.pending_lock:
+            for command in self.pending_commands.values():
+                command.abandoned = True
+            self.pending_commands = {}
+            self.responses_pending = 0
+            self.pending_lock.notify_all()
+
         if self.type == 'hid':
             if self.backend == 'pywinusb':
                 # close the device (PyWinUSB spawns separate read thread while open)
@@ -302,8 +446,11 @@ class KeygloveDevice(object):
             packet = b''.join(chr(x) for x in packet)
         if self.debug:
             print('=>[ ' + ' '.join(['%02X' % ord(b) for b in packet ]) + ' ]')
+        if self.capture != None:
+            self.capture.write(packet, True)
         self.on_before_tx_command()
-        self.responses_pending = self.responses_pending + 1
+        with self.pending_lock:
+            self.responses_pending = self.responses_pending + 1
         self.on_api_busy()
 
         if self.type == 'hid':
@@ -373,35 +520,114 @@ class KeygloveDevice(object):
 
         self.on_tx_command_complete()
 
+    def submit(self, packet, timeout=None, callback=None):
+        # send a command without waiting for its response, returning a KeygloveCommand to collect it with later
+        # each outstanding command gets its own tag (1-7) which the Keyglove echoes in the response, so up to 7 can be
+        # in flight at once; if all tags are in use, wait up to timeout seconds (None = forever) for one to come back
+        # callback(command), if given, is called from the reader thread as soon as the response arrives
+        if type(packet) == type(list()):
+            packet = b''.join(chr(x) for x in packet)
+        with self.pending_lock:
+            deadline = None if timeout is None else time.time() + timeout
+            while self.connected and len(self.pending_commands) == 7:
+                if deadline is None:
+                    self.pending_lock.wait()
+                else:
+                    remaining = deadline - time.time()
+                    if remaining <= 0:
+                        return None
+                    self.pending_lock.wait(remaining)
+            if not self.connected:
+                raise KeygloveError('Cannot send packet, Keyglove not connected')
+
+            # use tags in rotation so a late response to an abandoned command is unlikely to match a new one
+            tag = self.last_tag
+            while True:
+                tag = tag % 7 + 1
+                if tag not in self.pending_commands:
+                    break
+            self.last_tag = tag
+            command = KeygloveCommand(self, tag, callback)
+            self.pending_commands[tag] = command
+        self.send(chr((ord(packet[0]) & 0xC7) | (tag << 3)) + packet[1:])
+        return command
+
     def send_and_return(self, packet, timeout=0):
-        if self.responses_pending > 0:
-            raise KeygloveError("Cannot use send_and_return() if there is already a pending response")
-        self.send(packet)
-        t0 = time.time()
-        while self.connected and self.responses_pending > 0 and (timeout == 0 or time.time() - t0 < timeout):
-            pass
-        if self.responses_pending > 0:
-            # timed out waiting for response
-            self.responses_pending = 0
+        # send a command and wait up to timeout seconds (0 = forever) for its response
+        command = self.submit(packet, timeout if timeout > 0 else None)
+        if command == None:
             self.on_api_timeout()
-            self.on_api_idle()
             return None
-        else:
-            # got response back correctly
-            if self.kgapi:
-                return self.kgapi.get_last_response()
-            else:
-                # extremely unlikely but not impossible case where KGAPI object is gone before this finishes
-                return None
+        return command.result(timeout if timeout > 0 else None)
+
+    def sync_clock(self, samples=8, timeout=1):
+        # take a few system_get_time samples to update the clock estimate, returning the number that worked
+        if self.kgapi.clock == None:
+            self.kgapi.clock = KeygloveClock()
+        count = 0
+        for i in range(samples):
+            host_send = time.time()
+            command = self.submit(self.kgapi.kg_cmd_system_get_time(), timeout)
+            response = command.result(timeout) if command != None else None
+            host_recv = time.time()
+            if response == None or response['class_id'] != 1:
+                continue
+            payload = response['payload']
+            self.kgapi.clock.add_sample(host_send, host_recv, payload['seconds'], payload['subticks'], payload['microseconds'])
+            count += 1
+        return count
+
+    def start_clock_sync(self, interval=5, samples=4):
+        # keep the clock estimate up to date from a background thread (drift matters over long sessions)
+        self.stop_clock_sync()
+        self.clock_stop.clear()
+        self.sync_clock(samples=16)
+
+        def run():
+            while not self.clock_stop.wait(interval) and self.connected:
+                try:
+                    self.sync_clock(samples)
+                except KeygloveError:
+                    break
+
+        self.clock_thread = threading.Thread(target=run)
+        self.clock_thread.daemon = True
+        self.clock_thread.start()
+
+    def stop_clock_sync(self):
+        if self.clock_thread != None:
+            self.clock_stop.set()
+            if self.clock_thread is not threading.current_thread():
+                self.clock_thread.join()
+            self.clock_thread = None
+
+    def rx_data(self, data):
+        for packet_type, packet in self.kgapi.parse_data(data):
+            if self.capture != None:
+                self.capture.write(packet['raw'])
+            # tagged events are protocol errors caused by a tagged command, which will not get a response
+            if packet_type == 0xC0 or packet['tag'] != 0:
+                self.complete(packet)
+
+    def complete(self, packet):
+        with self.pending_lock:
+            command = self.pending_commands.pop(packet['tag'], None)
+            if command != None:
+                command.response = packet
+                command.finished = True
+            if command != None or packet['tag'] == 0:
+                self.responses_pending = max(self.responses_pending - 1, 0)
+            self.pending_lock.notify_all()
+            idle = self.responses_pending == 0
+        if command != None and command.callback != None:
+            command.callback(command)
+        if idle:
+            self.on_api_idle()
 
     # handler for reading incoming raw HID packets via PyWinUSB (thread started inside PyWinUSB code)
     def pywinusb_read_handler(self, data):
         if ((data[0] == 0x00 and self.transport == 'usb') or (data[0] == 0x04 and self.transport == 'bluetooth')) and data[1] < len(data) - 1:
-            for b in data[2:data[1] + 2]:
-                if self.kgapi.parse(b) == 0xC0:
-                    self.responses_pending = self.responses_pending - 1
-                    if self.responses_pending == 0:
-                        self.on_api_idle()
+            self.rx_data(bytearray(data[2:data[1] + 2]))
 
     # handler for reading incoming raw HID packets via PyUSB (thread started in local connect() method)
     def pyusb_read_handler(self):
@@ -409,11 +635,7 @@ class KeygloveDevice(object):
             try:
                 ret = self.devobj.read(self.pyusb_endpoint_in.bEndpointAddress, self.pyusb_endpoint_in.wMaxPacketSize)
                 if len(ret) > 0 and ret[0] > 0:
-                    for b in ret[1:ret[0] + 1]:
-                        if self.kgapi.parse(b) == 0xC0:
-                            self.responses_pending = self.responses_pending - 1
-                            if self.responses_pending == 0:
-                                self.on_api_idle()
+                    self.rx_data(bytearray(ret[1:ret[0] + 1]))
             except usb.core.USBError as e:
                 if e.errno == 110 or "timed out" in str(e) or "not detach" in str(e):
                     # PyUSB timeout, probably just no data
@@ -429,19 +651,28 @@ class KeygloveDevice(object):
     def pyserial_read_handler(self):
         while self.serial_port != None and self.serial_port.isOpen():
             try:
-                ch = self.serial_port.read()
-                if len(ch):
-                    #print "%02X " % ord(ch)
-                    if self.kgapi.parse(ord(ch)) == 0xC0:
-                        self.responses_pending = self.responses_pending - 1
-                        if self.responses_pending == 0:
-                            self.on_api_idle()
+                # wait (up to the port timeout) for at least one byte, then take everything else already waiting
+                data = self.serial_port.read(max(1, self.serial_port.inWaiting()))
+                if len(data):
+                    self.rx_data(data)
             except serial.SerialException as e:
                 # serial port cannot be read from, most likely unplugged/disconnected
                 self.on_unplugged()
                 self.disconnect()
 
 
+# any byte which can start a packet (0x80 or 0xC0, plus tag), for resyncing after garbage
+kgapi_packet_start = re.compile('[' + ''.join(re.escape(chr(b)) for b in range(0x80, 0x100, 0x08)) + ']')
+
+# precompiled layouts for the fixed part of each response and event payload
+{%struct_definitions%}
+kg_log_record_struct = struct.Struct('<BHHH')
+
+def kg_log_record_text(message_id, arg):
+    if message_id in log_messages:
+        text = log_messages[message_id][1]
+        return text.replace('%d', '%d' % arg) if '%d' in text else text
+    return 'Unknown log message 0x%04X (%d)' % (message_id, arg)
 
 class KGAPI(object):
 
@@ -459,12 +690,14 @@ class KGAPI(object):
     on_before_tx_command = KeygloveEvent()
     on_tx_command_complete = KeygloveEvent()
 
-    kgapi_rx_buffer = []
-    kgapi_rx_expected_length = 0
+    kgapi_rx_buffer = bytearray()
     debug = False
 
     last_response = None
     last_event = None
+    last_event_timestamp = None     # device seconds since boot from the last timestamped event
+    last_event_host_time = None     # same moment in host time.time() seconds (needs a synchronized clock)
+    clock = None                    # KeygloveClock, set up by KeygloveDevice.sync_clock()
 
     def get_last_response(self):
         return self.last_response
@@ -473,63 +706,112 @@ class KGAPI(object):
         return self.last_event
 
     def parse(self, b):
-        if len(self.kgapi_rx_buffer) == 0 and (b == 0xC0 or b == 0x80):
-            self.kgapi_rx_buffer.append(b)
-        elif len(self.kgapi_rx_buffer) == 1:
-            self.kgapi_rx_buffer.append(b)
-            self.kgapi_rx_expected_length = 4 + (self.kgapi_rx_buffer[0] & 0x07) + self.kgapi_rx_buffer[1]
-        elif len(self.kgapi_rx_buffer) > 1:
-            self.kgapi_rx_buffer.append(b)
+        # process one received byte (parse_data() is much faster for whole chunks)
+        packets = self.parse_data(chr(b))
+        return packets[-1][0] if packets else 0
 
+    def parse_data(self, data):
         """
-        Keyglove packet structure (as of 2013-11-16):
-            Byte 0:     8 bits, Packet Type              0xC0 = command/response, 0x80 = event
+        Keyglove packet structure (as of 2014-12-20):
+            Byte 0:     2 bits, Packet Type              0xC0 = command/response, 0x80 = event
+                        3 bits, Tag                      Optional command tag (1-7), echoed in the response,
+                                                         or timestamp mode for events other than protocol/log
+                        3 bits, Length (high bits)       Always 0 (payload is never over 250 bytes)
             Byte 1:     8 bits, Length                   Payload length
             Byte 2:     8 bits, Class ID (CID)           Packet class
             Byte 3:     8 bits, Command ID (CMD)         Packet ID
             Bytes 4-n:  0 - 250 Bytes, Payload (PL)      Up to 250 bytes of payload
-        """
-
-        #print('%02X: %d, %d' % (b, len(self.kgapi_rx_buffer), self.kgapi_rx_expected_length))
-        if self.kgapi_rx_expected_length > 0 and len(self.kgapi_rx_buffer) == self.kgapi_rx_expected_length:
-            if self.debug:
-                print('<=[ ' + ' '.join(['%02X' % b for b in self.kgapi_rx_buffer ]) + ' ]')
-            packet_type, payload_length, packet_class, packet_command = self.kgapi_rx_buffer[:4]
-            self.kgapi_last_rx_packet = self.kgapi_rx_buffer
-            self.kgapi_rx_payload = b''.join(chr(i) for i in self.kgapi_rx_buffer[4:])
-            self.kgapi_rx_buffer = []
-            if packet_type & 0xC0 == 0xC0:
-                # 0xC0 = response packet after a command that has just been sent
-                # initialize last_response with unknown packet if we don't match
-                self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { }, 'raw': self.kgapi_last_rx_packet }
-                {%response_conditions%}
-                self.kg_response(self.last_response)
-            elif packet_type & 0xC0 == 0x80:
-                # 0x80 = event packet
-                # initialize last_event with unknown packet if we don't match
-                self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { }, 'raw': self.kgapi_last_rx_packet }
-                {%event_conditions%}
-                elif packet_class == 0xFF: # LOG
-                    if packet_command == 0xFF: # kg_log
-                        level, = struct.unpack('<B', self.kgapi_rx_payload[:1])
-                        message = self.kgapi_rx_payload[1:]
-                        payload = { 'level': level, 'message': message }
-                        self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': payload, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_log(payload)
-                self.kg_event(self.last_event)
+                                                         (timestamped events end with a uint32 timestamp)
 
-            return packet_type & 0xC0
+        Splits a chunk of received data (any size) into packets and processes
+        each complete one. Whatever is left over waits for the next chunk.
+        Returns a list of (packet type, last_response or last_event) tuples,
+        one for each packet completed by this chunk.
+        """
 
+        buf = self.kgapi_rx_buffer + bytearray(data)
+        end = len(buf)
+        start = 0
+        packets = []
+        while start < end:
+            if buf[start] & 0xC7 != 0xC0 and buf[start] & 0xC7 != 0x80:
+                # out of step, so skip straight to the next byte that can start a packet
+                match = kgapi_packet_start.search(buf, start + 1)
+                start = match.start() if match else end
+                continue
+            if end - start < 2:
+                break
+            length = 4 + ((buf[start] & 0x07) << 8) + buf[start + 1]
+            if end - start < length:
+                break
+            packets.append(self.process_packet(buf[start:start + length]))
+            start += length
+        self.kgapi_rx_buffer = buf[start:]
+        return packets
+
+    def process_packet(self, packet):
+        if self.debug:
+            print('<=[ ' + ' '.join(['%02X' % b for b in packet ]) + ' ]')
+        packet_type, payload_length, packet_class, packet_command = packet[:4]
+        self.kgapi_last_rx_packet = packet
+        self.kgapi_rx_payload = bytes(packet[4:])
+        if packet_type & 0xC0 == 0xC0:
+            # 0xC0 = response packet after a command that has just been sent
+            # initialize last_response with unknown packet if we don't match
+            self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { }, 'raw': self.kgapi_last_rx_packet }
+            {%response_conditions%}
+            self.last_response['tag'] = (packet_type >> 3) & 0x07
+            self.kg_response(self.last_response)
+            return (0xC0, self.last_response)
         else:
-            return 0
+            # 0x80 = event packet
+            # events other than protocol errors and logs use the tag bits for the timestamp mode
+            timestamp_mode = (packet_type >> 3) & 0x07 if packet_class not in (0x00, 0xFF) else 0
+            self.last_event_timestamp = None
+            self.last_event_host_time = None
+            if timestamp_mode and payload_length >= 4:
+                timestamp, = struct.unpack('<I', self.kgapi_rx_payload[-4:])
+                self.kgapi_rx_payload = self.kgapi_rx_payload[:-4]
+                payload_length -= 4
+                if timestamp_mode == 1: # ticks
+                    self.last_event_timestamp = timestamp / 100.0
+                elif self.clock != None: # microseconds
+                    self.last_event_timestamp = self.clock.unwrap_micros(timestamp) / 1000000.0
+                else:
+                    self.last_event_timestamp = timestamp / 1000000.0
+                if self.clock != None:
+                    self.last_event_host_time = self.clock.to_host(self.last_event_timestamp)
+            # initialize last_event with unknown packet if we don't match
+            self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { }, 'raw': self.kgapi_last_rx_packet }
+            {%event_conditions%}
+            elif packet_class == 0xFF: # LOG
+                if packet_command == 0xFF: # kg_log
+                    level, = struct.unpack('<B', self.kgapi_rx_payload[:1])
+                    message = self.kgapi_rx_payload[1:]
+                    payload = { 'level': level, 'message': message }
+                    self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': payload, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_log(payload)
+                elif packet_command == 0xFE: # kg_log records
+                    records = []
+                    for i in range(0, len(self.kgapi_rx_payload) - kg_log_record_struct.size + 1, kg_log_record_struct.size):
+                        level, message_id, arg, ticks = kg_log_record_struct.unpack_from(self.kgapi_rx_payload, i)
+                        record = { 'level': level, 'message_id': message_id, 'arg': arg, 'ticks': ticks, 'message': kg_log_record_text(message_id, arg) }
+                        records.append(record)
+                        self.kg_log(record)
+                    self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'records': records }, 'raw': self.kgapi_last_rx_packet }
+            self.last_event['tag'] = (packet_type >> 3) & 0x07 if not timestamp_mode else 0
+            self.last_event['timestamp'] = self.last_event_timestamp
+            self.last_event['host_time'] = self.last_event_host_time
+            self.kg_event(self.last_event)
+            return (0x80, self.last_event)
 
     def friendly_packet(self, packet, incoming):
-        if type(packet) == type(list()):
-            packet = b''.join(chr(x) for x in packet)
+        if type(packet) != type(str()):
+            packet = bytes(bytearray(packet)) # list or bytearray, e.g. the 'raw' packet of a response or event
         if len(packet) < 4 or len(packet) != ord(packet[1]) + 4:
             return False # invalid packet length
-        if packet[0] != 0x80 and (incoming == 0 and ord(packet[0]) != 0xC0):
-            return False # invalid packet type
+        if (ord(packet[0]) & 0xC7) not in (0x80, 0xC0) or (incoming == 0 and (ord(packet[0]) & 0xC7) != 0xC0):
+            return False # invalid packet type (bits 5-3 hold the tag or timestamp mode)
 
         packet_type = ord(packet[0]) & 0xC0
         payload_length = ord(packet[1])
@@ -537,6 +819,10 @@ class KGAPI(object):
         packet_command = ord(packet[3])
         payload = packet[4:]
 
+        if packet_type == 0x80 and packet_class not in (0x00, 0xFF) and ord(packet[0]) & 0x38 and payload_length >= 4:
+            payload = payload[:-4] # event timestamp
+            payload_length -= 4
+
         if incoming == 0:
             {%friendly_packet_command_conditions%}
         else:
@@ -549,6 +835,12 @@ class KGAPI(object):
                         level, = struct.unpack('<B', self.kgapi_rx_payload[:1])
                         message = self.kgapi_rx_payload[1:]
                         return { 'type': 'event', 'name': 'kg_log', 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'level': ('%d' % level), 'message': ''.join(['%c' % b for b in message]) }, 'payload_keys': [ 'level', 'message' ] }
+                    elif packet_command == 0xFE: # kg_log records
+                        messages = []
+                        for i in range(0, len(payload) - kg_log_record_struct.size + 1, kg_log_record_struct.size):
+                            level, message_id, arg, ticks = kg_log_record_struct.unpack_from(payload, i)
+                            messages.append('[%d @%d] %s' % (level, ticks, kg_log_record_text(message_id, arg)))
+                        return { 'type': 'event', 'name': 'kg_log', 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'records': '; '.join(messages) }, 'payload_keys': [ 'records' ] }
 
 # ======== ======== ======== ======== ======== ======== ======== ========
 # ======== ======== ======== ======== ======== ======== ======== ========
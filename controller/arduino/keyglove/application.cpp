@@ -53,6 +53,7 @@ THE SOFTWARE.
 #include "support_touch.h"
 #include "support_bluetooth.h"
 #include "support_hid_keyboard.h"
+#include "support_hid_macro.h"
 #include "application.h"
 
 uint8_t touch_data_prev[KG_BASE_COMBINATION_BYTES];     ///< Container for tracking previous touch status bits
@@ -158,6 +159,7 @@ uint8_t my_kg_evt_touch_status(uint8_t status_len, uint8_t *status_data) {
         // touch added
         if      (KGT_AY(touch_data_xor)) kg_cmd_motion_set_mode(0, true);   // enable motion sensor 0 (default MPU-6050 on back of hand)
         else if (KGT_DY(touch_data_xor)) keyboard_key_down(KEY_A);          // send key-down report for 'A' key
+        //else if (KGT_BY(touch_data_xor)) hid_macro_play_P(PSTR("Hello from Keyglove!\n")); // type a built-in text macro
     } else {
         // touch removed
         if      (KGT_AY(touch_data_xor)) kg_cmd_motion_set_mode(0, false);  // disable motion sensor 0
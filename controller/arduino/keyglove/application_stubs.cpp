@@ -1,5 +1,5 @@
 // Keyglove controller source code - Custom application behavior stub/reference implementations
-// 2014-12-14 by Jeff Rowberg <jeff@rowberg.net>
+// 2014-12-20 by Jeff Rowberg <jeff@rowberg.net>
 
 /*
 ================================================================================
@@ -31,7 +31,7 @@ THE SOFTWARE.
  * @file application_stubs.cpp
  * @brief **USER-DEFINED:** Custom application behavior stub/reference implementations
  * @author Jeff Rowberg
- * @date 2014-12-14
+ * @date 2014-12-20
  *
  * This file contains empty "stub" implementations of all existing API events.
  * It is also not included in the compile process. It is intended only that you
@@ -140,6 +140,31 @@ uint8_t my_kg_evt_system_timer_tick(uint8_t handle, uint32_t seconds, uint8_t su
     return 0; // 0=send event API packet, otherwise skip sending
 }
 
+/**
+ * @brief Indicates that the event timestamp mode has changed
+ * @param[in] mode New event timestamp mode
+ * @return KGAPI event packet fallthrough, zero allows and non-zero prevents
+ */
+uint8_t my_kg_evt_system_timestamp_mode(uint8_t mode) {
+    // TODO: special event handler code here
+    // ...
+
+    return 0; // 0=send event API packet, otherwise skip sending
+}
+
+/**
+ * @brief Indicates that memory headroom has dropped below the threshold
+ * @param[in] headroom Lowest headroom between the heap and the stack since boot
+ * @param[in] threshold Low memory threshold
+ * @return KGAPI event packet fallthrough, zero allows and non-zero prevents
+ */
+uint8_t my_kg_evt_system_memory_low(uint16_t headroom, uint16_t threshold) {
+    // TODO: special event handler code here
+    // ...
+
+    return 0; // 0=send event API packet, otherwise skip sending
+}
+
 
 //////////////////////////////// BLUETOOTH ////////////////////////////////
 
@@ -325,6 +350,20 @@ uint8_t my_kg_evt_feedback_rgb_mode(uint8_t index, uint8_t mode_red, uint8_t mod
     return 0; // 0=send event API packet, otherwise skip sending
 }
 
+/**
+ * @brief Indicates that a feedback pattern has been started on a feedback output
+ * @param[in] output Feedback output
+ * @param[in] pattern Pattern now running
+ * @param[in] duration Duration to run pattern (0 for forever)
+ * @return KGAPI event packet fallthrough, zero allows and non-zero prevents
+ */
+uint8_t my_kg_evt_feedback_pattern(uint8_t output, uint8_t pattern, uint8_t duration) {
+    // TODO: special event handler code here
+    // ...
+
+    return 0; // 0=send event API packet, otherwise skip sending
+}
+
 
 //////////////////////////////// TOUCH ////////////////////////////////
 
@@ -397,5 +436,140 @@ uint8_t my_kg_evt_motion_state(uint8_t index, uint8_t state) {
     return 0; // 0=send event API packet, otherwise skip sending
 }
 
+/**
+ * @brief Indicates progress of a motion sensor offset calibration
+ * @param[in] index Relevant motion sensor
+ * @param[in] status Calibration status
+ * @param[in] progress Percentage of still samples collected
+ * @return KGAPI event packet fallthrough, zero allows and non-zero prevents
+ */
+uint8_t my_kg_evt_motion_calibration(uint8_t index, uint8_t status, uint8_t progress) {
+    // TODO: special event handler code here
+    // ...
+
+    return 0; // 0=send event API packet, otherwise skip sending
+}
+
+/**
+ * @brief Indicates that a motion gesture has been recognized
+ * @param[in] index Relevant motion sensor
+ * @param[in] gesture Type of gesture recognized
+ * @param[in] axis Sensor axis (0 = X, 1 = Y, 2 = Z), with bit 7 set for the negative direction
+ * @param[in] strength Gesture strength
+ * @return KGAPI event packet fallthrough, zero allows and non-zero prevents
+ */
+uint8_t my_kg_evt_motion_gesture(uint8_t index, uint8_t gesture, uint8_t axis, uint8_t strength) {
+    // TODO: special event handler code here
+    // ...
+
+    return 0; // 0=send event API packet, otherwise skip sending
+}
+
+/**
+ * @brief Indicates that a motion sensor's configuration has changed
+ * @param[in] index Affected motion sensor
+ * @param[in] rate Output data rate in Hz
+ * @param[in] accel_range Accelerometer full scale
+ * @param[in] gyro_range Gyroscope full scale
+ * @param[in] filter Low-pass filter setting
+ * @param[in] encoding motion_data stream encoding
+ * @param[in] stream_rate Actual motion_data rate in Hz
+ * @return KGAPI event packet fallthrough, zero allows and non-zero prevents
+ */
+uint8_t my_kg_evt_motion_config(uint8_t index, uint16_t rate, uint8_t accel_range, uint8_t gyro_range, uint8_t filter, uint8_t encoding, uint16_t stream_rate) {
+    // TODO: special event handler code here
+    // ...
+
+    return 0; // 0=send event API packet, otherwise skip sending
+}
+
+
+//////////////////////////////// FLEX ////////////////////////////////
+
+/**
+ * @brief Indicates that a finger's bend has changed
+ * @param[in] index Flex sensor that changed
+ * @param[in] value New calibrated bend (0 = straight, 255 = fully bent)
+ * @return KGAPI event packet fallthrough, zero allows and non-zero prevents
+ */
+uint8_t my_kg_evt_flex_value(uint8_t index, uint8_t value) {
+    // TODO: special event handler code here
+    // ...
+
+    return 0; // 0=send event API packet, otherwise skip sending
+}
+
+
+//////////////////////////////// PRESSURE ////////////////////////////////
+
+/**
+ * @brief Indicates that a fingertip press has reached its peak
+ * @param[in] index Pressure sensor pressed
+ * @param[in] velocity Strike velocity
+ * @param[in] peak Peak force of the strike
+ * @return KGAPI event packet fallthrough, zero allows and non-zero prevents
+ */
+uint8_t my_kg_evt_pressure_press(uint8_t index, uint8_t velocity, uint8_t peak) {
+    // TODO: special event handler code here
+    // ...
+
+    return 0; // 0=send event API packet, otherwise skip sending
+}
+
+/**
+ * @brief Indicates that a fingertip press has ended
+ * @param[in] index Pressure sensor released
+ * @return KGAPI event packet fallthrough, zero allows and non-zero prevents
+ */
+uint8_t my_kg_evt_pressure_release(uint8_t index) {
+    // TODO: special event handler code here
+    // ...
+
+    return 0; // 0=send event API packet, otherwise skip sending
+}
+
+/**
+ * @brief Indicates that the force of a held press has changed
+ * @param[in] index Pressure sensor that changed
+ * @param[in] value New force (0-255)
+ * @return KGAPI event packet fallthrough, zero allows and non-zero prevents
+ */
+uint8_t my_kg_evt_pressure_value(uint8_t index, uint8_t value) {
+    // TODO: special event handler code here
+    // ...
+
+    return 0; // 0=send event API packet, otherwise skip sending
+}
+
+/**
+ * @brief Indicates that the press detection thresholds have changed
+ * @param[in] press Force at which a press starts
+ * @param[in] release Force below which a press ends
+ * @param[in] deadband Smallest change in force that sends a value event
+ * @return KGAPI event packet fallthrough, zero allows and non-zero prevents
+ */
+uint8_t my_kg_evt_pressure_config(uint8_t press, uint8_t release, uint8_t deadband) {
+    // TODO: special event handler code here
+    // ...
+
+    return 0; // 0=send event API packet, otherwise skip sending
+}
+
+
+//////////////////////////////// TOUCHSET ////////////////////////////////
+
+/**
+ * @brief Indicates that keyboard macro playback has started, finished or been cancelled
+ * @param[in] index Macro slot (0xFF for a macro built into firmware)
+ * @param[in] status Playback status
+ * @return KGAPI event packet fallthrough, zero allows and non-zero prevents
+ */
+uint8_t my_kg_evt_touchset_macro_status(uint8_t index, uint8_t status) {
+    // TODO: special event handler code here
+    // ...
+
+    return 0; // 0=send event API packet, otherwise skip sending
+}
+
 
 #endif // false
@@ -101,6 +101,12 @@ THE SOFTWARE.
 #elif defined(CORE_KEYGLOVE)
     #define KG_BOARD            KG_BOARD_KEYGLOVE100
 
+// Linux host simulation (see controller/linux)
+#elif defined(KG_LINUX_SIM)
+    #define KG_BOARD                    KG_BOARD_LINUX_SIM
+    #define AUTO_KG_HOSTIF_USB_SERIAL   KG_HOSTIF_USB_SERIAL
+    #define AUTO_KG_HOSTIF_USB_RAWHID   KG_HOSTIF_USB_RAWHID
+
 #else
     // ...if you're adding support for something else here, make sure you define it by this point!
     #error No compatible board defined. This could be a problem.
@@ -159,9 +165,10 @@ THE SOFTWARE.
  *
  * Controls whether KGAPI response and event packets (outgoing) will be sent if
  * generated, and whether those interfaces will be checked for command packets
- * (incoming) from a connected host.
+ * (incoming) from a connected host. Log messages (KG_INTERFACE_MODE_OUTGOING_LOG)
+ * only go to USB serial by default.
  */
-#define KG_APIMODE_USB_SERIAL   KG_INTERFACE_MODE_OUTGOING_API | KG_INTERFACE_MODE_INCOMING_API
+#define KG_APIMODE_USB_SERIAL   KG_INTERFACE_MODE_OUTGOING_API | KG_INTERFACE_MODE_INCOMING_API | KG_INTERFACE_MODE_OUTGOING_LOG
 
 /**
  * @brief KGAPI traffic mode for USB serial interface
@@ -207,8 +214,9 @@ THE SOFTWARE.
  *
  * @see KG_HID_KEYBOARD
  * @see KG_HID_MOUSE
+ * @see KG_HID_KEYBOARD_NKRO
  */
-#define KG_HID              KG_HID_MOUSE | KG_HID_KEYBOARD
+#define KG_HID              (KG_HID_MOUSE | KG_HID_KEYBOARD)
 
 /**
  * @brief Motion sensor support selection
@@ -218,6 +226,14 @@ THE SOFTWARE.
 //#define KG_MOTION           KG_MOTION_NONE
 #define KG_MOTION           KG_MOTION_MPU6050_HAND
 
+/**
+ * @brief Motion fusion selection (requires KG_MOTION_MPU6050_HAND)
+ * @see KG_FUSION_NONE
+ * @see KG_FUSION_MAHONY
+ */
+//#define KG_FUSION           KG_FUSION_NONE
+#define KG_FUSION           KG_FUSION_MAHONY
+
 /**
  * @brief Feedback generator selection
  * @see KG_FEEBACK_BLINK
@@ -257,4 +273,24 @@ THE SOFTWARE.
 
 
 
+// the Linux simulation only has touch sensors and the two USB API interfaces
+#if KG_BOARD == KG_BOARD_LINUX_SIM
+    #undef KG_HOSTIF
+    #undef KG_HID
+    #undef KG_MOTION
+    #undef KG_FUSION
+    #undef KG_FEEDBACK
+    #undef KG_FLEX
+    #undef KG_PRESSURE
+    #define KG_HOSTIF       (AUTO_KG_HOSTIF_USB_SERIAL | AUTO_KG_HOSTIF_USB_RAWHID)
+    #define KG_HID          KG_HID_NONE
+    #define KG_MOTION       KG_MOTION_NONE
+    #define KG_FUSION       KG_FUSION_NONE
+    #define KG_FEEDBACK     KG_FEEDBACK_NONE
+    #define KG_FLEX         KG_FLEX_NONE
+    #define KG_PRESSURE     KG_PRESSURE_NONE
+#endif
+
+
+
 #endif // _CONFIG_H_
@@ -50,20 +50,21 @@ THE SOFTWARE.
 #define KG_BOARD_TEENSYPP2_T19          0x11        ///< AT90USB128x MCU, 46 I/O pins and prototype/kit design, 19 touch sensors
 #define KG_BOARD_ARDUINO_DUE            0x20        ///< **NOT SUPPORTED YET:** SAM3X8E MCU, 50+ I/O pins and prototype/Arduino design
 #define KG_BOARD_KEYGLOVE100            0x30        ///< **NOT SUPPORTED YET:** SAM3X8E MCU, 50+ I/O pins and custom design
+#define KG_BOARD_LINUX_SIM              0x40        ///< Linux host simulation with stubbed peripherals, for benchmarks and testing (see controller/linux)
 
 
 
 /* Flex sensor options. Only one choice may be selected at the same time. (defined in KG_FLEX) */
 
 #define KG_FLEX_NONE                    0x00        ///< No flex sensors used
-#define KG_FLEX_5FINGERS                0x01        ///< **NOT SUPPORTED YET:** Full 5-finger complement
+#define KG_FLEX_5FINGERS                0x01        ///< **NOT SUPPORTED YET:** Full 5-finger complement (port F touch sensors must be rewired first, see board file)
 
 
 
 /* Pressure sensor options. Only one choice may be selected at the same time. (defined in KG_PRESSURE) */
 
 #define KG_PRESSURE_NONE                0x00        ///< No pressure sensors used
-#define KG_PRESSURE_5TIPS               0x01        ///< **NOT SUPPORTED YET:** Full 5-fingertip complement
+#define KG_PRESSURE_5TIPS               0x01        ///< **NOT SUPPORTED YET:** Full 5-fingertip complement (port F touch sensors must be rewired first, see board file)
 
 
 
@@ -98,6 +99,7 @@ THE SOFTWARE.
 #define KG_HID_NONE                     0x00        ///< No standard HID support
 #define KG_HID_KEYBOARD                 0x01        ///< Include standard HID keyboard support routines
 #define KG_HID_MOUSE                    0x02        ///< Include standard HID mouse support routines
+#define KG_HID_KEYBOARD_NKRO            0x04        ///< Use N-key rollover keyboard report where supported (requires NKRO iWRAP HID descriptor)
 
 
 
@@ -109,6 +111,13 @@ THE SOFTWARE.
 
 
 
+/* Motion fusion options. Only one option may be selected. (defined in KG_FUSION) */
+
+#define KG_FUSION_NONE                  0x00        ///< No orientation fusion
+#define KG_FUSION_MAHONY                0x01        ///< Fixed-point Mahony complementary filter on hand accel/gyro data
+
+
+
 /* Sensory feedback. Multiple options may be enabled. (defined in KG_FEEDBACK) */
 
 #define KG_FEEDBACK_NONE                0x00        ///< No feedback support
@@ -135,5 +144,6 @@ THE SOFTWARE.
 #define KG_INTERFACENUM_BT2_SERIAL      3           ///< KGAPI interface identifier for BT2 serial
 #define KG_INTERFACENUM_BT2_RAWHID      4           ///< KGAPI interface identifier for BT2 raw HID
 #define KG_INTERFACENUM_BT2_IAP         5           ///< KGAPI interface identifier for BT2 IAP
+#define KG_INTERFACENUM_COUNT           5           ///< Highest KGAPI interface identifier (sizes per-interface tables)
 
 #endif // _HARDWARE_H_
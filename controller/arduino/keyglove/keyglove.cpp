@@ -60,6 +60,16 @@ THE SOFTWARE.
     #include "support_motion.h"
 #endif
 
+// FLEX SENSORS
+#if (KG_FLEX > 0)
+    #include "support_flex.h"
+#endif
+
+// PRESSURE SENSORS
+#if (KG_PRESSURE > 0)
+    #include "support_pressure.h"
+#endif
+
 // BLUETOOTH SUPPORT
 #if (KG_HOSTIF & HG_HOSTIF_BT2_SPP) || (KG_HOSTIF & KG_HOSTIF_BT2_HID) || (KG_HOSTIF & KG_HOSTIF_BT2_RAWHID) || (KG_HOSTIF & KG_HOSTIF_BT2_IAP)
     #include "support_bluetooth.h"
@@ -68,6 +78,7 @@ THE SOFTWARE.
 // HUMAN INPUT DEVICE
 #if (KG_HID & KG_HID_KEYBOARD)
     #include "support_hid_keyboard.h"
+    #include "support_hid_macro.h"
 #endif
 #if (KG_HID & KG_HID_MOUSE)
     #include "support_hid_mouse.h"
@@ -111,6 +122,12 @@ void setup() {
     keygloveTick = 0;
     keygloveTock = 0;
 
+    // LOGGING (first, so everything after it can log)
+    setup_log();
+
+    // MEMORY MONITORING
+    setup_memory();
+
     // BOARD
     setup_board();
 
@@ -121,10 +138,11 @@ void setup() {
     setup_application();
 
     // send system_boot event
-    uint8_t payload[7] = {
-        KG_FIRMWARE_VERSION_MAJOR,
-        KG_FIRMWARE_VERSION_MINOR,
-        KG_FIRMWARE_VERSION_PATCH,
+    uint8_t payload[12] = {
+        KG_FIRMWARE_VERSION_MAJOR & 0xFF, (KG_FIRMWARE_VERSION_MAJOR >> 8) & 0xFF,
+        KG_FIRMWARE_VERSION_MINOR & 0xFF, (KG_FIRMWARE_VERSION_MINOR >> 8) & 0xFF,
+        KG_FIRMWARE_VERSION_PATCH & 0xFF, (KG_FIRMWARE_VERSION_PATCH >> 8) & 0xFF,
+        KG_PROTOCOL_VERSION & 0xFF, (KG_PROTOCOL_VERSION >> 8) & 0xFF,
         KG_BUILD_TIMESTAMP & 0xFF,
         (KG_BUILD_TIMESTAMP >> 8) & 0xFF,
         (KG_BUILD_TIMESTAMP >> 16) & 0xFF,
@@ -132,12 +150,15 @@ void setup() {
     };
     skipPacket = 0;
     if (kg_evt_system_boot) skipPacket = kg_evt_system_boot(KG_FIRMWARE_VERSION_MAJOR, KG_FIRMWARE_VERSION_MINOR, KG_FIRMWARE_VERSION_PATCH, KG_PROTOCOL_VERSION, KG_BUILD_TIMESTAMP);
-    if (!skipPacket) send_keyglove_packet(KG_PACKET_TYPE_EVENT, 7, KG_PACKET_CLASS_SYSTEM, KG_PACKET_ID_EVT_SYSTEM_BOOT, payload);
+    if (!skipPacket) send_keyglove_packet(KG_PACKET_TYPE_EVENT, 12, KG_PACKET_CLASS_SYSTEM, KG_PACKET_ID_EVT_SYSTEM_BOOT, payload);
 
     // CORE TOUCH SENSOR LOGIC
     setup_touch();
 
     // FEEDBACK
+    #if (KG_FEEDBACK > 0)
+        setup_feedback();
+    #endif
     #if (KG_FEEDBACK & KG_FEEDBACK_BLINK)
         setup_feedback_blink();
     #endif
@@ -152,8 +173,28 @@ void setup() {
     #endif
 
     // MOTION
+    #if (KG_MOTION > 0)
+        setup_twi();
+    #endif
+    #if (KG_MOTION > 0)
+        setup_motion();
+    #endif
     #if (KG_MOTION & KG_MOTION_MPU6050_HAND)
-        setup_motion_mpu6050_hand();
+        setup_motion_gesture();
+    #endif
+    #if (KG_FUSION > 0)
+        setup_motion_fusion();
+    #endif
+
+    // FLEX/PRESSURE SENSORS
+    #if (KG_FLEX > 0) || (KG_PRESSURE > 0)
+        setup_adc();
+    #endif
+    #if (KG_FLEX > 0)
+        setup_flex();
+    #endif
+    #if (KG_PRESSURE > 0)
+        setup_pressure();
     #endif
 
     // HOST INTERFACE
@@ -164,6 +205,7 @@ void setup() {
     // HUMAN INPUT DEVICE
     #if (KG_HID & KG_HID_KEYBOARD)
         setup_hid_keyboard();
+        setup_hid_macro();
     #endif
     #if (KG_HID & KG_HID_MOUSE)
         setup_hid_mouse();
@@ -199,19 +241,7 @@ void loop() {
         // update touch status
         update_touch();
 
-        // update feedback settings
-        #if (KG_FEEDBACK & KG_FEEDBACK_BLINK)
-            update_feedback_blink();
-        #endif // KG_FEEDBACK_BLINK
-        #if (KG_FEEDBACK & KG_FEEDBACK_RGB)
-            update_feedback_rgb();
-        #endif // KG_FEEDBACK_RGB
-        #if (KG_FEEDBACK & KG_FEEDBACK_PIEZO)
-            update_feedback_piezo();
-        #endif // KG_FEEDBACK_PIEZO
-        #if (KG_FEEDBACK & KG_FEEDBACK_VIBRATE)
-            update_feedback_vibrate();
-        #endif // KG_FEEDBACK_VIBRATE
+        // (feedback outputs are updated by their own timer interrupt, see setup_feedback())
 
         // check for 100 ticks and reset counter (should be every 1 second)
         keygloveTick++;
@@ -220,6 +250,9 @@ void loop() {
             keygloveTick = 0;
             keygloveTock++;
 
+            // check memory headroom once per second
+            update_memory();
+
             /*
             // read battery voltage once per second
             // need to scale [700, 880] to [0, 100]
@@ -307,16 +340,59 @@ void loop() {
     */
     
     // MOTION
+    #if (KG_MOTION > 0)
+        // run callbacks for any finished sensor bus transactions
+        update_twi();
+
+        // let every motion sensor read any full batch of new samples
+        update_motion();
+    #endif
     #if (KG_MOTION & KG_MOTION_MPU6050_HAND)
-        // check for available motion data from MPU-6050 on back of hand
-        if (mpuHandInterrupt) {
-            mpuHandInterrupt = false; // clear the flag so we don't read again until the next interrupt
-            update_motion_mpu6050_hand();
+
+        // process the batch one sample at a time
+        while (motion_mpu6050_hand_next_sample()) {
+            #if (KG_FUSION > 0)
+                // update orientation and gravity-free world-frame acceleration
+                update_motion_fusion(&aaRaw, &gvRaw);
+            #endif
+
+            // look for gestures
+            update_motion_gesture();
+
+            #if (KG_HID & KG_HID_MOUSE)
+                // translate new motion data into pending mouse movement
+                update_hid_mouse();
+            #endif
         }
     #endif
+
+    // FLEX SENSORS
+    #if (KG_FLEX > 0)
+        // scale new readings and report meaningful bend changes
+        update_flex();
+    #endif
+
+    // PRESSURE SENSORS
+    #if (KG_PRESSURE > 0)
+        // detect presses and report force changes beyond the deadband
+        update_pressure();
+    #endif
+
+    // HUMAN INPUT DEVICE
+    #if (KG_HID & KG_HID_KEYBOARD)
+        // type the next step of any macro in progress
+        update_hid_macro();
+    #endif
+    #if (KG_HID & KG_HID_MOUSE)
+        // send pending mouse movement to any transport that is due for a report
+        send_hid_mouse_reports();
+    #endif
     
     // send any queued packets
     send_keyglove_queue();
+
+    // send anything logged since the last pass
+    update_log();
 }
 
 /* ============================= */
@@ -511,7 +587,7 @@ uint16_t kg_cmd_system_get_capabilities(uint8_t category, uint16_t *count) {
 
         uint8_t payload[5];
         payload[0] = KG_CAPABILITY_CATEGORY_PRESSURE;
-        payload[1] = 0x09;
+        payload[1] = 0x03;
         payload[2] = 0x01;
         payload[3] = 0x01;
         payload[4] = KG_PRESSURE;
@@ -580,3 +656,207 @@ uint16_t kg_cmd_system_set_timer(uint8_t handle, uint16_t interval, uint8_t ones
     }
     return 0; // success
 }
+
+/**
+ * @brief Get the current device clock readings
+ * @param[out] seconds Seconds since boot
+ * @param[out] subticks 10ms ticks within the current second (0-99)
+ * @param[out] microseconds Microseconds since boot (wraps every ~71.6 minutes)
+ * @return Result code (0=success)
+ */
+uint16_t kg_cmd_system_get_time(uint32_t *seconds, uint8_t *subticks, uint32_t *microseconds) {
+    // tick counters only change in loop(), so these are always consistent
+    *seconds = keygloveTock;
+    *subticks = keygloveTick;
+    *microseconds = micros();
+    return 0; // success
+}
+
+/**
+ * @brief Get the current event timestamp mode
+ * @param[out] mode Timestamp mode
+ * @return Result code (0=success)
+ */
+uint16_t kg_cmd_system_get_timestamp_mode(uint8_t *mode) {
+    *mode = protocolTimestampMode;
+    return 0; // success
+}
+
+/**
+ * @brief Set a new event timestamp mode
+ * @param[in] mode Timestamp mode
+ * @return Result code (0=success)
+ */
+uint16_t kg_cmd_system_set_timestamp_mode(uint8_t mode) {
+    if (mode > KG_SYSTEM_TIMESTAMP_MODE_MICROSECONDS) {
+        return KG_PROTOCOL_ERROR_PARAMETER_RANGE;
+    }
+    protocolTimestampMode = mode;
+
+    // send kg_evt_system_timestamp_mode packet (if we aren't just intentionally setting it already)
+    if (!inBinPacket) {
+        uint8_t payload[1] = { mode };
+        skipPacket = 0;
+        if (kg_evt_system_timestamp_mode) skipPacket = kg_evt_system_timestamp_mode(mode);
+        if (!skipPacket) send_keyglove_packet(KG_PACKET_TYPE_EVENT, 1, KG_PACKET_CLASS_SYSTEM, KG_PACKET_ID_EVT_SYSTEM_TIMESTAMP_MODE, payload);
+    }
+    return 0; // success
+}
+
+/**
+ * @brief Get the event subscription mask for one interface and class
+ * @param[in] interface Host interface (0 for the one this command came from)
+ * @param[in] event_class Event class ID
+ * @param[out] mask Subscribed event IDs (bit N set = event ID N is sent)
+ * @return Result code (0=success)
+ */
+uint16_t kg_cmd_system_get_event_mask(uint8_t interface, uint8_t event_class, uint16_t *mask) {
+    if (interface == 0) interface = lastCommandInterfaceNum;
+    if (interface == 0 || interface > KG_INTERFACENUM_COUNT || event_class == KG_PACKET_CLASS_PROTOCOL || event_class >= KG_PACKET_CLASS_COUNT) {
+        *mask = 0;
+        return KG_PROTOCOL_ERROR_PARAMETER_RANGE;
+    }
+    *mask = protocolEventFilter[interface - 1][event_class].mask;
+    return 0; // success
+}
+
+/**
+ * @brief Set the event subscription mask for one interface and class
+ * @param[in] interface Host interface (0 for the one this command came from)
+ * @param[in] event_class Event class ID
+ * @param[in] mask Subscribed event IDs (bit N set = event ID N is sent)
+ * @return Result code (0=success)
+ */
+uint16_t kg_cmd_system_set_event_mask(uint8_t interface, uint8_t event_class, uint16_t mask) {
+    if (interface == 0) interface = lastCommandInterfaceNum;
+    if (interface == 0 || interface > KG_INTERFACENUM_COUNT || event_class == KG_PACKET_CLASS_PROTOCOL || event_class >= KG_PACKET_CLASS_COUNT) {
+        return KG_PROTOCOL_ERROR_PARAMETER_RANGE;
+    }
+    protocolEventFilter[interface - 1][event_class].mask = mask;
+    return 0; // success
+}
+
+/**
+ * @brief Get the event rate limit for one interface and class
+ * @param[in] interface Host interface (0 for the one this command came from)
+ * @param[in] event_class Event class ID
+ * @param[out] interval Shortest time between events (10ms units, 0 = no limit)
+ * @param[out] ids Event IDs the limit applies to (bit N = event ID N)
+ * @return Result code (0=success)
+ */
+uint16_t kg_cmd_system_get_event_rate(uint8_t interface, uint8_t event_class, uint8_t *interval, uint16_t *ids) {
+    if (interface == 0) interface = lastCommandInterfaceNum;
+    if (interface == 0 || interface > KG_INTERFACENUM_COUNT || event_class == KG_PACKET_CLASS_PROTOCOL || event_class >= KG_PACKET_CLASS_COUNT) {
+        *interval = 0;
+        *ids = 0;
+        return KG_PROTOCOL_ERROR_PARAMETER_RANGE;
+    }
+    protocol_event_filter_t *filter = &protocolEventFilter[interface - 1][event_class];
+    *interval = filter -> interval;
+    *ids = filter -> rate_ids;
+    return 0; // success
+}
+
+/**
+ * @brief Set the event rate limit for one interface and class
+ * @param[in] interface Host interface (0 for the one this command came from)
+ * @param[in] event_class Event class ID
+ * @param[in] interval Shortest time between events (10ms units, 0 = no limit)
+ * @param[in] ids Event IDs the limit applies to (bit N = event ID N)
+ * @return Result code (0=success)
+ */
+uint16_t kg_cmd_system_set_event_rate(uint8_t interface, uint8_t event_class, uint8_t interval, uint16_t ids) {
+    if (interface == 0) interface = lastCommandInterfaceNum;
+    if (interface == 0 || interface > KG_INTERFACENUM_COUNT || event_class == KG_PACKET_CLASS_PROTOCOL || event_class >= KG_PACKET_CLASS_COUNT) {
+        return KG_PROTOCOL_ERROR_PARAMETER_RANGE;
+    }
+    protocol_event_filter_t *filter = &protocolEventFilter[interface - 1][event_class];
+    filter -> interval = interval;
+    filter -> rate_ids = ids;
+
+    // let the next event through straight away
+    filter -> last = (uint16_t)(keygloveTock * 100 + keygloveTick) - interval;
+    return 0; // success
+}
+
+/**
+ * @brief Get the current log level filter
+ * @param[out] level Highest log level which is logged
+ * @return Result code (0=success)
+ */
+uint16_t kg_cmd_system_get_log_level(uint8_t *level) {
+    *level = logLevel;
+    return 0; // success
+}
+
+/**
+ * @brief Set a new log level filter
+ * @param[in] level Highest log level which is logged
+ * @return Result code (0=success)
+ */
+uint16_t kg_cmd_system_set_log_level(uint8_t level) {
+    if (level > KG_LOG_LEVEL_VERBOSE) {
+        return KG_PROTOCOL_ERROR_PARAMETER_RANGE;
+    }
+    logLevel = level;
+    return 0; // success
+}
+
+/**
+ * @brief Get detailed RAM usage
+ * @param[out] free_ram Bytes between the top of the heap and the stack right now
+ * @param[out] stack_headroom Lowest headroom between the heap and the stack since boot
+ * @param[out] heap_size Bytes currently claimed by the heap, including free blocks
+ * @param[out] heap_free Bytes in free blocks inside the heap
+ * @param[out] largest_free Largest block that could be allocated right now
+ * @param[out] free_blocks Number of free blocks inside the heap (fragmentation)
+ * @return Result code (0=success)
+ */
+uint16_t kg_cmd_system_get_memory_stats(uint16_t *free_ram, uint16_t *stack_headroom, uint16_t *heap_size, uint16_t *heap_free, uint16_t *largest_free, uint8_t *free_blocks) {
+    *free_ram = memory_free_ram();
+    *stack_headroom = memory_stack_headroom();
+    memory_heap_stats(heap_size, heap_free, largest_free, free_blocks);
+    return 0; // success
+}
+
+/**
+ * @brief Get dynamic allocation counters for one subsystem
+ * @param[in] subsystem Subsystem to report on
+ * @param[out] allocations Successful malloc/realloc calls
+ * @param[out] blocks Blocks currently allocated
+ * @param[out] failures Failed malloc/realloc calls
+ * @return Result code (0=success)
+ */
+uint16_t kg_cmd_system_get_memory_allocations(uint8_t subsystem, uint32_t *allocations, uint16_t *blocks, uint16_t *failures) {
+    if (subsystem >= KG_MEMORY_SUBSYSTEM_COUNT) {
+        *allocations = 0;
+        *blocks = 0;
+        *failures = 0;
+        return KG_PROTOCOL_ERROR_PARAMETER_RANGE;
+    }
+    *allocations = memoryAllocations[subsystem];
+    *blocks = memoryBlocks[subsystem];
+    *failures = memoryFailures[subsystem];
+    return 0; // success
+}
+
+/**
+ * @brief Get the low memory threshold
+ * @param[out] threshold Low memory threshold
+ * @return Result code (0=success)
+ */
+uint16_t kg_cmd_system_get_memory_threshold(uint16_t *threshold) {
+    *threshold = memoryThreshold;
+    return 0; // success
+}
+
+/**
+ * @brief Set the low memory threshold
+ * @param[in] threshold Low memory threshold
+ * @return Result code (0=success)
+ */
+uint16_t kg_cmd_system_set_memory_threshold(uint16_t threshold) {
+    memoryThreshold = threshold;
+    memoryLowSent = false;
+    return 0; // success
+}
@@ -43,8 +43,5 @@ THE SOFTWARE.
  * LIBRARY INCLUDES FOR PROPER BUILD PROCESS
 =============================================== */
 
-#include <Wire.h>       // Core Arduino I2C hardware library
-#include <I2Cdev.h>     // I2Cdevlib device wrapper library
-#include <MPU6050.h>    // MPU-6050 I2C sensor support for I2Cdevlib
 #include <iWRAP.h>      // Bluegiga iWRAP parser library
 #include <EEPROM.h>     // Core Arduino EEPROM library
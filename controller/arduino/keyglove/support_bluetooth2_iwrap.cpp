@@ -59,6 +59,12 @@ Manual instructions for WT12 setup:
         SET CONTROL ECHO 5
         SET CONTROL BAUD 125000,8n1
 
+   If KG_HID_KEYBOARD_NKRO is enabled, use this HID descriptor instead. It is
+   identical except for an additional N-key rollover keyboard report (ID 5)
+   holding the modifier byte and a 224-bit key bitmap (usages 0x00-0xDF):
+
+        HID SET 11B 05010906A1010507850119E029E715002501750195088102950175088101950575010508850119012905910295017503910395067508150025650507190029658100C0050C0901A1018502050C1500250109E909EA09E209CD19B529B87501950881020A8A010A21020A2A021A23022A27027501950881020A83010A96010A92010A9E010A94010A060209B209B4750195088102C005010902A1010901A10085030509190129031500250195037501810295017505810305010930093109381581257F750895038106050C0A380295018106C0C006ABFF0A0002A10185047508150026FF00951009018102951009029102C005010906A1018505050719E029E7150025017501950881020507190029DF15002501750195E08102C0
+
 5. Change to 125000 baud and apply this setting:
 
         SET CONTROL MUX 1
@@ -84,6 +90,7 @@ Basic Bluetooth Functionality:
 
 //#if KG_HOSTIF & KG_HOSTIF_BT2_HID
     uint8_t bluetoothTXHIDKBPacket[12];         ///< Buffer for outgoing HID keyboard report payload
+    uint8_t bluetoothTXHIDNKROPacket[5 + BT2_HID_NKRO_BITMAP_SIZE]; ///< Buffer for outgoing HID NKRO keyboard report payload
     uint8_t bluetoothTXHIDCPPacket[7];          ///< Buffer for outgoing HID consumer page report payload
     uint8_t bluetoothTXHIDMousePacket[9];       ///< Buffer for outgoing HID mouse report payload
 //#endif
@@ -176,6 +183,25 @@ void BTKeyboardWrapper::set_key6(uint8_t code) { bluetoothTXHIDKBPacket[11] = co
  * @param[in] code Key code to use
  */
 void BTKeyboardWrapper::set_modifier(uint8_t code) { bluetoothTXHIDKBPacket[4] = code; }
+/**
+ * @brief Set the entire 8-byte boot protocol keyboard report at once
+ * @param[in] report Report data (modifiers, reserved, six key codes)
+ */
+void BTKeyboardWrapper::set_report(const uint8_t *report) { memcpy(bluetoothTXHIDKBPacket + 4, report, 8); }
+/**
+ * @brief Send an N-key rollover keyboard report (report ID 5)
+ * @param[in] modifiers Modifier key bitmask
+ * @param[in] bitmap Key state bitmap, one bit per usage code starting at 0x00
+ */
+void BTKeyboardWrapper::send_nkro(uint8_t modifiers, const uint8_t *bitmap) {
+    bluetoothTXHIDNKROPacket[4] = modifiers;
+    memcpy(bluetoothTXHIDNKROPacket + 5, bitmap, BT2_HID_NKRO_BITMAP_SIZE);
+
+    // send packet out over wireless HID interface (Bluetooth v2.1 HID)
+    if (interfaceBT2HIDReady && iwrap_connection_map[bluetoothHIDDeviceIndex] && iwrap_connection_map[bluetoothHIDDeviceIndex] -> link_hid_interrupt != 0xFF) {
+        iwrap_send_data(iwrap_connection_map[bluetoothHIDDeviceIndex] -> link_hid_interrupt, 5 + BT2_HID_NKRO_BITMAP_SIZE, (const uint8_t *)bluetoothTXHIDNKROPacket, iwrap_mode);
+    }
+}
 /**
  * @brief Send the HID report using current data
  */
@@ -267,6 +293,7 @@ void setup_hostif_bt2() {
 
     // pre-build KB/CP/mouse HID reports
     memset(bluetoothTXHIDKBPacket, 0, 12);
+    memset(bluetoothTXHIDNKROPacket, 0, 5 + BT2_HID_NKRO_BITMAP_SIZE);
     memset(bluetoothTXHIDCPPacket, 0, 7);
     memset(bluetoothTXHIDMousePacket, 0, 9);
 
@@ -276,6 +303,12 @@ void setup_hostif_bt2() {
     bluetoothTXHIDKBPacket[2] = 0xA1;
     bluetoothTXHIDKBPacket[3] = 0x01;
 
+    // NKRO keyboard (only meaningful if the NKRO descriptor has been installed)
+    bluetoothTXHIDNKROPacket[0] = 0x9F;
+    bluetoothTXHIDNKROPacket[1] = 3 + BT2_HID_NKRO_BITMAP_SIZE;
+    bluetoothTXHIDNKROPacket[2] = 0xA1;
+    bluetoothTXHIDNKROPacket[3] = 0x05;
+
     // consumer page
     bluetoothTXHIDCPPacket[0] = 0x9F;
     bluetoothTXHIDCPPacket[1] = 0x05;
@@ -349,7 +382,7 @@ uint8_t bluetooth_check_incoming_protocol_data() {
                     interfaceBT2AVRCPReady = false;
 
                     // send command to test module connectivity
-                    send_keyglove_log(KG_LOG_LEVEL_NORMAL, 30, F("Testing iWRAP communication..."));
+                    keyglove_log(KG_LOG_LEVEL_NORMAL, KG_LOG_BT2_IWRAP_TESTING);
                     iwrap_send_command("AT", iwrap_mode);
                     iwrap_state = IWRAP_STATE_PENDING_AT;
 
@@ -358,12 +391,12 @@ uint8_t bluetooth_check_incoming_protocol_data() {
                 }
             } else if (iwrap_state == IWRAP_STATE_PENDING_AT) {
                 // send command to dump all module settings and pairings
-                send_keyglove_log(KG_LOG_LEVEL_NORMAL, 25, F("Getting iWRAP settings..."));
+                keyglove_log(KG_LOG_LEVEL_NORMAL, KG_LOG_BT2_IWRAP_GET_SETTINGS);
                 iwrap_send_command("SET", iwrap_mode);
                 iwrap_state = IWRAP_STATE_PENDING_SET;
             } else if (iwrap_state == IWRAP_STATE_PENDING_SET) {
                 // send command to show all current connections
-                send_keyglove_log(KG_LOG_LEVEL_NORMAL, 33, F("Getting active connection list..."));
+                keyglove_log(KG_LOG_LEVEL_NORMAL, KG_LOG_BT2_IWRAP_GET_CONNECTIONS);
                 iwrap_send_command("LIST", iwrap_mode);
                 iwrap_state = IWRAP_STATE_PENDING_LIST;
             } else if (iwrap_state == IWRAP_STATE_PENDING_LIST) {
@@ -371,7 +404,7 @@ uint8_t bluetooth_check_incoming_protocol_data() {
                 if (!iwrap_initialized) {
                     iwrap_initialized = 1;
                     interfaceBT2Ready = true; // KGAPI status tracking
-                    send_keyglove_log(KG_LOG_LEVEL_NORMAL, 29, F("iWRAP initialization complete"));
+                    keyglove_log(KG_LOG_LEVEL_NORMAL, KG_LOG_BT2_IWRAP_READY);
                     
                     // send kg_evt_bluetooth_ready()
                     skipPacket = 0;
@@ -381,7 +414,7 @@ uint8_t bluetooth_check_incoming_protocol_data() {
                 iwrap_state = IWRAP_STATE_IDLE;
             } else if (iwrap_state == IWRAP_STATE_PENDING_CALL && !iwrap_pending_calls) {
                 // all done!
-                send_keyglove_log(KG_LOG_LEVEL_NORMAL, 22, F("Pending call processed"));
+                keyglove_log(KG_LOG_LEVEL_NORMAL, KG_LOG_BT2_CALL_PROCESSED);
                 iwrap_state = IWRAP_STATE_IDLE;
             } else if (iwrap_state == IWRAP_STATE_PENDING_SETBTPAIR) {
                 // send kg_evt_bluetooth_pairings_cleared()
@@ -419,9 +452,7 @@ uint8_t bluetooth_check_incoming_protocol_data() {
 
                     // write MAC string into call command buffer and send it
                     iwrap_bintohexstr((uint8_t *)(iwrap_connection_map[iwrap_autocall_index] -> mac.address), 6, &cptr, ':', 0);
-                    char s[21];
-                    sprintf(s, "Calling device #%d\r\n", iwrap_autocall_index);
-                    send_keyglove_log(KG_LOG_LEVEL_NORMAL, strlen(s), s);
+                    keyglove_log(KG_LOG_LEVEL_NORMAL, KG_LOG_BT2_CALLING, iwrap_autocall_index);
                     iwrap_send_command(cmd, iwrap_mode);
                     //iwrap_autocall_last_time = millis();
                     bluetoothTock = keygloveTock;
@@ -436,7 +467,7 @@ uint8_t bluetooth_check_incoming_protocol_data() {
     // check for timeout if still testing communication
     if (!iwrap_initialized && iwrap_state == IWRAP_STATE_PENDING_AT) {
         if (keygloveTock - bluetoothTock > 4) {
-            send_keyglove_log(KG_LOG_LEVEL_CRITICAL, 39, F("Could not communicate with iWRAP module"));
+            keyglove_log(KG_LOG_LEVEL_CRITICAL, KG_LOG_BT2_IWRAP_NO_RESPONSE);
             iwrap_state = IWRAP_STATE_COMM_FAILED;
             iwrap_pending_commands = 0; // normally handled by the parser, but comms failed
         }
@@ -453,19 +484,22 @@ uint8_t bluetooth_check_incoming_protocol_data() {
  * @return Result, zero for success or non-zero for error
  */
 uint8_t bluetooth_send_keyglove_packet_buffer(uint8_t *buffer, uint8_t length, uint8_t specificInterface) {
+    // log data only goes to interfaces which want it
+    uint8_t outgoingMode = (buffer[2] == KG_PACKET_CLASS_LOG ? KG_INTERFACE_MODE_OUTGOING_LOG : KG_INTERFACE_MODE_OUTGOING_API);
+
     #if KG_HOSTIF & KG_HOSTIF_BT2_SERIAL
-        if (!specificInterface || lastCommandInterfaceNum == KG_INTERFACENUM_BT2_SERIAL) {
+        if (specificInterface ? lastCommandInterfaceNum == KG_INTERFACENUM_BT2_SERIAL : protocol_event_allowed(KG_INTERFACENUM_BT2_SERIAL, buffer[2], buffer[3])) {
             // send packet out over wireless serial (Bluetooth v2.1 SPP)
-            if (interfaceBT2SerialReady && (interfaceBT2SerialMode & KG_INTERFACE_MODE_OUTGOING_API) != 0 && iwrap_connection_map[bluetoothSPPDeviceIndex] && iwrap_connection_map[bluetoothSPPDeviceIndex] -> link_spp != 0xFF) {
+            if (interfaceBT2SerialReady && (interfaceBT2SerialMode & outgoingMode) != 0 && iwrap_connection_map[bluetoothSPPDeviceIndex] && iwrap_connection_map[bluetoothSPPDeviceIndex] -> link_spp != 0xFF) {
                 iwrap_send_data(iwrap_connection_map[bluetoothSPPDeviceIndex] -> link_spp, length, (const uint8_t *)buffer, iwrap_mode);
             }
         }
     #endif
 
     #if KG_HOSTIF & KG_HOSTIF_BT2_RAWHID
-        if (!specificInterface || lastCommandInterfaceNum == KG_INTERFACENUM_BT2_RAWHID) {
+        if (specificInterface ? lastCommandInterfaceNum == KG_INTERFACENUM_BT2_RAWHID : protocol_event_allowed(KG_INTERFACENUM_BT2_RAWHID, buffer[2], buffer[3])) {
             // send packet out over wireless custom HID interface (Bluetooth v2.1 raw HID)
-            if (interfaceBT2RawHIDReady && (interfaceBT2RawHIDMode & KG_INTERFACE_MODE_OUTGOING_API) != 0 && iwrap_connection_map[bluetoothRawHIDDeviceIndex] && iwrap_connection_map[bluetoothRawHIDDeviceIndex] -> link_hid_interrupt != 0xFF) {
+            if (interfaceBT2RawHIDReady && (interfaceBT2RawHIDMode & outgoingMode) != 0 && iwrap_connection_map[bluetoothRawHIDDeviceIndex] && iwrap_connection_map[bluetoothRawHIDDeviceIndex] -> link_hid_interrupt != 0xFF) {
                 int8_t bytes;
                 for (uint8_t i = 0; i < length; i += (BT2_RAWHID_TX_SIZE - 1)) {
                     memset(bluetoothTXRawHIDPacket + 4, 0, BT2_RAWHID_TX_SIZE);
@@ -481,9 +515,9 @@ uint8_t bluetooth_send_keyglove_packet_buffer(uint8_t *buffer, uint8_t length, u
     #endif
 
     #if KG_HOSTIF & KG_HOSTIF_BT2_IAP
-        if (!specificInterface || lastCommandInterfaceNum == KG_INTERFACENUM_BT2_IAP) {
+        if (specificInterface ? lastCommandInterfaceNum == KG_INTERFACENUM_BT2_IAP : protocol_event_allowed(KG_INTERFACENUM_BT2_IAP, buffer[2], buffer[3])) {
             // send packet out over wireless iAP link (Bluetooth v2.1 IAP)
-            if (interfaceBT2IAPReady && (interfaceBT2IAPMode & KG_INTERFACE_MODE_OUTGOING_API) != 0 && iwrap_connection_map[bluetoothIAPDeviceIndex] && iwrap_connection_map[bluetoothIAPDeviceIndex] -> link_iap != 0xFF) {
+            if (interfaceBT2IAPReady && (interfaceBT2IAPMode & outgoingMode) != 0 && iwrap_connection_map[bluetoothIAPDeviceIndex] && iwrap_connection_map[bluetoothIAPDeviceIndex] -> link_iap != 0xFF) {
                 iwrap_send_data(iwrap_connection_map[bluetoothIAPDeviceIndex] -> link_iap, length, (const uint8_t *)buffer, iwrap_mode);
             }
         }
@@ -506,6 +540,7 @@ uint8_t bluetooth_send_keyglove_packet_buffer(uint8_t *buffer, uint8_t length, u
  * enabled.
  */
 void my_iwrap_callback_txcommand(uint16_t length, const uint8_t *data) {
+    if (logLevel < KG_LOG_LEVEL_VERBOSE) return;
     char s[length + 18];
     sprintf(s, "=> BT2 (FF, %d): %s", length, data);
     send_keyglove_log(KG_LOG_LEVEL_VERBOSE, strlen(s), s);
@@ -522,6 +557,7 @@ void my_iwrap_callback_txcommand(uint16_t length, const uint8_t *data) {
  * enabled.
  */
 void my_iwrap_callback_txdata(uint8_t channel, uint16_t length, const uint8_t *data) {
+    if (logLevel < KG_LOG_LEVEL_VERBOSE) return;
     char s[length + 18];
     sprintf(s, "=> BT2 (%02X, %d): %s", channel, length, data);
     send_keyglove_log(KG_LOG_LEVEL_VERBOSE, strlen(s), s);
@@ -538,6 +574,7 @@ void my_iwrap_callback_txdata(uint8_t channel, uint16_t length, const uint8_t *d
  * enabled.
  */
 void my_iwrap_callback_rxoutput(uint16_t length, const uint8_t *data) {
+    if (logLevel < KG_LOG_LEVEL_VERBOSE) return;
     char s[length + 28];
     uint8_t *p = (uint8_t *)data;
     int len = sprintf(s, "<= BT2 (FF, %d): ", length);
@@ -771,7 +808,7 @@ void my_iwrap_rsp_pair(const iwrap_address_t *mac, uint8_t result) {
 
         // make sure we allocate memory if needed
         if (iwrap_connection_map[i] == 0) {
-            iwrap_connection_map[i] = (iwrap_pairing_t *)malloc(sizeof(iwrap_pairing_t));
+            iwrap_connection_map[i] = (iwrap_pairing_t *)memory_malloc(KG_SYSTEM_MEMORY_SUBSYSTEM_BLUETOOTH, sizeof(iwrap_pairing_t));
         }
         
         // only continue if allocation succeeded
@@ -823,7 +860,7 @@ void my_iwrap_rsp_set(uint8_t category, const char *option, const char *value) {
             // rename the device if it hasn't been configured yet
             if (strcmp(value, "Keyglove") == 0) {
                 // rename device to include BT MAC address for unique name
-                char *cmdName = (char *)malloc(30);
+                char *cmdName = (char *)memory_malloc(KG_SYSTEM_MEMORY_SUBSYSTEM_BLUETOOTH, 30);
                 if (cmdName) {
                     strcpy(cmdName, "SET BT NAME Keyglove 00:00:00");
                     cmdName[21] = (iwrap_module_mac.address[3] / 0x10) + 48 + ((iwrap_module_mac.address[3] / 0x10) / 10 * 7);
@@ -833,7 +870,7 @@ void my_iwrap_rsp_set(uint8_t category, const char *option, const char *value) {
                     cmdName[27] = (iwrap_module_mac.address[5] / 0x10) + 48 + ((iwrap_module_mac.address[5] / 0x10) / 10 * 7);
                     cmdName[28] = (iwrap_module_mac.address[5] & 0x0f) + 48 + ((iwrap_module_mac.address[5] & 0x0f) / 10 * 7);
                     iwrap_send_command(cmdName, iwrap_mode);
-                    free(cmdName);
+                    memory_free(KG_SYSTEM_MEMORY_SUBSYSTEM_BLUETOOTH, cmdName);
                 } else {
                     // this should NEVER happen, but if it does, I want to know
                     uint8_t payload[2] = { KG_PROTOCOL_ERROR_NULL_POINTER & 0xFF, KG_PROTOCOL_ERROR_NULL_POINTER >> 8 };
@@ -851,7 +888,7 @@ void my_iwrap_rsp_set(uint8_t category, const char *option, const char *value) {
 
             // make sure we allocate memory for the connection map entry
             if (iwrap_connection_map[iwrap_pairings] == 0) {
-                iwrap_connection_map[iwrap_pairings] = (iwrap_pairing_t *)malloc(sizeof(iwrap_pairing_t));
+                iwrap_connection_map[iwrap_pairings] = (iwrap_pairing_t *)memory_malloc(KG_SYSTEM_MEMORY_SUBSYSTEM_BLUETOOTH, sizeof(iwrap_pairing_t));
             }
             if (iwrap_connection_map[iwrap_pairings] != 0) {
                 memset(iwrap_connection_map[iwrap_pairings], 0xFF, sizeof(iwrap_pairing_t)); // 0xFF is "no link ID"
@@ -1363,7 +1400,7 @@ uint8_t remove_mapped_connection(uint8_t link_id) {
  * @return 0 if command sent successfully, -1 (0xFF) otherwise
  */
 uint8_t set_master_role(uint8_t link_id) {
-    char *cmdRole = (char *)malloc(16);
+    char *cmdRole = (char *)memory_malloc(KG_SYSTEM_MEMORY_SUBSYSTEM_BLUETOOTH, 16);
     if (cmdRole) {
         strcpy(cmdRole, "SET 00 MASTER");
         if (link_id > 9) {
@@ -1373,7 +1410,7 @@ uint8_t set_master_role(uint8_t link_id) {
             cmdRole[5] = link_id + 48;
         }
         iwrap_send_command(cmdRole, iwrap_mode);
-        free(cmdRole);
+        memory_free(KG_SYSTEM_MEMORY_SUBSYSTEM_BLUETOOTH, cmdRole);
         return 0; // successfully sent command
     }
     return 0xFF; // could not send command (memory allocation)
@@ -1707,7 +1744,7 @@ uint16_t kg_cmd_bluetooth_delete_pairing(uint8_t pairing) {
         }
 
         // free this entry and shift any below it up one position
-        free(iwrap_connection_map[pairing]);
+        memory_free(KG_SYSTEM_MEMORY_SUBSYSTEM_BLUETOOTH, iwrap_connection_map[pairing]);
         iwrap_pairings--;
         for (uint8_t i = pairing; i < iwrap_pairings; i++) {
             iwrap_connection_map[i] = iwrap_connection_map[i + 1];
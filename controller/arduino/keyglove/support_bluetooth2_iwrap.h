@@ -100,12 +100,16 @@ typedef enum {
     KG_BLUETOOTH_MODE_MAX
 } bluetooth_mode_t;
 
+#define BT2_HID_NKRO_BITMAP_SIZE    28  ///< Bytes in NKRO keyboard report key bitmap (usage codes 0x00-0xDF, every non-modifier key)
+
 /**
  * @brief Simple wrapper for Teensy-like keyboard behavior and iWRAP raw HID report interface
  */
 class BTKeyboardWrapper {
     public:
         BTKeyboardWrapper() { };
+        void set_report(const uint8_t *report);
+        void send_nkro(uint8_t modifiers, const uint8_t *bitmap);
         void set_key1(uint8_t code);
         void set_key2(uint8_t code);
         void set_key3(uint8_t code);
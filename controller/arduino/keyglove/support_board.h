@@ -47,6 +47,8 @@ THE SOFTWARE.
     #include "support_board_teensypp2_t37.h"
 #elif KG_BOARD == KG_BOARD_TEENSYPP2_T19
     #include "support_board_teensypp2_t19.h"
+#elif KG_BOARD == KG_BOARD_LINUX_SIM
+    #include "support_board_linux_sim.h"
 //#elif KG_BOARD == KG_BOARD_ARDUINO_DUE
     //#include "support_board_arduino_due.h"
     // TODO: Arduino Due ARM chip support
@@ -0,0 +1,143 @@
+// Keyglove controller source code - Host MCU implementations specific to the Linux host simulation
+// 2014-12-14 by Jeff Rowberg <jeff@rowberg.net>
+
+/* ============================================
+Controller code is placed under the MIT license
+Copyright (c) 2014 Jeff Rowberg
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+
+/**
+ * @file support_board_linux_sim.cpp
+ * @brief Host MCU implementations specific to the Linux host simulation
+ * @author Jeff Rowberg
+ * @date 2014-12-14
+ *
+ * This file implements the simulation "board" (see controller/linux). The host
+ * drives the touch sensors by writing lines to the control channel:
+ *
+ *     touch 01000000       (raw touch status bytes in hex, same layout as the
+ *                           "touch_status" event, here A+Y touching)
+ *     touch 00000000       (nothing touching)
+ *
+ * The new state is read in update_board_touch(), in place of polling the pins,
+ * so the usual debouncing and event generation in update_touch() still apply.
+ *
+ * Normally it is not necessary to edit this file.
+ */
+
+#include "keyglove.h"
+#include "support_board_linux_sim.h"
+
+// for compiler's sake, make sure this is ACTUALLY code we need
+// (interrupt vector definition cause problems across multiple source files)
+#if KG_BOARD == KG_BOARD_LINUX_SIM
+
+#include "linux_sim.h"
+
+bool interfaceUSBSerialReady = false;   ///< Status indicator for USB serial interface
+uint8_t interfaceUSBSerialMode = 0;     ///< USB serial communication mode setting @see KG_INTERFACE_MODE_NONE, @see KG_INTERFACE_MODE_OUTGOING_API, @see KG_INTERFACE_MODE_INCOMING_API
+bool interfaceUSBRawHIDReady = false;   ///< Status indicator for USB raw HID interface
+uint8_t interfaceUSBRawHIDMode = 0;     ///< USB raw HID communication mode setting @see KG_INTERFACE_MODE_NONE, @see KG_INTERFACE_MODE_OUTGOING_API, @see KG_INTERFACE_MODE_INCOMING_API
+bool interfaceUSBHIDReady = false;      ///< Status indicator for USB HID interface
+
+uint8_t simTouches[KG_BASE_COMBINATION_BYTES];  ///< Touch status last set over the control channel
+char simControlLine[64];                        ///< Control channel line being received
+uint8_t simControlLength = 0;                   ///< Characters in simControlLine so far
+
+/**
+ * @brief Simulated timer interrupt for tracking 100Hz ticks
+ */
+ISR(TIMER1_COMPA_vect) {
+    keyglove100Hz = 1;
+}
+
+/**
+ * @brief Initialize simulated board (19-sensor arrangement)
+ *
+ * This function starts the simulated 100Hz tick interrupt and marks the
+ * pseudo-terminal USB interfaces as ready.
+ *
+ * @see setup()
+ */
+void setup_board() {
+    // 10ms interval, same as Timer1 on the real board
+    sim_set_timer(0, TIMER1_COMPA_vect, 10000);
+
+    #if KG_HOSTIF & KG_HOSTIF_USB_SERIAL
+        // start USB serial interface
+        USBSerial.begin(KG_HOSTIF_USB_SERIAL_BAUD);
+        interfaceUSBSerialReady = true;
+        interfaceUSBSerialMode = KG_APIMODE_USB_SERIAL;
+    #endif
+
+    #if KG_HOSTIF & KG_HOSTIF_USB_RAWHID
+        interfaceUSBRawHIDReady = true;
+        interfaceUSBRawHIDMode = KG_APIMODE_USB_RAWHID;
+    #endif
+}
+
+/**
+ * @brief Apply one complete line received on the control channel
+ */
+void sim_control_command(char *line) {
+    if (strncmp(line, "touch ", 6) == 0) {
+        uint8_t touches[KG_BASE_COMBINATION_BYTES];
+        memset(touches, 0, KG_BASE_COMBINATION_BYTES);
+        for (uint8_t i = 0; i < KG_BASE_COMBINATION_BYTES * 2; i++) {
+            char c = line[6 + i];
+            uint8_t nibble;
+            if (c >= '0' && c <= '9') nibble = c - '0';
+            else if (c >= 'a' && c <= 'f') nibble = c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F') nibble = c - 'A' + 10;
+            else break;
+            touches[i >> 1] |= (i & 1) ? nibble : (nibble << 4);
+        }
+        memcpy(simTouches, touches, KG_BASE_COMBINATION_BYTES);
+    }
+}
+
+/**
+ * @brief Get status of all simulated touch sensors
+ *
+ * Any pending control channel input is processed first, so a touch change is
+ * seen on the first scan after the host sends it.
+ *
+ * @see loop()
+ * @see update_touch()
+ */
+void update_board_touch(uint8_t *touches) {
+    while (SimControl.available()) {
+        int c = SimControl.read();
+        if (c < 0) break;
+        if (c == '\n' || c == '\r') {
+            simControlLine[simControlLength] = 0;
+            if (simControlLength) sim_control_command(simControlLine);
+            simControlLength = 0;
+        } else if (simControlLength < sizeof(simControlLine) - 1) {
+            simControlLine[simControlLength++] = c;
+        }
+    }
+    for (uint8_t i = 0; i < KG_BASE_COMBINATION_BYTES; i++) touches[i] |= simTouches[i];
+}
+
+#endif
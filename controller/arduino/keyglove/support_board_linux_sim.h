@@ -0,0 +1,103 @@
+// Keyglove controller source code - Host MCU declarations specific to the Linux host simulation
+// 2014-12-14 by Jeff Rowberg <jeff@rowberg.net>
+
+/* ============================================
+Controller code is placed under the MIT license
+Copyright (c) 2014 Jeff Rowberg
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+
+/**
+ * @file support_board_linux_sim.h
+ * @brief Host MCU declarations specific to the Linux host simulation
+ * @author Jeff Rowberg
+ * @date 2014-12-14
+ *
+ * This file defines the "board" used when the firmware is built as a Linux
+ * program (see controller/linux). There is no hardware: the 100Hz tick comes
+ * from a simulated timer, and touch sensor states are set by the host over the
+ * simulation's control channel. The touch sensor layout is the same as the
+ * Teensy++ v2.0 / Touch:19 board, so status data looks like the real thing.
+ *
+ * Normally it is not necessary to edit this file.
+ */
+
+#ifndef _SUPPORT_BOARD_LINUX_SIM_H_
+#define _SUPPORT_BOARD_LINUX_SIM_H_
+
+#define USBSerial Serial                    ///< USB serial interface name
+
+#define KG_HOSTIF_USB_SERIAL_BAUD 115200    ///< USB serial interface baud rate (ignored)
+
+// sensor count and base combination count
+#define KG_TOTAL_SENSORS 19                 ///< Total sensor count with most efficient pin configuration
+#define KG_BASE_COMBINATIONS 25             ///< Number of physically reasonable 1-to-1 touch combinations
+#define KG_BASE_COMBINATION_BYTES 4         ///< Number of bytes required to store all touch status bits
+
+// NOTE: KG_BASE_COMBINATIONS seems like it would be very high, but there are
+// physical and practical limitations that make this number much smaller
+
+#define KGT_AY(test) (test[0] & 0x01)
+#define KGT_BY(test) (test[0] & 0x02)
+#define KGT_CY(test) (test[0] & 0x04)
+#define KGT_DY(test) (test[0] & 0x08)
+#define KGT_EY(test) (test[0] & 0x10)
+#define KGT_FY(test) (test[0] & 0x20)
+#define KGT_GY(test) (test[0] & 0x40)
+#define KGT_HY(test) (test[0] & 0x80)
+#define KGT_IY(test) (test[1] & 0x01)
+#define KGT_JY(test) (test[1] & 0x02)
+#define KGT_KY(test) (test[1] & 0x04)
+#define KGT_LY(test) (test[1] & 0x08)
+#define KGT_A1(test) (test[1] & 0x10)
+#define KGT_D1(test) (test[1] & 0x20)
+#define KGT_G1(test) (test[1] & 0x40)
+#define KGT_J1(test) (test[1] & 0x80)
+#define KGT_Y4(test) (test[2] & 0x01)
+#define KGT_Y5(test) (test[2] & 0x02)
+#define KGT_Y6(test) (test[2] & 0x04)
+#define KGT_Y7(test) (test[2] & 0x08)
+#define KGT_A8(test) (test[2] & 0x10)
+#define KGT_D8(test) (test[2] & 0x20)
+#define KGT_G8(test) (test[2] & 0x40)
+#define KGT_J8(test) (test[2] & 0x80)
+#define KGT_Y1(test) (test[3] & 0x01)
+
+#define KGT_ADY (KGT_AY && KGT_DY)
+#define KGT_AJY (KGT_AY && KGT_JY)
+#define KGT_DGY (KGT_DY && KGT_GY)
+#define KGT_GJY (KGT_GY && KGT_JY)
+
+#define CLR(x, y) (x &= (~(1 << y)))    ///< Bit-clearing macro for port/pin combination
+#define SET(x, y) (x |= (1 << y))       ///< Bit-setting macro for port/pin combination
+#define _BV(bit) (1 << (bit))           ///< Bit-value calculation macro for lazy people
+
+extern bool interfaceUSBSerialReady;
+extern uint8_t interfaceUSBSerialMode;
+extern bool interfaceUSBRawHIDReady;
+extern uint8_t interfaceUSBRawHIDMode;
+extern bool interfaceUSBHIDReady;
+
+void setup_board();
+void update_board_touch(uint8_t *touches);
+
+#endif // _SUPPORT_BOARD_LINUX_SIM_H_
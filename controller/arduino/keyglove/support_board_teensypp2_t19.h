@@ -58,11 +58,25 @@ THE SOFTWARE.
 #define KG_PIN_BT2_RTS              4       ///< PD4
 
 #define KG_PIN_BLINK                6       ///< PD6
-#define KG_PIN_PIEZO                24      ///< PB4
+#define KG_PIN_PIEZO                24      ///< PB4 (OC2A)
 #define KG_PIN_VIBRATE              23      ///< PB3
-#define KG_PIN_RGB_RED              14      ///< PC4
-#define KG_PIN_RGB_GREEN            15      ///< PC5
-#define KG_PIN_RGB_BLUE             16      ///< PC6
+#define KG_PIN_RGB_RED              14      ///< PC4 (OC3C)
+#define KG_PIN_RGB_GREEN            15      ///< PC5 (OC3B)
+#define KG_PIN_RGB_BLUE             16      ///< PC6 (OC3A)
+
+#define KG_PWM_PIEZO_ENABLE         (1 << COM2A0)   ///< Timer2 toggle-on-compare bit for piezo pin
+#define KG_PWM_RGB_RED              OCR3C           ///< Timer3 compare register for red pin
+#define KG_PWM_RGB_GREEN            OCR3B           ///< Timer3 compare register for green pin
+#define KG_PWM_RGB_BLUE             OCR3A           ///< Timer3 compare register for blue pin
+#define KG_PWM_RGB_RED_ENABLE       (1 << COM3C1)   ///< Timer3 non-inverting PWM bit for red pin
+#define KG_PWM_RGB_GREEN_ENABLE     (1 << COM3B1)   ///< Timer3 non-inverting PWM bit for green pin
+#define KG_PWM_RGB_BLUE_ENABLE      (1 << COM3A1)   ///< Timer3 non-inverting PWM bit for blue pin
+
+// NOTE: port F is also used for touch sensors on this board, so flex or
+// pressure sensors need those touch sensors rewired elsewhere before KG_FLEX
+// or KG_PRESSURE can be enabled
+#define KG_FLEX_ADC_CHANNELS        1, 2, 3, 5, 6       ///< PF1, PF2, PF3, PF5, PF6 (ADC1-3, ADC5-6), thumb to pinky
+#define KG_PRESSURE_ADC_CHANNELS    1, 2, 3, 5, 6       ///< Same pins as flex sensors, since only one set fits the eight ADC inputs
 
 // ======================== END PIN DEFINITIONS ========================
 
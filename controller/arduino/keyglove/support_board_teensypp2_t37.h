@@ -57,6 +57,12 @@ THE SOFTWARE.
 
 #define KG_PIN_BLINK                6       ///< PD6
 
+// NOTE: port F is also used for touch sensors on this board, so flex or
+// pressure sensors need those touch sensors rewired elsewhere before KG_FLEX
+// or KG_PRESSURE can be enabled
+#define KG_FLEX_ADC_CHANNELS        0, 1, 2, 3, 4       ///< PF0-PF4 (ADC0-4), thumb to pinky
+#define KG_PRESSURE_ADC_CHANNELS    0, 1, 2, 3, 4       ///< Same pins as flex sensors, since only one set fits the eight ADC inputs
+
 // ======================== END PIN DEFINITIONS ========================
 
 // sensor count and base combination count
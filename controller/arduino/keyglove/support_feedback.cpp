@@ -38,8 +38,237 @@ THE SOFTWARE.
  */
 
 #include "keyglove.h"
+#include "support_protocol.h"
 #include "support_feedback.h"
 
+/* Built-in patterns. Each segment is (level, duration in 10ms ticks, flags).
+ * Patterns 0-23 match the RGB mode values one-to-one, and patterns 0-11 match
+ * the blink mode values; the vibrate and piezo modes map onto the same set. */
+const uint8_t feedbackPatternOff[] PROGMEM          = { KG_FEEDBACK_HOLD(0) };
+const uint8_t feedbackPatternSolid[] PROGMEM        = { KG_FEEDBACK_HOLD(255) };
+const uint8_t feedbackPatternB200_100[] PROGMEM     = { KG_FEEDBACK_STEP(255, 10), KG_FEEDBACK_STEP(0, 10), KG_FEEDBACK_LOOP };
+const uint8_t feedbackPatternB200_50[] PROGMEM      = { KG_FEEDBACK_STEP(255, 5), KG_FEEDBACK_STEP(0, 15), KG_FEEDBACK_LOOP };
+const uint8_t feedbackPatternB1000_500[] PROGMEM    = { KG_FEEDBACK_STEP(255, 50), KG_FEEDBACK_STEP(0, 50), KG_FEEDBACK_LOOP };
+const uint8_t feedbackPatternB1000_100[] PROGMEM    = { KG_FEEDBACK_STEP(255, 10), KG_FEEDBACK_STEP(0, 90), KG_FEEDBACK_LOOP };
+const uint8_t feedbackPatternB1000_100_2X[] PROGMEM = { KG_FEEDBACK_STEP(255, 10), KG_FEEDBACK_STEP(0, 10), KG_FEEDBACK_STEP(255, 10), KG_FEEDBACK_STEP(0, 70), KG_FEEDBACK_LOOP };
+const uint8_t feedbackPatternB1000_100_3X[] PROGMEM = { KG_FEEDBACK_STEP(255, 10), KG_FEEDBACK_STEP(0, 10), KG_FEEDBACK_STEP(255, 10), KG_FEEDBACK_STEP(0, 10), KG_FEEDBACK_STEP(255, 10), KG_FEEDBACK_STEP(0, 50), KG_FEEDBACK_LOOP };
+const uint8_t feedbackPatternB3000_1000[] PROGMEM   = { KG_FEEDBACK_STEP(255, 100), KG_FEEDBACK_STEP(0, 200), KG_FEEDBACK_LOOP };
+const uint8_t feedbackPatternB3000_100[] PROGMEM    = { KG_FEEDBACK_STEP(255, 10), KG_FEEDBACK_STEP(0, 145), KG_FEEDBACK_STEP(0, 145), KG_FEEDBACK_LOOP };
+const uint8_t feedbackPatternB3000_100_2X[] PROGMEM = { KG_FEEDBACK_STEP(255, 10), KG_FEEDBACK_STEP(0, 10), KG_FEEDBACK_STEP(255, 10), KG_FEEDBACK_STEP(0, 135), KG_FEEDBACK_STEP(0, 135), KG_FEEDBACK_LOOP };
+const uint8_t feedbackPatternB3000_100_3X[] PROGMEM = { KG_FEEDBACK_STEP(255, 10), KG_FEEDBACK_STEP(0, 10), KG_FEEDBACK_STEP(255, 10), KG_FEEDBACK_STEP(0, 10), KG_FEEDBACK_STEP(255, 10), KG_FEEDBACK_STEP(0, 250), KG_FEEDBACK_LOOP };
+const uint8_t feedbackPatternF200_100[] PROGMEM     = { KG_FEEDBACK_RAMP(255, 5), KG_FEEDBACK_RAMP(0, 5), KG_FEEDBACK_STEP(0, 10), KG_FEEDBACK_LOOP };
+const uint8_t feedbackPatternF200_50[] PROGMEM      = { KG_FEEDBACK_RAMP(255, 3), KG_FEEDBACK_RAMP(0, 2), KG_FEEDBACK_STEP(0, 15), KG_FEEDBACK_LOOP };
+const uint8_t feedbackPatternF1000_1000[] PROGMEM   = { KG_FEEDBACK_RAMP(255, 50), KG_FEEDBACK_RAMP(0, 50), KG_FEEDBACK_LOOP };
+const uint8_t feedbackPatternF1000_500[] PROGMEM    = { KG_FEEDBACK_RAMP(255, 25), KG_FEEDBACK_RAMP(0, 25), KG_FEEDBACK_STEP(0, 50), KG_FEEDBACK_LOOP };
+const uint8_t feedbackPatternF1000_100[] PROGMEM    = { KG_FEEDBACK_RAMP(255, 5), KG_FEEDBACK_RAMP(0, 5), KG_FEEDBACK_STEP(0, 90), KG_FEEDBACK_LOOP };
+const uint8_t feedbackPatternF1000_100_2X[] PROGMEM = { KG_FEEDBACK_RAMP(255, 5), KG_FEEDBACK_RAMP(0, 5), KG_FEEDBACK_STEP(0, 10), KG_FEEDBACK_RAMP(255, 5), KG_FEEDBACK_RAMP(0, 5), KG_FEEDBACK_STEP(0, 70), KG_FEEDBACK_LOOP };
+const uint8_t feedbackPatternF1000_100_3X[] PROGMEM = { KG_FEEDBACK_RAMP(255, 5), KG_FEEDBACK_RAMP(0, 5), KG_FEEDBACK_STEP(0, 10), KG_FEEDBACK_RAMP(255, 5), KG_FEEDBACK_RAMP(0, 5), KG_FEEDBACK_STEP(0, 10), KG_FEEDBACK_RAMP(255, 5), KG_FEEDBACK_RAMP(0, 5), KG_FEEDBACK_STEP(0, 50), KG_FEEDBACK_LOOP };
+const uint8_t feedbackPatternF3000_3000[] PROGMEM   = { KG_FEEDBACK_RAMP(255, 150), KG_FEEDBACK_RAMP(0, 150), KG_FEEDBACK_LOOP };
+const uint8_t feedbackPatternF3000_1000[] PROGMEM   = { KG_FEEDBACK_RAMP(255, 50), KG_FEEDBACK_RAMP(0, 50), KG_FEEDBACK_STEP(0, 200), KG_FEEDBACK_LOOP };
+const uint8_t feedbackPatternF3000_100[] PROGMEM    = { KG_FEEDBACK_RAMP(255, 5), KG_FEEDBACK_RAMP(0, 5), KG_FEEDBACK_STEP(0, 145), KG_FEEDBACK_STEP(0, 145), KG_FEEDBACK_LOOP };
+const uint8_t feedbackPatternF3000_100_2X[] PROGMEM = { KG_FEEDBACK_RAMP(255, 5), KG_FEEDBACK_RAMP(0, 5), KG_FEEDBACK_STEP(0, 10), KG_FEEDBACK_RAMP(255, 5), KG_FEEDBACK_RAMP(0, 5), KG_FEEDBACK_STEP(0, 135), KG_FEEDBACK_STEP(0, 135), KG_FEEDBACK_LOOP };
+const uint8_t feedbackPatternF3000_100_3X[] PROGMEM = { KG_FEEDBACK_RAMP(255, 5), KG_FEEDBACK_RAMP(0, 5), KG_FEEDBACK_STEP(0, 10), KG_FEEDBACK_RAMP(255, 5), KG_FEEDBACK_RAMP(0, 5), KG_FEEDBACK_STEP(0, 10), KG_FEEDBACK_RAMP(255, 5), KG_FEEDBACK_RAMP(0, 5), KG_FEEDBACK_STEP(0, 250), KG_FEEDBACK_LOOP };
+const uint8_t feedbackPatternB1000_250[] PROGMEM    = { KG_FEEDBACK_STEP(255, 25), KG_FEEDBACK_STEP(0, 75), KG_FEEDBACK_LOOP };
+const uint8_t feedbackPatternB100_50[] PROGMEM      = { KG_FEEDBACK_STEP(255, 5), KG_FEEDBACK_STEP(0, 5), KG_FEEDBACK_LOOP };
+const uint8_t feedbackPatternB100_20[] PROGMEM      = { KG_FEEDBACK_STEP(255, 2), KG_FEEDBACK_STEP(0, 8), KG_FEEDBACK_LOOP };
+
+/**
+ * @brief Built-in pattern table, indexed by pattern ID
+ */
+const uint8_t * const feedbackPatterns[] PROGMEM = {
+    feedbackPatternOff,             // 0
+    feedbackPatternSolid,           // 1
+    feedbackPatternB200_100,        // 2
+    feedbackPatternB200_50,         // 3
+    feedbackPatternB1000_500,       // 4
+    feedbackPatternB1000_100,       // 5
+    feedbackPatternB1000_100_2X,    // 6
+    feedbackPatternB1000_100_3X,    // 7
+    feedbackPatternB3000_1000,      // 8
+    feedbackPatternB3000_100,       // 9
+    feedbackPatternB3000_100_2X,    // 10
+    feedbackPatternB3000_100_3X,    // 11
+    feedbackPatternF200_100,        // 12
+    feedbackPatternF200_50,         // 13
+    feedbackPatternF1000_1000,      // 14
+    feedbackPatternF1000_500,       // 15
+    feedbackPatternF1000_100,       // 16
+    feedbackPatternF1000_100_2X,    // 17
+    feedbackPatternF1000_100_3X,    // 18
+    feedbackPatternF3000_3000,      // 19
+    feedbackPatternF3000_1000,      // 20
+    feedbackPatternF3000_100,       // 21
+    feedbackPatternF3000_100_2X,    // 22
+    feedbackPatternF3000_100_3X,    // 23
+    feedbackPatternB1000_250,       // 24
+    feedbackPatternB100_50,         // 25
+    feedbackPatternB100_20          // 26
+};
+
+#define KG_FEEDBACK_PATTERNS (sizeof(feedbackPatterns) / sizeof(feedbackPatterns[0]))
+
+uint8_t feedbackCustomPattern[KG_FEEDBACK_CUSTOM_PATTERNS][(KG_FEEDBACK_CUSTOM_SEGMENTS + 1) * 3];  ///< Custom pattern segment data (RAM)
+feedback_pattern_state_t feedbackOutput[KG_FEEDBACK_OUTPUT_MAX];    ///< Pattern playback state for each feedback output
+
+/**
+ * @brief Output timer overflow interrupt, runs all feedback outputs at KG_FEEDBACK_ISR_HZ
+ */
+ISR(TIMER3_OVF_vect) {
+    #if (KG_FEEDBACK & KG_FEEDBACK_BLINK)
+        update_feedback_blink();
+    #endif
+    #if (KG_FEEDBACK & KG_FEEDBACK_RGB)
+        update_feedback_rgb();
+    #endif
+    #if (KG_FEEDBACK & KG_FEEDBACK_PIEZO)
+        update_feedback_piezo();
+    #endif
+    #if (KG_FEEDBACK & KG_FEEDBACK_VIBRATE)
+        update_feedback_vibrate();
+    #endif
+}
+
+/**
+ * @brief Initialize shared feedback output timer
+ *
+ * Timer3 runs in fast PWM mode with TOP=ICR3, which gives both the hardware
+ * PWM carrier for the RGB channels (OC3A/B/C) and the overflow interrupt that
+ * steps every feedback pattern. Nothing in the main loop touches feedback
+ * output after this, so patterns keep exact timing no matter how busy the
+ * loop gets. This must be called before any individual feedback module setup.
+ */
+void setup_feedback() {
+    // set up Timer3
+    //   WGM33:0 = 1110 --> fast PWM, TOP=ICR3
+    //   CS32:0 = 010 --> clk/8 prescaler (1MHz @ 8MHz, so 1kHz overflow with TOP=999)
+    //   COM3x1:0 = 00 --> outputs disconnected until enabled by RGB module
+    TCCR3A = (1 << WGM31);
+    TCCR3B = (1 << WGM33) | (1 << WGM32) | (1 << CS31);
+    ICR3 = KG_FEEDBACK_PWM_TOP;
+    TCNT3 = 0;
+    TIMSK3 |= (1 << TOIE3); // enable TIMER3 overflow interrupt
+}
+
+/**
+ * @brief Check whether a pattern ID refers to a built-in or custom pattern
+ * @param[in] pattern Pattern ID
+ * @return Non-zero if pattern exists
+ */
+uint8_t feedback_pattern_valid(uint8_t pattern) {
+    return pattern < KG_FEEDBACK_PATTERNS || (pattern >= KG_FEEDBACK_PATTERN_CUSTOM && pattern < KG_FEEDBACK_PATTERN_CUSTOM + KG_FEEDBACK_CUSTOM_PATTERNS);
+}
+
+/**
+ * @brief Read one byte of the pattern running on an output
+ * @param[in] state Pattern playback state
+ * @param[in] offset Byte offset within pattern
+ * @return Pattern data byte
+ */
+uint8_t feedback_pattern_read(feedback_pattern_state_t *state, uint8_t offset) {
+    if (state->pattern >= KG_FEEDBACK_PATTERN_CUSTOM) return state->segments[offset];
+    return pgm_read_byte(state->segments + offset);
+}
+
+/**
+ * @brief Start a pattern on a feedback output
+ * @param[in] output Feedback output
+ * @param[in] pattern Pattern ID (must be valid)
+ * @param[in] duration Duration in 10ms units to run pattern before it expires (0 to run forever)
+ *
+ * The pattern begins on the next output timer interrupt. This is safe to call
+ * from the main loop while the output timer is running.
+ */
+void feedback_pattern_start(feedback_output_t output, uint8_t pattern, uint8_t duration) {
+    feedback_pattern_state_t *state = &feedbackOutput[output];
+    uint8_t sreg = SREG;
+    cli();
+    if (pattern >= KG_FEEDBACK_PATTERN_CUSTOM) {
+        state->segments = feedbackCustomPattern[pattern - KG_FEEDBACK_PATTERN_CUSTOM];
+    } else {
+        state->segments = (const uint8_t *)pgm_read_word(feedbackPatterns + pattern);
+    }
+    state->pattern = pattern;
+    state->pos = 0;
+    state->tick = 0;
+    state->sub = 0;
+    state->ramp = (uint16_t)state->level << 8;
+    state->slope = 0;
+    state->duration = duration;
+    state->remaining = duration;
+    SREG = sreg;
+}
+
+/**
+ * @brief Advance the pattern on a feedback output by one output timer interrupt
+ * @param[in] output Feedback output
+ * @return Bitmask of KG_FEEDBACK_PATTERN_CHANGED and KG_FEEDBACK_PATTERN_EXPIRED
+ *
+ * Segment advance and expiry happen once per 10ms tick; in between, the only
+ * work is adding the ramp slope, so fades move in 1ms steps without any
+ * division in the interrupt. The slope is worked out once when a ramp segment
+ * begins. The new level is left in feedbackOutput[output].level for the
+ * caller to apply.
+ */
+uint8_t feedback_pattern_step(feedback_output_t output) {
+    feedback_pattern_state_t *state = &feedbackOutput[output];
+    uint8_t result = 0;
+
+    if (state->sub == 0) {
+        uint8_t level = feedback_pattern_read(state, state->pos);
+        uint8_t duration = feedback_pattern_read(state, state->pos + 1);
+
+        if (duration && state->tick >= duration) {
+            // current segment finished, land exactly on its level and move on to the next one
+            state->ramp = (uint16_t)level << 8;
+            state->pos += 3;
+            state->tick = 0;
+            level = feedback_pattern_read(state, state->pos);
+            duration = feedback_pattern_read(state, state->pos + 1);
+        }
+        if (!duration && state->pos && (feedback_pattern_read(state, state->pos + 2) & KG_FEEDBACK_SEGMENT_LOOP)) {
+            // end of a looping pattern, start over
+            state->pos = 0;
+            level = feedback_pattern_read(state, 0);
+            duration = feedback_pattern_read(state, 1);
+        }
+
+        if (state->tick == 0) {
+            // new segment: either jump to its level or work out the per-interrupt ramp slope
+            if (duration && (feedback_pattern_read(state, state->pos + 2) & KG_FEEDBACK_SEGMENT_RAMP)) {
+                state->slope = ((int32_t)((uint16_t)level << 8) - state->ramp) / (int16_t)(duration * KG_FEEDBACK_ISR_TICKS);
+            } else {
+                state->ramp = (uint16_t)level << 8;
+                state->slope = 0;
+            }
+        }
+        if (duration) state->tick++;
+        if (state->remaining && --state->remaining == 0) result |= KG_FEEDBACK_PATTERN_EXPIRED;
+    }
+    if (++state->sub == KG_FEEDBACK_ISR_TICKS) state->sub = 0;
+
+    // truncated slope always falls slightly short, so this never wraps
+    state->ramp += state->slope;
+    if ((state->ramp >> 8) != state->level) {
+        state->level = state->ramp >> 8;
+        result |= KG_FEEDBACK_PATTERN_CHANGED;
+    }
+    return result;
+}
+
+/**
+ * @brief Find the device mode that corresponds to a pattern
+ * @param[in] map Pattern ID for each mode of a device (program memory)
+ * @param[in] count Number of modes in map
+ * @param[in] pattern Pattern ID to look up
+ * @return Matching mode, or 0xFF if the pattern is not one of the device modes
+ */
+uint8_t feedback_pattern_mode(const uint8_t *map, uint8_t count, uint8_t pattern) {
+    for (uint8_t mode = 0; mode < count; mode++) {
+        if (pgm_read_byte(map + mode) == pattern) return mode;
+    }
+    return 0xFF;
+}
+
 // for people who don't want to waste lots of hours: "%" != "mod" ...
 
 /**
@@ -92,3 +321,83 @@ uint8_t square_wave(int32_t x, int32_t period, uint8_t duty) {
 int16_t triangle_wave(int32_t x, int32_t period, int32_t amplitude) {
     return abs((amplitude * mod(x - (period >> 2), period) / (period >> 1)) - amplitude) - (amplitude >> 1);
 }
+
+/* ============================= */
+/* KGAPI COMMAND IMPLEMENTATIONS */
+/* ============================= */
+
+/**
+ * @brief Store a custom feedback pattern
+ * @param[in] index Custom pattern slot to store
+ * @param[in] segments_len Length in bytes of segments_data buffer
+ * @param[in] segments_data Pattern segment data
+ * @return Result code (0=success)
+ */
+uint16_t kg_cmd_feedback_set_custom_pattern(uint8_t index, uint8_t segments_len, uint8_t *segments_data) {
+    if (index >= KG_FEEDBACK_CUSTOM_PATTERNS || segments_len % 3 != 0 || segments_len > sizeof(feedbackCustomPattern[0])) {
+        return KG_PROTOCOL_ERROR_PARAMETER_RANGE;
+    }
+
+    // make sure the pattern ends, holding the output off if no end was given
+    uint8_t i;
+    for (i = 0; i < segments_len && segments_data[i + 1] != 0; i += 3);
+    if (i == segments_len && i == sizeof(feedbackCustomPattern[0])) return KG_PROTOCOL_ERROR_PARAMETER_RANGE;
+
+    // the output timer interrupt may be reading this slot, so hold it off until everything is consistent
+    uint8_t *pattern = feedbackCustomPattern[index];
+    uint8_t sreg = SREG;
+    cli();
+    memcpy(pattern, segments_data, segments_len);
+    if (i == segments_len) pattern[i] = pattern[i + 1] = pattern[i + 2] = 0;
+
+    // restart any output already running this pattern, since its position may no longer be valid
+    for (i = 0; i < KG_FEEDBACK_OUTPUT_MAX; i++) {
+        if (feedbackOutput[i].pattern == KG_FEEDBACK_PATTERN_CUSTOM + index) {
+            feedback_pattern_start((feedback_output_t)i, feedbackOutput[i].pattern, feedbackOutput[i].duration);
+        }
+    }
+    SREG = sreg;
+    return 0; // success
+}
+
+/**
+ * @brief Run a feedback pattern on one feedback output
+ * @param[in] output Feedback output to control
+ * @param[in] pattern Pattern to run
+ * @param[in] duration Duration to run pattern before turning output off (0 to run forever)
+ * @return Result code (0=success)
+ */
+uint16_t kg_cmd_feedback_play_pattern(uint8_t output, uint8_t pattern, uint8_t duration) {
+    if (!feedback_pattern_valid(pattern)) {
+        return KG_PROTOCOL_ERROR_PARAMETER_RANGE;
+    }
+    switch (output) {
+        #if KG_FEEDBACK & KG_FEEDBACK_BLINK
+            case KG_FEEDBACK_OUTPUT_BLINK:
+        #endif
+        #if KG_FEEDBACK & KG_FEEDBACK_PIEZO
+            case KG_FEEDBACK_OUTPUT_PIEZO:
+        #endif
+        #if KG_FEEDBACK & KG_FEEDBACK_VIBRATE
+            case KG_FEEDBACK_OUTPUT_VIBRATE:
+        #endif
+        #if KG_FEEDBACK & KG_FEEDBACK_RGB
+            case KG_FEEDBACK_OUTPUT_RGB_RED:
+            case KG_FEEDBACK_OUTPUT_RGB_GREEN:
+            case KG_FEEDBACK_OUTPUT_RGB_BLUE:
+        #endif
+            break;
+        default:
+            return KG_PROTOCOL_ERROR_PARAMETER_RANGE;
+    }
+    feedback_pattern_start((feedback_output_t)output, pattern, duration);
+
+    // send kg_evt_feedback_pattern packet (if we aren't setting it from an API command)
+    if (!inBinPacket) {
+        uint8_t payload[3] = { output, pattern, duration };
+        skipPacket = 0;
+        if (kg_evt_feedback_pattern) skipPacket = kg_evt_feedback_pattern(output, pattern, duration);
+        if (!skipPacket) send_keyglove_packet(KG_PACKET_TYPE_EVENT, 3, KG_PACKET_CLASS_FEEDBACK, KG_PACKET_ID_EVT_FEEDBACK_PATTERN, payload);
+    }
+    return 0; // success
+}
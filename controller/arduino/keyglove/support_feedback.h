@@ -56,6 +56,63 @@ THE SOFTWARE.
     #include "support_feedback_rgb.h"
 #endif
 
+#define KG_FEEDBACK_PWM_TOP                 999     ///< Output timer counts per PWM period (gamma table range)
+#define KG_FEEDBACK_ISR_HZ                  (F_CPU / 8 / (KG_FEEDBACK_PWM_TOP + 1))        ///< Output timer interrupt rate (1kHz at 8MHz)
+#define KG_FEEDBACK_ISR_TICKS               (KG_FEEDBACK_ISR_HZ / 100)                      ///< Output timer interrupts per 10ms pattern tick
+
+#define KG_FEEDBACK_SEGMENT_RAMP            0x01    ///< Segment flag: ramp linearly from previous level instead of stepping
+#define KG_FEEDBACK_SEGMENT_LOOP            0x02    ///< End segment flag: restart pattern from first segment
+
+#define KG_FEEDBACK_STEP(level, ticks)      (level), (ticks), 0                             ///< Pattern segment: go straight to level and hold it
+#define KG_FEEDBACK_RAMP(level, ticks)      (level), (ticks), KG_FEEDBACK_SEGMENT_RAMP      ///< Pattern segment: fade to level over duration
+#define KG_FEEDBACK_HOLD(level)             (level), 0, 0                                   ///< Pattern end: hold level forever
+#define KG_FEEDBACK_LOOP                    0, 0, KG_FEEDBACK_SEGMENT_LOOP                  ///< Pattern end: restart from first segment
+
+#define KG_FEEDBACK_PATTERN_CUSTOM          0x80    ///< First custom (RAM) pattern ID
+#define KG_FEEDBACK_CUSTOM_PATTERNS         4       ///< Number of custom pattern slots
+#define KG_FEEDBACK_CUSTOM_SEGMENTS         16      ///< Maximum segments per custom pattern (not including end)
+
+#define KG_FEEDBACK_PATTERN_CHANGED         0x01    ///< feedback_pattern_step() result: output level changed
+#define KG_FEEDBACK_PATTERN_EXPIRED         0x02    ///< feedback_pattern_step() result: pattern duration has elapsed
+
+/**
+ * @brief List of feedback outputs which can run patterns
+ */
+typedef enum {
+    KG_FEEDBACK_OUTPUT_BLINK = 0,   ///< (0) Single LED
+    KG_FEEDBACK_OUTPUT_PIEZO,       ///< (1) Piezo buzzer
+    KG_FEEDBACK_OUTPUT_VIBRATE,     ///< (2) Vibration motor
+    KG_FEEDBACK_OUTPUT_RGB_RED,     ///< (3) RGB LED red channel
+    KG_FEEDBACK_OUTPUT_RGB_GREEN,   ///< (4) RGB LED green channel
+    KG_FEEDBACK_OUTPUT_RGB_BLUE,    ///< (5) RGB LED blue channel
+    KG_FEEDBACK_OUTPUT_MAX
+} feedback_output_t;
+
+/**
+ * @brief Pattern playback state for one feedback output
+ */
+typedef struct {
+    const uint8_t *segments;        ///< Pattern segment data (program memory, or RAM for custom patterns)
+    uint8_t pattern;                ///< Pattern ID
+    uint8_t pos;                    ///< Byte offset of current segment
+    uint8_t tick;                   ///< 10ms ticks elapsed in current segment
+    uint8_t sub;                    ///< Output timer interrupts elapsed in current 10ms tick
+    uint16_t ramp;                  ///< Current level in 8.8 fixed point
+    int16_t slope;                  ///< Ramp increment per output timer interrupt in 8.8 fixed point
+    uint8_t level;                  ///< Current output level
+    uint8_t duration;               ///< Requested pattern duration in 10ms ticks (0 = forever)
+    uint8_t remaining;              ///< 10ms ticks left before pattern expires
+} feedback_pattern_state_t;
+
+extern feedback_pattern_state_t feedbackOutput[KG_FEEDBACK_OUTPUT_MAX];
+
+void setup_feedback();
+
+uint8_t feedback_pattern_valid(uint8_t pattern);
+void feedback_pattern_start(feedback_output_t output, uint8_t pattern, uint8_t duration);
+uint8_t feedback_pattern_step(feedback_output_t output);
+uint8_t feedback_pattern_mode(const uint8_t *map, uint8_t count, uint8_t pattern);
+
 int16_t mod(int16_t x, int16_t m);
 uint8_t square_wave(int32_t x, int32_t period, uint8_t duty);
 int16_t triangle_wave(int32_t x, int32_t period, int32_t amplitude);
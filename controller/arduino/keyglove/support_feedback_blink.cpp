@@ -46,10 +46,6 @@ THE SOFTWARE.
 #include "support_feedback.h"
 //#include "support_feedback_blink.h"     // <-- included by support_feedback.h
 
-feedback_blink_mode_t feedbackBlinkMode;    ///< LED blink mode
-uint8_t feedbackBlinkTick;                  ///< LED blink tick reference
-uint8_t feedbackBlinkLoop;                  ///< Tick loop length for LED blink timing
-
 /**
  * @brief Sets LED feedpack pin logic state
  * @param[in] logic Zero for low (off), non-zero for high (on)
@@ -63,28 +59,11 @@ void feedback_set_blink_logic(uint8_t logic) {
 /**
  * @brief Sets LED feedback mode
  * @param[in] mode New LED mode to set
+ *
+ * Blink modes use built-in feedback patterns with the same values.
  */
 void feedback_set_blink_mode(feedback_blink_mode_t mode) {
-    feedbackBlinkMode = mode;
-    feedbackBlinkTick = 0;
-    feedbackBlinkLoop = 0;
-
-    // logic: mode=0 -> off, mode=5 -> on, else no immediate change
-    if (feedbackBlinkMode == KG_BLINK_MODE_OFF) feedback_set_blink_logic(0);
-    else if (feedbackBlinkMode == KG_BLINK_MODE_SOLID) feedback_set_blink_logic(1);
-    else if (feedbackBlinkMode == KG_BLINK_MODE_B200_100 ||
-             feedbackBlinkMode == KG_BLINK_MODE_B200_50
-            ) feedbackBlinkLoop = 4;
-    else if (feedbackBlinkMode == KG_BLINK_MODE_B1000_500 ||
-             feedbackBlinkMode == KG_BLINK_MODE_B1000_100 ||
-             feedbackBlinkMode == KG_BLINK_MODE_B1000_100_2X ||
-             feedbackBlinkMode == KG_BLINK_MODE_B1000_100_3X
-            ) feedbackBlinkLoop = 20;
-    else if (feedbackBlinkMode == KG_BLINK_MODE_B3000_1000 ||
-             feedbackBlinkMode == KG_BLINK_MODE_B3000_100 ||
-             feedbackBlinkMode == KG_BLINK_MODE_B3000_100_2X ||
-             feedbackBlinkMode == KG_BLINK_MODE_B3000_100_3X
-            ) feedbackBlinkLoop = 60;
+    feedback_pattern_start(KG_FEEDBACK_OUTPUT_BLINK, mode, 0);
 }
 
 /**
@@ -93,39 +72,25 @@ void feedback_set_blink_mode(feedback_blink_mode_t mode) {
 void setup_feedback_blink() {
     pinMode(KG_PIN_BLINK, OUTPUT);
     digitalWrite(KG_PIN_BLINK, LOW);
-    feedbackBlinkMode = KG_BLINK_MODE_OFF;
-    feedbackBlinkTick = 0;
+    feedbackOutput[KG_FEEDBACK_OUTPUT_BLINK].level = 0;
+    feedback_pattern_start(KG_FEEDBACK_OUTPUT_BLINK, KG_BLINK_MODE_OFF, 0);
 
     // SELF-TEST
     //set_blink_mode(KG_BLINK_MODE_3000_100);
 }
 
 /**
- * @brief Update status of LED feedback subystem, called at 100Hz from loop()
+ * @brief Update status of LED feedback subystem, called from output timer interrupt
+ * @see KG_FEEDBACK_ISR_HZ
  */
 void update_feedback_blink() {
-    // each "keygloveTick" is 10ms, loops at 100 (1 second)
-    // each "blinkTick" is 50ms, loops at cycle period (max 12.5 seconds = 250, near 255)
-    if (feedbackBlinkLoop && (keygloveTick % 5) == 0) {
-        //feedbackBlinkMod = feedbackBlinkTick % feedbackBlinkLoop;
-
-        if (feedbackBlinkMode == KG_BLINK_MODE_B200_100) {
-            feedback_set_blink_logic(square_wave(feedbackBlinkTick, 4, 50));
-        } else if (feedbackBlinkMode == KG_BLINK_MODE_B200_50) {
-            feedback_set_blink_logic(square_wave(feedbackBlinkTick, 2, 25));
-        } else if (feedbackBlinkMode == KG_BLINK_MODE_B1000_500) {
-            feedback_set_blink_logic(square_wave(feedbackBlinkTick, 20, 50));
-        } else if (feedbackBlinkMode == KG_BLINK_MODE_B3000_1000) {
-            feedback_set_blink_logic(square_wave(feedbackBlinkTick, 60, 33));
-        } else if (feedbackBlinkMode == KG_BLINK_MODE_B1000_100 || feedbackBlinkMode == KG_BLINK_MODE_B3000_100) {
-            feedback_set_blink_logic(feedbackBlinkTick < 2 ? square_wave(feedbackBlinkTick, 4, 50) : 0);
-        } else if (feedbackBlinkMode == KG_BLINK_MODE_B1000_100_2X || feedbackBlinkMode == KG_BLINK_MODE_B3000_100_2X) {
-            feedback_set_blink_logic(feedbackBlinkTick < 6 ? square_wave(feedbackBlinkTick, 4, 50) : 0);
-        } else if (feedbackBlinkMode == KG_BLINK_MODE_B1000_100_3X || feedbackBlinkMode == KG_BLINK_MODE_B3000_100_3X) {
-            feedback_set_blink_logic(feedbackBlinkTick < 10 ? square_wave(feedbackBlinkTick, 4, 50) : 0);
-        }
-        feedbackBlinkTick++;
-        if (feedbackBlinkTick == feedbackBlinkLoop) feedbackBlinkTick = 0;
+    uint8_t result = feedback_pattern_step(KG_FEEDBACK_OUTPUT_BLINK);
+    if (result & KG_FEEDBACK_PATTERN_EXPIRED) {
+        feedback_pattern_start(KG_FEEDBACK_OUTPUT_BLINK, KG_BLINK_MODE_OFF, 0);
+        feedback_set_blink_logic(0);
+    } else if (result & KG_FEEDBACK_PATTERN_CHANGED) {
+        // digital output, so "on" is anything in the upper half
+        feedback_set_blink_logic(feedbackOutput[KG_FEEDBACK_OUTPUT_BLINK].level >= 0x80);
     }
 }
 
@@ -139,7 +104,8 @@ void update_feedback_blink() {
  * @return Result code (0=success)
  */
 uint16_t kg_cmd_feedback_get_blink_mode(uint8_t *mode) {
-    *mode = feedbackBlinkMode;
+    // patterns beyond the blink modes may have been started with "play_pattern"
+    *mode = feedbackOutput[KG_FEEDBACK_OUTPUT_BLINK].pattern < KG_BLINK_MODE_MAX ? feedbackOutput[KG_FEEDBACK_OUTPUT_BLINK].pattern : 0xFF;
     return 0; // success
 }
 
@@ -46,22 +46,66 @@ THE SOFTWARE.
 #include "support_feedback.h"
 //#include "support_feedback_piezo.h"     // <-- included by support_feedback.h
 
-feedback_piezo_mode_t feedbackPiezoMode;    ///< Piezo sound mode
-uint16_t feedbackPiezoTick;                 ///< Piezo tick reference
-uint16_t feedbackPiezoDuration;             ///< Piezo pattern duration
 uint16_t feedbackPiezoFrequency;            ///< Piezo frequency to use for tone generation
 
 /**
- * @brief Enables or disables the piezo buzzer using a certain frequency
+ * @brief Built-in feedback pattern used for each piezo mode
+ */
+const uint8_t feedbackPiezoPattern[KG_PIEZO_MODE_MAX] PROGMEM = {
+    0,      // KG_PIEZO_MODE_OFF
+    1,      // KG_PIEZO_MODE_SOLID
+    4,      // KG_PIEZO_MODE_LONGBEEP (1sec period, 500ms pulse)
+    24,     // KG_PIEZO_MODE_LONGPULSE (1sec period, 250ms pulse)
+    2,      // KG_PIEZO_MODE_SHORTBEEP (200ms period, 100ms pulse)
+    3,      // KG_PIEZO_MODE_SHORTPULSE (200ms period, 50ms pulse)
+    25,     // KG_PIEZO_MODE_TINYBEEP (100ms period, 50ms pulse)
+    26      // KG_PIEZO_MODE_TINYPULSE (100ms period, 20ms pulse)
+};
+
+/**
+ * @brief Timer2 clock prescaler for each CS22:0 setting (1-7)
+ */
+const uint16_t feedbackPiezoPrescaler[7] PROGMEM = { 1, 8, 32, 64, 128, 256, 1024 };
+
+/**
+ * @brief Sets the piezo buzzer tone frequency
  * @param[in] frequency Frequency (Hz) of tone to generate, or zero to disable
  * @see KG_PIN_PIEZO
+ *
+ * Timer2 toggles the piezo pin (OC2A) in hardware in CTC mode, so the tone
+ * costs no CPU time at all. The smallest prescaler which fits the compare
+ * value into 8 bits gives the most accurate frequency. The pattern only
+ * connects or disconnects the pin from the timer, so the tone itself keeps
+ * running between beeps.
  */
 void feedback_set_piezo_tone(uint16_t frequency) {
+    uint8_t cs = 0;
+    uint32_t compare = 0;
+    if (frequency) {
+        for (; cs < 7; cs++) {
+            compare = F_CPU / (2UL * pgm_read_word(feedbackPiezoPrescaler + cs) * frequency);
+            if (compare <= 256) break;
+        }
+        if (cs == 7) {
+            // too low to reach, so use the lowest available frequency
+            cs = 6;
+            compare = 256;
+        }
+    }
+
+    // TCCR2A is also updated from the output timer interrupt
+    uint8_t sreg = SREG;
+    cli();
     if (frequency == 0) {
-        noTone(KG_PIN_PIEZO);
+        TCCR2B = 0;
+        TCCR2A &= ~KG_PWM_PIEZO_ENABLE;
     } else {
-        tone(KG_PIN_PIEZO, frequency);
+        TCCR2A = (TCCR2A & KG_PWM_PIEZO_ENABLE) | (1 << WGM21);    // CTC mode, TOP=OCR2A
+        OCR2A = compare ? compare - 1 : 0;
+        TCNT2 = 0;
+        TCCR2B = cs + 1;
     }
+    SREG = sreg;
 }
 
 /**
@@ -71,12 +115,9 @@ void feedback_set_piezo_tone(uint16_t frequency) {
  * @param[in] frequency Frequency (Hz) of tone to generate
  */
 void feedback_set_piezo_mode(feedback_piezo_mode_t mode, uint8_t duration, uint16_t frequency) {
-    feedbackPiezoMode = mode;
     feedbackPiezoFrequency = frequency;
-    if (mode == KG_PIEZO_MODE_OFF) feedback_set_piezo_tone(0);
-    else if (mode == KG_PIEZO_MODE_SOLID) feedback_set_piezo_tone(frequency);
-    feedbackPiezoTick = 0xFFFF;
-    feedbackPiezoDuration = duration;
+    feedback_set_piezo_tone(frequency ? frequency : KG_PIEZO_DEFAULT_FREQ);
+    feedback_pattern_start(KG_FEEDBACK_OUTPUT_PIEZO, pgm_read_byte(feedbackPiezoPattern + mode), duration);
 }
 
 /**
@@ -85,25 +126,30 @@ void feedback_set_piezo_mode(feedback_piezo_mode_t mode, uint8_t duration, uint1
 void setup_feedback_piezo() {
     pinMode(KG_PIN_PIEZO, OUTPUT);
     digitalWrite(KG_PIN_PIEZO, LOW);
-    noTone(KG_PIN_PIEZO);
+    TCCR2A = 0; // pin disconnected from timer until a pattern turns it on
+    feedbackPiezoFrequency = KG_PIEZO_DEFAULT_FREQ;
+    feedback_set_piezo_tone(feedbackPiezoFrequency);
+    feedbackOutput[KG_FEEDBACK_OUTPUT_PIEZO].level = 0;
+    feedback_pattern_start(KG_FEEDBACK_OUTPUT_PIEZO, 0, 0);
 
     // SELF-TEST
     //feedback_set_piezo_mode(KG_PIEZO_TINYPULSE, 20);
 }
 
 /**
- * @brief Update status of piezo feedback subystem, called at 100Hz from loop()
+ * @brief Update status of piezo feedback subystem, called from output timer interrupt
+ * @see KG_FEEDBACK_ISR_HZ
  */
 void update_feedback_piezo() {
-     if (feedbackPiezoMode > 0) {
-         if      (feedbackPiezoMode == KG_PIEZO_MODE_LONGBEEP   && feedbackPiezoTick % 50 == 0) { feedback_set_piezo_tone(feedbackPiezoTick % 100 >= 50 ? 0 : feedbackPiezoFrequency); }
-         else if (feedbackPiezoMode == KG_PIEZO_MODE_LONGPULSE  && feedbackPiezoTick % 25 == 0) { feedback_set_piezo_tone(feedbackPiezoTick % 100 >= 25 ? 0 : feedbackPiezoFrequency); }
-         else if (feedbackPiezoMode == KG_PIEZO_MODE_SHORTBEEP  && feedbackPiezoTick % 10 == 0) { feedback_set_piezo_tone(feedbackPiezoTick %  20 >= 10 ? 0 : feedbackPiezoFrequency); }
-         else if (feedbackPiezoMode == KG_PIEZO_MODE_SHORTPULSE && feedbackPiezoTick %  5 == 0) { feedback_set_piezo_tone(feedbackPiezoTick %  20 >=  5 ? 0 : feedbackPiezoFrequency); }
-         else if (feedbackPiezoMode == KG_PIEZO_MODE_TINYBEEP   && feedbackPiezoTick %  5 == 0) { feedback_set_piezo_tone(feedbackPiezoTick %  10 >=  5 ? 0 : feedbackPiezoFrequency); }
-         else if (feedbackPiezoMode == KG_PIEZO_MODE_TINYPULSE  && feedbackPiezoTick %  2 == 0) { feedback_set_piezo_tone(feedbackPiezoTick %  10 >=  2 ? 0 : feedbackPiezoFrequency); }
-         if (++feedbackPiezoTick >= feedbackPiezoDuration && feedbackPiezoDuration > 0) feedback_set_piezo_mode(KG_PIEZO_MODE_OFF, 0, 0);
-     }
+    uint8_t result = feedback_pattern_step(KG_FEEDBACK_OUTPUT_PIEZO);
+    if (result & KG_FEEDBACK_PATTERN_EXPIRED) {
+        feedback_pattern_start(KG_FEEDBACK_OUTPUT_PIEZO, pgm_read_byte(feedbackPiezoPattern + KG_PIEZO_MODE_OFF), 0);
+        TCCR2A &= ~KG_PWM_PIEZO_ENABLE;
+    } else if (result & KG_FEEDBACK_PATTERN_CHANGED) {
+        // tone is either on or off, so "on" is anything in the upper half
+        if (feedbackOutput[KG_FEEDBACK_OUTPUT_PIEZO].level >= 0x80) TCCR2A |= KG_PWM_PIEZO_ENABLE;
+        else TCCR2A &= ~KG_PWM_PIEZO_ENABLE;
+    }
 }
 
 /* ============================= */
@@ -120,8 +166,9 @@ void update_feedback_piezo() {
  */
 uint16_t kg_cmd_feedback_get_piezo_mode(uint8_t index, uint8_t *mode, uint8_t *duration, uint16_t *frequency) {
     // "index" is currently ignored, as there is only one piezo device in the design
-    *mode = feedbackPiezoMode;
-    *duration = feedbackPiezoDuration;
+    // patterns beyond the piezo modes may have been started with "play_pattern"
+    *mode = feedback_pattern_mode(feedbackPiezoPattern, KG_PIEZO_MODE_MAX, feedbackOutput[KG_FEEDBACK_OUTPUT_PIEZO].pattern);
+    *duration = feedbackOutput[KG_FEEDBACK_OUTPUT_PIEZO].duration;
     *frequency = feedbackPiezoFrequency;
     return 0; // success
 }
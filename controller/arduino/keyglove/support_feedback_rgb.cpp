@@ -46,9 +46,31 @@ THE SOFTWARE.
 #include "support_feedback.h"
 //#include "support_feedback_rgb.h"       // <-- included by support_feedback.h
 
-feedback_rgb_mode_t feedbackRGBMode[3];     ///< RGB feedback red component mode
-int16_t feedbackRGBTick[3];                 ///< RGB fade tick reference (signed because of abs equations)
-uint16_t feedbackRGBLoop[3];                ///< Tick loop length for RGB fade timing
+/**
+ * @brief Gamma-corrected (2.2) PWM compare values for each 8-bit output level
+ *
+ * Linear steps in pattern level look linear to the eye after this mapping, and
+ * the 1000-count PWM period leaves plenty of resolution at the dim end where
+ * an 8-bit analogWrite() would visibly step.
+ */
+const uint16_t feedbackRGBGamma[256] PROGMEM = {
+      0,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   2,   2,
+      2,   3,   3,   3,   4,   4,   5,   5,   6,   6,   7,   7,   8,   8,   9,  10,
+     10,  11,  12,  13,  13,  14,  15,  16,  17,  18,  19,  20,  21,  22,  23,  24,
+     25,  27,  28,  29,  30,  32,  33,  34,  36,  37,  38,  40,  41,  43,  45,  46,
+     48,  49,  51,  53,  55,  56,  58,  60,  62,  64,  66,  68,  70,  72,  74,  76,
+     78,  80,  82,  85,  87,  89,  91,  94,  96,  99, 101, 104, 106, 109, 111, 114,
+    116, 119, 122, 125, 127, 130, 133, 136, 139, 142, 145, 148, 151, 154, 157, 160,
+    163, 167, 170, 173, 177, 180, 183, 187, 190, 194, 197, 201, 205, 208, 212, 216,
+    219, 223, 227, 231, 235, 239, 243, 247, 251, 255, 259, 263, 267, 271, 276, 280,
+    284, 289, 293, 297, 302, 306, 311, 315, 320, 325, 329, 334, 339, 344, 349, 353,
+    358, 363, 368, 373, 378, 383, 389, 394, 399, 404, 409, 415, 420, 425, 431, 436,
+    442, 447, 453, 459, 464, 470, 476, 481, 487, 493, 499, 505, 511, 517, 523, 529,
+    535, 541, 547, 554, 560, 566, 573, 579, 585, 592, 598, 605, 611, 618, 625, 631,
+    638, 645, 652, 659, 665, 672, 679, 686, 693, 700, 708, 715, 722, 729, 736, 744,
+    751, 759, 766, 773, 781, 789, 796, 804, 811, 819, 827, 835, 843, 850, 858, 866,
+    874, 882, 890, 898, 907, 915, 923, 931, 940, 948, 956, 965, 973, 982, 990, 999
+};
 
 /**
  * @brief Sets RGB feedpack pin digital logic states (red/green/blue)
@@ -57,20 +79,20 @@ uint16_t feedbackRGBLoop[3];                ///< Tick loop length for RGB fade t
  * @param[in] b Blue: zero for low (off), non-zero for high (on), 255 for no change
  */
 void feedback_set_rgb_digital(uint8_t r, uint8_t g, uint8_t b) {
-    if (r != 255) digitalWrite(KG_PIN_RGB_RED, r);
-    if (g != 255) digitalWrite(KG_PIN_RGB_GREEN, g);
-    if (b != 255) digitalWrite(KG_PIN_RGB_BLUE, b);
+    if (r != 255) feedback_set_rgb_digital_channel(0, r);
+    if (g != 255) feedback_set_rgb_digital_channel(1, g);
+    if (b != 255) feedback_set_rgb_digital_channel(2, b);
 }
 
 /**
  * @brief Sets RGB feedpack pin digital logic state on one channel (red/green/blue)
  * @param[in] channel Channel number (0=RED, 1=GREEN, 2=BLUE)
  * @param[in] value Logic state (zero for low/off, non-zero for high/on)
+ *
+ * The pins stay under timer control, so full on/off is just the ends of the PWM range.
  */
 void feedback_set_rgb_digital_channel(uint8_t channel, uint8_t value) {
-    if (channel == 0) digitalWrite(KG_PIN_RGB_RED, value);
-    else if (channel == 1) digitalWrite(KG_PIN_RGB_GREEN, value);
-    else if (channel == 2) digitalWrite(KG_PIN_RGB_BLUE, value);
+    feedback_set_rgb_analog_channel(channel, value ? 255 : 0);
 }
 
 /**
@@ -80,20 +102,39 @@ void feedback_set_rgb_digital_channel(uint8_t channel, uint8_t value) {
  * @param[in] b Blue: zero for off, non-zero for PWM (on), 255 for no change
  */
 void feedback_set_rgb_analog(uint8_t r, uint8_t g, uint8_t b) {
-    if (r != 255) analogWrite(KG_PIN_RGB_RED, r);
-    if (g != 255) analogWrite(KG_PIN_RGB_GREEN, g);
-    if (b != 255) analogWrite(KG_PIN_RGB_BLUE, b);
+    if (r != 255) feedback_set_rgb_analog_channel(0, r);
+    if (g != 255) feedback_set_rgb_analog_channel(1, g);
+    if (b != 255) feedback_set_rgb_analog_channel(2, b);
 }
 
 /**
  * @brief Sets RGB feedpack pin analog PWM state on one channel (red/green/blue)
  * @param[in] channel Channel number (0=RED, 1=GREEN, 2=BLUE)
- * @param[in] value PWM duty cycle (zero for off, non-zero for PWM/on)
+ * @param[in] value Brightness before gamma correction (zero for off, 255 for full on)
+ *
+ * Called from the output timer interrupt as well as the main loop, so the
+ * 16-bit compare register write and TCCR3A update are done atomically.
  */
 void feedback_set_rgb_analog_channel(uint8_t channel, uint8_t value) {
-    if (channel == 0) analogWrite(KG_PIN_RGB_RED, value);
-    else if (channel == 1) analogWrite(KG_PIN_RGB_GREEN, value);
-    else if (channel == 2) analogWrite(KG_PIN_RGB_BLUE, value);
+    uint16_t compare = pgm_read_word(feedbackRGBGamma + value);
+    uint8_t enable;
+    uint8_t sreg = SREG;
+    cli();
+    if (channel == 0) {
+        KG_PWM_RGB_RED = compare;
+        enable = KG_PWM_RGB_RED_ENABLE;
+    } else if (channel == 1) {
+        KG_PWM_RGB_GREEN = compare;
+        enable = KG_PWM_RGB_GREEN_ENABLE;
+    } else {
+        KG_PWM_RGB_BLUE = compare;
+        enable = KG_PWM_RGB_BLUE_ENABLE;
+    }
+
+    // fast PWM still emits a one-count pulse at compare=0, so disconnect the pin (PORT is low) for true off
+    if (value) TCCR3A |= enable;
+    else TCCR3A &= ~enable;
+    SREG = sreg;
 }
 
 /**
@@ -101,38 +142,13 @@ void feedback_set_rgb_analog_channel(uint8_t channel, uint8_t value) {
  * @param[in] r Red mode
  * @param[in] g Green mode
  * @param[in] b Blue mode
+ *
+ * RGB modes use built-in feedback patterns with the same values.
  */
 void feedback_set_rgb_mode(feedback_rgb_mode_t r, feedback_rgb_mode_t g, feedback_rgb_mode_t b) {
-    feedbackRGBMode[0] = r;
-    feedbackRGBMode[1] = g;
-    feedbackRGBMode[2] = b;
-    feedbackRGBTick[0] = feedbackRGBTick[1] = feedbackRGBTick[2] = 0;
-    feedbackRGBLoop[0] = feedbackRGBLoop[1] = feedbackRGBLoop[2] = 0;
-
-    for (uint8_t i = 0; i < 3; i++) {
-             if (feedbackRGBMode[i] == KG_RGB_MODE_B200_100     || feedbackRGBMode[i] == KG_RGB_MODE_F200_100 ||
-                 feedbackRGBMode[i] == KG_RGB_MODE_B200_50      || feedbackRGBMode[i] == KG_RGB_MODE_F200_50
-                ) feedbackRGBLoop[i] = 20;
-        else if (feedbackRGBMode[i] == KG_RGB_MODE_B1000_500    || feedbackRGBMode[i] == KG_RGB_MODE_F1000_500 ||
-                 feedbackRGBMode[i] == KG_RGB_MODE_B1000_100    || feedbackRGBMode[i] == KG_RGB_MODE_F1000_100 ||
-                 feedbackRGBMode[i] == KG_RGB_MODE_B1000_100_2X || feedbackRGBMode[i] == KG_RGB_MODE_F1000_100_2X ||
-                 feedbackRGBMode[i] == KG_RGB_MODE_B1000_100_3X || feedbackRGBMode[i] == KG_RGB_MODE_F1000_100_3X ||
-                 feedbackRGBMode[i] == KG_RGB_MODE_F1000_1000
-                ) feedbackRGBLoop[i] = 100;
-        else if (feedbackRGBMode[i] == KG_RGB_MODE_B3000_1000   || feedbackRGBMode[i] == KG_RGB_MODE_F3000_1000 ||
-                 feedbackRGBMode[i] == KG_RGB_MODE_B3000_100    || feedbackRGBMode[i] == KG_RGB_MODE_F3000_100 ||
-                 feedbackRGBMode[i] == KG_RGB_MODE_B3000_100_2X || feedbackRGBMode[i] == KG_RGB_MODE_F3000_100_2X ||
-                 feedbackRGBMode[i] == KG_RGB_MODE_B3000_100_3X || feedbackRGBMode[i] == KG_RGB_MODE_F3000_100_3X ||
-                 feedbackRGBMode[i] == KG_RGB_MODE_F3000_3000
-                ) feedbackRGBLoop[i] = 300;
-    }
-
-    // logic: r=OFF -> off, r=ON -> on, else no immediate change, update_feedback_rgb() will handling it
-    feedback_set_rgb_digital(
-        r == KG_RGB_MODE_OFF ? 0 : (r == KG_RGB_MODE_SOLID ? 1 : 255),
-        g == KG_RGB_MODE_OFF ? 0 : (g == KG_RGB_MODE_SOLID ? 1 : 255),
-        b == KG_RGB_MODE_OFF ? 0 : (b == KG_RGB_MODE_SOLID ? 1 : 255)
-    );
+    feedback_pattern_start(KG_FEEDBACK_OUTPUT_RGB_RED, r, 0);
+    feedback_pattern_start(KG_FEEDBACK_OUTPUT_RGB_GREEN, g, 0);
+    feedback_pattern_start(KG_FEEDBACK_OUTPUT_RGB_BLUE, b, 0);
 }
 
 /**
@@ -145,6 +161,10 @@ void setup_feedback_rgb() {
     digitalWrite(KG_PIN_RGB_RED, LOW);
     digitalWrite(KG_PIN_RGB_GREEN, LOW);
     digitalWrite(KG_PIN_RGB_BLUE, LOW);
+    for (uint8_t i = KG_FEEDBACK_OUTPUT_RGB_RED; i <= KG_FEEDBACK_OUTPUT_RGB_BLUE; i++) {
+        feedbackOutput[i].level = 0;
+        feedback_pattern_start((feedback_output_t)i, KG_RGB_MODE_OFF, 0);
+    }
 
     // SELF-TEST
     //feedback_set_rgb_digital(1, 1, 1); // turn everything on and wait 1/20 sec
@@ -153,47 +173,21 @@ void setup_feedback_rgb() {
 }
 
 /**
- * @brief Update status of RGB feedback subystem, called at 100Hz from loop()
+ * @brief Update status of RGB feedback subystem, called from output timer interrupt
+ * @see KG_FEEDBACK_ISR_HZ
  */
 void update_feedback_rgb() {
-    // each "keygloveTick" is 10ms, loops at 100 (1 second)
-    // each "RGBTick" is also 10ms, loops at cycle period (can be greater than 1 second, actually 6553 seconds)
     for (uint8_t i = 0; i < 3; i++) {
-        if (feedbackRGBMode[i] == KG_RGB_MODE_B200_100) {
-            feedback_set_rgb_digital_channel(i, square_wave(feedbackRGBTick[i], 20, 50));
-        } else if (feedbackRGBMode[i] == KG_RGB_MODE_B200_50) {
-            feedback_set_rgb_digital_channel(i, square_wave(feedbackRGBTick[i], 10, 25));
-        } else if (feedbackRGBMode[i] == KG_RGB_MODE_B1000_500) {
-            feedback_set_rgb_digital_channel(i, square_wave(feedbackRGBTick[i], 100, 50));
-        } else if (feedbackRGBMode[i] == KG_RGB_MODE_B3000_1000) {
-            feedback_set_rgb_digital_channel(i, square_wave(feedbackRGBTick[i], 300, 33));
-        } else if (feedbackRGBMode[i] == KG_RGB_MODE_B1000_100 || feedbackRGBMode[i] == KG_RGB_MODE_B3000_100) {
-            feedback_set_rgb_digital_channel(i, feedbackRGBTick[i] < 10 ? square_wave(feedbackRGBTick[i], 20, 50) : 0);
-        } else if (feedbackRGBMode[i] == KG_RGB_MODE_B1000_100_2X || feedbackRGBMode[i] == KG_RGB_MODE_B3000_100_2X) {
-            feedback_set_rgb_digital_channel(i, feedbackRGBTick[i] < 30 ? square_wave(feedbackRGBTick[i], 20, 50) : 0);
-        } else if (feedbackRGBMode[i] == KG_RGB_MODE_B1000_100_3X || feedbackRGBMode[i] == KG_RGB_MODE_B3000_100_3X) {
-            feedback_set_rgb_digital_channel(i, feedbackRGBTick[i] < 50 ? square_wave(feedbackRGBTick[i], 20, 50) : 0);
-
-        } else if (feedbackRGBMode[i] == KG_RGB_MODE_F200_50) {
-            feedback_set_rgb_analog_channel(i, feedbackRGBTick[i] < 5 ? triangle_wave(feedbackRGBTick[i], 10, 400) : 0);
-        } else if (feedbackRGBMode[i] == KG_RGB_MODE_F1000_500) {
-            feedback_set_rgb_analog_channel(i, feedbackRGBTick[i] < 50 ? triangle_wave(feedbackRGBTick[i], 100, 400) : 0);
-        } else if (feedbackRGBMode[i] == KG_RGB_MODE_F1000_1000) {
-            feedback_set_rgb_analog_channel(i, triangle_wave(feedbackRGBTick[i], 200, 400));
-        } else if (feedbackRGBMode[i] == KG_RGB_MODE_F3000_1000) {
-            feedback_set_rgb_analog_channel(i, feedbackRGBTick[i] < 100 ? triangle_wave(feedbackRGBTick[i], 200, 400) : 0);
-        } else if (feedbackRGBMode[i] == KG_RGB_MODE_F3000_3000) {
-            feedback_set_rgb_analog_channel(i, triangle_wave(feedbackRGBTick[i], 600, 400));
-        } else if (feedbackRGBMode[i] == KG_RGB_MODE_F200_100 || feedbackRGBMode[i] == KG_RGB_MODE_F1000_100 || feedbackRGBMode[i] == KG_RGB_MODE_F3000_100) {
-            feedback_set_rgb_analog_channel(i, feedbackRGBTick[i] < 10 ? triangle_wave(feedbackRGBTick[i], 20, 400) : 0);
-        } else if (feedbackRGBMode[i] == KG_RGB_MODE_F1000_100_2X || feedbackRGBMode[i] == KG_RGB_MODE_F3000_100_2X) {
-            feedback_set_rgb_analog_channel(i, feedbackRGBTick[i] < 30 ? triangle_wave(feedbackRGBTick[i], 20, 400) : 0);
-        } else if (feedbackRGBMode[i] == KG_RGB_MODE_F1000_100_3X || feedbackRGBMode[i] == KG_RGB_MODE_F3000_100_3X) {
-            feedback_set_rgb_analog_channel(i, feedbackRGBTick[i] < 50 ? triangle_wave(feedbackRGBTick[i], 20, 400) : 0);
+        feedback_output_t output = (feedback_output_t)(KG_FEEDBACK_OUTPUT_RGB_RED + i);
+        uint8_t result = feedback_pattern_step(output);
+        if (result & KG_FEEDBACK_PATTERN_EXPIRED) {
+            feedback_pattern_start(output, KG_RGB_MODE_OFF, 0);
+            feedback_pattern_step(output);
+            result |= KG_FEEDBACK_PATTERN_CHANGED;
+        }
+        if (result & KG_FEEDBACK_PATTERN_CHANGED) {
+            feedback_set_rgb_analog_channel(i, feedbackOutput[output].level);
         }
-
-        feedbackRGBTick[i]++;
-        if (feedbackRGBTick[i] == feedbackRGBLoop[i]) feedbackRGBTick[i] = 0;
     }
 }
 
@@ -211,9 +205,10 @@ void update_feedback_rgb() {
  */
 uint16_t kg_cmd_feedback_get_rgb_mode(uint8_t index, uint8_t *mode_red, uint8_t *mode_green, uint8_t *mode_blue) {
     // "index" is currently ignored, as there is only one RGB device in the design
-    *mode_red = feedbackRGBMode[0];
-    *mode_green = feedbackRGBMode[1];
-    *mode_blue = feedbackRGBMode[2];
+    // patterns beyond the RGB modes may have been started with "play_pattern"
+    *mode_red = feedbackOutput[KG_FEEDBACK_OUTPUT_RGB_RED].pattern < KG_RGB_MODE_MAX ? feedbackOutput[KG_FEEDBACK_OUTPUT_RGB_RED].pattern : 0xFF;
+    *mode_green = feedbackOutput[KG_FEEDBACK_OUTPUT_RGB_GREEN].pattern < KG_RGB_MODE_MAX ? feedbackOutput[KG_FEEDBACK_OUTPUT_RGB_GREEN].pattern : 0xFF;
+    *mode_blue = feedbackOutput[KG_FEEDBACK_OUTPUT_RGB_BLUE].pattern < KG_RGB_MODE_MAX ? feedbackOutput[KG_FEEDBACK_OUTPUT_RGB_BLUE].pattern : 0xFF;
     return 0; // success
 }
 
@@ -46,9 +46,20 @@ THE SOFTWARE.
 #include "support_feedback.h"
 //#include "support_feedback_vibrate.h"   // <-- included by support_feedback.h
 
-feedback_vibrate_mode_t feedbackVibrateMode;    ///< Vibration mode
-uint16_t feedbackVibrateTick;                   ///< Vibration tick reference
-uint16_t feedbackVibrateDuration;               ///< Vibration pattern duration
+uint8_t feedbackVibratePhase;               ///< Phase accumulator for pulse-density motor drive
+
+/**
+ * @brief Built-in feedback pattern used for each vibration mode
+ */
+const uint8_t feedbackVibratePattern[KG_VIBRATE_MODE_MAX] PROGMEM = {
+    0,      // KG_VIBRATE_MODE_OFF
+    1,      // KG_VIBRATE_MODE_SOLID
+    4,      // KG_VIBRATE_MODE_LONGBUZZ (1sec period, 500ms pulse)
+    24,     // KG_VIBRATE_MODE_LONGPULSE (1sec period, 250ms pulse)
+    2,      // KG_VIBRATE_MODE_SHORTBUZZ (200ms period, 100ms pulse)
+    3,      // KG_VIBRATE_MODE_SHORTPULSE (200ms period, 50ms pulse)
+    25      // KG_VIBRATE_MODE_TINYBUZZ (100ms period, 50ms pulse)
+};
 
 /**
  * @brief Sets vibration motor control pin logic state
@@ -65,11 +76,7 @@ void feedback_set_vibrate_logic(uint8_t logic) {
  * @param[in] duration Duration in 10ms units to run pattern before ending (0 to run forever)
  */
 void feedback_set_vibrate_mode(feedback_vibrate_mode_t mode, uint8_t duration) {
-    feedbackVibrateMode = mode;
-    if (mode == KG_VIBRATE_MODE_OFF) feedback_set_vibrate_logic(0);
-    else if (mode == KG_VIBRATE_MODE_SOLID) feedback_set_vibrate_logic(1);
-    feedbackVibrateTick = 0xFFFF;
-    feedbackVibrateDuration = duration;
+    feedback_pattern_start(KG_FEEDBACK_OUTPUT_VIBRATE, pgm_read_byte(feedbackVibratePattern + mode), duration);
 }
 
 /**
@@ -78,23 +85,31 @@ void feedback_set_vibrate_mode(feedback_vibrate_mode_t mode, uint8_t duration) {
 void setup_feedback_vibrate() {
     pinMode(KG_PIN_VIBRATE, OUTPUT);
     digitalWrite(KG_PIN_VIBRATE, HIGH); // transistor switch makes it active-low
+    feedbackVibratePhase = 0;
+    feedbackOutput[KG_FEEDBACK_OUTPUT_VIBRATE].level = 0;
+    feedback_pattern_start(KG_FEEDBACK_OUTPUT_VIBRATE, 0, 0);
 
     // SELF-TEST
     //feedback_set_vibrate_mode(KG_VIBRATE_MODE_TINYBUZZ, 20);
 }
 
 /**
- * @brief Update status of vibration feedback subystem, called at 100Hz from loop()
+ * @brief Update status of vibration feedback subystem, called from output timer interrupt
+ * @see KG_FEEDBACK_ISR_HZ
+ *
+ * The motor pin has no hardware PWM, so the level drives a phase accumulator
+ * instead: the pin is on for each interrupt where adding the level carries out
+ * of 8 bits. This spreads the on-time evenly at the interrupt rate, which the
+ * motor's inertia smooths into a proportional speed, so ramps are real ramps.
  */
 void update_feedback_vibrate() {
-     if (feedbackVibrateMode > 0) {
-         if      (feedbackVibrateMode == KG_VIBRATE_MODE_LONGBUZZ   && feedbackVibrateTick % 50 == 0) feedback_set_vibrate_logic(feedbackVibrateTick % 100 >= 50 ? 0 : 1);
-         else if (feedbackVibrateMode == KG_VIBRATE_MODE_LONGPULSE  && feedbackVibrateTick % 25 == 0) feedback_set_vibrate_logic(feedbackVibrateTick % 100 >= 25 ? 0 : 1);
-         else if (feedbackVibrateMode == KG_VIBRATE_MODE_SHORTBUZZ  && feedbackVibrateTick % 10 == 0) feedback_set_vibrate_logic(feedbackVibrateTick %  20 >= 10 ? 0 : 1);
-         else if (feedbackVibrateMode == KG_VIBRATE_MODE_SHORTPULSE && feedbackVibrateTick %  5 == 0) feedback_set_vibrate_logic(feedbackVibrateTick %  20 >=  5 ? 0 : 1);
-         else if (feedbackVibrateMode == KG_VIBRATE_MODE_TINYBUZZ   && feedbackVibrateTick %  5 == 0) feedback_set_vibrate_logic(feedbackVibrateTick %  10 >=  5 ? 0 : 1);
-         if (++feedbackVibrateTick >= feedbackVibrateDuration && feedbackVibrateDuration > 0) feedback_set_vibrate_mode(KG_VIBRATE_MODE_OFF, 0);
-     }
+    if (feedback_pattern_step(KG_FEEDBACK_OUTPUT_VIBRATE) & KG_FEEDBACK_PATTERN_EXPIRED) {
+        feedback_pattern_start(KG_FEEDBACK_OUTPUT_VIBRATE, pgm_read_byte(feedbackVibratePattern + KG_VIBRATE_MODE_OFF), 0);
+    }
+    uint8_t level = feedbackOutput[KG_FEEDBACK_OUTPUT_VIBRATE].level;
+    uint8_t phase = feedbackVibratePhase;
+    feedbackVibratePhase += level;
+    feedback_set_vibrate_logic(level == 255 || feedbackVibratePhase < phase);
 }
 
 /* ============================= */
@@ -110,8 +125,9 @@ void update_feedback_vibrate() {
  */
 uint16_t kg_cmd_feedback_get_vibrate_mode(uint8_t index, uint8_t *mode, uint8_t *duration) {
     // "index" is currently ignored, as there is only one vibration device in the design
-    *mode = feedbackVibrateMode;
-    *duration = feedbackVibrateDuration;
+    // patterns beyond the vibration modes may have been started with "play_pattern"
+    *mode = feedback_pattern_mode(feedbackVibratePattern, KG_VIBRATE_MODE_MAX, feedbackOutput[KG_FEEDBACK_OUTPUT_VIBRATE].pattern);
+    *duration = feedbackOutput[KG_FEEDBACK_OUTPUT_VIBRATE].duration;
     return 0; // success
 }
 
@@ -0,0 +1,275 @@
+// Keyglove controller source code - Flex sensor acquisition
+// 2014-12-14 by Jeff Rowberg <jeff@rowberg.net>
+
+/* ============================================
+Controller code is placed under the MIT license
+Copyright (c) 2014 Jeff Rowberg
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+/**
+ * @file support_flex.cpp
+ * @brief Flex sensor acquisition
+ * @author Jeff Rowberg
+ * @date 2014-12-14
+ *
+ * This file turns the flex sensor readings from the free-running ADC scan into
+ * finger bend values. The readings are taken and oversampled entirely from
+ * the ADC interrupt (see support_helper_adc.cpp), so loop() never waits on a
+ * conversion.
+ *
+ * update_flex() scales each result into a 0-255 bend value using the channel's
+ * min/max calibration, which is captured on request and stored in EEPROM. A
+ * kg_evt_flex_value event is only sent once the bend has moved by at least
+ * opt_flex_threshold, and no more often than opt_flex_interval, so small
+ * jitter never reaches the host.
+ *
+ * Normally it is not necessary to edit this file.
+ */
+
+#include "keyglove.h"
+#include "support_board.h"
+#include "support_protocol.h"
+#include "support_flex.h"
+
+#define KG_FLEX_CAL_MIN_SPAN    (64 << KG_ADC_OVERSAMPLE_BITS)  ///< Smallest captured range that replaces a channel's calibration
+
+uint8_t opt_flex_threshold = 4;         ///< OPTION: Smallest change in bend (0-255) that sends a flex_value event
+uint8_t opt_flex_interval = 20;         ///< OPTION: Shortest time in milliseconds between flex_value events for one sensor
+
+uint8_t flexScan;                       ///< adcScanCount when flexRaw was last updated
+uint16_t flexRaw[KG_FLEX_SENSOR_COUNT];     ///< Latest oversampled reading for each sensor (0 to KG_ADC_RAW_MAX)
+uint8_t flexValue[KG_FLEX_SENSOR_COUNT];    ///< Latest calibrated bend for each sensor (0 = straight, 255 = fully bent)
+uint8_t flexSent[KG_FLEX_SENSOR_COUNT];     ///< Bend last sent in a flex_value event
+uint32_t flexSentTime[KG_FLEX_SENSOR_COUNT];    ///< millis() when flexSent was sent
+uint16_t flexMin[KG_FLEX_SENSOR_COUNT];     ///< Calibrated straight reading for each sensor
+uint16_t flexMax[KG_FLEX_SENSOR_COUNT];     ///< Calibrated fully bent reading for each sensor
+uint16_t flexCalMin[KG_FLEX_SENSOR_COUNT];  ///< Lowest reading seen during calibration capture
+uint16_t flexCalMax[KG_FLEX_SENSOR_COUNT];  ///< Highest reading seen during calibration capture
+uint8_t flexCalStatus;                  ///< Calibration capture state (KG_FLEX_CAL_STATUS_*)
+uint8_t flexCalRecord[KG_FLEX_CAL_RECORD_SIZE];     ///< Calibration record waiting to be written to EEPROM
+uint8_t flexCalWritePos;                ///< Next record byte to write to EEPROM (0xFF if none pending)
+
+/**
+ * @brief Start storing flexMin/flexMax in EEPROM in the background
+ * @see flex_cal_write_step()
+ */
+void flex_cal_save() {
+    uint8_t checksum = 0;
+    for (uint8_t i = 0; i < KG_FLEX_SENSOR_COUNT; i++) {
+        flexCalRecord[i * 4 + 1] = flexMin[i] & 0xFF;
+        flexCalRecord[i * 4 + 2] = flexMin[i] >> 8;
+        flexCalRecord[i * 4 + 3] = flexMax[i] & 0xFF;
+        flexCalRecord[i * 4 + 4] = flexMax[i] >> 8;
+    }
+    for (uint8_t i = 1; i < KG_FLEX_CAL_RECORD_SIZE - 1; i++) checksum += flexCalRecord[i];
+    flexCalRecord[0] = KG_FLEX_CAL_MAGIC;
+    flexCalRecord[KG_FLEX_CAL_RECORD_SIZE - 1] = ~checksum;
+    flexCalWritePos = 1;
+}
+
+/**
+ * @brief Store the next byte of a pending EEPROM calibration record write
+ *
+ * One byte per call like the motion offset record, with the magic byte
+ * written last so a record cut short by a reset is never loaded.
+ */
+void flex_cal_write_step() {
+    if (flexCalWritePos == 0xFF || !eeprom_is_ready()) return;
+    uint8_t pos = flexCalWritePos < KG_FLEX_CAL_RECORD_SIZE ? flexCalWritePos : 0;
+    uint8_t *address = (uint8_t *)(KG_FLEX_CAL_EEPROM_BASE + pos);
+    if (eeprom_read_byte(address) != flexCalRecord[pos]) eeprom_write_byte(address, flexCalRecord[pos]);
+    if (pos == 0) flexCalWritePos = 0xFF; // magic byte written last, all done
+    else flexCalWritePos++;
+}
+
+/**
+ * @brief Load calibration from EEPROM, or use the full reading range if none is stored
+ */
+void flex_cal_load() {
+    eeprom_read_block(flexCalRecord, (const void *)KG_FLEX_CAL_EEPROM_BASE, KG_FLEX_CAL_RECORD_SIZE);
+    uint8_t checksum = 0, i;
+    for (i = 1; i < KG_FLEX_CAL_RECORD_SIZE - 1; i++) checksum += flexCalRecord[i];
+    uint8_t valid = flexCalRecord[0] == KG_FLEX_CAL_MAGIC && flexCalRecord[KG_FLEX_CAL_RECORD_SIZE - 1] == (uint8_t)~checksum;
+    for (i = 0; i < KG_FLEX_SENSOR_COUNT; i++) {
+        if (valid) {
+            flexMin[i] = flexCalRecord[i * 4 + 1] | (flexCalRecord[i * 4 + 2] << 8);
+            flexMax[i] = flexCalRecord[i * 4 + 3] | (flexCalRecord[i * 4 + 4] << 8);
+        } else {
+            flexMin[i] = 0;
+            flexMax[i] = KG_ADC_RAW_MAX;
+        }
+    }
+}
+
+/**
+ * @brief Scale an oversampled reading into a bend value using a channel's calibration
+ * @param[in] index Flex sensor index
+ * @param[in] raw Oversampled reading
+ * @return Bend from 0 (straight) to 255 (fully bent)
+ *
+ * Sensors wired so that the reading falls as they bend are handled by storing
+ * a "min" larger than "max".
+ */
+uint8_t flex_scale(uint8_t index, uint16_t raw) {
+    int32_t span = (int32_t)flexMax[index] - flexMin[index];
+    int32_t offset = (int32_t)raw - flexMin[index];
+    if (span == 0) return 0;
+    if (span < 0) {
+        span = -span;
+        offset = -offset;
+    }
+    if (offset <= 0) return 0;
+    if (offset >= span) return 255;
+    return offset * 255 / span;
+}
+
+/**
+ * @brief Initialize flex sensor processing
+ */
+void setup_flex() {
+    flexScan = adcScanCount;
+    flexCalStatus = KG_FLEX_CAL_STATUS_IDLE;
+    flexCalWritePos = 0xFF;
+    flex_cal_load();
+    for (uint8_t i = 0; i < KG_FLEX_SENSOR_COUNT; i++) {
+        flexSent[i] = 0;
+        flexSentTime[i] = 0;
+    }
+}
+
+/**
+ * @brief Pick up new flex results and send any meaningful changes
+ * @see API event: kg_evt_flex_value()
+ */
+void update_flex() {
+    flex_cal_write_step();
+    if (!adc_read(KG_ADC_INDEX_FLEX, KG_FLEX_SENSOR_COUNT, flexRaw, &flexScan)) return;
+
+    uint32_t now = millis();
+    for (uint8_t i = 0; i < KG_FLEX_SENSOR_COUNT; i++) {
+        if (flexCalStatus == KG_FLEX_CAL_STATUS_CAPTURING) {
+            if (flexRaw[i] < flexCalMin[i]) flexCalMin[i] = flexRaw[i];
+            if (flexRaw[i] > flexCalMax[i]) flexCalMax[i] = flexRaw[i];
+        }
+        flexValue[i] = flex_scale(i, flexRaw[i]);
+
+        // only report changes that matter, and not too often
+        uint8_t change = abs((int16_t)flexValue[i] - flexSent[i]);
+        if (change == 0 || change < opt_flex_threshold || now - flexSentTime[i] < opt_flex_interval) continue;
+        flexSent[i] = flexValue[i];
+        flexSentTime[i] = now;
+
+        // send kg_evt_flex_value packet
+        uint8_t payload[2] = { i, flexValue[i] };
+        skipPacket = 0;
+        if (kg_evt_flex_value) skipPacket = kg_evt_flex_value(i, flexValue[i]);
+        if (!skipPacket) send_keyglove_packet(KG_PACKET_TYPE_EVENT, 2, KG_PACKET_CLASS_FLEX, KG_PACKET_ID_EVT_FLEX_VALUE, payload);
+    }
+}
+
+/* ============================= */
+/* KGAPI COMMAND IMPLEMENTATIONS */
+/* ============================= */
+
+/**
+ * @brief Get the latest reading of specified flex sensor
+ * @param[in] index Index of flex sensor
+ * @param[out] value Calibrated bend (0 = straight, 255 = fully bent)
+ * @param[out] raw Oversampled reading
+ * @return Result code (0=success)
+ */
+uint16_t kg_cmd_flex_get_value(uint8_t index, uint8_t *value, uint16_t *raw) {
+    if (index >= KG_FLEX_SENSOR_COUNT) {
+        return KG_PROTOCOL_ERROR_PARAMETER_RANGE;
+    } else {
+        *value = flexValue[index];
+        *raw = flexRaw[index];
+    }
+    return 0; // success
+}
+
+/**
+ * @brief Start, finish or cancel capturing flex sensor calibration
+ * @param[in] mode Calibration mode (0 = cancel, 1 = start capture, 2 = finish and store)
+ * @return Result code (0=success)
+ *
+ * While capturing, every finger should be flexed through its full range. On
+ * finish, each sensor whose captured range is at least KG_FLEX_CAL_MIN_SPAN
+ * takes it as its new calibration, and the rest keep their old one.
+ */
+uint16_t kg_cmd_flex_calibrate(uint8_t mode) {
+    if (mode > 2 || (mode == 2 && flexCalStatus != KG_FLEX_CAL_STATUS_CAPTURING)) {
+        return KG_PROTOCOL_ERROR_PARAMETER_RANGE;
+    } else if (mode == 1) {
+        for (uint8_t i = 0; i < KG_FLEX_SENSOR_COUNT; i++) {
+            flexCalMin[i] = KG_ADC_RAW_MAX;
+            flexCalMax[i] = 0;
+        }
+        flexCalStatus = KG_FLEX_CAL_STATUS_CAPTURING;
+    } else {
+        if (mode == 2) {
+            for (uint8_t i = 0; i < KG_FLEX_SENSOR_COUNT; i++) {
+                if (flexCalMax[i] < flexCalMin[i] + KG_FLEX_CAL_MIN_SPAN) continue;
+                flexMin[i] = flexCalMin[i];
+                flexMax[i] = flexCalMax[i];
+            }
+            flex_cal_save();
+        }
+        flexCalStatus = KG_FLEX_CAL_STATUS_IDLE;
+    }
+    return 0; // success
+}
+
+/**
+ * @brief Get the calibration of specified flex sensor
+ * @param[in] index Index of flex sensor
+ * @param[out] min Reading for a straight finger
+ * @param[out] max Reading for a fully bent finger
+ * @return Result code (0=success)
+ */
+uint16_t kg_cmd_flex_get_calibration(uint8_t index, uint16_t *min, uint16_t *max) {
+    if (index >= KG_FLEX_SENSOR_COUNT) {
+        return KG_PROTOCOL_ERROR_PARAMETER_RANGE;
+    } else {
+        *min = flexMin[index];
+        *max = flexMax[index];
+    }
+    return 0; // success
+}
+
+/**
+ * @brief Set and store the calibration of specified flex sensor
+ * @param[in] index Index of flex sensor
+ * @param[in] min Reading for a straight finger
+ * @param[in] max Reading for a fully bent finger (may be below min)
+ * @return Result code (0=success)
+ */
+uint16_t kg_cmd_flex_set_calibration(uint8_t index, uint16_t min, uint16_t max) {
+    if (index >= KG_FLEX_SENSOR_COUNT || min > KG_ADC_RAW_MAX || max > KG_ADC_RAW_MAX || min == max) {
+        return KG_PROTOCOL_ERROR_PARAMETER_RANGE;
+    } else {
+        flexMin[index] = min;
+        flexMax[index] = max;
+        flex_cal_save();
+    }
+    return 0; // success
+}
@@ -0,0 +1,62 @@
+// Keyglove controller source code - Flex sensor acquisition declarations
+// 2014-12-14 by Jeff Rowberg <jeff@rowberg.net>
+
+/* ============================================
+Controller code is placed under the MIT license
+Copyright (c) 2014 Jeff Rowberg
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+/**
+ * @file support_flex.h
+ * @brief Flex sensor acquisition declarations
+ * @author Jeff Rowberg
+ * @date 2014-12-14
+ */
+
+#ifndef _SUPPORT_FLEX_H_
+#define _SUPPORT_FLEX_H_
+
+#include <avr/eeprom.h>
+#include "support_helper_adc.h"
+
+#define KG_FLEX_CAL_STATUS_IDLE         0x00    ///< Using stored calibration
+#define KG_FLEX_CAL_STATUS_CAPTURING    0x01    ///< Tracking min/max while every finger is flexed through its range
+
+#define KG_FLEX_CAL_EEPROM_BASE         0x0C10  ///< EEPROM address of stored calibration (just past motion sensor offsets)
+#define KG_FLEX_CAL_RECORD_SIZE         (2 + KG_FLEX_SENSOR_COUNT * 4)  ///< EEPROM record: magic, min/max per channel (little-endian), checksum
+#define KG_FLEX_CAL_MAGIC               0xF1    ///< First byte of a valid EEPROM record
+
+extern uint8_t opt_flex_threshold;
+extern uint8_t opt_flex_interval;
+
+extern uint16_t flexRaw[KG_FLEX_SENSOR_COUNT];
+extern uint8_t flexValue[KG_FLEX_SENSOR_COUNT];
+extern uint16_t flexMin[KG_FLEX_SENSOR_COUNT];
+extern uint16_t flexMax[KG_FLEX_SENSOR_COUNT];
+
+void flex_cal_load();
+void flex_cal_save();
+void flex_cal_write_step();
+void setup_flex();
+void update_flex();
+
+#endif // _SUPPORT_FLEX_H_
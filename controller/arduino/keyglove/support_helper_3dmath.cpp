@@ -290,3 +290,244 @@ VectorFloat VectorFloat::getRotated(Quaternion *q) {
     r.rotate(q);
     return r;
 }
+
+
+
+/**
+ * @brief Initializes Q14 quaternion to known "zero" state
+ */
+QuaternionQ14::QuaternionQ14() {
+    w = 16384;
+    x = 0;
+    y = 0;
+    z = 0;
+}
+
+/**
+ * @brief Initializes Q14 quaternion with provided components
+ * @param[in] nw W element
+ * @param[in] nx X element
+ * @param[in] ny Y element
+ * @param[in] nz Z element
+ */
+QuaternionQ14::QuaternionQ14(int16_t nw, int16_t nx, int16_t ny, int16_t nz) {
+    w = nw;
+    x = nx;
+    y = ny;
+    z = nz;
+}
+
+
+
+/* ====================== */
+/* IN-PLACE BATCH KERNELS */
+/* ====================== */
+
+/**
+ * @brief Approximate 1/sqrt(value) without a division or sqrt()
+ * @param[in] value Positive input value
+ * @return Approximate inverse square root (within about 0.2%)
+ *
+ * This is the well-known exponent bit trick followed by one Newton-Raphson
+ * step, which costs three float multiplies instead of sqrt() plus a divide.
+ */
+float fast_inv_sqrt(float value) {
+    union { float f; uint32_t i; } u;
+    u.f = value;
+    u.i = 0x5F3759DF - (u.i >> 1);
+    return u.f * (1.5f - 0.5f * value * u.f * u.f);
+}
+
+/**
+ * @brief Calculate the quaternion product A * B into an existing quaternion
+ * @param[out] out Product destination (may be the same as A or B)
+ * @param[in] a First quaternion
+ * @param[in] b Second quaternion
+ */
+void quaternion_multiply(Quaternion *out, Quaternion *a, Quaternion *b) {
+    float w = a -> w*b -> w - a -> x*b -> x - a -> y*b -> y - a -> z*b -> z;
+    float x = a -> w*b -> x + a -> x*b -> w + a -> y*b -> z - a -> z*b -> y;
+    float y = a -> w*b -> y - a -> x*b -> z + a -> y*b -> w + a -> z*b -> x;
+    float z = a -> w*b -> z + a -> x*b -> y - a -> y*b -> x + a -> z*b -> w;
+    out -> w = w;
+    out -> x = x;
+    out -> y = y;
+    out -> z = z;
+}
+
+/**
+ * @brief Normalize a quaternion in place using fast_inv_sqrt()
+ * @param[in,out] q Quaternion to normalize
+ */
+void quaternion_normalize_fast(Quaternion *q) {
+    float s = fast_inv_sqrt(q -> w*q -> w + q -> x*q -> x + q -> y*q -> y + q -> z*q -> z);
+    q -> w *= s;
+    q -> x *= s;
+    q -> y *= s;
+    q -> z *= s;
+}
+
+/**
+ * @brief Build the 3x3 rotation matrix equivalent to q * P * conj(q)
+ * @param[out] m Row-major matrix (9 elements)
+ * @param[in] q Quaternion to convert
+ *
+ * The diagonal uses the full w^2+x^2-y^2-z^2 form so the matrix matches the
+ * quaternion sandwich product exactly even if q is not quite unit length.
+ */
+void quaternion_to_matrix(float *m, Quaternion *q) {
+    float ww = q -> w*q -> w, xx = q -> x*q -> x, yy = q -> y*q -> y, zz = q -> z*q -> z;
+    float wx = q -> w*q -> x, wy = q -> w*q -> y, wz = q -> w*q -> z;
+    float xy = q -> x*q -> y, xz = q -> x*q -> z, yz = q -> y*q -> z;
+    m[0] = ww + xx - yy - zz;   m[1] = 2*(xy - wz);         m[2] = 2*(xz + wy);
+    m[3] = 2*(xy + wz);         m[4] = ww - xx + yy - zz;   m[5] = 2*(yz - wx);
+    m[6] = 2*(xz - wy);         m[7] = 2*(yz + wx);         m[8] = ww - xx - yy + zz;
+}
+
+/**
+ * @brief Normalize a batch of vectors in place using fast_inv_sqrt()
+ * @param[in,out] v First vector in batch
+ * @param[in] count Number of vectors in batch
+ */
+void vector_float_normalize_batch(VectorFloat *v, uint8_t count) {
+    for (; count; count--, v++) {
+        float s = fast_inv_sqrt(v -> x*v -> x + v -> y*v -> y + v -> z*v -> z);
+        v -> x *= s;
+        v -> y *= s;
+        v -> z *= s;
+    }
+}
+
+/**
+ * @brief Rotate a batch of vectors in place by one quaternion
+ * @param[in,out] v First vector in batch
+ * @param[in] count Number of vectors in batch
+ * @param[in] q Quaternion to rotate vectors by
+ *
+ * The quaternion is converted to a matrix once, so each vector then costs 9
+ * multiplies instead of the 32 in two full quaternion products.
+ */
+void vector_float_rotate_batch(VectorFloat *v, uint8_t count, Quaternion *q) {
+    float m[9];
+    quaternion_to_matrix(m, q);
+    for (; count; count--, v++) {
+        float x = v -> x, y = v -> y, z = v -> z;
+        v -> x = m[0]*x + m[1]*y + m[2]*z;
+        v -> y = m[3]*x + m[4]*y + m[5]*z;
+        v -> z = m[6]*x + m[7]*y + m[8]*z;
+    }
+}
+
+/**
+ * @brief Rotate a batch of integer vectors in place by one quaternion
+ * @param[in,out] v First vector in batch
+ * @param[in] count Number of vectors in batch
+ * @param[in] q Quaternion to rotate vectors by
+ *
+ * Results are truncated toward zero, the same as VectorInt16::rotate().
+ */
+void vector_int16_rotate_batch(VectorInt16 *v, uint8_t count, Quaternion *q) {
+    float m[9];
+    quaternion_to_matrix(m, q);
+    for (; count; count--, v++) {
+        float x = v -> x, y = v -> y, z = v -> z;
+        v -> x = m[0]*x + m[1]*y + m[2]*z;
+        v -> y = m[3]*x + m[4]*y + m[5]*z;
+        v -> z = m[6]*x + m[7]*y + m[8]*z;
+    }
+}
+
+/**
+ * @brief Limit a 32-bit value to the int16_t range
+ * @param[in] value Value to limit
+ * @return Saturated value
+ */
+int16_t q14_saturate(int32_t value) {
+    if (value > 32767) return 32767;
+    if (value < -32768) return -32768;
+    return value;
+}
+
+/**
+ * @brief Calculate the Q14 quaternion product A * B into an existing quaternion
+ * @param[out] out Product destination (may be the same as A or B)
+ * @param[in] a First quaternion
+ * @param[in] b Second quaternion
+ *
+ * Every product is a 16x16 multiply with a 32-bit sum, which the AVR handles
+ * far faster than float math.
+ */
+void quaternion_q14_multiply(QuaternionQ14 *out, QuaternionQ14 *a, QuaternionQ14 *b) {
+    int16_t w = ((int32_t)a -> w*b -> w - (int32_t)a -> x*b -> x - (int32_t)a -> y*b -> y - (int32_t)a -> z*b -> z) >> 14;
+    int16_t x = ((int32_t)a -> w*b -> x + (int32_t)a -> x*b -> w + (int32_t)a -> y*b -> z - (int32_t)a -> z*b -> y) >> 14;
+    int16_t y = ((int32_t)a -> w*b -> y - (int32_t)a -> x*b -> z + (int32_t)a -> y*b -> w + (int32_t)a -> z*b -> x) >> 14;
+    int16_t z = ((int32_t)a -> w*b -> z + (int32_t)a -> x*b -> y - (int32_t)a -> y*b -> x + (int32_t)a -> z*b -> w) >> 14;
+    out -> w = w;
+    out -> x = x;
+    out -> y = y;
+    out -> z = z;
+}
+
+/**
+ * @brief Normalize a Q14 quaternion in place
+ * @param[in,out] q Quaternion to normalize
+ */
+void quaternion_q14_normalize(QuaternionQ14 *q) {
+    int32_t n = (int32_t)q -> w*q -> w + (int32_t)q -> x*q -> x + (int32_t)q -> y*q -> y + (int32_t)q -> z*q -> z;
+    if (n == 0) return;
+    // n is |q|^2 in Q28, so the Q14 scale factor is 2^28 / sqrt(n)
+    int32_t s = 268435456.0f * fast_inv_sqrt(n);
+    q -> w = q14_saturate(((int32_t)q -> w * s) >> 14);
+    q -> x = q14_saturate(((int32_t)q -> x * s) >> 14);
+    q -> y = q14_saturate(((int32_t)q -> y * s) >> 14);
+    q -> z = q14_saturate(((int32_t)q -> z * s) >> 14);
+}
+
+/**
+ * @brief Build the Q14 rotation matrix equivalent to q * P * conj(q)
+ * @param[out] m Row-major matrix (9 elements, Q14)
+ * @param[in] q Quaternion to convert
+ */
+void quaternion_q14_to_matrix(int16_t *m, QuaternionQ14 *q) {
+    int32_t ww = (int32_t)q -> w*q -> w, xx = (int32_t)q -> x*q -> x, yy = (int32_t)q -> y*q -> y, zz = (int32_t)q -> z*q -> z;
+    int32_t wx = (int32_t)q -> w*q -> x, wy = (int32_t)q -> w*q -> y, wz = (int32_t)q -> w*q -> z;
+    int32_t xy = (int32_t)q -> x*q -> y, xz = (int32_t)q -> x*q -> z, yz = (int32_t)q -> y*q -> z;
+    m[0] = (ww + xx - yy - zz) >> 14;   m[1] = (xy - wz) >> 13;             m[2] = (xz + wy) >> 13;
+    m[3] = (xy + wz) >> 13;             m[4] = (ww - xx + yy - zz) >> 14;   m[5] = (yz - wx) >> 13;
+    m[6] = (xz - wy) >> 13;             m[7] = (yz + wx) >> 13;             m[8] = (ww - xx - yy + zz) >> 14;
+}
+
+/**
+ * @brief Scale a batch of integer vectors in place to Q14 unit length (16384)
+ * @param[in,out] v First vector in batch
+ * @param[in] count Number of vectors in batch
+ */
+void vector_int16_normalize_q14(VectorInt16 *v, uint8_t count) {
+    for (; count; count--, v++) {
+        uint32_t n = (uint32_t)((int32_t)v -> x*v -> x) + (uint32_t)((int32_t)v -> y*v -> y) + (uint32_t)((int32_t)v -> z*v -> z);
+        if (n == 0) continue;
+        int32_t s = 16384.0f * 16384.0f * fast_inv_sqrt(n);   // Q14 scale factor
+        v -> x = q14_saturate(((int32_t)v -> x * s) >> 14);
+        v -> y = q14_saturate(((int32_t)v -> y * s) >> 14);
+        v -> z = q14_saturate(((int32_t)v -> z * s) >> 14);
+    }
+}
+
+/**
+ * @brief Rotate a batch of integer vectors in place by one Q14 quaternion
+ * @param[in,out] v First vector in batch
+ * @param[in] count Number of vectors in batch
+ * @param[in] q Quaternion to rotate vectors by
+ *
+ * Results saturate at the int16_t range rather than wrapping.
+ */
+void vector_int16_rotate_q14(VectorInt16 *v, uint8_t count, QuaternionQ14 *q) {
+    int16_t m[9];
+    quaternion_q14_to_matrix(m, q);
+    for (; count; count--, v++) {
+        int16_t x = v -> x, y = v -> y, z = v -> z;
+        v -> x = q14_saturate(((int32_t)m[0]*x + (int32_t)m[1]*y + (int32_t)m[2]*z) >> 14);
+        v -> y = q14_saturate(((int32_t)m[3]*x + (int32_t)m[4]*y + (int32_t)m[5]*z) >> 14);
+        v -> z = q14_saturate(((int32_t)m[6]*x + (int32_t)m[7]*y + (int32_t)m[8]*z) >> 14);
+    }
+}
@@ -93,4 +93,34 @@ class VectorFloat {
         VectorFloat getRotated(Quaternion *q);
 };
 
+/**
+ * @brief Provides Q14 fixed-point quaternion representation (16384 = 1.0)
+ */
+class QuaternionQ14 {
+    public:
+        int16_t w; ///< Vector rotation component of quaternion
+        int16_t x; ///< X-axis rotation component of quaternion
+        int16_t y; ///< Y-axis rotation component of quaternion
+        int16_t z; ///< Z-axis rotation component of quaternion
+
+        QuaternionQ14();
+        QuaternionQ14(int16_t nw, int16_t nx, int16_t ny, int16_t nz);
+};
+
+// in-place kernels (no temporaries, safe when output and input are the same object)
+float fast_inv_sqrt(float value);
+void quaternion_multiply(Quaternion *out, Quaternion *a, Quaternion *b);
+void quaternion_normalize_fast(Quaternion *q);
+void quaternion_to_matrix(float *m, Quaternion *q);
+void vector_float_normalize_batch(VectorFloat *v, uint8_t count);
+void vector_float_rotate_batch(VectorFloat *v, uint8_t count, Quaternion *q);
+void vector_int16_rotate_batch(VectorInt16 *v, uint8_t count, Quaternion *q);
+
+// Q14 fixed-point kernels
+void quaternion_q14_multiply(QuaternionQ14 *out, QuaternionQ14 *a, QuaternionQ14 *b);
+void quaternion_q14_normalize(QuaternionQ14 *q);
+void quaternion_q14_to_matrix(int16_t *m, QuaternionQ14 *q);
+void vector_int16_normalize_q14(VectorInt16 *v, uint8_t count);
+void vector_int16_rotate_q14(VectorInt16 *v, uint8_t count, QuaternionQ14 *q);
+
 #endif /* _SUPPORT_HELPER_3DMATH_H_ */
\ No newline at end of file
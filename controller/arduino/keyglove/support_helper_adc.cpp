@@ -0,0 +1,143 @@
+// Keyglove controller source code - Free-running oversampled ADC scan
+// 2014-12-14 by Jeff Rowberg <jeff@rowberg.net>
+
+/* ============================================
+Controller code is placed under the MIT license
+Copyright (c) 2014 Jeff Rowberg
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+/**
+ * @file support_helper_adc.cpp
+ * @brief Free-running oversampled ADC scan implementation
+ * @author Jeff Rowberg
+ * @date 2014-12-14
+ *
+ * Reads every analog sensor channel (flex sensors first, then pressure
+ * sensors) without ever blocking loop(). The ADC conversion-complete interrupt
+ * collects each reading and starts the next conversion on the next channel,
+ * so conversions run back to back across all channels. Every
+ * KG_ADC_OVERSAMPLE_COUNT readings of each channel are summed and decimated
+ * into one result with KG_ADC_OVERSAMPLE_BITS extra bits. With a 125kHz ADC
+ * clock that is about 600 results per second, shared between the channels.
+ *
+ * Each sensor module keeps its own copy of adcScanCount and calls adc_read()
+ * from loop() to pick up its part of each new set of results.
+ *
+ * ADC channel n is pin PFn on the AT90USB128x; the channels used are listed in
+ * KG_FLEX_ADC_CHANNELS and KG_PRESSURE_ADC_CHANNELS in the board support file.
+ */
+
+#include "keyglove.h"
+#include "support_board.h"
+#include "support_helper_adc.h"
+
+#define KG_ADC_PRESCALE     ((F_CPU > 8000000UL) ? 7 : 6)   ///< ADPS2:0 value for a 125kHz ADC clock (divide by 128 or 64)
+
+volatile uint8_t adcScanCount;                          ///< Incremented each time a new set of results is ready
+
+#if (KG_ADC_CHANNEL_COUNT > 0)
+/**
+ * @brief ADC input for each scan position
+ */
+const uint8_t adcChannel[KG_ADC_CHANNEL_COUNT] = {
+    #if (KG_FLEX > 0)
+        KG_FLEX_ADC_CHANNELS,
+    #endif
+    #if (KG_PRESSURE > 0)
+        KG_PRESSURE_ADC_CHANNELS,
+    #endif
+};
+
+volatile uint16_t adcAccum[KG_ADC_CHANNEL_COUNT];       ///< Sum of conversions so far for each channel
+volatile uint16_t adcResult[KG_ADC_CHANNEL_COUNT];      ///< Latest decimated result for each channel
+volatile uint8_t adcConvIndex;                          ///< Scan position whose conversion is in progress
+volatile uint8_t adcConvCount;                          ///< Complete passes over all channels towards the next result
+
+/**
+ * @brief ADC conversion complete interrupt, collects one reading and starts the next
+ *
+ * The multiplexer is switched before the next conversion is started, so no
+ * reading is ever taken across a channel change and none need to be thrown
+ * away.
+ */
+ISR(ADC_vect) {
+    adcAccum[adcConvIndex] += ADC;
+    if (++adcConvIndex >= KG_ADC_CHANNEL_COUNT) {
+        adcConvIndex = 0;
+        if (++adcConvCount >= KG_ADC_OVERSAMPLE_COUNT) {
+            adcConvCount = 0;
+            for (uint8_t i = 0; i < KG_ADC_CHANNEL_COUNT; i++) {
+                adcResult[i] = adcAccum[i] >> KG_ADC_OVERSAMPLE_BITS;
+                adcAccum[i] = 0;
+            }
+            adcScanCount++;
+        }
+    }
+    ADMUX = (1 << REFS0) | adcChannel[adcConvIndex];
+    ADCSRA |= (1 << ADSC);
+}
+#endif
+
+/**
+ * @brief Configure sensor inputs and start continuous conversion
+ */
+void setup_adc() {
+    adcScanCount = 0;
+    #if (KG_ADC_CHANNEL_COUNT > 0)
+        adcConvIndex = adcConvCount = 0;
+
+        // analog inputs: no pull-ups, and digital input buffers off to save power
+        for (uint8_t i = 0; i < KG_ADC_CHANNEL_COUNT; i++) {
+            adcAccum[i] = 0;
+            DDRF &= ~(1 << adcChannel[i]);
+            PORTF &= ~(1 << adcChannel[i]);
+            DIDR0 |= (1 << adcChannel[i]);
+        }
+
+        // AVcc reference, interrupt on each conversion, first one started here
+        ADMUX = (1 << REFS0) | adcChannel[0];
+        ADCSRB = 0;
+        ADCSRA = (1 << ADEN) | (1 << ADIE) | (1 << ADSC) | KG_ADC_PRESCALE;
+    #endif
+}
+
+/**
+ * @brief Copy out part of the latest results if they are new to the caller
+ * @param[in] first First scan position to copy (e.g. KG_ADC_INDEX_PRESSURE)
+ * @param[in] count Number of results to copy
+ * @param[out] results Destination for results
+ * @param[in,out] scan Caller's adcScanCount from its previous read
+ * @return Non-zero if new results were copied, zero if nothing has changed
+ */
+uint8_t adc_read(uint8_t first, uint8_t count, uint16_t *results, uint8_t *scan) {
+    #if (KG_ADC_CHANNEL_COUNT > 0)
+        if (*scan == adcScanCount) return 0;
+        uint8_t sreg = SREG;
+        cli();
+        for (uint8_t i = 0; i < count; i++) results[i] = adcResult[first + i];
+        *scan = adcScanCount;
+        SREG = sreg;
+        return 1;
+    #else
+        return 0;
+    #endif
+}
@@ -0,0 +1,67 @@
+// Keyglove controller source code - Free-running oversampled ADC scan
+// 2014-12-14 by Jeff Rowberg <jeff@rowberg.net>
+
+/* ============================================
+Controller code is placed under the MIT license
+Copyright (c) 2014 Jeff Rowberg
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+/**
+ * @file support_helper_adc.h
+ * @brief Free-running oversampled ADC scan declarations
+ * @author Jeff Rowberg
+ * @date 2014-12-14
+ */
+
+#ifndef _SUPPORT_HELPER_ADC_H_
+#define _SUPPORT_HELPER_ADC_H_
+
+#if (KG_FLEX & KG_FLEX_5FINGERS)
+    #define KG_FLEX_SENSOR_COUNT        5       ///< Number of flex sensors incorporated in design
+#else
+    #define KG_FLEX_SENSOR_COUNT        0
+#endif
+
+#if (KG_PRESSURE & KG_PRESSURE_5TIPS)
+    #define KG_PRESSURE_SENSOR_COUNT    5       ///< Number of pressure sensors incorporated in design
+#else
+    #define KG_PRESSURE_SENSOR_COUNT    0
+#endif
+
+#define KG_ADC_CHANNEL_COUNT            (KG_FLEX_SENSOR_COUNT + KG_PRESSURE_SENSOR_COUNT)   ///< Total ADC channels scanned
+#define KG_ADC_INDEX_FLEX               0                       ///< First scan result belonging to flex sensors
+#define KG_ADC_INDEX_PRESSURE           KG_FLEX_SENSOR_COUNT    ///< First scan result belonging to pressure sensors
+
+#if (KG_ADC_CHANNEL_COUNT > 8)
+    #error Only eight ADC inputs are available, so flex and pressure sensors cannot both be fully fitted
+#endif
+
+#define KG_ADC_OVERSAMPLE_BITS          2       ///< Extra bits of resolution from oversampling (4^n conversions per result)
+#define KG_ADC_OVERSAMPLE_COUNT         (1 << (2 * KG_ADC_OVERSAMPLE_BITS))     ///< Conversions per channel per result
+#define KG_ADC_RAW_MAX                  ((1024 << KG_ADC_OVERSAMPLE_BITS) - 1)  ///< Largest oversampled result (12 bits)
+
+extern volatile uint8_t adcScanCount;
+
+void setup_adc();
+uint8_t adc_read(uint8_t first, uint8_t count, uint16_t *results, uint8_t *scan);
+
+#endif // _SUPPORT_HELPER_ADC_H_
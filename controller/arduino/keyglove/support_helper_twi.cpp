@@ -0,0 +1,280 @@
+// Keyglove controller source code - Interrupt-driven I2C (TWI) transaction queue implementation
+// 2014-12-14 by Jeff Rowberg <jeff@rowberg.net>
+
+/* ============================================
+Controller code is placed under the MIT license
+Copyright (c) 2014 Jeff Rowberg
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+/**
+ * @file support_helper_twi.cpp
+ * @brief Interrupt-driven I2C (TWI) transaction queue implementation
+ * @author Jeff Rowberg
+ * @date 2014-12-14
+ *
+ * Replaces the blocking Wire/I2Cdev path for motion sensors. Transactions are
+ * queued from the main loop and moved byte by byte by the TWI interrupt, so
+ * loop() is free to scan touch sensors and service the host while a sensor
+ * read is in flight. Completion callbacks run from update_twi() in the main
+ * loop, never from the interrupt, so they may send packets or queue more
+ * transactions.
+ *
+ * Every transaction is a register access: START, SLA+W, register, then either
+ * the data bytes for a write or a repeated START, SLA+R and the data bytes for
+ * a read, then STOP. Back-to-back transactions chain STOP+START directly from
+ * the interrupt without waiting for the main loop.
+ */
+
+#include "keyglove.h"
+#include "support_helper_twi.h"
+
+#define TWCR_NEXT   ((1 << TWINT) | (1 << TWEN) | (1 << TWIE))     ///< TWCR value to continue with the next bus step
+
+twi_transaction_t *twiQueue[KG_TWI_QUEUE_SIZE];     ///< Transactions waiting for or using the bus (head is active)
+volatile uint8_t twiQueueHead;                      ///< Index of active transaction in twiQueue
+volatile uint8_t twiQueueCount;                     ///< Number of transactions in twiQueue
+twi_transaction_t *twiDone[KG_TWI_QUEUE_SIZE];      ///< Finished transactions waiting for their callbacks
+volatile uint8_t twiDoneHead;                       ///< Index of oldest entry in twiDone
+volatile uint8_t twiDoneCount;                      ///< Number of entries in twiDone
+uint8_t twiIndex;                                   ///< Data byte position within active transaction
+volatile uint32_t twiStartTime;                     ///< millis() when active transaction started
+
+/**
+ * @brief Start the transaction at the head of the queue, with interrupts disabled
+ * @param[in] control Extra TWCR bits (TWSTO to finish the previous transaction first)
+ */
+void twi_begin(uint8_t control) {
+    twiQueue[twiQueueHead]->status = KG_TWI_STATUS_ACTIVE;
+    twiIndex = 0;
+    twiStartTime = millis();
+    TWCR = TWCR_NEXT | (1 << TWSTA) | control;
+}
+
+/**
+ * @brief Finish the active transaction and start the next one, with interrupts disabled
+ * @param[in] status Final transaction status
+ */
+void twi_end(uint8_t status) {
+    twi_transaction_t *transaction = twiQueue[twiQueueHead];
+    transaction->status = status;
+    twiDone[(twiDoneHead + twiDoneCount) % KG_TWI_QUEUE_SIZE] = transaction;
+    twiDoneCount++;
+    twiQueueHead = (twiQueueHead + 1) % KG_TWI_QUEUE_SIZE;
+    if (--twiQueueCount) {
+        twi_begin(1 << TWSTO); // hardware sends STOP then START
+    } else {
+        TWCR = TWCR_NEXT | (1 << TWSTO);
+    }
+}
+
+/**
+ * @brief TWI state machine interrupt, one call per bus event
+ */
+ISR(TWI_vect) {
+    twi_transaction_t *transaction = twiQueue[twiQueueHead];
+    switch (TWSR & 0xF8) {
+        case 0x08: // START sent, always address for write first to set the register
+            TWDR = transaction->address << 1;
+            TWCR = TWCR_NEXT;
+            break;
+        case 0x10: // repeated START sent, address for read
+            TWDR = (transaction->address << 1) | 1;
+            TWCR = TWCR_NEXT;
+            break;
+        case 0x18: // SLA+W acknowledged, send register
+            TWDR = transaction->reg;
+            TWCR = TWCR_NEXT;
+            break;
+        case 0x28: // register or data byte acknowledged
+            if (transaction->flags & KG_TWI_FLAG_READ) {
+                TWCR = TWCR_NEXT | (1 << TWSTA);
+            } else if (twiIndex < transaction->length) {
+                TWDR = transaction->data[twiIndex++];
+                TWCR = TWCR_NEXT;
+            } else {
+                twi_end(KG_TWI_STATUS_OK);
+            }
+            break;
+        case 0x40: // SLA+R acknowledged, ACK every byte but the last
+            TWCR = TWCR_NEXT | (transaction->length > 1 ? (1 << TWEA) : 0);
+            break;
+        case 0x50: // byte received and ACKed
+            transaction->data[twiIndex++] = TWDR;
+            TWCR = TWCR_NEXT | (twiIndex + 1 < transaction->length ? (1 << TWEA) : 0);
+            break;
+        case 0x58: // last byte received and NACKed
+            transaction->data[twiIndex++] = TWDR;
+            twi_end(KG_TWI_STATUS_OK);
+            break;
+        case 0x20: // SLA+W not acknowledged
+        case 0x30: // data byte not acknowledged
+        case 0x48: // SLA+R not acknowledged
+            twi_end(KG_TWI_STATUS_NACK);
+            break;
+        default: // bus error (0x00) or lost arbitration (0x38)
+            twi_end(KG_TWI_STATUS_BUS_ERROR);
+            break;
+    }
+}
+
+/**
+ * @brief Initialize TWI hardware for interrupt-driven master operation
+ */
+void setup_twi() {
+    twiQueueHead = twiQueueCount = 0;
+    twiDoneHead = twiDoneCount = 0;
+
+    // SCL = PD0, SDA = PD1, enable internal pull-ups like the Wire library does
+    digitalWrite(0, HIGH);
+    digitalWrite(1, HIGH);
+
+    TWSR = 0; // prescaler 1
+    TWBR = ((F_CPU / KG_TWI_FREQ) - 16) / 2;
+    TWCR = (1 << TWEN) | (1 << TWIE);
+}
+
+/**
+ * @brief Run callbacks for finished transactions and recover a stuck bus, called from loop()
+ */
+void update_twi() {
+    // a device holding SDA low (e.g. reset mid-transfer) would otherwise stall the queue forever
+    uint8_t sreg = SREG;
+    cli();
+    if (twiQueueCount && millis() - twiStartTime > KG_TWI_TIMEOUT) {
+        TWCR = 0; // release the bus
+        TWCR = (1 << TWEN) | (1 << TWIE);
+        twi_transaction_t *transaction = twiQueue[twiQueueHead];
+        transaction->status = KG_TWI_STATUS_TIMEOUT;
+        twiDone[(twiDoneHead + twiDoneCount) % KG_TWI_QUEUE_SIZE] = transaction;
+        twiDoneCount++;
+        twiQueueHead = (twiQueueHead + 1) % KG_TWI_QUEUE_SIZE;
+        if (--twiQueueCount) twi_begin(0);
+    }
+    SREG = sreg;
+
+    while (twiDoneCount) {
+        twi_transaction_t *transaction = twiDone[twiDoneHead];
+        sreg = SREG;
+        cli();
+        twiDoneHead = (twiDoneHead + 1) % KG_TWI_QUEUE_SIZE;
+        twiDoneCount--;
+        SREG = sreg;
+        if (transaction->callback) transaction->callback(transaction);
+    }
+}
+
+/**
+ * @brief Add a prepared transaction to the bus queue
+ * @param[in] transaction Transaction to queue (must not already be queued)
+ * @return Zero if queued, non-zero if the queue is full
+ */
+uint8_t twi_queue(twi_transaction_t *transaction) {
+    uint8_t result = 1;
+    uint8_t sreg = SREG;
+    cli();
+    if (twiQueueCount + twiDoneCount < KG_TWI_QUEUE_SIZE) {
+        transaction->status = KG_TWI_STATUS_QUEUED;
+        twiQueue[(twiQueueHead + twiQueueCount) % KG_TWI_QUEUE_SIZE] = transaction;
+        if (twiQueueCount++ == 0) twi_begin(0);
+        result = 0;
+    }
+    SREG = sreg;
+    return result;
+}
+
+/**
+ * @brief Queue a register read
+ * @param[in] transaction Transaction storage to use
+ * @param[in] address 7-bit device address
+ * @param[in] reg First register to read
+ * @param[out] data Buffer to fill
+ * @param[in] length Number of bytes to read (at least 1)
+ * @param[in] callback Function to call from update_twi() when done, or 0
+ * @return Zero if queued, non-zero if the queue is full
+ */
+uint8_t twi_read(twi_transaction_t *transaction, uint8_t address, uint8_t reg, uint8_t *data, uint8_t length, void (*callback)(twi_transaction_t *)) {
+    transaction->address = address;
+    transaction->reg = reg;
+    transaction->flags = KG_TWI_FLAG_READ;
+    transaction->data = data;
+    transaction->length = length;
+    transaction->callback = callback;
+    return twi_queue(transaction);
+}
+
+/**
+ * @brief Queue a register write
+ * @param[in] transaction Transaction storage to use
+ * @param[in] address 7-bit device address
+ * @param[in] reg First register to write
+ * @param[in] data Bytes to write (must stay valid until done)
+ * @param[in] length Number of bytes to write
+ * @param[in] callback Function to call from update_twi() when done, or 0
+ * @return Zero if queued, non-zero if the queue is full
+ */
+uint8_t twi_write(twi_transaction_t *transaction, uint8_t address, uint8_t reg, uint8_t *data, uint8_t length, void (*callback)(twi_transaction_t *)) {
+    transaction->address = address;
+    transaction->reg = reg;
+    transaction->flags = 0;
+    transaction->data = data;
+    transaction->length = length;
+    transaction->callback = callback;
+    return twi_queue(transaction);
+}
+
+/**
+ * @brief Block until a queued transaction finishes, running any pending callbacks
+ * @param[in] transaction Transaction to wait for
+ * @return Final transaction status
+ */
+uint8_t twi_wait(twi_transaction_t *transaction) {
+    while (transaction->status < KG_TWI_STATUS_OK) update_twi();
+    update_twi();
+    return transaction->status;
+}
+
+/**
+ * @brief Write one register and wait for completion (for setup code)
+ * @param[in] address 7-bit device address
+ * @param[in] reg Register to write
+ * @param[in] value Value to write
+ * @return Final transaction status (KG_TWI_STATUS_OK on success)
+ */
+uint8_t twi_write_byte_sync(uint8_t address, uint8_t reg, uint8_t value) {
+    twi_transaction_t transaction;
+    while (twi_write(&transaction, address, reg, &value, 1, 0)) update_twi();
+    return twi_wait(&transaction);
+}
+
+/**
+ * @brief Read registers and wait for completion (for setup code)
+ * @param[in] address 7-bit device address
+ * @param[in] reg First register to read
+ * @param[out] data Buffer to fill
+ * @param[in] length Number of bytes to read (at least 1)
+ * @return Final transaction status (KG_TWI_STATUS_OK on success)
+ */
+uint8_t twi_read_bytes_sync(uint8_t address, uint8_t reg, uint8_t *data, uint8_t length) {
+    twi_transaction_t transaction;
+    while (twi_read(&transaction, address, reg, data, length, 0)) update_twi();
+    return twi_wait(&transaction);
+}
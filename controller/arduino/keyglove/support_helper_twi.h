@@ -0,0 +1,79 @@
+// Keyglove controller source code - Interrupt-driven I2C (TWI) transaction queue declarations
+// 2014-12-14 by Jeff Rowberg <jeff@rowberg.net>
+
+/* ============================================
+Controller code is placed under the MIT license
+Copyright (c) 2014 Jeff Rowberg
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+/**
+ * @file support_helper_twi.h
+ * @brief Interrupt-driven I2C (TWI) transaction queue declarations
+ * @author Jeff Rowberg
+ * @date 2014-12-14
+ */
+
+#ifndef _SUPPORT_HELPER_TWI_H_
+#define _SUPPORT_HELPER_TWI_H_
+
+#define KG_TWI_FREQ                     400000  ///< I2C bus clock in Hz
+#define KG_TWI_QUEUE_SIZE               8       ///< Maximum transactions queued or awaiting callback at once
+#define KG_TWI_TIMEOUT                  10      ///< Milliseconds before a stuck transaction is abandoned and the bus reset
+
+#define KG_TWI_FLAG_READ                0x01    ///< Transaction reads from the register instead of writing to it
+
+#define KG_TWI_STATUS_IDLE              0       ///< Transaction not queued
+#define KG_TWI_STATUS_QUEUED            1       ///< Transaction waiting for the bus
+#define KG_TWI_STATUS_ACTIVE            2       ///< Transaction in progress
+#define KG_TWI_STATUS_OK                3       ///< Transaction completed successfully
+#define KG_TWI_STATUS_NACK              4       ///< Device did not acknowledge address or data
+#define KG_TWI_STATUS_BUS_ERROR         5       ///< Illegal bus condition or lost arbitration
+#define KG_TWI_STATUS_TIMEOUT           6       ///< Transaction did not finish within KG_TWI_TIMEOUT
+
+/**
+ * @brief One register read or write on the I2C bus
+ *
+ * The caller owns the storage for both the transaction and its data buffer,
+ * and must not touch either again until the status is KG_TWI_STATUS_OK or
+ * higher (i.e. after the callback).
+ */
+typedef struct twi_transaction_t {
+    uint8_t address;                            ///< 7-bit device address
+    uint8_t reg;                                ///< First register to read or write
+    uint8_t flags;                              ///< KG_TWI_FLAG_* bits
+    uint8_t *data;                              ///< Data to write, or buffer to fill when reading
+    uint8_t length;                             ///< Number of data bytes (at least one for reads)
+    void (*callback)(struct twi_transaction_t *transaction);   ///< Called from update_twi() when done, or 0
+    volatile uint8_t status;                    ///< KG_TWI_STATUS_* value
+} twi_transaction_t;
+
+void setup_twi();
+void update_twi();
+
+uint8_t twi_queue(twi_transaction_t *transaction);
+uint8_t twi_read(twi_transaction_t *transaction, uint8_t address, uint8_t reg, uint8_t *data, uint8_t length, void (*callback)(twi_transaction_t *));
+uint8_t twi_write(twi_transaction_t *transaction, uint8_t address, uint8_t reg, uint8_t *data, uint8_t length, void (*callback)(twi_transaction_t *));
+uint8_t twi_wait(twi_transaction_t *transaction);
+uint8_t twi_write_byte_sync(uint8_t address, uint8_t reg, uint8_t value);
+uint8_t twi_read_bytes_sync(uint8_t address, uint8_t reg, uint8_t *data, uint8_t length);
+
+#endif // _SUPPORT_HELPER_TWI_H_
@@ -44,12 +44,23 @@ THE SOFTWARE.
 #include "support_bluetooth2_iwrap.h"
 
 uint8_t hidModifiersDown = 0;                   ///< Modifier keys currently down
-uint8_t hidKeysDown[] = { 0, 0, 0, 0, 0, 0 };   ///< Normal keys currently down
+uint8_t hidKeyState[32];                        ///< Bitmap of normal keys currently down (one bit per usage code)
+uint8_t hidKeysDown[] = { 0, 0, 0, 0, 0, 0 };   ///< Normal keys in the current 6KRO (boot protocol) report
+
+uint8_t hidKeyboardSentUSB[8];                              ///< Last keyboard report sent over USB HID
+uint8_t hidKeyboardSentBT2[1 + BT2_HID_NKRO_BITMAP_SIZE];   ///< Last keyboard report sent over Bluetooth HID
+
+uint8_t opt_hid_keyboard_nkro = 0;              ///< OPTION: Send NKRO reports when KG_HID_KEYBOARD_NKRO is enabled (0 = boot protocol 6KRO only, needs the NKRO iWRAP descriptor if 1)
 
 /**
  * @brief Initialize HID keyboard behavior
  */
 void setup_hid_keyboard() {
+    hidModifiersDown = 0;
+    memset(hidKeyState, 0, sizeof(hidKeyState));
+    memset(hidKeysDown, 0, sizeof(hidKeysDown));
+    memset(hidKeyboardSentUSB, 0, sizeof(hidKeyboardSentUSB));
+    memset(hidKeyboardSentBT2, 0, sizeof(hidKeyboardSentBT2));
 }
 
 /*
@@ -59,74 +70,88 @@ void update_hid_keyboard() {
 }
 */
 
+/**
+ * @brief Fill any empty 6KRO report slots with keys that are down but not yet reported
+ *
+ * Slots are never reordered, so a key which is already in the report stays put
+ * while other keys come and go. Keys beyond the sixth remain in the bitmap and
+ * move into the 6KRO report as soon as a slot frees up.
+ */
+void hid_keyboard_fill_slots() {
+    for (uint8_t slot = 0; slot < 6; slot++) {
+        if (hidKeysDown[slot] != 0) continue;
+        for (uint16_t code = 1; code < 256; code++) {
+            if ((hidKeyState[code >> 3] & (1 << (code & 7))) == 0) continue;
+            if (memchr(hidKeysDown, code, 6) != 0) continue;
+            hidKeysDown[slot] = code;
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Build the current keyboard report and send it on each transport where it changed
+ *
+ * One 8-byte boot protocol report is built for all transports. Bluetooth sends
+ * the NKRO bitmap report instead when KG_HID_KEYBOARD_NKRO is enabled and the
+ * opt_hid_keyboard_nkro option is set. Nothing is sent unless the report for a
+ * given transport actually differs from the last one sent on it.
+ */
+void hid_keyboard_send_report() {
+    uint8_t report[8];
+    report[0] = hidModifiersDown;
+    report[1] = 0;
+    memcpy(report + 2, hidKeysDown, 6);
+
+    #if KG_HOSTIF & KG_HOSTIF_USB_HID
+        if (!interfaceUSBHIDReady) {
+            // host will see all keys up after (re)connecting
+            memset(hidKeyboardSentUSB, 0, sizeof(hidKeyboardSentUSB));
+        } else if (memcmp(report, hidKeyboardSentUSB, 8) != 0) {
+            Keyboard.set_modifier(report[0]);
+            Keyboard.set_key1(report[2]);
+            Keyboard.set_key2(report[3]);
+            Keyboard.set_key3(report[4]);
+            Keyboard.set_key4(report[5]);
+            Keyboard.set_key5(report[6]);
+            Keyboard.set_key6(report[7]);
+            Keyboard.send_now();
+            memcpy(hidKeyboardSentUSB, report, 8);
+        }
+    #endif /* KG_HOSTIF_USB_HID */
+
+    #if KG_HOSTIF & KG_HOSTIF_BT2_HID
+        if (!interfaceBT2HIDReady) {
+            // host will see all keys up after (re)connecting
+            memset(hidKeyboardSentBT2, 0, sizeof(hidKeyboardSentBT2));
+        }
+        #if (KG_HID & KG_HID_KEYBOARD_NKRO)
+            else if (opt_hid_keyboard_nkro) {
+                if (hidKeyboardSentBT2[0] != hidModifiersDown || memcmp(hidKeyboardSentBT2 + 1, hidKeyState, BT2_HID_NKRO_BITMAP_SIZE) != 0) {
+                    BTKeyboard.send_nkro(hidModifiersDown, hidKeyState);
+                    hidKeyboardSentBT2[0] = hidModifiersDown;
+                    memcpy(hidKeyboardSentBT2 + 1, hidKeyState, BT2_HID_NKRO_BITMAP_SIZE);
+                }
+            }
+        #endif /* KG_HID_KEYBOARD_NKRO */
+        else if (memcmp(report, hidKeyboardSentBT2, 8) != 0) {
+            BTKeyboard.set_report(report);
+            BTKeyboard.send_now();
+            memcpy(hidKeyboardSentBT2, report, 8);
+        }
+    #endif /* KG_HOSTIF_BT2_HID */
+}
+
 /**
  * @brief Send key press (down) HID report
  * @param[in] code Key code
  */
 void keyboard_key_down(uint8_t code) {
     #if KG_HID & KG_HID_KEYBOARD
-        uint8_t usePos = 0;
-        for (usePos = 0; usePos < 6 && hidKeysDown[usePos] != 0; usePos++);
-        if (usePos == 6) return; // out of HID keyboard buffer space, REALLY weird for the Keyglove!
-        hidKeysDown[usePos] = code;
-        switch (usePos) {
-            case 0:
-                #if KG_HOSTIF & KG_HOSTIF_USB_HID
-                    Keyboard.set_key1(code);
-                #endif /* ENABLE_USB */
-                #if KG_HOSTIF & KG_HOSTIF_BT2_HID
-                    BTKeyboard.set_key1(code);
-                #endif /* ENABLE_BLUETOOTH */
-                break;
-            case 1:
-                #if KG_HOSTIF & KG_HOSTIF_USB_HID
-                    Keyboard.set_key2(code);
-                #endif /* ENABLE_USB */
-                #if KG_HOSTIF & KG_HOSTIF_BT2_HID
-                    BTKeyboard.set_key2(code);
-                #endif /* ENABLE_BLUETOOTH */
-                break;
-            case 2:
-                #if KG_HOSTIF & KG_HOSTIF_USB_HID
-                    Keyboard.set_key3(code);
-                #endif /* ENABLE_USB */
-                #if KG_HOSTIF & KG_HOSTIF_BT2_HID
-                    BTKeyboard.set_key3(code);
-                #endif /* ENABLE_BLUETOOTH */
-                break;
-            case 3:
-                #if KG_HOSTIF & KG_HOSTIF_USB_HID
-                    Keyboard.set_key4(code);
-                #endif /* ENABLE_USB */
-                #if KG_HOSTIF & KG_HOSTIF_BT2_HID
-                    BTKeyboard.set_key4(code);
-                #endif /* ENABLE_BLUETOOTH */
-                break;
-            case 4:
-                #if KG_HOSTIF & KG_HOSTIF_USB_HID
-                    Keyboard.set_key5(code);
-                #endif /* ENABLE_USB */
-                #if KG_HOSTIF & KG_HOSTIF_BT2_HID
-                    BTKeyboard.set_key5(code);
-                #endif /* ENABLE_BLUETOOTH */
-                break;
-            case 5:
-                #if KG_HOSTIF & KG_HOSTIF_USB_HID
-                    Keyboard.set_key6(code);
-                #endif /* ENABLE_USB */
-                #if KG_HOSTIF & KG_HOSTIF_BT2_HID
-                    BTKeyboard.set_key6(code);
-                #endif /* ENABLE_BLUETOOTH */
-                break;
-        }
-        #if KG_HOSTIF & KG_HOSTIF_USB_HID
-            if (interfaceUSBHIDReady) {
-                Keyboard.send_now();
-            }
-        #endif /* ENABLE_USB */
-        #if KG_HOSTIF & KG_HOSTIF_BT2_HID
-            BTKeyboard.send_now();
-        #endif /* ENABLE_BLUETOOTH */
+        if (code == 0) return;
+        hidKeyState[code >> 3] |= (1 << (code & 7));
+        hid_keyboard_fill_slots();
+        hid_keyboard_send_report();
     #endif
 }
 
@@ -136,70 +161,14 @@ void keyboard_key_down(uint8_t code) {
  */
 void keyboard_key_up(uint8_t code) {
     #if KG_HID & KG_HID_KEYBOARD
-        uint8_t usePos = 0;
-        for (usePos = 0; usePos < 6 && hidKeysDown[usePos] != code; usePos++);
-        if (usePos == 6) return; // key not currently down...oops.
-        hidKeysDown[usePos] = 0;
-        switch (usePos) {
-            case 0:
-                #if KG_HOSTIF & KG_HOSTIF_USB_HID
-                    Keyboard.set_key1(0);
-                #endif /* ENABLE_USB */
-                #if KG_HOSTIF & KG_HOSTIF_BT2_HID
-                    BTKeyboard.set_key1(0);
-                #endif /* ENABLE_BLUETOOTH */
-                break;
-            case 1:
-                #if KG_HOSTIF & KG_HOSTIF_USB_HID
-                    Keyboard.set_key2(0);
-                #endif /* ENABLE_USB */
-                #if KG_HOSTIF & KG_HOSTIF_BT2_HID
-                    BTKeyboard.set_key2(0);
-                #endif /* ENABLE_BLUETOOTH */
-                break;
-            case 2:
-                #if KG_HOSTIF & KG_HOSTIF_USB_HID
-                    Keyboard.set_key3(0);
-                #endif /* ENABLE_USB */
-                #if KG_HOSTIF & KG_HOSTIF_BT2_HID
-                    BTKeyboard.set_key3(0);
-                #endif /* ENABLE_BLUETOOTH */
-                break;
-            case 3:
-                #if KG_HOSTIF & KG_HOSTIF_USB_HID
-                    Keyboard.set_key4(0);
-                #endif /* ENABLE_USB */
-                #if KG_HOSTIF & KG_HOSTIF_BT2_HID
-                    BTKeyboard.set_key4(0);
-                #endif /* ENABLE_BLUETOOTH */
-                break;
-            case 4:
-                #if KG_HOSTIF & KG_HOSTIF_USB_HID
-                    Keyboard.set_key5(0);
-                #endif /* ENABLE_USB */
-                #if KG_HOSTIF & KG_HOSTIF_BT2_HID
-                    BTKeyboard.set_key5(0);
-                #endif /* ENABLE_BLUETOOTH */
-                break;
-            case 5:
-                #if KG_HOSTIF & KG_HOSTIF_USB_HID
-                    Keyboard.set_key6(0);
-                #endif /* ENABLE_USB */
-                #if KG_HOSTIF & KG_HOSTIF_BT2_HID
-                    BTKeyboard.set_key6(0);
-                #endif /* ENABLE_BLUETOOTH */
-                break;
+        if ((hidKeyState[code >> 3] & (1 << (code & 7))) == 0) return; // key not currently down...oops.
+        hidKeyState[code >> 3] &= ~(1 << (code & 7));
+        uint8_t *slot = (uint8_t *)memchr(hidKeysDown, code, 6);
+        if (slot != 0) {
+            *slot = 0;
+            hid_keyboard_fill_slots();
         }
-        #if KG_HOSTIF & KG_HOSTIF_USB_HID
-            if (interfaceUSBHIDReady) {
-                Keyboard.send_now();
-            }
-        #endif /* ENABLE_USB */
-        #if KG_HOSTIF & KG_HOSTIF_BT2_HID
-            if (interfaceBT2HIDReady) {
-                BTKeyboard.send_now();
-            }
-        #endif /* ENABLE_BLUETOOTH */
+        hid_keyboard_send_report();
     #endif
 }
 
@@ -220,14 +189,7 @@ void keyboard_key_press(uint8_t code) {
 void keyboard_modifier_down(uint8_t code) {
     #if KG_HID & KG_HID_KEYBOARD
         hidModifiersDown = hidModifiersDown | code;
-        #if KG_HOSTIF & KG_HOSTIF_USB_HID
-            Keyboard.set_modifier(hidModifiersDown);
-            Keyboard.send_now();
-        #endif /* ENABLE_USB */
-        #if KG_HOSTIF & KG_HOSTIF_BT2_HID
-            BTKeyboard.set_modifier(hidModifiersDown);
-            BTKeyboard.send_now();
-        #endif /* ENABLE_USB */
+        hid_keyboard_send_report();
     #endif
 }
 
@@ -238,15 +200,8 @@ void keyboard_modifier_down(uint8_t code) {
 void keyboard_modifier_up(uint8_t code) {
     #if KG_HID & KG_HID_KEYBOARD
         if ((hidModifiersDown & code) > 0) {
-            hidModifiersDown -= code;
-            #if KG_HOSTIF & KG_HOSTIF_USB_HID
-                Keyboard.set_modifier(hidModifiersDown);
-                Keyboard.send_now();
-            #endif /* ENABLE_USB */
-            #if KG_HOSTIF & KG_HOSTIF_USB_HID
-                BTKeyboard.set_modifier(hidModifiersDown);
-                BTKeyboard.send_now();
-            #endif /* ENABLE_USB */
+            hidModifiersDown &= ~code;
+            hid_keyboard_send_report();
         }
     #endif
 }
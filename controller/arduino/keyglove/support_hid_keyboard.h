@@ -179,11 +179,15 @@ THE SOFTWARE.
 #endif /* !KEYPAD_ASTERISK */
 
 extern uint8_t hidModifiersDown;
+extern uint8_t hidKeyState[32];
 extern uint8_t hidKeysDown[6];
+extern uint8_t opt_hid_keyboard_nkro;
 
 void setup_hid_keyboard();
 //void update_hid_keyboard() {
 
+void hid_keyboard_send_report();
+
 void keyboard_key_down(uint8_t code);
 void keyboard_key_up(uint8_t code);
 void keyboard_key_press(uint8_t code);
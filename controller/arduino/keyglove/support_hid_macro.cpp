@@ -0,0 +1,406 @@
+// Keyglove controller source code - HID keyboard macro playback implementations
+// 2014-12-14 by Jeff Rowberg <jeff@rowberg.net>
+
+/* ============================================
+Controller code is placed under the MIT license
+Copyright (c) 2014 Jeff Rowberg
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+
+/**
+ * @file support_hid_macro.cpp
+ * @brief HID keyboard macro playback implementations
+ * @author Jeff Rowberg
+ * @date 2014-12-14
+ *
+ * This file provides supporting code for typing stored keyboard macros to a
+ * connected host. A macro is either built into the firmware (a string in
+ * program memory, see hid_macro_play_P()) or stored in one of the EEPROM macro
+ * slots over KGAPI with the "touchset_set_macro" command.
+ *
+ * Playback never blocks. Each call to update_hid_macro() from loop() performs
+ * at most one step (one HID keyboard report), and only once the configured
+ * step interval has elapsed, so touch detection keeps running at full speed
+ * while a long macro is being typed. A new touch cancels any macro still in
+ * progress.
+ *
+ * Normally it is not necessary to edit this file.
+ */
+
+#include "keyglove.h"
+#include "support_board.h"
+#include "support_protocol.h"
+#include "support_hid_keyboard.h"
+#include "support_hid_macro.h"
+#if (KG_PRESSURE > 0)
+    #include "support_pressure.h"
+#endif
+
+#define KG_HID_MACRO_SOURCE_NONE        0       ///< No macro playing
+#define KG_HID_MACRO_SOURCE_FLASH       1       ///< Playing a macro from program memory
+#define KG_HID_MACRO_SOURCE_EEPROM      2       ///< Playing a macro from an EEPROM slot
+
+#define KG_HID_MACRO_ASCII_SHIFT        0x80    ///< Flag in ASCII table entries for characters which need shift
+
+/**
+ * @brief HID usage codes for printable ASCII characters 0x20-0x7E (US layout)
+ */
+const uint8_t hidMacroASCII[] PROGMEM = {
+    0x2C, 0x9E, 0xB4, 0xA0, 0xA1, 0xA2, 0xA4, 0x34,  //   ! " # $ % & '
+    0xA6, 0xA7, 0xA5, 0xAE, 0x36, 0x2D, 0x37, 0x38,  // ( ) * + , - . /
+    0x27, 0x1E, 0x1F, 0x20, 0x21, 0x22, 0x23, 0x24,  // 0 1 2 3 4 5 6 7
+    0x25, 0x26, 0xB3, 0x33, 0xB6, 0x2E, 0xB7, 0xB8,  // 8 9 : ; < = > ?
+    0x9F, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8A,  // @ A B C D E F G
+    0x8B, 0x8C, 0x8D, 0x8E, 0x8F, 0x90, 0x91, 0x92,  // H I J K L M N O
+    0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A,  // P Q R S T U V W
+    0x9B, 0x9C, 0x9D, 0x2F, 0x31, 0x30, 0xA3, 0xAD,  // X Y Z [ \ ] ^ _
+    0x35, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A,  // ` a b c d e f g
+    0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x10, 0x11, 0x12,  // h i j k l m n o
+    0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A,  // p q r s t u v w
+    0x1B, 0x1C, 0x1D, 0xAF, 0xB1, 0xB0, 0xB5,        // x y z { | } ~
+};
+
+uint8_t opt_hid_macro_step_interval = 8;    ///< OPTION: Milliseconds between macro HID reports (a typed character takes two)
+
+uint8_t hidMacroSource;                     ///< Where the playing macro is being read from
+uint8_t hidMacroIndex;                      ///< Slot of the playing macro (KG_HID_MACRO_INDEX_FLASH for built-in)
+const char *hidMacroFlashStart;             ///< First byte of a built-in macro in program memory
+const char *hidMacroFlashPtr;               ///< Next byte of a built-in macro in program memory
+uint16_t hidMacroEEPROMAddress;             ///< Next byte of an EEPROM macro
+uint8_t hidMacroRemaining;                  ///< Bytes left to read from an EEPROM macro
+uint8_t hidMacroLength;                     ///< Total length of an EEPROM macro
+uint32_t hidMacroNextStep;                  ///< millis() timestamp when the next step is due
+
+uint8_t hidMacroKeyPressed;                 ///< Key typed by the last step, released on the next step (0 if none)
+uint8_t hidMacroShiftAdded;                 ///< Shift modifier added for the typed key (0 if none)
+uint8_t hidMacroModifiersHeld;              ///< Modifiers held down by macro opcodes
+uint8_t hidMacroKeysHeld[32];               ///< Bitmap of keys held down by macro opcodes
+
+uint8_t hidMacroWriteBuffer[KG_HID_MACRO_SLOT_SIZE];    ///< Macro slot content waiting to be written to EEPROM (length first)
+uint8_t hidMacroWriteSlot;                  ///< Slot being written to EEPROM (0xFF if none)
+uint8_t hidMacroWritePos;                   ///< Next write step (0 = clear length, 1-N = data, N+1 = set length)
+
+/**
+ * @brief Initialize macro playback and storage
+ */
+void setup_hid_macro() {
+    hidMacroSource = KG_HID_MACRO_SOURCE_NONE;
+    hidMacroKeyPressed = 0;
+    hidMacroShiftAdded = 0;
+    hidMacroModifiersHeld = 0;
+    memset(hidMacroKeysHeld, 0, sizeof(hidMacroKeysHeld));
+    hidMacroWriteSlot = 0xFF;
+}
+
+/**
+ * @brief Store the next byte of a pending EEPROM macro slot write
+ *
+ * Each byte takes about 3.4ms to program, so only one write is started per
+ * call and only once the previous one has finished. The old length byte is
+ * cleared first, then the data is written, and the new length goes in last.
+ * An interrupted write therefore leaves an empty slot rather than the old
+ * length over partly new data. Data bytes that already hold the right value
+ * are skipped to save EEPROM wear.
+ */
+void hid_macro_write_step() {
+    if (hidMacroWriteSlot == 0xFF || !eeprom_is_ready()) return;
+    uint8_t *slot = (uint8_t *)(KG_HID_MACRO_EEPROM_BASE + (uint16_t)hidMacroWriteSlot * KG_HID_MACRO_SLOT_SIZE);
+    uint8_t pos = hidMacroWritePos;
+    uint8_t length = hidMacroWriteBuffer[0];
+    if (pos == 0) {
+        // mark the slot empty before touching its data
+        if (eeprom_read_byte(slot) != 0) eeprom_write_byte(slot, 0);
+    } else if (pos <= length) {
+        if (eeprom_read_byte(slot + pos) != hidMacroWriteBuffer[pos]) eeprom_write_byte(slot + pos, hidMacroWriteBuffer[pos]);
+    } else {
+        // all data is in place, so the slot can become valid
+        if (length) eeprom_write_byte(slot, length);
+        hidMacroWriteSlot = 0xFF;
+        return;
+    }
+    hidMacroWritePos++;
+}
+
+/**
+ * @brief Read the next byte of the playing macro
+ * @return Next macro byte, or KG_HID_MACRO_END if there are no more
+ */
+uint8_t hid_macro_read() {
+    if (hidMacroSource == KG_HID_MACRO_SOURCE_FLASH) {
+        uint8_t b = pgm_read_byte(hidMacroFlashPtr);
+        if (b != KG_HID_MACRO_END) hidMacroFlashPtr++;
+        return b;
+    }
+    if (hidMacroRemaining == 0) return KG_HID_MACRO_END;
+    hidMacroRemaining--;
+    return eeprom_read_byte((const uint8_t *)hidMacroEEPROMAddress++);
+}
+
+/**
+ * @brief Release the key typed by the previous step, along with any shift added for it
+ */
+void hid_macro_release_key() {
+    if (hidMacroKeyPressed == 0) return;
+    hidModifiersDown &= ~hidMacroShiftAdded;
+    keyboard_key_up(hidMacroKeyPressed); // sends one report for both key and shift
+    hidMacroKeyPressed = 0;
+    hidMacroShiftAdded = 0;
+}
+
+/**
+ * @brief End macro playback, releasing everything the macro still holds down
+ * @param[in] status Playback status to report (complete or cancelled)
+ */
+void hid_macro_finish(uint8_t status) {
+    hidMacroSource = KG_HID_MACRO_SOURCE_NONE;
+    hid_macro_release_key();
+    if (hidMacroModifiersHeld) {
+        hidModifiersDown &= ~hidMacroModifiersHeld;
+        hidMacroModifiersHeld = 0;
+        hid_keyboard_send_report();
+    }
+    for (uint16_t code = 1; code < 256; code++) {
+        if (hidMacroKeysHeld[code >> 3] & (1 << (code & 7))) keyboard_key_up(code);
+    }
+    memset(hidMacroKeysHeld, 0, sizeof(hidMacroKeysHeld));
+
+    // send touchset_macro_status event
+    uint8_t payload[2] = { hidMacroIndex, status };
+    skipPacket = 0;
+    if (kg_evt_touchset_macro_status) skipPacket = kg_evt_touchset_macro_status(hidMacroIndex, status);
+    if (!skipPacket) send_keyglove_packet(KG_PACKET_TYPE_EVENT, 2, KG_PACKET_CLASS_TOUCHSET, KG_PACKET_ID_EVT_TOUCHSET_MACRO_STATUS, payload);
+}
+
+/**
+ * @brief Begin playback of a macro whose source and position are already set
+ */
+void hid_macro_start() {
+    hidMacroNextStep = millis();
+
+    // send touchset_macro_status event
+    uint8_t payload[2] = { hidMacroIndex, KG_HID_MACRO_STATUS_STARTED };
+    skipPacket = 0;
+    if (kg_evt_touchset_macro_status) skipPacket = kg_evt_touchset_macro_status(hidMacroIndex, KG_HID_MACRO_STATUS_STARTED);
+    if (!skipPacket) send_keyglove_packet(KG_PACKET_TYPE_EVENT, 2, KG_PACKET_CLASS_TOUCHSET, KG_PACKET_ID_EVT_TOUCHSET_MACRO_STATUS, payload);
+}
+
+/**
+ * @brief Check whether a macro is currently playing
+ * @return Non-zero if a macro is playing
+ */
+uint8_t hid_macro_active() {
+    return hidMacroSource != KG_HID_MACRO_SOURCE_NONE;
+}
+
+/**
+ * @brief Start typing a macro built into the firmware, cancelling any macro already playing
+ * @param[in] macro Null-terminated macro in program memory, e.g. PSTR("Hello\n")
+ *
+ * Opcode operands in a built-in macro must be non-zero, since a zero byte ends
+ * the string.
+ */
+void hid_macro_play_P(const char *macro) {
+    hid_macro_stop();
+    hidMacroSource = KG_HID_MACRO_SOURCE_FLASH;
+    hidMacroIndex = KG_HID_MACRO_INDEX_FLASH;
+    hidMacroFlashStart = hidMacroFlashPtr = macro;
+    hid_macro_start();
+}
+
+/**
+ * @brief Start typing a macro from an EEPROM slot, cancelling any macro already playing
+ * @param[in] index Macro slot to play
+ * @return Non-zero if playback started, zero if the slot is invalid or empty
+ */
+uint8_t hid_macro_play_slot(uint8_t index) {
+    if (index >= KG_HID_MACRO_SLOTS) return 0;
+    if (hidMacroWriteSlot == index) return 0; // still being written
+    uint16_t address = KG_HID_MACRO_EEPROM_BASE + (uint16_t)index * KG_HID_MACRO_SLOT_SIZE;
+    uint8_t length = eeprom_read_byte((const uint8_t *)address);
+    if (length == 0 || length >= KG_HID_MACRO_SLOT_SIZE) return 0; // empty or never written (0xFF)
+    hid_macro_stop();
+    hidMacroSource = KG_HID_MACRO_SOURCE_EEPROM;
+    hidMacroIndex = index;
+    hidMacroEEPROMAddress = address + 1;
+    hidMacroRemaining = hidMacroLength = length;
+    hid_macro_start();
+    return 1;
+}
+
+/**
+ * @brief Cancel the macro currently playing, if any
+ */
+void hid_macro_stop() {
+    if (hidMacroSource != KG_HID_MACRO_SOURCE_NONE) hid_macro_finish(KG_HID_MACRO_STATUS_CANCELLED);
+}
+
+/**
+ * @brief Perform the next macro step if one is due, called on every pass through loop()
+ */
+void update_hid_macro() {
+    hid_macro_write_step();
+
+    if (hidMacroSource == KG_HID_MACRO_SOURCE_NONE) return;
+    if ((int32_t)(millis() - hidMacroNextStep) < 0) return;
+    hidMacroNextStep = millis() + opt_hid_macro_step_interval;
+
+    // a typed key is always released on its own step, so repeated characters register
+    if (hidMacroKeyPressed) {
+        hid_macro_release_key();
+        return;
+    }
+
+    uint8_t b = hid_macro_read();
+    if (b >= 0x20 && b <= 0x7E) {
+        uint8_t code = pgm_read_byte(hidMacroASCII + b - 0x20);
+        if ((code & KG_HID_MACRO_ASCII_SHIFT) && (hidModifiersDown & MODIFIERKEY_SHIFT) == 0) {
+            hidMacroShiftAdded = MODIFIERKEY_SHIFT;
+            hidModifiersDown |= hidMacroShiftAdded;
+        }
+        hidMacroKeyPressed = code & ~KG_HID_MACRO_ASCII_SHIFT;
+        keyboard_key_down(hidMacroKeyPressed);
+        return;
+    }
+
+    switch (b) {
+        case KG_HID_MACRO_END:
+            hid_macro_finish(KG_HID_MACRO_STATUS_COMPLETE);
+            break;
+        case '\b':
+            hidMacroKeyPressed = KEY_BACKSPACE;
+            keyboard_key_down(hidMacroKeyPressed);
+            break;
+        case '\t':
+            hidMacroKeyPressed = KEY_TAB;
+            keyboard_key_down(hidMacroKeyPressed);
+            break;
+        case '\n':
+            hidMacroKeyPressed = KEY_ENTER;
+            keyboard_key_down(hidMacroKeyPressed);
+            break;
+        case KG_HID_MACRO_KEY_DOWN:
+            b = hid_macro_read();
+            hidMacroKeysHeld[b >> 3] |= (1 << (b & 7));
+            keyboard_key_down(b);
+            break;
+        case KG_HID_MACRO_KEY_UP:
+            b = hid_macro_read();
+            hidMacroKeysHeld[b >> 3] &= ~(1 << (b & 7));
+            keyboard_key_up(b);
+            break;
+        case KG_HID_MACRO_KEY_PRESS:
+            hidMacroKeyPressed = hid_macro_read();
+            keyboard_key_down(hidMacroKeyPressed);
+            break;
+        case KG_HID_MACRO_MODIFIER_DOWN:
+            b = hid_macro_read();
+            hidMacroModifiersHeld |= b;
+            keyboard_modifier_down(b);
+            break;
+        case KG_HID_MACRO_MODIFIER_UP:
+            b = hid_macro_read();
+            hidMacroModifiersHeld &= ~b;
+            keyboard_modifier_up(b);
+            break;
+        case KG_HID_MACRO_DELAY:
+            hidMacroNextStep += (uint16_t)hid_macro_read() * 10;
+            break;
+        case KG_HID_MACRO_PRESSURE_DELAY:
+            b = hid_macro_read();
+            #if (KG_PRESSURE > 0)
+                hidMacroNextStep += pressure_repeat_interval(b);
+            #endif
+            break;
+        case KG_HID_MACRO_PRESSURE_REPEAT:
+            b = hid_macro_read();
+            #if (KG_PRESSURE > 0)
+                if (pressure_modifier(b)) {
+                    // rewind without finishing, so held keys and modifiers stay down
+                    hidMacroFlashPtr = hidMacroFlashStart;
+                    hidMacroEEPROMAddress -= hidMacroLength - hidMacroRemaining;
+                    hidMacroRemaining = hidMacroLength;
+                }
+            #endif
+            break;
+        default:
+            // unknown byte, skip it
+            break;
+    }
+}
+
+/* ============================= */
+/* KGAPI COMMAND IMPLEMENTATIONS */
+/* ============================= */
+
+/**
+ * @brief Store a keyboard macro in an EEPROM macro slot
+ * @param[in] index Macro slot to store
+ * @param[in] macro_len Length in bytes of macro_data buffer
+ * @param[in] macro_data Macro content
+ * @return Result code (0=success)
+ *
+ * The slot is written in the background over the next several milliseconds
+ * (up to about 435ms for a full slot). Only one write is buffered at a time,
+ * so this returns KG_PROTOCOL_ERROR_BUSY until the previous one is finished.
+ */
+uint16_t kg_cmd_touchset_set_macro(uint8_t index, uint8_t macro_len, uint8_t *macro_data) {
+    if (index >= KG_HID_MACRO_SLOTS || macro_len >= KG_HID_MACRO_SLOT_SIZE) {
+        return KG_PROTOCOL_ERROR_PARAMETER_RANGE;
+    }
+
+    if (hidMacroWriteSlot != 0xFF) {
+        return KG_PROTOCOL_ERROR_BUSY;
+    }
+
+    // don't keep typing from a slot while it is being replaced
+    if (hidMacroSource == KG_HID_MACRO_SOURCE_EEPROM && hidMacroIndex == index) hid_macro_stop();
+
+    hidMacroWriteBuffer[0] = macro_len;
+    memcpy(hidMacroWriteBuffer + 1, macro_data, macro_len);
+    hidMacroWritePos = 0;
+    hidMacroWriteSlot = index;
+    return 0; // success
+}
+
+/**
+ * @brief Start typing a stored keyboard macro
+ * @param[in] index Macro slot to play
+ * @return Result code (0=success)
+ */
+uint16_t kg_cmd_touchset_play_macro(uint8_t index) {
+    if (index < KG_HID_MACRO_SLOTS && hidMacroWriteSlot == index) {
+        return KG_PROTOCOL_ERROR_BUSY;
+    }
+    if (!hid_macro_play_slot(index)) {
+        return KG_PROTOCOL_ERROR_PARAMETER_RANGE;
+    }
+    return 0; // success
+}
+
+/**
+ * @brief Cancel the keyboard macro currently playing
+ * @return Result code (0=success)
+ */
+uint16_t kg_cmd_touchset_stop_macro() {
+    hid_macro_stop();
+    return 0; // success
+}
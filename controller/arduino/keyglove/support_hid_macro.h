@@ -0,0 +1,82 @@
+// Keyglove controller source code - HID keyboard macro playback declarations
+// 2014-12-14 by Jeff Rowberg <jeff@rowberg.net>
+
+/* ============================================
+Controller code is placed under the MIT license
+Copyright (c) 2014 Jeff Rowberg
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+
+/**
+ * @file support_hid_macro.h
+ * @brief HID keyboard macro playback declarations
+ * @author Jeff Rowberg
+ * @date 2014-12-14
+ *
+ * This file provides supporting code for typing stored keyboard macros (text
+ * strings and key sequences) to a connected host. Macros are expanded into HID
+ * keyboard reports one step at a time from loop(), so typing a long macro never
+ * holds up touch detection or anything else. This is only relevant if you have
+ * enabled normal HID keyboard support over USB or Bluetooth.
+ *
+ * Normally it is not necessary to edit this file.
+ */
+
+#ifndef _SUPPORT_HID_MACRO_H_
+#define _SUPPORT_HID_MACRO_H_
+
+#include <avr/eeprom.h>
+
+/* Macro content is a sequence of bytes. Printable ASCII (0x20-0x7E) plus
+ * backspace, tab and newline are typed as text using a US keyboard layout;
+ * the values below are opcodes, each followed by a single operand byte. */
+#define KG_HID_MACRO_END                0x00    ///< End of macro (no operand, implied by length for EEPROM macros)
+#define KG_HID_MACRO_KEY_DOWN           0x10    ///< Press and hold key, operand is HID usage code
+#define KG_HID_MACRO_KEY_UP             0x11    ///< Release key, operand is HID usage code
+#define KG_HID_MACRO_KEY_PRESS          0x12    ///< Press and release key, operand is HID usage code
+#define KG_HID_MACRO_MODIFIER_DOWN      0x13    ///< Press and hold modifier(s), operand is modifier bitmask
+#define KG_HID_MACRO_MODIFIER_UP        0x14    ///< Release modifier(s), operand is modifier bitmask
+#define KG_HID_MACRO_DELAY              0x15    ///< Pause before the next step, operand is 10ms units
+#define KG_HID_MACRO_PRESSURE_DELAY     0x16    ///< Pause scaled by fingertip pressure (harder is shorter), operand is pressure sensor index
+#define KG_HID_MACRO_PRESSURE_REPEAT    0x17    ///< Start the macro again while fingertip is pressed, operand is pressure sensor index
+
+#define KG_HID_MACRO_STATUS_STARTED     0x01    ///< Macro playback has started
+#define KG_HID_MACRO_STATUS_COMPLETE    0x02    ///< Macro has been typed completely
+#define KG_HID_MACRO_STATUS_CANCELLED   0x03    ///< Macro playback was cancelled before completion
+
+#define KG_HID_MACRO_INDEX_FLASH        0xFF    ///< Macro index reported for macros built into firmware
+
+#define KG_HID_MACRO_SLOTS              8       ///< Number of macro slots stored in EEPROM
+#define KG_HID_MACRO_SLOT_SIZE          128     ///< Bytes per EEPROM macro slot (including length byte)
+#define KG_HID_MACRO_EEPROM_BASE        0x0800  ///< EEPROM address of first macro slot
+
+extern uint8_t opt_hid_macro_step_interval;
+
+void setup_hid_macro();
+void update_hid_macro();
+
+uint8_t hid_macro_active();
+void hid_macro_play_P(const char *macro);
+uint8_t hid_macro_play_slot(uint8_t index);
+void hid_macro_stop();
+
+#endif // _SUPPORT_HID_MACRO_H_
@@ -47,16 +47,14 @@ THE SOFTWARE.
 
 uint8_t hidMouseDown = 0;   ///< Mouse buttons currently down
 
-int8_t hidMouseDX;          ///< Mouse cursor X axis movement delta
-int8_t hidMouseDY;          ///< Mouse cursor Y axis movement delta
-int8_t hidMouseDZ;          ///< Mouse cursor Z axis movement delta (3D-only)
-int8_t hidScrollDX;         ///< Horizontal scroll movement delta
-int8_t hidScrollDY;         ///< Vertical scroll movement delta
+hid_mouse_pending_t hidMousePending[HID_MOUSE_TRANSPORT_MAX];   ///< Pending sub-pixel movement for each transport
 
 uint8_t opt_hid_mouse_invert_x = 0;                 ///< OPTION: Invert mouse x movements
 uint8_t opt_hid_mouse_invert_y = 1;                 ///< OPTION: Invert mouse y movements
 uint8_t opt_hid_mouse_invert_z = 0;                 ///< OPTION: Invert mouse z movements
 
+uint8_t opt_hid_mouse_report_interval[HID_MOUSE_TRANSPORT_MAX] = { 8, 15, 10 };    ///< OPTION: Minimum time between reports [usb,bt2,r400] in ms
+
 mouse_movement_mode_t opt_hid_mouse_mode = MOUSE_MODE_OFF;      ///< OPTION: Mouse cursor movement mode
 scroll_movement_mode_t opt_hid_scroll_mode = SCROLL_MODE_OFF;   ///< OPTION: Scroll movement mode
 
@@ -65,47 +63,140 @@ float opt_hid_mouse_scale_mode2[] = { 1, 1 };       ///< OPTION: Speed scale [x,
 float opt_hid_mouse_scale_mode3[] = { 1, 1 };       ///< OPTION: Speed scale [x,y] for mode 3 (movement-position)
 float opt_hid_mouse_scale_mode4[] = { 1, 1, 1 };    ///< OPTION: Speed scale [x,y,z] for mode 4 (3D)
 
+float hidMouseVelocityX;    ///< Integrated cursor X axis velocity (tilt-velocity mode only)
+float hidMouseVelocityY;    ///< Integrated cursor Y axis velocity (tilt-velocity mode only)
+
+/**
+ * @brief Apply the gyro response curve used by the tilt-based modes
+ * @param[in] g Raw gyroscope axis reading
+ * @return Movement in (fractional) pixels
+ */
+float hid_mouse_tilt_curve(int16_t g) {
+    return (g < 0) ? -pow(-(float)g/30, 1.3)*3 : pow((float)g/30, 1.3)*3;
+}
+
+/**
+ * @brief Add fractional movement to a pending fixed-point axis, saturating at the pending limit
+ * @param[in,out] pending Pending axis movement to update
+ * @param[in] delta Movement to add, in (fractional) pixels
+ */
+void hid_mouse_accumulate_axis(int32_t *pending, float delta) {
+    const int32_t limit = (int32_t)KG_HID_MOUSE_PENDING_LIMIT << KG_HID_MOUSE_SUBPIXEL_BITS;
+    if (delta > KG_HID_MOUSE_PENDING_LIMIT) delta = KG_HID_MOUSE_PENDING_LIMIT;
+    else if (delta < -KG_HID_MOUSE_PENDING_LIMIT) delta = -KG_HID_MOUSE_PENDING_LIMIT;
+    *pending += (int32_t)(delta * (1 << KG_HID_MOUSE_SUBPIXEL_BITS));
+    if (*pending > limit) *pending = limit;
+    else if (*pending < -limit) *pending = -limit;
+}
+
+/**
+ * @brief Remove the whole-pixel part of a pending axis for a single report
+ *
+ * The whole-pixel part is truncated toward zero and saturated to the int8_t
+ * report range. Anything that does not fit (fractional remainder or movement
+ * beyond +/-127) stays pending and is carried into the next report.
+ *
+ * @param[in,out] pending Pending axis movement to consume
+ * @return Movement to place into the report
+ */
+int8_t hid_mouse_take_axis(int32_t *pending) {
+    int32_t whole = *pending / (1 << KG_HID_MOUSE_SUBPIXEL_BITS);
+    if (whole > 127) whole = 127;
+    else if (whole < -127) whole = -127;
+    *pending -= whole * (1 << KG_HID_MOUSE_SUBPIXEL_BITS);
+    return (int8_t)whole;
+}
+
+/**
+ * @brief Add new movement to the pending state of every enabled transport
+ * @param[in] dx Cursor X axis movement in (fractional) pixels
+ * @param[in] dy Cursor Y axis movement in (fractional) pixels
+ * @param[in] dwheel Wheel movement in (fractional) steps
+ */
+void hid_mouse_accumulate(float dx, float dy, float dwheel) {
+    for (uint8_t i = 0; i < HID_MOUSE_TRANSPORT_MAX; i++) {
+        hid_mouse_accumulate_axis(&hidMousePending[i].dx, dx);
+        hid_mouse_accumulate_axis(&hidMousePending[i].dy, dy);
+        hid_mouse_accumulate_axis(&hidMousePending[i].dwheel, dwheel);
+    }
+}
+
+/**
+ * @brief Check whether a transport may send a report now, and build it if so
+ * @param[in] transport Transport to check
+ * @param[in] ready Whether the transport is currently connected and usable
+ * @param[out] x Cursor X axis movement for the report
+ * @param[out] y Cursor Y axis movement for the report
+ * @param[out] wheel Wheel movement for the report
+ * @return Non-zero if a report should be sent with the provided values
+ */
+uint8_t hid_mouse_take_report(uint8_t transport, bool ready, int8_t *x, int8_t *y, int8_t *wheel) {
+    hid_mouse_pending_t *pending = &hidMousePending[transport];
+    if (!ready) {
+        // don't let stale movement build up and jump the cursor on connection
+        pending -> dx = pending -> dy = pending -> dwheel = 0;
+        return 0;
+    }
+    uint32_t now = millis();
+    if (now - pending -> lastReport < opt_hid_mouse_report_interval[transport]) {
+        // too soon, so keep merging deltas into the pending report
+        return 0;
+    }
+    *x = hid_mouse_take_axis(&pending -> dx);
+    *y = hid_mouse_take_axis(&pending -> dy);
+    *wheel = hid_mouse_take_axis(&pending -> dwheel);
+    if (*x == 0 && *y == 0 && *wheel == 0) return 0;
+    pending -> lastReport = now;
+    return 1;
+}
+
 /**
  * @brief Initialize HID mouse behavior
  */
 void setup_hid_mouse() {
-    // zero all relative movements
-    hidMouseDX = hidMouseDY = hidMouseDZ = 0;
-    hidScrollDX = hidScrollDY = 0;
+    // zero all pending movement
+    memset(hidMousePending, 0, sizeof(hidMousePending));
+    hidMouseVelocityX = hidMouseVelocityY = 0;
 }
 
 /**
- * @brief Update mouse movements if necessary, called at 100Hz from loop()
+ * @brief Translate new motion data into pending mouse movement, called after each motion sample
+ *
+ * This does not send anything by itself; reports are generated separately by
+ * send_hid_mouse_reports() at each transport's own rate.
  */
 void update_hid_mouse() {
+    float dx = 0, dy = 0, dz = 0, dscroll = 0;
     #if KG_MOTION > 0
         switch (opt_hid_mouse_mode) {
             case MOUSE_MODE_TILT_VELOCITY:
-                hidMouseDX += ((gv.y < 0) ? -pow(-(float)gv.y/30, 1.3)*3 : pow((float)gv.y/30, 1.3)*3) - ((gv.z < 0) ? -pow(-(float)gv.z/30, 1.3)*3 : pow((float)gv.z/30, 1.3)*3);
-                hidMouseDY += (gv.x < 0) ? -pow(-(float)gv.x/30, 1.3)*3 : pow((float)gv.x/30, 1.3)*3;
+                hidMouseVelocityX += (hid_mouse_tilt_curve(gv.y) - hid_mouse_tilt_curve(gv.z)) * opt_hid_mouse_scale_mode1[0];
+                hidMouseVelocityY += hid_mouse_tilt_curve(gv.x) * opt_hid_mouse_scale_mode1[1];
+                dx = hidMouseVelocityX;
+                dy = hidMouseVelocityY;
                 break;
             case MOUSE_MODE_TILT_POSITION:
-                hidMouseDX = ((gv.y < 0) ? -pow(-(float)gv.y/30, 1.3)*3 : pow((float)gv.y/30, 1.3)*3) - ((gv.z < 0) ? -pow(-(float)gv.z/30, 1.3)*3 : pow((float)gv.z/30, 1.3)*3);
-                hidMouseDY = (gv.x < 0) ? -pow(-(float)gv.x/30, 1.3)*3 : pow((float)gv.x/30, 1.3)*3;
+                dx = (hid_mouse_tilt_curve(gv.y) - hid_mouse_tilt_curve(gv.z)) * opt_hid_mouse_scale_mode2[0];
+                dy = hid_mouse_tilt_curve(gv.x) * opt_hid_mouse_scale_mode2[1];
                 break;
             case MOUSE_MODE_MOVEMENT_POSITION:
                 #if (KG_FUSION > 0)
-                    hidMouseDX = apFrame.x * opt_hid_mouse_scale_mode4[0];
-                    hidMouseDY = apFrame.y * opt_hid_mouse_scale_mode4[1];
+                    dx = apFrame.x * opt_hid_mouse_scale_mode3[0];
+                    dy = apFrame.y * opt_hid_mouse_scale_mode3[1];
                 #else
-                    hidMouseDX = aa.x * opt_hid_mouse_scale_mode4[0];
-                    hidMouseDY = aa.y * opt_hid_mouse_scale_mode4[1];
+                    dx = aa.x * opt_hid_mouse_scale_mode3[0];
+                    dy = aa.y * opt_hid_mouse_scale_mode3[1];
                 #endif
                 break;
             case MOUSE_MODE_3D:
                 #if (KG_FUSION > 0)
-                    hidMouseDX = apFrame.x * opt_hid_mouse_scale_mode4[0];
-                    hidMouseDY = apFrame.y * opt_hid_mouse_scale_mode4[1];
-                    hidMouseDZ = apFrame.z * opt_hid_mouse_scale_mode4[2];
+                    dx = apFrame.x * opt_hid_mouse_scale_mode4[0];
+                    dy = apFrame.y * opt_hid_mouse_scale_mode4[1];
+                    dz = apFrame.z * opt_hid_mouse_scale_mode4[2];
                 #else
-                    hidMouseDX = aa.x * opt_hid_mouse_scale_mode4[0];
-                    hidMouseDY = aa.y * opt_hid_mouse_scale_mode4[1];
-                    hidMouseDZ = aa.z * opt_hid_mouse_scale_mode4[2];
+                    dx = aa.x * opt_hid_mouse_scale_mode4[0];
+                    dy = aa.y * opt_hid_mouse_scale_mode4[1];
+                    dz = aa.z * opt_hid_mouse_scale_mode4[2];
                 #endif
                 break;
         }
@@ -113,42 +204,51 @@ void update_hid_mouse() {
             case SCROLL_MODE_TILT_VELOCITY: // gyro
                 break;
             case SCROLL_MODE_TILT_POSITION: // gyro
-                hidScrollDY -= ((float)gv.y < 0) ? -sqrt(-(float)gv.y / 30) : sqrt((float)gv.y / 30);
+                dscroll = (gv.y < 0) ? sqrt(-(float)gv.y / 30) : -sqrt((float)gv.y / 30);
                 break;
             case SCROLL_MODE_MOVEMENT_POSITION: // accel
                 break;
         }
     #endif
 
-    if (opt_hid_mouse_mode > 0 && (hidMouseDX != 0 || hidMouseDY != 0 || hidMouseDZ != 0)) {
-        if (opt_hid_mouse_invert_x == 1) hidMouseDX = -hidMouseDX;
-        if (opt_hid_mouse_invert_y == 1) hidMouseDY = -hidMouseDY;
-        if (opt_hid_mouse_invert_z == 1) hidMouseDZ = -hidMouseDZ;
-        #if KG_HOSTIF & KG_HOSTIF_USB_HID
-            if (hidMouseDZ > 0) Mouse.move(hidMouseDX, hidMouseDY, hidMouseDZ);
-            else Mouse.move(hidMouseDX, hidMouseDY);
-        #endif /* KG_HOSTIF_USB_HID */
-        #if KG_HOSTIF & KG_HOSTIF_BT2_HID
-            if (hidMouseDZ > 0) BTMouse.move(hidMouseDX, hidMouseDY, hidMouseDZ, 0);
-            else BTMouse.move(hidMouseDX, hidMouseDY);
-        #endif /* KG_HOSTIF_BT2_HID */
-        #if KG_HOSTIF & KG_HOSTIF_R400_HID
-            if (hidMouseDZ > 0) RX400.move(hidMouseDX, hidMouseDY, hidMouseDZ);
-            else RX400.move(hidMouseDX, hidMouseDY);
-        #endif /* KG_HOSTIF_R400_HID */
-    }
-    if (opt_hid_scroll_mode > 0 && hidScrollDY != 0) {
-        if (opt_hid_mouse_invert_y == 1) hidMouseDY = -hidMouseDY;
-        #if KG_HOSTIF & KG_HOSTIF_USB_HID
-            Mouse.scroll(hidScrollDY);
-        #endif /* KG_HOSTIF_USB_HID */
-        #if KG_HOSTIF & KG_HOSTIF_BT2_HID
-            BTMouse.scroll(hidScrollDY, 0);
-        #endif /* KG_HOSTIF_BT2_HID */
-        #if KG_HOSTIF & KG_HOSTIF_R400_HID
-            RX400.scroll(hidScrollDY);
-        #endif /* KG_HOSTIF_R400_HID */
-    }
+    if (opt_hid_mouse_mode == MOUSE_MODE_OFF) dx = dy = dz = 0;
+    if (opt_hid_scroll_mode == SCROLL_MODE_OFF) dscroll = 0;
+    if (dx == 0 && dy == 0 && dz == 0 && dscroll == 0) return;
+
+    if (opt_hid_mouse_invert_x == 1) dx = -dx;
+    if (opt_hid_mouse_invert_y == 1) dy = -dy;
+    if (opt_hid_mouse_invert_z == 1) dz = -dz;
+
+    // 3D Z axis movement and scrolling both drive the wheel
+    hid_mouse_accumulate(dx, dy, dz + dscroll);
+}
+
+/**
+ * @brief Send pending mouse movement on each transport that is due for a report, called from loop()
+ *
+ * Each transport has its own minimum report interval. Movement which arrives
+ * before a transport is due is merged into its next report rather than being
+ * sent immediately or dropped.
+ */
+void send_hid_mouse_reports() {
+    int8_t x, y, wheel;
+    #if KG_HOSTIF & KG_HOSTIF_USB_HID
+        if (hid_mouse_take_report(HID_MOUSE_TRANSPORT_USB, interfaceUSBHIDReady, &x, &y, &wheel)) {
+            Mouse.move(x, y, wheel);
+        }
+    #endif /* KG_HOSTIF_USB_HID */
+    #if KG_HOSTIF & KG_HOSTIF_BT2_HID
+        if (hid_mouse_take_report(HID_MOUSE_TRANSPORT_BT2, interfaceBT2HIDReady, &x, &y, &wheel)) {
+            if (wheel != 0) BTMouse.move(x, y, wheel, 0);
+            else BTMouse.move(x, y);
+        }
+    #endif /* KG_HOSTIF_BT2_HID */
+    #if KG_HOSTIF & KG_HOSTIF_R400_HID
+        if (hid_mouse_take_report(HID_MOUSE_TRANSPORT_R400, true, &x, &y, &wheel)) {
+            if (wheel != 0) RX400.move(x, y, wheel);
+            else RX400.move(x, y);
+        }
+    #endif /* KG_HOSTIF_R400_HID */
 }
 
 /**
@@ -49,6 +49,9 @@ THE SOFTWARE.
 #define MOUSE_ACTION_MOVE               1   ///< Mouse cursor movement action
 #define MOUSE_ACTION_SCROLL             2   ///< Scrolling movement action
 
+#define KG_HID_MOUSE_SUBPIXEL_BITS      8       ///< Fractional bits of pending movement (1/256 pixel resolution)
+#define KG_HID_MOUSE_PENDING_LIMIT      1024    ///< Maximum pending movement per axis in whole pixels
+
 /**
  * @brief List of possible values for cursor movement mode
  */
@@ -72,8 +75,35 @@ typedef enum {
     SCROLL_MODE_MAX
 } scroll_movement_mode_t;
 
+/**
+ * @brief List of transports which can carry HID mouse reports
+ */
+typedef enum {
+    HID_MOUSE_TRANSPORT_USB = 0,    ///< (0) USB HID mouse (Teensy "Mouse" object)
+    HID_MOUSE_TRANSPORT_BT2,        ///< (1) Bluetooth HID mouse ("BTMouse" iWRAP wrapper)
+    HID_MOUSE_TRANSPORT_R400,       ///< (2) RX400 wireless receiver
+    HID_MOUSE_TRANSPORT_MAX
+} hid_mouse_transport_t;
+
+/**
+ * @brief Pending (not yet reported) mouse movement for a single transport
+ *
+ * All deltas are fixed-point values with KG_HID_MOUSE_SUBPIXEL_BITS fractional
+ * bits, so that fractional motion is carried forward into the next report
+ * instead of being truncated away.
+ */
+typedef struct {
+    int32_t dx;             ///< Pending cursor X axis movement
+    int32_t dy;             ///< Pending cursor Y axis movement
+    int32_t dwheel;         ///< Pending wheel movement (scroll or 3D Z axis)
+    uint32_t lastReport;    ///< Timestamp (millis) of the last report sent
+} hid_mouse_pending_t;
+
+extern uint8_t opt_hid_mouse_report_interval[HID_MOUSE_TRANSPORT_MAX];
+
 void setup_hid_mouse();
 void update_hid_mouse();
+void send_hid_mouse_reports();
 
 void mouse_on(uint8_t mode);
 void mouse_off(uint8_t mode);
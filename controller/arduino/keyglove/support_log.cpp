@@ -0,0 +1,140 @@
+// Keyglove controller source code - Deferred tokenized logging implementations
+// 2014-12-20 by Jeff Rowberg <jeff@rowberg.net>
+
+/* ============================================
+Controller code is placed under the MIT license
+Copyright (c) 2014 Jeff Rowberg
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+/**
+ * @file support_log.cpp
+ * @brief Deferred tokenized logging implementations
+ * @author Jeff Rowberg
+ * @date 2014-12-20
+ *
+ * Log messages are not sent when they are logged. keyglove_log() only checks
+ * the runtime level filter and copies a small record (level, message ID, a
+ * 16-bit argument and the low 16 bits of the 10ms tick count) into a RAM
+ * ring, which takes a few microseconds and is safe in interrupt handlers.
+ * Interrupts are held off only while the record is copied. update_log() runs
+ * from loop() and sends everything waiting as a single log event through
+ * send_keyglove_packet(), so log data takes the same route as every other
+ * event and goes out on each interface with KG_INTERFACE_MODE_OUTGOING_LOG
+ * set.
+ *
+ * The message text is never on the glove. The IDs come from
+ * support_log_messages.h, and the host looks them up in a dictionary
+ * generated from the same file. If the ring fills up, new records are
+ * dropped and counted, and the count is sent as a RECORDS_DROPPED record once
+ * there is room again.
+ *
+ * Normally it is not necessary to edit this file.
+ */
+
+#include "keyglove.h"
+#include "support_board.h"
+#include "support_protocol.h"
+
+uint8_t logLevel;                                   ///< Records above this level are not logged at all
+
+struct log_record_t {
+    uint8_t level;                                  ///< Log level
+    uint16_t id;                                    ///< Message ID (KG_LOG_*)
+    uint16_t arg;                                   ///< Argument for the message text
+    uint16_t ticks;                                 ///< Low 16 bits of 10ms ticks since boot when logged
+};
+
+log_record_t logRing[KG_LOG_RING_SIZE];             ///< Records waiting to be sent
+volatile uint8_t logHead;                           ///< Free-running count of records added
+volatile uint8_t logTail;                           ///< Free-running count of records sent
+volatile uint16_t logDropped;                       ///< Records lost because the ring was full
+
+/**
+ * @brief Clear the log ring and set the default log level
+ */
+void setup_log() {
+    logLevel = KG_LOG_LEVEL_NORMAL;
+    logHead = 0;
+    logTail = 0;
+    logDropped = 0;
+}
+
+/**
+ * @brief Add one record to the log ring (use keyglove_log() instead, which filters by level first)
+ * @param[in] level Log level
+ * @param[in] id Message ID (KG_LOG_*)
+ * @param[in] arg Argument for the message text
+ */
+void log_push(uint8_t level, uint16_t id, uint16_t arg) {
+    uint16_t ticks = keygloveTock * 100 + keygloveTick;
+    uint8_t sreg = SREG;
+    cli();
+    if ((uint8_t)(logHead - logTail) == KG_LOG_RING_SIZE) {
+        if (logDropped < 0xFFFF) logDropped++;
+    } else {
+        log_record_t *record = &logRing[logHead & (KG_LOG_RING_SIZE - 1)];
+        record -> level = level;
+        record -> id = id;
+        record -> arg = arg;
+        record -> ticks = ticks;
+        logHead++;
+    }
+    SREG = sreg;
+}
+
+/**
+ * @brief Send all waiting log records as one log event
+ */
+void update_log() {
+    uint8_t count = logHead - logTail;
+    if (count == 0) return;
+
+    // only this function moves the tail, so records between tail and head stay put while we copy them
+    uint8_t payload[KG_LOG_RING_SIZE * KG_LOG_RECORD_SIZE];
+    uint8_t *p = payload;
+    for (uint8_t i = 0; i < count; i++) {
+        log_record_t *record = &logRing[(logTail + i) & (KG_LOG_RING_SIZE - 1)];
+        *p++ = record -> level;
+        *p++ = record -> id & 0xFF;
+        *p++ = record -> id >> 8;
+        *p++ = record -> arg & 0xFF;
+        *p++ = record -> arg >> 8;
+        *p++ = record -> ticks & 0xFF;
+        *p++ = record -> ticks >> 8;
+    }
+
+    // if the packet could not be sent (e.g. no memory for the buffer), keep the records and try again next pass;
+    // 255 means the application filtered it out on purpose, so those records are done with
+    uint8_t result = send_keyglove_packet(KG_PACKET_TYPE_EVENT, p - payload, KG_PACKET_CLASS_LOG, KG_PACKET_ID_EVT_LOG_RECORDS, payload);
+    if (result != 0 && result != 255) return;
+    logTail += count;
+
+    // now there is room again, report anything lost (this record waits until the next pass)
+    if (logDropped) {
+        uint8_t sreg = SREG;
+        cli();
+        uint16_t dropped = logDropped;
+        logDropped = 0;
+        SREG = sreg;
+        log_push(KG_LOG_LEVEL_WARNING, KG_LOG_RECORDS_DROPPED, dropped);
+    }
+}
@@ -0,0 +1,73 @@
+// Keyglove controller source code - Deferred tokenized logging declarations
+// 2014-12-20 by Jeff Rowberg <jeff@rowberg.net>
+
+/* ============================================
+Controller code is placed under the MIT license
+Copyright (c) 2014 Jeff Rowberg
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+/**
+ * @file support_log.h
+ * @brief Deferred tokenized logging declarations
+ * @author Jeff Rowberg
+ * @date 2014-12-20
+ */
+
+#ifndef _SUPPORT_LOG_H_
+#define _SUPPORT_LOG_H_
+
+#define KG_LOG_LEVEL_PANIC                      0       ///< Log level for "What a Terrible Failure" problems that will lock the MCU
+#define KG_LOG_LEVEL_CRITICAL                   1       ///< Log level for critical issues that will break core functionality
+#define KG_LOG_LEVEL_WARNING                    3       ///< Log level for warnings that may impact certain subsystems
+#define KG_LOG_LEVEL_NORMAL                     5       ///< Log level for regular status updates
+#define KG_LOG_LEVEL_VERBOSE                    9       ///< Log level for extra detailed info
+
+#define KG_LOG_RING_SIZE                        16      ///< Number of log records which may wait to be sent (power of 2)
+#define KG_LOG_RECORD_SIZE                      7       ///< Bytes per record on the wire: level, message ID, argument, ticks
+
+#define KG_PACKET_CLASS_LOG                     0xFF    ///< Class of log events (not part of the generated KGAPI classes)
+#define KG_PACKET_ID_EVT_LOG_RECORDS            0xFE    ///< One or more tokenized log records
+#define KG_PACKET_ID_EVT_LOG_TEXT               0xFF    ///< Log level and free text message
+
+enum {
+    #define KG_LOG_MESSAGE(name, id, text) KG_LOG_##name = id,
+    #include "support_log_messages.h"
+    #undef KG_LOG_MESSAGE
+};
+
+extern uint8_t logLevel;
+
+void setup_log();
+void update_log();
+void log_push(uint8_t level, uint16_t id, uint16_t arg);
+
+/**
+ * @brief Queue a tokenized log message, from anywhere (including interrupts)
+ * @param[in] level Log level
+ * @param[in] id Message ID (KG_LOG_*)
+ * @param[in] arg Argument for the message text (if it has one)
+ */
+inline void keyglove_log(uint8_t level, uint16_t id, uint16_t arg = 0) {
+    if (level <= logLevel) log_push(level, id, arg);
+}
+
+#endif // _SUPPORT_LOG_H_
@@ -0,0 +1,61 @@
+// Keyglove controller source code - Tokenized log message IDs
+// 2014-12-20 by Jeff Rowberg <jeff@rowberg.net>
+
+/* ============================================
+Controller code is placed under the MIT license
+Copyright (c) 2014 Jeff Rowberg
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+/**
+ * @file support_log_messages.h
+ * @brief Tokenized log message IDs
+ * @author Jeff Rowberg
+ * @date 2014-12-20
+ *
+ * Every fixed log message the firmware can send is listed here once, as
+ * KG_LOG_MESSAGE(name, id, text). The firmware only uses the name and the
+ * 16-bit ID (as KG_LOG_<name>), so none of the text is compiled in. The
+ * host/python/keyglove_logdict.py script turns this list into the host-side
+ * dictionary (host/python/kglog_messages.py) which kglib uses to print the
+ * text again, so run it after changing anything here.
+ *
+ * The high byte of each ID is the KGAPI class of the code that logs it, and
+ * IDs must never be reused for a different message. The text may contain
+ * one "%d", which is replaced by the 16-bit argument given to keyglove_log().
+ *
+ * This file is included several times on purpose, so it has no include guard.
+ */
+
+//             Name                                 ID      Text
+KG_LOG_MESSAGE(RECORDS_DROPPED,                     0x0001, "Log ring full, %d records dropped")
+
+KG_LOG_MESSAGE(SYSTEM_ALLOC_FAILED,                 0x0101, "Memory allocation failed in subsystem %d")
+
+KG_LOG_MESSAGE(BT2_IWRAP_TESTING,                   0x0201, "Testing iWRAP communication...")
+KG_LOG_MESSAGE(BT2_IWRAP_GET_SETTINGS,              0x0202, "Getting iWRAP settings...")
+KG_LOG_MESSAGE(BT2_IWRAP_GET_CONNECTIONS,           0x0203, "Getting active connection list...")
+KG_LOG_MESSAGE(BT2_IWRAP_READY,                     0x0204, "iWRAP initialization complete")
+KG_LOG_MESSAGE(BT2_IWRAP_NO_RESPONSE,               0x0205, "Could not communicate with iWRAP module")
+KG_LOG_MESSAGE(BT2_CALL_PROCESSED,                  0x0206, "Pending call processed")
+KG_LOG_MESSAGE(BT2_CALLING,                         0x0207, "Calling device #%d")
+
+KG_LOG_MESSAGE(MOTION_MPU6050_HAND_FIFO_OVERFLOW,   0x0501, "MPU6050 FIFO overflow, %d bytes discarded")
@@ -0,0 +1,265 @@
+// Keyglove controller source code - Memory usage monitoring implementations
+// 2014-12-20 by Jeff Rowberg <jeff@rowberg.net>
+
+/* ============================================
+Controller code is placed under the MIT license
+Copyright (c) 2014 Jeff Rowberg
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+
+/**
+ * @file support_memory.cpp
+ * @brief Memory usage monitoring implementations
+ * @author Jeff Rowberg
+ * @date 2014-12-20
+ *
+ * The AT90USB1286 has 8KB of RAM shared by .data/.bss, the heap growing up
+ * from the end of .bss and the stack growing down from the top. Running out
+ * shows up as the two meeting, which usually corrupts something long before
+ * any malloc() call fails, so this file keeps track of how close they get:
+ *
+ * - Everything above .bss is painted with KG_MEMORY_STACK_PAINT at boot,
+ *   from the .init1 section before anything else runs. Scanning up from the
+ *   highest heap top seen for the first byte that no longer has the pattern
+ *   gives the lowest headroom there has been since boot, including stack
+ *   peaks in interrupt handlers that a free RAM reading would never catch.
+ * - Heap fragmentation is measured by walking the avr-libc free list, which
+ *   gives the number of free blocks, their total size and the largest block
+ *   malloc() could return right now.
+ * - Firmware allocations go through memory_malloc(), memory_realloc() and
+ *   memory_free(), which count calls, live blocks and failures for each
+ *   subsystem (KG_SYSTEM_MEMORY_SUBSYSTEM_*). Failures are also logged.
+ *
+ * update_memory() checks the headroom once per second and sends a
+ * "system_memory_low" event the first time it drops below memoryThreshold.
+ * It is not sent again until the threshold is set again.
+ *
+ * The Linux simulation has no fixed RAM layout to measure, so only the
+ * allocation counters mean anything there, and the headroom always reads as
+ * unlimited.
+ *
+ * Normally it is not necessary to edit this file.
+ */
+
+#include "keyglove.h"
+#include "support_board.h"
+#include "support_protocol.h"
+
+uint32_t memoryAllocations[KG_MEMORY_SUBSYSTEM_COUNT];  ///< Successful malloc/realloc calls for each subsystem
+uint16_t memoryBlocks[KG_MEMORY_SUBSYSTEM_COUNT];       ///< Blocks currently allocated by each subsystem
+uint16_t memoryFailures[KG_MEMORY_SUBSYSTEM_COUNT];     ///< Failed malloc/realloc calls for each subsystem
+uint16_t memoryThreshold;                               ///< Stack headroom below which "memory_low" is sent (0 = never)
+bool memoryLowSent;                                     ///< Whether "memory_low" has been sent since the threshold was set
+
+#if KG_BOARD != KG_BOARD_LINUX_SIM
+
+extern uint8_t __heap_start;                            ///< First byte after .bss (linker symbol)
+extern char *__brkval;                                  ///< Current top of the heap, or 0 before the first malloc()
+extern size_t __malloc_margin;                          ///< Bytes malloc() always leaves free below the stack pointer
+
+struct __freelist {
+    size_t sz;                                          ///< Usable size of this free block
+    struct __freelist *nx;                              ///< Next free block, or 0 at the end of the list
+};
+extern struct __freelist *__flp;                        ///< avr-libc heap free list
+
+uint8_t *memoryHeapPeak;                                ///< Highest heap top seen, where the headroom scan starts
+
+void memory_paint_stack() __attribute__ ((naked, used, section (".init1")));
+
+/**
+ * @brief Fill all RAM above .bss with KG_MEMORY_STACK_PAINT
+ *
+ * This is never called. The linker places it in .init1, which runs straight
+ * after reset, before the stack pointer is set up or .data/.bss are
+ * initialized, so it uses nothing but scratch registers.
+ */
+void memory_paint_stack() {
+    __asm volatile (
+        "    ldi r30, lo8(__heap_start)     \n"
+        "    ldi r31, hi8(__heap_start)     \n"
+        "    ldi r24, %0                    \n"
+        "    ldi r25, hi8(__stack)          \n"
+        "    rjmp 2f                        \n"
+        "1:  st Z+, r24                     \n"
+        "2:  cpi r30, lo8(__stack)          \n"
+        "    cpc r31, r25                   \n"
+        "    brlo 1b                        \n"
+        "    breq 1b                        \n"
+        : : "M" (KG_MEMORY_STACK_PAINT));
+}
+
+/**
+ * @brief Get the current top of the heap, and remember it if it is the highest yet
+ * @return First byte above the heap
+ */
+uint8_t *memory_heap_top() {
+    uint8_t *top = __brkval ? (uint8_t *)__brkval : &__heap_start;
+    if (top > memoryHeapPeak) memoryHeapPeak = top;
+    return top;
+}
+
+/**
+ * @brief Get the number of bytes between the top of the heap and the stack right now
+ * @return Free RAM in bytes
+ */
+uint16_t memory_free_ram() {
+    return (uint8_t *)SP - memory_heap_top();
+}
+
+/**
+ * @brief Get the lowest headroom between the heap and the stack since boot
+ * @return Headroom in bytes
+ *
+ * Memory below the highest heap top ever seen has been written, so the scan
+ * starts there. This never reads higher than an earlier result did.
+ */
+uint16_t memory_stack_headroom() {
+    memory_heap_top();
+    uint8_t *p = memoryHeapPeak;
+    uint8_t *sp = (uint8_t *)SP;
+    while (p < sp && *p == KG_MEMORY_STACK_PAINT) p++;
+    return p - memoryHeapPeak;
+}
+
+/**
+ * @brief Measure heap size and fragmentation
+ * @param[out] heapSize Bytes claimed by the heap, including free blocks
+ * @param[out] heapFree Bytes in free blocks inside the heap
+ * @param[out] largestFree Largest block malloc() could return right now
+ * @param[out] freeBlocks Number of free blocks inside the heap
+ */
+void memory_heap_stats(uint16_t *heapSize, uint16_t *heapFree, uint16_t *largestFree, uint8_t *freeBlocks) {
+    uint8_t *top = memory_heap_top();
+    *heapSize = top - &__heap_start;
+    *heapFree = 0;
+    *largestFree = 0;
+    *freeBlocks = 0;
+
+    // malloc() is never used from interrupts, so the list can't change under us
+    for (struct __freelist *fp = __flp; fp; fp = fp -> nx) {
+        *heapFree += fp -> sz + sizeof(size_t);
+        if (fp -> sz > *largestFree) *largestFree = fp -> sz;
+        if (*freeBlocks < 0xFF) (*freeBlocks)++;
+    }
+
+    // a new block can also come from above the heap, up to __malloc_margin below the stack
+    uint8_t *limit = (uint8_t *)SP - __malloc_margin;
+    if (limit > top + sizeof(size_t) && (uint16_t)(limit - top - sizeof(size_t)) > *largestFree) {
+        *largestFree = limit - top - sizeof(size_t);
+    }
+}
+
+#else
+
+uint16_t memory_free_ram() {
+    return 0;
+}
+
+uint16_t memory_stack_headroom() {
+    return 0xFFFF;
+}
+
+void memory_heap_stats(uint16_t *heapSize, uint16_t *heapFree, uint16_t *largestFree, uint8_t *freeBlocks) {
+    *heapSize = 0;
+    *heapFree = 0;
+    *largestFree = 0;
+    *freeBlocks = 0;
+}
+
+#endif
+
+/**
+ * @brief Set the default low memory threshold
+ *
+ * Allocation counters are not cleared, since buffers allocated before a
+ * "system_reset" command are still in use afterwards.
+ */
+void setup_memory() {
+    memoryThreshold = KG_MEMORY_THRESHOLD_DEFAULT;
+    memoryLowSent = false;
+}
+
+/**
+ * @brief Check headroom against the threshold (called once per second), and send "memory_low" the first time it is below
+ *
+ * The event is sent only once until the threshold is set again, which clears memoryLowSent.
+ */
+void update_memory() {
+    if (memoryThreshold == 0 || memoryLowSent) return;
+    uint16_t headroom = memory_stack_headroom();
+    if (headroom >= memoryThreshold) return;
+    memoryLowSent = true;
+
+    // send system_memory_low event
+    uint8_t payload[4] = { (uint8_t)(headroom & 0xFF), (uint8_t)(headroom >> 8), (uint8_t)(memoryThreshold & 0xFF), (uint8_t)(memoryThreshold >> 8) };
+    skipPacket = 0;
+    if (kg_evt_system_memory_low) skipPacket = kg_evt_system_memory_low(headroom, memoryThreshold);
+    if (!skipPacket) send_keyglove_packet(KG_PACKET_TYPE_EVENT, 4, KG_PACKET_CLASS_SYSTEM, KG_PACKET_ID_EVT_SYSTEM_MEMORY_LOW, payload);
+}
+
+/**
+ * @brief Allocate memory for a subsystem and count it
+ * @param[in] subsystem Subsystem making the allocation (KG_SYSTEM_MEMORY_SUBSYSTEM_*)
+ * @param[in] size Number of bytes to allocate
+ * @return New block, or 0 if there was not enough memory
+ */
+void *memory_malloc(uint8_t subsystem, size_t size) {
+    void *ptr = malloc(size);
+    if (ptr) {
+        memoryAllocations[subsystem]++;
+        memoryBlocks[subsystem]++;
+    } else {
+        memoryFailures[subsystem]++;
+        keyglove_log(KG_LOG_LEVEL_WARNING, KG_LOG_SYSTEM_ALLOC_FAILED, subsystem);
+    }
+    return ptr;
+}
+
+/**
+ * @brief Resize a subsystem's block of memory and count it
+ * @param[in] subsystem Subsystem making the allocation (KG_SYSTEM_MEMORY_SUBSYSTEM_*)
+ * @param[in] ptr Existing block, or 0 to allocate a new one
+ * @param[in] size New number of bytes
+ * @return Resized block, or 0 if there was not enough memory (the old block is left alone)
+ */
+void *memory_realloc(uint8_t subsystem, void *ptr, size_t size) {
+    void *newPtr = realloc(ptr, size);
+    if (newPtr) {
+        memoryAllocations[subsystem]++;
+        if (!ptr) memoryBlocks[subsystem]++;
+    } else {
+        memoryFailures[subsystem]++;
+        keyglove_log(KG_LOG_LEVEL_WARNING, KG_LOG_SYSTEM_ALLOC_FAILED, subsystem);
+    }
+    return newPtr;
+}
+
+/**
+ * @brief Free a subsystem's block of memory and count it
+ * @param[in] subsystem Subsystem which made the allocation (KG_SYSTEM_MEMORY_SUBSYSTEM_*)
+ * @param[in] ptr Block to free (0 is ignored)
+ */
+void memory_free(uint8_t subsystem, void *ptr) {
+    if (ptr) memoryBlocks[subsystem]--;
+    free(ptr);
+}
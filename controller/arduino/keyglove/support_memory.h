@@ -0,0 +1,60 @@
+// Keyglove controller source code - Memory usage monitoring declarations
+// 2014-12-20 by Jeff Rowberg <jeff@rowberg.net>
+
+/* ============================================
+Controller code is placed under the MIT license
+Copyright (c) 2014 Jeff Rowberg
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+
+/**
+ * @file support_memory.h
+ * @brief Memory usage monitoring declarations
+ * @author Jeff Rowberg
+ * @date 2014-12-20
+ */
+
+#ifndef _SUPPORT_MEMORY_H_
+#define _SUPPORT_MEMORY_H_
+
+#define KG_MEMORY_SUBSYSTEM_COUNT               3       ///< Number of subsystems with allocation counters (see KG_SYSTEM_MEMORY_SUBSYSTEM_*)
+#define KG_MEMORY_STACK_PAINT                   0xC5    ///< Byte pattern written over free RAM at boot
+#define KG_MEMORY_THRESHOLD_DEFAULT             256     ///< Default stack headroom (bytes) below which "memory_low" is sent
+
+extern uint32_t memoryAllocations[KG_MEMORY_SUBSYSTEM_COUNT];
+extern uint16_t memoryBlocks[KG_MEMORY_SUBSYSTEM_COUNT];
+extern uint16_t memoryFailures[KG_MEMORY_SUBSYSTEM_COUNT];
+extern uint16_t memoryThreshold;
+extern bool memoryLowSent;
+
+void setup_memory();
+void update_memory();
+
+void *memory_malloc(uint8_t subsystem, size_t size);
+void *memory_realloc(uint8_t subsystem, void *ptr, size_t size);
+void memory_free(uint8_t subsystem, void *ptr);
+
+uint16_t memory_free_ram();
+uint16_t memory_stack_headroom();
+void memory_heap_stats(uint16_t *heapSize, uint16_t *heapFree, uint16_t *largestFree, uint8_t *freeBlocks);
+
+#endif // _SUPPORT_MEMORY_H_
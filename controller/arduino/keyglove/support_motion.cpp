@@ -32,7 +32,11 @@ THE SOFTWARE.
  * @date 2014-11-07
  *
  * This file provides the structural framework for motion implementations in the
- * overall Keyglove architecture.
+ * overall Keyglove architecture. Every sensor is an entry in the motionDriver[]
+ * registry, with its runtime configuration in motionConfig[]. The scheduler
+ * keeps the combined sensor bus traffic within KG_MOTION_BUS_BUDGET, and thins
+ * out each motion_data stream so that all of them together stay within
+ * KG_MOTION_STREAM_BUDGET.
  *
  * Normally it is not necessary to edit this file.
  */
@@ -42,6 +46,130 @@ THE SOFTWARE.
 #include "support_motion.h"
 
 motion_mode_t motionMode[KG_MOTION_SENSOR_COUNT];   ///< Motion sensor modes
+uint8_t motionStreamCount[KG_MOTION_SENSOR_COUNT];  ///< Samples since each sensor's last motion_data packet
+
+/**
+ * @brief Motion sensor driver registry, in sensor index order
+ */
+const motion_driver_t motionDriver[KG_MOTION_SENSOR_COUNT] = {
+    #if (KG_MOTION & KG_MOTION_MPU6050_HAND)
+        { setup_motion_mpu6050_hand, motion_mpu6050_hand_configure, update_motion_mpu6050_hand, motion_set_mpu6050_hand_mode, KG_MPU6050_HAND_SAMPLE_SIZE },
+    #endif
+};
+
+/**
+ * @brief Motion sensor configurations, in sensor index order (defaults here)
+ */
+motion_config_t motionConfig[KG_MOTION_SENSOR_COUNT] = {
+    #if (KG_MOTION & KG_MOTION_MPU6050_HAND)
+        { KG_MPU6050_HAND_SAMPLE_RATE, 0, 3, 3, KG_MOTION_ENCODING_ACCEL | KG_MOTION_ENCODING_GYRO, KG_MPU6050_HAND_SAMPLE_RATE, 1 },
+    #endif
+};
+
+/**
+ * @brief Get the motion_data payload size for a stream encoding
+ * @param[in] encoding Stream encoding (KG_MOTION_ENCODING_*)
+ * @return Bytes of motion data per packet
+ */
+uint8_t motion_stream_size(uint8_t encoding) {
+    uint8_t size = 0;
+    if (encoding & KG_MOTION_ENCODING_ACCEL) size += 6;
+    if (encoding & KG_MOTION_ENCODING_GYRO) size += 6;
+    return (encoding & KG_MOTION_ENCODING_COMPACT) ? size / 2 : size;
+}
+
+/**
+ * @brief Check total bus load and choose each sensor's stream divider
+ * @return Zero if all sensors fit within KG_MOTION_BUS_BUDGET, non-zero if not
+ *
+ * Bus load is counted for every configured sensor, whether enabled or not, so
+ * that enabling a sensor can never push the total over budget. When the
+ * requested streams add up to more than KG_MOTION_STREAM_BUDGET, every stream
+ * is scaled down by the same factor, so each sensor keeps its share.
+ */
+uint8_t motion_schedule() {
+    uint32_t bus = 0, stream = 0;
+    uint8_t i;
+    for (i = 0; i < KG_MOTION_SENSOR_COUNT; i++) {
+        bus += (uint32_t)motionConfig[i].rate * motionDriver[i].sample_size;
+
+        // 4-byte packet header, 3-byte event header, then the data
+        stream += (uint32_t)min(motionConfig[i].stream_rate, motionConfig[i].rate) * (7 + motion_stream_size(motionConfig[i].encoding));
+    }
+    if (bus > KG_MOTION_BUS_BUDGET) return 1;
+
+    for (i = 0; i < KG_MOTION_SENSOR_COUNT; i++) {
+        uint32_t rate = min(motionConfig[i].stream_rate, motionConfig[i].rate);
+        if (stream > KG_MOTION_STREAM_BUDGET) rate = rate * KG_MOTION_STREAM_BUDGET / stream;
+        if (motionConfig[i].stream_rate == 0) {
+            motionConfig[i].stream_divider = 0;
+        } else if (rate == 0) {
+            motionConfig[i].stream_divider = 255;
+        } else {
+            uint32_t divider = (motionConfig[i].rate + rate - 1) / rate;
+            motionConfig[i].stream_divider = divider > 255 ? 255 : divider;
+        }
+        motionStreamCount[i] = 0;
+    }
+    return 0;
+}
+
+/**
+ * @brief Send one sample as a kg_evt_motion_data packet, if it is due
+ * @param[in] index Motion sensor index
+ * @param[in] accel Acceleration to send
+ * @param[in] gyro Rotation rate to send
+ *
+ * Drivers call this once for every sample, passing filtered or raw values as
+ * selected by KG_MOTION_ENCODING_RAW. Only every stream_divider'th sample
+ * goes out. The flags byte of the event is the encoding, so the host knows
+ * exactly what follows.
+ *
+ * @see API event: kg_evt_motion_data()
+ */
+void motion_stream_sample(uint8_t index, VectorInt16 *accel, VectorInt16 *gyro) {
+    motion_config_t *config = &motionConfig[index];
+    if (config -> stream_divider == 0 || ++motionStreamCount[index] < config -> stream_divider) return;
+    motionStreamCount[index] = 0;
+
+    int16_t value[6] = { accel -> x, accel -> y, accel -> z, gyro -> x, gyro -> y, gyro -> z };
+    uint8_t payload[15];
+    uint8_t length = 0, i;
+    for (i = 0; i < 6; i++) {
+        if (!(config -> encoding & (i < 3 ? KG_MOTION_ENCODING_ACCEL : KG_MOTION_ENCODING_GYRO))) continue;
+        if (config -> encoding & KG_MOTION_ENCODING_COMPACT) {
+            payload[3 + length++] = value[i] >> 8;
+        } else {
+            payload[3 + length++] = value[i] & 0xFF;
+            payload[3 + length++] = value[i] >> 8;
+        }
+    }
+    payload[0] = index;
+    payload[1] = config -> encoding;
+    payload[2] = length;
+    skipPacket = 0;
+    if (kg_evt_motion_data) skipPacket = kg_evt_motion_data(payload[0], payload[1], payload[2], payload + 3);
+    if (!skipPacket) send_keyglove_packet(KG_PACKET_TYPE_EVENT, 3 + length, KG_PACKET_CLASS_MOTION, KG_PACKET_ID_EVT_MOTION_DATA, payload);
+}
+
+/**
+ * @brief Initialize all motion sensors with their default configurations
+ */
+void setup_motion() {
+    for (uint8_t i = 0; i < KG_MOTION_SENSOR_COUNT; i++) {
+        motionMode[i] = KG_MOTION_MODE_OFF;
+        motionDriver[i].configure(&motionConfig[i]);
+        motionDriver[i].setup();
+    }
+    motion_schedule();
+}
+
+/**
+ * @brief Let each motion sensor start reading new samples, called from loop()
+ */
+void update_motion() {
+    for (uint8_t i = 0; i < KG_MOTION_SENSOR_COUNT; i++) motionDriver[i].update();
+}
 
 /* ============================= */
 /* KGAPI COMMAND IMPLEMENTATIONS */
@@ -72,10 +200,8 @@ uint16_t kg_cmd_motion_set_mode(uint8_t index, uint8_t mode) {
     if (index >= KG_MOTION_SENSOR_COUNT || mode >= KG_MOTION_MODE_MAX) {
         return KG_PROTOCOL_ERROR_PARAMETER_RANGE;
     } else {
-        //motion_set_mode((motion_mode_t)mode);
-        if (index == 0) {
-            motion_set_mpu6050_hand_mode(mode);
-        }
+        motionMode[index] = (motion_mode_t)mode;
+        motionDriver[index].set_mode(mode);
 
         // send kg_evt_feedback_vibrate_mode packet (if we aren't setting it from an API command)
         if (!inBinPacket) {
@@ -87,3 +213,90 @@ uint16_t kg_cmd_motion_set_mode(uint8_t index, uint8_t mode) {
     }
     return 0; // success
 }
+
+/**
+ * @brief Start offset calibration for specified motion sensor
+ * @param[in] index Index of motion sensor to calibrate
+ * @param[in] flags Offsets to calibrate (0x01 = gyro, 0x02 = accel, 0 = cancel)
+ * @return Result code (0=success)
+ * @see API event: kg_evt_motion_calibration()
+ */
+uint16_t kg_cmd_motion_calibrate(uint8_t index, uint8_t flags) {
+    if (index >= KG_MOTION_SENSOR_COUNT) {
+        return KG_PROTOCOL_ERROR_PARAMETER_RANGE;
+    }
+    #if (KG_MOTION & KG_MOTION_MPU6050_HAND)
+        if (index == KG_MOTION_INDEX_MPU6050_HAND && motion_mpu6050_hand_cal_start(flags)) return KG_PROTOCOL_ERROR_PARAMETER_RANGE;
+    #endif
+    return 0; // success
+}
+
+/**
+ * @brief Get the current configuration of specified motion sensor
+ * @param[in] index Index of motion sensor
+ * @param[out] rate Output data rate in Hz
+ * @param[out] accel_range Accelerometer full scale
+ * @param[out] gyro_range Gyroscope full scale
+ * @param[out] filter Low-pass filter setting
+ * @param[out] encoding motion_data stream encoding
+ * @param[out] stream_rate Actual motion_data rate in Hz after scheduling
+ * @return Result code (0=success)
+ */
+uint16_t kg_cmd_motion_get_config(uint8_t index, uint16_t *rate, uint8_t *accel_range, uint8_t *gyro_range, uint8_t *filter, uint8_t *encoding, uint16_t *stream_rate) {
+    if (index >= KG_MOTION_SENSOR_COUNT) {
+        return KG_PROTOCOL_ERROR_PARAMETER_RANGE;
+    } else {
+        motion_config_t *config = &motionConfig[index];
+        *rate = config -> rate;
+        *accel_range = config -> accel_range;
+        *gyro_range = config -> gyro_range;
+        *filter = config -> filter;
+        *encoding = config -> encoding;
+        *stream_rate = config -> stream_divider ? config -> rate / config -> stream_divider : 0;
+    }
+    return 0; // success
+}
+
+/**
+ * @brief Set a new configuration for specified motion sensor
+ * @param[in] index Index of motion sensor
+ * @param[in] rate Output data rate in Hz
+ * @param[in] accel_range Accelerometer full scale (0=2g, 1=4g, 2=8g, 3=16g)
+ * @param[in] gyro_range Gyroscope full scale (0=250, 1=500, 2=1000, 3=2000 deg/s)
+ * @param[in] filter Low-pass filter setting
+ * @param[in] encoding motion_data stream encoding (KG_MOTION_ENCODING_*)
+ * @param[in] stream_rate Requested motion_data rate in Hz (0 for no stream)
+ * @return Result code (0=success)
+ *
+ * The new configuration is rejected, and the old one kept, if the sensor does
+ * not support it or the total bus load would go over KG_MOTION_BUS_BUDGET.
+ */
+uint16_t kg_cmd_motion_set_config(uint8_t index, uint16_t rate, uint8_t accel_range, uint8_t gyro_range, uint8_t filter, uint8_t encoding, uint16_t stream_rate) {
+    if (index >= KG_MOTION_SENSOR_COUNT || (encoding & ~(KG_MOTION_ENCODING_ACCEL | KG_MOTION_ENCODING_GYRO | KG_MOTION_ENCODING_RAW | KG_MOTION_ENCODING_COMPACT))) {
+        return KG_PROTOCOL_ERROR_PARAMETER_RANGE;
+    } else {
+        motion_config_t old = motionConfig[index];
+        motion_config_t *config = &motionConfig[index];
+        config -> rate = rate;
+        config -> accel_range = accel_range;
+        config -> gyro_range = gyro_range;
+        config -> filter = filter;
+        config -> encoding = encoding;
+        config -> stream_rate = stream_rate;
+        if (motion_schedule() || motionDriver[index].configure(config)) {
+            motionConfig[index] = old;
+            motion_schedule();
+            return KG_PROTOCOL_ERROR_PARAMETER_RANGE;
+        }
+
+        // send kg_evt_motion_config packet (if we aren't setting it from an API command)
+        if (!inBinPacket) {
+            uint16_t actual = config -> stream_divider ? rate / config -> stream_divider : 0;
+            uint8_t payload[9] = { index, rate & 0xFF, rate >> 8, accel_range, gyro_range, filter, encoding, actual & 0xFF, actual >> 8 };
+            skipPacket = 0;
+            if (kg_evt_motion_config) skipPacket = kg_evt_motion_config(index, rate, accel_range, gyro_range, filter, encoding, actual);
+            if (!skipPacket) send_keyglove_packet(KG_PACKET_TYPE_EVENT, 9, KG_PACKET_CLASS_MOTION, KG_PACKET_ID_EVT_MOTION_CONFIG, payload);
+        }
+    }
+    return 0; // success
+}
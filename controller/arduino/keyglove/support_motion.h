@@ -43,13 +43,60 @@ THE SOFTWARE.
 #ifndef _SUPPORT_MOTION_H_
 #define _SUPPORT_MOTION_H_
 
+#include "support_helper_3dmath.h"
+
+#define KG_MOTION_ENCODING_ACCEL    0x01    ///< Stream encoding flag: include acceleration
+#define KG_MOTION_ENCODING_GYRO     0x02    ///< Stream encoding flag: include rotation rate
+#define KG_MOTION_ENCODING_RAW      0x04    ///< Stream encoding flag: unfiltered values in the sensor's configured range
+#define KG_MOTION_ENCODING_COMPACT  0x08    ///< Stream encoding flag: one byte (high byte) per axis instead of two
+
+#define KG_MOTION_BUS_BUDGET        12000   ///< Most sensor bus bytes per second all sensors together may be configured for
+#define KG_MOTION_STREAM_BUDGET     4000    ///< Most motion_data bytes per second (packet headers included) sent for all sensors together
+
+/**
+ * @brief Runtime configuration for one motion sensor
+ */
+typedef struct {
+    uint16_t rate;              ///< Output data rate in Hz
+    uint8_t accel_range;        ///< Accelerometer full scale (0=2g, 1=4g, 2=8g, 3=16g)
+    uint8_t gyro_range;         ///< Gyroscope full scale (0=250, 1=500, 2=1000, 3=2000 deg/s)
+    uint8_t filter;             ///< Low-pass filter setting (meaning depends on the sensor)
+    uint8_t encoding;           ///< motion_data stream contents (KG_MOTION_ENCODING_*)
+    uint16_t stream_rate;       ///< Requested motion_data rate in Hz (0 for no stream)
+    uint8_t stream_divider;     ///< Samples per motion_data packet, chosen by motion_schedule() (0 for no stream)
+} motion_config_t;
+
+/**
+ * @brief Functions and bus cost of one motion sensor driver
+ *
+ * Each entry of motionDriver[] is one sensor, and its position is the sensor
+ * index used by KGAPI. The driver owns reading and unpacking its own samples;
+ * the shared code only handles configuration, scheduling and streaming.
+ */
+typedef struct {
+    void (*setup)();                            ///< Initialize the sensor using its motionConfig[] entry
+    uint8_t (*configure)(motion_config_t *config);  ///< Check and apply a configuration (non-zero if unsupported)
+    void (*update)();                           ///< Start reading any batch of new samples, called from loop()
+    void (*set_mode)(uint8_t mode);             ///< Enable the sensor, or disable and power it down
+    uint8_t sample_size;                        ///< Sensor bus bytes read per sample
+} motion_driver_t;
+
 #if (KG_MOTION & KG_MOTION_MPU6050_HAND)
-     #include "support_motion_mpu6050_hand.h"
+    #include "support_motion_mpu6050_hand.h"
+    #include "support_motion_gesture.h"
+    #define KG_MOTION_INDEX_MPU6050_HAND    0   ///< Sensor index of the hand-mounted MPU-6050
     #define KG_MOTION_SENSOR_COUNT  1
 #else
     #define KG_MOTION_SENSOR_COUNT  0           ///< Number of motion sensors incorporated in design
 #endif
 
+#if (KG_FUSION > 0)
+    #if !(KG_MOTION & KG_MOTION_MPU6050_HAND)
+        #error Motion fusion requires the hand-mounted MPU-6050 (KG_MOTION_MPU6050_HAND).
+    #endif
+    #include "support_motion_fusion.h"
+#endif
+
 /**
  * @brief List of possible values for motion sensor mode
  */
@@ -60,5 +107,12 @@ typedef enum {
 } motion_mode_t;
 
 extern motion_mode_t motionMode[KG_MOTION_SENSOR_COUNT];
+extern motion_config_t motionConfig[KG_MOTION_SENSOR_COUNT];
+extern const motion_driver_t motionDriver[KG_MOTION_SENSOR_COUNT];
+
+uint8_t motion_schedule();
+void motion_stream_sample(uint8_t index, VectorInt16 *accel, VectorInt16 *gyro);
+void setup_motion();
+void update_motion();
 
 #endif // _SUPPORT_MOTION_H_
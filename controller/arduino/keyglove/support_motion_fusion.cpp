@@ -0,0 +1,229 @@
+// Keyglove controller source code - Orientation fusion from hand motion data
+// 2014-12-14 by Jeff Rowberg <jeff@rowberg.net>
+
+
+/* ============================================
+Controller code is placed under the MIT license
+Copyright (c) 2014 Jeff Rowberg
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+/**
+ * @file support_motion_fusion.cpp
+ * @brief Orientation fusion from hand motion data
+ * @author Jeff Rowberg
+ * @date 2014-12-14
+ *
+ * This file combines the accelerometer and gyroscope data from the hand-mounted
+ * MPU-6050 into an orientation quaternion using a Mahony complementary filter,
+ * and uses that orientation to rotate each acceleration sample into the world
+ * frame and remove gravity from it. The result (apFrame) is linear motion that
+ * no longer depends on how the hand is tilted, which is what the movement-based
+ * mouse modes need.
+ *
+ * Everything runs in fixed point so that it fits comfortably inside one sample
+ * period on an 8-bit MCU with no FPU. The quaternion is kept in Q30 so that the
+ * very small per-sample increments from slow rotations are not lost, but all of
+ * the products use its top 16 bits (Q14) so they remain 16x16 multiplies. The
+ * time spent in each update is measured in fusionTime and fusionTimeMax.
+ *
+ * There is no magnetometer, so roll and pitch are held against gravity but
+ * heading (rotation about world Z) will slowly drift with gyro bias.
+ *
+ * Normally it is not necessary to edit this file.
+ */
+
+#include "keyglove.h"
+#include "support_board.h"
+#include "support_protocol.h"
+#include "support_motion.h"
+//#include "support_motion_fusion.h"      // <-- included by support_motion.h
+
+int32_t fusionQ[4];                     ///< Hand orientation quaternion (w, x, y, z) from body to world frame, Q30
+int32_t fusionIntegral[3];              ///< Integral feedback per gyro axis, gyro LSB in Q24
+uint8_t fusionAligned;                  ///< Whether orientation has been seeded from gravity since the last reset
+VectorInt16 apFrame;                    ///< Gravity-compensated world-frame linear acceleration (accel LSB)
+uint16_t fusionTime;                    ///< Microseconds spent in the most recent fusion update
+uint16_t fusionTimeMax;                 ///< Most microseconds spent in any fusion update since reset
+int16_t fusionDqScale;                  ///< KG_FUSION_DQ_SCALE at the current rate
+int16_t fusionKiScale;                  ///< KG_FUSION_KI_SCALE at the current rate
+
+/**
+ * @brief Limit a value to a symmetric range
+ * @param[in] value Value to limit
+ * @param[in] limit Largest allowed magnitude
+ * @return Limited value
+ */
+int32_t motion_fusion_clamp(int32_t value, int32_t limit) {
+    if (value > limit) return limit;
+    if (value < -limit) return -limit;
+    return value;
+}
+
+/**
+ * @brief Multiply a 32-bit value by a 16-bit fraction without a 64-bit product
+ * @param[in] value Value to scale
+ * @param[in] scale Positive multiplier in Q16 (below 32768)
+ * @return (value * scale) >> 16
+ */
+int32_t motion_fusion_scale(int32_t value, int16_t scale) {
+    return (value >> 16) * scale + (int32_t)(((uint32_t)(value & 0xFFFF) * (uint16_t)scale) >> 16);
+}
+
+/**
+ * @brief Reset orientation, to be seeded again from the next gravity reading
+ *
+ * The rate-dependent scales are worked out here too (in float, since this
+ * is rare), so this must also be called whenever KG_FUSION_RATE changes.
+ */
+void motion_fusion_reset() {
+    fusionDqScale = KG_FUSION_DQ_SCALE(KG_FUSION_RATE);
+    fusionKiScale = KG_FUSION_KI_SCALE(KG_FUSION_RATE);
+    fusionQ[0] = 1L << 30;
+    fusionQ[1] = fusionQ[2] = fusionQ[3] = 0;
+    fusionIntegral[0] = fusionIntegral[1] = fusionIntegral[2] = 0;
+    fusionAligned = 0;
+    apFrame.x = apFrame.y = apFrame.z = 0;
+    fusionTimeMax = 0;
+}
+
+/**
+ * @brief Seed orientation with the shortest rotation taking measured gravity onto world +Z
+ * @param[in] accel Acceleration sample known to be close to 1g
+ *
+ * This only runs once after each reset, so it is allowed to use float math.
+ * Without it, the filter would need several seconds to pull in from level if
+ * the hand started out tilted.
+ */
+void motion_fusion_align(VectorInt16 *accel) {
+    VectorFloat a(accel->x, accel->y, accel->z);
+    a.normalize();
+    Quaternion q;
+    if (a.z < -0.999f) {
+        // upside down, so any half turn about a horizontal axis will do
+        q = Quaternion(0, 1, 0, 0);
+    } else {
+        q = Quaternion(1.0f + a.z, a.y, -a.x, 0).getNormalized();
+    }
+    fusionQ[0] = q.w * 1073741824.0f;
+    fusionQ[1] = q.x * 1073741824.0f;
+    fusionQ[2] = q.y * 1073741824.0f;
+    fusionQ[3] = q.z * 1073741824.0f;
+}
+
+/**
+ * @brief Get the current hand orientation as a float quaternion
+ * @param[out] q Orientation from body to world frame
+ */
+void motion_fusion_get_quaternion(Quaternion *q) {
+    q -> w = fusionQ[0] / 1073741824.0f;
+    q -> x = fusionQ[1] / 1073741824.0f;
+    q -> y = fusionQ[2] / 1073741824.0f;
+    q -> z = fusionQ[3] / 1073741824.0f;
+}
+
+/**
+ * @brief Initialize orientation fusion
+ */
+void setup_motion_fusion() {
+    motion_fusion_reset();
+    fusionTime = 0;
+}
+
+/**
+ * @brief Fuse one accel/gyro sample into orientation and world-frame acceleration
+ * @param[in] accel Raw acceleration sample (+/-2g range)
+ * @param[in] gyro Raw rotation rate sample (+/-2000 deg/s range)
+ * @see KG_FUSION_RATE
+ *
+ * Call this exactly once per sensor sample; the integration step assumes the
+ * samples are KG_FUSION_RATE apart, which the FIFO guarantees.
+ */
+void update_motion_fusion(VectorInt16 *accel, VectorInt16 *gyro) {
+    uint32_t t0 = micros();
+
+    // only trust the accelerometer as a gravity reference when the hand isn't accelerating much
+    uint32_t a2 = (uint32_t)((int32_t)accel -> x * accel -> x)
+                + (uint32_t)((int32_t)accel -> y * accel -> y)
+                + (uint32_t)((int32_t)accel -> z * accel -> z);
+    uint8_t trusted = (a2 > KG_FUSION_ACCEL_MIN && a2 < KG_FUSION_ACCEL_MAX);
+
+    if (!fusionAligned) {
+        if (!trusted) return;
+        motion_fusion_align(accel);
+        fusionAligned = 1;
+    }
+
+    int16_t q0 = fusionQ[0] >> 16, q1 = fusionQ[1] >> 16, q2 = fusionQ[2] >> 16, q3 = fusionQ[3] >> 16;
+    int32_t gx = gyro -> x, gy = gyro -> y, gz = gyro -> z;
+
+    if (trusted) {
+        // estimated gravity direction in body frame, i.e. third row of rotation matrix (Q14)
+        int16_t vx = ((int32_t)q1 * q3 - (int32_t)q0 * q2) >> 13;
+        int16_t vy = ((int32_t)q2 * q3 + (int32_t)q0 * q1) >> 13;
+        int16_t vz = 16384 - (((int32_t)q1 * q1 + (int32_t)q2 * q2) >> 13);
+
+        // error is the cross product of measured and estimated gravity (Q14, accel is ~1g = 1.0)
+        int16_t ex = ((int32_t)accel -> y * vz - (int32_t)accel -> z * vy) >> 14;
+        int16_t ey = ((int32_t)accel -> z * vx - (int32_t)accel -> x * vz) >> 14;
+        int16_t ez = ((int32_t)accel -> x * vy - (int32_t)accel -> y * vx) >> 14;
+
+        fusionIntegral[0] = motion_fusion_clamp(fusionIntegral[0] + (int32_t)ex * fusionKiScale, KG_FUSION_INTEGRAL_MAX);
+        fusionIntegral[1] = motion_fusion_clamp(fusionIntegral[1] + (int32_t)ey * fusionKiScale, KG_FUSION_INTEGRAL_MAX);
+        fusionIntegral[2] = motion_fusion_clamp(fusionIntegral[2] + (int32_t)ez * fusionKiScale, KG_FUSION_INTEGRAL_MAX);
+
+        gx += ((int32_t)ex * KG_FUSION_KP_SCALE) >> 16;
+        gy += ((int32_t)ey * KG_FUSION_KP_SCALE) >> 16;
+        gz += ((int32_t)ez * KG_FUSION_KP_SCALE) >> 16;
+    }
+
+    int16_t wx = motion_fusion_clamp(gx + (fusionIntegral[0] >> 24), 32767);
+    int16_t wy = motion_fusion_clamp(gy + (fusionIntegral[1] >> 24), 32767);
+    int16_t wz = motion_fusion_clamp(gz + (fusionIntegral[2] >> 24), 32767);
+
+    // integrate q' = 0.5 * q * (0, w) over one sample period
+    int32_t s0 = -(int32_t)q1 * wx - (int32_t)q2 * wy - (int32_t)q3 * wz;
+    int32_t s1 =  (int32_t)q0 * wx + (int32_t)q2 * wz - (int32_t)q3 * wy;
+    int32_t s2 =  (int32_t)q0 * wy - (int32_t)q1 * wz + (int32_t)q3 * wx;
+    int32_t s3 =  (int32_t)q0 * wz + (int32_t)q1 * wy - (int32_t)q2 * wx;
+    fusionQ[0] += motion_fusion_scale(s0, fusionDqScale);
+    fusionQ[1] += motion_fusion_scale(s1, fusionDqScale);
+    fusionQ[2] += motion_fusion_scale(s2, fusionDqScale);
+    fusionQ[3] += motion_fusion_scale(s3, fusionDqScale);
+
+    // renormalize with one Newton step for 1/sqrt(n) near 1: q *= 1 + (1 - n)/2
+    q0 = fusionQ[0] >> 16, q1 = fusionQ[1] >> 16, q2 = fusionQ[2] >> 16, q3 = fusionQ[3] >> 16;
+    int32_t n = (int32_t)q0 * q0 + (int32_t)q1 * q1 + (int32_t)q2 * q2 + (int32_t)q3 * q3;  // Q28
+    int32_t d = motion_fusion_clamp(((1L << 28) - n) >> 9, 65536);                          // Q20
+    fusionQ[0] += ((int32_t)q0 * d) >> 4;
+    fusionQ[1] += ((int32_t)q1 * d) >> 4;
+    fusionQ[2] += ((int32_t)q2 * d) >> 4;
+    fusionQ[3] += ((int32_t)q3 * d) >> 4;
+
+    // rotate acceleration into world frame and remove gravity
+    QuaternionQ14 q(fusionQ[0] >> 16, fusionQ[1] >> 16, fusionQ[2] >> 16, fusionQ[3] >> 16);
+    apFrame = *accel;
+    vector_int16_rotate_q14(&apFrame, 1, &q);
+    apFrame.z = motion_fusion_clamp((int32_t)apFrame.z - KG_FUSION_ACCEL_1G, 32767);
+
+    fusionTime = micros() - t0;
+    if (fusionTime > fusionTimeMax) fusionTimeMax = fusionTime;
+}
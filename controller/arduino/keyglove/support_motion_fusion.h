@@ -0,0 +1,67 @@
+// Keyglove controller source code - Orientation fusion declarations
+// 2014-12-14 by Jeff Rowberg <jeff@rowberg.net>
+
+
+/* ============================================
+Controller code is placed under the MIT license
+Copyright (c) 2014 Jeff Rowberg
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+/**
+ * @file support_motion_fusion.h
+ * @brief Orientation fusion declarations
+ * @author Jeff Rowberg
+ * @date 2014-12-14
+ */
+
+#ifndef _SUPPORT_MOTION_FUSION_H_
+#define _SUPPORT_MOTION_FUSION_H_
+
+#include "support_helper_3dmath.h"
+
+#define KG_FUSION_RATE          motionConfig[KG_MOTION_INDEX_MPU6050_HAND].rate     ///< Fusion update rate in Hz (one update per hand sensor sample)
+#define KG_FUSION_KP            1.0f                ///< Proportional feedback gain (rad/s per unit of gravity error)
+#define KG_FUSION_KI            0.02f               ///< Integral feedback gain, used to trim roll/pitch gyro bias
+#define KG_FUSION_ACCEL_1G      16384               ///< Accelerometer LSB per g (+/-2g range)
+#define KG_FUSION_GYRO_RAD      (0.0174532925f / 16.4f)     ///< Gyro rad/s per LSB (+/-2000 deg/s range)
+#define KG_FUSION_ACCEL_MIN     171798692UL         ///< Lowest squared accel magnitude trusted as gravity (0.8g)^2
+#define KG_FUSION_ACCEL_MAX     386547056UL         ///< Highest squared accel magnitude trusted as gravity (1.2g)^2
+#define KG_FUSION_INTEGRAL_MAX  (64L << 24)         ///< Integral feedback limit (64 gyro LSB, about 4 deg/s)
+
+/** Quaternion increment scale at a given rate: S (Q14 * gyro LSB) to dq (Q30) is (S * this) >> 16, must stay below 32768 */
+#define KG_FUSION_DQ_SCALE(rate)    ((int16_t)(0.5f * KG_FUSION_GYRO_RAD / (rate) * 4294967296.0f + 0.5f))
+/** Proportional feedback scale: error (Q14) to gyro LSB is (e * this) >> 16 */
+#define KG_FUSION_KP_SCALE      ((int16_t)(KG_FUSION_KP / KG_FUSION_GYRO_RAD / 16384.0f * 65536.0f + 0.5f))
+/** Integral feedback scale at a given rate: error (Q14) to gyro LSB (Q24) per sample is (e * this) */
+#define KG_FUSION_KI_SCALE(rate)    ((int16_t)(KG_FUSION_KI / (rate) / KG_FUSION_GYRO_RAD / 16384.0f * 16777216.0f + 0.5f))
+
+extern int32_t fusionQ[4];
+extern VectorInt16 apFrame;
+extern uint16_t fusionTime;
+extern uint16_t fusionTimeMax;
+
+void motion_fusion_reset();
+void motion_fusion_get_quaternion(Quaternion *q);
+void setup_motion_fusion();
+void update_motion_fusion(VectorInt16 *accel, VectorInt16 *gyro);
+
+#endif // _SUPPORT_MOTION_FUSION_H_
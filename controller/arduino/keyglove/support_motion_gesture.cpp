@@ -0,0 +1,300 @@
+// Keyglove controller source code - Motion gesture recognition
+// 2014-12-14 by Jeff Rowberg <jeff@rowberg.net>
+
+
+/* ============================================
+Controller code is placed under the MIT license
+Copyright (c) 2014 Jeff Rowberg
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+/**
+ * @file support_motion_gesture.cpp
+ * @brief Motion gesture recognition
+ * @author Jeff Rowberg
+ * @date 2014-12-14
+ *
+ * This file recognizes simple hand gestures in the hand-mounted MPU-6050 data
+ * stream and reports each one with a short "motion_gesture" event, so a host
+ * that only cares about gestures does not need the full motion data stream.
+ *
+ * Each gesture is a small fixed-point state machine fed one sample at a time:
+ *
+ * - Rotations start when any filtered gyro axis passes 60 deg/s and end when
+ *   all of them fall below 30 deg/s. A short rotation with a high peak rate is
+ *   a flick (an immediate return stroke on the same axis is part of the same
+ *   flick), and a longer one through a large enough angle is a twist.
+ * - Raw acceleration minus a slow low-pass gravity estimate gives linear
+ *   acceleration. A brief spike with little rotation is a tap, and several
+ *   alternating strokes along one axis are a shake.
+ *
+ * Flicks, twists and taps are held until the hand has been quiet for a moment,
+ * so that the strokes of a shake are not also reported on their own. After
+ * any gesture, recognition pauses briefly so that the tail end of the motion
+ * is not mistaken for a new gesture.
+ *
+ * Normally it is not necessary to edit this file.
+ */
+
+#include "keyglove.h"
+#include "support_board.h"
+#include "support_protocol.h"
+#include "support_motion.h"
+//#include "support_motion_gesture.h"     // <-- included by support_motion.h
+
+uint8_t opt_motion_gesture_mask = (1 << KG_GESTURE_FLICK) | (1 << KG_GESTURE_SHAKE) | (1 << KG_GESTURE_TWIST) | (1 << KG_GESTURE_TAP);    ///< OPTION: Gestures to report (bit n set reports gesture n)
+
+int32_t gestureGravity[3];              ///< Low-pass raw acceleration (gravity estimate), scaled up by KG_GESTURE_LOWPASS_SHIFT
+uint8_t gestureInit;                    ///< Whether the gravity estimate has been seeded since the last reset
+uint8_t gestureRefractory;              ///< Samples left before recognition resumes
+
+uint8_t gestureRotating;                ///< Rotation in progress
+uint8_t gestureRotateSamples;           ///< Samples since rotation started
+uint8_t gestureRotateQuiet;             ///< Consecutive slow samples at the end of a rotation
+int32_t gestureRotateAngle[3];          ///< Summed gyro readings (rotation angle) per axis
+int16_t gestureRotatePeak[3];           ///< Fastest gyro reading (with sign) per axis
+
+uint8_t gestureTapSamples;              ///< Samples since a possible tap started (0 if none, 0xFF while a rejected spike dies down)
+uint16_t gestureTapPeak;                ///< Largest linear acceleration during a possible tap
+uint8_t gestureTapAxis;                 ///< Axis and direction of gestureTapPeak
+
+int8_t gestureShakeSign[3];             ///< Direction of the last shake stroke per axis
+uint8_t gestureShakeStrokes[3];         ///< Alternating strokes counted per axis
+uint8_t gestureShakeIdle[3];            ///< Samples since the last shake stroke per axis
+
+uint8_t gesturePending;                 ///< Gesture waiting for quiet before being reported (0 if none)
+uint8_t gesturePendingAxis;             ///< Axis and direction of pending gesture
+uint8_t gesturePendingStrength;         ///< Strength of pending gesture
+uint8_t gesturePendingStrokes;          ///< Rotations included in a pending flick (2 once it has returned)
+uint8_t gesturePendingWait;             ///< Quiet samples since the pending gesture was recognized
+
+/**
+ * @brief Abandon every gesture in progress
+ */
+void motion_gesture_clear() {
+    gestureRotating = 0;
+    gestureTapSamples = 0;
+    gesturePending = 0;
+    for (uint8_t i = 0; i < 3; i++) {
+        gestureShakeSign[i] = 0;
+        gestureShakeStrokes[i] = 0;
+        gestureShakeIdle[i] = 0;
+    }
+}
+
+/**
+ * @brief Start over completely, including the gravity estimate
+ */
+void motion_gesture_reset() {
+    motion_gesture_clear();
+    gestureInit = 0;
+    gestureRefractory = KG_GESTURE_REFRACTORY;  // let the gravity estimate settle
+}
+
+/**
+ * @brief Report a recognized gesture and pause recognition
+ * @param[in] gesture Type of gesture (KG_GESTURE_*)
+ * @param[in] axis Sensor axis, with KG_GESTURE_AXIS_NEGATIVE for negative direction
+ * @param[in] strength Gesture strength
+ * @see API event: kg_evt_motion_gesture()
+ */
+void motion_gesture_send(uint8_t gesture, uint8_t axis, uint8_t strength) {
+    motion_gesture_clear();
+    gestureRefractory = KG_GESTURE_REFRACTORY;
+    if (!(opt_motion_gesture_mask & (1 << gesture))) return;
+
+    // send kg_evt_motion_gesture packet
+    uint8_t payload[4] = { 0, gesture, axis, strength };
+    skipPacket = 0;
+    if (kg_evt_motion_gesture) skipPacket = kg_evt_motion_gesture(0, gesture, axis, strength);
+    if (!skipPacket) send_keyglove_packet(KG_PACKET_TYPE_EVENT, 4, KG_PACKET_CLASS_MOTION, KG_PACKET_ID_EVT_MOTION_GESTURE, payload);
+}
+
+/**
+ * @brief Hold a gesture until the hand has been quiet for KG_GESTURE_QUIET_SAMPLES
+ * @param[in] gesture Type of gesture (KG_GESTURE_*)
+ * @param[in] axis Sensor axis, with KG_GESTURE_AXIS_NEGATIVE for negative direction
+ * @param[in] strength Gesture strength
+ */
+void motion_gesture_pend(uint8_t gesture, uint8_t axis, uint8_t strength) {
+    gesturePending = gesture;
+    gesturePendingAxis = axis;
+    gesturePendingStrength = strength;
+    gesturePendingStrokes = 1;
+    gesturePendingWait = 0;
+}
+
+/**
+ * @brief Classify a finished rotation as a flick, a twist, or nothing
+ */
+void motion_gesture_rotation_done() {
+    uint8_t i, peakAxis = 0, angleAxis = 0;
+    for (i = 1; i < 3; i++) {
+        if (abs(gestureRotatePeak[i]) > abs(gestureRotatePeak[peakAxis])) peakAxis = i;
+        if (labs(gestureRotateAngle[i]) > labs(gestureRotateAngle[angleAxis])) angleAxis = i;
+    }
+
+    uint16_t peak = abs(gestureRotatePeak[peakAxis]);
+    if (gestureRotateSamples - gestureRotateQuiet <= KG_GESTURE_FLICK_SAMPLES && peak >= KG_GESTURE_FLICK_PEAK) {
+        uint8_t axis = peakAxis | (gestureRotatePeak[peakAxis] < 0 ? KG_GESTURE_AXIS_NEGATIVE : 0);
+        if (gesturePending == KG_GESTURE_FLICK && (gesturePendingAxis & 0x03) == peakAxis) {
+            if (gesturePendingStrokes == 1 && gesturePendingAxis != axis) {
+                // return stroke of the same flick, so keep the original direction
+                gesturePendingStrokes = 2;
+                gesturePendingWait = 0;
+            } else {
+                // back and forth more than once, which the shake detector deals with
+                gesturePending = 0;
+            }
+        } else {
+            motion_gesture_pend(KG_GESTURE_FLICK, axis, peak / 164 > 255 ? 255 : peak / 164);
+        }
+    } else {
+        int32_t degrees = labs(gestureRotateAngle[angleAxis]) / KG_GESTURE_DEGREE;
+        if (degrees >= KG_GESTURE_TWIST_ANGLE) {
+            motion_gesture_pend(KG_GESTURE_TWIST,
+                angleAxis | (gestureRotateAngle[angleAxis] < 0 ? KG_GESTURE_AXIS_NEGATIVE : 0),
+                degrees > 255 ? 255 : degrees);
+        }
+    }
+}
+
+/**
+ * @brief Initialize gesture recognition
+ */
+void setup_motion_gesture() {
+    motion_gesture_reset();
+}
+
+/**
+ * @brief Feed the latest motion sample to the gesture recognizers
+ *
+ * Call this once per sample, after motion_mpu6050_hand_next_sample().
+ */
+void update_motion_gesture() {
+    if (!opt_motion_gesture_mask) return;
+
+    int16_t accel[3] = { aaRaw.x, aaRaw.y, aaRaw.z };
+    int16_t gyro[3] = { gv.x, gv.y, gv.z };
+    int16_t linear[3];
+    uint16_t gyroMax = 0, linearMax = 0;
+    uint8_t linearAxis = 0, i;
+
+    if (!gestureInit) {
+        for (i = 0; i < 3; i++) gestureGravity[i] = (int32_t)accel[i] << KG_GESTURE_LOWPASS_SHIFT;
+        gestureInit = 1;
+    }
+
+    // remove slow-moving gravity from acceleration, and find strongest axes
+    for (i = 0; i < 3; i++) {
+        gestureGravity[i] += accel[i] - (gestureGravity[i] >> KG_GESTURE_LOWPASS_SHIFT);
+        int32_t l = accel[i] - (gestureGravity[i] >> KG_GESTURE_LOWPASS_SHIFT);
+        linear[i] = l > 32767 ? 32767 : (l < -32767 ? -32767 : l);
+        if ((uint16_t)abs(gyro[i]) > gyroMax) gyroMax = abs(gyro[i]);
+        if ((uint16_t)abs(linear[i]) > linearMax) {
+            linearMax = abs(linear[i]);
+            linearAxis = i;
+        }
+    }
+
+    if (gestureRefractory) {
+        gestureRefractory--;
+        return;
+    }
+
+    // ROTATION (flick/twist)
+    if (!gestureRotating && gyroMax >= KG_GESTURE_ROTATE_START) {
+        gestureRotating = 1;
+        gestureRotateSamples = gestureRotateQuiet = 0;
+        for (i = 0; i < 3; i++) {
+            gestureRotateAngle[i] = 0;
+            gestureRotatePeak[i] = 0;
+        }
+    }
+    if (gestureRotating) {
+        if (gestureRotateSamples < 255) gestureRotateSamples++;
+        for (i = 0; i < 3; i++) {
+            gestureRotateAngle[i] += gyro[i];
+            if (abs(gyro[i]) > abs(gestureRotatePeak[i])) gestureRotatePeak[i] = gyro[i];
+        }
+        if (gyroMax >= KG_GESTURE_ROTATE_END) {
+            gestureRotateQuiet = 0;
+        } else if (++gestureRotateQuiet >= KG_GESTURE_ROTATE_END_SAMPLES) {
+            gestureRotating = 0;
+            motion_gesture_rotation_done();
+        }
+    }
+
+    // TAP
+    if (gestureTapSamples == 0) {
+        if (linearMax >= KG_GESTURE_TAP_THRESHOLD && gyroMax < KG_GESTURE_TAP_GYRO) {
+            gestureTapSamples = 1;
+            gestureTapPeak = linearMax;
+            gestureTapAxis = linearAxis | (linear[linearAxis] < 0 ? KG_GESTURE_AXIS_NEGATIVE : 0);
+        }
+    } else if (gestureTapSamples == 0xFF) {
+        if (linearMax < KG_GESTURE_TAP_THRESHOLD / 2) gestureTapSamples = 0;
+    } else {
+        gestureTapSamples++;
+        if (linearMax > gestureTapPeak) {
+            gestureTapPeak = linearMax;
+            gestureTapAxis = linearAxis | (linear[linearAxis] < 0 ? KG_GESTURE_AXIS_NEGATIVE : 0);
+        }
+        if (gyroMax >= KG_GESTURE_TAP_GYRO || gestureTapSamples > KG_GESTURE_TAP_SAMPLES) {
+            // rotating or too slow, so not a tap
+            gestureTapSamples = 0xFF;
+        } else if (linearMax < KG_GESTURE_TAP_THRESHOLD / 2) {
+            gestureTapSamples = 0;
+            motion_gesture_pend(KG_GESTURE_TAP, gestureTapAxis, gestureTapPeak >> 10);
+        }
+    }
+
+    // SHAKE
+    uint8_t shaking = 0;
+    for (i = 0; i < 3; i++) {
+        int8_t sign = linear[i] > KG_GESTURE_SHAKE_THRESHOLD ? 1 : (linear[i] < -KG_GESTURE_SHAKE_THRESHOLD ? -1 : 0);
+        if (sign && sign != gestureShakeSign[i]) {
+            gestureShakeSign[i] = sign;
+            if (gestureShakeStrokes[i] < 255) gestureShakeStrokes[i]++;
+            gestureShakeIdle[i] = 0;
+        } else if (gestureShakeIdle[i] < 255) {
+            gestureShakeIdle[i]++;
+        }
+        if (gestureShakeIdle[i] > KG_GESTURE_SHAKE_GAP) {
+            if (gestureShakeStrokes[i] >= KG_GESTURE_SHAKE_STROKES) {
+                motion_gesture_send(KG_GESTURE_SHAKE, i, gestureShakeStrokes[i]);
+                return;
+            }
+            gestureShakeStrokes[i] = 0;
+            gestureShakeSign[i] = 0;
+        }
+        if (gestureShakeStrokes[i] >= 3) shaking = 1;
+    }
+
+    // report a held gesture once everything has calmed down
+    if (gesturePending) {
+        if (shaking || gestureRotating || (gestureTapSamples && gestureTapSamples != 0xFF)) {
+            gesturePendingWait = 0;
+        } else if (++gesturePendingWait >= KG_GESTURE_QUIET_SAMPLES) {
+            motion_gesture_send(gesturePending, gesturePendingAxis, gesturePendingStrength);
+        }
+    }
+}
@@ -0,0 +1,72 @@
+// Keyglove controller source code - Motion gesture recognition declarations
+// 2014-12-14 by Jeff Rowberg <jeff@rowberg.net>
+
+
+/* ============================================
+Controller code is placed under the MIT license
+Copyright (c) 2014 Jeff Rowberg
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+/**
+ * @file support_motion_gesture.h
+ * @brief Motion gesture recognition declarations
+ * @author Jeff Rowberg
+ * @date 2014-12-14
+ */
+
+#ifndef _SUPPORT_MOTION_GESTURE_H_
+#define _SUPPORT_MOTION_GESTURE_H_
+
+#define KG_GESTURE_FLICK                0x01    ///< Short, fast rotation (and optional return) about one axis
+#define KG_GESTURE_SHAKE                0x02    ///< Repeated back-and-forth movement along one axis
+#define KG_GESTURE_TWIST                0x03    ///< Slower, larger rotation about one axis
+#define KG_GESTURE_TAP                  0x04    ///< Brief acceleration spike with little rotation
+
+#define KG_GESTURE_AXIS_NEGATIVE        0x80    ///< Axis flag for movement in the negative direction
+
+// sample counts follow the hand sensor's configured rate (at most 500Hz, so they fit in 8 bits),
+// and gyro/accel LSB assume +/-2000 deg/s and +/-2g
+#define KG_GESTURE_RATE                 motionConfig[KG_MOTION_INDEX_MPU6050_HAND].rate     ///< Samples per second
+#define KG_GESTURE_LOWPASS_SHIFT        5       ///< Gravity low-pass time constant as a power of two in samples (320ms at 100Hz)
+#define KG_GESTURE_ROTATE_START         984     ///< Gyro rate (LSB, 60 deg/s) on any axis that starts a rotation
+#define KG_GESTURE_ROTATE_END           492     ///< Gyro rate (LSB, 30 deg/s) all axes must fall below to end a rotation
+#define KG_GESTURE_ROTATE_END_SAMPLES   3       ///< Consecutive slow samples that end a rotation
+#define KG_GESTURE_FLICK_PEAK           4920    ///< Smallest peak rate (LSB, 300 deg/s) counted as a flick
+#define KG_GESTURE_FLICK_SAMPLES        (KG_GESTURE_RATE / 4)       ///< Longest rotation counted as a flick (250ms)
+#define KG_GESTURE_TWIST_ANGLE          60      ///< Smallest rotation (degrees) counted as a twist
+#define KG_GESTURE_DEGREE               ((int32_t)KG_GESTURE_RATE * 164 / 10)    ///< Summed gyro LSB per degree of rotation
+#define KG_GESTURE_TAP_THRESHOLD        9830    ///< High-pass accel (LSB, 0.6g) that starts a tap
+#define KG_GESTURE_TAP_SAMPLES          (KG_GESTURE_RATE / 12)      ///< Longest spike counted as a tap (~80ms)
+#define KG_GESTURE_TAP_GYRO             1640    ///< Most rotation (LSB, 100 deg/s) allowed during a tap
+#define KG_GESTURE_SHAKE_THRESHOLD      6554    ///< High-pass accel (LSB, 0.4g) that counts as one shake stroke
+#define KG_GESTURE_SHAKE_STROKES        4       ///< Alternating strokes needed for a shake (two full cycles)
+#define KG_GESTURE_SHAKE_GAP            (KG_GESTURE_RATE * 3 / 10)  ///< Longest pause between strokes of one shake (300ms)
+#define KG_GESTURE_QUIET_SAMPLES        (KG_GESTURE_RATE / 5)       ///< Quiet time before a flick/twist/tap is reported (200ms)
+#define KG_GESTURE_REFRACTORY           (KG_GESTURE_RATE / 2)       ///< Dead time after any gesture (500ms)
+
+extern uint8_t opt_motion_gesture_mask;
+
+void motion_gesture_reset();
+void setup_motion_gesture();
+void update_motion_gesture();
+
+#endif // _SUPPORT_MOTION_GESTURE_H_
@@ -36,6 +36,11 @@ THE SOFTWARE.
  * raw sensor data is currently used from this chip; the DMP is not used for on-
  * module motion fusion.
  *
+ * When the hand has been idle for opt_motion_mpu6050_hand_sleep_delay seconds,
+ * the sensor is dropped into accelerometer-only low-power cycling with only
+ * the motion interrupt enabled, so an idle glove spends no I2C, CPU or radio
+ * time on motion data. Movement wakes it back up to the full sample rate.
+ *
  * Normally it is not necessary to edit this file.
  */
 
@@ -45,8 +50,23 @@ THE SOFTWARE.
 #include "support_motion.h"
 //#include "support_motion_mpu6050_hand.h"    // <-- included by "support_motion.h"
 
-MPU6050 mpuHand = MPU6050(0x68);        ///< MPU-6050 motion sensor I2Cdevlib object
-bool mpuHandInterrupt;                  ///< Interrupt flag for motion data availability
+volatile uint8_t mpuHandPending;        ///< Samples signaled by data-ready interrupts but not yet read from the FIFO
+uint32_t mpuHandSampleTime;             ///< Timestamp (microseconds) of most recent sample, derived from sample rate
+uint16_t mpuHandSamplePeriod;           ///< Sample period in microseconds at the configured rate
+
+uint8_t mpuHandBatch[KG_MPU6050_HAND_FIFO_BATCH * KG_MPU6050_HAND_SAMPLE_SIZE];   ///< Samples from last FIFO burst read
+uint8_t mpuHandBatchSize;               ///< Number of samples in mpuHandBatch
+uint8_t mpuHandBatchIndex;              ///< Next sample to process from mpuHandBatch
+bool mpuHandBusy;                       ///< FIFO count/data read sequence in progress on the I2C bus
+
+twi_transaction_t mpuHandCountRead;     ///< I2C transaction for reading FIFO byte count
+twi_transaction_t mpuHandBatchRead;     ///< I2C transaction for burst reading FIFO samples
+twi_transaction_t mpuHandResetWrite[2]; ///< I2C transactions for resetting and re-enabling FIFO
+uint8_t mpuHandCountData[2];            ///< FIFO byte count (big-endian)
+uint8_t mpuHandResetData[2] = { 0x04, 0x40 };   ///< USER_CTRL values: FIFO_RESET (only works with FIFO_EN=0), then FIFO_EN
+twi_transaction_t mpuHandConfigWrite;   ///< I2C transaction for writing rate, filter and range registers
+uint8_t mpuHandConfigData[4];           ///< SMPLRT_DIV, CONFIG, GYRO_CONFIG and ACCEL_CONFIG values for the current configuration
+bool mpuHandConfigPending;              ///< Configuration changed but not yet written to the sensor
 
 VectorInt16 aaRaw;                      ///< Raw linear acceleration
 VectorInt16 aa;                         ///< Filtered linear acceleration
@@ -55,12 +75,109 @@ VectorInt16 gvRaw;                      ///< Raw rotational velocity
 VectorInt16 gv;                         ///< Filtered rotational velocity
 VectorInt16 gv0;                        ///< Last-iteration filtered rotational velocity
 
+uint8_t opt_motion_mpu6050_hand_autocal = 1;    ///< OPTION: Trim gyro bias in the background whenever the hand rests
+
+int16_t mpuHandOffset[6];               ///< Offset register values (accel XYZ, gyro XYZ) currently in the sensor
+int16_t mpuHandOffsetSaved[6];          ///< Offset register values last stored in EEPROM
+uint8_t mpuHandOffsetData[12];          ///< Big-endian image of mpuHandOffset for register writes
+twi_transaction_t mpuHandOffsetWrite[2];    ///< I2C transactions for writing accel and gyro offset registers
+uint8_t mpuHandCalFlags;                ///< Offsets being calibrated on request (KG_MPU6050_HAND_CAL_*), 0 for background only
+uint8_t mpuHandCalStatus;               ///< Last calibration status reported
+uint8_t mpuHandCalProgress;             ///< Last calibration progress reported (percent)
+uint16_t mpuHandCalCount;               ///< Still samples collected in the current window
+uint16_t mpuHandCalElapsed;             ///< Samples since the requested calibration started
+uint8_t mpuHandCalSettle;               ///< Samples still to skip while new offsets take effect
+int32_t mpuHandCalSum[6];               ///< Sum of each axis over the current window
+int16_t mpuHandCalMin[6];               ///< Lowest reading of each axis in the current window
+int16_t mpuHandCalMax[6];               ///< Highest reading of each axis in the current window
+uint8_t mpuHandCalRecord[KG_MPU6050_HAND_CAL_RECORD_SIZE];   ///< Offset record waiting to be written to EEPROM
+uint8_t mpuHandCalWritePos;             ///< Next record byte to write to EEPROM (0xFF if none pending)
+
+uint8_t opt_motion_mpu6050_hand_sleep_delay = 10;   ///< OPTION: Seconds of idle time before dropping to low-power sleep (0 to never sleep)
+
+uint8_t mpuHandPowerState;              ///< Current power state, or the one being entered (KG_MPU6050_HAND_POWER_*)
+uint8_t mpuHandPowerTarget;             ///< Requested power state (KG_MPU6050_HAND_POWER_*)
+const uint8_t *mpuHandPowerStep;        ///< Next register/value pair of the running power sequence (0 if none)
+bool mpuHandPowerQueued;                ///< Power sequence write waiting on the I2C bus
+twi_transaction_t mpuHandPowerWrite;    ///< I2C transaction for power sequence register writes
+uint8_t mpuHandPowerData;               ///< Value being written by mpuHandPowerWrite
+uint32_t mpuHandIdleCount;              ///< Consecutive idle samples
+VectorInt16 mpuHandIdleAccel;           ///< Acceleration at the start of the current idle period
+
+/**
+ * @brief Register writes to enter low-power sleep (register, value pairs, ending with 0xFF)
+ *
+ * The gyro is stopped and the accelerometer cycles at KG_MPU6050_HAND_WAKE_RATE
+ * with the 5Hz high-pass filter feeding motion detection, which pulses INT once
+ * any axis moves by more than KG_MPU6050_HAND_WAKE_THRESHOLD.
+ */
+const uint8_t mpuHandSleepSequence[] PROGMEM = {
+    MPU6050_RA_INT_ENABLE,      0x00,   // no more data-ready pulses
+    MPU6050_RA_USER_CTRL,       0x00,   // FIFO off
+    MPU6050_RA_ACCEL_CONFIG,    0x01,   // 5Hz DHPF for motion detection
+    MPU6050_RA_MOT_THR,         KG_MPU6050_HAND_WAKE_THRESHOLD,
+    MPU6050_RA_MOT_DUR,         0x01,
+    MPU6050_RA_PWR_MGMT_2,      (KG_MPU6050_HAND_WAKE_RATE << 6) | 0x07,    // LP_WAKE_CTRL, gyro standby
+    MPU6050_RA_PWR_MGMT_1,      0x28,   // CYCLE, TEMP_DIS
+    MPU6050_RA_INT_ENABLE,      0x40,   // motion interrupt only
+    0xFF
+};
+
+/**
+ * @brief Register writes to power the sensor down completely while disabled
+ */
+const uint8_t mpuHandOffSequence[] PROGMEM = {
+    MPU6050_RA_INT_ENABLE,      0x00,
+    MPU6050_RA_USER_CTRL,       0x00,
+    MPU6050_RA_PWR_MGMT_1,      0x48,   // SLEEP, TEMP_DIS
+    0xFF
+};
+
+/**
+ * @brief Register writes to return to full-rate sampling from either sleep state
+ */
+const uint8_t mpuHandWakeSequence[] PROGMEM = {
+    MPU6050_RA_INT_ENABLE,      0x00,
+    MPU6050_RA_PWR_MGMT_1,      0x01,   // running, gyro X PLL clock
+    MPU6050_RA_PWR_MGMT_2,      0x00,   // all axes on (accel range is restored with the rest of the configuration)
+    MPU6050_RA_INT_ENABLE,      0x01,   // data ready
+    0xFF
+};
+
 /**
  * @brief Interrupt handler for INT pin from MPU-6050
- * @see mpuHandInterrupt
+ *
+ * The INT pin is configured as a non-latching 50us pulse, so nothing needs to
+ * be read to clear it. Each pulse is one new sample in the FIFO, and counting
+ * them here tells the main loop when the watermark is reached without polling
+ * the sensor over I2C.
+ *
+ * @see mpuHandPending
  */
 void motion_mpu6050_hand_interrupt() {
-    mpuHandInterrupt = true;
+    if (mpuHandPending < 255) mpuHandPending++;
+}
+
+/**
+ * @brief Empty the MPU-6050 FIFO and restart sample counting and timestamps
+ *
+ * Used when the sensor is enabled (the FIFO keeps filling while the interrupt
+ * is detached) and to resynchronize after an overflow, when the oldest data
+ * has been overwritten and sample boundaries are no longer known. The writes
+ * are queued, and the bus queue is strictly ordered, so any FIFO read queued
+ * afterwards sees the clean FIFO.
+ */
+void motion_mpu6050_hand_fifo_reset() {
+    uint8_t status = mpuHandResetWrite[1].status;
+    if (status == KG_TWI_STATUS_QUEUED || status == KG_TWI_STATUS_ACTIVE) return; // already on its way
+    twi_write(&mpuHandResetWrite[0], KG_MPU6050_HAND_ADDRESS, MPU6050_RA_USER_CTRL, mpuHandResetData, 1, 0);
+    twi_write(&mpuHandResetWrite[1], KG_MPU6050_HAND_ADDRESS, MPU6050_RA_USER_CTRL, mpuHandResetData + 1, 1, 0);
+    uint8_t sreg = SREG;
+    cli();
+    mpuHandPending = 0;
+    SREG = sreg;
+    mpuHandBatchSize = mpuHandBatchIndex = 0;
+    mpuHandSampleTime = micros();
 }
 
 /**
@@ -71,23 +188,69 @@ void motion_set_mpu6050_hand_mode(uint8_t mode) {
     if (mode) {
         aa.x = aa.y = aa.z = 0;
         gv.x = gv.y = gv.z = 0;
-        mpuHandInterrupt = true;
+        motion_mpu6050_hand_fifo_reset();
+        #if (KG_FUSION > 0)
+            // orientation is stale after any time with the sensor off
+            motion_fusion_reset();
+        #endif
+        motion_gesture_reset();
+        mpuHandIdleCount = 0;
+        mpuHandPowerTarget = KG_MPU6050_HAND_POWER_ACTIVE;
         attachInterrupt(KG_INTERRUPT_NUM_MPU6050_HAND, motion_mpu6050_hand_interrupt, FALLING);
-        //mpuHand.setSleepEnabled(false);
-        //I2Cdev::writeByte(0x68, MPU6050_RA_PWR_MGMT_1, 0x01);
     } else {
-        //mpuHand.setSleepEnabled(true);
-        //I2Cdev::writeByte(0x68, MPU6050_RA_PWR_MGMT_1, 0x41);
+        mpuHandPowerTarget = KG_MPU6050_HAND_POWER_OFF;
         detachInterrupt(KG_INTERRUPT_NUM_MPU6050_HAND);
+        mpuHandBatchSize = mpuHandBatchIndex = 0;
+        if (mpuHandCalFlags) motion_mpu6050_hand_cal_finish(KG_MPU6050_HAND_CAL_STATUS_CANCELLED);
     }
 }
 
+/**
+ * @brief Check and store a new rate, range and filter configuration
+ * @param[in] config New configuration
+ * @return Zero on success, non-zero if the configuration is not supported
+ *
+ * Rates are 1kHz divided by an integer, from KG_MPU6050_HAND_RATE_MIN to
+ * KG_MPU6050_HAND_RATE_MAX. Filter settings are DLPF_CFG values 1 (188Hz) to
+ * 6 (5Hz), since 0 and 7 switch the gyro to 8kHz internal sampling. The new
+ * registers are written from update_motion_mpu6050_hand() once no batch is in
+ * progress, since samples already in the FIFO use the old settings.
+ */
+uint8_t motion_mpu6050_hand_configure(motion_config_t *config) {
+    if (config -> rate < KG_MPU6050_HAND_RATE_MIN || config -> rate > KG_MPU6050_HAND_RATE_MAX || 1000 % config -> rate) return 1;
+    if (config -> accel_range > 3 || config -> gyro_range > 3 || config -> filter < 1 || config -> filter > 6) return 1;
+    mpuHandConfigData[0] = (1000 / config -> rate) - 1;     // 1kHz/(n+1)
+    mpuHandConfigData[1] = config -> filter;
+    mpuHandConfigData[2] = config -> gyro_range << 3;
+    mpuHandConfigData[3] = config -> accel_range << 3;
+    mpuHandSamplePeriod = 1000000UL / config -> rate;
+    mpuHandConfigPending = true;
+
+    // orientation and gesture timing both depend on the rate
+    #if (KG_FUSION > 0)
+        motion_fusion_reset();
+    #endif
+    motion_gesture_reset();
+    return 0;
+}
+
+/**
+ * @brief Queue the configuration registers write and restart the FIFO
+ */
+void motion_mpu6050_hand_config_apply() {
+    // SMPLRT_DIV, CONFIG, GYRO_CONFIG and ACCEL_CONFIG are consecutive registers
+    if (twi_write(&mpuHandConfigWrite, KG_MPU6050_HAND_ADDRESS, MPU6050_RA_SMPLRT_DIV, mpuHandConfigData, 4, 0)) return;
+    mpuHandConfigPending = false;
+    motion_mpu6050_hand_fifo_reset();
+}
+
 /**
  * @brief Initialize MPU-6050 communications and interrupt handler
  *
- * This function sets the MPU-6050 to 100Hz output, 2000 deg/sec resolution for
- * the gyroscope, and enables a latching active-low interrupt on DRDY (raw data
- * ready), MOT (motion detected), and ZMOT (zero motion detected).
+ * This function sets the MPU-6050 to the rate, range and filter stored by
+ * motion_mpu6050_hand_configure() (which must be called first), routes accel
+ * and gyro samples into the FIFO, and enables a non-latching active-low
+ * interrupt pulse on DRDY (raw data ready).
  */
 void setup_motion_mpu6050_hand() {
     // set INT4 pin (Arduino Pin 36) to INPUT/HIGH so MPU can drive interrupt pin as active-low
@@ -95,10 +258,12 @@ void setup_motion_mpu6050_hand() {
     digitalWrite(KG_INTERRUPT_PIN_MPU6050_HAND, HIGH);
 
     // setup MPU-6050
-    mpuHandInterrupt = false;
+    mpuHandPending = 0;
+    mpuHandBatchSize = mpuHandBatchIndex = 0;
+    mpuHandBusy = false;
 
     /*
-    // initialization with friendly function names
+    // initialization with friendly I2Cdevlib function names (for reference, library no longer used)
     mpuHand.initialize();
     delay(30);
     mpuHand.setFullScaleGyroRange(MPU6050_GYRO_FS_2000);
@@ -116,79 +281,542 @@ void setup_motion_mpu6050_hand() {
     */
 
     // initialization with manual register writes (faster than above, fewer transactions)
-    // NOTE: InvenSense docs state Mot/ZMot interrupts no longer supported (?!)
-    //I2Cdev::writeByte(0x68, MPU6050_RA_MOT_THR, 0x14);
-    //I2Cdev::writeByte(0x68, MPU6050_RA_MOT_DUR, 0x32);
-    //I2Cdev::writeByte(0x68, MPU6050_RA_ZRMOT_THR, 0x14);
-    //I2Cdev::writeByte(0x68, MPU6050_RA_ZRMOT_DUR, 0x2D);
-    I2Cdev::writeByte(0x68, MPU6050_RA_INT_PIN_CFG, 0xD0);
-    //I2Cdev::writeByte(0x68, MPU6050_RA_INT_ENABLE, 0x61);
-    I2Cdev::writeByte(0x68, MPU6050_RA_INT_ENABLE, 0x01);
-    I2Cdev::writeByte(0x68, MPU6050_RA_ACCEL_CONFIG, 0x00);
-    I2Cdev::writeByte(0x68, MPU6050_RA_GYRO_CONFIG, 0x18);
-    I2Cdev::writeByte(0x68, MPU6050_RA_CONFIG, 0x03);
-    I2Cdev::writeByte(0x68, MPU6050_RA_SMPLRT_DIV, 0x09);
-    I2Cdev::writeByte(0x68, MPU6050_RA_PWR_MGMT_1, 0x01);
+    // NOTE: zero-motion detection is not available on the MPU-6050 in practice, so
+    // idle time is measured here instead, and the motion interrupt is only enabled
+    // while asleep (see mpuHandSleepSequence)
+    twi_write_byte_sync(KG_MPU6050_HAND_ADDRESS, MPU6050_RA_INT_PIN_CFG, 0xD0);
+    twi_write_byte_sync(KG_MPU6050_HAND_ADDRESS, MPU6050_RA_INT_ENABLE, 0x01);
+    twi_write_byte_sync(KG_MPU6050_HAND_ADDRESS, MPU6050_RA_ACCEL_CONFIG, mpuHandConfigData[3]);
+    twi_write_byte_sync(KG_MPU6050_HAND_ADDRESS, MPU6050_RA_GYRO_CONFIG, mpuHandConfigData[2]);
+    twi_write_byte_sync(KG_MPU6050_HAND_ADDRESS, MPU6050_RA_CONFIG, mpuHandConfigData[1]);
+    twi_write_byte_sync(KG_MPU6050_HAND_ADDRESS, MPU6050_RA_SMPLRT_DIV, mpuHandConfigData[0]);
+    mpuHandConfigPending = false;
+    twi_write_byte_sync(KG_MPU6050_HAND_ADDRESS, MPU6050_RA_FIFO_EN, 0x78);     // XG, YG, ZG, ACCEL into FIFO (12 bytes/sample)
+    twi_write_byte_sync(KG_MPU6050_HAND_ADDRESS, MPU6050_RA_PWR_MGMT_1, 0x01);
+
+    // restore stored offset calibration, if there is any
+    mpuHandCalFlags = 0;
+    mpuHandCalCount = 0;
+    mpuHandCalSettle = 0;
+    mpuHandCalWritePos = 0xFF;
+    motion_mpu6050_hand_cal_load();
+
+    // sensor is running now, but stays powered down until enabled
+    mpuHandPowerState = KG_MPU6050_HAND_POWER_ACTIVE;
+    mpuHandPowerTarget = KG_MPU6050_HAND_POWER_OFF;
+    mpuHandPowerStep = 0;
+    mpuHandPowerQueued = false;
+    mpuHandIdleCount = 0;
 
     // test motion sensor
     //motion_set_mpu6050_hand_mode(1); // enable motion detection
 }
 
 /**
- * @brief Update motion data from MPU-6050
+ * @brief Start reading a batch of motion samples from the MPU-6050 FIFO
  *
- * This function is called whenever the motion interrupt occurs and the flag is
- * set by the interrupt handler, and then detected as such from inside the main
- * loop() function. All six axes of raw data are read, then filtered and stored.
+ * This function is called from the main loop, but only queues any I2C work
+ * once the interrupt handler has counted KG_MPU6050_HAND_FIFO_WATERMARK new
+ * samples and the previous batch has been fully processed. The FIFO byte
+ * count is read first, then motion_mpu6050_hand_count_done() pulls every
+ * complete sample (up to KG_MPU6050_HAND_FIFO_BATCH) in a single burst. Both
+ * reads run in the background, so a late loop() costs latency instead of
+ * lost samples, and loop() never waits on the bus.
  *
- * @see API event: kg_evt_motion_data()
+ * Power state and configuration changes are also started here, once any batch
+ * in progress has been read and processed. While asleep, any motion interrupt pulse wakes the
+ * sensor again.
+ *
+ * @see motion_mpu6050_hand_next_sample()
  */
 void update_motion_mpu6050_hand() {
-    uint8_t mpuInt = mpuHand.getIntStatus();
-    if (mpuInt & 0x01) {
-        // read raw motion data
-        mpuHand.getMotion6(&aaRaw.x, &aaRaw.y, &aaRaw.z, &gvRaw.x, &gvRaw.y, &gvRaw.z);
-
-        // store previous accel/gyro values
-        aa0.x = aa.x;
-        aa0.y = aa.y;
-        aa0.z = aa.z;
-        gv0.x = gv.x;
-        gv0.y = gv.y;
-        gv0.z = gv.z;
-
-        // simple smoothing filter
-        aa.x = aa0.x + (0.25 * (aaRaw.x - aa0.x));
-        aa.y = aa0.y + (0.25 * (aaRaw.y - aa0.y));
-        aa.z = aa0.z + (0.25 * (aaRaw.z - aa0.z));
-        gv.x = gv0.x + (0.25 * (gvRaw.x - gv0.x));
-        gv.y = gv0.y + (0.25 * (gvRaw.y - gv0.y));
-        gv.z = gv0.z + (0.25 * (gvRaw.z - gv0.z));
-
-        // build and send kg_evt_motion_data packet
-        uint8_t payload[15];
-        payload[0] = 0x00;  // sensor 0
-        payload[1] = 0x03;  // 1=accel, 2=gyro, 1|2 = 0x03
-        payload[2] = 0x0C;  // 12 bytes of motion data (6 axes, 2 bytes each)
-        payload[3] = aa.x & 0xFF;
-        payload[4] = aa.x >> 8;
-        payload[5] = aa.y & 0xFF;
-        payload[6] = aa.y >> 8;
-        payload[7] = aa.z & 0xFF;
-        payload[8] = aa.z >> 8;
-        payload[9] = gv.x & 0xFF;
-        payload[10] = gv.x >> 8;
-        payload[11] = gv.y & 0xFF;
-        payload[12] = gv.y >> 8;
-        payload[13] = gv.z & 0xFF;
-        payload[14] = gv.z >> 8;
-        skipPacket = 0;
-        if (kg_evt_motion_data) skipPacket = kg_evt_motion_data(payload[0], payload[1], payload[2], payload + 3);
-        if (!skipPacket) send_keyglove_packet(KG_PACKET_TYPE_EVENT, sizeof(payload), KG_PACKET_CLASS_MOTION, KG_PACKET_ID_EVT_MOTION_DATA, payload);
-    }
-    if (mpuInt & 0x20) {
-        send_keyglove_log(KG_LOG_LEVEL_VERBOSE, 10, F("MOTION INT"));
-    } else if (mpuInt & 0x40) {
-        send_keyglove_log(KG_LOG_LEVEL_VERBOSE, 10, F("ZEROMO INT"));
+    motion_mpu6050_hand_cal_write_step();
+    if (mpuHandPowerStep) {
+        // power sequence running, retry its write if the queue was full
+        if (!mpuHandPowerQueued) motion_mpu6050_hand_power_next(0);
+        return;
+    }
+    if (mpuHandPowerState == KG_MPU6050_HAND_POWER_SLEEP && mpuHandPending) mpuHandPowerTarget = KG_MPU6050_HAND_POWER_ACTIVE;
+    if (mpuHandPowerTarget != mpuHandPowerState) {
+        if (!mpuHandBusy && mpuHandBatchIndex >= mpuHandBatchSize) motion_mpu6050_hand_power_start(mpuHandPowerTarget);
+        return;
+    }
+    if (mpuHandPowerState != KG_MPU6050_HAND_POWER_ACTIVE) return;
+    if (mpuHandConfigPending && !mpuHandBusy && mpuHandBatchIndex >= mpuHandBatchSize) motion_mpu6050_hand_config_apply();
+    if (mpuHandBusy || mpuHandPending < KG_MPU6050_HAND_FIFO_WATERMARK || mpuHandBatchIndex < mpuHandBatchSize) return;
+    if (twi_read(&mpuHandCountRead, KG_MPU6050_HAND_ADDRESS, MPU6050_RA_FIFO_COUNTH, mpuHandCountData, 2, motion_mpu6050_hand_count_done) == 0) {
+        mpuHandBusy = true;
+    }
+}
+
+/**
+ * @brief Handle FIFO byte count and start burst read, called from update_twi()
+ * @param[in] transaction Completed FIFO count read
+ */
+void motion_mpu6050_hand_count_done(twi_transaction_t *transaction) {
+    if (transaction->status != KG_TWI_STATUS_OK) {
+        mpuHandBusy = false; // try again on the next pass
+        return;
+    }
+
+    uint16_t count = (mpuHandCountData[0] << 8) | mpuHandCountData[1];
+    if (count > KG_MPU6050_HAND_FIFO_SIZE - KG_MPU6050_HAND_SAMPLE_SIZE || count % KG_MPU6050_HAND_SAMPLE_SIZE) {
+        // FIFO overflowed (or lost sample alignment), so throw it all away and start clean
+        mpuHandBusy = false;
+        motion_mpu6050_hand_fifo_reset();
+        keyglove_log(KG_LOG_LEVEL_WARNING, KG_LOG_MOTION_MPU6050_HAND_FIFO_OVERFLOW, count);
+        return;
+    }
+
+    uint8_t samples = count / KG_MPU6050_HAND_SAMPLE_SIZE;
+    if (samples > KG_MPU6050_HAND_FIFO_BATCH) samples = KG_MPU6050_HAND_FIFO_BATCH;
+    if (samples == 0 || twi_read(&mpuHandBatchRead, KG_MPU6050_HAND_ADDRESS, MPU6050_RA_FIFO_R_W, mpuHandBatch, samples * KG_MPU6050_HAND_SAMPLE_SIZE, motion_mpu6050_hand_batch_done)) {
+        mpuHandBusy = false;
+    }
+}
+
+/**
+ * @brief Make a completed burst read available for processing, called from update_twi()
+ * @param[in] transaction Completed FIFO data read
+ */
+void motion_mpu6050_hand_batch_done(twi_transaction_t *transaction) {
+    mpuHandBusy = false;
+    if (transaction->status != KG_TWI_STATUS_OK) {
+        // part of a sample may have been pulled out, so the FIFO is no longer aligned
+        motion_mpu6050_hand_fifo_reset();
+        return;
+    }
+
+    uint8_t samples = transaction->length / KG_MPU6050_HAND_SAMPLE_SIZE;
+    mpuHandBatchSize = samples;
+    mpuHandBatchIndex = 0;
+
+    // a missed interrupt could leave the counter short of what was really read
+    uint8_t sreg = SREG;
+    cli();
+    mpuHandPending = mpuHandPending > samples ? mpuHandPending - samples : 0;
+    SREG = sreg;
+}
+
+/**
+ * @brief Convert an accel reading to +/-2g units, saturating at the int16_t limits
+ * @param[in] value Reading in the configured range
+ * @param[in] range Configured range (0=2g to 3=16g)
+ * @return Reading in +/-2g units
+ */
+int16_t motion_mpu6050_hand_accel_units(int16_t value, uint8_t range) {
+    int32_t scaled = (int32_t)value * (1 << range);
+    if (scaled > 32767) return 32767;
+    if (scaled < -32768) return -32768;
+    return scaled;
+}
+
+/**
+ * @brief Process the next buffered motion sample from MPU-6050
+ * @return Non-zero if a sample was processed, zero if the buffered batch is empty
+ *
+ * Each call unpacks one sample read by update_motion_mpu6050_hand(), gives it
+ * a timestamp one sample period after the previous one, filters it into aa/gv,
+ * and sends it out. Call this until it returns zero so that every consumer of
+ * aa/gv sees every sample.
+ *
+ * Whatever range is configured, aaRaw/gvRaw are converted to +/-2g and +/-2000
+ * deg/s units, which calibration, fusion, gestures and the mouse all assume.
+ * Only the raw stream encoding sends readings in the configured range.
+ *
+ * @see API event: kg_evt_motion_data()
+ */
+uint8_t motion_mpu6050_hand_next_sample() {
+    if (mpuHandBatchIndex >= mpuHandBatchSize) return 0;
+    uint8_t *sample = mpuHandBatch + (mpuHandBatchIndex++ * KG_MPU6050_HAND_SAMPLE_SIZE);
+    mpuHandSampleTime += mpuHandSamplePeriod;
+
+    // unpack raw motion data (big-endian, accel then gyro)
+    motion_config_t *config = &motionConfig[KG_MOTION_INDEX_MPU6050_HAND];
+    VectorInt16 aaSensor((sample[0] << 8) | sample[1], (sample[2] << 8) | sample[3], (sample[4] << 8) | sample[5]);
+    VectorInt16 gvSensor((sample[6] << 8) | sample[7], (sample[8] << 8) | sample[9], (sample[10] << 8) | sample[11]);
+    aaRaw.x = motion_mpu6050_hand_accel_units(aaSensor.x, config -> accel_range);
+    aaRaw.y = motion_mpu6050_hand_accel_units(aaSensor.y, config -> accel_range);
+    aaRaw.z = motion_mpu6050_hand_accel_units(aaSensor.z, config -> accel_range);
+    gvRaw.x = gvSensor.x >> (3 - config -> gyro_range);
+    gvRaw.y = gvSensor.y >> (3 - config -> gyro_range);
+    gvRaw.z = gvSensor.z >> (3 - config -> gyro_range);
+
+    // look for a still window to calibrate from (offsets apply in the sensor itself, not here)
+    motion_mpu6050_hand_cal_sample();
+
+    // count idle time towards sleep
+    motion_mpu6050_hand_idle_sample();
+
+    // store previous accel/gyro values
+    aa0.x = aa.x;
+    aa0.y = aa.y;
+    aa0.z = aa.z;
+    gv0.x = gv.x;
+    gv0.y = gv.y;
+    gv0.z = gv.z;
+
+    // simple smoothing filter
+    aa.x = aa0.x + (0.25 * (aaRaw.x - aa0.x));
+    aa.y = aa0.y + (0.25 * (aaRaw.y - aa0.y));
+    aa.z = aa0.z + (0.25 * (aaRaw.z - aa0.z));
+    gv.x = gv0.x + (0.25 * (gvRaw.x - gv0.x));
+    gv.y = gv0.y + (0.25 * (gvRaw.y - gv0.y));
+    gv.z = gv0.z + (0.25 * (gvRaw.z - gv0.z));
+
+    // send kg_evt_motion_data packet (if due)
+    if (config -> encoding & KG_MOTION_ENCODING_RAW) {
+        motion_stream_sample(KG_MOTION_INDEX_MPU6050_HAND, &aaSensor, &gvSensor);
+    } else {
+        motion_stream_sample(KG_MOTION_INDEX_MPU6050_HAND, &aa, &gv);
+    }
+    return 1;
+}
+
+/* ================ */
+/* POWER MANAGEMENT */
+/* ================ */
+
+/**
+ * @brief Start the register sequence for a new power state
+ * @param[in] state Power state to enter (KG_MPU6050_HAND_POWER_*)
+ * @see motion_mpu6050_hand_power_next()
+ */
+void motion_mpu6050_hand_power_start(uint8_t state) {
+    mpuHandPowerState = state;
+    if (state == KG_MPU6050_HAND_POWER_ACTIVE) mpuHandPowerStep = mpuHandWakeSequence;
+    else if (state == KG_MPU6050_HAND_POWER_SLEEP) mpuHandPowerStep = mpuHandSleepSequence;
+    else mpuHandPowerStep = mpuHandOffSequence;
+    mpuHandPowerQueued = false;
+    motion_mpu6050_hand_power_next(0);
+}
+
+/**
+ * @brief Finish entering a new power state and report it
+ *
+ * The gyro needs about 30ms to start up after waking, so the first batch is
+ * kept out of background calibration, and orientation and gesture tracking
+ * start over since the hand has moved an unknown amount while asleep.
+ *
+ * @see API event: kg_evt_motion_state()
+ */
+void motion_mpu6050_hand_power_done() {
+    if (mpuHandPowerState == KG_MPU6050_HAND_POWER_ACTIVE) {
+        // restores accel range and restarts the FIFO
+        mpuHandConfigPending = true;
+        mpuHandCalSettle = KG_MPU6050_HAND_FIFO_BATCH;
+        mpuHandIdleCount = 0;
+        #if (KG_FUSION > 0)
+            motion_fusion_reset();
+        #endif
+        motion_gesture_reset();
+    } else {
+        // drop data-ready pulses counted before the FIFO was stopped
+        uint8_t sreg = SREG;
+        cli();
+        mpuHandPending = 0;
+        SREG = sreg;
+    }
+
+    // powering down is already reported by kg_evt_motion_mode
+    if (mpuHandPowerState == KG_MPU6050_HAND_POWER_OFF) return;
+    uint8_t payload[2] = { 0, mpuHandPowerState };
+    skipPacket = 0;
+    if (kg_evt_motion_state) skipPacket = kg_evt_motion_state(0, mpuHandPowerState);
+    if (!skipPacket) send_keyglove_packet(KG_PACKET_TYPE_EVENT, 2, KG_PACKET_CLASS_MOTION, KG_PACKET_ID_EVT_MOTION_STATE, payload);
+}
+
+/**
+ * @brief Queue the next power sequence write, called from update_twi() as each one completes
+ * @param[in] transaction Completed register write, or 0 to (re)queue the current one
+ *
+ * Each write is chained from the completion of the last, so a whole sequence
+ * goes out back to back without waiting on loop(). A failed write is retried
+ * from update_motion_mpu6050_hand() instead of skipped.
+ */
+void motion_mpu6050_hand_power_next(twi_transaction_t *transaction) {
+    if (transaction) {
+        mpuHandPowerQueued = false;
+        if (transaction->status != KG_TWI_STATUS_OK) return;
+        mpuHandPowerStep += 2;
+    }
+    uint8_t reg = pgm_read_byte(mpuHandPowerStep);
+    if (reg == 0xFF) {
+        mpuHandPowerStep = 0;
+        motion_mpu6050_hand_power_done();
+        return;
+    }
+    mpuHandPowerData = pgm_read_byte(mpuHandPowerStep + 1);
+    mpuHandPowerQueued = twi_write(&mpuHandPowerWrite, KG_MPU6050_HAND_ADDRESS, reg, &mpuHandPowerData, 1, motion_mpu6050_hand_power_next) == 0;
+}
+
+/**
+ * @brief Feed the latest raw sample to idle detection
+ *
+ * The hand is idle while no gyro axis reads more than KG_MPU6050_HAND_IDLE_GYRO
+ * and acceleration stays within KG_MPU6050_HAND_IDLE_ACCEL of where the idle
+ * period started, so a slow drift still counts as movement. Calibration needs
+ * still samples, so sleep waits until any requested calibration is over.
+ */
+void motion_mpu6050_hand_idle_sample() {
+    if (!opt_motion_mpu6050_hand_sleep_delay || mpuHandCalFlags) {
+        mpuHandIdleCount = 0;
+        return;
+    }
+    if (mpuHandIdleCount == 0) {
+        mpuHandIdleAccel.x = aaRaw.x;
+        mpuHandIdleAccel.y = aaRaw.y;
+        mpuHandIdleAccel.z = aaRaw.z;
+    }
+    if (abs(gvRaw.x) > KG_MPU6050_HAND_IDLE_GYRO || abs(gvRaw.y) > KG_MPU6050_HAND_IDLE_GYRO || abs(gvRaw.z) > KG_MPU6050_HAND_IDLE_GYRO
+        || abs(aaRaw.x - mpuHandIdleAccel.x) > KG_MPU6050_HAND_IDLE_ACCEL
+        || abs(aaRaw.y - mpuHandIdleAccel.y) > KG_MPU6050_HAND_IDLE_ACCEL
+        || abs(aaRaw.z - mpuHandIdleAccel.z) > KG_MPU6050_HAND_IDLE_ACCEL) {
+        mpuHandIdleCount = 0;
+        return;
+    }
+    if (++mpuHandIdleCount >= (uint32_t)opt_motion_mpu6050_hand_sleep_delay * motionConfig[KG_MOTION_INDEX_MPU6050_HAND].rate) {
+        mpuHandIdleCount = 0;
+        mpuHandPowerTarget = KG_MPU6050_HAND_POWER_SLEEP;
+    }
+}
+
+/* ================== */
+/* OFFSET CALIBRATION */
+/* ================== */
+
+/**
+ * @brief Send a kg_evt_motion_calibration packet if status or progress decile changed
+ * @param[in] status Calibration status (KG_MPU6050_HAND_CAL_STATUS_*)
+ * @param[in] progress Percentage of still samples collected
+ */
+void motion_mpu6050_hand_cal_report(uint8_t status, uint8_t progress) {
+    if (status == mpuHandCalStatus && progress / 10 == mpuHandCalProgress / 10) return;
+    mpuHandCalStatus = status;
+    mpuHandCalProgress = progress;
+    uint8_t payload[3] = { 0, status, progress };
+    skipPacket = 0;
+    if (kg_evt_motion_calibration) skipPacket = kg_evt_motion_calibration(0, status, progress);
+    if (!skipPacket) send_keyglove_packet(KG_PACKET_TYPE_EVENT, 3, KG_PACKET_CLASS_MOTION, KG_PACKET_ID_EVT_MOTION_CALIBRATION, payload);
+}
+
+/**
+ * @brief End a requested calibration and fall back to background gyro trimming
+ * @param[in] status Final calibration status (KG_MPU6050_HAND_CAL_STATUS_*)
+ */
+void motion_mpu6050_hand_cal_finish(uint8_t status) {
+    mpuHandCalFlags = 0;
+    mpuHandCalCount = 0;
+    motion_mpu6050_hand_cal_report(status, status == KG_MPU6050_HAND_CAL_STATUS_COMPLETE ? 100 : mpuHandCalProgress);
+}
+
+/**
+ * @brief Fill the big-endian register image from mpuHandOffset
+ */
+void motion_mpu6050_hand_cal_pack() {
+    for (uint8_t i = 0; i < 6; i++) {
+        mpuHandOffsetData[i * 2] = mpuHandOffset[i] >> 8;
+        mpuHandOffsetData[i * 2 + 1] = mpuHandOffset[i] & 0xFF;
+    }
+}
+
+/**
+ * @brief Queue writes of mpuHandOffset into the sensor's offset registers
+ *
+ * Once written, the sensor subtracts the offsets from every sample before it
+ * reaches the FIFO, so calibration costs nothing per sample on this side.
+ */
+void motion_mpu6050_hand_cal_apply() {
+    motion_mpu6050_hand_cal_pack();
+    twi_write(&mpuHandOffsetWrite[0], KG_MPU6050_HAND_ADDRESS, MPU6050_RA_XA_OFFS_H, mpuHandOffsetData, 6, 0);
+    twi_write(&mpuHandOffsetWrite[1], KG_MPU6050_HAND_ADDRESS, MPU6050_RA_XG_OFFS_USRH, mpuHandOffsetData + 6, 6, 0);
+
+    // samples already in the FIFO were taken with the old offsets
+    mpuHandCalSettle = KG_MPU6050_HAND_FIFO_BATCH;
+}
+
+/**
+ * @brief Start storing mpuHandOffset in EEPROM in the background
+ * @see motion_mpu6050_hand_cal_write_step()
+ */
+void motion_mpu6050_hand_cal_save() {
+    motion_mpu6050_hand_cal_pack();
+    uint8_t checksum = 0;
+    for (uint8_t i = 0; i < 12; i++) {
+        mpuHandCalRecord[i + 1] = mpuHandOffsetData[i];
+        checksum += mpuHandOffsetData[i];
+    }
+    mpuHandCalRecord[0] = KG_MPU6050_HAND_CAL_MAGIC;
+    mpuHandCalRecord[13] = ~checksum;
+    memcpy(mpuHandOffsetSaved, mpuHandOffset, sizeof(mpuHandOffset));
+    mpuHandCalWritePos = 1;
+}
+
+/**
+ * @brief Store the next byte of a pending EEPROM offset record write
+ *
+ * Like macro slot writes, only one byte is programmed per call and only once
+ * the previous one has finished. The magic byte is written last, so a record
+ * cut short by a reset fails the checksum instead of loading bad offsets.
+ */
+void motion_mpu6050_hand_cal_write_step() {
+    if (mpuHandCalWritePos == 0xFF || !eeprom_is_ready()) return;
+    uint8_t pos = mpuHandCalWritePos < KG_MPU6050_HAND_CAL_RECORD_SIZE ? mpuHandCalWritePos : 0;
+    uint8_t *address = (uint8_t *)(KG_MPU6050_HAND_CAL_EEPROM_BASE + pos);
+    if (eeprom_read_byte(address) != mpuHandCalRecord[pos]) eeprom_write_byte(address, mpuHandCalRecord[pos]);
+    if (pos == 0) mpuHandCalWritePos = 0xFF; // magic byte written last, all done
+    else mpuHandCalWritePos++;
+}
+
+/**
+ * @brief Read current offset registers and replace them with any stored in EEPROM
+ *
+ * The accel offset registers hold factory trim values, so they are read back
+ * first and calibration only ever adjusts them. Called during setup, so
+ * blocking bus transactions are fine here.
+ */
+void motion_mpu6050_hand_cal_load() {
+    uint8_t data[6];
+    twi_read_bytes_sync(KG_MPU6050_HAND_ADDRESS, MPU6050_RA_XA_OFFS_H, data, 6);
+    for (uint8_t i = 0; i < 3; i++) mpuHandOffset[i] = (data[i * 2] << 8) | data[i * 2 + 1];
+    twi_read_bytes_sync(KG_MPU6050_HAND_ADDRESS, MPU6050_RA_XG_OFFS_USRH, data, 6);
+    for (uint8_t i = 0; i < 3; i++) mpuHandOffset[i + 3] = (data[i * 2] << 8) | data[i * 2 + 1];
+
+    eeprom_read_block(mpuHandCalRecord, (const void *)KG_MPU6050_HAND_CAL_EEPROM_BASE, KG_MPU6050_HAND_CAL_RECORD_SIZE);
+    uint8_t checksum = 0;
+    for (uint8_t i = 1; i < 13; i++) checksum += mpuHandCalRecord[i];
+    if (mpuHandCalRecord[0] == KG_MPU6050_HAND_CAL_MAGIC && mpuHandCalRecord[13] == (uint8_t)~checksum) {
+        for (uint8_t i = 0; i < 6; i++) mpuHandOffset[i] = (mpuHandCalRecord[i * 2 + 1] << 8) | mpuHandCalRecord[i * 2 + 2];
+        motion_mpu6050_hand_cal_apply();
+        twi_wait(&mpuHandOffsetWrite[0]);
+        twi_wait(&mpuHandOffsetWrite[1]);
+    }
+    memcpy(mpuHandOffsetSaved, mpuHandOffset, sizeof(mpuHandOffset));
+}
+
+/**
+ * @brief Start calibrating offsets on request
+ * @param[in] flags Offsets to calibrate (KG_MPU6050_HAND_CAL_*), or zero to cancel
+ * @return Zero on success, non-zero for invalid flags
+ */
+uint8_t motion_mpu6050_hand_cal_start(uint8_t flags) {
+    if (flags & ~(KG_MPU6050_HAND_CAL_GYRO | KG_MPU6050_HAND_CAL_ACCEL)) return 1;
+    if (flags == 0) {
+        if (mpuHandCalFlags) motion_mpu6050_hand_cal_finish(KG_MPU6050_HAND_CAL_STATUS_CANCELLED);
+        return 0;
+    }
+    mpuHandCalFlags = flags;
+    mpuHandCalCount = 0;
+    mpuHandCalElapsed = 0;
+    mpuHandCalStatus = 0;
+    motion_mpu6050_hand_cal_report(KG_MPU6050_HAND_CAL_STATUS_WAITING, 0);
+    return 0;
+}
+
+/**
+ * @brief Limit a calibrated offset to the int16_t register range
+ * @param[in] value Offset to limit
+ * @return Limited offset
+ */
+int16_t motion_mpu6050_hand_cal_clamp(int32_t value) {
+    if (value > 32767) return 32767;
+    if (value < -32768) return -32768;
+    return value;
+}
+
+/**
+ * @brief Feed the latest raw sample to the still-detection calibrator
+ *
+ * A window of KG_MPU6050_HAND_CAL_SAMPLES samples counts as still when no axis
+ * spreads more than the KG_MPU6050_HAND_CAL_STILL_* limits; any movement
+ * starts a new window. When a still window completes, its gyro average is the
+ * bias. Gyro offset registers use +/-1000 deg/s units (2 LSB per raw LSB at
+ * +/-2000 deg/s), and accel offset registers use +/-16g units (1 LSB per 8 raw
+ * LSB at +/-2g) with bit 0 reserved.
+ *
+ * In the background only the gyro is trimmed, since accel offsets cannot be
+ * told apart from tilt without a known orientation, and EEPROM is only
+ * rewritten when the bias has moved by KG_MPU6050_HAND_CAL_SAVE_DELTA.
+ */
+void motion_mpu6050_hand_cal_sample() {
+    if (!mpuHandCalFlags && !opt_motion_mpu6050_hand_autocal) return;
+    if (mpuHandCalFlags && ++mpuHandCalElapsed >= KG_MPU6050_HAND_CAL_TIMEOUT) {
+        motion_mpu6050_hand_cal_finish(KG_MPU6050_HAND_CAL_STATUS_TIMEOUT);
+        return;
+    }
+
+    // wait for any offset update to reach the sensor and clear out of the FIFO
+    uint8_t status0 = mpuHandOffsetWrite[0].status, status1 = mpuHandOffsetWrite[1].status;
+    if (status0 == KG_TWI_STATUS_QUEUED || status0 == KG_TWI_STATUS_ACTIVE
+        || status1 == KG_TWI_STATUS_QUEUED || status1 == KG_TWI_STATUS_ACTIVE) {
+        mpuHandCalCount = 0;
+        return;
+    }
+    if (mpuHandCalSettle) {
+        mpuHandCalSettle--;
+        mpuHandCalCount = 0;
+        return;
+    }
+
+    int16_t value[6] = { aaRaw.x, aaRaw.y, aaRaw.z, gvRaw.x, gvRaw.y, gvRaw.z };
+    uint8_t still = 1, i;
+    for (i = 0; i < 6; i++) {
+        if (mpuHandCalCount == 0) {
+            mpuHandCalSum[i] = 0;
+            mpuHandCalMin[i] = mpuHandCalMax[i] = value[i];
+        } else if (value[i] < mpuHandCalMin[i]) {
+            mpuHandCalMin[i] = value[i];
+        } else if (value[i] > mpuHandCalMax[i]) {
+            mpuHandCalMax[i] = value[i];
+        }
+        if (mpuHandCalMax[i] - mpuHandCalMin[i] > (i < 3 ? KG_MPU6050_HAND_CAL_STILL_ACCEL : KG_MPU6050_HAND_CAL_STILL_GYRO)) still = 0;
+        mpuHandCalSum[i] += value[i];
+    }
+    if (!still) {
+        mpuHandCalCount = 0;
+        if (mpuHandCalFlags) motion_mpu6050_hand_cal_report(KG_MPU6050_HAND_CAL_STATUS_WAITING, 0);
+        return;
+    }
+    mpuHandCalCount++;
+    if (mpuHandCalFlags) motion_mpu6050_hand_cal_report(KG_MPU6050_HAND_CAL_STATUS_COLLECTING, (uint32_t)mpuHandCalCount * 100 / KG_MPU6050_HAND_CAL_SAMPLES);
+    if (mpuHandCalCount < KG_MPU6050_HAND_CAL_SAMPLES) return;
+
+    // full still window, so work out new offsets
+    mpuHandCalCount = 0;
+    int16_t mean[6];
+    for (i = 0; i < 6; i++) mean[i] = mpuHandCalSum[i] / KG_MPU6050_HAND_CAL_SAMPLES;
+    uint8_t changed = 0;
+    if (!mpuHandCalFlags || (mpuHandCalFlags & KG_MPU6050_HAND_CAL_GYRO)) {
+        for (i = 3; i < 6; i++) {
+            if (mean[i] == 0) continue;
+            mpuHandOffset[i] = motion_mpu6050_hand_cal_clamp((int32_t)mpuHandOffset[i] - (int32_t)mean[i] * 2);
+            changed = 1;
+        }
+    }
+    if (mpuHandCalFlags & KG_MPU6050_HAND_CAL_ACCEL) {
+        if (abs(mean[0]) > KG_MPU6050_HAND_CAL_FLAT_LIMIT || abs(mean[1]) > KG_MPU6050_HAND_CAL_FLAT_LIMIT) {
+            if (changed) motion_mpu6050_hand_cal_apply();
+            motion_mpu6050_hand_cal_finish(KG_MPU6050_HAND_CAL_STATUS_NOT_FLAT);
+            return;
+        }
+        mean[2] -= mean[2] > 0 ? KG_MPU6050_HAND_ACCEL_1G : -KG_MPU6050_HAND_ACCEL_1G;
+        for (i = 0; i < 3; i++) {
+            int16_t trimmed = motion_mpu6050_hand_cal_clamp((int32_t)mpuHandOffset[i] - mean[i] / 8);
+            mpuHandOffset[i] = (trimmed & ~1) | (mpuHandOffset[i] & 1);
+        }
+        changed = 1;
+    }
+    if (changed) motion_mpu6050_hand_cal_apply();
+
+    if (mpuHandCalFlags) {
+        motion_mpu6050_hand_cal_save();
+        motion_mpu6050_hand_cal_finish(KG_MPU6050_HAND_CAL_STATUS_COMPLETE);
+    } else {
+        for (i = 3; i < 6; i++) {
+            if (abs(mpuHandOffset[i] - mpuHandOffsetSaved[i]) >= KG_MPU6050_HAND_CAL_SAVE_DELTA) {
+                motion_mpu6050_hand_cal_save();
+                break;
+            }
+        }
     }
 }
@@ -35,19 +35,102 @@ THE SOFTWARE.
 #ifndef _SUPPORT_MOTION_MPU6050_HAND_H_
 #define _SUPPORT_MOTION_MPU6050_HAND_H_
 
-#include <I2Cdev.h>
-#include <MPU6050.h>
+#include <avr/eeprom.h>
+#include "support_helper_twi.h"
 
 #include "support_helper_3dmath.h"
 
-extern bool mpuHandInterrupt;
+#define KG_MPU6050_HAND_ADDRESS         0x68    ///< 7-bit I2C address (AD0 low)
 
+// MPU-6050 registers (names as used by I2Cdevlib)
+#define MPU6050_RA_XA_OFFS_H            0x06    ///< Accel offsets, XYZ big-endian, factory trimmed (+/-16g units, bit 0 reserved)
+#define MPU6050_RA_XG_OFFS_USRH         0x13    ///< Gyro offsets, XYZ big-endian (+/-1000 deg/s units)
+#define MPU6050_RA_SMPLRT_DIV           0x19
+#define MPU6050_RA_CONFIG               0x1A
+#define MPU6050_RA_GYRO_CONFIG          0x1B
+#define MPU6050_RA_ACCEL_CONFIG         0x1C
+#define MPU6050_RA_MOT_THR              0x1F
+#define MPU6050_RA_MOT_DUR              0x20
+#define MPU6050_RA_ZRMOT_THR            0x21
+#define MPU6050_RA_ZRMOT_DUR            0x22
+#define MPU6050_RA_FIFO_EN              0x23
+#define MPU6050_RA_INT_PIN_CFG          0x37
+#define MPU6050_RA_INT_ENABLE           0x38
+#define MPU6050_RA_INT_STATUS           0x3A
+#define MPU6050_RA_USER_CTRL            0x6A
+#define MPU6050_RA_PWR_MGMT_1           0x6B
+#define MPU6050_RA_PWR_MGMT_2           0x6C
+#define MPU6050_RA_FIFO_COUNTH          0x72
+#define MPU6050_RA_FIFO_R_W             0x74
+
+#define KG_MPU6050_HAND_SAMPLE_RATE     100     ///< Default output data rate in Hz
+#define KG_MPU6050_HAND_RATE_MIN        100     ///< Lowest configurable rate in Hz (fusion fixed point needs at least ~70Hz)
+#define KG_MPU6050_HAND_RATE_MAX        500     ///< Highest configurable rate in Hz (1kHz divided by an integer in between)
+#define KG_MPU6050_HAND_FIFO_WATERMARK  2       ///< Samples to collect in the FIFO before reading them all in one burst
+#define KG_MPU6050_HAND_FIFO_BATCH      8       ///< Maximum samples read and buffered per burst
+#define KG_MPU6050_HAND_FIFO_SIZE       1024    ///< MPU-6050 FIFO capacity in bytes
+#define KG_MPU6050_HAND_SAMPLE_SIZE     12      ///< FIFO bytes per sample (accel XYZ then gyro XYZ, big-endian)
+#define KG_MPU6050_HAND_ACCEL_1G        16384   ///< Accel LSB per g (+/-2g range)
+
+#define KG_MPU6050_HAND_CAL_GYRO        0x01    ///< Calibration flag: gyro bias (any orientation)
+#define KG_MPU6050_HAND_CAL_ACCEL       0x02    ///< Calibration flag: accel offsets (sensor lying flat)
+
+#define KG_MPU6050_HAND_CAL_STATUS_WAITING      0x01    ///< Waiting for the hand to be held still
+#define KG_MPU6050_HAND_CAL_STATUS_COLLECTING   0x02    ///< Averaging still samples
+#define KG_MPU6050_HAND_CAL_STATUS_COMPLETE     0x03    ///< New offsets applied and stored
+#define KG_MPU6050_HAND_CAL_STATUS_TIMEOUT      0x04    ///< Hand was not still long enough before the timeout
+#define KG_MPU6050_HAND_CAL_STATUS_NOT_FLAT     0x05    ///< Accelerometer calibration needs the sensor lying flat
+#define KG_MPU6050_HAND_CAL_STATUS_CANCELLED    0x06    ///< Calibration was cancelled
+
+#define KG_MPU6050_HAND_CAL_SAMPLES     200     ///< Still samples averaged per calibration window (2 seconds at 100Hz)
+#define KG_MPU6050_HAND_CAL_TIMEOUT     3000    ///< Samples an explicit calibration waits for a full still window (30 seconds at 100Hz)
+#define KG_MPU6050_HAND_CAL_STILL_GYRO  33      ///< Largest gyro spread (LSB, ~2 deg/s) within a window that still counts as resting
+#define KG_MPU6050_HAND_CAL_STILL_ACCEL 328     ///< Largest accel spread (LSB, ~0.02g) within a window that still counts as resting
+#define KG_MPU6050_HAND_CAL_FLAT_LIMIT  1638    ///< Largest X/Y accel (LSB, ~0.1g) accepted as lying flat for accel calibration
+#define KG_MPU6050_HAND_CAL_SAVE_DELTA  4       ///< Gyro offset change (register LSB) before background calibration rewrites EEPROM
+#define KG_MPU6050_HAND_CAL_EEPROM_BASE 0x0C00  ///< EEPROM address of stored offsets (just past the macro slots)
+#define KG_MPU6050_HAND_CAL_RECORD_SIZE 14      ///< EEPROM record: magic, 12 bytes of offset registers, checksum
+#define KG_MPU6050_HAND_CAL_MAGIC       0xC6    ///< First byte of a valid EEPROM record
+
+#define KG_MPU6050_HAND_POWER_OFF       0x00    ///< Power state: sensor disabled and fully asleep
+#define KG_MPU6050_HAND_POWER_ACTIVE    0x01    ///< Power state: sampling at full rate (also motion_state event value)
+#define KG_MPU6050_HAND_POWER_SLEEP     0x02    ///< Power state: accel-only low-power cycling, waiting for motion (also motion_state event value)
+
+#define KG_MPU6050_HAND_IDLE_GYRO       131     ///< Largest gyro reading (LSB, 8 deg/s) on any axis that still counts as idle
+#define KG_MPU6050_HAND_IDLE_ACCEL      655     ///< Largest accel change (LSB, 0.04g) from the start of an idle period
+#define KG_MPU6050_HAND_WAKE_THRESHOLD  20      ///< MOT_THR value (2mg per LSB) that wakes the sensor from low-power cycling
+#define KG_MPU6050_HAND_WAKE_RATE       2       ///< LP_WAKE_CTRL accel rate while asleep (0=1.25Hz, 1=5Hz, 2=20Hz, 3=40Hz)
+
+extern uint8_t opt_motion_mpu6050_hand_autocal;
+extern uint8_t opt_motion_mpu6050_hand_sleep_delay;
+extern uint8_t mpuHandPowerState;
+
+extern volatile uint8_t mpuHandPending;
+extern uint32_t mpuHandSampleTime;
+
+extern VectorInt16 aaRaw;
 extern VectorInt16 aa;
+extern VectorInt16 gvRaw;
 extern VectorInt16 gv;
 
 void motion_mpu6050_hand_interrupt();
 void motion_set_mpu6050_hand_mode(uint8_t mode);
+uint8_t motion_mpu6050_hand_configure(motion_config_t *config);
+void motion_mpu6050_hand_fifo_reset();
 void setup_motion_mpu6050_hand();
 void update_motion_mpu6050_hand();
+void motion_mpu6050_hand_count_done(twi_transaction_t *transaction);
+void motion_mpu6050_hand_batch_done(twi_transaction_t *transaction);
+uint8_t motion_mpu6050_hand_next_sample();
+
+void motion_mpu6050_hand_power_start(uint8_t state);
+void motion_mpu6050_hand_power_next(twi_transaction_t *transaction);
+void motion_mpu6050_hand_idle_sample();
+
+void motion_mpu6050_hand_cal_finish(uint8_t status);
+void motion_mpu6050_hand_cal_load();
+void motion_mpu6050_hand_cal_write_step();
+void motion_mpu6050_hand_cal_sample();
+uint8_t motion_mpu6050_hand_cal_start(uint8_t flags);
 
 #endif // _SUPPORT_MOTION_MPU6050_HAND_H_
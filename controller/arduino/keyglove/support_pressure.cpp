@@ -0,0 +1,251 @@
+// Keyglove controller source code - Fingertip pressure detection
+// 2014-12-14 by Jeff Rowberg <jeff@rowberg.net>
+
+/* ============================================
+Controller code is placed under the MIT license
+Copyright (c) 2014 Jeff Rowberg
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+/**
+ * @file support_pressure.cpp
+ * @brief Fingertip pressure detection
+ * @author Jeff Rowberg
+ * @date 2014-12-14
+ *
+ * This file turns the fingertip pressure sensor readings from the free-running
+ * ADC scan (see support_helper_adc.cpp) into presses. Each reading becomes a
+ * 0-255 force above a resting baseline, which slowly follows the sensor while
+ * the finger is not pressing so that drift and preload don't look like force.
+ *
+ * A press starts once the force reaches opt_pressure_press and ends once it
+ * falls below opt_pressure_release; the gap between the two keeps a finger
+ * resting near one threshold from chattering. While the force is still rising
+ * at the start of a press, the fastest rise is kept as the strike velocity,
+ * and the press event is sent with that velocity and the peak force as soon as
+ * the rise stops. While held, value events are only sent when the force moves
+ * by opt_pressure_deadband or more.
+ *
+ * pressure_modifier() exposes each sensor as an analog modifier for touchset
+ * actions, e.g. the pressure opcodes in keyboard macros which repeat faster
+ * the harder or faster the fingertip is pressed.
+ *
+ * Normally it is not necessary to edit this file.
+ */
+
+#include "keyglove.h"
+#include "support_board.h"
+#include "support_protocol.h"
+#include "support_pressure.h"
+
+#define KG_PRESSURE_VALUE_SHIFT     (KG_ADC_OVERSAMPLE_BITS + 2)    ///< Shift from ADC result to 8-bit force
+
+uint8_t opt_pressure_press = 40;        ///< OPTION: Force (0-255) at which a press starts
+uint8_t opt_pressure_release = 24;      ///< OPTION: Force (0-255) below which a press ends
+uint8_t opt_pressure_deadband = 6;      ///< OPTION: Smallest change in force that sends a pressure_value event
+uint16_t opt_pressure_repeat_slow = 500;    ///< OPTION: Pressure-scaled macro delay in milliseconds at the lightest press
+uint8_t opt_pressure_repeat_fast = 30;  ///< OPTION: Pressure-scaled macro delay in milliseconds at the hardest press
+
+uint8_t pressureScan;                   ///< adcScanCount when pressureRaw was last updated
+uint32_t pressureTime;                  ///< millis() when pressureRaw was last updated (0 before the first reading)
+uint16_t pressureRaw[KG_PRESSURE_SENSOR_COUNT];         ///< Latest oversampled reading for each sensor
+uint16_t pressureBaseline[KG_PRESSURE_SENSOR_COUNT];    ///< Resting reading for each sensor, scaled by 2^KG_PRESSURE_BASELINE_SHIFT
+uint8_t pressureValue[KG_PRESSURE_SENSOR_COUNT];        ///< Latest force above baseline for each sensor (0-255)
+uint8_t pressureVelocity[KG_PRESSURE_SENSOR_COUNT];     ///< Strike velocity of the latest press (force per 10ms)
+uint8_t pressurePeak[KG_PRESSURE_SENSOR_COUNT];         ///< Highest force during the latest strike
+uint8_t pressureSent[KG_PRESSURE_SENSOR_COUNT];         ///< Force last reported for a held press
+uint8_t pressureState[KG_PRESSURE_SENSOR_COUNT];        ///< Press state (KG_PRESSURE_STATE_*)
+
+/**
+ * @brief Get a pressure sensor's current level for use as an analog modifier
+ * @param[in] index Pressure sensor index
+ * @return Larger of force and strike velocity while pressed (0-255), zero when released
+ *
+ * Using the strike velocity too means a quick tap counts as hard from the very
+ * start, even before the force has built up.
+ */
+uint8_t pressure_modifier(uint8_t index) {
+    if (index >= KG_PRESSURE_SENSOR_COUNT || pressureState[index] == KG_PRESSURE_STATE_RELEASED) return 0;
+    return pressureValue[index] > pressureVelocity[index] ? pressureValue[index] : pressureVelocity[index];
+}
+
+/**
+ * @brief Get a repeat interval scaled by a pressure sensor's modifier level
+ * @param[in] index Pressure sensor index
+ * @return Milliseconds from opt_pressure_repeat_slow (lightest) down to opt_pressure_repeat_fast (hardest)
+ */
+uint16_t pressure_repeat_interval(uint8_t index) {
+    int32_t span = (int32_t)opt_pressure_repeat_slow - opt_pressure_repeat_fast;
+    return opt_pressure_repeat_slow - span * pressure_modifier(index) / 255;
+}
+
+/**
+ * @brief Initialize pressure detection
+ */
+void setup_pressure() {
+    pressureScan = adcScanCount;
+    pressureTime = 0;
+    for (uint8_t i = 0; i < KG_PRESSURE_SENSOR_COUNT; i++) {
+        pressureValue[i] = 0;
+        pressureVelocity[i] = 0;
+        pressureState[i] = KG_PRESSURE_STATE_RELEASED;
+    }
+}
+
+/**
+ * @brief Pick up new pressure readings and report presses, releases and force changes
+ * @see API event: kg_evt_pressure_press()
+ * @see API event: kg_evt_pressure_release()
+ * @see API event: kg_evt_pressure_value()
+ */
+void update_pressure() {
+    if (!adc_read(KG_ADC_INDEX_PRESSURE, KG_PRESSURE_SENSOR_COUNT, pressureRaw, &pressureScan)) return;
+
+    uint32_t now = millis();
+    uint16_t elapsed = now - pressureTime;
+    for (uint8_t i = 0; i < KG_PRESSURE_SENSOR_COUNT; i++) {
+        // first reading is taken as the resting baseline
+        if (pressureTime == 0) pressureBaseline[i] = pressureRaw[i] << KG_PRESSURE_BASELINE_SHIFT;
+
+        int16_t force = ((int16_t)pressureRaw[i] - (int16_t)(pressureBaseline[i] >> KG_PRESSURE_BASELINE_SHIFT)) >> KG_PRESSURE_VALUE_SHIFT;
+        if (force < 0) force = 0;
+        if (force > 255) force = 255;
+        int16_t rise = force - pressureValue[i];
+        pressureValue[i] = force;
+
+        if (pressureState[i] == KG_PRESSURE_STATE_RELEASED) {
+            if (force < opt_pressure_press) {
+                // follow slow drift while at rest, but not while a press is building up
+                if (force < opt_pressure_release) {
+                    pressureBaseline[i] += pressureRaw[i] - (pressureBaseline[i] >> KG_PRESSURE_BASELINE_SHIFT);
+                }
+                continue;
+            }
+            pressureState[i] = KG_PRESSURE_STATE_STRIKING;
+            pressureVelocity[i] = 0;
+        }
+
+        if (pressureState[i] == KG_PRESSURE_STATE_STRIKING) {
+            if (rise > 0) {
+                // still rising, so keep the fastest rise (force per 10ms) and the peak
+                if (elapsed) {
+                    uint16_t velocity = (uint16_t)rise * 10 / elapsed;
+                    if (velocity > 255) velocity = 255;
+                    if (velocity > pressureVelocity[i]) pressureVelocity[i] = velocity;
+                }
+                pressurePeak[i] = force;
+                continue;
+            }
+            pressureState[i] = KG_PRESSURE_STATE_HELD;
+            pressureSent[i] = pressurePeak[i];
+
+            // send kg_evt_pressure_press packet
+            uint8_t payload[3] = { i, pressureVelocity[i], pressurePeak[i] };
+            skipPacket = 0;
+            if (kg_evt_pressure_press) skipPacket = kg_evt_pressure_press(i, pressureVelocity[i], pressurePeak[i]);
+            if (!skipPacket) send_keyglove_packet(KG_PACKET_TYPE_EVENT, 3, KG_PACKET_CLASS_PRESSURE, KG_PACKET_ID_EVT_PRESSURE_PRESS, payload);
+        }
+
+        if (force < opt_pressure_release) {
+            pressureState[i] = KG_PRESSURE_STATE_RELEASED;
+
+            // send kg_evt_pressure_release packet
+            uint8_t payload[1] = { i };
+            skipPacket = 0;
+            if (kg_evt_pressure_release) skipPacket = kg_evt_pressure_release(i);
+            if (!skipPacket) send_keyglove_packet(KG_PACKET_TYPE_EVENT, 1, KG_PACKET_CLASS_PRESSURE, KG_PACKET_ID_EVT_PRESSURE_RELEASE, payload);
+        } else if (abs(force - pressureSent[i]) >= opt_pressure_deadband) {
+            pressureSent[i] = force;
+
+            // send kg_evt_pressure_value packet
+            uint8_t payload[2] = { i, pressureValue[i] };
+            skipPacket = 0;
+            if (kg_evt_pressure_value) skipPacket = kg_evt_pressure_value(i, pressureValue[i]);
+            if (!skipPacket) send_keyglove_packet(KG_PACKET_TYPE_EVENT, 2, KG_PACKET_CLASS_PRESSURE, KG_PACKET_ID_EVT_PRESSURE_VALUE, payload);
+        }
+    }
+    pressureTime = now ? now : 1;
+}
+
+/* ============================= */
+/* KGAPI COMMAND IMPLEMENTATIONS */
+/* ============================= */
+
+/**
+ * @brief Get the latest reading of specified pressure sensor
+ * @param[in] index Index of pressure sensor
+ * @param[out] state Press state
+ * @param[out] value Force above the resting baseline (0-255)
+ * @param[out] velocity Strike velocity of the most recent press
+ * @param[out] raw Oversampled reading
+ * @return Result code (0=success)
+ */
+uint16_t kg_cmd_pressure_get_value(uint8_t index, uint8_t *state, uint8_t *value, uint8_t *velocity, uint16_t *raw) {
+    if (index >= KG_PRESSURE_SENSOR_COUNT) {
+        return KG_PROTOCOL_ERROR_PARAMETER_RANGE;
+    } else {
+        *state = pressureState[index];
+        *value = pressureValue[index];
+        *velocity = pressureVelocity[index];
+        *raw = pressureRaw[index];
+    }
+    return 0; // success
+}
+
+/**
+ * @brief Get the press detection thresholds
+ * @param[out] press Force at which a press starts
+ * @param[out] release Force below which a press ends
+ * @param[out] deadband Smallest change in force that sends a value event
+ * @return Result code (0=success)
+ */
+uint16_t kg_cmd_pressure_get_config(uint8_t *press, uint8_t *release, uint8_t *deadband) {
+    *press = opt_pressure_press;
+    *release = opt_pressure_release;
+    *deadband = opt_pressure_deadband;
+    return 0; // success
+}
+
+/**
+ * @brief Set the press detection thresholds
+ * @param[in] press Force at which a press starts
+ * @param[in] release Force below which a press ends (must be below press)
+ * @param[in] deadband Smallest change in force that sends a value event (at least 1)
+ * @return Result code (0=success)
+ */
+uint16_t kg_cmd_pressure_set_config(uint8_t press, uint8_t release, uint8_t deadband) {
+    if (release >= press || deadband == 0) {
+        return KG_PROTOCOL_ERROR_PARAMETER_RANGE;
+    } else {
+        opt_pressure_press = press;
+        opt_pressure_release = release;
+        opt_pressure_deadband = deadband;
+
+        // send kg_evt_pressure_config packet (if we aren't setting it from an API command)
+        if (!inBinPacket) {
+            uint8_t payload[3] = { press, release, deadband };
+            skipPacket = 0;
+            if (kg_evt_pressure_config) skipPacket = kg_evt_pressure_config(press, release, deadband);
+            if (!skipPacket) send_keyglove_packet(KG_PACKET_TYPE_EVENT, 3, KG_PACKET_CLASS_PRESSURE, KG_PACKET_ID_EVT_PRESSURE_CONFIG, payload);
+        }
+    }
+    return 0; // success
+}
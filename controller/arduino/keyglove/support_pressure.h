@@ -0,0 +1,62 @@
+// Keyglove controller source code - Fingertip pressure detection
+// 2014-12-14 by Jeff Rowberg <jeff@rowberg.net>
+
+/* ============================================
+Controller code is placed under the MIT license
+Copyright (c) 2014 Jeff Rowberg
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+/**
+ * @file support_pressure.h
+ * @brief Fingertip pressure detection declarations
+ * @author Jeff Rowberg
+ * @date 2014-12-14
+ */
+
+#ifndef _SUPPORT_PRESSURE_H_
+#define _SUPPORT_PRESSURE_H_
+
+#include "support_helper_adc.h"
+
+#define KG_PRESSURE_STATE_RELEASED      0x00    ///< Not pressed
+#define KG_PRESSURE_STATE_STRIKING      0x01    ///< Pressed and force still rising
+#define KG_PRESSURE_STATE_HELD          0x02    ///< Pressed, past the peak of the strike
+
+#define KG_PRESSURE_BASELINE_SHIFT      4       ///< Resting baseline follows 1/2^n of each difference while released
+
+extern uint8_t opt_pressure_press;
+extern uint8_t opt_pressure_release;
+extern uint8_t opt_pressure_deadband;
+extern uint16_t opt_pressure_repeat_slow;
+extern uint8_t opt_pressure_repeat_fast;
+
+extern uint16_t pressureRaw[KG_PRESSURE_SENSOR_COUNT];
+extern uint8_t pressureValue[KG_PRESSURE_SENSOR_COUNT];
+extern uint8_t pressureVelocity[KG_PRESSURE_SENSOR_COUNT];
+extern uint8_t pressureState[KG_PRESSURE_SENSOR_COUNT];
+
+uint8_t pressure_modifier(uint8_t index);
+uint16_t pressure_repeat_interval(uint8_t index);
+void setup_pressure();
+void update_pressure();
+
+#endif // _SUPPORT_PRESSURE_H_
@@ -37,6 +37,40 @@ THE SOFTWARE.
  * commands and events are also implemented here. Subsystem-specific API packets
  * are defined and implemented elsewhere.
  *
+ * Complete command packets are not run inside the parser. They wait in a small
+ * queue (KG_PROTOCOL_QUEUE_DEPTH deep) and one is run on each pass through the
+ * main loop, so a host can send a whole burst of commands without waiting for
+ * each response. The queue owns one packet buffer per slot, and a finished
+ * packet is swapped into its slot rather than copied. When the queue is full,
+ * serial input is left unread until there is room again, and anything else
+ * (e.g. the rest of a raw HID report) runs the oldest command first.
+ *
+ * A command may carry a tag (1-7) in the three spare bits of its first header
+ * byte (0xC8, 0xD0, ... 0xF8). The response, and any protocol error caused by
+ * the command, carries the same tag, so the host can match responses to the
+ * commands it has outstanding. Untagged commands (0xC0) work exactly as
+ * before.
+ *
+ * Events are never tagged, so the same three bits are reused on events to
+ * carry the current timestamp mode (see system_set_timestamp_mode). When it
+ * is not zero, every event except protocol errors and log messages has a
+ * 32-bit timestamp appended after its normal payload, counted in the length
+ * byte. The timestamp is taken when the packet is actually sent, so queued
+ * events are stamped with their send time rather than the time they were
+ * queued.
+ *
+ * Events go out on every ready interface, but each interface has its own
+ * subscription mask for each built-in class (bit N = event ID N) and an
+ * optional shortest interval between the streaming events of that class, both
+ * set over KGAPI (system_set_event_mask/system_set_event_rate). The interval
+ * only applies to the event IDs the host marks as rate limited, so one-off
+ * state changes in the same class (gestures, touch releases) are never
+ * dropped. The send path checks everything with one lookup in small
+ * [interface][class] tables, so a slow link like BT2 serial can take motion
+ * data at 25Hz while USB gets all of it, and a raw HID monitor can skip it
+ * completely. Responses and protocol errors
+ * only ever go to the interface the command came from, and are not filtered.
+ *
  * Normally it is not necessary to edit this file.
  */
 
@@ -65,6 +99,20 @@ uint8_t skipPacket = 0;     ///< Global var to control whether event packet will
 
 uint8_t lastCommandInterfaceNum;    ///< Source interface number of last incoming command packet
 
+uint8_t rxPacketTag;                ///< Tag from the header of the command packet being received
+uint8_t protocolCommandTag;         ///< Tag of the command being run, echoed in its response
+
+uint8_t *protocolQueue[KG_PROTOCOL_QUEUE_DEPTH];            ///< Packet buffer owned by each queue slot
+uint16_t protocolQueueSize[KG_PROTOCOL_QUEUE_DEPTH];        ///< Allocated size of each queue slot buffer
+uint8_t protocolQueueInterface[KG_PROTOCOL_QUEUE_DEPTH];    ///< Source interface number of each queued command
+uint8_t protocolQueueTag[KG_PROTOCOL_QUEUE_DEPTH];          ///< Tag of each queued command
+uint8_t protocolQueueHead;                                  ///< Slot holding the oldest queued command
+uint8_t protocolQueueCount;                                 ///< Number of commands waiting to be run
+
+uint8_t protocolTimestampMode;      ///< Timestamp appended to outgoing events (KG_SYSTEM_TIMESTAMP_MODE_*)
+
+protocol_event_filter_t protocolEventFilter[KG_INTERFACENUM_COUNT][KG_PACKET_CLASS_COUNT];    ///< Event subscriptions and rate limits for each interface and class
+
 uint8_t systemResetFlags = 0; ///< Controls what to reset when we use "system_reset" API command
 
 /**
@@ -74,9 +122,45 @@ void setup_protocol() {
     // allocate RX packet buffer on fresh boot
     if (rxPacketSize == 0 || rxPacket == 0) {
         rxPacketSize = 32;
-        rxPacket = (uint8_t *)malloc(rxPacketSize);
+        rxPacket = (uint8_t *)memory_malloc(KG_SYSTEM_MEMORY_SUBSYSTEM_PROTOCOL_RX, rxPacketSize);
         rxPacketLength = 0;
     }
+
+    // anything still queued was meant for the firmware we're replacing
+    protocolQueueHead = 0;
+    protocolQueueCount = 0;
+
+    // events start out without timestamps until a host asks for them
+    protocolTimestampMode = KG_SYSTEM_TIMESTAMP_MODE_NONE;
+
+    // every interface gets every event, as fast as they happen
+    memset(protocolEventFilter, 0, sizeof(protocolEventFilter));
+    for (uint8_t i = 0; i < KG_INTERFACENUM_COUNT; i++) {
+        for (uint8_t j = 0; j < KG_PACKET_CLASS_COUNT; j++) protocolEventFilter[i][j].mask = 0xFFFF;
+    }
+}
+
+/**
+ * @brief Check whether an event should go out on one interface
+ * @param[in] interfaceNum Interface number (KG_INTERFACENUM_*)
+ * @param[in] packetClass Event class ID byte
+ * @param[in] packetId Event ID byte
+ * @return Non-zero if the event should be sent, zero if the interface has unsubscribed or the event is over its rate limit
+ */
+uint8_t protocol_event_allowed(uint8_t interfaceNum, uint8_t packetClass, uint8_t packetId) {
+    // custom classes and IDs beyond the mask are always sent
+    if (packetClass >= KG_PACKET_CLASS_COUNT || packetId > 15) return 1;
+
+    protocol_event_filter_t *filter = &protocolEventFilter[interfaceNum - 1][packetClass];
+    uint16_t bit = 1 << packetId;
+    if ((filter -> mask & bit) == 0) return 0;
+    if (filter -> interval && (filter -> rate_ids & bit)) {
+        // 16-bit tick count wraps every ~11 minutes, which is far longer than any interval
+        uint16_t now = keygloveTock * 100 + keygloveTick;
+        if ((uint16_t)(now - filter -> last) < filter -> interval) return 0;
+        filter -> last = now;
+    }
+    return 1;
 }
 
 /**
@@ -90,6 +174,145 @@ uint16_t reset_keyglove_rx_packet() {
     return prevLength;
 }
 
+/**
+ * @brief Run one complete command packet, passing it to the appropriate main handler
+ * @param[in] rxPacket Complete command packet
+ */
+void process_protocol_packet(uint8_t *rxPacket) {
+    uint8_t protocol_error = 0;
+
+    // filter incoming packets for custom behavior
+    if (filter_incoming_keyglove_packet(rxPacket) == 0) {
+        switch (rxPacket[2]) {
+            //case KG_PACKET_CLASS_PROTOCOL:
+
+            case KG_PACKET_CLASS_SYSTEM:
+                protocol_error = process_protocol_command_system(rxPacket);
+                break;
+
+            case KG_PACKET_CLASS_TOUCH:
+                protocol_error = process_protocol_command_touch(rxPacket);
+                break;
+
+            #if KG_MOTION > 0
+                case KG_PACKET_CLASS_MOTION:
+                    protocol_error = process_protocol_command_motion(rxPacket);
+                    break;
+            #endif
+
+            #if KG_FEEDBACK > 0
+                case KG_PACKET_CLASS_FEEDBACK:
+                    protocol_error = process_protocol_command_feedback(rxPacket);
+                    break;
+            #endif
+
+            #if KG_FLEX > 0
+                case KG_PACKET_CLASS_FLEX:
+                    protocol_error = process_protocol_command_flex(rxPacket);
+                    break;
+            #endif
+
+            #if KG_PRESSURE > 0
+                case KG_PACKET_CLASS_PRESSURE:
+                    protocol_error = process_protocol_command_pressure(rxPacket);
+                    break;
+            #endif
+
+            #if (KG_TOUCHSET > 0) || (KG_HID & KG_HID_KEYBOARD)
+                case KG_PACKET_CLASS_TOUCHSET:
+                    protocol_error = process_protocol_command_touchset(rxPacket);
+                    break;
+            #endif
+
+            #if (KG_HOSTIF & HG_HOSTIF_BT2_SPP) || (KG_HOSTIF & KG_HOSTIF_BT2_RAWHID) || (KG_HOSTIF & KG_HOSTIF_BT2_IAP)
+                case KG_PACKET_CLASS_BLUETOOTH:
+                    protocol_error = process_protocol_command_bluetooth(rxPacket);
+                    break;
+            #endif
+
+            default:
+                // check for custom protocol, will return KG_PROTOCOL_ERROR_INVALID_COMMAND if no matches
+                protocol_error = KG_PROTOCOL_ERROR_INVALID_COMMAND;
+                break;
+        }
+
+        // check for errors (e.g. unhandled, bad arguments, etc.)
+        if (protocol_error) {
+            // check for custom protocol, will return KG_PROTOCOL_ERROR_INVALID_COMMAND if no matches
+            protocol_error = process_protocol_command_custom(rxPacket);
+
+            // if we still have an error, then there is no custom functionality implemented for this class/ID combination
+            if (protocol_error) {
+                uint8_t payload[2] = { protocol_error, 0x00 };
+                skipPacket = 0;
+                if (kg_evt_protocol_error) skipPacket = kg_evt_protocol_error(payload[0]);
+                if (!skipPacket) send_keyglove_packet(KG_PACKET_TYPE_EVENT, 2, KG_PACKET_CLASS_PROTOCOL, KG_PACKET_ID_EVT_PROTOCOL_ERROR, payload);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Move the packet that was just received into the command queue
+ *
+ * The packet buffer itself moves into the free slot, and the parser carries
+ * on with the buffer that slot owned before, so nothing is copied. If there is
+ * no room, the oldest command is run first to make some.
+ */
+void protocol_queue_rx_packet() {
+    if (protocolQueueCount == KG_PROTOCOL_QUEUE_DEPTH) process_protocol_queue();
+
+    uint8_t slot = (protocolQueueHead + protocolQueueCount) % KG_PROTOCOL_QUEUE_DEPTH;
+    if (protocolQueue[slot] == 0) {
+        // first use of this slot, so it needs a buffer for the parser to continue with
+        protocolQueueSize[slot] = 32;
+        protocolQueue[slot] = (uint8_t *)memory_malloc(KG_SYSTEM_MEMORY_SUBSYSTEM_PROTOCOL_RX, protocolQueueSize[slot]);
+        if (protocolQueue[slot] == 0) {
+            // no memory to queue with, so just run it right now
+            protocolCommandTag = rxPacketTag;
+            process_protocol_packet(rxPacket);
+            protocolCommandTag = 0;
+            return;
+        }
+    }
+
+    uint8_t *packet = protocolQueue[slot];
+    uint16_t size = protocolQueueSize[slot];
+    protocolQueue[slot] = rxPacket;
+    protocolQueueSize[slot] = rxPacketSize;
+    protocolQueueInterface[slot] = lastCommandInterfaceNum;
+    protocolQueueTag[slot] = rxPacketTag;
+    protocolQueueCount++;
+    rxPacket = packet;
+    rxPacketSize = size;
+}
+
+/**
+ * @brief Run the oldest queued command packet (if any)
+ * @return Number of commands still queued
+ */
+uint8_t process_protocol_queue() {
+    if (protocolQueueCount == 0) return 0;
+
+    uint8_t slot = protocolQueueHead;
+    protocolQueueHead = (protocolQueueHead + 1) % KG_PROTOCOL_QUEUE_DEPTH;
+    protocolQueueCount--;
+
+    // responses go back where the command came from, and handlers expect
+    // inBinPacket to be set while running an API command, as it is in the parser
+    uint8_t interfaceNum = lastCommandInterfaceNum;
+    bool parsing = inBinPacket;
+    lastCommandInterfaceNum = protocolQueueInterface[slot];
+    protocolCommandTag = protocolQueueTag[slot];
+    inBinPacket = true;
+    process_protocol_packet(protocolQueue[slot]);
+    inBinPacket = parsing;
+    protocolCommandTag = 0;
+    lastCommandInterfaceNum = interfaceNum;
+
+    return protocolQueueCount;
+}
+
 /**
  * @brief Parse the next incoming KGAPI protocol byte
  * @param[in] inputByte Incoming byte to parse
@@ -97,21 +320,24 @@ uint16_t reset_keyglove_rx_packet() {
 void protocol_parse(uint8_t inputByte) {
     if (rxPacketLength + 1 == rxPacketSize) {
         rxPacketSize += 32;
-        rxPacket = (uint8_t *)realloc(rxPacket, rxPacketSize);
+        rxPacket = (uint8_t *)memory_realloc(KG_SYSTEM_MEMORY_SUBSYSTEM_PROTOCOL_RX, rxPacket, rxPacketSize);
         if (!rxPacket) {
             // failed to reallocate to new chunk of memory
             // this should NEVER happen, but if it does, I want to know
             uint8_t payload[2] = { KG_PROTOCOL_ERROR_NULL_POINTER & 0xFF, KG_PROTOCOL_ERROR_NULL_POINTER >> 8 };
+            protocolCommandTag = rxPacketTag;
             skipPacket = 0;
             if (kg_evt_protocol_error) skipPacket = kg_evt_protocol_error(KG_PROTOCOL_ERROR_NULL_POINTER);
             if (!skipPacket) send_keyglove_packet(KG_PACKET_TYPE_EVENT, 2, KG_PACKET_CLASS_PROTOCOL, KG_PACKET_ID_EVT_PROTOCOL_ERROR, payload);
+            protocolCommandTag = 0;
             return;
         }
     }
-    if (!inBinPacket && inputByte == KG_PACKET_TYPE_COMMAND) { // "bait" byte, 0xC0
+    if (!inBinPacket && (inputByte & ~KG_PACKET_TAG_MASK) == KG_PACKET_TYPE_COMMAND) { // "bait" byte, 0xC0 (plus tag)
         packetStartTime = millis();
         inBinPacket = true;
-        rxPacket[0] = inputByte;
+        rxPacket[0] = KG_PACKET_TYPE_COMMAND; // handlers never see the tag
+        rxPacketTag = inputByte & KG_PACKET_TAG_MASK;
         rxPacketLength = 1; // initialize buffer length to include only 1st header byte (so far)
         binDataLength = 0;
     } else if (inBinPacket && rxPacketLength == 1) { // data length byte
@@ -119,9 +345,11 @@ void protocol_parse(uint8_t inputByte) {
         if (binDataLength > 250) {
             // error (data payload too long)
             uint8_t payload[2] = { KG_PROTOCOL_ERROR_BAD_LENGTH, 0x00 };
+            protocolCommandTag = rxPacketTag;
             skipPacket = 0;
             if (kg_evt_protocol_error) skipPacket = kg_evt_protocol_error(payload[0]);
             if (!skipPacket) send_keyglove_packet(KG_PACKET_TYPE_EVENT, 2, KG_PACKET_CLASS_PROTOCOL, KG_PACKET_ID_EVT_PROTOCOL_ERROR, payload);
+            protocolCommandTag = 0;
             inBinPacket = false;
             rxPacketLength = 0;
         } else {
@@ -130,78 +358,8 @@ void protocol_parse(uint8_t inputByte) {
     } else {
         rxPacket[rxPacketLength++] = inputByte;
         if (inBinPacket && rxPacketLength - 4 == binDataLength) {
-            // process packet that just came in, passing to appropriate main handler
-            uint8_t protocol_error = 0;
-
-            // filter incoming packets for custom behavior
-            if (filter_incoming_keyglove_packet(rxPacket) == 0) {
-                switch (rxPacket[2]) {
-                    //case KG_PACKET_CLASS_PROTOCOL:
-
-                    case KG_PACKET_CLASS_SYSTEM:
-                        protocol_error = process_protocol_command_system(rxPacket);
-                        break;
-    
-                    case KG_PACKET_CLASS_TOUCH:
-                        protocol_error = process_protocol_command_touch(rxPacket);
-                        break;
-    
-                    #if KG_MOTION > 0
-                        case KG_PACKET_CLASS_MOTION:
-                            protocol_error = process_protocol_command_motion(rxPacket);
-                            break;
-                    #endif
-    
-                    #if KG_FEEDBACK > 0
-                        case KG_PACKET_CLASS_FEEDBACK:
-                            protocol_error = process_protocol_command_feedback(rxPacket);
-                            break;
-                    #endif
-    
-                    #if KG_FLEX > 0
-                        case KG_PACKET_CLASS_FLEX:
-                            protocol_error = process_protocol_command_flex(rxPacket);
-                            break;
-                    #endif
-    
-                    #if KG_PRESSURE > 0
-                        case KG_PACKET_CLASS_PRESSURE:
-                            protocol_error = process_protocol_command_pressure(rxPacket);
-                            break;
-                    #endif
-    
-                    #if KG_TOUCHSET > 0
-                        case KG_PACKET_CLASS_TOUCHSET:
-                            protocol_error = process_protocol_command_touchset(rxPacket);
-                            break;
-                    #endif
-    
-                    #if (KG_HOSTIF & HG_HOSTIF_BT2_SPP) || (KG_HOSTIF & KG_HOSTIF_BT2_RAWHID) || (KG_HOSTIF & KG_HOSTIF_BT2_IAP)
-                        case KG_PACKET_CLASS_BLUETOOTH:
-                            protocol_error = process_protocol_command_bluetooth(rxPacket);
-                            break;
-                    #endif
-    
-                    default:
-                        // check for custom protocol, will return KG_PROTOCOL_ERROR_INVALID_COMMAND if no matches
-                        protocol_error = KG_PROTOCOL_ERROR_INVALID_COMMAND;
-                        break;
-                }
-
-                // check for errors (e.g. unhandled, bad arguments, etc.)
-                if (protocol_error) {
-                    // check for custom protocol, will return KG_PROTOCOL_ERROR_INVALID_COMMAND if no matches
-                    protocol_error = process_protocol_command_custom(rxPacket);
-
-                    // if we still have an error, then there is no custom functionality implemented for this class/ID combination
-                    if (protocol_error) {
-                        uint8_t payload[2] = { protocol_error, 0x00 };
-                        skipPacket = 0;
-                        if (kg_evt_protocol_error) skipPacket = kg_evt_protocol_error(payload[0]);
-                        if (!skipPacket) send_keyglove_packet(KG_PACKET_TYPE_EVENT, 2, KG_PACKET_CLASS_PROTOCOL, KG_PACKET_ID_EVT_PROTOCOL_ERROR, payload);
-                    }
-                }
-            }
+            // hand packet that just came in to the command queue
+            protocol_queue_rx_packet();
 
             // reset packet status/length
             reset_keyglove_rx_packet();
@@ -217,7 +375,8 @@ uint8_t check_incoming_protocol_data() {
     #if KG_HOSTIF & KG_HOSTIF_USB_SERIAL
         // read available data from USB virtual serial
         if (interfaceUSBSerialReady && (interfaceUSBSerialMode & KG_INTERFACE_MODE_INCOMING_API) != 0) {
-            while ((rxByte = USBSerial.read()) < 256) {
+            // stop reading once the queue is full, so the rest waits in the USB buffer
+            while (protocolQueueCount < KG_PROTOCOL_QUEUE_DEPTH && (rxByte = USBSerial.read()) < 256) {
                 lastCommandInterfaceNum = KG_INTERFACENUM_USB_SERIAL;
                 protocol_parse((uint8_t)rxByte);
             }
@@ -244,42 +403,57 @@ uint8_t check_incoming_protocol_data() {
     if (inBinPacket && (millis() - packetStartTime) > KG_PROTOCOL_RX_TIMEOUT) {
         // error (data payload too long)
         uint8_t payload[2] = { KG_PROTOCOL_ERROR_PACKET_TIMEOUT, 0x00 };
+        protocolCommandTag = rxPacketTag;
         skipPacket = 0;
         if (kg_evt_protocol_error) skipPacket = kg_evt_protocol_error(payload[0]);
         if (!skipPacket) send_keyglove_packet(KG_PACKET_TYPE_EVENT, 2, KG_PACKET_CLASS_PROTOCOL, KG_PACKET_ID_EVT_PROTOCOL_ERROR, payload);
+        protocolCommandTag = 0;
         inBinPacket = false;
         rxPacketLength = 0;
     }
 
+    // run the oldest queued command, unless the parser is partway through the next one
+    if (!inBinPacket) process_protocol_queue();
+
     return 0;
 }
 
 /**
- * @brief Send a special log message (from RAM) out the main serial interface
+ * @brief Send a free text log message (from RAM) right away
  * @param[in] level Log level
  * @param[in] length Number of bytes in message
  * @param[in] message Message to send (normal variable in RAM)
  * @return Result, zero for success or non-zero for error
+ *
+ * Only for messages which have to carry arbitrary text (e.g. iWRAP traffic
+ * dumps). Fixed messages should use keyglove_log(), which is far cheaper.
  */
 uint8_t send_keyglove_log(uint8_t level, uint8_t length, const char *message) {
-    uint8_t beginning[] = { 0x80, length + 1, 0xFF, 0xFF, level };
-    Serial.write(beginning, 5);
-    Serial.println((const char *)message);
-    return 0;
+    static bool sending = false;
+    if (level > logLevel || sending || length > 249) return 1;
+
+    // sending this may itself cause a log message (e.g. iWRAP TX dump), which must not recurse
+    uint8_t payload[length + 1];
+    payload[0] = level;
+    memcpy(payload + 1, message, length);
+    sending = true;
+    uint8_t result = send_keyglove_packet(KG_PACKET_TYPE_EVENT, length + 1, KG_PACKET_CLASS_LOG, KG_PACKET_ID_EVT_LOG_TEXT, payload);
+    sending = false;
+    return result;
 }
 
 /**
- * @brief Send a special log message (from flash) out the main serial interface
+ * @brief Send a free text log message (from flash) right away
  * @param[in] level Log level
  * @param[in] length Number of bytes in message
  * @param[in] message Message to send (from flash)
  * @return Result, zero for success or non-zero for error
  */
 uint8_t send_keyglove_log(uint8_t level, uint8_t length, const __FlashStringHelper *message) {
-    uint8_t beginning[] = { 0x80, length + 1, 0xFF, 0xFF, level };
-    Serial.write(beginning, 5);
-    Serial.println((const __FlashStringHelper *)message);
-    return 0;
+    if (level > logLevel || length > 249) return 1;
+    char text[length];
+    memcpy_P(text, (const char *)message, length);
+    return send_keyglove_log(level, length, text);
 }
 
 /**
@@ -294,12 +468,12 @@ uint8_t send_keyglove_log(uint8_t level, uint8_t length, const __FlashStringHelp
 uint8_t queue_keyglove_packet(uint8_t packetType, uint8_t payloadLength, uint8_t packetClass, uint8_t packetId, uint8_t *payload) {
     uint8_t packetLength = payloadLength + 4;
     if (txQueueSize == 0) {
-        if (!(txQueue = (uint8_t *)malloc(384))) {
+        if (!(txQueue = (uint8_t *)memory_malloc(KG_SYSTEM_MEMORY_SUBSYSTEM_PROTOCOL_TX, 384))) {
             return 1; // couldn't allocate block of memory
         }
         txQueueSize = 384;
     } else if (txQueueSize + packetLength > txQueueSize) {
-        if (!(txQueue = (uint8_t *)realloc(txQueue, txQueueSize + packetLength + 64))) {
+        if (!(txQueue = (uint8_t *)memory_realloc(KG_SYSTEM_MEMORY_SUBSYSTEM_PROTOCOL_TX, txQueue, txQueueSize + packetLength + 64))) {
             return 2; // couldn't re-allocate bigger block of memory
         }
         txQueueSize += packetLength + 64;
@@ -334,8 +508,14 @@ uint8_t send_keyglove_packet(uint8_t packetType, uint8_t payloadLength, uint8_t
     // filter outgoing packets for custom behavior
     if (filter_outgoing_keyglove_packet(&packetType, &payloadLength, &packetClass, &packetId, payload)) return 255;
 
+    // subsystem events get a timestamp appended if the host asked for one
+    uint8_t timestampMode = 0;
+    if (protocolTimestampMode && packetType == KG_PACKET_TYPE_EVENT && packetClass != KG_PACKET_CLASS_PROTOCOL && packetClass != KG_PACKET_CLASS_LOG && payloadLength <= 246) {
+        timestampMode = protocolTimestampMode;
+    }
+
     // allocate and check full packet buffer
-    uint8_t *buffer = (uint8_t *)malloc(4 + payloadLength);
+    uint8_t *buffer = (uint8_t *)memory_malloc(KG_SYSTEM_MEMORY_SUBSYSTEM_PROTOCOL_TX, 4 + payloadLength + (timestampMode ? 4 : 0));
     if (buffer == 0) {
         // couldn't allocate packet buffer...uh oh
         return 2;
@@ -344,27 +524,45 @@ uint8_t send_keyglove_packet(uint8_t packetType, uint8_t payloadLength, uint8_t
     // certain outgoing packets should only be sent on one specific interface, the last one which was used
     uint8_t specificInterface = (packetType != KG_PACKET_TYPE_EVENT || packetClass == KG_PACKET_CLASS_PROTOCOL);
 
+    // log data only goes to interfaces which want it
+    uint8_t outgoingMode = (packetClass == KG_PACKET_CLASS_LOG ? KG_INTERFACE_MODE_OUTGOING_LOG : KG_INTERFACE_MODE_OUTGOING_API);
+
     buffer[0] = packetType;
+    if (packetType == KG_PACKET_TYPE_COMMAND || packetClass == KG_PACKET_CLASS_PROTOCOL) {
+        // responses, and protocol errors caused by a tagged command, carry that command's tag
+        buffer[0] |= protocolCommandTag;
+    }
     buffer[1] = payloadLength;
     buffer[2] = packetClass;
     buffer[3] = packetId;
     if (payloadLength) memcpy(buffer + 4, payload, payloadLength);
     uint8_t length = 4 + payloadLength;
 
+    if (timestampMode) {
+        // event tag bits hold the mode, and the length byte covers the timestamp
+        uint32_t timestamp = timestampMode == KG_SYSTEM_TIMESTAMP_MODE_TICKS ? keygloveTock * 100 + keygloveTick : micros();
+        buffer[0] |= timestampMode << 3;
+        buffer[1] = payloadLength + 4;
+        buffer[length++] = timestamp & 0xFF;
+        buffer[length++] = (timestamp >> 8) & 0xFF;
+        buffer[length++] = (timestamp >> 16) & 0xFF;
+        buffer[length++] = timestamp >> 24;
+    }
+
     #if KG_HOSTIF & KG_HOSTIF_USB_SERIAL
-        if (!specificInterface || lastCommandInterfaceNum == KG_INTERFACENUM_USB_SERIAL) {
+        if (specificInterface ? lastCommandInterfaceNum == KG_INTERFACENUM_USB_SERIAL : protocol_event_allowed(KG_INTERFACENUM_USB_SERIAL, packetClass, packetId)) {
             // send packet out over wired serial (USB virtual serial)
-            if (interfaceUSBSerialReady && (interfaceUSBSerialMode & KG_INTERFACE_MODE_OUTGOING_API) != 0) {
+            if (interfaceUSBSerialReady && (interfaceUSBSerialMode & outgoingMode) != 0) {
                 USBSerial.write((const uint8_t *)buffer, length); // packet data
             }
         }
     #endif
 
     #if KG_HOSTIF & KG_HOSTIF_USB_RAWHID
-        if (!specificInterface || lastCommandInterfaceNum == KG_INTERFACENUM_USB_RAWHID) {
+        if (specificInterface ? lastCommandInterfaceNum == KG_INTERFACENUM_USB_RAWHID : protocol_event_allowed(KG_INTERFACENUM_USB_RAWHID, packetClass, packetId)) {
             // send packet out over wired custom HID interface (USB raw HID)
             // 64-byte packets, formatted where byte 0 is [0-64] and bytes 1-63 are data
-            if (interfaceUSBRawHIDReady && (interfaceUSBRawHIDMode & KG_INTERFACE_MODE_OUTGOING_API) != 0) {
+            if (interfaceUSBRawHIDReady && (interfaceUSBRawHIDMode & outgoingMode) != 0) {
                 int8_t bytes;
                 for (uint8_t i = 0; i < length; i += (USB_RAWHID_TX_SIZE - 1)) {
                     memset(txRawHIDPacket, 0, USB_RAWHID_TX_SIZE);
@@ -387,7 +585,7 @@ uint8_t send_keyglove_packet(uint8_t packetType, uint8_t payloadLength, uint8_t
     // KG_HID_KEYBOARD and KG_HID_MOUSE are handled elsewhere and deal with other kinds of data
     
     // tidy up!
-    free(buffer);
+    memory_free(KG_SYSTEM_MEMORY_SUBSYSTEM_PROTOCOL_TX, buffer);
 
     return 0;
 }
@@ -409,7 +607,7 @@ uint16_t send_keyglove_queue() {
             // queue is empty, free up the memory
             txQueueLength = 0;
             txQueueSize = 0;
-            free(txQueue);
+            memory_free(KG_SYSTEM_MEMORY_SUBSYSTEM_PROTOCOL_TX, txQueue);
         }
     }
     return txQueueLength;
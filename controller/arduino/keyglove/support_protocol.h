@@ -44,11 +44,15 @@ THE SOFTWARE.
 #include "support_protocol_pressure.h"
 #include "support_protocol_touchset.h"
 #include "custom_protocol.h"
+#include "support_log.h"
+#include "support_memory.h"
 
 #define KG_PROTOCOL_RX_TIMEOUT                  500     ///< Number of milliseconds before KGAPI parser will timeout after an incomplete packet
+#define KG_PROTOCOL_QUEUE_DEPTH                 4       ///< Number of received commands which may wait to be run
 
 #define KG_PACKET_TYPE_EVENT                    0x80    ///< First byte in header of an event packet
 #define KG_PACKET_TYPE_COMMAND                  0xC0    ///< First byte in header of a command or response packet
+#define KG_PACKET_TAG_MASK                      0x38    ///< Header bits holding the optional command tag (1-7) echoed in the response
 
 #define KG_PACKET_CLASS_PROTOCOL                0x00
 #define KG_PACKET_CLASS_SYSTEM                  0x01
@@ -59,12 +63,7 @@ THE SOFTWARE.
 #define KG_PACKET_CLASS_FLEX                    0x06
 #define KG_PACKET_CLASS_PRESSURE                0x07
 #define KG_PACKET_CLASS_TOUCHSET                0x08
-
-#define KG_LOG_LEVEL_PANIC                      0       ///< Log level for "What a Terrible Failure" problems that will lock the MCU
-#define KG_LOG_LEVEL_CRITICAL                   1       ///< Log level for critical issues that will break core functionality
-#define KG_LOG_LEVEL_WARNING                    3       ///< Log level for warnings that may impact certain subsystems
-#define KG_LOG_LEVEL_NORMAL                     5       ///< Log level for regular status updates
-#define KG_LOG_LEVEL_VERBOSE                    9       ///< Log level for extra detailed info
+#define KG_PACKET_CLASS_COUNT                   0x09    ///< One more than the highest built-in class ID (sizes per-class tables)
 
 // ------------------------------------------------------------------
 // -------- API packets below are built into the core system --------
@@ -88,8 +87,30 @@ THE SOFTWARE.
 #define KG_PROTOCOL_ERROR_PARAMETER_LENGTH                  0x0004
 #define KG_PROTOCOL_ERROR_PARAMETER_RANGE                   0x0005
 #define KG_PROTOCOL_ERROR_NOT_IMPLEMENTED                   0x0006
+#define KG_PROTOCOL_ERROR_BUSY                              0x0007
 #define KG_PROTOCOL_ERROR_NULL_POINTER                      0xADDE
 
+// "system" class values used by the core (the generated support_protocol_system.h has no enumerations)
+
+#define KG_SYSTEM_RESET_MODE_NORMAL                         0x01    ///< Reset all components (e.g. core, motion, Bluetooth)
+#define KG_SYSTEM_RESET_MODE_KGONLY                         0x02    ///< Reset only core Keyglove board
+
+#define KG_SYSTEM_TIMESTAMP_MODE_NONE                       0x00    ///< Events carry no timestamp
+#define KG_SYSTEM_TIMESTAMP_MODE_TICKS                      0x01    ///< Append 10ms ticks since boot to each event
+#define KG_SYSTEM_TIMESTAMP_MODE_MICROSECONDS               0x02    ///< Append micros() to each event
+
+#define KG_CAPABILITY_CATEGORY_PLATFORM                     0x01    ///< Platform information (controller board)
+#define KG_CAPABILITY_CATEGORY_HOSTIF                       0x02    ///< Host interface information (USB, Bluetooth, etc.)
+#define KG_CAPABILITY_CATEGORY_FEEDBACK                     0x03    ///< Feedback subsystem informaiton
+#define KG_CAPABILITY_CATEGORY_TOUCH                        0x04    ///< Touch subsystem information
+#define KG_CAPABILITY_CATEGORY_MOTION                       0x05    ///< Motion subsystem information
+#define KG_CAPABILITY_CATEGORY_FLEX                         0x06    ///< Flex subsystem information
+#define KG_CAPABILITY_CATEGORY_PRESSURE                     0x07    ///< Pressure subsystem information
+
+#define KG_SYSTEM_MEMORY_SUBSYSTEM_PROTOCOL_RX              0x00    ///< KGAPI command parser and command queue buffers
+#define KG_SYSTEM_MEMORY_SUBSYSTEM_PROTOCOL_TX              0x01    ///< KGAPI outgoing packet and packet queue buffers
+#define KG_SYSTEM_MEMORY_SUBSYSTEM_BLUETOOTH                0x02    ///< Bluetooth pairing records and iWRAP command buffers
+
 // ------------------------------------------------------------------
 // ------------------------------------------------------------------
 // ------------------------------------------------------------------
@@ -99,6 +120,16 @@ THE SOFTWARE.
     #define USB_RAWHID_RX_SIZE 64                   ///< Payload byte count of incoming raw HID report over USB
 #endif
 
+/**
+ * @brief Event subscription and rate limit settings for one interface and class
+ */
+typedef struct protocol_event_filter_t {
+    uint16_t mask;                              ///< Subscribed event IDs (bit N set = event ID N is sent)
+    uint16_t rate_ids;                          ///< Event IDs the interval applies to
+    uint8_t interval;                           ///< Shortest time between rate-limited events (10ms ticks, 0 = no limit)
+    uint16_t last;                              ///< Tick count when the last rate-limited event was sent
+} protocol_event_filter_t;
+
 // custom protocol function prototypes
 uint8_t filter_incoming_keyglove_packet(uint8_t *rxPacket);
 uint8_t filter_outgoing_keyglove_packet(uint8_t *packetType, uint8_t *payloadLength, uint8_t *packetClass, uint8_t *packetId, uint8_t *payload);
@@ -120,10 +151,17 @@ extern uint8_t binDataLength;
 extern uint8_t skipPacket;
 
 extern uint8_t lastCommandInterfaceNum;
+extern uint8_t protocolCommandTag;
+extern uint8_t protocolTimestampMode;
+extern protocol_event_filter_t protocolEventFilter[KG_INTERFACENUM_COUNT][KG_PACKET_CLASS_COUNT];
 extern uint8_t systemResetFlags;
 
 void setup_protocol();
+uint8_t protocol_event_allowed(uint8_t interfaceNum, uint8_t packetClass, uint8_t packetId);
 void protocol_parse(uint8_t inputByte);
+void process_protocol_packet(uint8_t *rxPacket);
+void protocol_queue_rx_packet();
+uint8_t process_protocol_queue();
 uint16_t reset_keyglove_rx_packet();
 uint8_t check_incoming_protocol_data();
 uint8_t send_keyglove_log(uint8_t level, uint8_t length, const char *message);
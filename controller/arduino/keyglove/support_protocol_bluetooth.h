@@ -1,5 +1,5 @@
 // Keyglove controller source code - KGAPI "bluetooth" protocol command parser declarations
-// 2014-12-07 by Jeff Rowberg <jeff@rowberg.net>
+// 2014-12-20 by Jeff Rowberg <jeff@rowberg.net>
 
 /*
 ================================================================================
@@ -31,7 +31,7 @@ THE SOFTWARE.
  * @file support_protocol_bluetooth.h
  * @brief KGAPI "bluetooth" protocol command parser declarations
  * @author Jeff Rowberg
- * @date 2014-12-07
+ * @date 2014-12-20
  *
  * This file implements subsystem-specific command processing functions for the
  * "bluetooth" part of the KGAPI protocol.
@@ -1,5 +1,5 @@
 // Keyglove controller source code - KGAPI "feedback" protocol command parser implementation
-// 2014-12-07 by Jeff Rowberg <jeff@rowberg.net>
+// 2014-12-20 by Jeff Rowberg <jeff@rowberg.net>
 
 /*
 ================================================================================
@@ -31,7 +31,7 @@ THE SOFTWARE.
  * @file support_protocol_feedback.cpp
  * @brief KGAPI "feedback" protocol command parser implementation
  * @author Jeff Rowberg
- * @date 2014-12-07
+ * @date 2014-12-20
  *
  * This file implements subsystem-specific command processing functions for the
  * "feedback" part of the KGAPI protocol.
@@ -56,6 +56,8 @@ THE SOFTWARE.
  * @see KGAPI command: kg_cmd_feedback_set_vibrate_mode()
  * @see KGAPI command: kg_cmd_feedback_get_rgb_mode()
  * @see KGAPI command: kg_cmd_feedback_set_rgb_mode()
+ * @see KGAPI command: kg_cmd_feedback_set_custom_pattern()
+ * @see KGAPI command: kg_cmd_feedback_play_pattern()
  */
 uint8_t process_protocol_command_feedback(uint8_t *rxPacket) {
     // check for valid command IDs
@@ -230,6 +232,42 @@ uint8_t process_protocol_command_feedback(uint8_t *rxPacket) {
             break;
         #endif // KG_FEEDBACK & KG_FEEDBACK_RGB
         
+        case KG_PACKET_ID_CMD_FEEDBACK_SET_CUSTOM_PATTERN: // 0x09
+            // feedback_set_custom_pattern(uint8_t index, uint8_t[] segments)(uint16_t result)
+            // parameters = 2 bytes
+            if (rxPacket[1] < 2 || rxPacket[1] != 2 + rxPacket[5]) {
+                // incorrect parameter length
+                protocol_error = KG_PROTOCOL_ERROR_PARAMETER_LENGTH;
+            } else {
+                // run command
+                uint16_t result = kg_cmd_feedback_set_custom_pattern(rxPacket[4], rxPacket[5], rxPacket + 6);
+        
+                // build response
+                uint8_t payload[2] = { result & 0xFF, (result >> 8) & 0xFF };
+        
+                // send response
+                send_keyglove_packet(KG_PACKET_TYPE_COMMAND, 2, rxPacket[2], rxPacket[3], payload);
+            }
+            break;
+        
+        case KG_PACKET_ID_CMD_FEEDBACK_PLAY_PATTERN: // 0x0A
+            // feedback_play_pattern(uint8_t output, uint8_t pattern, uint8_t duration)(uint16_t result)
+            // parameters = 3 bytes
+            if (rxPacket[1] != 3) {
+                // incorrect parameter length
+                protocol_error = KG_PROTOCOL_ERROR_PARAMETER_LENGTH;
+            } else {
+                // run command
+                uint16_t result = kg_cmd_feedback_play_pattern(rxPacket[4], rxPacket[5], rxPacket[6]);
+        
+                // build response
+                uint8_t payload[2] = { result & 0xFF, (result >> 8) & 0xFF };
+        
+                // send response
+                send_keyglove_packet(KG_PACKET_TYPE_COMMAND, 2, rxPacket[2], rxPacket[3], payload);
+            }
+            break;
+        
         default:
             protocol_error = KG_PROTOCOL_ERROR_INVALID_COMMAND;
     }
@@ -248,3 +286,4 @@ uint8_t process_protocol_command_feedback(uint8_t *rxPacket) {
 #if KG_FEEDBACK & KG_FEEDBACK_RGB
 /* 0x04 */ uint8_t (*kg_evt_feedback_rgb_mode)(uint8_t index, uint8_t mode_red, uint8_t mode_green, uint8_t mode_blue);
 #endif // KG_FEEDBACK & KG_FEEDBACK_RGB
+/* 0x05 */ uint8_t (*kg_evt_feedback_pattern)(uint8_t output, uint8_t pattern, uint8_t duration);
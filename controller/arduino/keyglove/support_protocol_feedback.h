@@ -1,5 +1,5 @@
 // Keyglove controller source code - KGAPI "feedback" protocol command parser declarations
-// 2014-12-07 by Jeff Rowberg <jeff@rowberg.net>
+// 2014-12-20 by Jeff Rowberg <jeff@rowberg.net>
 
 /*
 ================================================================================
@@ -31,7 +31,7 @@ THE SOFTWARE.
  * @file support_protocol_feedback.h
  * @brief KGAPI "feedback" protocol command parser declarations
  * @author Jeff Rowberg
- * @date 2014-12-07
+ * @date 2014-12-20
  *
  * This file implements subsystem-specific command processing functions for the
  * "feedback" part of the KGAPI protocol.
@@ -54,11 +54,14 @@ THE SOFTWARE.
 #define KG_PACKET_ID_CMD_FEEDBACK_SET_VIBRATE_MODE          0x06
 #define KG_PACKET_ID_CMD_FEEDBACK_GET_RGB_MODE              0x07
 #define KG_PACKET_ID_CMD_FEEDBACK_SET_RGB_MODE              0x08
+#define KG_PACKET_ID_CMD_FEEDBACK_SET_CUSTOM_PATTERN        0x09
+#define KG_PACKET_ID_CMD_FEEDBACK_PLAY_PATTERN              0x0A
 // -- command/event split --
 #define KG_PACKET_ID_EVT_FEEDBACK_BLINK_MODE                0x01
 #define KG_PACKET_ID_EVT_FEEDBACK_PIEZO_MODE                0x02
 #define KG_PACKET_ID_EVT_FEEDBACK_VIBRATE_MODE              0x03
 #define KG_PACKET_ID_EVT_FEEDBACK_RGB_MODE                  0x04
+#define KG_PACKET_ID_EVT_FEEDBACK_PATTERN                   0x05
 
 /* ================================ */
 /* KGAPI COMMAND/EVENT DECLARATIONS */
@@ -88,6 +91,8 @@ THE SOFTWARE.
 #if KG_FEEDBACK & KG_FEEDBACK_RGB
 /* 0x08 */ uint16_t kg_cmd_feedback_set_rgb_mode(uint8_t index, uint8_t mode_red, uint8_t mode_green, uint8_t mode_blue);
 #endif // KG_FEEDBACK & KG_FEEDBACK_RGB
+/* 0x09 */ uint16_t kg_cmd_feedback_set_custom_pattern(uint8_t index, uint8_t segments_len, uint8_t *segments_data);
+/* 0x0A */ uint16_t kg_cmd_feedback_play_pattern(uint8_t output, uint8_t pattern, uint8_t duration);
 // -- command/event split --
 #if KG_FEEDBACK & KG_FEEDBACK_BLINK
 /* 0x01 */ extern uint8_t (*kg_evt_feedback_blink_mode)(uint8_t mode);
@@ -101,6 +106,7 @@ THE SOFTWARE.
 #if KG_FEEDBACK & KG_FEEDBACK_RGB
 /* 0x04 */ extern uint8_t (*kg_evt_feedback_rgb_mode)(uint8_t index, uint8_t mode_red, uint8_t mode_green, uint8_t mode_blue);
 #endif // KG_FEEDBACK & KG_FEEDBACK_RGB
+/* 0x05 */ extern uint8_t (*kg_evt_feedback_pattern)(uint8_t output, uint8_t pattern, uint8_t duration);
 
 uint8_t process_protocol_command_feedback(uint8_t *rxPacket);
 
@@ -1,5 +1,5 @@
 // Keyglove controller source code - KGAPI "flex" protocol command parser implementation
-// 2014-12-07 by Jeff Rowberg <jeff@rowberg.net>
+// 2014-12-20 by Jeff Rowberg <jeff@rowberg.net>
 
 /*
 ================================================================================
@@ -31,7 +31,7 @@ THE SOFTWARE.
  * @file support_protocol_flex.cpp
  * @brief KGAPI "flex" protocol command parser implementation
  * @author Jeff Rowberg
- * @date 2014-12-07
+ * @date 2014-12-20
  *
  * This file implements subsystem-specific command processing functions for the
  * "flex" part of the KGAPI protocol.
@@ -48,11 +48,90 @@ THE SOFTWARE.
  * @param[in] rxPacket Incoming KGAPI packet buffer
  * @return Protocol error, if any (0 for success)
  * @see protocol_parse()
+ * @see KGAPI command: kg_cmd_flex_get_value()
+ * @see KGAPI command: kg_cmd_flex_calibrate()
+ * @see KGAPI command: kg_cmd_flex_get_calibration()
+ * @see KGAPI command: kg_cmd_flex_set_calibration()
  */
 uint8_t process_protocol_command_flex(uint8_t *rxPacket) {
     // check for valid command IDs
     uint8_t protocol_error = 0;
     switch (rxPacket[3]) {
+        case KG_PACKET_ID_CMD_FLEX_GET_VALUE: // 0x01
+            // flex_get_value(uint8_t index)(uint16_t result, uint8_t value, uint16_t raw)
+            // parameters = 1 byte
+            if (rxPacket[1] != 1) {
+                // incorrect parameter length
+                protocol_error = KG_PROTOCOL_ERROR_PARAMETER_LENGTH;
+            } else {
+                // run command
+                uint8_t value;
+                uint16_t raw;
+                uint16_t result = kg_cmd_flex_get_value(rxPacket[4], &value, &raw);
+        
+                // build response
+                uint8_t payload[5] = { result & 0xFF, (result >> 8) & 0xFF, value, raw & 0xFF, (raw >> 8) & 0xFF };
+        
+                // send response
+                send_keyglove_packet(KG_PACKET_TYPE_COMMAND, 5, rxPacket[2], rxPacket[3], payload);
+            }
+            break;
+        
+        case KG_PACKET_ID_CMD_FLEX_CALIBRATE: // 0x02
+            // flex_calibrate(uint8_t mode)(uint16_t result)
+            // parameters = 1 byte
+            if (rxPacket[1] != 1) {
+                // incorrect parameter length
+                protocol_error = KG_PROTOCOL_ERROR_PARAMETER_LENGTH;
+            } else {
+                // run command
+                uint16_t result = kg_cmd_flex_calibrate(rxPacket[4]);
+        
+                // build response
+                uint8_t payload[2] = { result & 0xFF, (result >> 8) & 0xFF };
+        
+                // send response
+                send_keyglove_packet(KG_PACKET_TYPE_COMMAND, 2, rxPacket[2], rxPacket[3], payload);
+            }
+            break;
+        
+        case KG_PACKET_ID_CMD_FLEX_GET_CALIBRATION: // 0x03
+            // flex_get_calibration(uint8_t index)(uint16_t result, uint16_t min, uint16_t max)
+            // parameters = 1 byte
+            if (rxPacket[1] != 1) {
+                // incorrect parameter length
+                protocol_error = KG_PROTOCOL_ERROR_PARAMETER_LENGTH;
+            } else {
+                // run command
+                uint16_t min;
+                uint16_t max;
+                uint16_t result = kg_cmd_flex_get_calibration(rxPacket[4], &min, &max);
+        
+                // build response
+                uint8_t payload[6] = { result & 0xFF, (result >> 8) & 0xFF, min & 0xFF, (min >> 8) & 0xFF, max & 0xFF, (max >> 8) & 0xFF };
+        
+                // send response
+                send_keyglove_packet(KG_PACKET_TYPE_COMMAND, 6, rxPacket[2], rxPacket[3], payload);
+            }
+            break;
+        
+        case KG_PACKET_ID_CMD_FLEX_SET_CALIBRATION: // 0x04
+            // flex_set_calibration(uint8_t index, uint16_t min, uint16_t max)(uint16_t result)
+            // parameters = 5 bytes
+            if (rxPacket[1] != 5) {
+                // incorrect parameter length
+                protocol_error = KG_PROTOCOL_ERROR_PARAMETER_LENGTH;
+            } else {
+                // run command
+                uint16_t result = kg_cmd_flex_set_calibration(rxPacket[4], rxPacket[5] | (rxPacket[6] << 8), rxPacket[7] | (rxPacket[8] << 8));
+        
+                // build response
+                uint8_t payload[2] = { result & 0xFF, (result >> 8) & 0xFF };
+        
+                // send response
+                send_keyglove_packet(KG_PACKET_TYPE_COMMAND, 2, rxPacket[2], rxPacket[3], payload);
+            }
+            break;
         
         default:
             protocol_error = KG_PROTOCOL_ERROR_INVALID_COMMAND;
@@ -60,4 +139,4 @@ uint8_t process_protocol_command_flex(uint8_t *rxPacket) {
     return protocol_error;
 }
 
-
+/* 0x01 */ uint8_t (*kg_evt_flex_value)(uint8_t index, uint8_t value);
@@ -1,5 +1,5 @@
 // Keyglove controller source code - KGAPI "flex" protocol command parser declarations
-// 2014-12-07 by Jeff Rowberg <jeff@rowberg.net>
+// 2014-12-20 by Jeff Rowberg <jeff@rowberg.net>
 
 /*
 ================================================================================
@@ -31,7 +31,7 @@ THE SOFTWARE.
  * @file support_protocol_flex.h
  * @brief KGAPI "flex" protocol command parser declarations
  * @author Jeff Rowberg
- * @date 2014-12-07
+ * @date 2014-12-20
  *
  * This file implements subsystem-specific command processing functions for the
  * "flex" part of the KGAPI protocol.
@@ -46,17 +46,23 @@ THE SOFTWARE.
 /* KGAPI CONSTANT DECLARATIONS */
 /* =========================== */
 
-
+#define KG_PACKET_ID_CMD_FLEX_GET_VALUE                     0x01
+#define KG_PACKET_ID_CMD_FLEX_CALIBRATE                     0x02
+#define KG_PACKET_ID_CMD_FLEX_GET_CALIBRATION               0x03
+#define KG_PACKET_ID_CMD_FLEX_SET_CALIBRATION               0x04
 // -- command/event split --
-
+#define KG_PACKET_ID_EVT_FLEX_VALUE                         0x01
 
 /* ================================ */
 /* KGAPI COMMAND/EVENT DECLARATIONS */
 /* ================================ */
 
-
+/* 0x01 */ uint16_t kg_cmd_flex_get_value(uint8_t index, uint8_t *value, uint16_t *raw);
+/* 0x02 */ uint16_t kg_cmd_flex_calibrate(uint8_t mode);
+/* 0x03 */ uint16_t kg_cmd_flex_get_calibration(uint8_t index, uint16_t *min, uint16_t *max);
+/* 0x04 */ uint16_t kg_cmd_flex_set_calibration(uint8_t index, uint16_t min, uint16_t max);
 // -- command/event split --
-
+/* 0x01 */ extern uint8_t (*kg_evt_flex_value)(uint8_t index, uint8_t value);
 
 uint8_t process_protocol_command_flex(uint8_t *rxPacket);
 
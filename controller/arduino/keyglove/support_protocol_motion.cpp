@@ -1,5 +1,5 @@
 // Keyglove controller source code - KGAPI "motion" protocol command parser implementation
-// 2014-12-07 by Jeff Rowberg <jeff@rowberg.net>
+// 2014-12-20 by Jeff Rowberg <jeff@rowberg.net>
 
 /*
 ================================================================================
@@ -31,7 +31,7 @@ THE SOFTWARE.
  * @file support_protocol_motion.cpp
  * @brief KGAPI "motion" protocol command parser implementation
  * @author Jeff Rowberg
- * @date 2014-12-07
+ * @date 2014-12-20
  *
  * This file implements subsystem-specific command processing functions for the
  * "motion" part of the KGAPI protocol.
@@ -50,6 +50,9 @@ THE SOFTWARE.
  * @see protocol_parse()
  * @see KGAPI command: kg_cmd_motion_get_mode()
  * @see KGAPI command: kg_cmd_motion_set_mode()
+ * @see KGAPI command: kg_cmd_motion_calibrate()
+ * @see KGAPI command: kg_cmd_motion_get_config()
+ * @see KGAPI command: kg_cmd_motion_set_config()
  */
 uint8_t process_protocol_command_motion(uint8_t *rxPacket) {
     // check for valid command IDs
@@ -92,6 +95,66 @@ uint8_t process_protocol_command_motion(uint8_t *rxPacket) {
             }
             break;
         
+        case KG_PACKET_ID_CMD_MOTION_CALIBRATE: // 0x03
+            // motion_calibrate(uint8_t index, uint8_t flags)(uint16_t result)
+            // parameters = 2 bytes
+            if (rxPacket[1] != 2) {
+                // incorrect parameter length
+                protocol_error = KG_PROTOCOL_ERROR_PARAMETER_LENGTH;
+            } else {
+                // run command
+                uint16_t result = kg_cmd_motion_calibrate(rxPacket[4], rxPacket[5]);
+        
+                // build response
+                uint8_t payload[2] = { result & 0xFF, (result >> 8) & 0xFF };
+        
+                // send response
+                send_keyglove_packet(KG_PACKET_TYPE_COMMAND, 2, rxPacket[2], rxPacket[3], payload);
+            }
+            break;
+        
+        case KG_PACKET_ID_CMD_MOTION_GET_CONFIG: // 0x04
+            // motion_get_config(uint8_t index)(uint16_t result, uint16_t rate, uint8_t accel_range, uint8_t gyro_range, uint8_t filter, uint8_t encoding, uint16_t stream_rate)
+            // parameters = 1 byte
+            if (rxPacket[1] != 1) {
+                // incorrect parameter length
+                protocol_error = KG_PROTOCOL_ERROR_PARAMETER_LENGTH;
+            } else {
+                // run command
+                uint16_t rate;
+                uint8_t accel_range;
+                uint8_t gyro_range;
+                uint8_t filter;
+                uint8_t encoding;
+                uint16_t stream_rate;
+                uint16_t result = kg_cmd_motion_get_config(rxPacket[4], &rate, &accel_range, &gyro_range, &filter, &encoding, &stream_rate);
+        
+                // build response
+                uint8_t payload[10] = { result & 0xFF, (result >> 8) & 0xFF, rate & 0xFF, (rate >> 8) & 0xFF, accel_range, gyro_range, filter, encoding, stream_rate & 0xFF, (stream_rate >> 8) & 0xFF };
+        
+                // send response
+                send_keyglove_packet(KG_PACKET_TYPE_COMMAND, 10, rxPacket[2], rxPacket[3], payload);
+            }
+            break;
+        
+        case KG_PACKET_ID_CMD_MOTION_SET_CONFIG: // 0x05
+            // motion_set_config(uint8_t index, uint16_t rate, uint8_t accel_range, uint8_t gyro_range, uint8_t filter, uint8_t encoding, uint16_t stream_rate)(uint16_t result)
+            // parameters = 9 bytes
+            if (rxPacket[1] != 9) {
+                // incorrect parameter length
+                protocol_error = KG_PROTOCOL_ERROR_PARAMETER_LENGTH;
+            } else {
+                // run command
+                uint16_t result = kg_cmd_motion_set_config(rxPacket[4], rxPacket[5] | (rxPacket[6] << 8), rxPacket[7], rxPacket[8], rxPacket[9], rxPacket[10], rxPacket[11] | (rxPacket[12] << 8));
+        
+                // build response
+                uint8_t payload[2] = { result & 0xFF, (result >> 8) & 0xFF };
+        
+                // send response
+                send_keyglove_packet(KG_PACKET_TYPE_COMMAND, 2, rxPacket[2], rxPacket[3], payload);
+            }
+            break;
+        
         default:
             protocol_error = KG_PROTOCOL_ERROR_INVALID_COMMAND;
     }
@@ -101,3 +164,6 @@ uint8_t process_protocol_command_motion(uint8_t *rxPacket) {
 /* 0x01 */ uint8_t (*kg_evt_motion_mode)(uint8_t index, uint8_t mode);
 /* 0x02 */ uint8_t (*kg_evt_motion_data)(uint8_t index, uint8_t flags, uint8_t data_len, uint8_t *data_data);
 /* 0x03 */ uint8_t (*kg_evt_motion_state)(uint8_t index, uint8_t state);
+/* 0x04 */ uint8_t (*kg_evt_motion_calibration)(uint8_t index, uint8_t status, uint8_t progress);
+/* 0x05 */ uint8_t (*kg_evt_motion_gesture)(uint8_t index, uint8_t gesture, uint8_t axis, uint8_t strength);
+/* 0x06 */ uint8_t (*kg_evt_motion_config)(uint8_t index, uint16_t rate, uint8_t accel_range, uint8_t gyro_range, uint8_t filter, uint8_t encoding, uint16_t stream_rate);
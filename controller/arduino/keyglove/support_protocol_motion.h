@@ -1,5 +1,5 @@
 // Keyglove controller source code - KGAPI "motion" protocol command parser declarations
-// 2014-12-07 by Jeff Rowberg <jeff@rowberg.net>
+// 2014-12-20 by Jeff Rowberg <jeff@rowberg.net>
 
 /*
 ================================================================================
@@ -31,7 +31,7 @@ THE SOFTWARE.
  * @file support_protocol_motion.h
  * @brief KGAPI "motion" protocol command parser declarations
  * @author Jeff Rowberg
- * @date 2014-12-07
+ * @date 2014-12-20
  *
  * This file implements subsystem-specific command processing functions for the
  * "motion" part of the KGAPI protocol.
@@ -48,10 +48,16 @@ THE SOFTWARE.
 
 #define KG_PACKET_ID_CMD_MOTION_GET_MODE                    0x01
 #define KG_PACKET_ID_CMD_MOTION_SET_MODE                    0x02
+#define KG_PACKET_ID_CMD_MOTION_CALIBRATE                   0x03
+#define KG_PACKET_ID_CMD_MOTION_GET_CONFIG                  0x04
+#define KG_PACKET_ID_CMD_MOTION_SET_CONFIG                  0x05
 // -- command/event split --
 #define KG_PACKET_ID_EVT_MOTION_MODE                        0x01
 #define KG_PACKET_ID_EVT_MOTION_DATA                        0x02
 #define KG_PACKET_ID_EVT_MOTION_STATE                       0x03
+#define KG_PACKET_ID_EVT_MOTION_CALIBRATION                 0x04
+#define KG_PACKET_ID_EVT_MOTION_GESTURE                     0x05
+#define KG_PACKET_ID_EVT_MOTION_CONFIG                      0x06
 
 /* ================================ */
 /* KGAPI COMMAND/EVENT DECLARATIONS */
@@ -59,10 +65,16 @@ THE SOFTWARE.
 
 /* 0x01 */ uint16_t kg_cmd_motion_get_mode(uint8_t index, uint8_t *mode);
 /* 0x02 */ uint16_t kg_cmd_motion_set_mode(uint8_t index, uint8_t mode);
+/* 0x03 */ uint16_t kg_cmd_motion_calibrate(uint8_t index, uint8_t flags);
+/* 0x04 */ uint16_t kg_cmd_motion_get_config(uint8_t index, uint16_t *rate, uint8_t *accel_range, uint8_t *gyro_range, uint8_t *filter, uint8_t *encoding, uint16_t *stream_rate);
+/* 0x05 */ uint16_t kg_cmd_motion_set_config(uint8_t index, uint16_t rate, uint8_t accel_range, uint8_t gyro_range, uint8_t filter, uint8_t encoding, uint16_t stream_rate);
 // -- command/event split --
 /* 0x01 */ extern uint8_t (*kg_evt_motion_mode)(uint8_t index, uint8_t mode);
 /* 0x02 */ extern uint8_t (*kg_evt_motion_data)(uint8_t index, uint8_t flags, uint8_t data_len, uint8_t *data_data);
 /* 0x03 */ extern uint8_t (*kg_evt_motion_state)(uint8_t index, uint8_t state);
+/* 0x04 */ extern uint8_t (*kg_evt_motion_calibration)(uint8_t index, uint8_t status, uint8_t progress);
+/* 0x05 */ extern uint8_t (*kg_evt_motion_gesture)(uint8_t index, uint8_t gesture, uint8_t axis, uint8_t strength);
+/* 0x06 */ extern uint8_t (*kg_evt_motion_config)(uint8_t index, uint16_t rate, uint8_t accel_range, uint8_t gyro_range, uint8_t filter, uint8_t encoding, uint16_t stream_rate);
 
 uint8_t process_protocol_command_motion(uint8_t *rxPacket);
 
@@ -1,5 +1,5 @@
 // Keyglove controller source code - KGAPI "pressure" protocol command parser implementation
-// 2014-12-07 by Jeff Rowberg <jeff@rowberg.net>
+// 2014-12-20 by Jeff Rowberg <jeff@rowberg.net>
 
 /*
 ================================================================================
@@ -31,7 +31,7 @@ THE SOFTWARE.
  * @file support_protocol_pressure.cpp
  * @brief KGAPI "pressure" protocol command parser implementation
  * @author Jeff Rowberg
- * @date 2014-12-07
+ * @date 2014-12-20
  *
  * This file implements subsystem-specific command processing functions for the
  * "pressure" part of the KGAPI protocol.
@@ -48,11 +48,74 @@ THE SOFTWARE.
  * @param[in] rxPacket Incoming KGAPI packet buffer
  * @return Protocol error, if any (0 for success)
  * @see protocol_parse()
+ * @see KGAPI command: kg_cmd_pressure_get_value()
+ * @see KGAPI command: kg_cmd_pressure_get_config()
+ * @see KGAPI command: kg_cmd_pressure_set_config()
  */
 uint8_t process_protocol_command_pressure(uint8_t *rxPacket) {
     // check for valid command IDs
     uint8_t protocol_error = 0;
     switch (rxPacket[3]) {
+        case KG_PACKET_ID_CMD_PRESSURE_GET_VALUE: // 0x01
+            // pressure_get_value(uint8_t index)(uint16_t result, uint8_t state, uint8_t value, uint8_t velocity, uint16_t raw)
+            // parameters = 1 byte
+            if (rxPacket[1] != 1) {
+                // incorrect parameter length
+                protocol_error = KG_PROTOCOL_ERROR_PARAMETER_LENGTH;
+            } else {
+                // run command
+                uint8_t state;
+                uint8_t value;
+                uint8_t velocity;
+                uint16_t raw;
+                uint16_t result = kg_cmd_pressure_get_value(rxPacket[4], &state, &value, &velocity, &raw);
+        
+                // build response
+                uint8_t payload[7] = { result & 0xFF, (result >> 8) & 0xFF, state, value, velocity, raw & 0xFF, (raw >> 8) & 0xFF };
+        
+                // send response
+                send_keyglove_packet(KG_PACKET_TYPE_COMMAND, 7, rxPacket[2], rxPacket[3], payload);
+            }
+            break;
+        
+        case KG_PACKET_ID_CMD_PRESSURE_GET_CONFIG: // 0x02
+            // pressure_get_config()(uint8_t press, uint8_t release, uint8_t deadband)
+            // parameters = 0 bytes
+            if (rxPacket[1] != 0) {
+                // incorrect parameter length
+                protocol_error = KG_PROTOCOL_ERROR_PARAMETER_LENGTH;
+            } else {
+                // run command
+                uint8_t press;
+                uint8_t release;
+                uint8_t deadband;
+                uint16_t result = kg_cmd_pressure_get_config(&press, &release, &deadband);
+        
+                // build response
+                uint8_t payload[3] = { press, release, deadband };
+        
+                // send response
+                send_keyglove_packet(KG_PACKET_TYPE_COMMAND, 3, rxPacket[2], rxPacket[3], payload);
+            }
+            break;
+        
+        case KG_PACKET_ID_CMD_PRESSURE_SET_CONFIG: // 0x03
+            // pressure_set_config(uint8_t press, uint8_t release, uint8_t deadband)(uint16_t result)
+            // parameters = 3 bytes
+            if (rxPacket[1] != 3) {
+                // incorrect parameter length
+                protocol_error = KG_PROTOCOL_ERROR_PARAMETER_LENGTH;
+            } else {
+                // run command
+                uint16_t result = kg_cmd_pressure_set_config(rxPacket[4], rxPacket[5], rxPacket[6]);
+        
+                // build response
+                uint8_t payload[2] = { result & 0xFF, (result >> 8) & 0xFF };
+        
+                // send response
+                send_keyglove_packet(KG_PACKET_TYPE_COMMAND, 2, rxPacket[2], rxPacket[3], payload);
+            }
+            break;
         
         default:
             protocol_error = KG_PROTOCOL_ERROR_INVALID_COMMAND;
@@ -60,4 +123,7 @@ uint8_t process_protocol_command_pressure(uint8_t *rxPacket) {
     return protocol_error;
 }
 
-
+/* 0x01 */ uint8_t (*kg_evt_pressure_press)(uint8_t index, uint8_t velocity, uint8_t peak);
+/* 0x02 */ uint8_t (*kg_evt_pressure_release)(uint8_t index);
+/* 0x03 */ uint8_t (*kg_evt_pressure_value)(uint8_t index, uint8_t value);
+/* 0x04 */ uint8_t (*kg_evt_pressure_config)(uint8_t press, uint8_t release, uint8_t deadband);
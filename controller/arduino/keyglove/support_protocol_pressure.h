@@ -1,5 +1,5 @@
 // Keyglove controller source code - KGAPI "pressure" protocol command parser declarations
-// 2014-12-07 by Jeff Rowberg <jeff@rowberg.net>
+// 2014-12-20 by Jeff Rowberg <jeff@rowberg.net>
 
 /*
 ================================================================================
@@ -31,7 +31,7 @@ THE SOFTWARE.
  * @file support_protocol_pressure.h
  * @brief KGAPI "pressure" protocol command parser declarations
  * @author Jeff Rowberg
- * @date 2014-12-07
+ * @date 2014-12-20
  *
  * This file implements subsystem-specific command processing functions for the
  * "pressure" part of the KGAPI protocol.
@@ -46,17 +46,27 @@ THE SOFTWARE.
 /* KGAPI CONSTANT DECLARATIONS */
 /* =========================== */
 
-
+#define KG_PACKET_ID_CMD_PRESSURE_GET_VALUE                 0x01
+#define KG_PACKET_ID_CMD_PRESSURE_GET_CONFIG                0x02
+#define KG_PACKET_ID_CMD_PRESSURE_SET_CONFIG                0x03
 // -- command/event split --
-
+#define KG_PACKET_ID_EVT_PRESSURE_PRESS                     0x01
+#define KG_PACKET_ID_EVT_PRESSURE_RELEASE                   0x02
+#define KG_PACKET_ID_EVT_PRESSURE_VALUE                     0x03
+#define KG_PACKET_ID_EVT_PRESSURE_CONFIG                    0x04
 
 /* ================================ */
 /* KGAPI COMMAND/EVENT DECLARATIONS */
 /* ================================ */
 
-
+/* 0x01 */ uint16_t kg_cmd_pressure_get_value(uint8_t index, uint8_t *state, uint8_t *value, uint8_t *velocity, uint16_t *raw);
+/* 0x02 */ uint16_t kg_cmd_pressure_get_config(uint8_t *press, uint8_t *release, uint8_t *deadband);
+/* 0x03 */ uint16_t kg_cmd_pressure_set_config(uint8_t press, uint8_t release, uint8_t deadband);
 // -- command/event split --
-
+/* 0x01 */ extern uint8_t (*kg_evt_pressure_press)(uint8_t index, uint8_t velocity, uint8_t peak);
+/* 0x02 */ extern uint8_t (*kg_evt_pressure_release)(uint8_t index);
+/* 0x03 */ extern uint8_t (*kg_evt_pressure_value)(uint8_t index, uint8_t value);
+/* 0x04 */ extern uint8_t (*kg_evt_pressure_config)(uint8_t press, uint8_t release, uint8_t deadband);
 
 uint8_t process_protocol_command_pressure(uint8_t *rxPacket);
 
@@ -1,5 +1,5 @@
 // Keyglove controller source code - KGAPI "system" protocol command parser implementation
-// 2014-12-14 by Jeff Rowberg <jeff@rowberg.net>
+// 2014-12-20 by Jeff Rowberg <jeff@rowberg.net>
 
 /*
 ================================================================================
@@ -31,7 +31,7 @@ THE SOFTWARE.
  * @file support_protocol_system.cpp
  * @brief KGAPI "system" protocol command parser implementation
  * @author Jeff Rowberg
- * @date 2014-12-14
+ * @date 2014-12-20
  *
  * This file implements subsystem-specific command processing functions for the
  * "system" part of the KGAPI protocol.
@@ -55,6 +55,19 @@ THE SOFTWARE.
  * @see KGAPI command: kg_cmd_system_get_memory()
  * @see KGAPI command: kg_cmd_system_get_battery_status()
  * @see KGAPI command: kg_cmd_system_set_timer()
+ * @see KGAPI command: kg_cmd_system_get_time()
+ * @see KGAPI command: kg_cmd_system_get_timestamp_mode()
+ * @see KGAPI command: kg_cmd_system_set_timestamp_mode()
+ * @see KGAPI command: kg_cmd_system_get_event_mask()
+ * @see KGAPI command: kg_cmd_system_set_event_mask()
+ * @see KGAPI command: kg_cmd_system_get_event_rate()
+ * @see KGAPI command: kg_cmd_system_set_event_rate()
+ * @see KGAPI command: kg_cmd_system_get_log_level()
+ * @see KGAPI command: kg_cmd_system_set_log_level()
+ * @see KGAPI command: kg_cmd_system_get_memory_stats()
+ * @see KGAPI command: kg_cmd_system_get_memory_allocations()
+ * @see KGAPI command: kg_cmd_system_get_memory_threshold()
+ * @see KGAPI command: kg_cmd_system_set_memory_threshold()
  */
 uint8_t process_protocol_command_system(uint8_t *rxPacket) {
     // check for valid command IDs
@@ -200,6 +213,258 @@ uint8_t process_protocol_command_system(uint8_t *rxPacket) {
             }
             break;
         
+        case KG_PACKET_ID_CMD_SYSTEM_GET_TIME: // 0x08
+            // system_get_time()(uint32_t seconds, uint8_t subticks, uint32_t microseconds)
+            // parameters = 0 bytes
+            if (rxPacket[1] != 0) {
+                // incorrect parameter length
+                protocol_error = KG_PROTOCOL_ERROR_PARAMETER_LENGTH;
+            } else {
+                // run command
+                uint32_t seconds;
+                uint8_t subticks;
+                uint32_t microseconds;
+                uint16_t result = kg_cmd_system_get_time(&seconds, &subticks, &microseconds);
+        
+                // build response
+                uint8_t payload[9] = { seconds & 0xFF, (seconds >> 8) & 0xFF, (seconds >> 16) & 0xFF, (seconds >> 24) & 0xFF, subticks, microseconds & 0xFF, (microseconds >> 8) & 0xFF, (microseconds >> 16) & 0xFF, (microseconds >> 24) & 0xFF };
+        
+                // send response
+                send_keyglove_packet(KG_PACKET_TYPE_COMMAND, 9, rxPacket[2], rxPacket[3], payload);
+            }
+            break;
+        
+        case KG_PACKET_ID_CMD_SYSTEM_GET_TIMESTAMP_MODE: // 0x09
+            // system_get_timestamp_mode()(uint8_t mode)
+            // parameters = 0 bytes
+            if (rxPacket[1] != 0) {
+                // incorrect parameter length
+                protocol_error = KG_PROTOCOL_ERROR_PARAMETER_LENGTH;
+            } else {
+                // run command
+                uint8_t mode;
+                uint16_t result = kg_cmd_system_get_timestamp_mode(&mode);
+        
+                // build response
+                uint8_t payload[1] = { mode };
+        
+                // send response
+                send_keyglove_packet(KG_PACKET_TYPE_COMMAND, 1, rxPacket[2], rxPacket[3], payload);
+            }
+            break;
+        
+        case KG_PACKET_ID_CMD_SYSTEM_SET_TIMESTAMP_MODE: // 0x0A
+            // system_set_timestamp_mode(uint8_t mode)(uint16_t result)
+            // parameters = 1 byte
+            if (rxPacket[1] != 1) {
+                // incorrect parameter length
+                protocol_error = KG_PROTOCOL_ERROR_PARAMETER_LENGTH;
+            } else {
+                // run command
+                uint16_t result = kg_cmd_system_set_timestamp_mode(rxPacket[4]);
+        
+                // build response
+                uint8_t payload[2] = { result & 0xFF, (result >> 8) & 0xFF };
+        
+                // send response
+                send_keyglove_packet(KG_PACKET_TYPE_COMMAND, 2, rxPacket[2], rxPacket[3], payload);
+            }
+            break;
+        
+        case KG_PACKET_ID_CMD_SYSTEM_GET_EVENT_MASK: // 0x0B
+            // system_get_event_mask(uint8_t interface, uint8_t event_class)(uint16_t result, uint16_t mask)
+            // parameters = 2 bytes
+            if (rxPacket[1] != 2) {
+                // incorrect parameter length
+                protocol_error = KG_PROTOCOL_ERROR_PARAMETER_LENGTH;
+            } else {
+                // run command
+                uint16_t mask;
+                uint16_t result = kg_cmd_system_get_event_mask(rxPacket[4], rxPacket[5], &mask);
+        
+                // build response
+                uint8_t payload[4] = { result & 0xFF, (result >> 8) & 0xFF, mask & 0xFF, (mask >> 8) & 0xFF };
+        
+                // send response
+                send_keyglove_packet(KG_PACKET_TYPE_COMMAND, 4, rxPacket[2], rxPacket[3], payload);
+            }
+            break;
+        
+        case KG_PACKET_ID_CMD_SYSTEM_SET_EVENT_MASK: // 0x0C
+            // system_set_event_mask(uint8_t interface, uint8_t event_class, uint16_t mask)(uint16_t result)
+            // parameters = 4 bytes
+            if (rxPacket[1] != 4) {
+                // incorrect parameter length
+                protocol_error = KG_PROTOCOL_ERROR_PARAMETER_LENGTH;
+            } else {
+                // run command
+                uint16_t result = kg_cmd_system_set_event_mask(rxPacket[4], rxPacket[5], rxPacket[6] | (rxPacket[7] << 8));
+        
+                // build response
+                uint8_t payload[2] = { result & 0xFF, (result >> 8) & 0xFF };
+        
+                // send response
+                send_keyglove_packet(KG_PACKET_TYPE_COMMAND, 2, rxPacket[2], rxPacket[3], payload);
+            }
+            break;
+        
+        case KG_PACKET_ID_CMD_SYSTEM_GET_EVENT_RATE: // 0x0D
+            // system_get_event_rate(uint8_t interface, uint8_t event_class)(uint16_t result, uint8_t interval, uint16_t ids)
+            // parameters = 2 bytes
+            if (rxPacket[1] != 2) {
+                // incorrect parameter length
+                protocol_error = KG_PROTOCOL_ERROR_PARAMETER_LENGTH;
+            } else {
+                // run command
+                uint8_t interval;
+                uint16_t ids;
+                uint16_t result = kg_cmd_system_get_event_rate(rxPacket[4], rxPacket[5], &interval, &ids);
+        
+                // build response
+                uint8_t payload[5] = { result & 0xFF, (result >> 8) & 0xFF, interval, ids & 0xFF, (ids >> 8) & 0xFF };
+        
+                // send response
+                send_keyglove_packet(KG_PACKET_TYPE_COMMAND, 5, rxPacket[2], rxPacket[3], payload);
+            }
+            break;
+        
+        case KG_PACKET_ID_CMD_SYSTEM_SET_EVENT_RATE: // 0x0E
+            // system_set_event_rate(uint8_t interface, uint8_t event_class, uint8_t interval, uint16_t ids)(uint16_t result)
+            // parameters = 5 bytes
+            if (rxPacket[1] != 5) {
+                // incorrect parameter length
+                protocol_error = KG_PROTOCOL_ERROR_PARAMETER_LENGTH;
+            } else {
+                // run command
+                uint16_t result = kg_cmd_system_set_event_rate(rxPacket[4], rxPacket[5], rxPacket[6], rxPacket[7] | (rxPacket[8] << 8));
+        
+                // build response
+                uint8_t payload[2] = { result & 0xFF, (result >> 8) & 0xFF };
+        
+                // send response
+                send_keyglove_packet(KG_PACKET_TYPE_COMMAND, 2, rxPacket[2], rxPacket[3], payload);
+            }
+            break;
+        
+        case KG_PACKET_ID_CMD_SYSTEM_GET_LOG_LEVEL: // 0x0F
+            // system_get_log_level()(uint8_t level)
+            // parameters = 0 bytes
+            if (rxPacket[1] != 0) {
+                // incorrect parameter length
+                protocol_error = KG_PROTOCOL_ERROR_PARAMETER_LENGTH;
+            } else {
+                // run command
+                uint8_t level;
+                uint16_t result = kg_cmd_system_get_log_level(&level);
+        
+                // build response
+                uint8_t payload[1] = { level };
+        
+                // send response
+                send_keyglove_packet(KG_PACKET_TYPE_COMMAND, 1, rxPacket[2], rxPacket[3], payload);
+            }
+            break;
+        
+        case KG_PACKET_ID_CMD_SYSTEM_SET_LOG_LEVEL: // 0x10
+            // system_set_log_level(uint8_t level)(uint16_t result)
+            // parameters = 1 byte
+            if (rxPacket[1] != 1) {
+                // incorrect parameter length
+                protocol_error = KG_PROTOCOL_ERROR_PARAMETER_LENGTH;
+            } else {
+                // run command
+                uint16_t result = kg_cmd_system_set_log_level(rxPacket[4]);
+        
+                // build response
+                uint8_t payload[2] = { result & 0xFF, (result >> 8) & 0xFF };
+        
+                // send response
+                send_keyglove_packet(KG_PACKET_TYPE_COMMAND, 2, rxPacket[2], rxPacket[3], payload);
+            }
+            break;
+        
+        case KG_PACKET_ID_CMD_SYSTEM_GET_MEMORY_STATS: // 0x11
+            // system_get_memory_stats()(uint16_t free_ram, uint16_t stack_headroom, uint16_t heap_size, uint16_t heap_free, uint16_t largest_free, uint8_t free_blocks)
+            // parameters = 0 bytes
+            if (rxPacket[1] != 0) {
+                // incorrect parameter length
+                protocol_error = KG_PROTOCOL_ERROR_PARAMETER_LENGTH;
+            } else {
+                // run command
+                uint16_t free_ram;
+                uint16_t stack_headroom;
+                uint16_t heap_size;
+                uint16_t heap_free;
+                uint16_t largest_free;
+                uint8_t free_blocks;
+                uint16_t result = kg_cmd_system_get_memory_stats(&free_ram, &stack_headroom, &heap_size, &heap_free, &largest_free, &free_blocks);
+        
+                // build response
+                uint8_t payload[11] = { free_ram & 0xFF, (free_ram >> 8) & 0xFF, stack_headroom & 0xFF, (stack_headroom >> 8) & 0xFF, heap_size & 0xFF, (heap_size >> 8) & 0xFF, heap_free & 0xFF, (heap_free >> 8) & 0xFF, largest_free & 0xFF, (largest_free >> 8) & 0xFF, free_blocks };
+        
+                // send response
+                send_keyglove_packet(KG_PACKET_TYPE_COMMAND, 11, rxPacket[2], rxPacket[3], payload);
+            }
+            break;
+        
+        case KG_PACKET_ID_CMD_SYSTEM_GET_MEMORY_ALLOCATIONS: // 0x12
+            // system_get_memory_allocations(uint8_t subsystem)(uint16_t result, uint32_t allocations, uint16_t blocks, uint16_t failures)
+            // parameters = 1 byte
+            if (rxPacket[1] != 1) {
+                // incorrect parameter length
+                protocol_error = KG_PROTOCOL_ERROR_PARAMETER_LENGTH;
+            } else {
+                // run command
+                uint32_t allocations;
+                uint16_t blocks;
+                uint16_t failures;
+                uint16_t result = kg_cmd_system_get_memory_allocations(rxPacket[4], &allocations, &blocks, &failures);
+        
+                // build response
+                uint8_t payload[10] = { result & 0xFF, (result >> 8) & 0xFF, allocations & 0xFF, (allocations >> 8) & 0xFF, (allocations >> 16) & 0xFF, (allocations >> 24) & 0xFF, blocks & 0xFF, (blocks >> 8) & 0xFF, failures & 0xFF, (failures >> 8) & 0xFF };
+        
+                // send response
+                send_keyglove_packet(KG_PACKET_TYPE_COMMAND, 10, rxPacket[2], rxPacket[3], payload);
+            }
+            break;
+        
+        case KG_PACKET_ID_CMD_SYSTEM_GET_MEMORY_THRESHOLD: // 0x13
+            // system_get_memory_threshold()(uint16_t threshold)
+            // parameters = 0 bytes
+            if (rxPacket[1] != 0) {
+                // incorrect parameter length
+                protocol_error = KG_PROTOCOL_ERROR_PARAMETER_LENGTH;
+            } else {
+                // run command
+                uint16_t threshold;
+                uint16_t result = kg_cmd_system_get_memory_threshold(&threshold);
+        
+                // build response
+                uint8_t payload[2] = { threshold & 0xFF, (threshold >> 8) & 0xFF };
+        
+                // send response
+                send_keyglove_packet(KG_PACKET_TYPE_COMMAND, 2, rxPacket[2], rxPacket[3], payload);
+            }
+            break;
+        
+        case KG_PACKET_ID_CMD_SYSTEM_SET_MEMORY_THRESHOLD: // 0x14
+            // system_set_memory_threshold(uint16_t threshold)(uint16_t result)
+            // parameters = 2 bytes
+            if (rxPacket[1] != 2) {
+                // incorrect parameter length
+                protocol_error = KG_PROTOCOL_ERROR_PARAMETER_LENGTH;
+            } else {
+                // run command
+                uint16_t result = kg_cmd_system_set_memory_threshold(rxPacket[4] | (rxPacket[5] << 8));
+        
+                // build response
+                uint8_t payload[2] = { result & 0xFF, (result >> 8) & 0xFF };
+        
+                // send response
+                send_keyglove_packet(KG_PACKET_TYPE_COMMAND, 2, rxPacket[2], rxPacket[3], payload);
+            }
+            break;
+        
         default:
             protocol_error = KG_PROTOCOL_ERROR_INVALID_COMMAND;
     }
@@ -212,3 +477,5 @@ uint8_t process_protocol_command_system(uint8_t *rxPacket) {
 /* 0x04 */ uint8_t (*kg_evt_system_capability)(uint8_t category, uint8_t record_len, uint8_t *record_data);
 /* 0x05 */ uint8_t (*kg_evt_system_battery_status)(uint8_t status, uint8_t level);
 /* 0x06 */ uint8_t (*kg_evt_system_timer_tick)(uint8_t handle, uint32_t seconds, uint8_t subticks);
+/* 0x07 */ uint8_t (*kg_evt_system_timestamp_mode)(uint8_t mode);
+/* 0x08 */ uint8_t (*kg_evt_system_memory_low)(uint16_t headroom, uint16_t threshold);
@@ -1,5 +1,5 @@
 // Keyglove controller source code - KGAPI "system" protocol command parser declarations
-// 2014-12-14 by Jeff Rowberg <jeff@rowberg.net>
+// 2014-12-20 by Jeff Rowberg <jeff@rowberg.net>
 
 /*
 ================================================================================
@@ -31,7 +31,7 @@ THE SOFTWARE.
  * @file support_protocol_system.h
  * @brief KGAPI "system" protocol command parser declarations
  * @author Jeff Rowberg
- * @date 2014-12-14
+ * @date 2014-12-20
  *
  * This file implements subsystem-specific command processing functions for the
  * "system" part of the KGAPI protocol.
@@ -53,6 +53,19 @@ THE SOFTWARE.
 #define KG_PACKET_ID_CMD_SYSTEM_GET_MEMORY                  0x05
 #define KG_PACKET_ID_CMD_SYSTEM_GET_BATTERY_STATUS          0x06
 #define KG_PACKET_ID_CMD_SYSTEM_SET_TIMER                   0x07
+#define KG_PACKET_ID_CMD_SYSTEM_GET_TIME                    0x08
+#define KG_PACKET_ID_CMD_SYSTEM_GET_TIMESTAMP_MODE          0x09
+#define KG_PACKET_ID_CMD_SYSTEM_SET_TIMESTAMP_MODE          0x0A
+#define KG_PACKET_ID_CMD_SYSTEM_GET_EVENT_MASK              0x0B
+#define KG_PACKET_ID_CMD_SYSTEM_SET_EVENT_MASK              0x0C
+#define KG_PACKET_ID_CMD_SYSTEM_GET_EVENT_RATE              0x0D
+#define KG_PACKET_ID_CMD_SYSTEM_SET_EVENT_RATE              0x0E
+#define KG_PACKET_ID_CMD_SYSTEM_GET_LOG_LEVEL               0x0F
+#define KG_PACKET_ID_CMD_SYSTEM_SET_LOG_LEVEL               0x10
+#define KG_PACKET_ID_CMD_SYSTEM_GET_MEMORY_STATS            0x11
+#define KG_PACKET_ID_CMD_SYSTEM_GET_MEMORY_ALLOCATIONS      0x12
+#define KG_PACKET_ID_CMD_SYSTEM_GET_MEMORY_THRESHOLD        0x13
+#define KG_PACKET_ID_CMD_SYSTEM_SET_MEMORY_THRESHOLD        0x14
 // -- command/event split --
 #define KG_PACKET_ID_EVT_SYSTEM_BOOT                        0x01
 #define KG_PACKET_ID_EVT_SYSTEM_READY                       0x02
@@ -60,6 +73,8 @@ THE SOFTWARE.
 #define KG_PACKET_ID_EVT_SYSTEM_CAPABILITY                  0x04
 #define KG_PACKET_ID_EVT_SYSTEM_BATTERY_STATUS              0x05
 #define KG_PACKET_ID_EVT_SYSTEM_TIMER_TICK                  0x06
+#define KG_PACKET_ID_EVT_SYSTEM_TIMESTAMP_MODE              0x07
+#define KG_PACKET_ID_EVT_SYSTEM_MEMORY_LOW                  0x08
 
 /* ================================ */
 /* KGAPI COMMAND/EVENT DECLARATIONS */
@@ -72,6 +87,19 @@ THE SOFTWARE.
 /* 0x05 */ uint16_t kg_cmd_system_get_memory(uint32_t *free_ram, uint32_t *total_ram);
 /* 0x06 */ uint16_t kg_cmd_system_get_battery_status(uint8_t *status, uint8_t *level);
 /* 0x07 */ uint16_t kg_cmd_system_set_timer(uint8_t handle, uint16_t interval, uint8_t oneshot);
+/* 0x08 */ uint16_t kg_cmd_system_get_time(uint32_t *seconds, uint8_t *subticks, uint32_t *microseconds);
+/* 0x09 */ uint16_t kg_cmd_system_get_timestamp_mode(uint8_t *mode);
+/* 0x0A */ uint16_t kg_cmd_system_set_timestamp_mode(uint8_t mode);
+/* 0x0B */ uint16_t kg_cmd_system_get_event_mask(uint8_t interface, uint8_t event_class, uint16_t *mask);
+/* 0x0C */ uint16_t kg_cmd_system_set_event_mask(uint8_t interface, uint8_t event_class, uint16_t mask);
+/* 0x0D */ uint16_t kg_cmd_system_get_event_rate(uint8_t interface, uint8_t event_class, uint8_t *interval, uint16_t *ids);
+/* 0x0E */ uint16_t kg_cmd_system_set_event_rate(uint8_t interface, uint8_t event_class, uint8_t interval, uint16_t ids);
+/* 0x0F */ uint16_t kg_cmd_system_get_log_level(uint8_t *level);
+/* 0x10 */ uint16_t kg_cmd_system_set_log_level(uint8_t level);
+/* 0x11 */ uint16_t kg_cmd_system_get_memory_stats(uint16_t *free_ram, uint16_t *stack_headroom, uint16_t *heap_size, uint16_t *heap_free, uint16_t *largest_free, uint8_t *free_blocks);
+/* 0x12 */ uint16_t kg_cmd_system_get_memory_allocations(uint8_t subsystem, uint32_t *allocations, uint16_t *blocks, uint16_t *failures);
+/* 0x13 */ uint16_t kg_cmd_system_get_memory_threshold(uint16_t *threshold);
+/* 0x14 */ uint16_t kg_cmd_system_set_memory_threshold(uint16_t threshold);
 // -- command/event split --
 /* 0x01 */ extern uint8_t (*kg_evt_system_boot)(uint16_t major, uint16_t minor, uint16_t patch, uint16_t protocol, uint32_t timestamp);
 /* 0x02 */ extern uint8_t (*kg_evt_system_ready)();
@@ -79,17 +107,8 @@ THE SOFTWARE.
 /* 0x04 */ extern uint8_t (*kg_evt_system_capability)(uint8_t category, uint8_t record_len, uint8_t *record_data);
 /* 0x05 */ extern uint8_t (*kg_evt_system_battery_status)(uint8_t status, uint8_t level);
 /* 0x06 */ extern uint8_t (*kg_evt_system_timer_tick)(uint8_t handle, uint32_t seconds, uint8_t subticks);
-
-#define KG_SYSTEM_RESET_MODE_NORMAL                         0x01    ///< Reset all components (e.g. core, motion, Bluetooth)
-#define KG_SYSTEM_RESET_MODE_KGONLY                         0x02    ///< Reset only core Keyglove board
-
-#define KG_CAPABILITY_CATEGORY_PLATFORM                     0x01    ///< Platform information (controller board)
-#define KG_CAPABILITY_CATEGORY_HOSTIF                       0x02    ///< Host interface information (USB, Bluetooth, etc.)
-#define KG_CAPABILITY_CATEGORY_FEEDBACK                     0x03    ///< Feedback subsystem informaiton
-#define KG_CAPABILITY_CATEGORY_TOUCH                        0x04    ///< Touch subsystem information
-#define KG_CAPABILITY_CATEGORY_MOTION                       0x05    ///< Motion subsystem information
-#define KG_CAPABILITY_CATEGORY_FLEX                         0x06    ///< Flex subsystem information
-#define KG_CAPABILITY_CATEGORY_PRESSURE                     0x07    ///< Pressure subsystem information
+/* 0x07 */ extern uint8_t (*kg_evt_system_timestamp_mode)(uint8_t mode);
+/* 0x08 */ extern uint8_t (*kg_evt_system_memory_low)(uint16_t headroom, uint16_t threshold);
 
 uint8_t process_protocol_command_system(uint8_t *rxPacket);
 
@@ -1,5 +1,5 @@
 // Keyglove controller source code - KGAPI "touchset" protocol command parser implementation
-// 2014-12-07 by Jeff Rowberg <jeff@rowberg.net>
+// 2014-12-20 by Jeff Rowberg <jeff@rowberg.net>
 
 /*
 ================================================================================
@@ -31,7 +31,7 @@ THE SOFTWARE.
  * @file support_protocol_touchset.cpp
  * @brief KGAPI "touchset" protocol command parser implementation
  * @author Jeff Rowberg
- * @date 2014-12-07
+ * @date 2014-12-20
  *
  * This file implements subsystem-specific command processing functions for the
  * "touchset" part of the KGAPI protocol.
@@ -48,11 +48,73 @@ THE SOFTWARE.
  * @param[in] rxPacket Incoming KGAPI packet buffer
  * @return Protocol error, if any (0 for success)
  * @see protocol_parse()
+ * @see KGAPI command: kg_cmd_touchset_set_macro()
+ * @see KGAPI command: kg_cmd_touchset_play_macro()
+ * @see KGAPI command: kg_cmd_touchset_stop_macro()
  */
 uint8_t process_protocol_command_touchset(uint8_t *rxPacket) {
     // check for valid command IDs
     uint8_t protocol_error = 0;
     switch (rxPacket[3]) {
+        #if KG_HID & KG_HID_KEYBOARD
+        case KG_PACKET_ID_CMD_TOUCHSET_SET_MACRO: // 0x01
+            // touchset_set_macro(uint8_t index, uint8_t[] macro)(uint16_t result)
+            // parameters = 2 bytes
+            if (rxPacket[1] < 2 || rxPacket[1] != 2 + rxPacket[5]) {
+                // incorrect parameter length
+                protocol_error = KG_PROTOCOL_ERROR_PARAMETER_LENGTH;
+            } else {
+                // run command
+                uint16_t result = kg_cmd_touchset_set_macro(rxPacket[4], rxPacket[5], rxPacket + 6);
+        
+                // build response
+                uint8_t payload[2] = { result & 0xFF, (result >> 8) & 0xFF };
+        
+                // send response
+                send_keyglove_packet(KG_PACKET_TYPE_COMMAND, 2, rxPacket[2], rxPacket[3], payload);
+            }
+            break;
+        #endif // KG_HID & KG_HID_KEYBOARD
+        
+        #if KG_HID & KG_HID_KEYBOARD
+        case KG_PACKET_ID_CMD_TOUCHSET_PLAY_MACRO: // 0x02
+            // touchset_play_macro(uint8_t index)(uint16_t result)
+            // parameters = 1 byte
+            if (rxPacket[1] != 1) {
+                // incorrect parameter length
+                protocol_error = KG_PROTOCOL_ERROR_PARAMETER_LENGTH;
+            } else {
+                // run command
+                uint16_t result = kg_cmd_touchset_play_macro(rxPacket[4]);
+        
+                // build response
+                uint8_t payload[2] = { result & 0xFF, (result >> 8) & 0xFF };
+        
+                // send response
+                send_keyglove_packet(KG_PACKET_TYPE_COMMAND, 2, rxPacket[2], rxPacket[3], payload);
+            }
+            break;
+        #endif // KG_HID & KG_HID_KEYBOARD
+        
+        #if KG_HID & KG_HID_KEYBOARD
+        case KG_PACKET_ID_CMD_TOUCHSET_STOP_MACRO: // 0x03
+            // touchset_stop_macro()(uint16_t result)
+            // parameters = 0 bytes
+            if (rxPacket[1] != 0) {
+                // incorrect parameter length
+                protocol_error = KG_PROTOCOL_ERROR_PARAMETER_LENGTH;
+            } else {
+                // run command
+                uint16_t result = kg_cmd_touchset_stop_macro();
+        
+                // build response
+                uint8_t payload[2] = { result & 0xFF, (result >> 8) & 0xFF };
+        
+                // send response
+                send_keyglove_packet(KG_PACKET_TYPE_COMMAND, 2, rxPacket[2], rxPacket[3], payload);
+            }
+            break;
+        #endif // KG_HID & KG_HID_KEYBOARD
         
         default:
             protocol_error = KG_PROTOCOL_ERROR_INVALID_COMMAND;
@@ -60,4 +122,6 @@ uint8_t process_protocol_command_touchset(uint8_t *rxPacket) {
     return protocol_error;
 }
 
-
+#if KG_HID & KG_HID_KEYBOARD
+/* 0x01 */ uint8_t (*kg_evt_touchset_macro_status)(uint8_t index, uint8_t status);
+#endif // KG_HID & KG_HID_KEYBOARD
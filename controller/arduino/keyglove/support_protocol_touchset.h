@@ -1,5 +1,5 @@
 // Keyglove controller source code - KGAPI "touchset" protocol command parser declarations
-// 2014-12-07 by Jeff Rowberg <jeff@rowberg.net>
+// 2014-12-20 by Jeff Rowberg <jeff@rowberg.net>
 
 /*
 ================================================================================
@@ -31,7 +31,7 @@ THE SOFTWARE.
  * @file support_protocol_touchset.h
  * @brief KGAPI "touchset" protocol command parser declarations
  * @author Jeff Rowberg
- * @date 2014-12-07
+ * @date 2014-12-20
  *
  * This file implements subsystem-specific command processing functions for the
  * "touchset" part of the KGAPI protocol.
@@ -46,17 +46,29 @@ THE SOFTWARE.
 /* KGAPI CONSTANT DECLARATIONS */
 /* =========================== */
 
-
+#define KG_PACKET_ID_CMD_TOUCHSET_SET_MACRO                 0x01
+#define KG_PACKET_ID_CMD_TOUCHSET_PLAY_MACRO                0x02
+#define KG_PACKET_ID_CMD_TOUCHSET_STOP_MACRO                0x03
 // -- command/event split --
-
+#define KG_PACKET_ID_EVT_TOUCHSET_MACRO_STATUS              0x01
 
 /* ================================ */
 /* KGAPI COMMAND/EVENT DECLARATIONS */
 /* ================================ */
 
-
+#if KG_HID & KG_HID_KEYBOARD
+/* 0x01 */ uint16_t kg_cmd_touchset_set_macro(uint8_t index, uint8_t macro_len, uint8_t *macro_data);
+#endif // KG_HID & KG_HID_KEYBOARD
+#if KG_HID & KG_HID_KEYBOARD
+/* 0x02 */ uint16_t kg_cmd_touchset_play_macro(uint8_t index);
+#endif // KG_HID & KG_HID_KEYBOARD
+#if KG_HID & KG_HID_KEYBOARD
+/* 0x03 */ uint16_t kg_cmd_touchset_stop_macro();
+#endif // KG_HID & KG_HID_KEYBOARD
 // -- command/event split --
-
+#if KG_HID & KG_HID_KEYBOARD
+/* 0x01 */ extern uint8_t (*kg_evt_touchset_macro_status)(uint8_t index, uint8_t status);
+#endif // KG_HID & KG_HID_KEYBOARD
 
 uint8_t process_protocol_command_touchset(uint8_t *rxPacket);
 
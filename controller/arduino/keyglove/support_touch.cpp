@@ -41,6 +41,9 @@ THE SOFTWARE.
 #include "support_board.h"
 #include "support_protocol.h"
 #include "support_touch.h"
+#if (KG_HID & KG_HID_KEYBOARD)
+    #include "support_hid_macro.h"
+#endif
 
 uint8_t touchMode;          ///< Touch mode
 //uint32_t touchBench;        ///< Touch benchmark reference end
@@ -87,6 +90,18 @@ void update_touch() {
     } else if (memcmp(touches_verify, touches_active, KG_BASE_COMBINATION_BYTES) != 0 && millis() - touchTime >= opt_touch_detect_threshold) {
         // detection is over threshold and current readings are different from previous readings
 
+        #if (KG_HID & KG_HID_KEYBOARD)
+            // any new touch cancels a macro still being typed (before the event can start another one)
+            if (hid_macro_active()) {
+                for (i = 0; i < KG_BASE_COMBINATION_BYTES; i++) {
+                    if (touches_verify[i] & ~touches_active[i]) {
+                        hid_macro_stop();
+                        break;
+                    }
+                }
+            }
+        #endif
+
         // set official sensor readings to current readings
         memcpy(touches_active, touches_verify, KG_BASE_COMBINATION_BYTES);
 
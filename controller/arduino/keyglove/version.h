@@ -43,7 +43,7 @@ THE SOFTWARE.
 #define KG_FIRMWARE_VERSION_MAJOR 0                         ///< Firmware major version number
 #define KG_FIRMWARE_VERSION_MINOR 5                         ///< Firmware minor version number
 #define KG_FIRMWARE_VERSION_PATCH 0                         ///< Firmware patch version number
-#define KG_PROTOCOL_VERSION 1                               ///< API protocol version
+#define KG_PROTOCOL_VERSION 3                               ///< API protocol version
 #define KG_BUILD_TIMESTAMP 1415420841                       ///< UNIX timestamp for current build
 
 // info available for reference, not in system_boot() event
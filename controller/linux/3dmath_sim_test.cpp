@@ -0,0 +1,237 @@
+// Keyglove controller source code - 3D math kernel accuracy test and benchmark on the Linux host simulation
+// 2014-12-20 by Jeff Rowberg <jeff@rowberg.net>
+
+/* ============================================
+Controller code is placed under the MIT license
+Copyright (c) 2014 Jeff Rowberg
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+
+/**
+ * @file 3dmath_sim_test.cpp
+ * @brief 3D math kernel accuracy test and benchmark on the Linux host simulation
+ * @author Jeff Rowberg
+ * @date 2014-12-20
+ *
+ * This file takes the place of the sketch to check the in-place and Q14
+ * kernels in support_helper_3dmath.cpp against the Quaternion, VectorFloat and
+ * VectorInt16 classes they replace, using random unit quaternions and vectors
+ * from a fixed seed. Each check prints one line with the worst error found,
+ * then the time per vector of each rotation method is printed, and the process
+ * exits with status 0 only if all checks passed:
+ *
+ *     g++ -DKG_LINUX_SIM -std=gnu++98 -O2 -Icontroller/linux -Icontroller/arduino/keyglove \
+ *         controller/linux/{linux_core,3dmath_sim_test}.cpp \
+ *         controller/arduino/keyglove/support_helper_3dmath.cpp -o 3dmath_sim_test && ./3dmath_sim_test
+ *
+ * (The first line of output is the simulation's usual pseudo-terminal list.)
+ *
+ * Timings are for the host CPU, where float math is cheap. They show what the
+ * batch kernels save over the classes, but on the AVR the float paths cost far
+ * more relative to the Q14 path.
+ */
+
+#include <Arduino.h>
+#include "support_helper_3dmath.h"
+
+#include <stdio.h>
+
+#define TEST_SAMPLES 10000                  ///< Random cases per accuracy check
+#define TEST_BATCH 250                      ///< Vectors per batch kernel call (count is a uint8_t)
+#define TEST_BENCH_ROUNDS 400               ///< Batches per benchmark method
+
+uint8_t testFailures;                       ///< Number of failed checks
+
+/**
+ * @brief Report one check
+ * @param[in] name Short description
+ * @param[in] error Worst error found
+ * @param[in] limit Largest acceptable error
+ */
+void test_check(const char *name, float error, float limit) {
+    bool pass = error <= limit;
+    printf("%s: %s (max error %g, limit %g)\n", pass ? "PASS" : "FAIL", name, error, limit);
+    if (!pass) testFailures++;
+}
+
+/**
+ * @brief Random float in a range
+ * @param[in] lo Lower bound
+ * @param[in] hi Upper bound
+ * @return Random value
+ */
+float test_random(float lo, float hi) {
+    return lo + (hi - lo) * rand() / (float)RAND_MAX;
+}
+
+/**
+ * @brief Random unit quaternion
+ * @return Random rotation
+ */
+Quaternion test_random_quaternion() {
+    Quaternion q(test_random(-1, 1), test_random(-1, 1), test_random(-1, 1), test_random(-1, 1));
+    q.normalize();
+    return q;
+}
+
+/**
+ * @brief Convert a float quaternion to Q14, rounding to nearest
+ * @param[in] q Quaternion to convert
+ * @return Q14 quaternion
+ */
+QuaternionQ14 test_to_q14(Quaternion q) {
+    return QuaternionQ14(lround(q.w * 16384), lround(q.x * 16384), lround(q.y * 16384), lround(q.z * 16384));
+}
+
+/**
+ * @brief Largest component difference between two quaternions
+ * @param[in] a First quaternion
+ * @param[in] b Second quaternion
+ * @return Largest absolute difference
+ */
+float test_quaternion_error(Quaternion a, Quaternion b) {
+    return max(max(fabsf(a.w - b.w), fabsf(a.x - b.x)), max(fabsf(a.y - b.y), fabsf(a.z - b.z)));
+}
+
+/**
+ * @brief Largest component difference between two integer vectors
+ * @param[in] a First vector
+ * @param[in] b Second vector
+ * @return Largest absolute difference
+ */
+float test_vector_int16_error(VectorInt16 a, VectorInt16 b) {
+    return max(max(abs(a.x - b.x), abs(a.y - b.y)), abs(a.z - b.z));
+}
+
+/**
+ * @brief Float kernels against the Quaternion and Vector classes
+ */
+void test_float() {
+    float multiply = 0, alias = 0, normalize = 0, rotate = 0, normalizeBatch = 0;
+    for (uint16_t i = 0; i < TEST_SAMPLES; i++) {
+        Quaternion a = test_random_quaternion(), b = test_random_quaternion(), r;
+        quaternion_multiply(&r, &a, &b);
+        multiply = max(multiply, test_quaternion_error(r, a.getProduct(b)));
+        Quaternion expected = a.getProduct(b);
+        quaternion_multiply(&a, &a, &b);
+        alias = max(alias, test_quaternion_error(a, expected));
+
+        float scale = test_random(0.5f, 2.0f);
+        Quaternion n(b.w * scale, b.x * scale, b.y * scale, b.z * scale);
+        quaternion_normalize_fast(&n);
+        normalize = max(normalize, test_quaternion_error(n, b));
+
+        VectorFloat v(test_random(-1000, 1000), test_random(-1000, 1000), test_random(-1000, 1000)), u = v;
+        vector_float_rotate_batch(&u, 1, &b);
+        v.rotate(&b);
+        rotate = max(rotate, max(max(fabsf(u.x - v.x), fabsf(u.y - v.y)), fabsf(u.z - v.z)) / v.getMagnitude());
+
+        vector_float_normalize_batch(&u, 1);
+        normalizeBatch = max(normalizeBatch, fabsf(u.getMagnitude() - 1));
+    }
+    test_check("quaternion_multiply matches getProduct", multiply, 1e-6f);
+    test_check("quaternion_multiply in place matches getProduct", alias, 1e-6f);
+    test_check("quaternion_normalize_fast matches normalize", normalize, 0.002f);
+    test_check("vector_float_rotate_batch matches VectorFloat::rotate (relative)", rotate, 1e-5f);
+    test_check("vector_float_normalize_batch gives unit length", normalizeBatch, 0.002f);
+}
+
+/**
+ * @brief Integer and Q14 kernels against the float classes
+ */
+void test_int16() {
+    float rotate = 0, rotateQ14 = 0, multiplyQ14 = 0, normalizeQ14 = 0, normalizeVectorQ14 = 0;
+    for (uint16_t i = 0; i < TEST_SAMPLES; i++) {
+        Quaternion a = test_random_quaternion(), b = test_random_quaternion();
+
+        // small enough that no rotation leaves the int16_t range
+        VectorInt16 v(test_random(-18000, 18000), test_random(-18000, 18000), test_random(-18000, 18000)), u = v, uq = v;
+        vector_int16_rotate_batch(&u, 1, &a);
+        QuaternionQ14 aq = test_to_q14(a);
+        vector_int16_rotate_q14(&uq, 1, &aq);
+        v.rotate(&a);
+        rotate = max(rotate, test_vector_int16_error(u, v));
+        rotateQ14 = max(rotateQ14, test_vector_int16_error(uq, v));
+
+        QuaternionQ14 bq = test_to_q14(b), rq;
+        quaternion_q14_multiply(&rq, &aq, &bq);
+        Quaternion r = a.getProduct(b);
+        multiplyQ14 = max(multiplyQ14, test_quaternion_error(Quaternion(rq.w, rq.x, rq.y, rq.z), Quaternion(r.w * 16384, r.x * 16384, r.y * 16384, r.z * 16384)));
+
+        float scale = test_random(0.5f, 1.5f);
+        QuaternionQ14 nq(b.w * 16384 * scale, b.x * 16384 * scale, b.y * 16384 * scale, b.z * 16384 * scale);
+        quaternion_q14_normalize(&nq);
+        normalizeQ14 = max(normalizeQ14, test_quaternion_error(Quaternion(nq.w, nq.x, nq.y, nq.z), Quaternion(b.w * 16384, b.x * 16384, b.y * 16384, b.z * 16384)));
+
+        VectorInt16 n(test_random(-32768, 32767), test_random(-32768, 32767), test_random(-32768, 32767));
+        if (n.x == 0 && n.y == 0 && n.z == 0) continue;
+        vector_int16_normalize_q14(&n, 1);
+        normalizeVectorQ14 = max(normalizeVectorQ14, fabsf(n.getMagnitude() - 16384) / 16384);
+    }
+    test_check("vector_int16_rotate_batch matches VectorInt16::rotate (LSB)", rotate, 1);
+    test_check("vector_int16_rotate_q14 matches VectorInt16::rotate (LSB)", rotateQ14, 6);
+    test_check("quaternion_q14_multiply matches getProduct (LSB)", multiplyQ14, 3);
+    test_check("quaternion_q14_normalize matches normalize (LSB)", normalizeQ14, 40);
+    test_check("vector_int16_normalize_q14 gives unit length (relative)", normalizeVectorQ14, 0.0025f);
+}
+
+/**
+ * @brief Time one integer vector rotation method
+ * @param[in] name Method name
+ * @param[in] method 0 = VectorInt16::rotate, 1 = vector_int16_rotate_batch, 2 = vector_int16_rotate_q14
+ */
+void test_bench(const char *name, uint8_t method) {
+    static VectorInt16 v[TEST_BATCH];
+    Quaternion q = test_random_quaternion();
+    QuaternionQ14 qq = test_to_q14(q);
+    for (uint8_t i = 0; i < TEST_BATCH; i++) v[i] = VectorInt16(test_random(-16000, 16000), test_random(-16000, 16000), test_random(-16000, 16000));
+
+    uint32_t start = micros();
+    for (uint16_t round = 0; round < TEST_BENCH_ROUNDS; round++) {
+        if (method == 0) {
+            for (uint8_t i = 0; i < TEST_BATCH; i++) v[i].rotate(&q);
+        } else if (method == 1) {
+            vector_int16_rotate_batch(v, TEST_BATCH, &q);
+        } else {
+            vector_int16_rotate_q14(v, TEST_BATCH, &qq);
+        }
+    }
+    uint32_t elapsed = micros() - start;
+    // rotation keeps the vectors in range, and the checksum keeps the compiler from dropping the work
+    printf("BENCH: %-28s %7.1f ns/vector (checksum %d)\n", name, elapsed * 1000.0 / ((uint32_t)TEST_BATCH * TEST_BENCH_ROUNDS), v[0].x + v[1].y + v[2].z);
+}
+
+void setup() {
+    srand(1);
+    test_float();
+    test_int16();
+
+    test_bench("VectorInt16::rotate", 0);
+    test_bench("vector_int16_rotate_batch", 1);
+    test_bench("vector_int16_rotate_q14", 2);
+
+    printf("%s\n", testFailures ? "FAILED" : "OK");
+    exit(testFailures ? 1 : 0);
+}
+
+void loop() {
+}
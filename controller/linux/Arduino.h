@@ -0,0 +1,201 @@
+// Keyglove controller source code - Arduino core API subset for the Linux host simulation
+// 2014-12-14 by Jeff Rowberg <jeff@rowberg.net>
+
+/* ============================================
+Controller code is placed under the MIT license
+Copyright (c) 2014 Jeff Rowberg
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+
+/**
+ * @file Arduino.h
+ * @brief Arduino core API subset for the Linux host simulation
+ * @author Jeff Rowberg
+ * @date 2014-12-14
+ *
+ * This header stands in for the Teensy++ 2.0 Arduino core when the firmware
+ * is built as a normal Linux program (KG_BOARD_LINUX_SIM). It only covers what
+ * the modules enabled in the simulation actually use. Timing comes from the
+ * host's monotonic clock, pins do nothing, and the USB serial and raw HID
+ * interfaces are pseudo-terminals (see linux_core.cpp).
+ *
+ * Interrupt handlers are plain functions run by the simulation's main loop
+ * between calls to loop(), so the firmware never sees one interrupt another
+ * piece of code. The one exception is the TWI (I2C) interrupt: code such as
+ * twi_wait() spins without returning to loop(), so a TWI interrupt that is due
+ * also runs whenever SREG is restored with the I bit set, which is the point
+ * where the real MCU would take it after a cli() section.
+ *
+ * Normally it is not necessary to edit this file.
+ */
+
+#ifndef _ARDUINO_H_
+#define _ARDUINO_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+
+#define F_CPU 16000000UL
+
+// program memory is ordinary memory here
+#define PROGMEM
+#define PSTR(s) (s)
+#define F(s) ((const __FlashStringHelper *)(s))
+class __FlashStringHelper;
+#define pgm_read_byte(p) (*(const uint8_t *)(p))
+#define pgm_read_word(p) (*(const uint16_t *)(p))
+#define pgm_read_dword(p) (*(const uint32_t *)(p))
+#define memcpy_P memcpy
+#define strlen_P strlen
+
+// interrupts are simulated from the main loop, see above
+#define ISR(vector) extern "C" void vector(void)
+#define SREG_I 7
+#define cli() (SREG.value &= ~(1 << SREG_I))
+#define sei() (SREG = SREG.value | (1 << SREG_I))
+
+/**
+ * @brief Status register, only the I bit means anything
+ */
+class sim_sreg_class {
+    public:
+        uint8_t value;                      ///< Register contents
+        operator uint8_t() const { return value; }
+        sim_sreg_class &operator=(uint8_t v);
+};
+
+extern sim_sreg_class SREG;
+
+// TWI (I2C) registers, backed by a simulated bus (see linux_sim.h)
+#define TWINT 7
+#define TWEA 6
+#define TWSTA 5
+#define TWSTO 4
+#define TWWC 3
+#define TWEN 2
+#define TWIE 0
+
+/**
+ * @brief TWI control register, writing it drives the simulated bus
+ */
+class sim_twcr_class {
+    public:
+        uint8_t value;                      ///< Register contents
+        operator uint8_t() const { return value; }
+        sim_twcr_class &operator=(uint8_t v);
+};
+
+extern sim_twcr_class TWCR;
+extern volatile uint8_t TWSR;
+extern volatile uint8_t TWDR;
+extern volatile uint8_t TWBR;
+
+template<class T, class U> inline T min(T a, U b) { return a < (T)b ? a : (T)b; }
+template<class T, class U> inline T max(T a, U b) { return a > (T)b ? a : (T)b; }
+#define constrain(a, lo, hi) ((a) < (lo) ? (lo) : ((a) > (hi) ? (hi) : (a)))
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t channel);
+void attachInterrupt(uint8_t num, void (*isr)(void), int mode);
+void detachInterrupt(uint8_t num);
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint16_t us);
+
+class Print {
+    public:
+        virtual size_t write(uint8_t b) { return write(&b, 1); }
+        virtual size_t write(const uint8_t *buffer, size_t size) = 0;
+        size_t write(const char *s) { return write((const uint8_t *)s, strlen(s)); }
+        size_t print(const char *s) { return write(s); }
+        size_t print(const __FlashStringHelper *s) { return write((const char *)s); }
+        size_t println() { return write("\r\n"); }
+        size_t println(const char *s) { return print(s) + println(); }
+        size_t println(const __FlashStringHelper *s) { return print(s) + println(); }
+};
+
+class Stream : public Print {
+    public:
+        virtual int available() = 0;
+        virtual int read() = 0;
+};
+
+/**
+ * @brief Byte stream over the master side of a pseudo-terminal
+ *
+ * Writes that cannot complete within a short timeout (nobody reading the
+ * slave side) are dropped, like the Teensy USB serial driver does when the
+ * host stops reading.
+ */
+class usb_serial_class : public Stream {
+    public:
+        int fd;                             ///< Pseudo-terminal master
+        uint32_t dropped;                   ///< Bytes discarded because the host was not reading
+        usb_serial_class() : fd(-1), dropped(0) { }
+        void begin(long) { }
+        int available();
+        int read();
+        size_t write(const uint8_t *buffer, size_t size);
+        using Print::write;
+        operator bool() { return fd >= 0; }
+};
+
+#define USB_RAWHID_RX_SIZE 64               ///< Raw HID output report size (host to device)
+#define USB_RAWHID_TX_SIZE 64               ///< Raw HID input report size (device to host)
+
+/**
+ * @brief Raw HID reports as fixed-size records over a pseudo-terminal
+ */
+class usb_rawhid_class {
+    public:
+        int fd;                             ///< Pseudo-terminal master
+        uint8_t rx[USB_RAWHID_RX_SIZE];     ///< Partially received report
+        uint8_t rxLength;                   ///< Bytes of rx received so far
+        uint32_t dropped;                   ///< Reports discarded because the host was not reading
+        usb_rawhid_class() : fd(-1), rxLength(0), dropped(0) { }
+        int available();
+        int recv(void *buffer, uint16_t timeout);
+        int send(const void *buffer, uint16_t timeout);
+};
+
+extern usb_serial_class Serial;
+extern usb_rawhid_class RawHID;
+
+#endif // _ARDUINO_H_
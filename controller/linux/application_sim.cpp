@@ -0,0 +1,52 @@
+// Keyglove controller source code - Application behavior for the Linux host simulation
+// 2014-12-14 by Jeff Rowberg <jeff@rowberg.net>
+
+/* ============================================
+Controller code is placed under the MIT license
+Copyright (c) 2014 Jeff Rowberg
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+
+/**
+ * @file application_sim.cpp
+ * @brief Application behavior for the Linux host simulation
+ * @author Jeff Rowberg
+ * @date 2014-12-14
+ *
+ * The simulation is built with this file in place of the sketch's own
+ * "application.cpp". No custom event handlers are assigned, so every KGAPI
+ * event goes to the host unchanged (the stock application replaces timer ticks
+ * with battery readings, which would hide them from benchmarks), and nothing
+ * depends on the feedback, motion or Bluetooth modules that the simulation
+ * leaves out.
+ */
+
+#include "keyglove.h"
+#include "application.h"
+
+/**
+ * @brief Custom application setup routine
+ *
+ * Intentionally empty, see above.
+ */
+void setup_application() {
+}
@@ -0,0 +1,409 @@
+// Keyglove controller source code - Arduino core implementation for the Linux host simulation
+// 2014-12-14 by Jeff Rowberg <jeff@rowberg.net>
+
+/* ============================================
+Controller code is placed under the MIT license
+Copyright (c) 2014 Jeff Rowberg
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+
+/**
+ * @file linux_core.cpp
+ * @brief Arduino core implementation for the Linux host simulation
+ * @author Jeff Rowberg
+ * @date 2014-12-14
+ *
+ * This file runs the firmware's setup() and loop() as a normal Linux process,
+ * so protocol handling and host tools can be exercised and timed without a
+ * glove. The USB serial interface, the USB raw HID interface and a control
+ * channel each get a pseudo-terminal, and their slave device names are printed
+ * on the first line of standard output as JSON:
+ *
+ *     {"usb_serial": "/dev/pts/5", "usb_rawhid": "/dev/pts/6", "control": "/dev/pts/7"}
+ *
+ * The raw HID pseudo-terminal carries whole 64-byte reports back to back, in
+ * both directions, with no report ID (the same bytes a hidraw node would give).
+ *
+ * Between calls to loop(), any simulated timer or TWI interrupts that are due
+ * are run, and then the process sleeps until the next one is due or host data
+ * arrives, for at most 1ms. With "--spin" it never sleeps, which is closer to
+ * the real MCU but keeps one CPU core busy.
+ *
+ * The simulation is built from a selection of the firmware sources as C++98,
+ * matching the AVR toolchain. -fpermissive is only needed for the (int) pointer
+ * casts in kg_cmd_system_get_memory, which assume 16-bit AVR addresses; it
+ * leaves them as warnings, and everything else should build without any:
+ *
+ *     g++ -DKG_LINUX_SIM -std=gnu++98 -O2 -fpermissive -Icontroller/linux -Icontroller/arduino/keyglove \
+ *         controller/linux/{linux_core,application_sim}.cpp controller/arduino/keyglove/{keyglove,
+ *         custom_protocol,support_board_linux_sim,support_log,support_memory,support_protocol,
+ *         support_protocol_system,support_protocol_touch,support_touch}.cpp -o keyglove_sim
+ *
+ * host/python/keyglove_bench.py builds and starts it automatically.
+ *
+ * Normally it is not necessary to edit this file.
+ */
+
+#include <Arduino.h>
+#include "linux_sim.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/ioctl.h>
+#include <stdio.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+void setup();
+void loop();
+
+usb_serial_class Serial;                    ///< USB serial interface
+usb_rawhid_class RawHID;                    ///< USB raw HID interface
+usb_serial_class SimControl;                ///< Host control channel
+
+sim_sreg_class SREG;                        ///< Status register (only the I bit is used)
+int __heap_start;                           ///< Stand-in for the AVR linker symbol used by system_get_memory
+int *__brkval;                              ///< Stand-in for the AVR malloc break pointer used by system_get_memory
+
+struct timespec simStart;                   ///< Host time at startup (millis() and micros() are relative to this)
+
+/**
+ * @brief Simulated periodic timer interrupt
+ */
+struct sim_timer_t {
+    void (*isr)(void);                      ///< Handler to run, or 0 if unused
+    uint32_t period;                        ///< Period in microseconds
+    uint32_t next;                          ///< micros() value when the handler is next due
+};
+
+sim_timer_t simTimer[SIM_TIMER_COUNT];      ///< All simulated timer interrupts
+
+#define SIM_TWI_IDLE 0                      ///< Bus free (after STOP or reset)
+#define SIM_TWI_START 1                     ///< START sent, TWDR holds the address to send next
+#define SIM_TWI_WRITE 2                     ///< Device addressed for writing
+#define SIM_TWI_READ 3                      ///< Device addressed for reading
+#define SIM_TWI_NACK 4                      ///< Address or data not acknowledged, waiting for STOP
+#define SIM_TWI_HUNG 5                      ///< Device holding SCL low, waiting for a bus reset
+
+extern "C" void TWI_vect(void) __attribute__((weak));
+
+sim_twcr_class TWCR;                        ///< TWI control register
+volatile uint8_t TWSR;                      ///< TWI status register
+volatile uint8_t TWDR;                      ///< TWI data register
+volatile uint8_t TWBR;                      ///< TWI bit rate register
+sim_twi_device_t simTwiDevice[SIM_TWI_DEVICE_COUNT];    ///< All simulated I2C devices
+uint32_t simTwiResets;                      ///< Number of times the firmware disabled TWI to release the bus
+uint8_t simTwiState;                        ///< SIM_TWI_* bus state
+sim_twi_device_t *simTwiSelected;           ///< Device addressed since the last START, or 0
+uint8_t simTwiPointerNext;                  ///< Non-zero if the next byte written sets the register pointer
+uint8_t simTwiStatus;                       ///< TWSR value for the pending bus step
+uint8_t simTwiReceived;                     ///< Byte for TWDR when the pending bus step is a read
+uint8_t simTwiPending;                      ///< Non-zero if a bus step is in progress
+uint32_t simTwiDue;                         ///< micros() value when the pending bus step finishes
+
+/* ===================== */
+/* TIME AND PIN HANDLING */
+/* ===================== */
+
+uint32_t micros() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint32_t)((now.tv_sec - simStart.tv_sec) * 1000000LL + (now.tv_nsec - simStart.tv_nsec) / 1000);
+}
+
+uint32_t millis() {
+    return micros() / 1000;
+}
+
+void delay(uint32_t ms) {
+    usleep(ms * 1000);
+}
+
+void delayMicroseconds(uint16_t us) {
+    usleep(us);
+}
+
+// there are no pins, and every input reads as idle (pulled up, nothing touching)
+void pinMode(uint8_t, uint8_t) { }
+void digitalWrite(uint8_t, uint8_t) { }
+int digitalRead(uint8_t) { return HIGH; }
+int analogRead(uint8_t) { return 0; }
+void attachInterrupt(uint8_t, void (*)(void), int) { }
+void detachInterrupt(uint8_t) { }
+
+/**
+ * @brief Run a handler periodically from the main loop, like a hardware timer interrupt
+ * @param[in] index Timer to use (0 to SIM_TIMER_COUNT - 1)
+ * @param[in] isr Handler to run, or 0 to stop the timer
+ * @param[in] period Period in microseconds
+ */
+void sim_set_timer(uint8_t index, void (*isr)(void), uint32_t period) {
+    if (index >= SIM_TIMER_COUNT) return;
+    simTimer[index].isr = isr;
+    simTimer[index].period = period;
+    simTimer[index].next = micros() + period;
+}
+
+/* ================= */
+/* SIMULATED I2C BUS */
+/* ================= */
+
+/**
+ * @brief Start a bus step that sets TWINT with the given status when it finishes
+ * @param[in] status TWSR value for the finished step
+ *
+ * Every step takes nine SCL cycles at the rate set in TWBR (prescaler 1).
+ */
+void sim_twi_step(uint8_t status) {
+    simTwiStatus = status;
+    simTwiPending = 1;
+    simTwiDue = micros() + 9 * (16 + 2 * (uint32_t)TWBR) / (F_CPU / 1000000UL);
+}
+
+/**
+ * @brief Run the TWI interrupt if a bus step has finished and it is enabled
+ */
+void sim_twi_interrupt() {
+    if (!simTwiPending || (int32_t)(micros() - simTwiDue) < 0) return;
+    simTwiPending = 0;
+    TWSR = simTwiStatus;
+    if (simTwiStatus == 0x50 || simTwiStatus == 0x58) TWDR = simTwiReceived;
+    TWCR.value |= (1 << TWINT);
+    if (!(TWCR.value & (1 << TWIE)) || !TWI_vect) return;
+    // like the hardware, the I bit is cleared while the handler runs
+    uint8_t sreg = SREG.value;
+    SREG.value &= ~(1 << SREG_I);
+    TWI_vect();
+    SREG.value = sreg;
+}
+
+sim_sreg_class &sim_sreg_class::operator=(uint8_t v) {
+    value = v;
+    if (value & (1 << SREG_I)) sim_twi_interrupt();
+    return *this;
+}
+
+sim_twcr_class &sim_twcr_class::operator=(uint8_t v) {
+    if (!(v & (1 << TWEN))) {
+        // disabling TWI releases the bus whatever state it was in
+        if (value & (1 << TWEN)) simTwiResets++;
+        value = v;
+        simTwiState = SIM_TWI_IDLE;
+        simTwiPending = 0;
+        return *this;
+    }
+
+    // writing TWINT as one clears it and starts the next step, as zero leaves it alone
+    value = (v & ~(1 << TWINT)) | (value & (1 << TWINT) & ~v);
+    if (!(v & (1 << TWINT)) || simTwiState == SIM_TWI_HUNG) return *this;
+
+    if (v & (1 << TWSTO)) {
+        simTwiState = SIM_TWI_IDLE;
+        value &= ~(1 << TWSTO);
+        if (!(v & (1 << TWSTA))) return *this;
+    }
+    if (v & (1 << TWSTA)) {
+        sim_twi_step(simTwiState == SIM_TWI_IDLE ? 0x08 : 0x10);
+        simTwiState = SIM_TWI_START;
+        return *this;
+    }
+
+    switch (simTwiState) {
+        case SIM_TWI_START:
+            simTwiSelected = 0;
+            for (uint8_t i = 0; i < SIM_TWI_DEVICE_COUNT; i++) {
+                if (simTwiDevice[i].address && simTwiDevice[i].address == TWDR >> 1) simTwiSelected = &simTwiDevice[i];
+            }
+            if (simTwiSelected && simTwiSelected->hang) {
+                simTwiState = SIM_TWI_HUNG;
+            } else if (TWDR & 1) {
+                sim_twi_step(simTwiSelected ? 0x40 : 0x48);
+                simTwiState = simTwiSelected ? SIM_TWI_READ : SIM_TWI_NACK;
+            } else {
+                sim_twi_step(simTwiSelected ? 0x18 : 0x20);
+                simTwiState = simTwiSelected ? SIM_TWI_WRITE : SIM_TWI_NACK;
+                simTwiPointerNext = 1;
+            }
+            break;
+        case SIM_TWI_WRITE:
+            if (simTwiPointerNext) {
+                simTwiSelected->pointer = TWDR;
+                simTwiPointerNext = 0;
+            } else {
+                simTwiSelected->reg[simTwiSelected->pointer++] = TWDR;
+            }
+            sim_twi_step(0x28);
+            break;
+        case SIM_TWI_READ:
+            simTwiReceived = simTwiSelected->reg[simTwiSelected->pointer++];
+            sim_twi_step(v & (1 << TWEA) ? 0x50 : 0x58);
+            break;
+    }
+    return *this;
+}
+
+/* ============================= */
+/* PSEUDO-TERMINAL COMMUNICATION */
+/* ============================= */
+
+/**
+ * @brief Write a whole buffer to a non-blocking descriptor, waiting up to a timeout for room
+ * @param[in] fd Descriptor to write to
+ * @param[in] buffer Data to write
+ * @param[in] size Number of bytes to write
+ * @param[in] timeout Milliseconds to wait for room before giving up
+ * @return Number of bytes written
+ */
+size_t sim_write(int fd, const uint8_t *buffer, size_t size, int timeout) {
+    size_t written = 0;
+    uint32_t start = millis();
+    while (written < size) {
+        ssize_t result = ::write(fd, buffer + written, size - written);
+        if (result > 0) {
+            written += result;
+        } else if (result < 0 && errno != EAGAIN && errno != EINTR) {
+            break;
+        } else {
+            int remaining = timeout - (int)(millis() - start);
+            if (remaining <= 0) break;
+            struct pollfd p = { fd, POLLOUT, 0 };
+            poll(&p, 1, remaining);
+        }
+    }
+    return written;
+}
+
+int usb_serial_class::available() {
+    int count = 0;
+    return fd >= 0 && ioctl(fd, FIONREAD, &count) == 0 ? count : 0;
+}
+
+int usb_serial_class::read() {
+    uint8_t b;
+    return fd >= 0 && ::read(fd, &b, 1) == 1 ? b : -1;
+}
+
+size_t usb_serial_class::write(const uint8_t *buffer, size_t size) {
+    if (fd < 0) return 0;
+    size_t written = sim_write(fd, buffer, size, 50);
+    dropped += size - written;
+    return size;
+}
+
+int usb_rawhid_class::available() {
+    return rxLength == USB_RAWHID_RX_SIZE ? USB_RAWHID_RX_SIZE : 0;
+}
+
+int usb_rawhid_class::recv(void *buffer, uint16_t) {
+    if (fd < 0) return 0;
+    ssize_t result = ::read(fd, rx + rxLength, USB_RAWHID_RX_SIZE - rxLength);
+    if (result > 0) rxLength += result;
+    if (rxLength < USB_RAWHID_RX_SIZE) return 0;
+    memcpy(buffer, rx, USB_RAWHID_RX_SIZE);
+    rxLength = 0;
+    return USB_RAWHID_RX_SIZE;
+}
+
+int usb_rawhid_class::send(const void *buffer, uint16_t timeout) {
+    if (fd < 0) return 0;
+    size_t written = sim_write(fd, (const uint8_t *)buffer, USB_RAWHID_TX_SIZE, timeout);
+    if (written == USB_RAWHID_TX_SIZE) return USB_RAWHID_TX_SIZE;
+    if (written > 0) {
+        // never leave half a report behind, or every later one would be misaligned
+        sim_write(fd, (const uint8_t *)buffer + written, USB_RAWHID_TX_SIZE - written, 1000);
+        return USB_RAWHID_TX_SIZE;
+    }
+    dropped++;
+    return 0;
+}
+
+/**
+ * @brief Create a raw-mode pseudo-terminal
+ * @param[out] name Slave device name
+ * @return Non-blocking master descriptor, or -1 on failure
+ *
+ * The slave side is opened once and kept open, so the master does not see a
+ * hangup when host programs open and close it.
+ */
+int sim_open_pty(char *name, size_t size) {
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) || unlockpt(master) || ptsname_r(master, name, size)) return -1;
+    int slave = open(name, O_RDWR | O_NOCTTY);
+    if (slave < 0) return -1;
+    struct termios tio;
+    tcgetattr(slave, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(slave, TCSANOW, &tio);
+    fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+    return master;
+}
+
+/* ========= */
+/* MAIN LOOP */
+/* ========= */
+
+int main(int argc, char **argv) {
+    bool spin = argc > 1 && strcmp(argv[1], "--spin") == 0;
+    signal(SIGPIPE, SIG_IGN);
+    clock_gettime(CLOCK_MONOTONIC, &simStart);
+
+    char serialName[64], rawhidName[64], controlName[64];
+    Serial.fd = sim_open_pty(serialName, sizeof(serialName));
+    RawHID.fd = sim_open_pty(rawhidName, sizeof(rawhidName));
+    SimControl.fd = sim_open_pty(controlName, sizeof(controlName));
+    if (Serial.fd < 0 || RawHID.fd < 0 || SimControl.fd < 0) {
+        perror("Unable to create pseudo-terminals");
+        return 1;
+    }
+    printf("{\"usb_serial\": \"%s\", \"usb_rawhid\": \"%s\", \"control\": \"%s\"}\n", serialName, rawhidName, controlName);
+    fflush(stdout);
+
+    SREG.value = 1 << SREG_I;
+    setup();
+    for (;;) {
+        sim_twi_interrupt();
+        uint32_t now = micros();
+        int32_t wait = 1000;
+        if (simTwiPending && (int32_t)(simTwiDue - now) < wait) wait = simTwiDue - now;
+        for (uint8_t i = 0; i < SIM_TIMER_COUNT; i++) {
+            if (!simTimer[i].isr) continue;
+            if ((int32_t)(now - simTimer[i].next) >= 0) {
+                simTimer[i].isr();
+                // like a compare flag, ticks missed while busy collapse into one
+                simTimer[i].next += simTimer[i].period;
+                if ((int32_t)(now - simTimer[i].next) >= 0) simTimer[i].next = now + simTimer[i].period;
+            }
+            if ((int32_t)(simTimer[i].next - now) < wait) wait = simTimer[i].next - now;
+        }
+
+        loop();
+
+        if (!spin && wait > 0) {
+            struct pollfd p[3] = { { Serial.fd, POLLIN, 0 }, { RawHID.fd, POLLIN, 0 }, { SimControl.fd, POLLIN, 0 } };
+            struct timespec timeout = { 0, wait * 1000L };
+            ppoll(p, 3, &timeout, 0);
+        }
+    }
+}
@@ -0,0 +1,79 @@
+// Keyglove controller source code - Linux host simulation interface for board support
+// 2014-12-14 by Jeff Rowberg <jeff@rowberg.net>
+
+/* ============================================
+Controller code is placed under the MIT license
+Copyright (c) 2014 Jeff Rowberg
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+
+/**
+ * @file linux_sim.h
+ * @brief Linux host simulation interface for board support
+ * @author Jeff Rowberg
+ * @date 2014-12-14
+ *
+ * These are the parts of the simulated core that only the simulation board
+ * support file (support_board_linux_sim.cpp) needs: periodic timer interrupts
+ * and the control channel that stands in for the glove's physical inputs. The
+ * simulated I2C devices are here too, for programs that run the TWI helper
+ * against them (see twi_sim_test.cpp).
+ *
+ * Normally it is not necessary to edit this file.
+ */
+
+#ifndef _LINUX_SIM_H_
+#define _LINUX_SIM_H_
+
+#include <Arduino.h>
+
+#define SIM_TIMER_COUNT 4                   ///< Number of simulated timer interrupts available
+#define SIM_TWI_DEVICE_COUNT 4              ///< Number of simulated I2C devices available
+
+/**
+ * @brief Control channel, a third pseudo-terminal carrying text commands from the host
+ *
+ * Each command is one line. The core does not interpret them, the board file
+ * reads them wherever the real hardware would be sampled.
+ */
+extern usb_serial_class SimControl;
+
+/**
+ * @brief Simulated I2C device, 256 registers behind an auto-incrementing register pointer
+ *
+ * The first byte written after the address sets the register pointer, and
+ * every data byte read or written after that moves it on by one, like most
+ * sensors (including the MPU-6050) do.
+ */
+struct sim_twi_device_t {
+    uint8_t address;                        ///< 7-bit address, or 0 if unused
+    uint8_t reg[256];                       ///< Register contents
+    uint8_t pointer;                        ///< Register for the next data byte
+    uint8_t hang;                           ///< Non-zero to hold SCL low once addressed, until the bus is reset
+};
+
+extern sim_twi_device_t simTwiDevice[SIM_TWI_DEVICE_COUNT];
+extern uint32_t simTwiResets;
+
+void sim_set_timer(uint8_t index, void (*isr)(void), uint32_t period);
+
+#endif // _LINUX_SIM_H_
@@ -0,0 +1,195 @@
+// Keyglove controller source code - I2C (TWI) transaction queue test on the Linux host simulation
+// 2014-12-20 by Jeff Rowberg <jeff@rowberg.net>
+
+/* ============================================
+Controller code is placed under the MIT license
+Copyright (c) 2014 Jeff Rowberg
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+
+/**
+ * @file twi_sim_test.cpp
+ * @brief I2C (TWI) transaction queue test on the Linux host simulation
+ * @author Jeff Rowberg
+ * @date 2014-12-20
+ *
+ * This file takes the place of the sketch to run support_helper_twi.cpp
+ * against the simulated I2C bus in linux_core.cpp, covering the blocking
+ * helpers, NACKs, a full queue with completion callbacks, and recovery from a
+ * device that hangs the bus. Each check prints one line, and the process exits
+ * with status 0 only if all of them passed:
+ *
+ *     g++ -DKG_LINUX_SIM -std=gnu++98 -O2 -Icontroller/linux -Icontroller/arduino/keyglove \
+ *         controller/linux/{linux_core,twi_sim_test}.cpp \
+ *         controller/arduino/keyglove/support_helper_twi.cpp -o twi_sim_test && ./twi_sim_test
+ *
+ * (The first line of output is the simulation's usual pseudo-terminal list.)
+ */
+
+#include <Arduino.h>
+#include "linux_sim.h"
+#include "support_helper_twi.h"
+
+#include <stdio.h>
+
+#define TEST_ADDRESS 0x68                   ///< Simulated device that always answers (MPU-6050 address)
+#define TEST_HANG_ADDRESS 0x69              ///< Simulated device that hangs the bus when addressed
+#define TEST_MISSING_ADDRESS 0x50           ///< Address with no simulated device
+
+uint8_t testFailures;                       ///< Number of failed checks
+twi_transaction_t *testDone[KG_TWI_QUEUE_SIZE + 1];    ///< Transactions in the order their callbacks ran
+uint8_t testDoneCount;                      ///< Number of entries in testDone
+
+/**
+ * @brief Report one check
+ * @param[in] name Short description
+ * @param[in] pass Whether the check passed
+ */
+void test_check(const char *name, bool pass) {
+    printf("%s: %s\n", pass ? "PASS" : "FAIL", name);
+    if (!pass) testFailures++;
+}
+
+/**
+ * @brief Completion callback that records the order transactions finish in
+ * @param[in] transaction Finished transaction
+ */
+void test_callback(twi_transaction_t *transaction) {
+    if (testDoneCount < sizeof(testDone) / sizeof(testDone[0])) testDone[testDoneCount++] = transaction;
+}
+
+/**
+ * @brief Run update_twi() until a number of callbacks have run or a second has passed
+ * @param[in] count Callbacks to wait for
+ */
+void test_wait_callbacks(uint8_t count) {
+    uint32_t start = millis();
+    while (testDoneCount < count && millis() - start < 1000) update_twi();
+}
+
+/**
+ * @brief Blocking helpers, including NACKs from a missing device
+ */
+void test_sync() {
+    sim_twi_device_t *device = &simTwiDevice[0];
+    test_check("sync write", twi_write_byte_sync(TEST_ADDRESS, 0x6B, 0x01) == KG_TWI_STATUS_OK
+        && device->reg[0x6B] == 0x01 && device->pointer == 0x6C);
+
+    uint8_t data[6];
+    for (uint8_t i = 0; i < 6; i++) device->reg[0x3B + i] = 0xA0 + i;
+    memset(data, 0, sizeof(data));
+    test_check("sync multi-byte read", twi_read_bytes_sync(TEST_ADDRESS, 0x3B, data, 6) == KG_TWI_STATUS_OK
+        && memcmp(data, device->reg + 0x3B, 6) == 0 && device->pointer == 0x41);
+
+    device->reg[0x75] = 0x68;
+    data[0] = 0;
+    test_check("sync single-byte read", twi_read_bytes_sync(TEST_ADDRESS, 0x75, data, 1) == KG_TWI_STATUS_OK
+        && data[0] == 0x68);
+
+    test_check("missing device NACKs a write", twi_write_byte_sync(TEST_MISSING_ADDRESS, 0x00, 0x00) == KG_TWI_STATUS_NACK);
+    test_check("missing device NACKs a read", twi_read_bytes_sync(TEST_MISSING_ADDRESS, 0x00, data, 1) == KG_TWI_STATUS_NACK);
+}
+
+/**
+ * @brief Full queue, refusal when full, and callback order
+ */
+void test_queue() {
+    twi_transaction_t transaction[KG_TWI_QUEUE_SIZE + 1];
+    uint8_t data[KG_TWI_QUEUE_SIZE][2];
+    for (uint8_t i = 0; i < KG_TWI_QUEUE_SIZE; i++) {
+        simTwiDevice[0].reg[0x10 + i] = i;
+        data[i][0] = data[i][1] = 0xFF;
+    }
+
+    testDoneCount = 0;
+    bool queued = true, waiting = true;
+    for (uint8_t i = 0; i < KG_TWI_QUEUE_SIZE; i++) {
+        if (i == 3) {
+            queued = queued && !twi_read(&transaction[i], TEST_MISSING_ADDRESS, 0x00, data[i], 2, test_callback);
+        } else {
+            queued = queued && !twi_read(&transaction[i], TEST_ADDRESS, 0x10 + i, data[i], 2, test_callback);
+        }
+        waiting = waiting && transaction[i].status < KG_TWI_STATUS_OK;
+    }
+    test_check("queue accepts KG_TWI_QUEUE_SIZE transactions without blocking", queued && waiting);
+    test_check("queue refuses one more", twi_write(&transaction[KG_TWI_QUEUE_SIZE], TEST_ADDRESS, 0x00, data[0], 1, test_callback) != 0);
+
+    test_wait_callbacks(KG_TWI_QUEUE_SIZE);
+    bool ordered = testDoneCount == KG_TWI_QUEUE_SIZE, results = true;
+    for (uint8_t i = 0; ordered && i < KG_TWI_QUEUE_SIZE; i++) {
+        ordered = testDone[i] == &transaction[i];
+        if (i == 3) {
+            results = results && transaction[i].status == KG_TWI_STATUS_NACK;
+        } else {
+            results = results && transaction[i].status == KG_TWI_STATUS_OK && data[i][0] == i && data[i][1] == simTwiDevice[0].reg[0x11 + i];
+        }
+    }
+    test_check("callbacks run once each, in queue order", ordered);
+    test_check("queued reads complete with data, NACK does not stall the rest", results);
+
+    testDoneCount = 0;
+    uint8_t value = 0x5A;
+    test_check("queue accepts again after callbacks", !twi_write(&transaction[0], TEST_ADDRESS, 0x20, &value, 1, test_callback));
+    test_wait_callbacks(1);
+    test_check("callback after write", testDoneCount == 1 && transaction[0].status == KG_TWI_STATUS_OK && simTwiDevice[0].reg[0x20] == 0x5A);
+}
+
+/**
+ * @brief A device that hangs the bus times out, and the queue carries on
+ */
+void test_timeout() {
+    twi_transaction_t stuck, next;
+    uint8_t stuckData = 0, nextData = 0;
+    uint32_t resets = simTwiResets;
+
+    testDoneCount = 0;
+    simTwiDevice[0].reg[0x30] = 0x42;
+    uint32_t start = millis();
+    twi_read(&stuck, TEST_HANG_ADDRESS, 0x00, &stuckData, 1, test_callback);
+    twi_read(&next, TEST_ADDRESS, 0x30, &nextData, 1, test_callback);
+    test_wait_callbacks(1);
+    uint32_t elapsed = millis() - start;
+    test_check("hung transaction times out after KG_TWI_TIMEOUT", testDoneCount >= 1 && testDone[0] == &stuck
+        && stuck.status == KG_TWI_STATUS_TIMEOUT && elapsed >= KG_TWI_TIMEOUT);
+    test_check("timeout resets the bus", simTwiResets == resets + 1);
+
+    test_wait_callbacks(2);
+    test_check("queue continues after timeout", testDoneCount == 2 && testDone[1] == &next
+        && next.status == KG_TWI_STATUS_OK && nextData == 0x42);
+}
+
+void setup() {
+    simTwiDevice[0].address = TEST_ADDRESS;
+    simTwiDevice[1].address = TEST_HANG_ADDRESS;
+    simTwiDevice[1].hang = 1;
+    setup_twi();
+
+    test_sync();
+    test_queue();
+    test_timeout();
+
+    printf("%s\n", testFailures ? "FAILED" : "OK");
+    exit(testFailures ? 1 : 0);
+}
+
+void loop() {
+}
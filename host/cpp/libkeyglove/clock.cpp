@@ -0,0 +1,189 @@
+// Keyglove host SDK - Device clock synchronization
+// 2014-12-20 by Jeff Rowberg <jeff@rowberg.net>
+
+/*
+================================================================================
+Keyglove source code is placed under the MIT license
+Copyright (c) 2014 Jeff Rowberg
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+================================================================================
+*/
+
+
+/**
+ * @file clock.cpp
+ * @brief Device clock synchronization
+ * @author Jeff Rowberg
+ * @date 2014-12-20
+ *
+ * The glove reads its clock somewhere between receiving system_get_time and
+ * sending the response, so the middle of the host's round trip is the best
+ * guess for the matching host time, off by at most half the round trip. Link
+ * jitter (USB polling, Bluetooth retransmits, OS scheduling) only ever makes
+ * a round trip longer, so the fit uses just the quickest half of the recent
+ * samples: a least-squares line of (host - device) against device time gives
+ * the offset and the crystal drift together. Drift is only estimated once
+ * those samples cover MIN_DRIFT_SPAN, since before that the slope is noise.
+ *
+ * The glove's microsecond counter wraps every 71.6 minutes. It is unwrapped
+ * with the 1Hz/10ms tick counters from the same response, which do not wrap,
+ * and event timestamps are then unwrapped against the newest sample.
+ *
+ * Normally it is not necessary to edit this file.
+ */
+
+#include "clock.h"
+
+#include <algorithm>
+#include <time.h>
+
+namespace keyglove {
+
+const int clock_sync::WINDOW;
+const int64_t clock_sync::MIN_DRIFT_SPAN;
+
+/**
+ * @brief Create a clock with no samples
+ */
+clock_sync::clock_sync() {
+    reset();
+}
+
+/**
+ * @brief Forget all samples, e.g. after the glove resets
+ */
+void clock_sync::reset() {
+    count_ = 0;
+    next_ = 0;
+    last_device_ = 0;
+    offset_ = 0;
+    drift_ = 0;
+}
+
+/**
+ * @brief Add one system_get_time exchange and update the estimate
+ * @param[in] host_send now() just before the command was sent
+ * @param[in] host_recv now() just after the response arrived
+ * @param[in] time Response to the command
+ */
+void clock_sync::add_sample(int64_t host_send, int64_t host_recv, const rsp::system_get_time &time) {
+    int64_t ticks = ((int64_t)time.seconds() * 100 + time.subticks()) * 10000;
+    int64_t wraps = (ticks - (int64_t)time.microseconds() + 0x80000000LL) >> 32;
+    sample &s = samples_[next_];
+    s.device = (wraps << 32) + time.microseconds();
+    s.host = host_send + (host_recv - host_send) / 2;
+    s.rtt = host_recv - host_send;
+    next_ = (next_ + 1) % WINDOW;
+    if (count_ < WINDOW) count_++;
+    last_device_ = s.device;
+    fit();
+}
+
+/**
+ * @brief Fit offset and drift to the quickest half of the samples
+ */
+void clock_sync::fit() {
+    int64_t rtts[WINDOW];
+    for (int i = 0; i < count_; i++) rtts[i] = samples_[i].rtt;
+    int used = std::max(1, count_ / 2);
+    std::nth_element(rtts, rtts + used - 1, rtts + count_);
+    int64_t limit = rtts[used - 1];
+
+    double sx = 0, sy = 0, sxx = 0, sxy = 0;
+    int64_t first = last_device_;
+    int n = 0;
+    for (int i = 0; i < count_ && n < used; i++) {
+        if (samples_[i].rtt > limit) continue;
+        first = std::min(first, samples_[i].device);
+        double x = (double)(samples_[i].device - last_device_);
+        double y = (double)(samples_[i].host - samples_[i].device);
+        sx += x;
+        sy += y;
+        sxx += x * x;
+        sxy += x * y;
+        n++;
+    }
+    // over a short span the slope is all noise, so keep the last drift until there is a useful baseline
+    double var = sxx - sx * sx / n;
+    if (n > 1 && last_device_ - first >= MIN_DRIFT_SPAN) drift_ = (sxy - sx * sy / n) / var;
+    offset_ = (sy - drift_ * sx) / n;
+}
+
+/**
+ * @brief Unwrap a 32-bit microsecond reading from the glove
+ * @param[in] microseconds Reading from micros() on the glove
+ * @return Device microseconds since boot (the reading closest to the newest sample)
+ */
+int64_t clock_sync::unwrap_micros(uint32_t microseconds) const {
+    return last_device_ + (int32_t)(microseconds - (uint32_t)last_device_);
+}
+
+/**
+ * @brief Get the device time of a timestamped event
+ * @param[in] packet Complete event packet
+ * @param[in] length Packet length
+ * @return Device microseconds since boot, or -1 if the event has no timestamp
+ */
+int64_t clock_sync::device_time(const uint8_t *packet, size_t length) const {
+    if (length < PACKET_HEADER_SIZE + PACKET_TIMESTAMP_SIZE) return -1;
+    switch (packet_timestamp_mode(packet)) {
+        case SYSTEM_TIMESTAMP_MODE_TICKS:
+            return (int64_t)packet_timestamp(packet, length) * 10000;
+        case SYSTEM_TIMESTAMP_MODE_MICROSECONDS:
+            return unwrap_micros(packet_timestamp(packet, length));
+        default:
+            return -1;
+    }
+}
+
+/**
+ * @brief Convert device time into host time
+ * @param[in] device_us Device microseconds since boot
+ * @return Host microseconds on the now() clock
+ */
+int64_t clock_sync::to_host(int64_t device_us) const {
+    double x = (double)(device_us - last_device_);
+    return device_us + (int64_t)(offset_ + drift_ * x);
+}
+
+/**
+ * @brief Get the host time at which a timestamped event happened
+ * @param[in] packet Complete event packet
+ * @param[in] length Packet length
+ * @return Host microseconds on the now() clock, or -1 if the event has no timestamp or there are no samples yet
+ */
+int64_t clock_sync::event_time(const uint8_t *packet, size_t length) const {
+    int64_t device_us = device_time(packet, length);
+    if (device_us < 0 || !ready()) return -1;
+    return to_host(device_us);
+}
+
+/**
+ * @brief Get the host clock used for samples and results
+ * @return Microseconds on CLOCK_MONOTONIC, which NTP slews but never steps
+ */
+int64_t clock_sync::now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+} // namespace keyglove
@@ -0,0 +1,99 @@
+// Keyglove host SDK - Device clock synchronization
+// 2014-12-20 by Jeff Rowberg <jeff@rowberg.net>
+
+/*
+================================================================================
+Keyglove source code is placed under the MIT license
+Copyright (c) 2014 Jeff Rowberg
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+================================================================================
+*/
+
+
+/**
+ * @file clock.h
+ * @brief Device clock synchronization
+ * @author Jeff Rowberg
+ * @date 2014-12-20
+ */
+
+#ifndef _KEYGLOVE_CLOCK_H_
+#define _KEYGLOVE_CLOCK_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "kgapi.h"
+
+namespace keyglove {
+
+/**
+ * @brief Estimates the offset and drift between one glove's clock and the host's
+ *
+ * Send cmd::system_get_time() every few seconds, note now() just before
+ * sending it and just after its response arrives, and pass both to
+ * add_sample() with the response. Timestamped events can then be converted
+ * to host time with event_time(), so they line up with each other and with
+ * host-side measurements no matter how long they sat in a USB or Bluetooth
+ * buffer on the way.
+ */
+class clock_sync {
+public:
+    static const int WINDOW = 32;                   ///< Most recent samples kept for the fit
+    static const int64_t MIN_DRIFT_SPAN = 10000000; ///< Microseconds the samples must cover before drift is estimated
+
+    clock_sync();
+
+    void reset();
+    void add_sample(int64_t host_send, int64_t host_recv, const rsp::system_get_time &time);
+    int64_t unwrap_micros(uint32_t microseconds) const;
+    int64_t device_time(const uint8_t *packet, size_t length) const;
+    int64_t to_host(int64_t device_us) const;
+    int64_t event_time(const uint8_t *packet, size_t length) const;
+
+    /** @brief Whether at least one sample has been added */
+    bool ready() const { return count_ > 0; }
+
+    /** @brief Current drift estimate in parts per million (positive if the glove runs slow) */
+    double drift_ppm() const { return drift_ * 1e6; }
+
+    static int64_t now();
+
+private:
+    struct sample {
+        int64_t device;                             ///< Unwrapped device microseconds since boot
+        int64_t host;                               ///< Host microseconds at the middle of the round trip
+        int64_t rtt;                                ///< Round trip time in microseconds
+    };
+
+    void fit();
+
+    sample samples_[WINDOW];
+    int count_;
+    int next_;
+    int64_t last_device_;                           ///< Device time of the newest sample, the reference for offset_
+    double offset_;                                 ///< Host minus device microseconds at last_device_
+    double drift_;                                  ///< Change in offset_ per device microsecond
+};
+
+} // namespace keyglove
+
+#endif // _KEYGLOVE_CLOCK_H_
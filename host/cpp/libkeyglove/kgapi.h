@@ -0,0 +1,1797 @@
+// Keyglove host SDK - KGAPI packet builders, packet views and dispatch table
+// 2014-12-20 by Jeff Rowberg <jeff@rowberg.net>
+
+/*
+================================================================================
+Keyglove source code is placed under the MIT license
+Copyright (c) 2014 Jeff Rowberg
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+================================================================================
+*/
+
+/**
+ * @file kgapi.h
+ * @brief KGAPI packet builders, packet views and dispatch table
+ * @author Jeff Rowberg
+ * @date 2014-12-20
+ *
+ * Everything here works directly on packet bytes in the caller's buffers:
+ *
+ * - keyglove::cmd::<class>_<command>() writes a complete command packet into
+ *   a buffer and returns its length. Multi-byte fields are always written
+ *   little-endian one byte at a time, so the host byte order and alignment
+ *   don't matter.
+ * - keyglove::rsp::<class>_<command> and keyglove::evt::<class>_<event> are
+ *   read-only views over a received payload. Nothing is parsed or copied
+ *   until a field accessor is called, and uint8_t[] fields come back as
+ *   keyglove::bytes pointing into the packet itself.
+ * - keyglove::dispatcher looks up the handler for a packet by type, class and
+ *   ID in a fixed table, so dispatch costs the same for every packet.
+ *
+ * Views and bytes are only valid as long as the buffer they point into.
+ *
+ * This file is autogenerated. Normally it is not necessary to edit this file.
+ */
+
+#ifndef _KEYGLOVE_KGAPI_H_
+#define _KEYGLOVE_KGAPI_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+namespace keyglove {
+
+/* ============== */
+/* PACKET FRAMING */
+/* ============== */
+
+const uint8_t PACKET_TYPE_COMMAND = 0xC0;       ///< Command (host to glove) or its response (glove to host)
+const uint8_t PACKET_TYPE_EVENT = 0x80;         ///< Event (glove to host)
+const uint8_t PACKET_TAG_MASK = 0x38;           ///< First header byte bits holding the command tag (1-7), echoed in the response
+const size_t PACKET_HEADER_SIZE = 4;            ///< Type/tag/length, length, class ID, packet ID
+const size_t PACKET_MAX_SIZE = PACKET_HEADER_SIZE + 2047;   ///< Largest packet the 11-bit length field allows
+const size_t PACKET_TIMESTAMP_SIZE = 4;         ///< Timestamp appended to events when a timestamp mode is set
+
+/**
+ * @brief Get the total length of a packet from its first two bytes
+ */
+inline size_t packet_length(const uint8_t *header) {
+    return PACKET_HEADER_SIZE + (((header[0] & 0x07) << 8) | header[1]);
+}
+
+/**
+ * @brief Check whether a byte can start a packet
+ */
+inline bool packet_start(uint8_t b) {
+    return (b & 0xC0) == PACKET_TYPE_COMMAND || (b & 0xC0) == PACKET_TYPE_EVENT;
+}
+
+/**
+ * @brief Get the timestamp mode of an event (0 if it has no timestamp)
+ *
+ * Events other than protocol errors (class 0x00) and log messages (class
+ * 0xFF) use the tag bits for the glove's timestamp mode, and then end with
+ * a uint32 timestamp which is counted in the packet length.
+ *
+ * @see SYSTEM_TIMESTAMP_MODE_TICKS, SYSTEM_TIMESTAMP_MODE_MICROSECONDS
+ */
+inline uint8_t packet_timestamp_mode(const uint8_t *header) {
+    if ((header[0] & 0xC0) != PACKET_TYPE_EVENT || header[2] == 0x00 || header[2] == 0xFF) return 0;
+    return (header[0] & PACKET_TAG_MASK) >> 3;
+}
+
+/**
+ * @brief Get the timestamp from the end of a timestamped event
+ * @param[in] packet Complete event packet
+ * @param[in] length Packet length
+ * @return Timestamp in the units given by packet_timestamp_mode(), or 0 if there is none
+ */
+inline uint32_t packet_timestamp(const uint8_t *packet, size_t length) {
+    if (!packet_timestamp_mode(packet) || length < PACKET_HEADER_SIZE + PACKET_TIMESTAMP_SIZE) return 0;
+    const uint8_t *p = packet + length - PACKET_TIMESTAMP_SIZE;
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/**
+ * @brief Get the tag of a packet (0 if untagged)
+ *
+ * Responses carry the tag of the command they answer, and so do protocol
+ * errors caused by a tagged command. Other events are never tagged.
+ */
+inline uint8_t packet_tag(const uint8_t *header) {
+    if (packet_timestamp_mode(header)) return 0;
+    return (header[0] & PACKET_TAG_MASK) >> 3;
+}
+
+/**
+ * @brief Tag a command packet built with one of the keyglove::cmd functions
+ * @param[in] packet Command packet
+ * @param[in] tag Tag from 1 to 7, or 0 to remove it
+ */
+inline void set_packet_tag(uint8_t *packet, uint8_t tag) {
+    packet[0] = (packet[0] & ~PACKET_TAG_MASK) | ((tag << 3) & PACKET_TAG_MASK);
+}
+
+inline uint16_t read_u16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+inline uint32_t read_u32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+inline uint8_t *write_u16(uint8_t *p, uint16_t v) {
+    p[0] = v & 0xFF;
+    p[1] = v >> 8;
+    return p + 2;
+}
+
+inline uint8_t *write_u32(uint8_t *p, uint32_t v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = v >> 24;
+    return p + 4;
+}
+
+inline uint8_t *write_bytes(uint8_t *p, const uint8_t *data, size_t length) {
+    memcpy(p, data, length);
+    return p + length;
+}
+
+inline uint8_t *write_header(uint8_t *p, uint8_t type, uint8_t class_id, uint8_t id, size_t payload_length) {
+    p[0] = type | ((payload_length >> 8) & 0x07);
+    p[1] = payload_length & 0xFF;
+    p[2] = class_id;
+    p[3] = id;
+    return p + PACKET_HEADER_SIZE;
+}
+
+/**
+ * @brief Variable-length field inside a received packet (not a copy)
+ */
+struct bytes {
+    const uint8_t *data;
+    uint8_t length;
+};
+
+/* ========================== */
+/* CLASS IDS AND ENUMERATIONS */
+/* ========================== */
+
+enum {
+    CLASS_PROTOCOL          = 0x00,
+    CLASS_SYSTEM            = 0x01,
+    CLASS_BLUETOOTH         = 0x02,
+    CLASS_FEEDBACK          = 0x03,
+    CLASS_TOUCH             = 0x04,
+    CLASS_MOTION            = 0x05,
+    CLASS_FLEX              = 0x06,
+    CLASS_PRESSURE          = 0x07,
+    CLASS_TOUCHSET          = 0x08,
+    CLASS_COUNT             = 9     ///< One more than the highest class ID
+};
+
+const uint8_t ID_COUNT = 21;     ///< One more than the highest command or event ID in any class
+
+/// Describes the nature of a protocol error that has occurred.
+enum {
+    PROTOCOL_ERROR_CODE_INVALID_COMMAND     = 0x01,  ///< Command class or ID is unknown
+    PROTOCOL_ERROR_CODE_PACKET_TIMEOUT      = 0x02,  ///< Command packet not completed in time
+    PROTOCOL_ERROR_CODE_BAD_LENGTH          = 0x03,  ///< Length value not supported, 250 bytes or less
+    PROTOCOL_ERROR_CODE_PARAMETER_LENGTH    = 0x04,  ///< Length of supplied parameters does not match with command definition
+    PROTOCOL_ERROR_CODE_PARAMETER_RANGE     = 0x05,  ///< Value of supplied parameter(s) outside of valid range
+    PROTOCOL_ERROR_CODE_NOT_IMPLEMENTED     = 0x06,  ///< Command known but not implemented in this firmware configuration
+    PROTOCOL_ERROR_CODE_BUSY                = 0x07,  ///< Command could not run yet because an earlier operation is still in progress, try again shortly
+};
+
+/// Describes the nature of a system error that has occurred.
+enum {
+    SYSTEM_ERROR_CODE_OUT_OF_MEMORY         = 0x01,  ///< Could not allocate required memory
+};
+
+/// Describes the type of reset to perform.
+enum {
+    SYSTEM_RESET_MODE_NORMAL                = 0x01,  ///< Reset Keyglove hardware and all peripherals (Bluetooth, sensors, etc.)
+    SYSTEM_RESET_MODE_KGONLY                = 0x02,  ///< Reset Keyglove hardware only, no peripherals
+};
+
+/// Describes the device clock reading attached to each event.
+enum {
+    SYSTEM_TIMESTAMP_MODE_NONE              = 0x00,  ///< Events carry no timestamp
+    SYSTEM_TIMESTAMP_MODE_TICKS             = 0x01,  ///< 10ms ticks since boot
+    SYSTEM_TIMESTAMP_MODE_MICROSECONDS      = 0x02,  ///< Microseconds since boot (wraps every 71.6 minutes)
+};
+
+/// Identifies a host interface for event subscriptions.
+enum {
+    SYSTEM_INTERFACE_CURRENT                = 0x00,  ///< Interface the command came from
+    SYSTEM_INTERFACE_USB_SERIAL             = 0x01,  ///< USB serial
+    SYSTEM_INTERFACE_USB_RAWHID             = 0x02,  ///< USB raw HID
+    SYSTEM_INTERFACE_BT2_SERIAL             = 0x03,  ///< Bluetooth v2 serial (SPP)
+    SYSTEM_INTERFACE_BT2_RAWHID             = 0x04,  ///< Bluetooth v2 raw HID
+    SYSTEM_INTERFACE_BT2_IAP                = 0x05,  ///< Bluetooth v2 iAP
+};
+
+/// Describes the importance of a log message.
+enum {
+    SYSTEM_LOG_LEVEL_PANIC                  = 0x00,  ///< Problems that will lock the MCU
+    SYSTEM_LOG_LEVEL_CRITICAL               = 0x01,  ///< Critical issues that will break core functionality
+    SYSTEM_LOG_LEVEL_WARNING                = 0x03,  ///< Warnings that may impact certain subsystems
+    SYSTEM_LOG_LEVEL_NORMAL                 = 0x05,  ///< Regular status updates (default)
+    SYSTEM_LOG_LEVEL_VERBOSE                = 0x09,  ///< Extra detailed info
+};
+
+/// Identifies the part of the firmware that made a dynamic allocation.
+enum {
+    SYSTEM_MEMORY_SUBSYSTEM_PROTOCOL_RX     = 0x00,  ///< KGAPI command parser and command queue buffers
+    SYSTEM_MEMORY_SUBSYSTEM_PROTOCOL_TX     = 0x01,  ///< KGAPI outgoing packet and packet queue buffers
+    SYSTEM_MEMORY_SUBSYSTEM_BLUETOOTH       = 0x02,  ///< Bluetooth pairing records and iWRAP command buffers
+};
+
+/// Identifies a single feedback output for pattern control.
+enum {
+    FEEDBACK_OUTPUT_BLINK                   = 0x00,  ///< Single LED
+    FEEDBACK_OUTPUT_PIEZO                   = 0x01,  ///< Piezo buzzer
+    FEEDBACK_OUTPUT_VIBRATE                 = 0x02,  ///< Vibration motor
+    FEEDBACK_OUTPUT_RGB_RED                 = 0x03,  ///< RGB LED red channel
+    FEEDBACK_OUTPUT_RGB_GREEN               = 0x04,  ///< RGB LED green channel
+    FEEDBACK_OUTPUT_RGB_BLUE                = 0x05,  ///< RGB LED blue channel
+};
+
+/// Describes the state of a motion sensor offset calibration.
+enum {
+    MOTION_CALIBRATION_STATUS_WAITING       = 0x01,  ///< Waiting for the hand to be held still
+    MOTION_CALIBRATION_STATUS_COLLECTING    = 0x02,  ///< Averaging still samples
+    MOTION_CALIBRATION_STATUS_COMPLETE      = 0x03,  ///< New offsets applied and stored
+    MOTION_CALIBRATION_STATUS_TIMEOUT       = 0x04,  ///< Hand was not still long enough before the timeout
+    MOTION_CALIBRATION_STATUS_NOT_FLAT      = 0x05,  ///< Accelerometer calibration needs the sensor lying flat
+    MOTION_CALIBRATION_STATUS_CANCELLED     = 0x06,  ///< Calibration was cancelled
+};
+
+/// Describes the type of a recognized motion gesture.
+enum {
+    MOTION_GESTURE_FLICK                    = 0x01,  ///< Short, fast rotation (and optional return) about one axis
+    MOTION_GESTURE_SHAKE                    = 0x02,  ///< Repeated back-and-forth movement along one axis
+    MOTION_GESTURE_TWIST                    = 0x03,  ///< Slower, larger rotation about one axis
+    MOTION_GESTURE_TAP                      = 0x04,  ///< Brief acceleration spike with little rotation
+};
+
+/// Describes the power state of a motion sensor.
+enum {
+    MOTION_STATE_ACTIVE                     = 0x01,  ///< Sampling at the full configured rate
+    MOTION_STATE_SLEEP                      = 0x02,  ///< Idle, accelerometer-only low-power cycling until motion wakes it
+};
+
+/// Describes the press state of a pressure sensor.
+enum {
+    PRESSURE_STATE_RELEASED                 = 0x00,  ///< Not pressed
+    PRESSURE_STATE_STRIKING                 = 0x01,  ///< Pressed and force still rising
+    PRESSURE_STATE_HELD                     = 0x02,  ///< Pressed, past the peak of the strike
+};
+
+/// Describes the state of keyboard macro playback.
+enum {
+    TOUCHSET_MACRO_STATUS_STARTED           = 0x01,  ///< Macro playback has started
+    TOUCHSET_MACRO_STATUS_COMPLETE          = 0x02,  ///< Macro has been typed completely
+    TOUCHSET_MACRO_STATUS_CANCELLED         = 0x03,  ///< Macro playback was cancelled before completion
+};
+
+/* ================ */
+/* COMMAND BUILDERS */
+/* ================ */
+
+namespace cmd {
+
+/// Test communication with Keyglove device and get current uptime
+inline size_t system_ping(uint8_t *buf) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_SYSTEM, 0x01, 0);
+    return p - buf;
+}
+
+/// Reset Keyglove device
+inline size_t system_reset(uint8_t *buf, uint8_t mode) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_SYSTEM, 0x02, 1);
+    *p++ = mode;
+    return p - buf;
+}
+
+/// Get firmware build info
+inline size_t system_get_info(uint8_t *buf) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_SYSTEM, 0x03, 0);
+    return p - buf;
+}
+
+/// Get capabilities designed into this unit
+inline size_t system_get_capabilities(uint8_t *buf, uint8_t category) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_SYSTEM, 0x04, 1);
+    *p++ = category;
+    return p - buf;
+}
+
+/// Get system memory usage
+inline size_t system_get_memory(uint8_t *buf) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_SYSTEM, 0x05, 0);
+    return p - buf;
+}
+
+/// Get battery status
+inline size_t system_get_battery_status(uint8_t *buf) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_SYSTEM, 0x06, 0);
+    return p - buf;
+}
+
+/// Set a timer interval to trigger future behavior
+inline size_t system_set_timer(uint8_t *buf, uint8_t handle, uint16_t interval, uint8_t oneshot) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_SYSTEM, 0x07, 4);
+    *p++ = handle;
+    p = write_u16(p, interval);
+    *p++ = oneshot;
+    return p - buf;
+}
+
+/// Get the current device clock readings
+inline size_t system_get_time(uint8_t *buf) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_SYSTEM, 0x08, 0);
+    return p - buf;
+}
+
+/// Get the current event timestamp mode
+inline size_t system_get_timestamp_mode(uint8_t *buf) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_SYSTEM, 0x09, 0);
+    return p - buf;
+}
+
+/// Set a new event timestamp mode
+inline size_t system_set_timestamp_mode(uint8_t *buf, uint8_t mode) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_SYSTEM, 0x0A, 1);
+    *p++ = mode;
+    return p - buf;
+}
+
+/// Get the event subscription mask for one interface and class
+inline size_t system_get_event_mask(uint8_t *buf, uint8_t interface, uint8_t event_class) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_SYSTEM, 0x0B, 2);
+    *p++ = interface;
+    *p++ = event_class;
+    return p - buf;
+}
+
+/// Set the event subscription mask for one interface and class
+inline size_t system_set_event_mask(uint8_t *buf, uint8_t interface, uint8_t event_class, uint16_t mask) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_SYSTEM, 0x0C, 4);
+    *p++ = interface;
+    *p++ = event_class;
+    p = write_u16(p, mask);
+    return p - buf;
+}
+
+/// Get the event rate limit for one interface and class
+inline size_t system_get_event_rate(uint8_t *buf, uint8_t interface, uint8_t event_class) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_SYSTEM, 0x0D, 2);
+    *p++ = interface;
+    *p++ = event_class;
+    return p - buf;
+}
+
+/// Set the event rate limit for one interface and class
+inline size_t system_set_event_rate(uint8_t *buf, uint8_t interface, uint8_t event_class, uint8_t interval, uint16_t ids) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_SYSTEM, 0x0E, 5);
+    *p++ = interface;
+    *p++ = event_class;
+    *p++ = interval;
+    p = write_u16(p, ids);
+    return p - buf;
+}
+
+/// Get the current log level filter
+inline size_t system_get_log_level(uint8_t *buf) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_SYSTEM, 0x0F, 0);
+    return p - buf;
+}
+
+/// Set a new log level filter
+inline size_t system_set_log_level(uint8_t *buf, uint8_t level) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_SYSTEM, 0x10, 1);
+    *p++ = level;
+    return p - buf;
+}
+
+/// Get detailed RAM usage
+inline size_t system_get_memory_stats(uint8_t *buf) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_SYSTEM, 0x11, 0);
+    return p - buf;
+}
+
+/// Get dynamic allocation counters for one subsystem
+inline size_t system_get_memory_allocations(uint8_t *buf, uint8_t subsystem) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_SYSTEM, 0x12, 1);
+    *p++ = subsystem;
+    return p - buf;
+}
+
+/// Get the low memory threshold
+inline size_t system_get_memory_threshold(uint8_t *buf) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_SYSTEM, 0x13, 0);
+    return p - buf;
+}
+
+/// Set the low memory threshold
+inline size_t system_set_memory_threshold(uint8_t *buf, uint16_t threshold) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_SYSTEM, 0x14, 2);
+    p = write_u16(p, threshold);
+    return p - buf;
+}
+
+/// Get current mode for Bluetooth subsystem
+inline size_t bluetooth_get_mode(uint8_t *buf) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_BLUETOOTH, 0x01, 0);
+    return p - buf;
+}
+
+/// Set new mode for Bluetooth subsystem
+inline size_t bluetooth_set_mode(uint8_t *buf, uint8_t mode) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_BLUETOOTH, 0x02, 1);
+    *p++ = mode;
+    return p - buf;
+}
+
+/// Reset Bluetooth subsystem
+inline size_t bluetooth_reset(uint8_t *buf) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_BLUETOOTH, 0x03, 0);
+    return p - buf;
+}
+
+/// Get local Bluetooth MAC address
+inline size_t bluetooth_get_mac(uint8_t *buf) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_BLUETOOTH, 0x04, 0);
+    return p - buf;
+}
+
+/// Get a list of all paired devices
+inline size_t bluetooth_get_pairings(uint8_t *buf) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_BLUETOOTH, 0x05, 0);
+    return p - buf;
+}
+
+/// Perform Bluetooth inquiry to locate nearby devices
+inline size_t bluetooth_discover(uint8_t *buf, uint8_t duration) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_BLUETOOTH, 0x06, 1);
+    *p++ = duration;
+    return p - buf;
+}
+
+/// Initiate pairing request to remote device
+inline size_t bluetooth_pair(uint8_t *buf, const uint8_t *address) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_BLUETOOTH, 0x07, 6);
+    p = write_bytes(p, address, 6);
+    return p - buf;
+}
+
+/// Remove a specific pairing entry
+inline size_t bluetooth_delete_pairing(uint8_t *buf, uint8_t pairing) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_BLUETOOTH, 0x08, 1);
+    *p++ = pairing;
+    return p - buf;
+}
+
+/// Remove all pairing entries
+inline size_t bluetooth_clear_pairings(uint8_t *buf) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_BLUETOOTH, 0x09, 0);
+    return p - buf;
+}
+
+/// Get a list of all open or pending connections
+inline size_t bluetooth_get_connections(uint8_t *buf) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_BLUETOOTH, 0x0A, 0);
+    return p - buf;
+}
+
+/// Attempt to open a connection to a specific paired device using a specific profile
+inline size_t bluetooth_connect(uint8_t *buf, uint8_t pairing, uint8_t profile) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_BLUETOOTH, 0x0B, 2);
+    *p++ = pairing;
+    *p++ = profile;
+    return p - buf;
+}
+
+/// Close a specific Bluetooth connection
+inline size_t bluetooth_disconnect(uint8_t *buf, uint8_t handle) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_BLUETOOTH, 0x0C, 1);
+    *p++ = handle;
+    return p - buf;
+}
+
+/// Get current blink feedback mode
+inline size_t feedback_get_blink_mode(uint8_t *buf) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_FEEDBACK, 0x01, 0);
+    return p - buf;
+}
+
+/// Set new blink feedback mode
+inline size_t feedback_set_blink_mode(uint8_t *buf, uint8_t mode) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_FEEDBACK, 0x02, 1);
+    *p++ = mode;
+    return p - buf;
+}
+
+/// Get current feedback mode for a piezo buzzer
+inline size_t feedback_get_piezo_mode(uint8_t *buf, uint8_t index) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_FEEDBACK, 0x03, 1);
+    *p++ = index;
+    return p - buf;
+}
+
+/// Set a new piezo feedback mode for a piezo buzzer
+inline size_t feedback_set_piezo_mode(uint8_t *buf, uint8_t index, uint8_t mode, uint8_t duration, uint16_t frequency) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_FEEDBACK, 0x04, 5);
+    *p++ = index;
+    *p++ = mode;
+    *p++ = duration;
+    p = write_u16(p, frequency);
+    return p - buf;
+}
+
+/// Get current feedback mode for a vibration motor
+inline size_t feedback_get_vibrate_mode(uint8_t *buf, uint8_t index) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_FEEDBACK, 0x05, 1);
+    *p++ = index;
+    return p - buf;
+}
+
+/// Set a new vibration motor feedback mode
+inline size_t feedback_set_vibrate_mode(uint8_t *buf, uint8_t index, uint8_t mode, uint8_t duration) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_FEEDBACK, 0x06, 3);
+    *p++ = index;
+    *p++ = mode;
+    *p++ = duration;
+    return p - buf;
+}
+
+/// Get current feedback mode for an RGB LED
+inline size_t feedback_get_rgb_mode(uint8_t *buf, uint8_t index) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_FEEDBACK, 0x07, 1);
+    *p++ = index;
+    return p - buf;
+}
+
+/// Set a new RGB LED feedback mode
+inline size_t feedback_set_rgb_mode(uint8_t *buf, uint8_t index, uint8_t mode_red, uint8_t mode_green, uint8_t mode_blue) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_FEEDBACK, 0x08, 4);
+    *p++ = index;
+    *p++ = mode_red;
+    *p++ = mode_green;
+    *p++ = mode_blue;
+    return p - buf;
+}
+
+/// Store a custom feedback pattern
+inline size_t feedback_set_custom_pattern(uint8_t *buf, uint8_t index, uint8_t segments_len, const uint8_t *segments_data) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_FEEDBACK, 0x09, 2 + segments_len);
+    *p++ = index;
+    *p++ = segments_len;
+    p = write_bytes(p, segments_data, segments_len);
+    return p - buf;
+}
+
+/// Run a feedback pattern on one feedback output
+inline size_t feedback_play_pattern(uint8_t *buf, uint8_t output, uint8_t pattern, uint8_t duration) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_FEEDBACK, 0x0A, 3);
+    *p++ = output;
+    *p++ = pattern;
+    *p++ = duration;
+    return p - buf;
+}
+
+/// Get the current touch mode
+inline size_t touch_get_mode(uint8_t *buf) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_TOUCH, 0x01, 0);
+    return p - buf;
+}
+
+/// Set a new touch mode
+inline size_t touch_set_mode(uint8_t *buf, uint8_t mode) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_TOUCH, 0x02, 1);
+    *p++ = mode;
+    return p - buf;
+}
+
+/// Get current mode for specified motion sensor
+inline size_t motion_get_mode(uint8_t *buf, uint8_t index) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_MOTION, 0x01, 1);
+    *p++ = index;
+    return p - buf;
+}
+
+/// Set new mode for specified motion sensor
+inline size_t motion_set_mode(uint8_t *buf, uint8_t index, uint8_t mode) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_MOTION, 0x02, 2);
+    *p++ = index;
+    *p++ = mode;
+    return p - buf;
+}
+
+/// Start offset calibration for specified motion sensor
+inline size_t motion_calibrate(uint8_t *buf, uint8_t index, uint8_t flags) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_MOTION, 0x03, 2);
+    *p++ = index;
+    *p++ = flags;
+    return p - buf;
+}
+
+/// Get the current configuration of specified motion sensor
+inline size_t motion_get_config(uint8_t *buf, uint8_t index) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_MOTION, 0x04, 1);
+    *p++ = index;
+    return p - buf;
+}
+
+/// Set a new configuration for specified motion sensor
+inline size_t motion_set_config(uint8_t *buf, uint8_t index, uint16_t rate, uint8_t accel_range, uint8_t gyro_range, uint8_t filter, uint8_t encoding, uint16_t stream_rate) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_MOTION, 0x05, 9);
+    *p++ = index;
+    p = write_u16(p, rate);
+    *p++ = accel_range;
+    *p++ = gyro_range;
+    *p++ = filter;
+    *p++ = encoding;
+    p = write_u16(p, stream_rate);
+    return p - buf;
+}
+
+/// Get the latest reading of a flex sensor
+inline size_t flex_get_value(uint8_t *buf, uint8_t index) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_FLEX, 0x01, 1);
+    *p++ = index;
+    return p - buf;
+}
+
+/// Start, finish or cancel capturing flex sensor calibration
+inline size_t flex_calibrate(uint8_t *buf, uint8_t mode) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_FLEX, 0x02, 1);
+    *p++ = mode;
+    return p - buf;
+}
+
+/// Get the calibration of a flex sensor
+inline size_t flex_get_calibration(uint8_t *buf, uint8_t index) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_FLEX, 0x03, 1);
+    *p++ = index;
+    return p - buf;
+}
+
+/// Set and store the calibration of a flex sensor
+inline size_t flex_set_calibration(uint8_t *buf, uint8_t index, uint16_t min, uint16_t max) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_FLEX, 0x04, 5);
+    *p++ = index;
+    p = write_u16(p, min);
+    p = write_u16(p, max);
+    return p - buf;
+}
+
+/// Get the latest reading of a pressure sensor
+inline size_t pressure_get_value(uint8_t *buf, uint8_t index) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_PRESSURE, 0x01, 1);
+    *p++ = index;
+    return p - buf;
+}
+
+/// Get the press detection thresholds
+inline size_t pressure_get_config(uint8_t *buf) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_PRESSURE, 0x02, 0);
+    return p - buf;
+}
+
+/// Set the press detection thresholds
+inline size_t pressure_set_config(uint8_t *buf, uint8_t press, uint8_t release, uint8_t deadband) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_PRESSURE, 0x03, 3);
+    *p++ = press;
+    *p++ = release;
+    *p++ = deadband;
+    return p - buf;
+}
+
+/// Store a keyboard macro in an EEPROM macro slot
+inline size_t touchset_set_macro(uint8_t *buf, uint8_t index, uint8_t macro_len, const uint8_t *macro_data) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_TOUCHSET, 0x01, 2 + macro_len);
+    *p++ = index;
+    *p++ = macro_len;
+    p = write_bytes(p, macro_data, macro_len);
+    return p - buf;
+}
+
+/// Start typing a stored keyboard macro
+inline size_t touchset_play_macro(uint8_t *buf, uint8_t index) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_TOUCHSET, 0x02, 1);
+    *p++ = index;
+    return p - buf;
+}
+
+/// Cancel the keyboard macro currently playing
+inline size_t touchset_stop_macro(uint8_t *buf) {
+    uint8_t *p = write_header(buf, PACKET_TYPE_COMMAND, CLASS_TOUCHSET, 0x03, 0);
+    return p - buf;
+}
+
+} // namespace cmd
+
+/* ============== */
+/* RESPONSE VIEWS */
+/* ============== */
+
+namespace rsp {
+
+/// Response to cmd::system_ping()
+struct system_ping {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_SYSTEM, id = 0x01, min_length = 4 };
+    explicit system_ping(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint32_t uptime() const { return read_u32(payload_ + 0); }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::system_reset()
+struct system_reset {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_SYSTEM, id = 0x02, min_length = 2 };
+    explicit system_reset(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint16_t result() const { return read_u16(payload_ + 0); }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::system_get_info()
+struct system_get_info {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_SYSTEM, id = 0x03, min_length = 12 };
+    explicit system_get_info(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint16_t major() const { return read_u16(payload_ + 0); }
+    uint16_t minor() const { return read_u16(payload_ + 2); }
+    uint16_t patch() const { return read_u16(payload_ + 4); }
+    uint16_t protocol() const { return read_u16(payload_ + 6); }
+    uint32_t timestamp() const { return read_u32(payload_ + 8); }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::system_get_capabilities()
+struct system_get_capabilities {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_SYSTEM, id = 0x04, min_length = 2 };
+    explicit system_get_capabilities(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint16_t count() const { return read_u16(payload_ + 0); }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::system_get_memory()
+struct system_get_memory {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_SYSTEM, id = 0x05, min_length = 8 };
+    explicit system_get_memory(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint32_t free_ram() const { return read_u32(payload_ + 0); }
+    uint32_t total_ram() const { return read_u32(payload_ + 4); }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::system_get_battery_status()
+struct system_get_battery_status {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_SYSTEM, id = 0x06, min_length = 2 };
+    explicit system_get_battery_status(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint8_t status() const { return payload_[0]; }
+    uint8_t level() const { return payload_[1]; }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::system_set_timer()
+struct system_set_timer {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_SYSTEM, id = 0x07, min_length = 2 };
+    explicit system_set_timer(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint16_t result() const { return read_u16(payload_ + 0); }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::system_get_time()
+struct system_get_time {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_SYSTEM, id = 0x08, min_length = 9 };
+    explicit system_get_time(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint32_t seconds() const { return read_u32(payload_ + 0); }
+    uint8_t subticks() const { return payload_[4]; }
+    uint32_t microseconds() const { return read_u32(payload_ + 5); }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::system_get_timestamp_mode()
+struct system_get_timestamp_mode {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_SYSTEM, id = 0x09, min_length = 1 };
+    explicit system_get_timestamp_mode(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint8_t mode() const { return payload_[0]; }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::system_set_timestamp_mode()
+struct system_set_timestamp_mode {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_SYSTEM, id = 0x0A, min_length = 2 };
+    explicit system_set_timestamp_mode(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint16_t result() const { return read_u16(payload_ + 0); }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::system_get_event_mask()
+struct system_get_event_mask {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_SYSTEM, id = 0x0B, min_length = 4 };
+    explicit system_get_event_mask(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint16_t result() const { return read_u16(payload_ + 0); }
+    uint16_t mask() const { return read_u16(payload_ + 2); }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::system_set_event_mask()
+struct system_set_event_mask {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_SYSTEM, id = 0x0C, min_length = 2 };
+    explicit system_set_event_mask(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint16_t result() const { return read_u16(payload_ + 0); }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::system_get_event_rate()
+struct system_get_event_rate {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_SYSTEM, id = 0x0D, min_length = 5 };
+    explicit system_get_event_rate(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint16_t result() const { return read_u16(payload_ + 0); }
+    uint8_t interval() const { return payload_[2]; }
+    uint16_t ids() const { return read_u16(payload_ + 3); }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::system_set_event_rate()
+struct system_set_event_rate {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_SYSTEM, id = 0x0E, min_length = 2 };
+    explicit system_set_event_rate(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint16_t result() const { return read_u16(payload_ + 0); }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::system_get_log_level()
+struct system_get_log_level {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_SYSTEM, id = 0x0F, min_length = 1 };
+    explicit system_get_log_level(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint8_t level() const { return payload_[0]; }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::system_set_log_level()
+struct system_set_log_level {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_SYSTEM, id = 0x10, min_length = 2 };
+    explicit system_set_log_level(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint16_t result() const { return read_u16(payload_ + 0); }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::system_get_memory_stats()
+struct system_get_memory_stats {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_SYSTEM, id = 0x11, min_length = 11 };
+    explicit system_get_memory_stats(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint16_t free_ram() const { return read_u16(payload_ + 0); }
+    uint16_t stack_headroom() const { return read_u16(payload_ + 2); }
+    uint16_t heap_size() const { return read_u16(payload_ + 4); }
+    uint16_t heap_free() const { return read_u16(payload_ + 6); }
+    uint16_t largest_free() const { return read_u16(payload_ + 8); }
+    uint8_t free_blocks() const { return payload_[10]; }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::system_get_memory_allocations()
+struct system_get_memory_allocations {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_SYSTEM, id = 0x12, min_length = 10 };
+    explicit system_get_memory_allocations(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint16_t result() const { return read_u16(payload_ + 0); }
+    uint32_t allocations() const { return read_u32(payload_ + 2); }
+    uint16_t blocks() const { return read_u16(payload_ + 6); }
+    uint16_t failures() const { return read_u16(payload_ + 8); }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::system_get_memory_threshold()
+struct system_get_memory_threshold {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_SYSTEM, id = 0x13, min_length = 2 };
+    explicit system_get_memory_threshold(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint16_t threshold() const { return read_u16(payload_ + 0); }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::system_set_memory_threshold()
+struct system_set_memory_threshold {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_SYSTEM, id = 0x14, min_length = 2 };
+    explicit system_set_memory_threshold(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint16_t result() const { return read_u16(payload_ + 0); }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::bluetooth_get_mode()
+struct bluetooth_get_mode {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_BLUETOOTH, id = 0x01, min_length = 3 };
+    explicit bluetooth_get_mode(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint16_t result() const { return read_u16(payload_ + 0); }
+    uint8_t mode() const { return payload_[2]; }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::bluetooth_set_mode()
+struct bluetooth_set_mode {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_BLUETOOTH, id = 0x02, min_length = 2 };
+    explicit bluetooth_set_mode(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint16_t result() const { return read_u16(payload_ + 0); }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::bluetooth_reset()
+struct bluetooth_reset {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_BLUETOOTH, id = 0x03, min_length = 2 };
+    explicit bluetooth_reset(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint16_t result() const { return read_u16(payload_ + 0); }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::bluetooth_get_mac()
+struct bluetooth_get_mac {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_BLUETOOTH, id = 0x04, min_length = 8 };
+    explicit bluetooth_get_mac(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint16_t result() const { return read_u16(payload_ + 0); }
+    const uint8_t *address() const { return payload_ + 2; }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::bluetooth_get_pairings()
+struct bluetooth_get_pairings {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_BLUETOOTH, id = 0x05, min_length = 3 };
+    explicit bluetooth_get_pairings(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint16_t result() const { return read_u16(payload_ + 0); }
+    uint8_t count() const { return payload_[2]; }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::bluetooth_discover()
+struct bluetooth_discover {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_BLUETOOTH, id = 0x06, min_length = 2 };
+    explicit bluetooth_discover(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint16_t result() const { return read_u16(payload_ + 0); }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::bluetooth_pair()
+struct bluetooth_pair {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_BLUETOOTH, id = 0x07, min_length = 2 };
+    explicit bluetooth_pair(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint16_t result() const { return read_u16(payload_ + 0); }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::bluetooth_delete_pairing()
+struct bluetooth_delete_pairing {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_BLUETOOTH, id = 0x08, min_length = 2 };
+    explicit bluetooth_delete_pairing(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint16_t result() const { return read_u16(payload_ + 0); }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::bluetooth_clear_pairings()
+struct bluetooth_clear_pairings {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_BLUETOOTH, id = 0x09, min_length = 2 };
+    explicit bluetooth_clear_pairings(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint16_t result() const { return read_u16(payload_ + 0); }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::bluetooth_get_connections()
+struct bluetooth_get_connections {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_BLUETOOTH, id = 0x0A, min_length = 3 };
+    explicit bluetooth_get_connections(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint16_t result() const { return read_u16(payload_ + 0); }
+    uint8_t count() const { return payload_[2]; }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::bluetooth_connect()
+struct bluetooth_connect {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_BLUETOOTH, id = 0x0B, min_length = 2 };
+    explicit bluetooth_connect(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint16_t result() const { return read_u16(payload_ + 0); }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::bluetooth_disconnect()
+struct bluetooth_disconnect {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_BLUETOOTH, id = 0x0C, min_length = 2 };
+    explicit bluetooth_disconnect(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint16_t result() const { return read_u16(payload_ + 0); }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::feedback_get_blink_mode()
+struct feedback_get_blink_mode {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_FEEDBACK, id = 0x01, min_length = 1 };
+    explicit feedback_get_blink_mode(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint8_t mode() const { return payload_[0]; }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::feedback_set_blink_mode()
+struct feedback_set_blink_mode {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_FEEDBACK, id = 0x02, min_length = 2 };
+    explicit feedback_set_blink_mode(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint16_t result() const { return read_u16(payload_ + 0); }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::feedback_get_piezo_mode()
+struct feedback_get_piezo_mode {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_FEEDBACK, id = 0x03, min_length = 4 };
+    explicit feedback_get_piezo_mode(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint8_t mode() const { return payload_[0]; }
+    uint8_t duration() const { return payload_[1]; }
+    uint16_t frequency() const { return read_u16(payload_ + 2); }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::feedback_set_piezo_mode()
+struct feedback_set_piezo_mode {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_FEEDBACK, id = 0x04, min_length = 2 };
+    explicit feedback_set_piezo_mode(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint16_t result() const { return read_u16(payload_ + 0); }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::feedback_get_vibrate_mode()
+struct feedback_get_vibrate_mode {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_FEEDBACK, id = 0x05, min_length = 2 };
+    explicit feedback_get_vibrate_mode(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint8_t mode() const { return payload_[0]; }
+    uint8_t duration() const { return payload_[1]; }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::feedback_set_vibrate_mode()
+struct feedback_set_vibrate_mode {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_FEEDBACK, id = 0x06, min_length = 2 };
+    explicit feedback_set_vibrate_mode(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint16_t result() const { return read_u16(payload_ + 0); }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::feedback_get_rgb_mode()
+struct feedback_get_rgb_mode {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_FEEDBACK, id = 0x07, min_length = 3 };
+    explicit feedback_get_rgb_mode(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint8_t mode_red() const { return payload_[0]; }
+    uint8_t mode_green() const { return payload_[1]; }
+    uint8_t mode_blue() const { return payload_[2]; }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::feedback_set_rgb_mode()
+struct feedback_set_rgb_mode {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_FEEDBACK, id = 0x08, min_length = 2 };
+    explicit feedback_set_rgb_mode(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint16_t result() const { return read_u16(payload_ + 0); }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::feedback_set_custom_pattern()
+struct feedback_set_custom_pattern {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_FEEDBACK, id = 0x09, min_length = 2 };
+    explicit feedback_set_custom_pattern(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint16_t result() const { return read_u16(payload_ + 0); }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::feedback_play_pattern()
+struct feedback_play_pattern {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_FEEDBACK, id = 0x0A, min_length = 2 };
+    explicit feedback_play_pattern(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint16_t result() const { return read_u16(payload_ + 0); }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::touch_get_mode()
+struct touch_get_mode {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_TOUCH, id = 0x01, min_length = 1 };
+    explicit touch_get_mode(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint8_t mode() const { return payload_[0]; }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::touch_set_mode()
+struct touch_set_mode {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_TOUCH, id = 0x02, min_length = 2 };
+    explicit touch_set_mode(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint16_t result() const { return read_u16(payload_ + 0); }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::motion_get_mode()
+struct motion_get_mode {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_MOTION, id = 0x01, min_length = 1 };
+    explicit motion_get_mode(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint8_t mode() const { return payload_[0]; }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::motion_set_mode()
+struct motion_set_mode {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_MOTION, id = 0x02, min_length = 2 };
+    explicit motion_set_mode(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint16_t result() const { return read_u16(payload_ + 0); }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::motion_calibrate()
+struct motion_calibrate {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_MOTION, id = 0x03, min_length = 2 };
+    explicit motion_calibrate(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint16_t result() const { return read_u16(payload_ + 0); }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::motion_get_config()
+struct motion_get_config {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_MOTION, id = 0x04, min_length = 10 };
+    explicit motion_get_config(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint16_t result() const { return read_u16(payload_ + 0); }
+    uint16_t rate() const { return read_u16(payload_ + 2); }
+    uint8_t accel_range() const { return payload_[4]; }
+    uint8_t gyro_range() const { return payload_[5]; }
+    uint8_t filter() const { return payload_[6]; }
+    uint8_t encoding() const { return payload_[7]; }
+    uint16_t stream_rate() const { return read_u16(payload_ + 8); }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::motion_set_config()
+struct motion_set_config {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_MOTION, id = 0x05, min_length = 2 };
+    explicit motion_set_config(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint16_t result() const { return read_u16(payload_ + 0); }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::flex_get_value()
+struct flex_get_value {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_FLEX, id = 0x01, min_length = 5 };
+    explicit flex_get_value(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint16_t result() const { return read_u16(payload_ + 0); }
+    uint8_t value() const { return payload_[2]; }
+    uint16_t raw() const { return read_u16(payload_ + 3); }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::flex_calibrate()
+struct flex_calibrate {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_FLEX, id = 0x02, min_length = 2 };
+    explicit flex_calibrate(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint16_t result() const { return read_u16(payload_ + 0); }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::flex_get_calibration()
+struct flex_get_calibration {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_FLEX, id = 0x03, min_length = 6 };
+    explicit flex_get_calibration(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint16_t result() const { return read_u16(payload_ + 0); }
+    uint16_t min() const { return read_u16(payload_ + 2); }
+    uint16_t max() const { return read_u16(payload_ + 4); }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::flex_set_calibration()
+struct flex_set_calibration {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_FLEX, id = 0x04, min_length = 2 };
+    explicit flex_set_calibration(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint16_t result() const { return read_u16(payload_ + 0); }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::pressure_get_value()
+struct pressure_get_value {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_PRESSURE, id = 0x01, min_length = 7 };
+    explicit pressure_get_value(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint16_t result() const { return read_u16(payload_ + 0); }
+    uint8_t state() const { return payload_[2]; }
+    uint8_t value() const { return payload_[3]; }
+    uint8_t velocity() const { return payload_[4]; }
+    uint16_t raw() const { return read_u16(payload_ + 5); }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::pressure_get_config()
+struct pressure_get_config {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_PRESSURE, id = 0x02, min_length = 3 };
+    explicit pressure_get_config(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint8_t press() const { return payload_[0]; }
+    uint8_t release() const { return payload_[1]; }
+    uint8_t deadband() const { return payload_[2]; }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::pressure_set_config()
+struct pressure_set_config {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_PRESSURE, id = 0x03, min_length = 2 };
+    explicit pressure_set_config(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint16_t result() const { return read_u16(payload_ + 0); }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::touchset_set_macro()
+struct touchset_set_macro {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_TOUCHSET, id = 0x01, min_length = 2 };
+    explicit touchset_set_macro(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint16_t result() const { return read_u16(payload_ + 0); }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::touchset_play_macro()
+struct touchset_play_macro {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_TOUCHSET, id = 0x02, min_length = 2 };
+    explicit touchset_play_macro(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint16_t result() const { return read_u16(payload_ + 0); }
+    const uint8_t *payload_;
+};
+
+/// Response to cmd::touchset_stop_macro()
+struct touchset_stop_macro {
+    enum { packet_type = PACKET_TYPE_COMMAND, class_id = CLASS_TOUCHSET, id = 0x03, min_length = 2 };
+    explicit touchset_stop_macro(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint16_t result() const { return read_u16(payload_ + 0); }
+    const uint8_t *payload_;
+};
+
+} // namespace rsp
+
+/* =========== */
+/* EVENT VIEWS */
+/* =========== */
+
+namespace evt {
+
+/// Occurs when a problem exists with a command you have sent
+struct protocol_error {
+    enum { packet_type = PACKET_TYPE_EVENT, class_id = CLASS_PROTOCOL, id = 0x01, min_length = 2 };
+    explicit protocol_error(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint16_t code() const { return read_u16(payload_ + 0); }
+    const uint8_t *payload_;
+};
+
+/// Indicates that Keyglove has started the boot process
+struct system_boot {
+    enum { packet_type = PACKET_TYPE_EVENT, class_id = CLASS_SYSTEM, id = 0x01, min_length = 12 };
+    explicit system_boot(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint16_t major() const { return read_u16(payload_ + 0); }
+    uint16_t minor() const { return read_u16(payload_ + 2); }
+    uint16_t patch() const { return read_u16(payload_ + 4); }
+    uint16_t protocol() const { return read_u16(payload_ + 6); }
+    uint32_t timestamp() const { return read_u32(payload_ + 8); }
+    const uint8_t *payload_;
+};
+
+/// Indicates that Keyglove has completed the boot process
+struct system_ready {
+    enum { packet_type = PACKET_TYPE_EVENT, class_id = CLASS_SYSTEM, id = 0x02, min_length = 0 };
+    explicit system_ready(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    const uint8_t *payload_;
+};
+
+/// Indicates that Keyglove has encountered an error
+struct system_error {
+    enum { packet_type = PACKET_TYPE_EVENT, class_id = CLASS_SYSTEM, id = 0x03, min_length = 2 };
+    explicit system_error(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint16_t code() const { return read_u16(payload_ + 0); }
+    const uint8_t *payload_;
+};
+
+/// Provides a record describing specific capabilities designed into this unit.
+struct system_capability {
+    enum { packet_type = PACKET_TYPE_EVENT, class_id = CLASS_SYSTEM, id = 0x04, min_length = 2 };
+    explicit system_capability(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *payload, size_t length) { return length >= min_length && length >= (size_t)min_length + payload[1]; }
+    uint8_t category() const { return payload_[0]; }
+    bytes record() const { bytes b = { payload_ + 2, payload_[1] }; return b; }
+    const uint8_t *payload_;
+};
+
+/// Indicates that battery status has changed
+struct system_battery_status {
+    enum { packet_type = PACKET_TYPE_EVENT, class_id = CLASS_SYSTEM, id = 0x05, min_length = 2 };
+    explicit system_battery_status(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint8_t status() const { return payload_[0]; }
+    uint8_t level() const { return payload_[1]; }
+    const uint8_t *payload_;
+};
+
+/// Indicates that a previously scheduled software timer has elapsed
+struct system_timer_tick {
+    enum { packet_type = PACKET_TYPE_EVENT, class_id = CLASS_SYSTEM, id = 0x06, min_length = 6 };
+    explicit system_timer_tick(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint8_t handle() const { return payload_[0]; }
+    uint32_t seconds() const { return read_u32(payload_ + 1); }
+    uint8_t subticks() const { return payload_[5]; }
+    const uint8_t *payload_;
+};
+
+/// Indicates that the event timestamp mode has changed
+struct system_timestamp_mode {
+    enum { packet_type = PACKET_TYPE_EVENT, class_id = CLASS_SYSTEM, id = 0x07, min_length = 1 };
+    explicit system_timestamp_mode(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint8_t mode() const { return payload_[0]; }
+    const uint8_t *payload_;
+};
+
+/// Indicates that memory headroom has dropped below the threshold
+struct system_memory_low {
+    enum { packet_type = PACKET_TYPE_EVENT, class_id = CLASS_SYSTEM, id = 0x08, min_length = 4 };
+    explicit system_memory_low(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint16_t headroom() const { return read_u16(payload_ + 0); }
+    uint16_t threshold() const { return read_u16(payload_ + 2); }
+    const uint8_t *payload_;
+};
+
+/// Indicates that the Bluetooth mode has been changed
+struct bluetooth_mode {
+    enum { packet_type = PACKET_TYPE_EVENT, class_id = CLASS_BLUETOOTH, id = 0x01, min_length = 1 };
+    explicit bluetooth_mode(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint8_t mode() const { return payload_[0]; }
+    const uint8_t *payload_;
+};
+
+/// Indicates that the Bluetooth subsystem is ready for use
+struct bluetooth_ready {
+    enum { packet_type = PACKET_TYPE_EVENT, class_id = CLASS_BLUETOOTH, id = 0x02, min_length = 0 };
+    explicit bluetooth_ready(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    const uint8_t *payload_;
+};
+
+/// Indicates that a new device has been paired
+struct bluetooth_inquiry_response {
+    enum { packet_type = PACKET_TYPE_EVENT, class_id = CLASS_BLUETOOTH, id = 0x03, min_length = 13 };
+    explicit bluetooth_inquiry_response(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *payload, size_t length) { return length >= min_length && length >= (size_t)min_length + payload[12]; }
+    const uint8_t *address() const { return payload_ + 0; }
+    const uint8_t *cod() const { return payload_ + 6; }
+    int8_t rssi() const { return (int8_t)payload_[9]; }
+    uint8_t status() const { return payload_[10]; }
+    uint8_t pairing() const { return payload_[11]; }
+    bytes name() const { bytes b = { payload_ + 13, payload_[12] }; return b; }
+    const uint8_t *payload_;
+};
+
+/// Indicates that an ongoing Bluetooth discovery process has finished
+struct bluetooth_inquiry_complete {
+    enum { packet_type = PACKET_TYPE_EVENT, class_id = CLASS_BLUETOOTH, id = 0x04, min_length = 1 };
+    explicit bluetooth_inquiry_complete(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint8_t count() const { return payload_[0]; }
+    const uint8_t *payload_;
+};
+
+/// Provides a single pairing entry detailed status record
+struct bluetooth_pairing_status {
+    enum { packet_type = PACKET_TYPE_EVENT, class_id = CLASS_BLUETOOTH, id = 0x05, min_length = 11 };
+    explicit bluetooth_pairing_status(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *payload, size_t length) { return length >= min_length && length >= (size_t)min_length + payload[10]; }
+    uint8_t pairing() const { return payload_[0]; }
+    const uint8_t *address() const { return payload_ + 1; }
+    uint8_t priority() const { return payload_[7]; }
+    uint8_t profiles_supported() const { return payload_[8]; }
+    uint8_t profiles_active() const { return payload_[9]; }
+    bytes handle_list() const { bytes b = { payload_ + 11, payload_[10] }; return b; }
+    const uint8_t *payload_;
+};
+
+/// Indicates that a pending pair attempt has failed
+struct bluetooth_pairing_failed {
+    enum { packet_type = PACKET_TYPE_EVENT, class_id = CLASS_BLUETOOTH, id = 0x06, min_length = 6 };
+    explicit bluetooth_pairing_failed(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    const uint8_t *address() const { return payload_ + 0; }
+    const uint8_t *payload_;
+};
+
+/// Indicates that all pairings have been removed
+struct bluetooth_pairings_cleared {
+    enum { packet_type = PACKET_TYPE_EVENT, class_id = CLASS_BLUETOOTH, id = 0x07, min_length = 0 };
+    explicit bluetooth_pairings_cleared(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    const uint8_t *payload_;
+};
+
+/// Indicates that a paired device has connected
+struct bluetooth_connection_status {
+    enum { packet_type = PACKET_TYPE_EVENT, class_id = CLASS_BLUETOOTH, id = 0x08, min_length = 10 };
+    explicit bluetooth_connection_status(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint8_t handle() const { return payload_[0]; }
+    const uint8_t *address() const { return payload_ + 1; }
+    uint8_t pairing() const { return payload_[7]; }
+    uint8_t profile() const { return payload_[8]; }
+    uint8_t status() const { return payload_[9]; }
+    const uint8_t *payload_;
+};
+
+/// Indicates that an active connection has been closed
+struct bluetooth_connection_closed {
+    enum { packet_type = PACKET_TYPE_EVENT, class_id = CLASS_BLUETOOTH, id = 0x09, min_length = 3 };
+    explicit bluetooth_connection_closed(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint8_t handle() const { return payload_[0]; }
+    uint16_t reason() const { return read_u16(payload_ + 1); }
+    const uint8_t *payload_;
+};
+
+/// Indicates that the blink feedback mode has changed
+struct feedback_blink_mode {
+    enum { packet_type = PACKET_TYPE_EVENT, class_id = CLASS_FEEDBACK, id = 0x01, min_length = 1 };
+    explicit feedback_blink_mode(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint8_t mode() const { return payload_[0]; }
+    const uint8_t *payload_;
+};
+
+/// Indicates that a piezo buzzer feedback mode has changed
+struct feedback_piezo_mode {
+    enum { packet_type = PACKET_TYPE_EVENT, class_id = CLASS_FEEDBACK, id = 0x02, min_length = 5 };
+    explicit feedback_piezo_mode(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint8_t index() const { return payload_[0]; }
+    uint8_t mode() const { return payload_[1]; }
+    uint8_t duration() const { return payload_[2]; }
+    uint16_t frequency() const { return read_u16(payload_ + 3); }
+    const uint8_t *payload_;
+};
+
+/// Indicates that a vibration feedback mode has changed
+struct feedback_vibrate_mode {
+    enum { packet_type = PACKET_TYPE_EVENT, class_id = CLASS_FEEDBACK, id = 0x03, min_length = 3 };
+    explicit feedback_vibrate_mode(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint8_t index() const { return payload_[0]; }
+    uint8_t mode() const { return payload_[1]; }
+    uint8_t duration() const { return payload_[2]; }
+    const uint8_t *payload_;
+};
+
+/// Indicates that an RGB LED feedback mode has changed
+struct feedback_rgb_mode {
+    enum { packet_type = PACKET_TYPE_EVENT, class_id = CLASS_FEEDBACK, id = 0x04, min_length = 4 };
+    explicit feedback_rgb_mode(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint8_t index() const { return payload_[0]; }
+    uint8_t mode_red() const { return payload_[1]; }
+    uint8_t mode_green() const { return payload_[2]; }
+    uint8_t mode_blue() const { return payload_[3]; }
+    const uint8_t *payload_;
+};
+
+/// Indicates that a feedback pattern has been started on a feedback output
+struct feedback_pattern {
+    enum { packet_type = PACKET_TYPE_EVENT, class_id = CLASS_FEEDBACK, id = 0x05, min_length = 3 };
+    explicit feedback_pattern(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint8_t output() const { return payload_[0]; }
+    uint8_t pattern() const { return payload_[1]; }
+    uint8_t duration() const { return payload_[2]; }
+    const uint8_t *payload_;
+};
+
+/// Indicates that the touch mode has changed
+struct touch_mode {
+    enum { packet_type = PACKET_TYPE_EVENT, class_id = CLASS_TOUCH, id = 0x01, min_length = 1 };
+    explicit touch_mode(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint8_t mode() const { return payload_[0]; }
+    const uint8_t *payload_;
+};
+
+/// Indicates that the touch sensor status has changed
+struct touch_status {
+    enum { packet_type = PACKET_TYPE_EVENT, class_id = CLASS_TOUCH, id = 0x02, min_length = 1 };
+    explicit touch_status(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *payload, size_t length) { return length >= min_length && length >= (size_t)min_length + payload[0]; }
+    bytes status() const { bytes b = { payload_ + 1, payload_[0] }; return b; }
+    const uint8_t *payload_;
+};
+
+/// Indicates that a motion sensor's mode has changed
+struct motion_mode {
+    enum { packet_type = PACKET_TYPE_EVENT, class_id = CLASS_MOTION, id = 0x01, min_length = 2 };
+    explicit motion_mode(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint8_t index() const { return payload_[0]; }
+    uint8_t mode() const { return payload_[1]; }
+    const uint8_t *payload_;
+};
+
+/// Indicates that a motion sensor's measurement data has been updated
+struct motion_data {
+    enum { packet_type = PACKET_TYPE_EVENT, class_id = CLASS_MOTION, id = 0x02, min_length = 3 };
+    explicit motion_data(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *payload, size_t length) { return length >= min_length && length >= (size_t)min_length + payload[2]; }
+    uint8_t index() const { return payload_[0]; }
+    uint8_t flags() const { return payload_[1]; }
+    bytes data() const { bytes b = { payload_ + 3, payload_[2] }; return b; }
+    const uint8_t *payload_;
+};
+
+/// Motion state change detected, such as 'still' or 'moving'
+struct motion_state {
+    enum { packet_type = PACKET_TYPE_EVENT, class_id = CLASS_MOTION, id = 0x03, min_length = 2 };
+    explicit motion_state(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint8_t index() const { return payload_[0]; }
+    uint8_t state() const { return payload_[1]; }
+    const uint8_t *payload_;
+};
+
+/// Indicates progress of a motion sensor offset calibration
+struct motion_calibration {
+    enum { packet_type = PACKET_TYPE_EVENT, class_id = CLASS_MOTION, id = 0x04, min_length = 3 };
+    explicit motion_calibration(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint8_t index() const { return payload_[0]; }
+    uint8_t status() const { return payload_[1]; }
+    uint8_t progress() const { return payload_[2]; }
+    const uint8_t *payload_;
+};
+
+/// Indicates that a motion gesture has been recognized
+struct motion_gesture {
+    enum { packet_type = PACKET_TYPE_EVENT, class_id = CLASS_MOTION, id = 0x05, min_length = 4 };
+    explicit motion_gesture(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint8_t index() const { return payload_[0]; }
+    uint8_t gesture() const { return payload_[1]; }
+    uint8_t axis() const { return payload_[2]; }
+    uint8_t strength() const { return payload_[3]; }
+    const uint8_t *payload_;
+};
+
+/// Indicates that a motion sensor's configuration has changed
+struct motion_config {
+    enum { packet_type = PACKET_TYPE_EVENT, class_id = CLASS_MOTION, id = 0x06, min_length = 9 };
+    explicit motion_config(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint8_t index() const { return payload_[0]; }
+    uint16_t rate() const { return read_u16(payload_ + 1); }
+    uint8_t accel_range() const { return payload_[3]; }
+    uint8_t gyro_range() const { return payload_[4]; }
+    uint8_t filter() const { return payload_[5]; }
+    uint8_t encoding() const { return payload_[6]; }
+    uint16_t stream_rate() const { return read_u16(payload_ + 7); }
+    const uint8_t *payload_;
+};
+
+/// Indicates that a finger's bend has changed
+struct flex_value {
+    enum { packet_type = PACKET_TYPE_EVENT, class_id = CLASS_FLEX, id = 0x01, min_length = 2 };
+    explicit flex_value(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint8_t index() const { return payload_[0]; }
+    uint8_t value() const { return payload_[1]; }
+    const uint8_t *payload_;
+};
+
+/// Indicates that a fingertip press has reached its peak
+struct pressure_press {
+    enum { packet_type = PACKET_TYPE_EVENT, class_id = CLASS_PRESSURE, id = 0x01, min_length = 3 };
+    explicit pressure_press(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint8_t index() const { return payload_[0]; }
+    uint8_t velocity() const { return payload_[1]; }
+    uint8_t peak() const { return payload_[2]; }
+    const uint8_t *payload_;
+};
+
+/// Indicates that a fingertip press has ended
+struct pressure_release {
+    enum { packet_type = PACKET_TYPE_EVENT, class_id = CLASS_PRESSURE, id = 0x02, min_length = 1 };
+    explicit pressure_release(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint8_t index() const { return payload_[0]; }
+    const uint8_t *payload_;
+};
+
+/// Indicates that the force of a held press has changed
+struct pressure_value {
+    enum { packet_type = PACKET_TYPE_EVENT, class_id = CLASS_PRESSURE, id = 0x03, min_length = 2 };
+    explicit pressure_value(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint8_t index() const { return payload_[0]; }
+    uint8_t value() const { return payload_[1]; }
+    const uint8_t *payload_;
+};
+
+/// Indicates that the press detection thresholds have changed
+struct pressure_config {
+    enum { packet_type = PACKET_TYPE_EVENT, class_id = CLASS_PRESSURE, id = 0x04, min_length = 3 };
+    explicit pressure_config(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint8_t press() const { return payload_[0]; }
+    uint8_t release() const { return payload_[1]; }
+    uint8_t deadband() const { return payload_[2]; }
+    const uint8_t *payload_;
+};
+
+/// Indicates that keyboard macro playback has started, finished or been cancelled
+struct touchset_macro_status {
+    enum { packet_type = PACKET_TYPE_EVENT, class_id = CLASS_TOUCHSET, id = 0x01, min_length = 2 };
+    explicit touchset_macro_status(const uint8_t *payload) : payload_(payload) {}
+    static bool valid(const uint8_t *, size_t length) { return length >= min_length; }
+    uint8_t index() const { return payload_[0]; }
+    uint8_t status() const { return payload_[1]; }
+    const uint8_t *payload_;
+};
+
+} // namespace evt
+
+/* ============== */
+/* DISPATCH TABLE */
+/* ============== */
+
+/**
+ * @brief Calls a handler for each received packet from a fixed class/ID table
+ *
+ * Register a handler for any response or event view type, e.g.
+ *
+ *     void on_flex(void *glove, const keyglove::evt::flex_value &v) { ... }
+ *     dispatcher.on<keyglove::evt::flex_value>(on_flex, glove);
+ *
+ * Each glove normally has its own dispatcher, with its own context pointer.
+ * Views of timestamped events don't include the timestamp; the raw packet is
+ * still there for packet_timestamp() if the handler needs it.
+ */
+class dispatcher {
+public:
+    typedef void (*raw_handler)(void *context, const uint8_t *packet, size_t length);
+
+    dispatcher() : unhandled_(0), unhandled_context_(0) {
+        memset(responses_, 0, sizeof(responses_));
+        memset(events_, 0, sizeof(events_));
+    }
+
+    /**
+     * @brief Set or clear (with 0) the handler for one response or event type
+     */
+    template <class View>
+    void on(void (*handler)(void *context, const View &view), void *context = 0) {
+        slot &s = (View::packet_type == PACKET_TYPE_EVENT ? events_ : responses_)[View::class_id][View::id];
+        s.call = handler ? &call<View> : 0;
+        s.handler = (void (*)())handler;
+        s.context = context;
+    }
+
+    /**
+     * @brief Set the handler for packets with no handler of their own, or which are malformed
+     */
+    void on_unhandled(raw_handler handler, void *context = 0) {
+        unhandled_ = handler;
+        unhandled_context_ = context;
+    }
+
+    /**
+     * @brief Pass one complete packet to its handler
+     * @return True if a view handler took the packet
+     */
+    bool dispatch(const uint8_t *packet, size_t length) const {
+        if (length >= PACKET_HEADER_SIZE && length == packet_length(packet) && packet[2] < CLASS_COUNT && packet[3] < ID_COUNT) {
+            const slot &s = ((packet[0] & 0xC0) == PACKET_TYPE_COMMAND ? responses_ : events_)[packet[2]][packet[3]];
+            size_t payload_length = length - PACKET_HEADER_SIZE;
+            if (packet_timestamp_mode(packet)) {
+                payload_length = payload_length >= PACKET_TIMESTAMP_SIZE ? payload_length - PACKET_TIMESTAMP_SIZE : 0;
+            }
+            if (s.call && s.call(s, packet + PACKET_HEADER_SIZE, payload_length)) return true;
+        }
+        if (unhandled_) unhandled_(unhandled_context_, packet, length);
+        return false;
+    }
+
+private:
+    struct slot {
+        bool (*call)(const slot &s, const uint8_t *payload, size_t length);
+        void (*handler)();
+        void *context;
+    };
+
+    template <class View>
+    static bool call(const slot &s, const uint8_t *payload, size_t length) {
+        if (!View::valid(payload, length)) return false;
+        ((void (*)(void *, const View &))s.handler)(s.context, View(payload));
+        return true;
+    }
+
+    slot responses_[CLASS_COUNT][ID_COUNT];
+    slot events_[CLASS_COUNT][ID_COUNT];
+    raw_handler unhandled_;
+    void *unhandled_context_;
+};
+
+} // namespace keyglove
+
+#endif // _KEYGLOVE_KGAPI_H_
@@ -0,0 +1,303 @@
+// Keyglove host SDK - Serial and raw HID transport
+// 2014-12-14 by Jeff Rowberg <jeff@rowberg.net>
+
+/*
+================================================================================
+Keyglove source code is placed under the MIT license
+Copyright (c) 2014 Jeff Rowberg
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+================================================================================
+*/
+
+
+/**
+ * @file transport.cpp
+ * @brief Serial and raw HID transport
+ * @author Jeff Rowberg
+ * @date 2014-12-14
+ *
+ * This file moves KGAPI packets between the host and any number of Keyglove
+ * devices, connected either as a USB/Bluetooth serial port or as a Linux hidraw
+ * device. Every device is opened non-blocking and registered with one epoll
+ * instance, so a single poll() call waits on all of them at once.
+ *
+ * Received bytes are appended to a per-device buffer and complete packets are
+ * handed to the packet handler in place, as pointers into that buffer, so no
+ * packet is ever copied between the read() call and the dispatcher. Only the
+ * incomplete tail (less than one packet) is moved to the front of the buffer
+ * afterwards. If the stream gets out of step, bytes are skipped until one that
+ * can start a packet is found, the same way the firmware's parser recovers.
+ *
+ * Raw HID reports carry the data length in their first byte and up to 63 data
+ * bytes after it, in both directions. Outgoing reports are prefixed with the
+ * report ID (0) that hidraw expects.
+ *
+ * Normally it is not necessary to edit this file.
+ */
+
+#include "transport.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace keyglove {
+
+const int transport::MAX_DEVICES;
+const size_t transport::BUFFER_SIZE;
+const size_t transport::HID_REPORT_SIZE;
+
+/**
+ * @brief Create a transport with no devices open
+ * @param[in] handler Function to receive each complete packet
+ * @param[in] context Pointer passed back to the handler unchanged
+ */
+transport::transport(packet_handler handler, void *context) : handler_(handler), context_(context) {
+    epoll_ = epoll_create1(EPOLL_CLOEXEC);
+    for (int i = 0; i < MAX_DEVICES; i++) {
+        devices_[i].fd = -1;
+        devices_[i].fill = 0;
+    }
+}
+
+/**
+ * @brief Close all devices and the epoll instance
+ */
+transport::~transport() {
+    for (int i = 0; i < MAX_DEVICES; i++) close(i);
+    if (epoll_ >= 0) ::close(epoll_);
+}
+
+/**
+ * @brief Register an open file descriptor in a free device slot
+ * @param[in] fd Non-blocking file descriptor
+ * @param[in] hid Whether the device speaks raw HID reports
+ * @return Device handle, or -1 if there is no free slot (fd is closed)
+ */
+int transport::add(int fd, bool hid) {
+    for (int i = 0; i < MAX_DEVICES; i++) {
+        if (devices_[i].fd >= 0) continue;
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.u32 = i;
+        if (epoll_ctl(epoll_, EPOLL_CTL_ADD, fd, &ev) < 0) break;
+        devices_[i].fd = fd;
+        devices_[i].hid = hid;
+        devices_[i].fill = 0;
+        return i;
+    }
+    ::close(fd);
+    return -1;
+}
+
+/**
+ * @brief Open a serial port in raw mode
+ * @param[in] path Device path, e.g. "/dev/ttyACM0"
+ * @return Device handle, or -1 on failure (errno is set)
+ *
+ * The USB serial interface ignores the baud rate, but 115200 is set anyway for
+ * real UARTs such as a Bluetooth SPP link.
+ */
+int transport::open_serial(const char *path) {
+    int fd = ::open(path, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) return -1;
+    struct termios tio;
+    if (tcgetattr(fd, &tio) == 0) {
+        cfmakeraw(&tio);
+        cfsetispeed(&tio, B115200);
+        cfsetospeed(&tio, B115200);
+        tio.c_cflag |= CLOCAL | CREAD;
+        tio.c_cc[VMIN] = 1;     // VMIN=0 would make an empty read look like end of file
+        tio.c_cc[VTIME] = 0;
+        tcsetattr(fd, TCSANOW, &tio);
+        tcflush(fd, TCIOFLUSH);
+    }
+    return add(fd, false);
+}
+
+/**
+ * @brief Open a Linux hidraw device
+ * @param[in] path Device path, e.g. "/dev/hidraw3"
+ * @return Device handle, or -1 on failure (errno is set)
+ */
+int transport::open_hidraw(const char *path) {
+    int fd = ::open(path, O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) return -1;
+    return add(fd, true);
+}
+
+/**
+ * @brief Close a device and free its slot
+ * @param[in] device Device handle
+ */
+void transport::close(int device) {
+    if (device < 0 || device >= MAX_DEVICES || devices_[device].fd < 0) return;
+    epoll_ctl(epoll_, EPOLL_CTL_DEL, devices_[device].fd, NULL);
+    ::close(devices_[device].fd);
+    devices_[device].fd = -1;
+    devices_[device].fill = 0;
+}
+
+/**
+ * @brief Write a whole buffer to a non-blocking descriptor
+ * @param[in] fd File descriptor
+ * @param[in] data Bytes to write
+ * @param[in] length Number of bytes
+ * @return Whether everything was written
+ *
+ * Packets are small and the device drains them quickly, so a full output
+ * buffer is waited out here rather than queued.
+ */
+bool transport::write_all(int fd, const uint8_t *data, size_t length) {
+    while (length) {
+        ssize_t n = ::write(fd, data, length);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) return false;
+            struct epoll_event ev;
+            int wait = epoll_create1(EPOLL_CLOEXEC);
+            if (wait < 0) return false;
+            memset(&ev, 0, sizeof(ev));
+            ev.events = EPOLLOUT;
+            bool ready = epoll_ctl(wait, EPOLL_CTL_ADD, fd, &ev) == 0 && epoll_wait(wait, &ev, 1, 1000) == 1;
+            ::close(wait);
+            if (!ready) return false;
+            continue;
+        }
+        data += n;
+        length -= n;
+    }
+    return true;
+}
+
+/**
+ * @brief Send one complete packet to a device
+ * @param[in] device Device handle
+ * @param[in] packet Packet built with one of the keyglove::cmd functions
+ * @param[in] length Packet length returned by the builder
+ * @return Whether the packet was written completely
+ */
+bool transport::send(int device, const uint8_t *packet, size_t length) {
+    if (device < 0 || device >= MAX_DEVICES || devices_[device].fd < 0) return false;
+    int fd = devices_[device].fd;
+    if (!devices_[device].hid) return write_all(fd, packet, length);
+
+    // split into as many reports as it takes, each prefixed with report ID and length
+    uint8_t report[HID_REPORT_SIZE + 1];
+    do {
+        size_t chunk = length < HID_REPORT_SIZE - 1 ? length : HID_REPORT_SIZE - 1;
+        memset(report, 0, sizeof(report));
+        report[1] = chunk;
+        memcpy(report + 2, packet, chunk);
+        if (!write_all(fd, report, sizeof(report))) return false;
+        packet += chunk;
+        length -= chunk;
+    } while (length);
+    return true;
+}
+
+/**
+ * @brief Hand every complete packet in a device's buffer to the handler
+ * @param[in] device Device handle
+ */
+void transport::frame(int device) {
+    device_state *d = &devices_[device];
+    size_t start = 0;
+    while (start < d -> fill) {
+        if (!packet_start(d -> rx[start])) {
+            // out of step, skip ahead to something that can start a packet
+            start++;
+            continue;
+        }
+        if (d -> fill - start < PACKET_HEADER_SIZE) break;
+        size_t length = packet_length(d -> rx + start);
+        if (d -> fill - start < length) break;
+        handler_(context_, device, d -> rx + start, length);
+        if (d -> fd < 0) return;    // handler closed the device
+        start += length;
+    }
+    if (start) {
+        d -> fill -= start;
+        memmove(d -> rx, d -> rx + start, d -> fill);
+    }
+}
+
+/**
+ * @brief Read whatever a device has ready and frame it into packets
+ * @param[in] device Device handle
+ */
+void transport::receive(int device) {
+    device_state *d = &devices_[device];
+    for (;;) {
+        ssize_t n;
+        if (d -> hid) {
+            // one report per read, and only its first report[0] data bytes count
+            uint8_t report[HID_REPORT_SIZE];
+            n = ::read(d -> fd, report, sizeof(report));
+            if (n > 0) {
+                size_t count = report[0];
+                if (count > (size_t)n - 1) count = n - 1;
+                if (count > BUFFER_SIZE - d -> fill) d -> fill = 0;   // can't be a valid stream, start over
+                memcpy(d -> rx + d -> fill, report + 1, count);
+                d -> fill += count;
+            }
+        } else {
+            if (d -> fill == BUFFER_SIZE) d -> fill = 0;            // can't be a valid stream, start over
+            n = ::read(d -> fd, d -> rx + d -> fill, BUFFER_SIZE - d -> fill);
+            if (n > 0) d -> fill += n;
+        }
+
+        if (n > 0) {
+            frame(device);
+            if (d -> fd < 0) return;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+
+        // end of file or a real error, which both mean the device is gone
+        close(device);
+        handler_(context_, device, NULL, 0);
+        return;
+    }
+}
+
+/**
+ * @brief Wait for incoming data and deliver any complete packets
+ * @param[in] timeout_ms Longest time to wait in milliseconds (0 to return at once, -1 to wait forever)
+ * @return Number of devices that had data or went away, or -1 on error
+ */
+int transport::poll(int timeout_ms) {
+    struct epoll_event events[MAX_DEVICES];
+    int count = epoll_wait(epoll_, events, MAX_DEVICES, timeout_ms);
+    if (count < 0) return errno == EINTR ? 0 : -1;
+    for (int i = 0; i < count; i++) {
+        int device = events[i].data.u32;
+        if (devices_[device].fd >= 0) receive(device);
+    }
+    return count;
+}
+
+} // namespace keyglove
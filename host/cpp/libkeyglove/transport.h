@@ -0,0 +1,111 @@
+// Keyglove host SDK - Serial and raw HID transport
+// 2014-12-14 by Jeff Rowberg <jeff@rowberg.net>
+
+/*
+================================================================================
+Keyglove source code is placed under the MIT license
+Copyright (c) 2014 Jeff Rowberg
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+================================================================================
+*/
+
+
+/**
+ * @file transport.h
+ * @brief Serial and raw HID transport
+ * @author Jeff Rowberg
+ * @date 2014-12-14
+ */
+
+#ifndef _KEYGLOVE_TRANSPORT_H_
+#define _KEYGLOVE_TRANSPORT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "kgapi.h"
+
+namespace keyglove {
+
+/**
+ * @brief Receives one complete packet from a device
+ * @param[in] context Pointer given to the transport constructor
+ * @param[in] device Device handle returned from open_serial() or open_hidraw()
+ * @param[in] packet Complete packet (header and payload), or NULL if the device went away
+ * @param[in] length Packet length in bytes, or 0 if the device went away
+ *
+ * The packet points into the transport's receive buffer and is only valid
+ * until the handler returns. Pass it straight to dispatcher::dispatch() or
+ * copy it.
+ */
+typedef void (*packet_handler)(void *context, int device, const uint8_t *packet, size_t length);
+
+/**
+ * @brief Non-blocking Keyglove transport over serial ports and Linux hidraw devices
+ *
+ * All open devices are watched by a single epoll instance, so one thread can
+ * serve any number of gloves. Call poll() from your own loop, or add fd() to
+ * an outer event loop and call poll(0) when it becomes readable.
+ */
+class transport {
+public:
+    static const int MAX_DEVICES = 8;               ///< Most devices that may be open at once
+    static const size_t BUFFER_SIZE = 8192;         ///< Receive buffer per device, at least two full packets
+    static const size_t HID_REPORT_SIZE = 64;       ///< Raw HID report size (first byte is the data length)
+
+    transport(packet_handler handler, void *context = NULL);
+    ~transport();
+
+    int open_serial(const char *path);
+    int open_hidraw(const char *path);
+    void close(int device);
+
+    bool send(int device, const uint8_t *packet, size_t length);
+    int poll(int timeout_ms);
+
+    /** @brief File descriptor of the epoll instance, readable whenever poll(0) has work to do */
+    int fd() const { return epoll_; }
+
+private:
+    struct device_state {
+        int fd;                                     ///< Device file descriptor, or -1 if the slot is free
+        bool hid;                                   ///< Whether reads and writes are framed as raw HID reports
+        size_t fill;                                ///< Bytes currently held in rx
+        uint8_t rx[BUFFER_SIZE];                    ///< Received bytes not yet handed out as packets
+    };
+
+    transport(const transport &);
+    transport &operator=(const transport &);
+
+    int add(int fd, bool hid);
+    bool write_all(int fd, const uint8_t *data, size_t length);
+    void receive(int device);
+    void frame(int device);
+
+    packet_handler handler_;
+    void *context_;
+    int epoll_;
+    device_state devices_[MAX_DEVICES];
+};
+
+} // namespace keyglove
+
+#endif // _KEYGLOVE_TRANSPORT_H_
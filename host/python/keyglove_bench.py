@@ -0,0 +1,456 @@
+#!/usr/bin/env python
+
+"""
+================================================================================
+Keyglove end-to-end latency and throughput benchmark
+2014-12-14 by Jeff Rowberg <jeff@rowberg.net>
+
+Changelog:
+    2014-12-14 - Initial release
+
+
+================================================================================
+Keyglove source code is placed under the MIT license
+Copyright (c) 2014 Jeff Rowberg
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+================================================================================
+
+"""
+
+__author__ = "Jeff Rowberg"
+__license__ = "MIT"
+__version__ = "2014-12-14"
+__email__ = "jeff@rowberg.net"
+
+"""
+Usage:
+    keyglove_bench.py --sim [--spin] [options]
+        Build (if needed) and start the Linux host simulation of the firmware
+        (controller/linux), and benchmark its USB serial and USB raw HID links
+    keyglove_bench.py [--serial PATH] [--hidraw PATH] [options]
+        Benchmark real hardware over a serial port (USB serial, or BT2 serial
+        through an RFCOMM device) and/or a hidraw node (USB or BT2 raw HID);
+        with neither, the first serial Keyglove found is used
+
+Options:
+    --pings N       system_ping round trips per interface (default 1000)
+    --duration S    seconds of sustained timer events per interface (default 10)
+    --late MS       how far behind the best arrival an event counts as late (default 20)
+    --touches N     touch press/release cycles, simulation only (default 100)
+    --output FILE   write the JSON report here instead of standard output
+
+Results are one JSON document. Latencies are in microseconds, measured with the
+host clock from just before a command is written until the matching packet has
+been read. Event throughput uses all eight system timers at their shortest
+interval (10ms), which is the fastest the firmware generates events without
+motion sensors, so "dropped" counts ticks that never arrived (from gaps in the
+device timestamps) and "late" counts ticks that arrived more than --late ms
+behind the best-case device-to-host delay seen during the run.
+
+Link delay is measured from the device timestamp on each timer event until it
+has been read, after synchronizing a KeygloveClock with system_get_time
+exchanges, so unlike the relative delays above it is an absolute one-way
+figure. It needs protocol version 3 firmware and is skipped for older ones.
+
+Touch latency is measured from writing a new sensor state to the simulation's
+control channel until the "touch_status" event arrives, so it includes the
+firmware's debounce threshold (10ms by default). Real touches cannot be timed
+from the host, so this test is skipped for hardware.
+"""
+
+import sys, os, errno, select, subprocess, tempfile, argparse, json, math, platform, time, termios, tty
+import kglib
+
+SIM_SOURCES = [
+    'linux/linux_core.cpp',
+    'linux/application_sim.cpp',
+    'arduino/keyglove/keyglove.cpp',
+    'arduino/keyglove/custom_protocol.cpp',
+    'arduino/keyglove/support_board_linux_sim.cpp',
+    'arduino/keyglove/support_log.cpp',
+    'arduino/keyglove/support_memory.cpp',
+    'arduino/keyglove/support_protocol.cpp',
+    'arduino/keyglove/support_protocol_system.cpp',
+    'arduino/keyglove/support_protocol_touch.cpp',
+    'arduino/keyglove/support_touch.cpp',
+]
+
+RAWHID_REPORT_SIZE = 64
+
+sim = None              # simulation process (see 'subprocess.Popen')
+
+# ==============================================================================
+# HOST LINKS
+# ==============================================================================
+
+class Link(object):
+    """
+    One host interface to the Keyglove, read and written directly (rather than
+    through KeygloveDevice) so that nothing but the OS sits between the packets
+    and the timestamps. Raw HID links carry KGAPI data in fixed-size reports,
+    with the byte count in the first byte; hidraw nodes also need a report ID in
+    front of each report written.
+    """
+
+    def __init__(self, name, path, report_size=None, report_id=None):
+        self.name = name
+        self.path = path
+        self.report_size = report_size
+        self.report_id = report_id
+        self.fd = os.open(path, os.O_RDWR | os.O_NOCTTY | os.O_NONBLOCK)
+        if os.isatty(self.fd):
+            tty.setraw(self.fd)
+        self.kgapi = kglib.KGAPI()
+        self.buffer = bytearray()
+        self.pending = []
+        self.received = 0
+
+    def fileno(self):
+        return self.fd
+
+    def close(self):
+        os.close(self.fd)
+
+    def send(self, packet):
+        data = bytearray(packet)
+        if self.report_size:
+            chunk = self.report_size - 1
+            reports = bytearray()
+            for i in range(0, len(data), chunk):
+                part = data[i:i + chunk]
+                report = bytearray([len(part)]) + part + bytearray(chunk - len(part))
+                if self.report_id != None:
+                    report = bytearray([self.report_id]) + report
+                reports += report
+            data = reports
+        while data:
+            try:
+                data = data[os.write(self.fd, bytes(data)):]
+            except OSError as e:
+                if e.errno != errno.EAGAIN:
+                    raise
+                select.select([], [self], [], 0.1)
+
+    def read(self):
+        """
+        Read whatever is waiting and return the complete packets in it, as
+        (packet type, response or event) tuples from KGAPI.parse_data().
+        """
+        try:
+            data = os.read(self.fd, 4096)
+        except OSError as e:
+            if e.errno == errno.EAGAIN:
+                return []
+            raise
+        self.received += len(data)
+        if not self.report_size:
+            return self.kgapi.parse_data(data)
+        self.buffer += bytearray(data)
+        packets = []
+        while len(self.buffer) >= self.report_size:
+            report = self.buffer[:self.report_size]
+            del self.buffer[:self.report_size]
+            packets += self.kgapi.parse_data(report[1:1 + min(report[0], self.report_size - 1)])
+        return packets
+
+def wait(links, link, until, match):
+    """
+    Read from every link until 'match' accepts a packet from 'link' or the time
+    runs out. Other links are drained and ignored, since events go out on all
+    of them and a link nobody reads eventually stalls the firmware.
+    Returns (arrival time, packet) or (None, None) on timeout.
+    """
+    while True:
+        while link != None and link.pending:
+            arrived, packet = link.pending.pop(0)
+            if match(packet):
+                return (arrived, packet)
+        remaining = until - time.time()
+        if remaining <= 0:
+            return (None, None)
+        ready = select.select(links, [], [], remaining)[0]
+        now = time.time()
+        for l in ready:
+            packets = l.read()
+            if l == link:
+                link.pending += [(now, x) for x in packets]
+
+def is_response(class_id, command_id):
+    return lambda p: p[0] == 0xC0 and p[1]['class_id'] == class_id and p[1]['command_id'] == command_id
+
+def command(links, link, packet, timeout=1.0):
+    link.send(packet)
+    return wait(links, link, time.time() + timeout, is_response(ord(packet[2]), ord(packet[3])))[1]
+
+# ==============================================================================
+# STATISTICS
+# ==============================================================================
+
+def summarize(samples):
+    """
+    Summary of a list of seconds, in whole microseconds.
+    """
+    if not samples:
+        return { 'count': 0 }
+    ordered = sorted(samples)
+    count = len(ordered)
+    mean = sum(ordered) / count
+    stddev = math.sqrt(sum([(x - mean) ** 2 for x in ordered]) / count)
+    percentile = lambda p: ordered[min(count - 1, int(math.ceil(p / 100.0 * count)) - 1)]
+    us = lambda x: int(round(x * 1000000))
+    return {
+        'count': count,
+        'min': us(ordered[0]),
+        'mean': us(mean),
+        'p50': us(percentile(50)),
+        'p90': us(percentile(90)),
+        'p99': us(percentile(99)),
+        'max': us(ordered[-1]),
+        'stddev': us(stddev),
+    }
+
+# ==============================================================================
+# BENCHMARKS
+# ==============================================================================
+
+def ping_latency(links, link, count):
+    samples = []
+    lost = 0
+    uptime = None
+    for i in range(count):
+        start = time.time()
+        link.send(link.kgapi.kg_cmd_system_ping())
+        arrived, packet = wait(links, link, start + 1.0, is_response(1, 1))
+        if packet == None:
+            lost += 1
+            continue
+        samples.append(arrived - start)
+        uptime = packet[1]['payload']['uptime']
+    return { 'test': 'ping_latency', 'interface': link.name, 'lost': lost, 'uptime': uptime, 'latency_us': summarize(samples) }
+
+def event_throughput(links, link, duration, late):
+    kgapi = link.kgapi
+    for handle in range(8):
+        command(links, link, kgapi.kg_cmd_system_set_timer(handle, 1, 0))
+    start = time.time()
+    received = link.received
+    ticks = []
+    end = start + duration
+    while True:
+        arrived, packet = wait(links, link, end, lambda p: p[0] == 0x80 and p[1]['class_id'] == 1 and p[1]['event_id'] == 6)
+        if packet == None:
+            break
+        payload = packet[1]['payload']
+        ticks.append((arrived, payload['handle'], payload['seconds'] * 100 + payload['subticks']))
+    elapsed = time.time() - start
+    received = link.received - received
+    for handle in range(8):
+        command(links, link, kgapi.kg_cmd_system_set_timer(handle, 0, 0))
+
+    result = { 'test': 'event_throughput', 'interface': link.name, 'duration': round(elapsed, 3), 'events': len(ticks) }
+    if not ticks:
+        result['error'] = "no timer_tick events received (does the firmware's application handler suppress them?)"
+        return result
+
+    # ticks missing from each handle's sequence never made it to the host
+    dropped = 0
+    last = {}
+    for arrived, handle, tick in ticks:
+        if handle in last and tick > last[handle] + 1:
+            dropped += tick - last[handle] - 1
+        last[handle] = tick
+
+    # device-to-host delay relative to the best one seen (the clocks are unrelated, so only differences mean anything)
+    offsets = [arrived - tick / 100.0 for arrived, handle, tick in ticks]
+    best = min(offsets)
+    delays = [x - best for x in offsets]
+    result.update({
+        'events_per_second': round(len(ticks) / elapsed, 1),
+        'bytes_per_second': round(received / elapsed, 1),
+        'dropped': dropped,
+        'late': len([x for x in delays if x > late / 1000.0]),
+        'late_threshold_ms': late,
+        'relative_delay_us': summarize(delays),
+    })
+    return result
+
+def link_delay(links, link, count):
+    kgapi = link.kgapi
+    clock = kglib.KeygloveClock()
+    rtts = []
+    for i in range(32):
+        start = time.time()
+        link.send(kgapi.kg_cmd_system_get_time())
+        arrived, packet = wait(links, link, start + 1.0, is_response(1, 8))
+        if packet == None or 'seconds' not in packet[1]['payload']:
+            return { 'test': 'link_delay', 'interface': link.name, 'skipped': "firmware has no system_get_time command" }
+        payload = packet[1]['payload']
+        clock.add_sample(start, arrived, payload['seconds'], payload['subticks'], payload['microseconds'])
+        rtts.append(arrived - start)
+
+    kgapi.clock = clock
+    command(links, link, kgapi.kg_cmd_system_set_timestamp_mode(2))
+    command(links, link, kgapi.kg_cmd_system_set_timer(0, 1, 0))
+    samples = []
+    for i in range(count):
+        arrived, packet = wait(links, link, time.time() + 1.0, lambda p: p[0] == 0x80 and p[1]['class_id'] == 1 and p[1]['event_id'] == 6)
+        if packet == None:
+            break
+        if packet[1]['host_time'] != None:
+            samples.append(arrived - packet[1]['host_time'])
+    command(links, link, kgapi.kg_cmd_system_set_timer(0, 0, 0))
+    command(links, link, kgapi.kg_cmd_system_set_timestamp_mode(0))
+    kgapi.clock = None
+    return { 'test': 'link_delay', 'interface': link.name, 'sync_rtt_us': summarize(rtts), 'delay_us': summarize(samples) }
+
+def touch_latency(links, link, control, count):
+    samples = []
+    lost = 0
+    for i in range(count * 2):
+        state = '01000000' if i % 2 == 0 else '00000000'
+        expected = bytearray.fromhex(state)
+        start = time.time()
+        os.write(control, 'touch %s\n' % state)
+        arrived, packet = wait(links, link, start + 1.0, lambda p: p[0] == 0x80 and p[1]['class_id'] == 4 and p[1]['event_id'] == 2 and bytearray(p[1]['payload']['status']) == expected)
+        if packet == None:
+            lost += 1
+            continue
+        samples.append(arrived - start)
+    return { 'test': 'touch_latency', 'interface': link.name, 'lost': lost, 'latency_us': summarize(samples) }
+
+# ==============================================================================
+# TARGETS
+# ==============================================================================
+
+def start_sim(spin):
+    global sim
+
+    root = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', '..', 'controller')
+    sources = [os.path.join(root, x) for x in SIM_SOURCES]
+    headers = [os.path.join(root, 'linux', x) for x in os.listdir(os.path.join(root, 'linux'))] + \
+              [os.path.join(root, 'arduino', 'keyglove', x) for x in os.listdir(os.path.join(root, 'arduino', 'keyglove')) if x.endswith('.h')]
+    binary = os.path.join(tempfile.gettempdir(), 'keyglove-sim')
+    if not os.path.exists(binary) or os.path.getmtime(binary) < max([os.path.getmtime(x) for x in sources + headers]):
+        compiler = os.environ.get('CXX', 'g++')
+        sys.stderr.write("Building simulation with %s...\n" % compiler)
+        # -fpermissive only downgrades the (int) pointer casts in kg_cmd_system_get_memory, which
+        # assume 16-bit AVR addresses, to warnings; anything else the compiler reports is new
+        subprocess.check_call([compiler, '-DKG_LINUX_SIM', '-std=gnu++98', '-O2', '-fpermissive',
+            '-I' + os.path.join(root, 'linux'), '-I' + os.path.join(root, 'arduino', 'keyglove')] + sources + ['-o', binary])
+
+    sim = subprocess.Popen([binary] + (['--spin'] if spin else []), stdout=subprocess.PIPE)
+    ptys = json.loads(sim.stdout.readline())
+    links = [Link('usb_serial', ptys['usb_serial']), Link('usb_rawhid', ptys['usb_rawhid'], RAWHID_REPORT_SIZE)]
+    control = os.open(ptys['control'], os.O_WRONLY | os.O_NOCTTY)
+    tty.setraw(control)
+    return links, control
+
+def stop_sim():
+    if sim != None and sim.poll() == None:
+        sim.terminate()
+        sim.wait()
+
+# ==============================================================================
+# MAIN APPLICATION LOGIC
+# ==============================================================================
+
+def main():
+    parser = argparse.ArgumentParser(description="Measure Keyglove latency and throughput")
+    target = parser.add_mutually_exclusive_group()
+    target.add_argument('--sim', action='store_true', help="benchmark the Linux host simulation")
+    target.add_argument('--serial', metavar='PATH', help="serial port of real hardware (USB serial or BT2 serial)")
+    parser.add_argument('--hidraw', metavar='PATH', help="hidraw node of real hardware (USB or BT2 raw HID)")
+    parser.add_argument('--spin', action='store_true', help="run the simulation without sleeping between loops")
+    parser.add_argument('--pings', type=int, default=1000, help="ping round trips per interface (default 1000)")
+    parser.add_argument('--duration', type=float, default=10, help="seconds of timer events per interface (default 10)")
+    parser.add_argument('--late', type=float, default=20, help="late event threshold in ms (default 20)")
+    parser.add_argument('--touches', type=int, default=100, help="touch cycles, simulation only (default 100)")
+    parser.add_argument('--output', help="JSON report file (default: standard output)")
+    args = parser.parse_args()
+    if args.sim and args.hidraw:
+        parser.error("--hidraw is for real hardware, the simulation provides its own")
+
+    control = None
+    if args.sim:
+        links, control = start_sim(args.spin)
+        kind = 'simulation'
+    else:
+        links = []
+        if args.serial == None and args.hidraw == None:
+            devices = list(kglib.get_devices(type="serial"))
+            if not devices:
+                print("No serial Keyglove found, use --serial or --hidraw to choose a device")
+                exit(1)
+            args.serial = devices[0].port
+        if args.serial != None:
+            links.append(Link('bt2_serial' if 'rfcomm' in args.serial else 'usb_serial', args.serial))
+        if args.hidraw != None:
+            links.append(Link('raw_hid', args.hidraw, RAWHID_REPORT_SIZE, 0))
+        kind = 'hardware'
+
+    # let the boot events go by before talking to it
+    wait(links, None, time.time() + 0.5, None)
+    info = command(links, links[0], links[0].kgapi.kg_cmd_system_get_info())
+    target = { 'kind': kind, 'interfaces': dict([(l.name, l.path) for l in links]) }
+    if info != None:
+        target['firmware'] = info[1]['payload']
+
+    results = []
+    for link in links:
+        sys.stderr.write("Benchmarking %s (%s)...\n" % (link.name, link.path))
+        results.append(ping_latency(links, link, args.pings))
+        results.append(event_throughput(links, link, args.duration, args.late))
+        results.append(link_delay(links, link, 500))
+        if control != None:
+            results.append(touch_latency(links, link, control, args.touches))
+        else:
+            results.append({ 'test': 'touch_latency', 'interface': link.name, 'skipped': "touches cannot be generated from the host on real hardware" })
+
+    report = {
+        'tool': 'keyglove_bench',
+        'version': __version__,
+        'time': time.strftime('%Y-%m-%dT%H:%M:%S%z'),
+        'host': { 'system': platform.system(), 'release': platform.release(), 'machine': platform.machine(), 'python': platform.python_version() },
+        'target': target,
+        'results': results,
+    }
+    text = json.dumps(report, indent=4, sort_keys=True)
+    if args.output:
+        with open(args.output, 'w') as f:
+            f.write(text + '\n')
+    else:
+        print(text)
+
+    for link in links:
+        link.close()
+    stop_sim()
+
+# ==============================================================================
+# PYTHON "__main__" ENTRY POINT DEFINITION
+# ==============================================================================
+
+if __name__ == '__main__':
+    try:
+        main()
+    except KeyboardInterrupt:
+        stop_sim()
+        print("Goodbye!")
+        sys.exit(0)
@@ -0,0 +1,242 @@
+#!/usr/bin/env python
+
+"""
+================================================================================
+Keyglove multi-client broker daemon
+2014-12-14 by Jeff Rowberg <jeff@rowberg.net>
+
+Changelog:
+    2014-12-14 - Initial release
+
+
+================================================================================
+Keyglove source code is placed under the MIT license
+Copyright (c) 2014 Jeff Rowberg
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+================================================================================
+
+"""
+
+__author__ = "Jeff Rowberg"
+__license__ = "MIT"
+__version__ = "2014-12-14"
+__email__ = "jeff@rowberg.net"
+
+"""
+Usage: keyglove_broker.py [device index] [broker name]
+
+Connects to one Keyglove (the first one found unless an index is given) and
+shares it with local clients. Events go into a shared memory ring which clients
+read directly, and commands from each client are sent to the device with a
+broker-assigned tag so the responses can be routed back to the right client.
+See kgbroker.py for the client side.
+"""
+
+import sys, os, select, socket, struct, threading, time
+import kglib, kgbroker
+
+keyglove = None         # Keyglove device instance (see 'kglib.KeygloveDevice')
+kgapi = kglib.KGAPI()   # API protocol parser instance (see 'kglib.KGAPI')
+ring = None             # shared event ring (see 'kgbroker.EventRing')
+server = None           # listening command socket
+socket_path = None      # command socket path, removed on exit
+clients = {}            # connected client sockets, by file descriptor
+outstanding = []        # (deadline, command, client, client tag) for commands sent to the device
+waiting = []            # (deadline, packet, client, client tag) for commands waiting for a free device tag
+lock = threading.Lock() # guards 'outstanding' and 'waiting', which the reader thread also uses after each response
+
+COMMAND_TIMEOUT = 1     # seconds to wait for a free tag or a response before giving up on a command
+
+# ==============================================================================
+# DEVICE CONNECTION MANAGEMENT EVENTS (triggered from KeygloveDevice object)
+# ==============================================================================
+
+def my_on_connected(sender, args):
+    print("+++ Keyglove connected")
+
+def my_on_disconnected(sender, args):
+    print("--- Keyglove disconnected")
+
+def my_on_unplugged(sender, args):
+    print("!!! Keyglove device unplugged, no communication possible at this time")
+
+# ==============================================================================
+# API COMMUNICATION CALLBACKS (assigned in main(), triggered from KGAPI object)
+# ==============================================================================
+
+def my_kg_event(sender, args):
+    # tagged events are protocol errors for one client's command, routed with the response instead
+    if args['tag'] == 0:
+        ring.publish(args['raw'])
+
+# ==============================================================================
+# COMMAND ROUTING
+# ==============================================================================
+
+def protocol_error(tag, code):
+    # synthesize the protocol error event the Keyglove would send for a command it never saw
+    return bytearray([ 0x80 | (tag << 3), 2, 0x00, 0x01 ]) + bytearray(struct.pack('<H', code))
+
+def reply(client, packet):
+    try:
+        client.send(bytes(packet))
+    except socket.error:
+        pass # client went away, nothing to do
+
+def command_from(client):
+    try:
+        packet = bytearray(client.recv(4096))
+    except socket.error:
+        packet = bytearray()
+    if len(packet) == 0:
+        print("--- Client %d disconnected" % client.fileno())
+        del clients[client.fileno()]
+        drop_client(client)
+        client.close()
+        return
+    if len(packet) < 4 or (packet[0] & 0xC0) != 0xC0 or len(packet) != packet[1] + ((packet[0] & 0x07) << 8) + 4:
+        reply(client, protocol_error(0, 0x0003)) # bad length
+        return
+
+    # never wait for a device tag here, or one busy client would hold up every other client and all events
+    with lock:
+        waiting.append((time.time() + COMMAND_TIMEOUT, packet, client, (packet[0] >> 3) & 0x07))
+    submit_waiting()
+
+def response_handler(client, client_tag):
+    # the device tag is chosen by submit(), so put the client's back in the response
+    def done(command):
+        raw = bytearray(command.response['raw'])
+        raw[0] = (raw[0] & 0xC7) | (client_tag << 3)
+        reply(client, raw)
+        submit_waiting() # a device tag just came free
+    return done
+
+def submit_waiting():
+    # send waiting commands in arrival order for as long as device tags are free
+    with lock:
+        while len(waiting) > 0:
+            deadline, packet, client, client_tag = waiting[0]
+            command = keyglove.submit(bytes(packet), 0, response_handler(client, client_tag))
+            if command == None:
+                break # all device tags busy, the next response or expired command will try again
+            waiting.pop(0)
+            outstanding.append((time.time() + COMMAND_TIMEOUT, command, client, client_tag))
+
+def expire_commands():
+    # free the tags of commands the device never answered, give up on commands that never got a tag, and tell the senders
+    now = time.time()
+    with lock:
+        while len(outstanding) > 0 and (outstanding[0][1].done() or outstanding[0][0] <= now):
+            deadline, command, client, client_tag = outstanding.pop(0)
+            if not command.done() and command.result(0) == None:
+                reply(client, protocol_error(client_tag, 0x0002))
+        while len(waiting) > 0 and waiting[0][0] <= now:
+            deadline, packet, client, client_tag = waiting.pop(0)
+            reply(client, protocol_error(client_tag, 0x0002))
+    submit_waiting()
+
+def drop_client(client):
+    # commands from a client that has gone away are not worth a device tag
+    with lock:
+        waiting[:] = [x for x in waiting if x[2] != client]
+
+# ==============================================================================
+# MAIN APPLICATION LOGIC
+# ==============================================================================
+
+def main():
+    global keyglove, ring, server, socket_path
+
+    print("=============================")
+    print("Keyglove Multi-Client Broker")
+    print("=============================\n")
+
+    index = int(sys.argv[1]) if len(sys.argv) > 1 else 0
+    name = sys.argv[2] if len(sys.argv) > 2 else 'keyglove'
+
+    devices = list(kglib.get_devices())
+    if index >= len(devices):
+        print("Keyglove device #%d not found (%d available)" % (index, len(devices)))
+        print("Please make sure Keyglove is connected and")
+        print("PySerial, PyWinUSB, and/or PyUSB is available")
+        exit(1)
+    keyglove = devices[index]
+    print("Using %s @ %s" % (keyglove.description, keyglove.port))
+
+    ring_path, socket_path = kgbroker.default_path(name)
+    ring = kgbroker.EventRing(ring_path, True)
+    if os.path.exists(socket_path):
+        os.unlink(socket_path)
+    server = socket.socket(socket.AF_UNIX, socket.SOCK_SEQPACKET)
+    server.bind(socket_path)
+    server.listen(8)
+    print("Events: %s" % ring_path)
+    print("Commands: %s\n" % socket_path)
+
+    try:
+        keyglove.on_connected += my_on_connected
+        keyglove.on_disconnected += my_on_disconnected
+        keyglove.on_unplugged += my_on_unplugged
+        kgapi.kg_event += my_kg_event
+
+        if keyglove.connect(kgapi):
+            # route client commands until the device goes away (SIGINT/Ctrl+C will break)
+            while keyglove.connected:
+                ready, _, _ = select.select([ server ] + list(clients.values()), [], [], 0.1)
+                for sock in ready:
+                    if sock == server:
+                        client, address = server.accept()
+                        clients[client.fileno()] = client
+                        print("+++ Client %d connected" % client.fileno())
+                    elif sock.fileno() in clients:
+                        command_from(sock)
+                expire_commands()
+
+    except kglib.KeygloveError as e:
+        print("Keyglove error (%s): %s" % (type(e), e))
+
+def cleanup():
+    for client in clients.values():
+        client.close()
+    if server != None:
+        server.close()
+        os.unlink(socket_path)
+    if ring != None:
+        ring.close()
+
+# ==============================================================================
+# PYTHON "__main__" ENTRY POINT DEFINITION
+# ==============================================================================
+
+if __name__ == '__main__':
+    try:
+        main()
+        cleanup()
+    except KeyboardInterrupt:
+        if keyglove != None and keyglove.connected:
+            print("Disconnecting from Keyglove...")
+            if not keyglove.disconnect():
+                print("Could not disconnect!")
+        cleanup()
+
+        print("Goodbye!")
+        sys.exit(0)
@@ -0,0 +1,181 @@
+#!/usr/bin/env python
+
+"""
+================================================================================
+Keyglove capture recording and inspection tool
+2014-12-14 by Jeff Rowberg <jeff@rowberg.net>
+
+Changelog:
+    2014-12-14 - Initial release
+
+
+================================================================================
+Keyglove source code is placed under the MIT license
+Copyright (c) 2014 Jeff Rowberg
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+================================================================================
+
+"""
+
+__author__ = "Jeff Rowberg"
+__license__ = "MIT"
+__version__ = "2014-12-14"
+__email__ = "jeff@rowberg.net"
+
+"""
+Usage:
+    keyglove_capture.py record <file> [--device N]
+        Record everything sent to and received from a Keyglove until Ctrl+C
+    keyglove_capture.py info <file>
+        Show the time range, packet count, and packet classes in a capture
+    keyglove_capture.py dump <file> [--from S] [--to S] [--class ID ...] [--events | --commands]
+        Print matching packets; --from and --to are seconds from the first packet
+
+See kgcapture.py for the file format and the reader/writer classes.
+"""
+
+import sys, argparse, time
+import kglib, kgcapture
+
+keyglove = None         # Keyglove device instance (see 'kglib.KeygloveDevice')
+kgapi = kglib.KGAPI()   # API protocol parser instance (see 'kglib.KGAPI')
+capture = None          # capture being recorded (see 'kgcapture.CaptureWriter')
+
+# ==============================================================================
+# DEVICE CONNECTION MANAGEMENT EVENTS (triggered from KeygloveDevice object)
+# ==============================================================================
+
+def my_on_connected(sender, args):
+    print("+++ Keyglove connected")
+
+def my_on_disconnected(sender, args):
+    print("--- Keyglove disconnected")
+
+def my_on_unplugged(sender, args):
+    print("!!! Keyglove device unplugged, no communication possible at this time")
+
+# ==============================================================================
+# COMMANDS
+# ==============================================================================
+
+def record(args):
+    global keyglove, capture
+
+    devices = list(kglib.get_devices())
+    if args.device >= len(devices):
+        print("Keyglove device #%d not found (%d available)" % (args.device, len(devices)))
+        print("Please make sure Keyglove is connected and")
+        print("PySerial, PyWinUSB, and/or PyUSB is available")
+        exit(1)
+    keyglove = devices[args.device]
+    print("Recording %s @ %s to %s (Ctrl+C to stop)" % (keyglove.description, keyglove.port, args.file))
+
+    capture = kgcapture.CaptureWriter(args.file)
+    keyglove.capture = capture
+    keyglove.on_connected += my_on_connected
+    keyglove.on_disconnected += my_on_disconnected
+    keyglove.on_unplugged += my_on_unplugged
+    try:
+        if keyglove.connect(kgapi):
+            while keyglove.connected:
+                time.sleep(1)
+                capture.flush()
+    except kglib.KeygloveError as e:
+        print("Keyglove error (%s): %s" % (type(e), e))
+    capture.close()
+    print("Recorded %d packets" % capture.count)
+
+def info(args):
+    reader = kgcapture.CaptureReader(args.file)
+    print("File: %s (%s)" % (args.file, "complete" if reader.complete else "not closed, index recovered"))
+    print("Started: %s" % time.strftime('%Y-%m-%d %H:%M:%S', time.localtime(reader.started)))
+    print("Packets: %d in %d index blocks" % (len(reader), len(reader.blocks)))
+    if len(reader) > 0:
+        print("Duration: %.2f seconds" % (reader.end_time() - reader.start_time()))
+    print("Event classes: %s" % ', '.join(['%d' % x for x in reader.event_classes()]))
+    print("Command/response classes: %s" % ', '.join(['%d' % x for x in reader.command_classes()]))
+    reader.close()
+
+def dump(args):
+    reader = kgcapture.CaptureReader(args.file)
+    origin = reader.start_time()
+    if origin == None:
+        return
+    start = None if args.start == None else origin + args.start
+    end = None if args.end == None else origin + args.end
+    for frame in reader.frames(start, end, args.classes, not args.commands, not args.events):
+        incoming = frame.kind == kgcapture.KIND_RECEIVED
+        friendly = kgapi.friendly_packet(frame.packet, incoming)
+        if friendly:
+            text = "%s { %s }" % (friendly["name"], ', '.join([ ("%s: %s" % (x, friendly["payload"][x])) for x in friendly["payload_keys"]]))
+        else:
+            text = "UNKNOWN: [ %s ]" % ' '.join(['%02X' % ord(b) for b in frame.packet])
+        print("%10.3f %s %s" % (frame.timestamp - origin, "<--" if incoming else "-->", text))
+    reader.close()
+
+# ==============================================================================
+# MAIN APPLICATION LOGIC
+# ==============================================================================
+
+def main():
+    parser = argparse.ArgumentParser(description="Record and inspect Keyglove capture files")
+    commands = parser.add_subparsers()
+
+    p = commands.add_parser('record', help="record a Keyglove session")
+    p.add_argument('file')
+    p.add_argument('--device', type=int, default=0, help="device index (default: first found)")
+    p.set_defaults(func=record)
+
+    p = commands.add_parser('info', help="summarize a capture")
+    p.add_argument('file')
+    p.set_defaults(func=info)
+
+    p = commands.add_parser('dump', help="print packets from a capture")
+    p.add_argument('file')
+    p.add_argument('--from', dest='start', type=float, help="first second to show, from the start of the capture")
+    p.add_argument('--to', dest='end', type=float, help="last second to show, from the start of the capture")
+    p.add_argument('--class', dest='classes', type=int, nargs='+', help="only show these packet class IDs")
+    types = p.add_mutually_exclusive_group()
+    types.add_argument('--events', action='store_true', help="only show events")
+    types.add_argument('--commands', action='store_true', help="only show commands and responses")
+    p.set_defaults(func=dump)
+
+    args = parser.parse_args()
+    args.func(args)
+
+# ==============================================================================
+# PYTHON "__main__" ENTRY POINT DEFINITION
+# ==============================================================================
+
+if __name__ == '__main__':
+    try:
+        main()
+    except KeyboardInterrupt:
+        if keyglove != None and keyglove.connected:
+            print("Disconnecting from Keyglove...")
+            if not keyglove.disconnect():
+                print("Could not disconnect!")
+        if capture != None:
+            capture.close()
+            print("Recorded %d packets" % capture.count)
+
+        print("Goodbye!")
+        sys.exit(0)
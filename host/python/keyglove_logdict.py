@@ -0,0 +1,100 @@
+#!/usr/bin/env python
+
+"""
+================================================================================
+Keyglove log message dictionary generator
+2014-12-20 by Jeff Rowberg <jeff@rowberg.net>
+
+Changelog:
+    2014-12-20 - Initial release
+
+
+================================================================================
+Keyglove source code is placed under the MIT license
+Copyright (c) 2014 Jeff Rowberg
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+================================================================================
+
+"""
+
+__author__ = "Jeff Rowberg"
+__license__ = "MIT"
+__version__ = "2014-12-20"
+
+"""
+Usage:
+    keyglove_logdict.py [--header FILE] [--output FILE]
+        Read the KG_LOG_MESSAGE list from the firmware's support_log_messages.h
+        and write it out as kglog_messages.py, the dictionary kglib uses to turn
+        tokenized log records back into text
+
+The firmware only sends message IDs, so run this whenever support_log_messages.h
+changes and keep the result in step with the firmware on the glove.
+"""
+
+import sys, os, re, argparse
+
+MESSAGE = re.compile(r'^\s*KG_LOG_MESSAGE\(\s*(\w+)\s*,\s*(0x[0-9A-Fa-f]+|\d+)\s*,\s*"((?:[^"\\]|\\.)*)"\s*\)', re.M)
+
+def read_messages(path):
+    messages = {}
+    with open(path) as f:
+        for name, id, text in MESSAGE.findall(f.read()):
+            id = int(id, 0)
+            if id in messages:
+                raise ValueError("message ID 0x%04X is used by both %s and %s" % (id, messages[id][0], name))
+            messages[id] = (name, text.decode('string_escape'))
+    return messages
+
+def write_dictionary(path, messages, source):
+    with open(path, 'w') as f:
+        f.write('# Keyglove log message dictionary\n')
+        f.write('# Generated by keyglove_logdict.py from %s, do not edit\n\n' % source)
+        f.write('messages = {\n')
+        for id in sorted(messages):
+            f.write('    0x%04X: (%r, %r),\n' % (id, messages[id][0], messages[id][1]))
+        f.write('}\n')
+
+# ==============================================================================
+# MAIN APPLICATION LOGIC
+# ==============================================================================
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    parser = argparse.ArgumentParser(description="Generate the Keyglove log message dictionary")
+    parser.add_argument('--header', default=os.path.join(here, '..', '..', 'controller', 'arduino', 'keyglove', 'support_log_messages.h'), help="firmware message list")
+    parser.add_argument('--output', default=os.path.join(here, 'kglog_messages.py'), help="dictionary to write")
+    args = parser.parse_args()
+
+    try:
+        messages = read_messages(args.header)
+    except (IOError, ValueError) as e:
+        print("Cannot read messages: %s" % e)
+        sys.exit(1)
+    write_dictionary(args.output, messages, 'support_log_messages.h')
+    print("Wrote %d messages to %s" % (len(messages), args.output))
+
+# ==============================================================================
+# PYTHON "__main__" ENTRY POINT DEFINITION
+# ==============================================================================
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,175 @@
+#!/usr/bin/env python
+
+"""
+================================================================================
+Keyglove firmware protocol tests on the Linux host simulation
+2014-12-20 by Jeff Rowberg <jeff@rowberg.net>
+
+Changelog:
+    2014-12-20 - Initial release
+
+
+================================================================================
+Keyglove source code is placed under the MIT license
+Copyright (c) 2014 Jeff Rowberg
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+================================================================================
+
+"""
+
+__author__ = "Jeff Rowberg"
+__license__ = "MIT"
+__version__ = "2014-12-20"
+__email__ = "jeff@rowberg.net"
+
+"""
+Usage:
+    keyglove_sim_test.py
+        Build (if needed) and start the Linux host simulation of the firmware
+        (controller/linux), then run protocol behavior checks against it over
+        both the USB serial and USB raw HID links
+
+Each check prints one line, and the exit status is 0 only if all of them
+passed. The simulation is built and driven by the same code as
+keyglove_bench.py.
+"""
+
+import sys, time
+import keyglove_bench
+from keyglove_bench import wait
+
+failures = 0
+
+def check(name, passed):
+    global failures
+    print("%s: %s" % ('PASS' if passed else 'FAIL', name))
+    if not passed:
+        failures += 1
+
+def is_protocol_error(tag, code):
+    return lambda p: p[0] == 0x80 and p[1]['class_id'] == 0 and p[1]['event_id'] == 1 and p[1]['tag'] == tag and p[1]['payload']['code'] == code
+
+def is_timer_tick(p):
+    return p[0] == 0x80 and p[1]['class_id'] == 1 and p[1]['event_id'] == 6
+
+def collect_ticks(links, link, duration):
+    """
+    Gather timer_tick events from 'link' for 'duration' seconds and return the
+    firmware tick count (10ms units) of each one
+    """
+    ticks = []
+    end = time.time() + duration
+    while True:
+        arrived, packet = wait(links, link, end, is_timer_tick)
+        if packet == None:
+            return ticks
+        ticks.append(packet[1]['payload']['seconds'] * 100 + packet[1]['payload']['subticks'])
+
+# ==============================================================================
+# TESTS
+# ==============================================================================
+
+def test_tagged_parser_errors(links, link):
+    # a length byte over 250 is rejected as soon as it arrives, and the error must carry the command's tag
+    link.send('\xD0\xFB')
+    arrived, packet = wait(links, link, time.time() + 1.0, is_protocol_error(2, 0x0003))
+    check("%s: tagged over-length command gets a bad_length error with its tag" % link.name, packet != None)
+
+    # an incomplete packet times out after 500ms, and that error must carry the tag too
+    link.send('\xD8\x02\x01')
+    arrived, packet = wait(links, link, time.time() + 1.5, is_protocol_error(3, 0x0002))
+    check("%s: tagged incomplete command gets a packet_timeout error with its tag" % link.name, packet != None)
+
+    # and the parser is back in sync afterwards
+    packet = keyglove_bench.command(links, link, link.kgapi.kg_cmd_system_ping())
+    check("%s: commands work again after parser errors" % link.name, packet != None)
+
+def test_event_filters(links, link):
+    kgapi = link.kgapi
+    other = links[1] if link == links[0] else links[0]
+
+    # one timer firing every tick gives a steady 100 events per second
+    keyglove_bench.command(links, link, kgapi.kg_cmd_system_set_timer(0, 1, 0))
+    ticks = collect_ticks(links, link, 1.0)
+    check("%s: unfiltered timer ticks arrive at full rate (%d/s)" % (link.name, len(ticks)), len(ticks) >= 80)
+
+    # masking out the timer_tick ID stops them here but not on the other interface
+    keyglove_bench.command(links, link, kgapi.kg_cmd_system_set_event_mask(0, 1, 0xFFFF & ~(1 << 6)))
+    wait(links, None, time.time() + 0.1, None)
+    del link.pending[:]
+    ticks = collect_ticks(links, link, 0.5)
+    check("%s: masked timer ticks are not sent" % link.name, len(ticks) == 0)
+    ticks = collect_ticks(links, other, 0.5)
+    check("%s: masked timer ticks still reach %s (%d in 0.5s)" % (link.name, other.name, len(ticks)), len(ticks) >= 40)
+    keyglove_bench.command(links, link, kgapi.kg_cmd_system_set_event_mask(0, 1, 0xFFFF))
+
+    # an interval of 4 on the timer_tick ID allows one every 40ms
+    keyglove_bench.command(links, link, kgapi.kg_cmd_system_set_event_rate(0, 1, 4, 1 << 6))
+    wait(links, None, time.time() + 0.1, None)
+    del link.pending[:]
+    ticks = collect_ticks(links, link, 1.0)
+    gaps = [b - a for a, b in zip(ticks, ticks[1:])]
+    check("%s: rate-limited timer ticks arrive at the capped rate (%d/s)" % (link.name, len(ticks)), 20 <= len(ticks) <= 26)
+    check("%s: rate-limited timer ticks are at least 4 ticks apart" % link.name, len(gaps) > 0 and min(gaps) >= 4)
+
+    # limiting some other ID in the class leaves timer ticks alone
+    keyglove_bench.command(links, link, kgapi.kg_cmd_system_set_event_rate(0, 1, 4, 1 << 5))
+    wait(links, None, time.time() + 0.1, None)
+    del link.pending[:]
+    ticks = collect_ticks(links, link, 1.0)
+    check("%s: timer ticks are not limited by another ID's rate (%d/s)" % (link.name, len(ticks)), len(ticks) >= 80)
+
+    keyglove_bench.command(links, link, kgapi.kg_cmd_system_set_event_rate(0, 1, 0, 0))
+    keyglove_bench.command(links, link, kgapi.kg_cmd_system_set_timer(0, 0, 0))
+    wait(links, None, time.time() + 0.1, None)
+    del link.pending[:]
+
+# ==============================================================================
+# MAIN APPLICATION LOGIC
+# ==============================================================================
+
+def main():
+    links, control = keyglove_bench.start_sim(False)
+
+    # let the boot events go by before talking to it
+    wait(links, None, time.time() + 0.5, None)
+
+    for link in links:
+        test_tagged_parser_errors(links, link)
+        test_event_filters(links, link)
+
+    for link in links:
+        link.close()
+    keyglove_bench.stop_sim()
+    print("FAILED" if failures else "OK")
+    sys.exit(1 if failures else 0)
+
+# ==============================================================================
+# PYTHON "__main__" ENTRY POINT DEFINITION
+# ==============================================================================
+
+if __name__ == '__main__':
+    try:
+        main()
+    except KeyboardInterrupt:
+        keyglove_bench.stop_sim()
+        print("Goodbye!")
+        sys.exit(0)
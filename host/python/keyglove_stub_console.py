@@ -80,7 +80,7 @@ def my_kg_event(sender, args):
         print("%.2f <-- UNKNOWN EVENT: [ %s ]" % (time.time(), ' '.join(['%02X' % b for b in args['raw']])))
 
 def my_kg_log(sender, args):
-    print("%.2f <-- LOG (%d): %s" % (time.time(), args["level"], args["log"]))
+    print("%.2f <-- LOG (%d): %s" % (time.time(), args["level"], args["message"]))
 
 def my_kg_evt_touch_status(sender, args):
     print("%.2f *** Touch update: %s" % (time.time(), ' '.join(['%02X' % b for b in args['status']])))
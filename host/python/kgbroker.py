@@ -0,0 +1,221 @@
+#!/usr/bin/env python
+
+"""
+================================================================================
+Keyglove broker shared event ring and client library
+2014-12-14 by Jeff Rowberg <jeff@rowberg.net>
+
+Changelog:
+    2014-12-14 - Initial release
+
+================================================================================
+Keyglove source code is placed under the MIT license
+Copyright (c) 2014 Jeff Rowberg
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+================================================================================
+
+"""
+
+__author__ = "Jeff Rowberg"
+__license__ = "MIT"
+__version__ = "2014-12-14"
+__email__ = "jeff@rowberg.net"
+
+"""
+The broker daemon (keyglove_broker.py) owns the Keyglove device and shares it
+with any number of local client processes:
+
+    Events  - Every untagged event packet is written once into a ring of
+              fixed-size slots in a shared memory file. Clients map the same
+              file and read the ring on their own, so the broker does the same
+              work no matter how many clients there are, and a slow client
+              can only make itself fall behind.
+
+    Commands - Clients send raw command packets over a Unix SEQPACKET socket
+              (one packet per message). The broker sends each one to the device
+              with its own tag and sends the response back to the client which
+              sent the command, with the client's own tag (if any) restored.
+
+Shared ring layout (all fields little-endian):
+
+    Header (64 bytes):
+        0   4s  Magic 'KGEV'
+        4   H   Layout version (1)
+        6   H   Slot size in bytes
+        8   L   Number of slots
+        16  Q   Number of packets written so far
+
+    Slot (slot size bytes, slot for packet N is N % number of slots):
+        0   Q   N + 1 once packet N is complete, 0 while it is being written
+        8   d   Host time the packet was received (time.time())
+        16  H   Packet length
+        18  ..  Raw packet (header and payload)
+
+There is a single writer and no locks. A reader checks the slot sequence number
+before and after reading a packet, and drops it if the writer lapped the reader
+in between.
+"""
+
+import errno, mmap, os, select, socket, struct, tempfile, time
+
+RING_MAGIC = b'KGEV'
+RING_VERSION = 1
+RING_HEADER_SIZE = 64
+RING_SLOT_SIZE = 272            # slot header plus the largest possible packet (4 + 250)
+RING_SLOT_COUNT = 1024          # about 10 seconds of 100Hz motion and touch data
+
+ring_header = struct.Struct('<4sHHL')
+ring_counter = struct.Struct('<Q')
+ring_slot_header = struct.Struct('<dH')
+
+def default_path(name='keyglove'):
+    # shared memory file and command socket locations for a broker instance
+    base = '/dev/shm' if os.path.isdir('/dev/shm') else tempfile.gettempdir()
+    return (os.path.join(base, name + '.events'), os.path.join(tempfile.gettempdir(), name + '.sock'))
+
+class KeygloveBrokerError(Exception):
+    pass
+
+class EventRing(object):
+
+    """Shared memory packet ring, written by the broker and read by clients"""
+
+    def __init__(self, path, writer=False, slot_count=RING_SLOT_COUNT, slot_size=RING_SLOT_SIZE):
+        self.path = path
+        self.writer = writer
+        if writer:
+            fd = os.open(path, os.O_RDWR | os.O_CREAT | os.O_TRUNC, 0644)
+            os.ftruncate(fd, RING_HEADER_SIZE + slot_count * slot_size)
+        else:
+            fd = os.open(path, os.O_RDONLY)
+        try:
+            self.map = mmap.mmap(fd, 0, mmap.MAP_SHARED, mmap.PROT_READ | (mmap.PROT_WRITE if writer else 0))
+        finally:
+            os.close(fd)
+
+        if writer:
+            ring_header.pack_into(self.map, 0, RING_MAGIC, RING_VERSION, slot_size, slot_count)
+            ring_counter.pack_into(self.map, 16, 0)
+            self.slot_size = slot_size
+            self.slot_count = slot_count
+        else:
+            magic, version, self.slot_size, self.slot_count = ring_header.unpack_from(self.map, 0)
+            if magic != RING_MAGIC or version != RING_VERSION:
+                raise KeygloveBrokerError("'%s' is not a Keyglove event ring" % path)
+
+        # readers start with whatever is written next
+        self.next = self.written()
+        self.lost = 0
+
+    def close(self):
+        self.map.close()
+        if self.writer:
+            try:
+                os.unlink(self.path)
+            except OSError:
+                pass
+
+    def written(self):
+        return ring_counter.unpack_from(self.map, 16)[0]
+
+    def publish(self, packet, timestamp=None):
+        # write one packet (str or bytearray) into the next slot (broker only)
+        seq = ring_counter.unpack_from(self.map, 16)[0]
+        offset = RING_HEADER_SIZE + (seq % self.slot_count) * self.slot_size
+        length = min(len(packet), self.slot_size - 18)
+        ring_counter.pack_into(self.map, offset, 0)
+        ring_slot_header.pack_into(self.map, offset + 8, time.time() if timestamp is None else timestamp, length)
+        self.map[offset + 18:offset + 18 + length] = bytes(packet[:length])
+        ring_counter.pack_into(self.map, offset, seq + 1)
+        ring_counter.pack_into(self.map, 16, seq + 1)
+
+    def read(self):
+        # return a list of (timestamp, packet) for everything written since the last call
+        # packets which were overwritten before this reader got to them are counted in self.lost
+        written = ring_counter.unpack_from(self.map, 16)[0]
+        if written - self.next > self.slot_count:
+            self.lost += written - self.slot_count - self.next
+            self.next = written - self.slot_count
+        packets = []
+        while self.next < written:
+            offset = RING_HEADER_SIZE + (self.next % self.slot_count) * self.slot_size
+            seq = ring_counter.unpack_from(self.map, offset)[0]
+            if seq == self.next + 1:
+                timestamp, length = ring_slot_header.unpack_from(self.map, offset + 8)
+                packet = self.map[offset + 18:offset + 18 + length]
+                if ring_counter.unpack_from(self.map, offset)[0] == seq:
+                    packets.append((timestamp, packet))
+                else:
+                    self.lost += 1
+            else:
+                self.lost += 1
+            self.next += 1
+        return packets
+
+class BrokerClient(object):
+
+    """Connection to a running broker, for events and commands"""
+
+    def __init__(self, name='keyglove'):
+        ring_path, socket_path = default_path(name)
+        self.ring = EventRing(ring_path)
+        self.sock = socket.socket(socket.AF_UNIX, socket.SOCK_SEQPACKET)
+        try:
+            self.sock.connect(socket_path)
+        except socket.error as e:
+            self.ring.close()
+            raise KeygloveBrokerError("Unable to connect to broker at '%s': %s" % (socket_path, e))
+
+    def close(self):
+        self.sock.close()
+        self.ring.close()
+
+    def events(self):
+        # return a list of (timestamp, raw event packet) received since the last call
+        return self.ring.read()
+
+    def dispatch_events(self, kgapi):
+        # feed new events to a kglib.KGAPI object, so its kg_evt_* handlers fire as if it owned the device
+        packets = self.ring.read()
+        for timestamp, packet in packets:
+            kgapi.process_packet(bytearray(packet))
+        return len(packets)
+
+    def send(self, packet):
+        # send a command packet (str, bytearray or list), which may carry a tag of its own
+        if type(packet) == type(list()):
+            packet = b''.join(chr(x) for x in packet)
+        self.sock.send(bytes(packet))
+
+    def recv(self, timeout=None):
+        # return the next response (or protocol error event for a command), or None on timeout
+        ready, _, _ = select.select([ self.sock ], [], [], timeout)
+        if not ready:
+            return None
+        packet = self.sock.recv(4096)
+        if not packet:
+            raise KeygloveBrokerError("Broker closed the connection")
+        return bytearray(packet)
+
+    def send_and_return(self, packet, timeout=1):
+        # send a command and wait for its response (assumes no other commands from this client are outstanding)
+        self.send(packet)
+        return self.recv(timeout)
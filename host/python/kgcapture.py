@@ -0,0 +1,351 @@
+#!/usr/bin/env python
+
+"""
+================================================================================
+Keyglove binary capture file writer and reader
+2014-12-14 by Jeff Rowberg <jeff@rowberg.net>
+
+Changelog:
+    2014-12-14 - Initial release
+
+
+================================================================================
+Keyglove source code is placed under the MIT license
+Copyright (c) 2014 Jeff Rowberg
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+================================================================================
+
+"""
+
+__author__ = "Jeff Rowberg"
+__license__ = "MIT"
+__version__ = "2014-12-14"
+__email__ = "jeff@rowberg.net"
+
+"""
+A capture file is an append-only log of timestamped KGAPI packets. Every so
+often the writer adds an index block describing the packets since the previous
+one (time range and which packet classes they contain), so a reader can skip
+straight past long stretches that do not match a time or class filter without
+touching them. The reader memory-maps the file, so only the parts that are
+actually looked at are read from disk.
+
+File layout (all fields little-endian):
+
+    File header (32 bytes):
+        0   4s  Magic 'KGCP'
+        4   H   Format version (1)
+        6   H   File header size (32)
+        8   d   Time the capture was started (time.time())
+        16  L   Packets per index block
+        20  12x Reserved
+
+    Records, one after another, each with a 12-byte header:
+        0   B   Record kind (KIND_RECEIVED, KIND_SENT, or KIND_INDEX)
+        1   x   Reserved
+        2   H   Record data length
+        4   d   Host time the packet was received or sent (time.time())
+        12  ..  Record data (the raw packet for KIND_RECEIVED and KIND_SENT)
+
+    Index record data:
+        0   Q   File offset of the first packet record in this block
+        8   L   Number of packet records in this block
+        12  d   Timestamp of the first packet in this block
+        20  d   Timestamp of the last packet in this block
+        28  32s Bitmap of event class IDs in this block
+        60  32s Bitmap of command/response class IDs in this block
+        92  Q   File offset of the previous index record (0 if none)
+
+    Trailer (16 bytes, written by close()):
+        0   4s  Magic 'KGCX'
+        4   4x  Reserved
+        8   Q   File offset of the last index record
+
+With the trailer, the reader loads the whole index by following the chain of
+index records backwards. A file that was never closed (e.g. the capture was
+killed) has no trailer, so the reader walks the record headers instead and
+treats whatever follows the last index record as one more block. Nothing that
+was written before the interruption is lost.
+"""
+
+import bisect, collections, mmap, os, struct, threading, time
+
+CAPTURE_MAGIC = b'KGCP'
+CAPTURE_TRAILER_MAGIC = b'KGCX'
+CAPTURE_VERSION = 1
+
+KIND_RECEIVED = 1       # packet received from the Keyglove (response or event)
+KIND_SENT = 2           # packet sent to the Keyglove (command)
+KIND_INDEX = 3          # index block
+
+capture_header = struct.Struct('<4sHHdL12x')
+capture_record = struct.Struct('<BxHd')
+capture_index = struct.Struct('<QLdd32s32sQ')
+capture_trailer = struct.Struct('<4s4xQ')
+capture_bitmap = struct.Struct('<4Q')
+
+# one packet from a capture file; packet is the raw packet (header and payload) as a str
+CaptureFrame = collections.namedtuple('CaptureFrame', 'timestamp kind packet')
+
+# one index block; offset/end are the file range of its packet records, and the masks are class ID bitmaps (as ints)
+CaptureBlock = collections.namedtuple('CaptureBlock', 'offset end count first last event_mask command_mask')
+
+class KeygloveCaptureError(Exception):
+    pass
+
+def pack_bitmap(mask):
+    return capture_bitmap.pack(*[ (mask >> (i * 64)) & 0xFFFFFFFFFFFFFFFF for i in xrange(4) ])
+
+def unpack_bitmap(data):
+    mask = 0
+    for i, word in enumerate(capture_bitmap.unpack(data)):
+        mask |= word << (i * 64)
+    return mask
+
+def class_mask(classes):
+    # turn a list of class IDs into a bitmap (None = all classes)
+    if classes == None:
+        return (1 << 256) - 1
+    mask = 0
+    for class_id in classes:
+        mask |= 1 << class_id
+    return mask
+
+class CaptureWriter(object):
+
+    """Append packets to a new capture file (safe to use from several threads)"""
+
+    def __init__(self, path, index_interval=1024, index_seconds=10.0):
+        self.path = path
+        self.index_interval = index_interval
+        self.index_seconds = index_seconds
+        self.lock = threading.Lock()
+        self.file = open(path, 'wb')
+        self.file.write(capture_header.pack(CAPTURE_MAGIC, CAPTURE_VERSION, capture_header.size, time.time(), index_interval))
+        self.offset = capture_header.size
+        self.last_index = 0
+        self.count = 0
+        self.start_block()
+
+    def start_block(self):
+        self.block_offset = self.offset
+        self.block_count = 0
+        self.block_first = 0
+        self.block_last = 0
+        self.block_events = 0
+        self.block_commands = 0
+
+    def write(self, packet, sent=False, timestamp=None):
+        # append one raw packet (str, bytearray or list), received from the Keyglove unless sent is True
+        if type(packet) != type(str()):
+            packet = bytes(bytearray(packet))
+        if timestamp == None:
+            timestamp = time.time()
+        with self.lock:
+            if self.file == None:
+                return
+            self.file.write(capture_record.pack(KIND_SENT if sent else KIND_RECEIVED, len(packet), timestamp))
+            self.file.write(packet)
+            self.offset += capture_record.size + len(packet)
+            self.count += 1
+
+            if self.block_count == 0:
+                self.block_first = timestamp
+            self.block_last = timestamp
+            self.block_count += 1
+            if len(packet) >= 4:
+                if ord(packet[0]) & 0xC0 == 0xC0:
+                    self.block_commands |= 1 << ord(packet[2])
+                else:
+                    self.block_events |= 1 << ord(packet[2])
+
+            if self.block_count >= self.index_interval or timestamp - self.block_first >= self.index_seconds:
+                self.write_index()
+
+    def write_index(self):
+        # caller must hold self.lock
+        if self.block_count == 0:
+            return
+        data = capture_index.pack(self.block_offset, self.block_count, self.block_first, self.block_last,
+            pack_bitmap(self.block_events), pack_bitmap(self.block_commands), self.last_index)
+        self.file.write(capture_record.pack(KIND_INDEX, len(data), self.block_last))
+        self.file.write(data)
+        self.last_index = self.offset
+        self.offset += capture_record.size + len(data)
+        self.start_block()
+
+    def flush(self):
+        with self.lock:
+            if self.file != None:
+                self.file.flush()
+
+    def close(self):
+        with self.lock:
+            if self.file == None:
+                return
+            self.write_index()
+            self.file.write(capture_trailer.pack(CAPTURE_TRAILER_MAGIC, self.last_index))
+            self.file.close()
+            self.file = None
+
+class CaptureReader(object):
+
+    """Memory-mapped random access to a capture file"""
+
+    def __init__(self, path):
+        self.path = path
+        with open(path, 'rb') as f:
+            size = os.fstat(f.fileno()).st_size
+            if size < capture_header.size:
+                raise KeygloveCaptureError("'%s' is too short to be a Keyglove capture" % path)
+            self.map = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+        magic, version, header_size, self.started, self.index_interval = capture_header.unpack_from(self.map, 0)
+        if magic != CAPTURE_MAGIC or version != CAPTURE_VERSION:
+            self.map.close()
+            raise KeygloveCaptureError("'%s' is not a Keyglove capture" % path)
+        self.header_size = header_size
+
+        self.complete = False
+        self.blocks = []
+        if size >= header_size + capture_trailer.size:
+            magic, last_index = capture_trailer.unpack_from(self.map, size - capture_trailer.size)
+            if magic == CAPTURE_TRAILER_MAGIC:
+                self.load_index(last_index)
+                self.complete = True
+        if not self.complete:
+            self.recover_index(size)
+        self.block_times = [ block.first for block in self.blocks ]
+
+    def close(self):
+        self.map.close()
+
+    def load_index(self, offset):
+        # follow the index chain backwards from the last index record
+        # each index record directly follows the packets it describes, so it also marks where they end
+        while offset != 0:
+            kind, length, timestamp = capture_record.unpack_from(self.map, offset)
+            if kind != KIND_INDEX:
+                raise KeygloveCaptureError("Broken index chain at offset %d in '%s'" % (offset, self.path))
+            block_offset, count, first, last, events, commands, previous = capture_index.unpack_from(self.map, offset + capture_record.size)
+            self.blocks.append(CaptureBlock(block_offset, offset, count, first, last, unpack_bitmap(events), unpack_bitmap(commands)))
+            offset = previous
+        self.blocks.reverse()
+
+    def recover_index(self, size):
+        # no trailer, so walk the record headers and index whatever follows the last complete index record
+        offset = self.header_size
+        block_offset = offset
+        count = 0
+        first = last = 0
+        events = commands = 0
+        while offset + capture_record.size <= size:
+            kind, length, timestamp = capture_record.unpack_from(self.map, offset)
+            end = offset + capture_record.size + length
+            if end > size or kind not in (KIND_RECEIVED, KIND_SENT, KIND_INDEX):
+                break # partly written record at the end
+            if kind == KIND_INDEX:
+                data = capture_index.unpack_from(self.map, offset + capture_record.size)
+                self.blocks.append(CaptureBlock(data[0], offset, data[1], data[2], data[3], unpack_bitmap(data[4]), unpack_bitmap(data[5])))
+                block_offset = end
+                count = 0
+                events = commands = 0
+            else:
+                if count == 0:
+                    first = timestamp
+                last = timestamp
+                count += 1
+                if length >= 4:
+                    if ord(self.map[offset + capture_record.size]) & 0xC0 == 0xC0:
+                        commands |= 1 << ord(self.map[offset + capture_record.size + 2])
+                    else:
+                        events |= 1 << ord(self.map[offset + capture_record.size + 2])
+            offset = end
+        if count > 0:
+            self.blocks.append(CaptureBlock(block_offset, offset, count, first, last, events, commands))
+
+    def __len__(self):
+        return sum(block.count for block in self.blocks)
+
+    def start_time(self):
+        return self.blocks[0].first if self.blocks else None
+
+    def end_time(self):
+        return self.blocks[-1].last if self.blocks else None
+
+    def event_classes(self):
+        mask = 0
+        for block in self.blocks:
+            mask |= block.event_mask
+        return [ i for i in xrange(256) if mask & (1 << i) ]
+
+    def command_classes(self):
+        mask = 0
+        for block in self.blocks:
+            mask |= block.command_mask
+        return [ i for i in xrange(256) if mask & (1 << i) ]
+
+    def frames(self, start=None, end=None, classes=None, events=True, commands=True, kinds=(KIND_RECEIVED, KIND_SENT)):
+        """Generate CaptureFrame tuples in file order.
+
+        start/end limit packet timestamps (absolute, as time.time()), classes
+        is a list of class IDs (None = all), and events/commands select the
+        packet types. Blocks which cannot contain a match are skipped using
+        the index alone.
+        """
+
+        mask = class_mask(classes)
+        event_mask = mask if events else 0
+        command_mask = mask if commands else 0
+        first = 0
+        if start != None:
+            # blocks are in time order, so start from the last one which begins at or before start
+            first = max(bisect.bisect_right(self.block_times, start) - 1, 0)
+        for block in self.blocks[first:]:
+            if end != None and block.first > end:
+                break
+            if start != None and block.last < start:
+                continue
+            if not (block.event_mask & event_mask or block.command_mask & command_mask):
+                continue
+            offset = block.offset
+            while offset < block.end:
+                kind, length, timestamp = capture_record.unpack_from(self.map, offset)
+                data = offset + capture_record.size
+                offset = data + length
+                if kind not in kinds or length < 4:
+                    continue
+                if (start != None and timestamp < start) or (end != None and timestamp > end):
+                    continue
+                packet_class = ord(self.map[data + 2])
+                if ord(self.map[data]) & 0xC0 == 0xC0:
+                    if not command_mask & (1 << packet_class):
+                        continue
+                elif not event_mask & (1 << packet_class):
+                    continue
+                yield CaptureFrame(timestamp, kind, self.map[data:offset])
+
+    def dispatch(self, kgapi, **filters):
+        # replay received packets through a kglib.KGAPI object, so its kg_rsp_*/kg_evt_* handlers fire (same filters as frames())
+        count = 0
+        for frame in self.frames(kinds=(KIND_RECEIVED,), **filters):
+            kgapi.process_packet(bytearray(frame.packet))
+            count += 1
+        return count
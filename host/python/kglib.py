@@ -6,6 +6,12 @@ Keyglove Protocol Python interface library
 2014-12-06 by Jeff Rowberg <jeff@rowberg.net>
 
 Changelog:
+    2014-12-20 - Added device clock synchronization and timestamped events
+               - Decode tokenized log records against the kglog_messages dictionary
+    2014-12-14 - Added tagged commands so several can be outstanding at once
+               - Replaced busy-wait in send_and_return() with a condition wait
+               - Read and parse incoming data in whole chunks instead of byte by byte
+               - Decode payloads with precompiled struct.Struct layouts
     2014-12-06 - Separated communication code from parser/generator code
                - Added transparent support for PySerial/PyUSB/PyWinUSB
     2014-09-01 - Added unknown last response/event case for stability
@@ -41,10 +47,17 @@ THE SOFTWARE.
 
 __author__ = "Jeff Rowberg"
 __license__ = "MIT"
-__version__ = "2014-12-14"
+__version__ = "2014-12-20"
 __email__ = "jeff@rowberg.net"
 
-import struct, platform, sys, threading, time
+import re, struct, platform, sys, threading, time
+
+# log message dictionary generated from the firmware by keyglove_logdict.py
+try:
+    import kglog_messages
+    log_messages = kglog_messages.messages
+except ImportError:
+    log_messages = {}
 
 
 
@@ -134,6 +147,123 @@ class KeygloveEventHandler(object):
     __isub__ = remove
     __call__ = fire
 
+class KeygloveCommand(object):
+
+    """Command sent with KeygloveDevice.submit() which is waiting for its response"""
+
+    def __init__(self, device, tag, callback=None):
+        self.device = device
+        self.tag = tag
+        self.callback = callback
+        self.response = None
+        self.finished = False
+        self.abandoned = False
+
+    def done(self):
+
+        """Check whether the response (or the protocol error caused by this command) has arrived"""
+
+        return self.finished
+
+    def result(self, timeout=None):
+
+        """Wait for and return the response to this command.
+
+        If the command caused a protocol error instead, the error event is
+        returned. If nothing arrives within timeout seconds (None waits forever),
+        or the device is disconnected, None is returned and the tag is freed.
+        """
+
+        timed_out = False
+        with self.device.pending_lock:
+            deadline = None if timeout is None else time.time() + timeout
+            while not self.finished and not self.abandoned:
+                if deadline is None:
+                    self.device.pending_lock.wait()
+                else:
+                    remaining = deadline - time.time()
+                    if remaining <= 0:
+                        break
+                    self.device.pending_lock.wait(remaining)
+            if not self.finished and not self.abandoned:
+                # timed out, so give up on this tag (a late response will be ignored)
+                timed_out = True
+                if self.device.pending_commands.get(self.tag) is self:
+                    del self.device.pending_commands[self.tag]
+                    self.device.responses_pending = max(self.device.responses_pending - 1, 0)
+                self.abandoned = True
+                self.device.pending_lock.notify_all()
+            idle = self.device.responses_pending == 0
+        if timed_out:
+            self.device.on_api_timeout()
+            if idle:
+                self.device.on_api_idle()
+        return self.response
+
+
+
+class KeygloveClock(object):
+
+    """Estimates the offset and drift between the Keyglove's clock and the host's
+
+    Each sample is one system_get_time exchange: the host time just before the
+    command was sent, the host time just after the response arrived, and the
+    device clock readings from the response. The device read its clock
+    somewhere in between, so the midpoint of the round trip is the best guess
+    for the matching host time, and its error is at most half the round trip.
+    Link jitter mostly makes round trips longer, so only the quickest half of
+    the recent samples are used for a least-squares fit of offset and drift.
+    """
+
+    def __init__(self, window=32, min_span=10.0):
+        self.window = window
+        self.min_span = min_span    # device seconds the samples must cover before drift is estimated
+        self.samples = []           # (device seconds, host seconds at midpoint, round trip seconds)
+        self.offset = None          # host seconds minus device seconds at self.reference
+        self.drift = 0.0            # change in offset per device second (i.e. 1e-6 = 1ppm)
+        self.reference = 0.0        # device seconds of the newest sample
+        self.micros = None          # unwrapped device microseconds of the newest sample
+        self.lock = threading.Lock()
+
+    def ready(self):
+        return self.offset != None
+
+    def add_sample(self, host_send, host_recv, seconds, subticks, microseconds):
+        # the 1Hz/100Hz tick counters never wrap in practice, so use them to unwrap the microsecond counter
+        ticks = (seconds * 100 + subticks) * 10000
+        micros = ((ticks - microseconds + 0x80000000) // 0x100000000) * 0x100000000 + microseconds
+        with self.lock:
+            self.micros = micros
+            self.samples.append((micros / 1000000.0, (host_send + host_recv) / 2.0, host_recv - host_send))
+            del self.samples[:-self.window]
+            self.reference = self.samples[-1][0]
+
+            best = sorted(self.samples, key=lambda sample: sample[2])[:max(1, len(self.samples) // 2)]
+            x = [sample[0] - self.reference for sample in best]
+            y = [sample[1] - sample[0] for sample in best]
+            n = len(best)
+            mean_x = sum(x) / n
+            mean_y = sum(y) / n
+            var_x = sum((xi - mean_x) ** 2 for xi in x)
+            # over a short span the slope is all noise, so keep the last drift until there is a useful baseline
+            if n > 1 and max(x) - min(x) >= self.min_span:
+                self.drift = sum((xi - mean_x) * (yi - mean_y) for xi, yi in zip(x, y)) / var_x
+            self.offset = mean_y - self.drift * mean_x
+
+    def unwrap_micros(self, microseconds):
+        # take the 32-bit reading closest to the newest sample (good for about 35 minutes either way)
+        with self.lock:
+            if self.micros == None:
+                return microseconds
+            return self.micros + ((microseconds - self.micros + 0x80000000) % 0x100000000) - 0x80000000
+
+    def to_host(self, device_seconds):
+        # convert device seconds since boot into host time.time() seconds
+        with self.lock:
+            if self.offset == None:
+                return None
+            return device_seconds + self.offset + self.drift * (device_seconds - self.reference)
+
 
 
 class KeygloveDevice(object):
@@ -158,9 +288,15 @@ class KeygloveDevice(object):
         self.description = description
         self.mac = mac
         self.debug = debug
+        self.capture = None     # kgcapture.CaptureWriter (or anything with write(packet, sent)) to record all traffic
 
         self.connected = False
         self.responses_pending = 0
+        self.pending_lock = threading.Condition()
+        self.pending_commands = {}
+        self.last_tag = 0
+        self.clock_thread = None
+        self.clock_stop = threading.Event()
         self.serial_port = None
         self.serial_read_thread = None
         self.pywinusb_output = None
@@ -261,6 +397,14 @@ class KeygloveDevice(object):
         if not self.connected:
             return True
 
+        # nothing outstanding will get a response now
+        with self.pending_lock:
+            for command in self.pending_commands.values():
+                command.abandoned = True
+            self.pending_commands = {}
+            self.responses_pending = 0
+            self.pending_lock.notify_all()
+
         if self.type == 'hid':
             if self.backend == 'pywinusb':
                 # close the device (PyWinUSB spawns separate read thread while open)
@@ -302,8 +446,11 @@ class KeygloveDevice(object):
             packet = b''.join(chr(x) for x in packet)
         if self.debug:
             print('=>[ ' + ' '.join(['%02X' % ord(b) for b in packet ]) + ' ]')
+        if self.capture != None:
+            self.capture.write(packet, True)
         self.on_before_tx_command()
-        self.responses_pending = self.responses_pending + 1
+        with self.pending_lock:
+            self.responses_pending = self.responses_pending + 1
         self.on_api_busy()
 
         if self.type == 'hid':
@@ -373,35 +520,114 @@ class KeygloveDevice(object):
 
         self.on_tx_command_complete()
 
+    def submit(self, packet, timeout=None, callback=None):
+        # send a command without waiting for its response, returning a KeygloveCommand to collect it with later
+        # each outstanding command gets its own tag (1-7) which the Keyglove echoes in the response, so up to 7 can be
+        # in flight at once; if all tags are in use, wait up to timeout seconds (None = forever) for one to come back
+        # callback(command), if given, is called from the reader thread as soon as the response arrives
+        if type(packet) == type(list()):
+            packet = b''.join(chr(x) for x in packet)
+        with self.pending_lock:
+            deadline = None if timeout is None else time.time() + timeout
+            while self.connected and len(self.pending_commands) == 7:
+                if deadline is None:
+                    self.pending_lock.wait()
+                else:
+                    remaining = deadline - time.time()
+                    if remaining <= 0:
+                        return None
+                    self.pending_lock.wait(remaining)
+            if not self.connected:
+                raise KeygloveError('Cannot send packet, Keyglove not connected')
+
+            # use tags in rotation so a late response to an abandoned command is unlikely to match a new one
+            tag = self.last_tag
+            while True:
+                tag = tag % 7 + 1
+                if tag not in self.pending_commands:
+                    break
+            self.last_tag = tag
+            command = KeygloveCommand(self, tag, callback)
+            self.pending_commands[tag] = command
+        self.send(chr((ord(packet[0]) & 0xC7) | (tag << 3)) + packet[1:])
+        return command
+
     def send_and_return(self, packet, timeout=0):
-        if self.responses_pending > 0:
-            raise KeygloveError("Cannot use send_and_return() if there is already a pending response")
-        self.send(packet)
-        t0 = time.time()
-        while self.connected and self.responses_pending > 0 and (timeout == 0 or time.time() - t0 < timeout):
-            pass
-        if self.responses_pending > 0:
-            # timed out waiting for response
-            self.responses_pending = 0
+        # send a command and wait up to timeout seconds (0 = forever) for its response
+        command = self.submit(packet, timeout if timeout > 0 else None)
+        if command == None:
             self.on_api_timeout()
-            self.on_api_idle()
             return None
-        else:
-            # got response back correctly
-            if self.kgapi:
-                return self.kgapi.get_last_response()
-            else:
-                # extremely unlikely but not impossible case where KGAPI object is gone before this finishes
-                return None
+        return command.result(timeout if timeout > 0 else None)
+
+    def sync_clock(self, samples=8, timeout=1):
+        # take a few system_get_time samples to update the clock estimate, returning the number that worked
+        if self.kgapi.clock == None:
+            self.kgapi.clock = KeygloveClock()
+        count = 0
+        for i in range(samples):
+            host_send = time.time()
+            command = self.submit(self.kgapi.kg_cmd_system_get_time(), timeout)
+            response = command.result(timeout) if command != None else None
+            host_recv = time.time()
+            if response == None or response['class_id'] != 1:
+                continue
+            payload = response['payload']
+            self.kgapi.clock.add_sample(host_send, host_recv, payload['seconds'], payload['subticks'], payload['microseconds'])
+            count += 1
+        return count
+
+    def start_clock_sync(self, interval=5, samples=4):
+        # keep the clock estimate up to date from a background thread (drift matters over long sessions)
+        self.stop_clock_sync()
+        self.clock_stop.clear()
+        self.sync_clock(samples=16)
+
+        def run():
+            while not self.clock_stop.wait(interval) and self.connected:
+                try:
+                    self.sync_clock(samples)
+                except KeygloveError:
+                    break
+
+        self.clock_thread = threading.Thread(target=run)
+        self.clock_thread.daemon = True
+        self.clock_thread.start()
+
+    def stop_clock_sync(self):
+        if self.clock_thread != None:
+            self.clock_stop.set()
+            if self.clock_thread is not threading.current_thread():
+                self.clock_thread.join()
+            self.clock_thread = None
+
+    def rx_data(self, data):
+        for packet_type, packet in self.kgapi.parse_data(data):
+            if self.capture != None:
+                self.capture.write(packet['raw'])
+            # tagged events are protocol errors caused by a tagged command, which will not get a response
+            if packet_type == 0xC0 or packet['tag'] != 0:
+                self.complete(packet)
+
+    def complete(self, packet):
+        with self.pending_lock:
+            command = self.pending_commands.pop(packet['tag'], None)
+            if command != None:
+                command.response = packet
+                command.finished = True
+            if command != None or packet['tag'] == 0:
+                self.responses_pending = max(self.responses_pending - 1, 0)
+            self.pending_lock.notify_all()
+            idle = self.responses_pending == 0
+        if command != None and command.callback != None:
+            command.callback(command)
+        if idle:
+            self.on_api_idle()
 
     # handler for reading incoming raw HID packets via PyWinUSB (thread started inside PyWinUSB code)
     def pywinusb_read_handler(self, data):
         if ((data[0] == 0x00 and self.transport == 'usb') or (data[0] == 0x04 and self.transport == 'bluetooth')) and data[1] < len(data) - 1:
-            for b in data[2:data[1] + 2]:
-                if self.kgapi.parse(b) == 0xC0:
-                    self.responses_pending = self.responses_pending - 1
-                    if self.responses_pending == 0:
-                        self.on_api_idle()
+            self.rx_data(bytearray(data[2:data[1] + 2]))
 
     # handler for reading incoming raw HID packets via PyUSB (thread started in local connect() method)
     def pyusb_read_handler(self):
@@ -409,11 +635,7 @@ class KeygloveDevice(object):
             try:
                 ret = self.devobj.read(self.pyusb_endpoint_in.bEndpointAddress, self.pyusb_endpoint_in.wMaxPacketSize)
                 if len(ret) > 0 and ret[0] > 0:
-                    for b in ret[1:ret[0] + 1]:
-                        if self.kgapi.parse(b) == 0xC0:
-                            self.responses_pending = self.responses_pending - 1
-                            if self.responses_pending == 0:
-                                self.on_api_idle()
+                    self.rx_data(bytearray(ret[1:ret[0] + 1]))
             except usb.core.USBError as e:
                 if e.errno == 110 or "timed out" in str(e) or "not detach" in str(e):
                     # PyUSB timeout, probably just no data
@@ -429,19 +651,120 @@ class KeygloveDevice(object):
     def pyserial_read_handler(self):
         while self.serial_port != None and self.serial_port.isOpen():
             try:
-                ch = self.serial_port.read()
-                if len(ch):
-                    #print "%02X " % ord(ch)
-                    if self.kgapi.parse(ord(ch)) == 0xC0:
-                        self.responses_pending = self.responses_pending - 1
-                        if self.responses_pending == 0:
-                            self.on_api_idle()
+                # wait (up to the port timeout) for at least one byte, then take everything else already waiting
+                data = self.serial_port.read(max(1, self.serial_port.inWaiting()))
+                if len(data):
+                    self.rx_data(data)
             except serial.SerialException as e:
                 # serial port cannot be read from, most likely unplugged/disconnected
                 self.on_unplugged()
                 self.disconnect()
 
 
+# any byte which can start a packet (0x80 or 0xC0, plus tag), for resyncing after garbage
+kgapi_packet_start = re.compile('[' + ''.join(re.escape(chr(b)) for b in range(0x80, 0x100, 0x08)) + ']')
+
+# precompiled layouts for the fixed part of each response and event payload
+kg_evt_protocol_error_struct = struct.Struct('<H')
+kg_rsp_system_ping_struct = struct.Struct('<L')
+kg_rsp_system_reset_struct = struct.Struct('<H')
+kg_rsp_system_get_info_struct = struct.Struct('<HHHHL')
+kg_rsp_system_get_capabilities_struct = struct.Struct('<H')
+kg_rsp_system_get_memory_struct = struct.Struct('<LL')
+kg_rsp_system_get_battery_status_struct = struct.Struct('<BB')
+kg_rsp_system_set_timer_struct = struct.Struct('<H')
+kg_rsp_system_get_time_struct = struct.Struct('<LBL')
+kg_rsp_system_get_timestamp_mode_struct = struct.Struct('<B')
+kg_rsp_system_set_timestamp_mode_struct = struct.Struct('<H')
+kg_rsp_system_get_event_mask_struct = struct.Struct('<HH')
+kg_rsp_system_set_event_mask_struct = struct.Struct('<H')
+kg_rsp_system_get_event_rate_struct = struct.Struct('<HBH')
+kg_rsp_system_set_event_rate_struct = struct.Struct('<H')
+kg_rsp_system_get_log_level_struct = struct.Struct('<B')
+kg_rsp_system_set_log_level_struct = struct.Struct('<H')
+kg_rsp_system_get_memory_stats_struct = struct.Struct('<HHHHHB')
+kg_rsp_system_get_memory_allocations_struct = struct.Struct('<HLHH')
+kg_rsp_system_get_memory_threshold_struct = struct.Struct('<H')
+kg_rsp_system_set_memory_threshold_struct = struct.Struct('<H')
+kg_evt_system_boot_struct = struct.Struct('<HHHHL')
+kg_evt_system_error_struct = struct.Struct('<H')
+kg_evt_system_capability_struct = struct.Struct('<BB')
+kg_evt_system_battery_status_struct = struct.Struct('<BB')
+kg_evt_system_timer_tick_struct = struct.Struct('<BLB')
+kg_evt_system_timestamp_mode_struct = struct.Struct('<B')
+kg_evt_system_memory_low_struct = struct.Struct('<HH')
+kg_rsp_bluetooth_get_mode_struct = struct.Struct('<HB')
+kg_rsp_bluetooth_set_mode_struct = struct.Struct('<H')
+kg_rsp_bluetooth_reset_struct = struct.Struct('<H')
+kg_rsp_bluetooth_get_mac_struct = struct.Struct('<H6s')
+kg_rsp_bluetooth_get_pairings_struct = struct.Struct('<HB')
+kg_rsp_bluetooth_discover_struct = struct.Struct('<H')
+kg_rsp_bluetooth_pair_struct = struct.Struct('<H')
+kg_rsp_bluetooth_delete_pairing_struct = struct.Struct('<H')
+kg_rsp_bluetooth_clear_pairings_struct = struct.Struct('<H')
+kg_rsp_bluetooth_get_connections_struct = struct.Struct('<HB')
+kg_rsp_bluetooth_connect_struct = struct.Struct('<H')
+kg_rsp_bluetooth_disconnect_struct = struct.Struct('<H')
+kg_evt_bluetooth_mode_struct = struct.Struct('<B')
+kg_evt_bluetooth_inquiry_response_struct = struct.Struct('<6s3sbBBB')
+kg_evt_bluetooth_inquiry_complete_struct = struct.Struct('<B')
+kg_evt_bluetooth_pairing_status_struct = struct.Struct('<B6sBBBB')
+kg_evt_bluetooth_pairing_failed_struct = struct.Struct('<6s')
+kg_evt_bluetooth_connection_status_struct = struct.Struct('<B6sBBB')
+kg_evt_bluetooth_connection_closed_struct = struct.Struct('<BH')
+kg_rsp_feedback_get_blink_mode_struct = struct.Struct('<B')
+kg_rsp_feedback_set_blink_mode_struct = struct.Struct('<H')
+kg_rsp_feedback_get_piezo_mode_struct = struct.Struct('<BBH')
+kg_rsp_feedback_set_piezo_mode_struct = struct.Struct('<H')
+kg_rsp_feedback_get_vibrate_mode_struct = struct.Struct('<BB')
+kg_rsp_feedback_set_vibrate_mode_struct = struct.Struct('<H')
+kg_rsp_feedback_get_rgb_mode_struct = struct.Struct('<BBB')
+kg_rsp_feedback_set_rgb_mode_struct = struct.Struct('<H')
+kg_rsp_feedback_set_custom_pattern_struct = struct.Struct('<H')
+kg_rsp_feedback_play_pattern_struct = struct.Struct('<H')
+kg_evt_feedback_blink_mode_struct = struct.Struct('<B')
+kg_evt_feedback_piezo_mode_struct = struct.Struct('<BBBH')
+kg_evt_feedback_vibrate_mode_struct = struct.Struct('<BBB')
+kg_evt_feedback_rgb_mode_struct = struct.Struct('<BBBB')
+kg_evt_feedback_pattern_struct = struct.Struct('<BBB')
+kg_rsp_touch_get_mode_struct = struct.Struct('<B')
+kg_rsp_touch_set_mode_struct = struct.Struct('<H')
+kg_evt_touch_mode_struct = struct.Struct('<B')
+kg_evt_touch_status_struct = struct.Struct('<B')
+kg_rsp_motion_get_mode_struct = struct.Struct('<B')
+kg_rsp_motion_set_mode_struct = struct.Struct('<H')
+kg_rsp_motion_calibrate_struct = struct.Struct('<H')
+kg_rsp_motion_get_config_struct = struct.Struct('<HHBBBBH')
+kg_rsp_motion_set_config_struct = struct.Struct('<H')
+kg_evt_motion_mode_struct = struct.Struct('<BB')
+kg_evt_motion_data_struct = struct.Struct('<BBB')
+kg_evt_motion_state_struct = struct.Struct('<BB')
+kg_evt_motion_calibration_struct = struct.Struct('<BBB')
+kg_evt_motion_gesture_struct = struct.Struct('<BBBB')
+kg_evt_motion_config_struct = struct.Struct('<BHBBBBH')
+kg_rsp_flex_get_value_struct = struct.Struct('<HBH')
+kg_rsp_flex_calibrate_struct = struct.Struct('<H')
+kg_rsp_flex_get_calibration_struct = struct.Struct('<HHH')
+kg_rsp_flex_set_calibration_struct = struct.Struct('<H')
+kg_evt_flex_value_struct = struct.Struct('<BB')
+kg_rsp_pressure_get_value_struct = struct.Struct('<HBBBH')
+kg_rsp_pressure_get_config_struct = struct.Struct('<BBB')
+kg_rsp_pressure_set_config_struct = struct.Struct('<H')
+kg_evt_pressure_press_struct = struct.Struct('<BBB')
+kg_evt_pressure_release_struct = struct.Struct('<B')
+kg_evt_pressure_value_struct = struct.Struct('<BB')
+kg_evt_pressure_config_struct = struct.Struct('<BBB')
+kg_rsp_touchset_set_macro_struct = struct.Struct('<H')
+kg_rsp_touchset_play_macro_struct = struct.Struct('<H')
+kg_rsp_touchset_stop_macro_struct = struct.Struct('<H')
+kg_evt_touchset_macro_status_struct = struct.Struct('<BB')
+kg_log_record_struct = struct.Struct('<BHHH')
+
+def kg_log_record_text(message_id, arg):
+    if message_id in log_messages:
+        text = log_messages[message_id][1]
+        return text.replace('%d', '%d' % arg) if '%d' in text else text
+    return 'Unknown log message 0x%04X (%d)' % (message_id, arg)
 
 class KGAPI(object):
 
@@ -459,6 +782,32 @@ class KGAPI(object):
         return struct.pack('<4B', 0xC0, 0x00, 0x01, 0x06)
     def kg_cmd_system_set_timer(self, handle, interval, oneshot):
         return struct.pack('<4BBHB', 0xC0, 0x04, 0x01, 0x07, handle, interval, oneshot)
+    def kg_cmd_system_get_time(self):
+        return struct.pack('<4B', 0xC0, 0x00, 0x01, 0x08)
+    def kg_cmd_system_get_timestamp_mode(self):
+        return struct.pack('<4B', 0xC0, 0x00, 0x01, 0x09)
+    def kg_cmd_system_set_timestamp_mode(self, mode):
+        return struct.pack('<4BB', 0xC0, 0x01, 0x01, 0x0A, mode)
+    def kg_cmd_system_get_event_mask(self, interface, event_class):
+        return struct.pack('<4BBB', 0xC0, 0x02, 0x01, 0x0B, interface, event_class)
+    def kg_cmd_system_set_event_mask(self, interface, event_class, mask):
+        return struct.pack('<4BBBH', 0xC0, 0x04, 0x01, 0x0C, interface, event_class, mask)
+    def kg_cmd_system_get_event_rate(self, interface, event_class):
+        return struct.pack('<4BBB', 0xC0, 0x02, 0x01, 0x0D, interface, event_class)
+    def kg_cmd_system_set_event_rate(self, interface, event_class, interval, ids):
+        return struct.pack('<4BBBBH', 0xC0, 0x05, 0x01, 0x0E, interface, event_class, interval, ids)
+    def kg_cmd_system_get_log_level(self):
+        return struct.pack('<4B', 0xC0, 0x00, 0x01, 0x0F)
+    def kg_cmd_system_set_log_level(self, level):
+        return struct.pack('<4BB', 0xC0, 0x01, 0x01, 0x10, level)
+    def kg_cmd_system_get_memory_stats(self):
+        return struct.pack('<4B', 0xC0, 0x00, 0x01, 0x11)
+    def kg_cmd_system_get_memory_allocations(self, subsystem):
+        return struct.pack('<4BB', 0xC0, 0x01, 0x01, 0x12, subsystem)
+    def kg_cmd_system_get_memory_threshold(self):
+        return struct.pack('<4B', 0xC0, 0x00, 0x01, 0x13)
+    def kg_cmd_system_set_memory_threshold(self, threshold):
+        return struct.pack('<4BH', 0xC0, 0x02, 0x01, 0x14, threshold)
     
     def kg_cmd_bluetooth_get_mode(self):
         return struct.pack('<4B', 0xC0, 0x00, 0x02, 0x01)
@@ -501,6 +850,10 @@ class KGAPI(object):
         return struct.pack('<4BB', 0xC0, 0x01, 0x03, 0x07, index)
     def kg_cmd_feedback_set_rgb_mode(self, index, mode_red, mode_green, mode_blue):
         return struct.pack('<4BBBBB', 0xC0, 0x04, 0x03, 0x08, index, mode_red, mode_green, mode_blue)
+    def kg_cmd_feedback_set_custom_pattern(self, index, segments):
+        return struct.pack('<4BBB' + str(len(segments)) + 's', 0xC0, 0x02 + len(segments), 0x03, 0x09, index, len(segments), b''.join(chr(i) for i in segments))
+    def kg_cmd_feedback_play_pattern(self, output, pattern, duration):
+        return struct.pack('<4BBBB', 0xC0, 0x03, 0x03, 0x0A, output, pattern, duration)
     
     def kg_cmd_touch_get_mode(self):
         return struct.pack('<4B', 0xC0, 0x00, 0x04, 0x01)
@@ -511,6 +864,35 @@ class KGAPI(object):
         return struct.pack('<4BB', 0xC0, 0x01, 0x05, 0x01, index)
     def kg_cmd_motion_set_mode(self, index, mode):
         return struct.pack('<4BBB', 0xC0, 0x02, 0x05, 0x02, index, mode)
+    def kg_cmd_motion_calibrate(self, index, flags):
+        return struct.pack('<4BBB', 0xC0, 0x02, 0x05, 0x03, index, flags)
+    def kg_cmd_motion_get_config(self, index):
+        return struct.pack('<4BB', 0xC0, 0x01, 0x05, 0x04, index)
+    def kg_cmd_motion_set_config(self, index, rate, accel_range, gyro_range, filter, encoding, stream_rate):
+        return struct.pack('<4BBHBBBBH', 0xC0, 0x09, 0x05, 0x05, index, rate, accel_range, gyro_range, filter, encoding, stream_rate)
+    
+    def kg_cmd_flex_get_value(self, index):
+        return struct.pack('<4BB', 0xC0, 0x01, 0x06, 0x01, index)
+    def kg_cmd_flex_calibrate(self, mode):
+        return struct.pack('<4BB', 0xC0, 0x01, 0x06, 0x02, mode)
+    def kg_cmd_flex_get_calibration(self, index):
+        return struct.pack('<4BB', 0xC0, 0x01, 0x06, 0x03, index)
+    def kg_cmd_flex_set_calibration(self, index, min, max):
+        return struct.pack('<4BBHH', 0xC0, 0x05, 0x06, 0x04, index, min, max)
+    
+    def kg_cmd_pressure_get_value(self, index):
+        return struct.pack('<4BB', 0xC0, 0x01, 0x07, 0x01, index)
+    def kg_cmd_pressure_get_config(self):
+        return struct.pack('<4B', 0xC0, 0x00, 0x07, 0x02)
+    def kg_cmd_pressure_set_config(self, press, release, deadband):
+        return struct.pack('<4BBBB', 0xC0, 0x03, 0x07, 0x03, press, release, deadband)
+    
+    def kg_cmd_touchset_set_macro(self, index, macro):
+        return struct.pack('<4BBB' + str(len(macro)) + 's', 0xC0, 0x02 + len(macro), 0x08, 0x01, index, len(macro), b''.join(chr(i) for i in macro))
+    def kg_cmd_touchset_play_macro(self, index):
+        return struct.pack('<4BB', 0xC0, 0x01, 0x08, 0x02, index)
+    def kg_cmd_touchset_stop_macro(self):
+        return struct.pack('<4B', 0xC0, 0x00, 0x08, 0x03)
     
     kg_rsp_system_ping = KeygloveEvent()
     kg_rsp_system_reset = KeygloveEvent()
@@ -519,6 +901,19 @@ class KGAPI(object):
     kg_rsp_system_get_memory = KeygloveEvent()
     kg_rsp_system_get_battery_status = KeygloveEvent()
     kg_rsp_system_set_timer = KeygloveEvent()
+    kg_rsp_system_get_time = KeygloveEvent()
+    kg_rsp_system_get_timestamp_mode = KeygloveEvent()
+    kg_rsp_system_set_timestamp_mode = KeygloveEvent()
+    kg_rsp_system_get_event_mask = KeygloveEvent()
+    kg_rsp_system_set_event_mask = KeygloveEvent()
+    kg_rsp_system_get_event_rate = KeygloveEvent()
+    kg_rsp_system_set_event_rate = KeygloveEvent()
+    kg_rsp_system_get_log_level = KeygloveEvent()
+    kg_rsp_system_set_log_level = KeygloveEvent()
+    kg_rsp_system_get_memory_stats = KeygloveEvent()
+    kg_rsp_system_get_memory_allocations = KeygloveEvent()
+    kg_rsp_system_get_memory_threshold = KeygloveEvent()
+    kg_rsp_system_set_memory_threshold = KeygloveEvent()
     
     kg_rsp_bluetooth_get_mode = KeygloveEvent()
     kg_rsp_bluetooth_set_mode = KeygloveEvent()
@@ -541,12 +936,30 @@ class KGAPI(object):
     kg_rsp_feedback_set_vibrate_mode = KeygloveEvent()
     kg_rsp_feedback_get_rgb_mode = KeygloveEvent()
     kg_rsp_feedback_set_rgb_mode = KeygloveEvent()
+    kg_rsp_feedback_set_custom_pattern = KeygloveEvent()
+    kg_rsp_feedback_play_pattern = KeygloveEvent()
     
     kg_rsp_touch_get_mode = KeygloveEvent()
     kg_rsp_touch_set_mode = KeygloveEvent()
     
     kg_rsp_motion_get_mode = KeygloveEvent()
     kg_rsp_motion_set_mode = KeygloveEvent()
+    kg_rsp_motion_calibrate = KeygloveEvent()
+    kg_rsp_motion_get_config = KeygloveEvent()
+    kg_rsp_motion_set_config = KeygloveEvent()
+    
+    kg_rsp_flex_get_value = KeygloveEvent()
+    kg_rsp_flex_calibrate = KeygloveEvent()
+    kg_rsp_flex_get_calibration = KeygloveEvent()
+    kg_rsp_flex_set_calibration = KeygloveEvent()
+    
+    kg_rsp_pressure_get_value = KeygloveEvent()
+    kg_rsp_pressure_get_config = KeygloveEvent()
+    kg_rsp_pressure_set_config = KeygloveEvent()
+    
+    kg_rsp_touchset_set_macro = KeygloveEvent()
+    kg_rsp_touchset_play_macro = KeygloveEvent()
+    kg_rsp_touchset_stop_macro = KeygloveEvent()
     
     kg_evt_protocol_error = KeygloveEvent()
     
@@ -556,6 +969,8 @@ class KGAPI(object):
     kg_evt_system_capability = KeygloveEvent()
     kg_evt_system_battery_status = KeygloveEvent()
     kg_evt_system_timer_tick = KeygloveEvent()
+    kg_evt_system_timestamp_mode = KeygloveEvent()
+    kg_evt_system_memory_low = KeygloveEvent()
     
     kg_evt_bluetooth_mode = KeygloveEvent()
     kg_evt_bluetooth_ready = KeygloveEvent()
@@ -571,6 +986,7 @@ class KGAPI(object):
     kg_evt_feedback_piezo_mode = KeygloveEvent()
     kg_evt_feedback_vibrate_mode = KeygloveEvent()
     kg_evt_feedback_rgb_mode = KeygloveEvent()
+    kg_evt_feedback_pattern = KeygloveEvent()
     
     kg_evt_touch_mode = KeygloveEvent()
     kg_evt_touch_status = KeygloveEvent()
@@ -578,6 +994,18 @@ class KGAPI(object):
     kg_evt_motion_mode = KeygloveEvent()
     kg_evt_motion_data = KeygloveEvent()
     kg_evt_motion_state = KeygloveEvent()
+    kg_evt_motion_calibration = KeygloveEvent()
+    kg_evt_motion_gesture = KeygloveEvent()
+    kg_evt_motion_config = KeygloveEvent()
+    
+    kg_evt_flex_value = KeygloveEvent()
+    
+    kg_evt_pressure_press = KeygloveEvent()
+    kg_evt_pressure_release = KeygloveEvent()
+    kg_evt_pressure_value = KeygloveEvent()
+    kg_evt_pressure_config = KeygloveEvent()
+    
+    kg_evt_touchset_macro_status = KeygloveEvent()
     
     kg_log = KeygloveEvent()
 
@@ -590,12 +1018,14 @@ class KGAPI(object):
     on_before_tx_command = KeygloveEvent()
     on_tx_command_complete = KeygloveEvent()
 
-    kgapi_rx_buffer = []
-    kgapi_rx_expected_length = 0
+    kgapi_rx_buffer = bytearray()
     debug = False
 
     last_response = None
     last_event = None
+    last_event_timestamp = None     # device seconds since boot from the last timestamped event
+    last_event_host_time = None     # same moment in host time.time() seconds (needs a synchronized clock)
+    clock = None                    # KeygloveClock, set up by KeygloveDevice.sync_clock()
 
     def get_last_response(self):
         return self.last_response
@@ -604,304 +1034,519 @@ class KGAPI(object):
         return self.last_event
 
     def parse(self, b):
-        if len(self.kgapi_rx_buffer) == 0 and (b == 0xC0 or b == 0x80):
-            self.kgapi_rx_buffer.append(b)
-        elif len(self.kgapi_rx_buffer) == 1:
-            self.kgapi_rx_buffer.append(b)
-            self.kgapi_rx_expected_length = 4 + (self.kgapi_rx_buffer[0] & 0x07) + self.kgapi_rx_buffer[1]
-        elif len(self.kgapi_rx_buffer) > 1:
-            self.kgapi_rx_buffer.append(b)
+        # process one received byte (parse_data() is much faster for whole chunks)
+        packets = self.parse_data(chr(b))
+        return packets[-1][0] if packets else 0
 
+    def parse_data(self, data):
         """
-        Keyglove packet structure (as of 2013-11-16):
-            Byte 0:     8 bits, Packet Type              0xC0 = command/response, 0x80 = event
+        Keyglove packet structure (as of 2014-12-20):
+            Byte 0:     2 bits, Packet Type              0xC0 = command/response, 0x80 = event
+                        3 bits, Tag                      Optional command tag (1-7), echoed in the response,
+                                                         or timestamp mode for events other than protocol/log
+                        3 bits, Length (high bits)       Always 0 (payload is never over 250 bytes)
             Byte 1:     8 bits, Length                   Payload length
             Byte 2:     8 bits, Class ID (CID)           Packet class
             Byte 3:     8 bits, Command ID (CMD)         Packet ID
             Bytes 4-n:  0 - 250 Bytes, Payload (PL)      Up to 250 bytes of payload
-        """
+                                                         (timestamped events end with a uint32 timestamp)
 
-        #print('%02X: %d, %d' % (b, len(self.kgapi_rx_buffer), self.kgapi_rx_expected_length))
-        if self.kgapi_rx_expected_length > 0 and len(self.kgapi_rx_buffer) == self.kgapi_rx_expected_length:
-            if self.debug:
-                print('<=[ ' + ' '.join(['%02X' % b for b in self.kgapi_rx_buffer ]) + ' ]')
-            packet_type, payload_length, packet_class, packet_command = self.kgapi_rx_buffer[:4]
-            self.kgapi_last_rx_packet = self.kgapi_rx_buffer
-            self.kgapi_rx_payload = b''.join(chr(i) for i in self.kgapi_rx_buffer[4:])
-            self.kgapi_rx_buffer = []
-            if packet_type & 0xC0 == 0xC0:
-                # 0xC0 = response packet after a command that has just been sent
-                # initialize last_response with unknown packet if we don't match
-                self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { }, 'raw': self.kgapi_last_rx_packet }
-                if packet_class == 1: # SYSTEM
-                    if packet_command == 1: # kg_rsp_system_ping
-                        uptime, = struct.unpack('<L', self.kgapi_rx_payload[:4])
-                        self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'uptime': uptime }, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_rsp_system_ping(self.last_response['payload'])
-                    elif packet_command == 2: # kg_rsp_system_reset
-                        result, = struct.unpack('<H', self.kgapi_rx_payload[:2])
-                        self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result }, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_rsp_system_reset(self.last_response['payload'])
-                    elif packet_command == 3: # kg_rsp_system_get_info
-                        major, minor, patch, protocol, timestamp, = struct.unpack('<HHHHL', self.kgapi_rx_payload[:12])
-                        self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'major': major, 'minor': minor, 'patch': patch, 'protocol': protocol, 'timestamp': timestamp }, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_rsp_system_get_info(self.last_response['payload'])
-                    elif packet_command == 4: # kg_rsp_system_get_capabilities
-                        count, = struct.unpack('<H', self.kgapi_rx_payload[:2])
-                        self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'count': count }, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_rsp_system_get_capabilities(self.last_response['payload'])
-                    elif packet_command == 5: # kg_rsp_system_get_memory
-                        free_ram, total_ram, = struct.unpack('<LL', self.kgapi_rx_payload[:8])
-                        self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'free_ram': free_ram, 'total_ram': total_ram }, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_rsp_system_get_memory(self.last_response['payload'])
-                    elif packet_command == 6: # kg_rsp_system_get_battery_status
-                        status, level, = struct.unpack('<BB', self.kgapi_rx_payload[:2])
-                        self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'status': status, 'level': level }, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_rsp_system_get_battery_status(self.last_response['payload'])
-                    elif packet_command == 7: # kg_rsp_system_set_timer
-                        result, = struct.unpack('<H', self.kgapi_rx_payload[:2])
-                        self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result }, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_rsp_system_set_timer(self.last_response['payload'])
-                elif packet_class == 2: # BLUETOOTH
-                    if packet_command == 1: # kg_rsp_bluetooth_get_mode
-                        result, mode, = struct.unpack('<HB', self.kgapi_rx_payload[:3])
-                        self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result, 'mode': mode }, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_rsp_bluetooth_get_mode(self.last_response['payload'])
-                    elif packet_command == 2: # kg_rsp_bluetooth_set_mode
-                        result, = struct.unpack('<H', self.kgapi_rx_payload[:2])
-                        self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result }, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_rsp_bluetooth_set_mode(self.last_response['payload'])
-                    elif packet_command == 3: # kg_rsp_bluetooth_reset
-                        result, = struct.unpack('<H', self.kgapi_rx_payload[:2])
-                        self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result }, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_rsp_bluetooth_reset(self.last_response['payload'])
-                    elif packet_command == 4: # kg_rsp_bluetooth_get_mac
-                        result, address, = struct.unpack('<H6s', self.kgapi_rx_payload[:8])
-                        address = [ord(b) for b in self.kgapi_rx_payload[2:8]]
-                        self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result, 'address': address }, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_rsp_bluetooth_get_mac(self.last_response['payload'])
-                    elif packet_command == 5: # kg_rsp_bluetooth_get_pairings
-                        result, count, = struct.unpack('<HB', self.kgapi_rx_payload[:3])
-                        self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result, 'count': count }, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_rsp_bluetooth_get_pairings(self.last_response['payload'])
-                    elif packet_command == 6: # kg_rsp_bluetooth_discover
-                        result, = struct.unpack('<H', self.kgapi_rx_payload[:2])
-                        self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result }, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_rsp_bluetooth_discover(self.last_response['payload'])
-                    elif packet_command == 7: # kg_rsp_bluetooth_pair
-                        result, = struct.unpack('<H', self.kgapi_rx_payload[:2])
-                        self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result }, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_rsp_bluetooth_pair(self.last_response['payload'])
-                    elif packet_command == 8: # kg_rsp_bluetooth_delete_pairing
-                        result, = struct.unpack('<H', self.kgapi_rx_payload[:2])
-                        self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result }, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_rsp_bluetooth_delete_pairing(self.last_response['payload'])
-                    elif packet_command == 9: # kg_rsp_bluetooth_clear_pairings
-                        result, = struct.unpack('<H', self.kgapi_rx_payload[:2])
-                        self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result }, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_rsp_bluetooth_clear_pairings(self.last_response['payload'])
-                    elif packet_command == 10: # kg_rsp_bluetooth_get_connections
-                        result, count, = struct.unpack('<HB', self.kgapi_rx_payload[:3])
-                        self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result, 'count': count }, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_rsp_bluetooth_get_connections(self.last_response['payload'])
-                    elif packet_command == 11: # kg_rsp_bluetooth_connect
-                        result, = struct.unpack('<H', self.kgapi_rx_payload[:2])
-                        self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result }, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_rsp_bluetooth_connect(self.last_response['payload'])
-                    elif packet_command == 12: # kg_rsp_bluetooth_disconnect
-                        result, = struct.unpack('<H', self.kgapi_rx_payload[:2])
-                        self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result }, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_rsp_bluetooth_disconnect(self.last_response['payload'])
-                elif packet_class == 3: # FEEDBACK
-                    if packet_command == 1: # kg_rsp_feedback_get_blink_mode
-                        mode, = struct.unpack('<B', self.kgapi_rx_payload[:1])
-                        self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'mode': mode }, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_rsp_feedback_get_blink_mode(self.last_response['payload'])
-                    elif packet_command == 2: # kg_rsp_feedback_set_blink_mode
-                        result, = struct.unpack('<H', self.kgapi_rx_payload[:2])
-                        self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result }, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_rsp_feedback_set_blink_mode(self.last_response['payload'])
-                    elif packet_command == 3: # kg_rsp_feedback_get_piezo_mode
-                        mode, duration, frequency, = struct.unpack('<BBH', self.kgapi_rx_payload[:4])
-                        self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'mode': mode, 'duration': duration, 'frequency': frequency }, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_rsp_feedback_get_piezo_mode(self.last_response['payload'])
-                    elif packet_command == 4: # kg_rsp_feedback_set_piezo_mode
-                        result, = struct.unpack('<H', self.kgapi_rx_payload[:2])
-                        self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result }, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_rsp_feedback_set_piezo_mode(self.last_response['payload'])
-                    elif packet_command == 5: # kg_rsp_feedback_get_vibrate_mode
-                        mode, duration, = struct.unpack('<BB', self.kgapi_rx_payload[:2])
-                        self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'mode': mode, 'duration': duration }, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_rsp_feedback_get_vibrate_mode(self.last_response['payload'])
-                    elif packet_command == 6: # kg_rsp_feedback_set_vibrate_mode
-                        result, = struct.unpack('<H', self.kgapi_rx_payload[:2])
-                        self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result }, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_rsp_feedback_set_vibrate_mode(self.last_response['payload'])
-                    elif packet_command == 7: # kg_rsp_feedback_get_rgb_mode
-                        mode_red, mode_green, mode_blue, = struct.unpack('<BBB', self.kgapi_rx_payload[:3])
-                        self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'mode_red': mode_red, 'mode_green': mode_green, 'mode_blue': mode_blue }, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_rsp_feedback_get_rgb_mode(self.last_response['payload'])
-                    elif packet_command == 8: # kg_rsp_feedback_set_rgb_mode
-                        result, = struct.unpack('<H', self.kgapi_rx_payload[:2])
-                        self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result }, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_rsp_feedback_set_rgb_mode(self.last_response['payload'])
-                elif packet_class == 4: # TOUCH
-                    if packet_command == 1: # kg_rsp_touch_get_mode
-                        mode, = struct.unpack('<B', self.kgapi_rx_payload[:1])
-                        self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'mode': mode }, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_rsp_touch_get_mode(self.last_response['payload'])
-                    elif packet_command == 2: # kg_rsp_touch_set_mode
-                        result, = struct.unpack('<H', self.kgapi_rx_payload[:2])
-                        self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result }, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_rsp_touch_set_mode(self.last_response['payload'])
-                elif packet_class == 5: # MOTION
-                    if packet_command == 1: # kg_rsp_motion_get_mode
-                        mode, = struct.unpack('<B', self.kgapi_rx_payload[:1])
-                        self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'mode': mode }, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_rsp_motion_get_mode(self.last_response['payload'])
-                    elif packet_command == 2: # kg_rsp_motion_set_mode
-                        result, = struct.unpack('<H', self.kgapi_rx_payload[:2])
-                        self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result }, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_rsp_motion_set_mode(self.last_response['payload'])
-                self.kg_response(self.last_response)
-            elif packet_type & 0xC0 == 0x80:
-                # 0x80 = event packet
-                # initialize last_event with unknown packet if we don't match
-                self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { }, 'raw': self.kgapi_last_rx_packet }
-                if packet_class == 0: # PROTOCOL
-                    if packet_command == 1: # kg_evt_protocol_error
-                        code, = struct.unpack('<H', self.kgapi_rx_payload[:2])
-                        self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'code': code }, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_evt_protocol_error(self.last_event['payload'])
-                elif packet_class == 1: # SYSTEM
-                    if packet_command == 1: # kg_evt_system_boot
-                        major, minor, patch, protocol, timestamp, = struct.unpack('<HHHHL', self.kgapi_rx_payload[:12])
-                        self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'major': major, 'minor': minor, 'patch': patch, 'protocol': protocol, 'timestamp': timestamp }, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_evt_system_boot(self.last_event['payload'])
-                    elif packet_command == 2: # kg_evt_system_ready
-                        self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': {  }, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_evt_system_ready(self.last_event['payload'])
-                    elif packet_command == 3: # kg_evt_system_error
-                        code, = struct.unpack('<H', self.kgapi_rx_payload[:2])
-                        self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'code': code }, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_evt_system_error(self.last_event['payload'])
-                    elif packet_command == 4: # kg_evt_system_capability
-                        category, record_len, = struct.unpack('<BB', self.kgapi_rx_payload[:2])
-                        record_data = [ord(b) for b in self.kgapi_rx_payload[2:]]
-                        self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'category': category, 'record': record_data }, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_evt_system_capability(self.last_event['payload'])
-                    elif packet_command == 5: # kg_evt_system_battery_status
-                        status, level, = struct.unpack('<BB', self.kgapi_rx_payload[:2])
-                        self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'status': status, 'level': level }, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_evt_system_battery_status(self.last_event['payload'])
-                    elif packet_command == 6: # kg_evt_system_timer_tick
-                        handle, seconds, subticks, = struct.unpack('<BLB', self.kgapi_rx_payload[:6])
-                        self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'handle': handle, 'seconds': seconds, 'subticks': subticks }, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_evt_system_timer_tick(self.last_event['payload'])
-                elif packet_class == 2: # BLUETOOTH
-                    if packet_command == 1: # kg_evt_bluetooth_mode
-                        mode, = struct.unpack('<B', self.kgapi_rx_payload[:1])
-                        self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'mode': mode }, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_evt_bluetooth_mode(self.last_event['payload'])
-                    elif packet_command == 2: # kg_evt_bluetooth_ready
-                        self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': {  }, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_evt_bluetooth_ready(self.last_event['payload'])
-                    elif packet_command == 3: # kg_evt_bluetooth_inquiry_response
-                        address, cod, rssi, status, pairing, name_len, = struct.unpack('<6s3sbBBB', self.kgapi_rx_payload[:13])
-                        address = [ord(b) for b in self.kgapi_rx_payload[0:6]]
-                        cod = [ord(b) for b in self.kgapi_rx_payload[6:9]]
-                        name_data = [ord(b) for b in self.kgapi_rx_payload[13:]]
-                        self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'address': address, 'cod': cod, 'rssi': rssi, 'status': status, 'pairing': pairing, 'name': name_data }, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_evt_bluetooth_inquiry_response(self.last_event['payload'])
-                    elif packet_command == 4: # kg_evt_bluetooth_inquiry_complete
-                        count, = struct.unpack('<B', self.kgapi_rx_payload[:1])
-                        self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'count': count }, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_evt_bluetooth_inquiry_complete(self.last_event['payload'])
-                    elif packet_command == 5: # kg_evt_bluetooth_pairing_status
-                        pairing, address, priority, profiles_supported, profiles_active, handle_list_len, = struct.unpack('<B6sBBBB', self.kgapi_rx_payload[:11])
-                        address = [ord(b) for b in self.kgapi_rx_payload[1:7]]
-                        handle_list_data = [ord(b) for b in self.kgapi_rx_payload[11:]]
-                        self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'pairing': pairing, 'address': address, 'priority': priority, 'profiles_supported': profiles_supported, 'profiles_active': profiles_active, 'handle_list': handle_list_data }, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_evt_bluetooth_pairing_status(self.last_event['payload'])
-                    elif packet_command == 6: # kg_evt_bluetooth_pairing_failed
-                        address, = struct.unpack('<6s', self.kgapi_rx_payload[:6])
-                        address = [ord(b) for b in self.kgapi_rx_payload[0:6]]
-                        self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'address': address }, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_evt_bluetooth_pairing_failed(self.last_event['payload'])
-                    elif packet_command == 7: # kg_evt_bluetooth_pairings_cleared
-                        self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': {  }, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_evt_bluetooth_pairings_cleared(self.last_event['payload'])
-                    elif packet_command == 8: # kg_evt_bluetooth_connection_status
-                        handle, address, pairing, profile, status, = struct.unpack('<B6sBBB', self.kgapi_rx_payload[:10])
-                        address = [ord(b) for b in self.kgapi_rx_payload[1:7]]
-                        self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'handle': handle, 'address': address, 'pairing': pairing, 'profile': profile, 'status': status }, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_evt_bluetooth_connection_status(self.last_event['payload'])
-                    elif packet_command == 9: # kg_evt_bluetooth_connection_closed
-                        handle, reason, = struct.unpack('<BH', self.kgapi_rx_payload[:3])
-                        self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'handle': handle, 'reason': reason }, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_evt_bluetooth_connection_closed(self.last_event['payload'])
-                elif packet_class == 3: # FEEDBACK
-                    if packet_command == 1: # kg_evt_feedback_blink_mode
-                        mode, = struct.unpack('<B', self.kgapi_rx_payload[:1])
-                        self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'mode': mode }, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_evt_feedback_blink_mode(self.last_event['payload'])
-                    elif packet_command == 2: # kg_evt_feedback_piezo_mode
-                        index, mode, duration, frequency, = struct.unpack('<BBBH', self.kgapi_rx_payload[:5])
-                        self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'index': index, 'mode': mode, 'duration': duration, 'frequency': frequency }, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_evt_feedback_piezo_mode(self.last_event['payload'])
-                    elif packet_command == 3: # kg_evt_feedback_vibrate_mode
-                        index, mode, duration, = struct.unpack('<BBB', self.kgapi_rx_payload[:3])
-                        self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'index': index, 'mode': mode, 'duration': duration }, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_evt_feedback_vibrate_mode(self.last_event['payload'])
-                    elif packet_command == 4: # kg_evt_feedback_rgb_mode
-                        index, mode_red, mode_green, mode_blue, = struct.unpack('<BBBB', self.kgapi_rx_payload[:4])
-                        self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'index': index, 'mode_red': mode_red, 'mode_green': mode_green, 'mode_blue': mode_blue }, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_evt_feedback_rgb_mode(self.last_event['payload'])
-                elif packet_class == 4: # TOUCH
-                    if packet_command == 1: # kg_evt_touch_mode
-                        mode, = struct.unpack('<B', self.kgapi_rx_payload[:1])
-                        self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'mode': mode }, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_evt_touch_mode(self.last_event['payload'])
-                    elif packet_command == 2: # kg_evt_touch_status
-                        status_len, = struct.unpack('<B', self.kgapi_rx_payload[:1])
-                        status_data = [ord(b) for b in self.kgapi_rx_payload[1:]]
-                        self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'status': status_data }, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_evt_touch_status(self.last_event['payload'])
-                elif packet_class == 5: # MOTION
-                    if packet_command == 1: # kg_evt_motion_mode
-                        index, mode, = struct.unpack('<BB', self.kgapi_rx_payload[:2])
-                        self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'index': index, 'mode': mode }, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_evt_motion_mode(self.last_event['payload'])
-                    elif packet_command == 2: # kg_evt_motion_data
-                        index, flags, data_len, = struct.unpack('<BBB', self.kgapi_rx_payload[:3])
-                        data_data = [ord(b) for b in self.kgapi_rx_payload[3:]]
-                        self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'index': index, 'flags': flags, 'data': data_data }, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_evt_motion_data(self.last_event['payload'])
-                    elif packet_command == 3: # kg_evt_motion_state
-                        index, state, = struct.unpack('<BB', self.kgapi_rx_payload[:2])
-                        self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'index': index, 'state': state }, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_evt_motion_state(self.last_event['payload'])
-                elif packet_class == 0xFF: # LOG
-                    if packet_command == 0xFF: # kg_log
-                        level, = struct.unpack('<B', self.kgapi_rx_payload[:1])
-                        message = self.kgapi_rx_payload[1:]
-                        payload = { 'level': level, 'message': message }
-                        self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': payload, 'raw': self.kgapi_last_rx_packet }
-                        self.kg_log(payload)
-                self.kg_event(self.last_event)
-
-            return packet_type & 0xC0
+        Splits a chunk of received data (any size) into packets and processes
+        each complete one. Whatever is left over waits for the next chunk.
+        Returns a list of (packet type, last_response or last_event) tuples,
+        one for each packet completed by this chunk.
+        """
 
+        buf = self.kgapi_rx_buffer + bytearray(data)
+        end = len(buf)
+        start = 0
+        packets = []
+        while start < end:
+            if buf[start] & 0xC7 != 0xC0 and buf[start] & 0xC7 != 0x80:
+                # out of step, so skip straight to the next byte that can start a packet
+                match = kgapi_packet_start.search(buf, start + 1)
+                start = match.start() if match else end
+                continue
+            if end - start < 2:
+                break
+            length = 4 + ((buf[start] & 0x07) << 8) + buf[start + 1]
+            if end - start < length:
+                break
+            packets.append(self.process_packet(buf[start:start + length]))
+            start += length
+        self.kgapi_rx_buffer = buf[start:]
+        return packets
+
+    def process_packet(self, packet):
+        if self.debug:
+            print('<=[ ' + ' '.join(['%02X' % b for b in packet ]) + ' ]')
+        packet_type, payload_length, packet_class, packet_command = packet[:4]
+        self.kgapi_last_rx_packet = packet
+        self.kgapi_rx_payload = bytes(packet[4:])
+        if packet_type & 0xC0 == 0xC0:
+            # 0xC0 = response packet after a command that has just been sent
+            # initialize last_response with unknown packet if we don't match
+            self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { }, 'raw': self.kgapi_last_rx_packet }
+            if packet_class == 1: # SYSTEM
+                if packet_command == 1: # kg_rsp_system_ping
+                    uptime, = kg_rsp_system_ping_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'uptime': uptime }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_system_ping(self.last_response['payload'])
+                elif packet_command == 2: # kg_rsp_system_reset
+                    result, = kg_rsp_system_reset_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_system_reset(self.last_response['payload'])
+                elif packet_command == 3: # kg_rsp_system_get_info
+                    major, minor, patch, protocol, timestamp, = kg_rsp_system_get_info_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'major': major, 'minor': minor, 'patch': patch, 'protocol': protocol, 'timestamp': timestamp }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_system_get_info(self.last_response['payload'])
+                elif packet_command == 4: # kg_rsp_system_get_capabilities
+                    count, = kg_rsp_system_get_capabilities_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'count': count }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_system_get_capabilities(self.last_response['payload'])
+                elif packet_command == 5: # kg_rsp_system_get_memory
+                    free_ram, total_ram, = kg_rsp_system_get_memory_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'free_ram': free_ram, 'total_ram': total_ram }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_system_get_memory(self.last_response['payload'])
+                elif packet_command == 6: # kg_rsp_system_get_battery_status
+                    status, level, = kg_rsp_system_get_battery_status_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'status': status, 'level': level }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_system_get_battery_status(self.last_response['payload'])
+                elif packet_command == 7: # kg_rsp_system_set_timer
+                    result, = kg_rsp_system_set_timer_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_system_set_timer(self.last_response['payload'])
+                elif packet_command == 8: # kg_rsp_system_get_time
+                    seconds, subticks, microseconds, = kg_rsp_system_get_time_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'seconds': seconds, 'subticks': subticks, 'microseconds': microseconds }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_system_get_time(self.last_response['payload'])
+                elif packet_command == 9: # kg_rsp_system_get_timestamp_mode
+                    mode, = kg_rsp_system_get_timestamp_mode_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'mode': mode }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_system_get_timestamp_mode(self.last_response['payload'])
+                elif packet_command == 10: # kg_rsp_system_set_timestamp_mode
+                    result, = kg_rsp_system_set_timestamp_mode_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_system_set_timestamp_mode(self.last_response['payload'])
+                elif packet_command == 11: # kg_rsp_system_get_event_mask
+                    result, mask, = kg_rsp_system_get_event_mask_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result, 'mask': mask }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_system_get_event_mask(self.last_response['payload'])
+                elif packet_command == 12: # kg_rsp_system_set_event_mask
+                    result, = kg_rsp_system_set_event_mask_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_system_set_event_mask(self.last_response['payload'])
+                elif packet_command == 13: # kg_rsp_system_get_event_rate
+                    result, interval, ids, = kg_rsp_system_get_event_rate_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result, 'interval': interval, 'ids': ids }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_system_get_event_rate(self.last_response['payload'])
+                elif packet_command == 14: # kg_rsp_system_set_event_rate
+                    result, = kg_rsp_system_set_event_rate_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_system_set_event_rate(self.last_response['payload'])
+                elif packet_command == 15: # kg_rsp_system_get_log_level
+                    level, = kg_rsp_system_get_log_level_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'level': level }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_system_get_log_level(self.last_response['payload'])
+                elif packet_command == 16: # kg_rsp_system_set_log_level
+                    result, = kg_rsp_system_set_log_level_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_system_set_log_level(self.last_response['payload'])
+                elif packet_command == 17: # kg_rsp_system_get_memory_stats
+                    free_ram, stack_headroom, heap_size, heap_free, largest_free, free_blocks, = kg_rsp_system_get_memory_stats_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'free_ram': free_ram, 'stack_headroom': stack_headroom, 'heap_size': heap_size, 'heap_free': heap_free, 'largest_free': largest_free, 'free_blocks': free_blocks }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_system_get_memory_stats(self.last_response['payload'])
+                elif packet_command == 18: # kg_rsp_system_get_memory_allocations
+                    result, allocations, blocks, failures, = kg_rsp_system_get_memory_allocations_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result, 'allocations': allocations, 'blocks': blocks, 'failures': failures }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_system_get_memory_allocations(self.last_response['payload'])
+                elif packet_command == 19: # kg_rsp_system_get_memory_threshold
+                    threshold, = kg_rsp_system_get_memory_threshold_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'threshold': threshold }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_system_get_memory_threshold(self.last_response['payload'])
+                elif packet_command == 20: # kg_rsp_system_set_memory_threshold
+                    result, = kg_rsp_system_set_memory_threshold_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_system_set_memory_threshold(self.last_response['payload'])
+            elif packet_class == 2: # BLUETOOTH
+                if packet_command == 1: # kg_rsp_bluetooth_get_mode
+                    result, mode, = kg_rsp_bluetooth_get_mode_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result, 'mode': mode }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_bluetooth_get_mode(self.last_response['payload'])
+                elif packet_command == 2: # kg_rsp_bluetooth_set_mode
+                    result, = kg_rsp_bluetooth_set_mode_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_bluetooth_set_mode(self.last_response['payload'])
+                elif packet_command == 3: # kg_rsp_bluetooth_reset
+                    result, = kg_rsp_bluetooth_reset_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_bluetooth_reset(self.last_response['payload'])
+                elif packet_command == 4: # kg_rsp_bluetooth_get_mac
+                    result, address, = kg_rsp_bluetooth_get_mac_struct.unpack_from(self.kgapi_rx_payload)
+                    address = [ord(b) for b in self.kgapi_rx_payload[2:8]]
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result, 'address': address }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_bluetooth_get_mac(self.last_response['payload'])
+                elif packet_command == 5: # kg_rsp_bluetooth_get_pairings
+                    result, count, = kg_rsp_bluetooth_get_pairings_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result, 'count': count }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_bluetooth_get_pairings(self.last_response['payload'])
+                elif packet_command == 6: # kg_rsp_bluetooth_discover
+                    result, = kg_rsp_bluetooth_discover_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_bluetooth_discover(self.last_response['payload'])
+                elif packet_command == 7: # kg_rsp_bluetooth_pair
+                    result, = kg_rsp_bluetooth_pair_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_bluetooth_pair(self.last_response['payload'])
+                elif packet_command == 8: # kg_rsp_bluetooth_delete_pairing
+                    result, = kg_rsp_bluetooth_delete_pairing_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_bluetooth_delete_pairing(self.last_response['payload'])
+                elif packet_command == 9: # kg_rsp_bluetooth_clear_pairings
+                    result, = kg_rsp_bluetooth_clear_pairings_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_bluetooth_clear_pairings(self.last_response['payload'])
+                elif packet_command == 10: # kg_rsp_bluetooth_get_connections
+                    result, count, = kg_rsp_bluetooth_get_connections_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result, 'count': count }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_bluetooth_get_connections(self.last_response['payload'])
+                elif packet_command == 11: # kg_rsp_bluetooth_connect
+                    result, = kg_rsp_bluetooth_connect_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_bluetooth_connect(self.last_response['payload'])
+                elif packet_command == 12: # kg_rsp_bluetooth_disconnect
+                    result, = kg_rsp_bluetooth_disconnect_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_bluetooth_disconnect(self.last_response['payload'])
+            elif packet_class == 3: # FEEDBACK
+                if packet_command == 1: # kg_rsp_feedback_get_blink_mode
+                    mode, = kg_rsp_feedback_get_blink_mode_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'mode': mode }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_feedback_get_blink_mode(self.last_response['payload'])
+                elif packet_command == 2: # kg_rsp_feedback_set_blink_mode
+                    result, = kg_rsp_feedback_set_blink_mode_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_feedback_set_blink_mode(self.last_response['payload'])
+                elif packet_command == 3: # kg_rsp_feedback_get_piezo_mode
+                    mode, duration, frequency, = kg_rsp_feedback_get_piezo_mode_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'mode': mode, 'duration': duration, 'frequency': frequency }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_feedback_get_piezo_mode(self.last_response['payload'])
+                elif packet_command == 4: # kg_rsp_feedback_set_piezo_mode
+                    result, = kg_rsp_feedback_set_piezo_mode_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_feedback_set_piezo_mode(self.last_response['payload'])
+                elif packet_command == 5: # kg_rsp_feedback_get_vibrate_mode
+                    mode, duration, = kg_rsp_feedback_get_vibrate_mode_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'mode': mode, 'duration': duration }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_feedback_get_vibrate_mode(self.last_response['payload'])
+                elif packet_command == 6: # kg_rsp_feedback_set_vibrate_mode
+                    result, = kg_rsp_feedback_set_vibrate_mode_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_feedback_set_vibrate_mode(self.last_response['payload'])
+                elif packet_command == 7: # kg_rsp_feedback_get_rgb_mode
+                    mode_red, mode_green, mode_blue, = kg_rsp_feedback_get_rgb_mode_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'mode_red': mode_red, 'mode_green': mode_green, 'mode_blue': mode_blue }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_feedback_get_rgb_mode(self.last_response['payload'])
+                elif packet_command == 8: # kg_rsp_feedback_set_rgb_mode
+                    result, = kg_rsp_feedback_set_rgb_mode_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_feedback_set_rgb_mode(self.last_response['payload'])
+                elif packet_command == 9: # kg_rsp_feedback_set_custom_pattern
+                    result, = kg_rsp_feedback_set_custom_pattern_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_feedback_set_custom_pattern(self.last_response['payload'])
+                elif packet_command == 10: # kg_rsp_feedback_play_pattern
+                    result, = kg_rsp_feedback_play_pattern_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_feedback_play_pattern(self.last_response['payload'])
+            elif packet_class == 4: # TOUCH
+                if packet_command == 1: # kg_rsp_touch_get_mode
+                    mode, = kg_rsp_touch_get_mode_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'mode': mode }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_touch_get_mode(self.last_response['payload'])
+                elif packet_command == 2: # kg_rsp_touch_set_mode
+                    result, = kg_rsp_touch_set_mode_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_touch_set_mode(self.last_response['payload'])
+            elif packet_class == 5: # MOTION
+                if packet_command == 1: # kg_rsp_motion_get_mode
+                    mode, = kg_rsp_motion_get_mode_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'mode': mode }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_motion_get_mode(self.last_response['payload'])
+                elif packet_command == 2: # kg_rsp_motion_set_mode
+                    result, = kg_rsp_motion_set_mode_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_motion_set_mode(self.last_response['payload'])
+                elif packet_command == 3: # kg_rsp_motion_calibrate
+                    result, = kg_rsp_motion_calibrate_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_motion_calibrate(self.last_response['payload'])
+                elif packet_command == 4: # kg_rsp_motion_get_config
+                    result, rate, accel_range, gyro_range, filter, encoding, stream_rate, = kg_rsp_motion_get_config_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result, 'rate': rate, 'accel_range': accel_range, 'gyro_range': gyro_range, 'filter': filter, 'encoding': encoding, 'stream_rate': stream_rate }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_motion_get_config(self.last_response['payload'])
+                elif packet_command == 5: # kg_rsp_motion_set_config
+                    result, = kg_rsp_motion_set_config_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_motion_set_config(self.last_response['payload'])
+            elif packet_class == 6: # FLEX
+                if packet_command == 1: # kg_rsp_flex_get_value
+                    result, value, raw, = kg_rsp_flex_get_value_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result, 'value': value, 'raw': raw }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_flex_get_value(self.last_response['payload'])
+                elif packet_command == 2: # kg_rsp_flex_calibrate
+                    result, = kg_rsp_flex_calibrate_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_flex_calibrate(self.last_response['payload'])
+                elif packet_command == 3: # kg_rsp_flex_get_calibration
+                    result, min, max, = kg_rsp_flex_get_calibration_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result, 'min': min, 'max': max }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_flex_get_calibration(self.last_response['payload'])
+                elif packet_command == 4: # kg_rsp_flex_set_calibration
+                    result, = kg_rsp_flex_set_calibration_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_flex_set_calibration(self.last_response['payload'])
+            elif packet_class == 7: # PRESSURE
+                if packet_command == 1: # kg_rsp_pressure_get_value
+                    result, state, value, velocity, raw, = kg_rsp_pressure_get_value_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result, 'state': state, 'value': value, 'velocity': velocity, 'raw': raw }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_pressure_get_value(self.last_response['payload'])
+                elif packet_command == 2: # kg_rsp_pressure_get_config
+                    press, release, deadband, = kg_rsp_pressure_get_config_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'press': press, 'release': release, 'deadband': deadband }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_pressure_get_config(self.last_response['payload'])
+                elif packet_command == 3: # kg_rsp_pressure_set_config
+                    result, = kg_rsp_pressure_set_config_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_pressure_set_config(self.last_response['payload'])
+            elif packet_class == 8: # TOUCHSET
+                if packet_command == 1: # kg_rsp_touchset_set_macro
+                    result, = kg_rsp_touchset_set_macro_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_touchset_set_macro(self.last_response['payload'])
+                elif packet_command == 2: # kg_rsp_touchset_play_macro
+                    result, = kg_rsp_touchset_play_macro_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_touchset_play_macro(self.last_response['payload'])
+                elif packet_command == 3: # kg_rsp_touchset_stop_macro
+                    result, = kg_rsp_touchset_stop_macro_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_response = { 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': result }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_rsp_touchset_stop_macro(self.last_response['payload'])
+            self.last_response['tag'] = (packet_type >> 3) & 0x07
+            self.kg_response(self.last_response)
+            return (0xC0, self.last_response)
         else:
-            return 0
+            # 0x80 = event packet
+            # events other than protocol errors and logs use the tag bits for the timestamp mode
+            timestamp_mode = (packet_type >> 3) & 0x07 if packet_class not in (0x00, 0xFF) else 0
+            self.last_event_timestamp = None
+            self.last_event_host_time = None
+            if timestamp_mode and payload_length >= 4:
+                timestamp, = struct.unpack('<I', self.kgapi_rx_payload[-4:])
+                self.kgapi_rx_payload = self.kgapi_rx_payload[:-4]
+                payload_length -= 4
+                if timestamp_mode == 1: # ticks
+                    self.last_event_timestamp = timestamp / 100.0
+                elif self.clock != None: # microseconds
+                    self.last_event_timestamp = self.clock.unwrap_micros(timestamp) / 1000000.0
+                else:
+                    self.last_event_timestamp = timestamp / 1000000.0
+                if self.clock != None:
+                    self.last_event_host_time = self.clock.to_host(self.last_event_timestamp)
+            # initialize last_event with unknown packet if we don't match
+            self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { }, 'raw': self.kgapi_last_rx_packet }
+            if packet_class == 0: # PROTOCOL
+                if packet_command == 1: # kg_evt_protocol_error
+                    code, = kg_evt_protocol_error_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'code': code }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_evt_protocol_error(self.last_event['payload'])
+            elif packet_class == 1: # SYSTEM
+                if packet_command == 1: # kg_evt_system_boot
+                    major, minor, patch, protocol, timestamp, = kg_evt_system_boot_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'major': major, 'minor': minor, 'patch': patch, 'protocol': protocol, 'timestamp': timestamp }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_evt_system_boot(self.last_event['payload'])
+                elif packet_command == 2: # kg_evt_system_ready
+                    self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': {  }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_evt_system_ready(self.last_event['payload'])
+                elif packet_command == 3: # kg_evt_system_error
+                    code, = kg_evt_system_error_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'code': code }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_evt_system_error(self.last_event['payload'])
+                elif packet_command == 4: # kg_evt_system_capability
+                    category, record_len, = kg_evt_system_capability_struct.unpack_from(self.kgapi_rx_payload)
+                    record_data = [ord(b) for b in self.kgapi_rx_payload[2:]]
+                    self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'category': category, 'record': record_data }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_evt_system_capability(self.last_event['payload'])
+                elif packet_command == 5: # kg_evt_system_battery_status
+                    status, level, = kg_evt_system_battery_status_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'status': status, 'level': level }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_evt_system_battery_status(self.last_event['payload'])
+                elif packet_command == 6: # kg_evt_system_timer_tick
+                    handle, seconds, subticks, = kg_evt_system_timer_tick_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'handle': handle, 'seconds': seconds, 'subticks': subticks }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_evt_system_timer_tick(self.last_event['payload'])
+                elif packet_command == 7: # kg_evt_system_timestamp_mode
+                    mode, = kg_evt_system_timestamp_mode_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'mode': mode }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_evt_system_timestamp_mode(self.last_event['payload'])
+                elif packet_command == 8: # kg_evt_system_memory_low
+                    headroom, threshold, = kg_evt_system_memory_low_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'headroom': headroom, 'threshold': threshold }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_evt_system_memory_low(self.last_event['payload'])
+            elif packet_class == 2: # BLUETOOTH
+                if packet_command == 1: # kg_evt_bluetooth_mode
+                    mode, = kg_evt_bluetooth_mode_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'mode': mode }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_evt_bluetooth_mode(self.last_event['payload'])
+                elif packet_command == 2: # kg_evt_bluetooth_ready
+                    self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': {  }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_evt_bluetooth_ready(self.last_event['payload'])
+                elif packet_command == 3: # kg_evt_bluetooth_inquiry_response
+                    address, cod, rssi, status, pairing, name_len, = kg_evt_bluetooth_inquiry_response_struct.unpack_from(self.kgapi_rx_payload)
+                    address = [ord(b) for b in self.kgapi_rx_payload[0:6]]
+                    cod = [ord(b) for b in self.kgapi_rx_payload[6:9]]
+                    name_data = [ord(b) for b in self.kgapi_rx_payload[13:]]
+                    self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'address': address, 'cod': cod, 'rssi': rssi, 'status': status, 'pairing': pairing, 'name': name_data }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_evt_bluetooth_inquiry_response(self.last_event['payload'])
+                elif packet_command == 4: # kg_evt_bluetooth_inquiry_complete
+                    count, = kg_evt_bluetooth_inquiry_complete_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'count': count }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_evt_bluetooth_inquiry_complete(self.last_event['payload'])
+                elif packet_command == 5: # kg_evt_bluetooth_pairing_status
+                    pairing, address, priority, profiles_supported, profiles_active, handle_list_len, = kg_evt_bluetooth_pairing_status_struct.unpack_from(self.kgapi_rx_payload)
+                    address = [ord(b) for b in self.kgapi_rx_payload[1:7]]
+                    handle_list_data = [ord(b) for b in self.kgapi_rx_payload[11:]]
+                    self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'pairing': pairing, 'address': address, 'priority': priority, 'profiles_supported': profiles_supported, 'profiles_active': profiles_active, 'handle_list': handle_list_data }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_evt_bluetooth_pairing_status(self.last_event['payload'])
+                elif packet_command == 6: # kg_evt_bluetooth_pairing_failed
+                    address, = kg_evt_bluetooth_pairing_failed_struct.unpack_from(self.kgapi_rx_payload)
+                    address = [ord(b) for b in self.kgapi_rx_payload[0:6]]
+                    self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'address': address }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_evt_bluetooth_pairing_failed(self.last_event['payload'])
+                elif packet_command == 7: # kg_evt_bluetooth_pairings_cleared
+                    self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': {  }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_evt_bluetooth_pairings_cleared(self.last_event['payload'])
+                elif packet_command == 8: # kg_evt_bluetooth_connection_status
+                    handle, address, pairing, profile, status, = kg_evt_bluetooth_connection_status_struct.unpack_from(self.kgapi_rx_payload)
+                    address = [ord(b) for b in self.kgapi_rx_payload[1:7]]
+                    self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'handle': handle, 'address': address, 'pairing': pairing, 'profile': profile, 'status': status }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_evt_bluetooth_connection_status(self.last_event['payload'])
+                elif packet_command == 9: # kg_evt_bluetooth_connection_closed
+                    handle, reason, = kg_evt_bluetooth_connection_closed_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'handle': handle, 'reason': reason }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_evt_bluetooth_connection_closed(self.last_event['payload'])
+            elif packet_class == 3: # FEEDBACK
+                if packet_command == 1: # kg_evt_feedback_blink_mode
+                    mode, = kg_evt_feedback_blink_mode_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'mode': mode }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_evt_feedback_blink_mode(self.last_event['payload'])
+                elif packet_command == 2: # kg_evt_feedback_piezo_mode
+                    index, mode, duration, frequency, = kg_evt_feedback_piezo_mode_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'index': index, 'mode': mode, 'duration': duration, 'frequency': frequency }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_evt_feedback_piezo_mode(self.last_event['payload'])
+                elif packet_command == 3: # kg_evt_feedback_vibrate_mode
+                    index, mode, duration, = kg_evt_feedback_vibrate_mode_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'index': index, 'mode': mode, 'duration': duration }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_evt_feedback_vibrate_mode(self.last_event['payload'])
+                elif packet_command == 4: # kg_evt_feedback_rgb_mode
+                    index, mode_red, mode_green, mode_blue, = kg_evt_feedback_rgb_mode_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'index': index, 'mode_red': mode_red, 'mode_green': mode_green, 'mode_blue': mode_blue }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_evt_feedback_rgb_mode(self.last_event['payload'])
+                elif packet_command == 5: # kg_evt_feedback_pattern
+                    output, pattern, duration, = kg_evt_feedback_pattern_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'output': output, 'pattern': pattern, 'duration': duration }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_evt_feedback_pattern(self.last_event['payload'])
+            elif packet_class == 4: # TOUCH
+                if packet_command == 1: # kg_evt_touch_mode
+                    mode, = kg_evt_touch_mode_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'mode': mode }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_evt_touch_mode(self.last_event['payload'])
+                elif packet_command == 2: # kg_evt_touch_status
+                    status_len, = kg_evt_touch_status_struct.unpack_from(self.kgapi_rx_payload)
+                    status_data = [ord(b) for b in self.kgapi_rx_payload[1:]]
+                    self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'status': status_data }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_evt_touch_status(self.last_event['payload'])
+            elif packet_class == 5: # MOTION
+                if packet_command == 1: # kg_evt_motion_mode
+                    index, mode, = kg_evt_motion_mode_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'index': index, 'mode': mode }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_evt_motion_mode(self.last_event['payload'])
+                elif packet_command == 2: # kg_evt_motion_data
+                    index, flags, data_len, = kg_evt_motion_data_struct.unpack_from(self.kgapi_rx_payload)
+                    data_data = [ord(b) for b in self.kgapi_rx_payload[3:]]
+                    self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'index': index, 'flags': flags, 'data': data_data }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_evt_motion_data(self.last_event['payload'])
+                elif packet_command == 3: # kg_evt_motion_state
+                    index, state, = kg_evt_motion_state_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'index': index, 'state': state }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_evt_motion_state(self.last_event['payload'])
+                elif packet_command == 4: # kg_evt_motion_calibration
+                    index, status, progress, = kg_evt_motion_calibration_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'index': index, 'status': status, 'progress': progress }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_evt_motion_calibration(self.last_event['payload'])
+                elif packet_command == 5: # kg_evt_motion_gesture
+                    index, gesture, axis, strength, = kg_evt_motion_gesture_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'index': index, 'gesture': gesture, 'axis': axis, 'strength': strength }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_evt_motion_gesture(self.last_event['payload'])
+                elif packet_command == 6: # kg_evt_motion_config
+                    index, rate, accel_range, gyro_range, filter, encoding, stream_rate, = kg_evt_motion_config_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'index': index, 'rate': rate, 'accel_range': accel_range, 'gyro_range': gyro_range, 'filter': filter, 'encoding': encoding, 'stream_rate': stream_rate }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_evt_motion_config(self.last_event['payload'])
+            elif packet_class == 6: # FLEX
+                if packet_command == 1: # kg_evt_flex_value
+                    index, value, = kg_evt_flex_value_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'index': index, 'value': value }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_evt_flex_value(self.last_event['payload'])
+            elif packet_class == 7: # PRESSURE
+                if packet_command == 1: # kg_evt_pressure_press
+                    index, velocity, peak, = kg_evt_pressure_press_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'index': index, 'velocity': velocity, 'peak': peak }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_evt_pressure_press(self.last_event['payload'])
+                elif packet_command == 2: # kg_evt_pressure_release
+                    index, = kg_evt_pressure_release_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'index': index }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_evt_pressure_release(self.last_event['payload'])
+                elif packet_command == 3: # kg_evt_pressure_value
+                    index, value, = kg_evt_pressure_value_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'index': index, 'value': value }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_evt_pressure_value(self.last_event['payload'])
+                elif packet_command == 4: # kg_evt_pressure_config
+                    press, release, deadband, = kg_evt_pressure_config_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'press': press, 'release': release, 'deadband': deadband }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_evt_pressure_config(self.last_event['payload'])
+            elif packet_class == 8: # TOUCHSET
+                if packet_command == 1: # kg_evt_touchset_macro_status
+                    index, status, = kg_evt_touchset_macro_status_struct.unpack_from(self.kgapi_rx_payload)
+                    self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'index': index, 'status': status }, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_evt_touchset_macro_status(self.last_event['payload'])
+            elif packet_class == 0xFF: # LOG
+                if packet_command == 0xFF: # kg_log
+                    level, = struct.unpack('<B', self.kgapi_rx_payload[:1])
+                    message = self.kgapi_rx_payload[1:]
+                    payload = { 'level': level, 'message': message }
+                    self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': payload, 'raw': self.kgapi_last_rx_packet }
+                    self.kg_log(payload)
+                elif packet_command == 0xFE: # kg_log records
+                    records = []
+                    for i in range(0, len(self.kgapi_rx_payload) - kg_log_record_struct.size + 1, kg_log_record_struct.size):
+                        level, message_id, arg, ticks = kg_log_record_struct.unpack_from(self.kgapi_rx_payload, i)
+                        record = { 'level': level, 'message_id': message_id, 'arg': arg, 'ticks': ticks, 'message': kg_log_record_text(message_id, arg) }
+                        records.append(record)
+                        self.kg_log(record)
+                    self.last_event = { 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'records': records }, 'raw': self.kgapi_last_rx_packet }
+            self.last_event['tag'] = (packet_type >> 3) & 0x07 if not timestamp_mode else 0
+            self.last_event['timestamp'] = self.last_event_timestamp
+            self.last_event['host_time'] = self.last_event_host_time
+            self.kg_event(self.last_event)
+            return (0x80, self.last_event)
 
     def friendly_packet(self, packet, incoming):
-        if type(packet) == type(list()):
-            packet = b''.join(chr(x) for x in packet)
+        if type(packet) != type(str()):
+            packet = bytes(bytearray(packet)) # list or bytearray, e.g. the 'raw' packet of a response or event
         if len(packet) < 4 or len(packet) != ord(packet[1]) + 4:
             return False # invalid packet length
-        if packet[0] != 0x80 and (incoming == 0 and ord(packet[0]) != 0xC0):
-            return False # invalid packet type
+        if (ord(packet[0]) & 0xC7) not in (0x80, 0xC0) or (incoming == 0 and (ord(packet[0]) & 0xC7) != 0xC0):
+            return False # invalid packet type (bits 5-3 hold the tag or timestamp mode)
 
         packet_type = ord(packet[0]) & 0xC0
         payload_length = ord(packet[1])
@@ -909,6 +1554,10 @@ class KGAPI(object):
         packet_command = ord(packet[3])
         payload = packet[4:]
 
+        if packet_type == 0x80 and packet_class not in (0x00, 0xFF) and ord(packet[0]) & 0x38 and payload_length >= 4:
+            payload = payload[:-4] # event timestamp
+            payload_length -= 4
+
         if incoming == 0:
             if packet_class == 1: # SYSTEM
                 if packet_command == 1: # kg_cmd_system_ping
@@ -928,6 +1577,40 @@ class KGAPI(object):
                 elif packet_command == 7: # kg_cmd_system_set_timer
                     handle, interval, oneshot, = struct.unpack('<BHB', payload[:4])
                     return { 'type': 'command', 'name': 'kg_cmd_system_set_timer', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'handle': ('%d' % (handle)), 'interval': ('%d' % (interval)), 'oneshot': ('%d' % (oneshot)) }, 'payload_keys': [ 'handle', 'interval', 'oneshot' ] }
+                elif packet_command == 8: # kg_cmd_system_get_time
+                    return { 'type': 'command', 'name': 'kg_cmd_system_get_time', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': {  }, 'payload_keys': [  ] }
+                elif packet_command == 9: # kg_cmd_system_get_timestamp_mode
+                    return { 'type': 'command', 'name': 'kg_cmd_system_get_timestamp_mode', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': {  }, 'payload_keys': [  ] }
+                elif packet_command == 10: # kg_cmd_system_set_timestamp_mode
+                    mode, = struct.unpack('<B', payload[:1])
+                    return { 'type': 'command', 'name': 'kg_cmd_system_set_timestamp_mode', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'mode': ('%02X' % mode) }, 'payload_keys': [ 'mode' ] }
+                elif packet_command == 11: # kg_cmd_system_get_event_mask
+                    interface, event_class, = struct.unpack('<BB', payload[:2])
+                    return { 'type': 'command', 'name': 'kg_cmd_system_get_event_mask', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'interface': ('%02X' % interface), 'event_class': ('%02X' % event_class) }, 'payload_keys': [ 'interface', 'event_class' ] }
+                elif packet_command == 12: # kg_cmd_system_set_event_mask
+                    interface, event_class, mask, = struct.unpack('<BBH', payload[:4])
+                    return { 'type': 'command', 'name': 'kg_cmd_system_set_event_mask', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'interface': ('%02X' % interface), 'event_class': ('%02X' % event_class), 'mask': ('%04X' % mask) }, 'payload_keys': [ 'interface', 'event_class', 'mask' ] }
+                elif packet_command == 13: # kg_cmd_system_get_event_rate
+                    interface, event_class, = struct.unpack('<BB', payload[:2])
+                    return { 'type': 'command', 'name': 'kg_cmd_system_get_event_rate', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'interface': ('%02X' % interface), 'event_class': ('%02X' % event_class) }, 'payload_keys': [ 'interface', 'event_class' ] }
+                elif packet_command == 14: # kg_cmd_system_set_event_rate
+                    interface, event_class, interval, ids, = struct.unpack('<BBBH', payload[:5])
+                    return { 'type': 'command', 'name': 'kg_cmd_system_set_event_rate', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'interface': ('%02X' % interface), 'event_class': ('%02X' % event_class), 'interval': ('%d' % (interval)), 'ids': ('%04X' % ids) }, 'payload_keys': [ 'interface', 'event_class', 'interval', 'ids' ] }
+                elif packet_command == 15: # kg_cmd_system_get_log_level
+                    return { 'type': 'command', 'name': 'kg_cmd_system_get_log_level', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': {  }, 'payload_keys': [  ] }
+                elif packet_command == 16: # kg_cmd_system_set_log_level
+                    level, = struct.unpack('<B', payload[:1])
+                    return { 'type': 'command', 'name': 'kg_cmd_system_set_log_level', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'level': ('%d' % (level)) }, 'payload_keys': [ 'level' ] }
+                elif packet_command == 17: # kg_cmd_system_get_memory_stats
+                    return { 'type': 'command', 'name': 'kg_cmd_system_get_memory_stats', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': {  }, 'payload_keys': [  ] }
+                elif packet_command == 18: # kg_cmd_system_get_memory_allocations
+                    subsystem, = struct.unpack('<B', payload[:1])
+                    return { 'type': 'command', 'name': 'kg_cmd_system_get_memory_allocations', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'subsystem': ('%d' % (subsystem)) }, 'payload_keys': [ 'subsystem' ] }
+                elif packet_command == 19: # kg_cmd_system_get_memory_threshold
+                    return { 'type': 'command', 'name': 'kg_cmd_system_get_memory_threshold', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': {  }, 'payload_keys': [  ] }
+                elif packet_command == 20: # kg_cmd_system_set_memory_threshold
+                    threshold, = struct.unpack('<H', payload[:2])
+                    return { 'type': 'command', 'name': 'kg_cmd_system_set_memory_threshold', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'threshold': ('%d %s' % (threshold, 'byte' if (threshold == 1) else 'bytes')) }, 'payload_keys': [ 'threshold' ] }
             elif packet_class == 2: # BLUETOOTH
                 if packet_command == 1: # kg_cmd_bluetooth_get_mode
                     return { 'type': 'command', 'name': 'kg_cmd_bluetooth_get_mode', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': {  }, 'payload_keys': [  ] }
@@ -984,6 +1667,13 @@ class KGAPI(object):
                 elif packet_command == 8: # kg_cmd_feedback_set_rgb_mode
                     index, mode_red, mode_green, mode_blue, = struct.unpack('<BBBB', payload[:4])
                     return { 'type': 'command', 'name': 'kg_cmd_feedback_set_rgb_mode', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'index': ('%d' % (index)), 'mode_red': ('%02X' % mode_red), 'mode_green': ('%02X' % mode_green), 'mode_blue': ('%02X' % mode_blue) }, 'payload_keys': [ 'index', 'mode_red', 'mode_green', 'mode_blue' ] }
+                elif packet_command == 9: # kg_cmd_feedback_set_custom_pattern
+                    index, segments_len, = struct.unpack('<BB', payload[:2])
+                    segments_data = [ord(b) for b in payload[2:]]
+                    return { 'type': 'command', 'name': 'kg_cmd_feedback_set_custom_pattern', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'index': ('%d' % (index)), 'segments': ' '.join(['%02X' % b for b in segments_data]) }, 'payload_keys': [ 'index', 'segments' ] }
+                elif packet_command == 10: # kg_cmd_feedback_play_pattern
+                    output, pattern, duration, = struct.unpack('<BBB', payload[:3])
+                    return { 'type': 'command', 'name': 'kg_cmd_feedback_play_pattern', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'output': ('%d' % (output)), 'pattern': ('%d' % (pattern)), 'duration': ('%d %s' % (duration * 10, 'ms')) }, 'payload_keys': [ 'output', 'pattern', 'duration' ] }
             elif packet_class == 4: # TOUCH
                 if packet_command == 1: # kg_cmd_touch_get_mode
                     return { 'type': 'command', 'name': 'kg_cmd_touch_get_mode', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': {  }, 'payload_keys': [  ] }
@@ -997,201 +1687,374 @@ class KGAPI(object):
                 elif packet_command == 2: # kg_cmd_motion_set_mode
                     index, mode, = struct.unpack('<BB', payload[:2])
                     return { 'type': 'command', 'name': 'kg_cmd_motion_set_mode', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'index': ('%d' % (index)), 'mode': ('%02X' % mode) }, 'payload_keys': [ 'index', 'mode' ] }
+                elif packet_command == 3: # kg_cmd_motion_calibrate
+                    index, flags, = struct.unpack('<BB', payload[:2])
+                    return { 'type': 'command', 'name': 'kg_cmd_motion_calibrate', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'index': ('%d' % (index)), 'flags': ('%02X' % flags) }, 'payload_keys': [ 'index', 'flags' ] }
+                elif packet_command == 4: # kg_cmd_motion_get_config
+                    index, = struct.unpack('<B', payload[:1])
+                    return { 'type': 'command', 'name': 'kg_cmd_motion_get_config', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'index': ('%d' % (index)) }, 'payload_keys': [ 'index' ] }
+                elif packet_command == 5: # kg_cmd_motion_set_config
+                    index, rate, accel_range, gyro_range, filter, encoding, stream_rate, = struct.unpack('<BHBBBBH', payload[:9])
+                    return { 'type': 'command', 'name': 'kg_cmd_motion_set_config', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'index': ('%d' % (index)), 'rate': ('%d' % (rate)), 'accel_range': ('%d' % (accel_range)), 'gyro_range': ('%d' % (gyro_range)), 'filter': ('%d' % (filter)), 'encoding': ('%02X' % encoding), 'stream_rate': ('%d' % (stream_rate)) }, 'payload_keys': [ 'index', 'rate', 'accel_range', 'gyro_range', 'filter', 'encoding', 'stream_rate' ] }
+            elif packet_class == 6: # FLEX
+                if packet_command == 1: # kg_cmd_flex_get_value
+                    index, = struct.unpack('<B', payload[:1])
+                    return { 'type': 'command', 'name': 'kg_cmd_flex_get_value', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'index': ('%d' % (index)) }, 'payload_keys': [ 'index' ] }
+                elif packet_command == 2: # kg_cmd_flex_calibrate
+                    mode, = struct.unpack('<B', payload[:1])
+                    return { 'type': 'command', 'name': 'kg_cmd_flex_calibrate', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'mode': ('%d' % (mode)) }, 'payload_keys': [ 'mode' ] }
+                elif packet_command == 3: # kg_cmd_flex_get_calibration
+                    index, = struct.unpack('<B', payload[:1])
+                    return { 'type': 'command', 'name': 'kg_cmd_flex_get_calibration', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'index': ('%d' % (index)) }, 'payload_keys': [ 'index' ] }
+                elif packet_command == 4: # kg_cmd_flex_set_calibration
+                    index, min, max, = struct.unpack('<BHH', payload[:5])
+                    return { 'type': 'command', 'name': 'kg_cmd_flex_set_calibration', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'index': ('%d' % (index)), 'min': ('%d' % (min)), 'max': ('%d' % (max)) }, 'payload_keys': [ 'index', 'min', 'max' ] }
+            elif packet_class == 7: # PRESSURE
+                if packet_command == 1: # kg_cmd_pressure_get_value
+                    index, = struct.unpack('<B', payload[:1])
+                    return { 'type': 'command', 'name': 'kg_cmd_pressure_get_value', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'index': ('%d' % (index)) }, 'payload_keys': [ 'index' ] }
+                elif packet_command == 2: # kg_cmd_pressure_get_config
+                    return { 'type': 'command', 'name': 'kg_cmd_pressure_get_config', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': {  }, 'payload_keys': [  ] }
+                elif packet_command == 3: # kg_cmd_pressure_set_config
+                    press, release, deadband, = struct.unpack('<BBB', payload[:3])
+                    return { 'type': 'command', 'name': 'kg_cmd_pressure_set_config', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'press': ('%d' % (press)), 'release': ('%d' % (release)), 'deadband': ('%d' % (deadband)) }, 'payload_keys': [ 'press', 'release', 'deadband' ] }
+            elif packet_class == 8: # TOUCHSET
+                if packet_command == 1: # kg_cmd_touchset_set_macro
+                    index, macro_len, = struct.unpack('<BB', payload[:2])
+                    macro_data = [ord(b) for b in payload[2:]]
+                    return { 'type': 'command', 'name': 'kg_cmd_touchset_set_macro', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'index': ('%d' % (index)), 'macro': ' '.join(['%02X' % b for b in macro_data]) }, 'payload_keys': [ 'index', 'macro' ] }
+                elif packet_command == 2: # kg_cmd_touchset_play_macro
+                    index, = struct.unpack('<B', payload[:1])
+                    return { 'type': 'command', 'name': 'kg_cmd_touchset_play_macro', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'index': ('%d' % (index)) }, 'payload_keys': [ 'index' ] }
+                elif packet_command == 3: # kg_cmd_touchset_stop_macro
+                    return { 'type': 'command', 'name': 'kg_cmd_touchset_stop_macro', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': {  }, 'payload_keys': [  ] }
         else:
             if packet_type & 0xC0 == 0xC0: # response packet
                 if packet_class == 1: # SYSTEM
                     if packet_command == 1: # kg_rsp_system_ping
-                        uptime, = struct.unpack('<L', payload[:4])
+                        uptime, = kg_rsp_system_ping_struct.unpack_from(payload)
                         return { 'type': 'response', 'name': 'kg_rsp_system_ping', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'uptime': ('%d %s' % (uptime, 'second' if (uptime == 1) else 'seconds')) }, 'payload_keys': [ 'uptime' ] }
                     elif packet_command == 2: # kg_rsp_system_reset
-                        result, = struct.unpack('<H', payload[:2])
+                        result, = kg_rsp_system_reset_struct.unpack_from(payload)
                         return { 'type': 'response', 'name': 'kg_rsp_system_reset', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': ('%04X' % result) }, 'payload_keys': [ 'result' ] }
                     elif packet_command == 3: # kg_rsp_system_get_info
-                        major, minor, patch, protocol, timestamp, = struct.unpack('<HHHHL', payload[:12])
+                        major, minor, patch, protocol, timestamp, = kg_rsp_system_get_info_struct.unpack_from(payload)
                         return { 'type': 'response', 'name': 'kg_rsp_system_get_info', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'major': ('%d' % (major)), 'minor': ('%d' % (minor)), 'patch': ('%d' % (patch)), 'protocol': ('%d' % (protocol)), 'timestamp': ('%d' % (timestamp)) }, 'payload_keys': [ 'major', 'minor', 'patch', 'protocol', 'timestamp' ] }
                     elif packet_command == 4: # kg_rsp_system_get_capabilities
-                        count, = struct.unpack('<H', payload[:2])
+                        count, = kg_rsp_system_get_capabilities_struct.unpack_from(payload)
                         return { 'type': 'response', 'name': 'kg_rsp_system_get_capabilities', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'count': ('%d' % (count)) }, 'payload_keys': [ 'count' ] }
                     elif packet_command == 5: # kg_rsp_system_get_memory
-                        free_ram, total_ram, = struct.unpack('<LL', payload[:8])
+                        free_ram, total_ram, = kg_rsp_system_get_memory_struct.unpack_from(payload)
                         return { 'type': 'response', 'name': 'kg_rsp_system_get_memory', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'free_ram': ('%d %s' % (free_ram, 'byte' if (free_ram == 1) else 'bytes')), 'total_ram': ('%d %s' % (total_ram, 'byte' if (total_ram == 1) else 'bytes')) }, 'payload_keys': [ 'free_ram', 'total_ram' ] }
                     elif packet_command == 6: # kg_rsp_system_get_battery_status
-                        status, level, = struct.unpack('<BB', payload[:2])
+                        status, level, = kg_rsp_system_get_battery_status_struct.unpack_from(payload)
                         return { 'type': 'response', 'name': 'kg_rsp_system_get_battery_status', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'status': ('%02X' % status), 'level': ('%02X' % level) }, 'payload_keys': [ 'status', 'level' ] }
                     elif packet_command == 7: # kg_rsp_system_set_timer
-                        result, = struct.unpack('<H', payload[:2])
+                        result, = kg_rsp_system_set_timer_struct.unpack_from(payload)
                         return { 'type': 'response', 'name': 'kg_rsp_system_set_timer', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': ('%04X' % result) }, 'payload_keys': [ 'result' ] }
+                    elif packet_command == 8: # kg_rsp_system_get_time
+                        seconds, subticks, microseconds, = kg_rsp_system_get_time_struct.unpack_from(payload)
+                        return { 'type': 'response', 'name': 'kg_rsp_system_get_time', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'seconds': ('%d' % (seconds)), 'subticks': ('%d' % (subticks)), 'microseconds': ('%d' % (microseconds)) }, 'payload_keys': [ 'seconds', 'subticks', 'microseconds' ] }
+                    elif packet_command == 9: # kg_rsp_system_get_timestamp_mode
+                        mode, = kg_rsp_system_get_timestamp_mode_struct.unpack_from(payload)
+                        return { 'type': 'response', 'name': 'kg_rsp_system_get_timestamp_mode', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'mode': ('%02X' % mode) }, 'payload_keys': [ 'mode' ] }
+                    elif packet_command == 10: # kg_rsp_system_set_timestamp_mode
+                        result, = kg_rsp_system_set_timestamp_mode_struct.unpack_from(payload)
+                        return { 'type': 'response', 'name': 'kg_rsp_system_set_timestamp_mode', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': ('%04X' % result) }, 'payload_keys': [ 'result' ] }
+                    elif packet_command == 11: # kg_rsp_system_get_event_mask
+                        result, mask, = kg_rsp_system_get_event_mask_struct.unpack_from(payload)
+                        return { 'type': 'response', 'name': 'kg_rsp_system_get_event_mask', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': ('%04X' % result), 'mask': ('%04X' % mask) }, 'payload_keys': [ 'result', 'mask' ] }
+                    elif packet_command == 12: # kg_rsp_system_set_event_mask
+                        result, = kg_rsp_system_set_event_mask_struct.unpack_from(payload)
+                        return { 'type': 'response', 'name': 'kg_rsp_system_set_event_mask', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': ('%04X' % result) }, 'payload_keys': [ 'result' ] }
+                    elif packet_command == 13: # kg_rsp_system_get_event_rate
+                        result, interval, ids, = kg_rsp_system_get_event_rate_struct.unpack_from(payload)
+                        return { 'type': 'response', 'name': 'kg_rsp_system_get_event_rate', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': ('%04X' % result), 'interval': ('%d' % (interval)), 'ids': ('%04X' % ids) }, 'payload_keys': [ 'result', 'interval', 'ids' ] }
+                    elif packet_command == 14: # kg_rsp_system_set_event_rate
+                        result, = kg_rsp_system_set_event_rate_struct.unpack_from(payload)
+                        return { 'type': 'response', 'name': 'kg_rsp_system_set_event_rate', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': ('%04X' % result) }, 'payload_keys': [ 'result' ] }
+                    elif packet_command == 15: # kg_rsp_system_get_log_level
+                        level, = kg_rsp_system_get_log_level_struct.unpack_from(payload)
+                        return { 'type': 'response', 'name': 'kg_rsp_system_get_log_level', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'level': ('%d' % (level)) }, 'payload_keys': [ 'level' ] }
+                    elif packet_command == 16: # kg_rsp_system_set_log_level
+                        result, = kg_rsp_system_set_log_level_struct.unpack_from(payload)
+                        return { 'type': 'response', 'name': 'kg_rsp_system_set_log_level', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': ('%04X' % result) }, 'payload_keys': [ 'result' ] }
+                    elif packet_command == 17: # kg_rsp_system_get_memory_stats
+                        free_ram, stack_headroom, heap_size, heap_free, largest_free, free_blocks, = kg_rsp_system_get_memory_stats_struct.unpack_from(payload)
+                        return { 'type': 'response', 'name': 'kg_rsp_system_get_memory_stats', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'free_ram': ('%d %s' % (free_ram, 'byte' if (free_ram == 1) else 'bytes')), 'stack_headroom': ('%d %s' % (stack_headroom, 'byte' if (stack_headroom == 1) else 'bytes')), 'heap_size': ('%d %s' % (heap_size, 'byte' if (heap_size == 1) else 'bytes')), 'heap_free': ('%d %s' % (heap_free, 'byte' if (heap_free == 1) else 'bytes')), 'largest_free': ('%d %s' % (largest_free, 'byte' if (largest_free == 1) else 'bytes')), 'free_blocks': ('%d' % (free_blocks)) }, 'payload_keys': [ 'free_ram', 'stack_headroom', 'heap_size', 'heap_free', 'largest_free', 'free_blocks' ] }
+                    elif packet_command == 18: # kg_rsp_system_get_memory_allocations
+                        result, allocations, blocks, failures, = kg_rsp_system_get_memory_allocations_struct.unpack_from(payload)
+                        return { 'type': 'response', 'name': 'kg_rsp_system_get_memory_allocations', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': ('%04X' % result), 'allocations': ('%d' % (allocations)), 'blocks': ('%d' % (blocks)), 'failures': ('%d' % (failures)) }, 'payload_keys': [ 'result', 'allocations', 'blocks', 'failures' ] }
+                    elif packet_command == 19: # kg_rsp_system_get_memory_threshold
+                        threshold, = kg_rsp_system_get_memory_threshold_struct.unpack_from(payload)
+                        return { 'type': 'response', 'name': 'kg_rsp_system_get_memory_threshold', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'threshold': ('%d %s' % (threshold, 'byte' if (threshold == 1) else 'bytes')) }, 'payload_keys': [ 'threshold' ] }
+                    elif packet_command == 20: # kg_rsp_system_set_memory_threshold
+                        result, = kg_rsp_system_set_memory_threshold_struct.unpack_from(payload)
+                        return { 'type': 'response', 'name': 'kg_rsp_system_set_memory_threshold', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': ('%04X' % result) }, 'payload_keys': [ 'result' ] }
                 elif packet_class == 2: # BLUETOOTH
                     if packet_command == 1: # kg_rsp_bluetooth_get_mode
-                        result, mode, = struct.unpack('<HB', payload[:3])
+                        result, mode, = kg_rsp_bluetooth_get_mode_struct.unpack_from(payload)
                         return { 'type': 'response', 'name': 'kg_rsp_bluetooth_get_mode', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': ('%04X' % result), 'mode': ('%02X' % mode) }, 'payload_keys': [ 'result', 'mode' ] }
                     elif packet_command == 2: # kg_rsp_bluetooth_set_mode
-                        result, = struct.unpack('<H', payload[:2])
+                        result, = kg_rsp_bluetooth_set_mode_struct.unpack_from(payload)
                         return { 'type': 'response', 'name': 'kg_rsp_bluetooth_set_mode', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': ('%04X' % result) }, 'payload_keys': [ 'result' ] }
                     elif packet_command == 3: # kg_rsp_bluetooth_reset
-                        result, = struct.unpack('<H', payload[:2])
+                        result, = kg_rsp_bluetooth_reset_struct.unpack_from(payload)
                         return { 'type': 'response', 'name': 'kg_rsp_bluetooth_reset', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': ('%04X' % result) }, 'payload_keys': [ 'result' ] }
                     elif packet_command == 4: # kg_rsp_bluetooth_get_mac
-                        result, address, = struct.unpack('<H6s', payload[:8])
+                        result, address, = kg_rsp_bluetooth_get_mac_struct.unpack_from(payload)
                         address = [ord(b) for b in payload[2:8]]
                         return { 'type': 'response', 'name': 'kg_rsp_bluetooth_get_mac', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': ('%04X' % result), 'address': ':'.join(['%02X' % b for b in address][::-1]) }, 'payload_keys': [ 'result', 'address' ] }
                     elif packet_command == 5: # kg_rsp_bluetooth_get_pairings
-                        result, count, = struct.unpack('<HB', payload[:3])
+                        result, count, = kg_rsp_bluetooth_get_pairings_struct.unpack_from(payload)
                         return { 'type': 'response', 'name': 'kg_rsp_bluetooth_get_pairings', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': ('%04X' % result), 'count': ('%02X' % count) }, 'payload_keys': [ 'result', 'count' ] }
                     elif packet_command == 6: # kg_rsp_bluetooth_discover
-                        result, = struct.unpack('<H', payload[:2])
+                        result, = kg_rsp_bluetooth_discover_struct.unpack_from(payload)
                         return { 'type': 'response', 'name': 'kg_rsp_bluetooth_discover', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': ('%04X' % result) }, 'payload_keys': [ 'result' ] }
                     elif packet_command == 7: # kg_rsp_bluetooth_pair
-                        result, = struct.unpack('<H', payload[:2])
+                        result, = kg_rsp_bluetooth_pair_struct.unpack_from(payload)
                         return { 'type': 'response', 'name': 'kg_rsp_bluetooth_pair', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': ('%04X' % result) }, 'payload_keys': [ 'result' ] }
                     elif packet_command == 8: # kg_rsp_bluetooth_delete_pairing
-                        result, = struct.unpack('<H', payload[:2])
+                        result, = kg_rsp_bluetooth_delete_pairing_struct.unpack_from(payload)
                         return { 'type': 'response', 'name': 'kg_rsp_bluetooth_delete_pairing', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': ('%04X' % result) }, 'payload_keys': [ 'result' ] }
                     elif packet_command == 9: # kg_rsp_bluetooth_clear_pairings
-                        result, = struct.unpack('<H', payload[:2])
+                        result, = kg_rsp_bluetooth_clear_pairings_struct.unpack_from(payload)
                         return { 'type': 'response', 'name': 'kg_rsp_bluetooth_clear_pairings', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': ('%04X' % result) }, 'payload_keys': [ 'result' ] }
                     elif packet_command == 10: # kg_rsp_bluetooth_get_connections
-                        result, count, = struct.unpack('<HB', payload[:3])
+                        result, count, = kg_rsp_bluetooth_get_connections_struct.unpack_from(payload)
                         return { 'type': 'response', 'name': 'kg_rsp_bluetooth_get_connections', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': ('%04X' % result), 'count': ('%02X' % count) }, 'payload_keys': [ 'result', 'count' ] }
                     elif packet_command == 11: # kg_rsp_bluetooth_connect
-                        result, = struct.unpack('<H', payload[:2])
+                        result, = kg_rsp_bluetooth_connect_struct.unpack_from(payload)
                         return { 'type': 'response', 'name': 'kg_rsp_bluetooth_connect', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': ('%04X' % result) }, 'payload_keys': [ 'result' ] }
                     elif packet_command == 12: # kg_rsp_bluetooth_disconnect
-                        result, = struct.unpack('<H', payload[:2])
+                        result, = kg_rsp_bluetooth_disconnect_struct.unpack_from(payload)
                         return { 'type': 'response', 'name': 'kg_rsp_bluetooth_disconnect', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': ('%04X' % result) }, 'payload_keys': [ 'result' ] }
                 elif packet_class == 3: # FEEDBACK
                     if packet_command == 1: # kg_rsp_feedback_get_blink_mode
-                        mode, = struct.unpack('<B', payload[:1])
+                        mode, = kg_rsp_feedback_get_blink_mode_struct.unpack_from(payload)
                         return { 'type': 'response', 'name': 'kg_rsp_feedback_get_blink_mode', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'mode': ('%02X' % mode) }, 'payload_keys': [ 'mode' ] }
                     elif packet_command == 2: # kg_rsp_feedback_set_blink_mode
-                        result, = struct.unpack('<H', payload[:2])
+                        result, = kg_rsp_feedback_set_blink_mode_struct.unpack_from(payload)
                         return { 'type': 'response', 'name': 'kg_rsp_feedback_set_blink_mode', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': ('%04X' % result) }, 'payload_keys': [ 'result' ] }
                     elif packet_command == 3: # kg_rsp_feedback_get_piezo_mode
-                        mode, duration, frequency, = struct.unpack('<BBH', payload[:4])
+                        mode, duration, frequency, = kg_rsp_feedback_get_piezo_mode_struct.unpack_from(payload)
                         return { 'type': 'response', 'name': 'kg_rsp_feedback_get_piezo_mode', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'mode': ('%02X' % mode), 'duration': ('%d %s' % (duration * 10, 'ms')), 'frequency': ('%d %s' % (frequency, 'Hz')) }, 'payload_keys': [ 'mode', 'duration', 'frequency' ] }
                     elif packet_command == 4: # kg_rsp_feedback_set_piezo_mode
-                        result, = struct.unpack('<H', payload[:2])
+                        result, = kg_rsp_feedback_set_piezo_mode_struct.unpack_from(payload)
                         return { 'type': 'response', 'name': 'kg_rsp_feedback_set_piezo_mode', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': ('%04X' % result) }, 'payload_keys': [ 'result' ] }
                     elif packet_command == 5: # kg_rsp_feedback_get_vibrate_mode
-                        mode, duration, = struct.unpack('<BB', payload[:2])
+                        mode, duration, = kg_rsp_feedback_get_vibrate_mode_struct.unpack_from(payload)
                         return { 'type': 'response', 'name': 'kg_rsp_feedback_get_vibrate_mode', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'mode': ('%02X' % mode), 'duration': ('%d %s' % (duration * 10, '10')) }, 'payload_keys': [ 'mode', 'duration' ] }
                     elif packet_command == 6: # kg_rsp_feedback_set_vibrate_mode
-                        result, = struct.unpack('<H', payload[:2])
+                        result, = kg_rsp_feedback_set_vibrate_mode_struct.unpack_from(payload)
                         return { 'type': 'response', 'name': 'kg_rsp_feedback_set_vibrate_mode', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': ('%04X' % result) }, 'payload_keys': [ 'result' ] }
                     elif packet_command == 7: # kg_rsp_feedback_get_rgb_mode
-                        mode_red, mode_green, mode_blue, = struct.unpack('<BBB', payload[:3])
+                        mode_red, mode_green, mode_blue, = kg_rsp_feedback_get_rgb_mode_struct.unpack_from(payload)
                         return { 'type': 'response', 'name': 'kg_rsp_feedback_get_rgb_mode', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'mode_red': ('%02X' % mode_red), 'mode_green': ('%02X' % mode_green), 'mode_blue': ('%02X' % mode_blue) }, 'payload_keys': [ 'mode_red', 'mode_green', 'mode_blue' ] }
                     elif packet_command == 8: # kg_rsp_feedback_set_rgb_mode
-                        result, = struct.unpack('<H', payload[:2])
+                        result, = kg_rsp_feedback_set_rgb_mode_struct.unpack_from(payload)
                         return { 'type': 'response', 'name': 'kg_rsp_feedback_set_rgb_mode', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': ('%04X' % result) }, 'payload_keys': [ 'result' ] }
+                    elif packet_command == 9: # kg_rsp_feedback_set_custom_pattern
+                        result, = kg_rsp_feedback_set_custom_pattern_struct.unpack_from(payload)
+                        return { 'type': 'response', 'name': 'kg_rsp_feedback_set_custom_pattern', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': ('%04X' % result) }, 'payload_keys': [ 'result' ] }
+                    elif packet_command == 10: # kg_rsp_feedback_play_pattern
+                        result, = kg_rsp_feedback_play_pattern_struct.unpack_from(payload)
+                        return { 'type': 'response', 'name': 'kg_rsp_feedback_play_pattern', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': ('%04X' % result) }, 'payload_keys': [ 'result' ] }
                 elif packet_class == 4: # TOUCH
                     if packet_command == 1: # kg_rsp_touch_get_mode
-                        mode, = struct.unpack('<B', payload[:1])
+                        mode, = kg_rsp_touch_get_mode_struct.unpack_from(payload)
                         return { 'type': 'response', 'name': 'kg_rsp_touch_get_mode', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'mode': ('%02X' % mode) }, 'payload_keys': [ 'mode' ] }
                     elif packet_command == 2: # kg_rsp_touch_set_mode
-                        result, = struct.unpack('<H', payload[:2])
+                        result, = kg_rsp_touch_set_mode_struct.unpack_from(payload)
                         return { 'type': 'response', 'name': 'kg_rsp_touch_set_mode', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': ('%04X' % result) }, 'payload_keys': [ 'result' ] }
                 elif packet_class == 5: # MOTION
                     if packet_command == 1: # kg_rsp_motion_get_mode
-                        mode, = struct.unpack('<B', payload[:1])
+                        mode, = kg_rsp_motion_get_mode_struct.unpack_from(payload)
                         return { 'type': 'response', 'name': 'kg_rsp_motion_get_mode', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'mode': ('%02X' % mode) }, 'payload_keys': [ 'mode' ] }
                     elif packet_command == 2: # kg_rsp_motion_set_mode
-                        result, = struct.unpack('<H', payload[:2])
+                        result, = kg_rsp_motion_set_mode_struct.unpack_from(payload)
                         return { 'type': 'response', 'name': 'kg_rsp_motion_set_mode', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': ('%04X' % result) }, 'payload_keys': [ 'result' ] }
+                    elif packet_command == 3: # kg_rsp_motion_calibrate
+                        result, = kg_rsp_motion_calibrate_struct.unpack_from(payload)
+                        return { 'type': 'response', 'name': 'kg_rsp_motion_calibrate', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': ('%04X' % result) }, 'payload_keys': [ 'result' ] }
+                    elif packet_command == 4: # kg_rsp_motion_get_config
+                        result, rate, accel_range, gyro_range, filter, encoding, stream_rate, = kg_rsp_motion_get_config_struct.unpack_from(payload)
+                        return { 'type': 'response', 'name': 'kg_rsp_motion_get_config', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': ('%04X' % result), 'rate': ('%d' % (rate)), 'accel_range': ('%d' % (accel_range)), 'gyro_range': ('%d' % (gyro_range)), 'filter': ('%d' % (filter)), 'encoding': ('%02X' % encoding), 'stream_rate': ('%d' % (stream_rate)) }, 'payload_keys': [ 'result', 'rate', 'accel_range', 'gyro_range', 'filter', 'encoding', 'stream_rate' ] }
+                    elif packet_command == 5: # kg_rsp_motion_set_config
+                        result, = kg_rsp_motion_set_config_struct.unpack_from(payload)
+                        return { 'type': 'response', 'name': 'kg_rsp_motion_set_config', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': ('%04X' % result) }, 'payload_keys': [ 'result' ] }
+                elif packet_class == 6: # FLEX
+                    if packet_command == 1: # kg_rsp_flex_get_value
+                        result, value, raw, = kg_rsp_flex_get_value_struct.unpack_from(payload)
+                        return { 'type': 'response', 'name': 'kg_rsp_flex_get_value', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': ('%04X' % result), 'value': ('%d' % (value)), 'raw': ('%d' % (raw)) }, 'payload_keys': [ 'result', 'value', 'raw' ] }
+                    elif packet_command == 2: # kg_rsp_flex_calibrate
+                        result, = kg_rsp_flex_calibrate_struct.unpack_from(payload)
+                        return { 'type': 'response', 'name': 'kg_rsp_flex_calibrate', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': ('%04X' % result) }, 'payload_keys': [ 'result' ] }
+                    elif packet_command == 3: # kg_rsp_flex_get_calibration
+                        result, min, max, = kg_rsp_flex_get_calibration_struct.unpack_from(payload)
+                        return { 'type': 'response', 'name': 'kg_rsp_flex_get_calibration', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': ('%04X' % result), 'min': ('%d' % (min)), 'max': ('%d' % (max)) }, 'payload_keys': [ 'result', 'min', 'max' ] }
+                    elif packet_command == 4: # kg_rsp_flex_set_calibration
+                        result, = kg_rsp_flex_set_calibration_struct.unpack_from(payload)
+                        return { 'type': 'response', 'name': 'kg_rsp_flex_set_calibration', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': ('%04X' % result) }, 'payload_keys': [ 'result' ] }
+                elif packet_class == 7: # PRESSURE
+                    if packet_command == 1: # kg_rsp_pressure_get_value
+                        result, state, value, velocity, raw, = kg_rsp_pressure_get_value_struct.unpack_from(payload)
+                        return { 'type': 'response', 'name': 'kg_rsp_pressure_get_value', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': ('%04X' % result), 'state': ('%02X' % state), 'value': ('%d' % (value)), 'velocity': ('%d' % (velocity)), 'raw': ('%d' % (raw)) }, 'payload_keys': [ 'result', 'state', 'value', 'velocity', 'raw' ] }
+                    elif packet_command == 2: # kg_rsp_pressure_get_config
+                        press, release, deadband, = kg_rsp_pressure_get_config_struct.unpack_from(payload)
+                        return { 'type': 'response', 'name': 'kg_rsp_pressure_get_config', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'press': ('%d' % (press)), 'release': ('%d' % (release)), 'deadband': ('%d' % (deadband)) }, 'payload_keys': [ 'press', 'release', 'deadband' ] }
+                    elif packet_command == 3: # kg_rsp_pressure_set_config
+                        result, = kg_rsp_pressure_set_config_struct.unpack_from(payload)
+                        return { 'type': 'response', 'name': 'kg_rsp_pressure_set_config', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': ('%04X' % result) }, 'payload_keys': [ 'result' ] }
+                elif packet_class == 8: # TOUCHSET
+                    if packet_command == 1: # kg_rsp_touchset_set_macro
+                        result, = kg_rsp_touchset_set_macro_struct.unpack_from(payload)
+                        return { 'type': 'response', 'name': 'kg_rsp_touchset_set_macro', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': ('%04X' % result) }, 'payload_keys': [ 'result' ] }
+                    elif packet_command == 2: # kg_rsp_touchset_play_macro
+                        result, = kg_rsp_touchset_play_macro_struct.unpack_from(payload)
+                        return { 'type': 'response', 'name': 'kg_rsp_touchset_play_macro', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': ('%04X' % result) }, 'payload_keys': [ 'result' ] }
+                    elif packet_command == 3: # kg_rsp_touchset_stop_macro
+                        result, = kg_rsp_touchset_stop_macro_struct.unpack_from(payload)
+                        return { 'type': 'response', 'name': 'kg_rsp_touchset_stop_macro', 'length': payload_length, 'class_id': packet_class, 'command_id': packet_command, 'payload': { 'result': ('%04X' % result) }, 'payload_keys': [ 'result' ] }
             if packet_type & 0xC0 == 0x80: # event packet
                 if packet_class == 0: # PROTOCOL
                     if packet_command == 1: # kg_evt_protocol_error
-                        code, = struct.unpack('<H', payload[:2])
+                        code, = kg_evt_protocol_error_struct.unpack_from(payload)
                         return { 'type': 'event', 'name': 'kg_evt_protocol_error', 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'code': ('%04X' % code) }, 'payload_keys': [ 'code' ] }
                 elif packet_class == 1: # SYSTEM
                     if packet_command == 1: # kg_evt_system_boot
-                        major, minor, patch, protocol, timestamp, = struct.unpack('<HHHHL', payload[:12])
+                        major, minor, patch, protocol, timestamp, = kg_evt_system_boot_struct.unpack_from(payload)
                         return { 'type': 'event', 'name': 'kg_evt_system_boot', 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'major': ('%d' % (major)), 'minor': ('%d' % (minor)), 'patch': ('%d' % (patch)), 'protocol': ('%d' % (protocol)), 'timestamp': ('%d' % (timestamp)) }, 'payload_keys': [ 'major', 'minor', 'patch', 'protocol', 'timestamp' ] }
                     elif packet_command == 2: # kg_evt_system_ready
                         return { 'type': 'event', 'name': 'kg_evt_system_ready', 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': {  }, 'payload_keys': [  ] }
                     elif packet_command == 3: # kg_evt_system_error
-                        code, = struct.unpack('<H', payload[:2])
+                        code, = kg_evt_system_error_struct.unpack_from(payload)
                         return { 'type': 'event', 'name': 'kg_evt_system_error', 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'code': ('%04X' % code) }, 'payload_keys': [ 'code' ] }
                     elif packet_command == 4: # kg_evt_system_capability
-                        category, record_len, = struct.unpack('<BB', payload[:2])
+                        category, record_len, = kg_evt_system_capability_struct.unpack_from(payload)
                         record_data = [ord(b) for b in payload[2:]]
                         return { 'type': 'event', 'name': 'kg_evt_system_capability', 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'category': ('%d' % (category)), 'record': ' '.join(['%02X' % b for b in record_data]) }, 'payload_keys': [ 'category', 'record' ] }
                     elif packet_command == 5: # kg_evt_system_battery_status
-                        status, level, = struct.unpack('<BB', payload[:2])
+                        status, level, = kg_evt_system_battery_status_struct.unpack_from(payload)
                         return { 'type': 'event', 'name': 'kg_evt_system_battery_status', 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'status': ('%02X' % status), 'level': ('%02X' % level) }, 'payload_keys': [ 'status', 'level' ] }
                     elif packet_command == 6: # kg_evt_system_timer_tick
-                        handle, seconds, subticks, = struct.unpack('<BLB', payload[:6])
+                        handle, seconds, subticks, = kg_evt_system_timer_tick_struct.unpack_from(payload)
                         return { 'type': 'event', 'name': 'kg_evt_system_timer_tick', 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'handle': ('%d' % (handle)), 'seconds': ('%d' % (seconds)), 'subticks': ('%d' % (subticks)) }, 'payload_keys': [ 'handle', 'seconds', 'subticks' ] }
+                    elif packet_command == 7: # kg_evt_system_timestamp_mode
+                        mode, = kg_evt_system_timestamp_mode_struct.unpack_from(payload)
+                        return { 'type': 'event', 'name': 'kg_evt_system_timestamp_mode', 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'mode': ('%02X' % mode) }, 'payload_keys': [ 'mode' ] }
+                    elif packet_command == 8: # kg_evt_system_memory_low
+                        headroom, threshold, = kg_evt_system_memory_low_struct.unpack_from(payload)
+                        return { 'type': 'event', 'name': 'kg_evt_system_memory_low', 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'headroom': ('%d' % (headroom)), 'threshold': ('%d' % (threshold)) }, 'payload_keys': [ 'headroom', 'threshold' ] }
                 elif packet_class == 2: # BLUETOOTH
                     if packet_command == 1: # kg_evt_bluetooth_mode
-                        mode, = struct.unpack('<B', payload[:1])
+                        mode, = kg_evt_bluetooth_mode_struct.unpack_from(payload)
                         return { 'type': 'event', 'name': 'kg_evt_bluetooth_mode', 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'mode': ('%02X' % mode) }, 'payload_keys': [ 'mode' ] }
                     elif packet_command == 2: # kg_evt_bluetooth_ready
                         return { 'type': 'event', 'name': 'kg_evt_bluetooth_ready', 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': {  }, 'payload_keys': [  ] }
                     elif packet_command == 3: # kg_evt_bluetooth_inquiry_response
-                        address, cod, rssi, status, pairing, name_len, = struct.unpack('<6s3sbBBB', payload[:13])
+                        address, cod, rssi, status, pairing, name_len, = kg_evt_bluetooth_inquiry_response_struct.unpack_from(payload)
                         address = [ord(b) for b in payload[0:6]]
                         cod = [ord(b) for b in payload[6:9]]
                         name_data = [ord(b) for b in payload[13:]]
                         return { 'type': 'event', 'name': 'kg_evt_bluetooth_inquiry_response', 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'address': ':'.join(['%02X' % b for b in address][::-1]), 'cod': ''.join(['%02X' % b for b in cod][::-1]), 'rssi': ('%d' % (rssi)), 'status': ('%02X' % status), 'pairing': ('%d' % (pairing)), 'name': ''.join(['%c' % b for b in name_data]) }, 'payload_keys': [ 'address', 'cod', 'rssi', 'status', 'pairing', 'name' ] }
                     elif packet_command == 4: # kg_evt_bluetooth_inquiry_complete
-                        count, = struct.unpack('<B', payload[:1])
+                        count, = kg_evt_bluetooth_inquiry_complete_struct.unpack_from(payload)
                         return { 'type': 'event', 'name': 'kg_evt_bluetooth_inquiry_complete', 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'count': ('%d' % (count)) }, 'payload_keys': [ 'count' ] }
                     elif packet_command == 5: # kg_evt_bluetooth_pairing_status
-                        pairing, address, priority, profiles_supported, profiles_active, handle_list_len, = struct.unpack('<B6sBBBB', payload[:11])
+                        pairing, address, priority, profiles_supported, profiles_active, handle_list_len, = kg_evt_bluetooth_pairing_status_struct.unpack_from(payload)
                         address = [ord(b) for b in payload[1:7]]
                         handle_list_data = [ord(b) for b in payload[11:]]
                         return { 'type': 'event', 'name': 'kg_evt_bluetooth_pairing_status', 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'pairing': ('%d' % (pairing)), 'address': ':'.join(['%02X' % b for b in address][::-1]), 'priority': ('%02X' % priority), 'profiles_supported': ('%02X' % profiles_supported), 'profiles_active': ('%02X' % profiles_active), 'handle_list': ' '.join(['%02X' % b for b in handle_list_data]) }, 'payload_keys': [ 'pairing', 'address', 'priority', 'profiles_supported', 'profiles_active', 'handle_list' ] }
                     elif packet_command == 6: # kg_evt_bluetooth_pairing_failed
-                        address, = struct.unpack('<6s', payload[:6])
+                        address, = kg_evt_bluetooth_pairing_failed_struct.unpack_from(payload)
                         address = [ord(b) for b in payload[0:6]]
                         return { 'type': 'event', 'name': 'kg_evt_bluetooth_pairing_failed', 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'address': ':'.join(['%02X' % b for b in address][::-1]) }, 'payload_keys': [ 'address' ] }
                     elif packet_command == 7: # kg_evt_bluetooth_pairings_cleared
                         return { 'type': 'event', 'name': 'kg_evt_bluetooth_pairings_cleared', 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': {  }, 'payload_keys': [  ] }
                     elif packet_command == 8: # kg_evt_bluetooth_connection_status
-                        handle, address, pairing, profile, status, = struct.unpack('<B6sBBB', payload[:10])
+                        handle, address, pairing, profile, status, = kg_evt_bluetooth_connection_status_struct.unpack_from(payload)
                         address = [ord(b) for b in payload[1:7]]
                         return { 'type': 'event', 'name': 'kg_evt_bluetooth_connection_status', 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'handle': ('%d' % (handle)), 'address': ':'.join(['%02X' % b for b in address][::-1]), 'pairing': ('%d' % (pairing)), 'profile': ('%02X' % profile), 'status': ('%02X' % status) }, 'payload_keys': [ 'handle', 'address', 'pairing', 'profile', 'status' ] }
                     elif packet_command == 9: # kg_evt_bluetooth_connection_closed
-                        handle, reason, = struct.unpack('<BH', payload[:3])
+                        handle, reason, = kg_evt_bluetooth_connection_closed_struct.unpack_from(payload)
                         return { 'type': 'event', 'name': 'kg_evt_bluetooth_connection_closed', 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'handle': ('%d' % (handle)), 'reason': ('%04X' % reason) }, 'payload_keys': [ 'handle', 'reason' ] }
                 elif packet_class == 3: # FEEDBACK
                     if packet_command == 1: # kg_evt_feedback_blink_mode
-                        mode, = struct.unpack('<B', payload[:1])
+                        mode, = kg_evt_feedback_blink_mode_struct.unpack_from(payload)
                         return { 'type': 'event', 'name': 'kg_evt_feedback_blink_mode', 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'mode': ('%02X' % mode) }, 'payload_keys': [ 'mode' ] }
                     elif packet_command == 2: # kg_evt_feedback_piezo_mode
-                        index, mode, duration, frequency, = struct.unpack('<BBBH', payload[:5])
+                        index, mode, duration, frequency, = kg_evt_feedback_piezo_mode_struct.unpack_from(payload)
                         return { 'type': 'event', 'name': 'kg_evt_feedback_piezo_mode', 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'index': ('%d' % (index)), 'mode': ('%02X' % mode), 'duration': ('%d' % (duration)), 'frequency': ('%d' % (frequency)) }, 'payload_keys': [ 'index', 'mode', 'duration', 'frequency' ] }
                     elif packet_command == 3: # kg_evt_feedback_vibrate_mode
-                        index, mode, duration, = struct.unpack('<BBB', payload[:3])
+                        index, mode, duration, = kg_evt_feedback_vibrate_mode_struct.unpack_from(payload)
                         return { 'type': 'event', 'name': 'kg_evt_feedback_vibrate_mode', 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'index': ('%d' % (index)), 'mode': ('%02X' % mode), 'duration': ('%d' % (duration)) }, 'payload_keys': [ 'index', 'mode', 'duration' ] }
                     elif packet_command == 4: # kg_evt_feedback_rgb_mode
-                        index, mode_red, mode_green, mode_blue, = struct.unpack('<BBBB', payload[:4])
+                        index, mode_red, mode_green, mode_blue, = kg_evt_feedback_rgb_mode_struct.unpack_from(payload)
                         return { 'type': 'event', 'name': 'kg_evt_feedback_rgb_mode', 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'index': ('%d' % (index)), 'mode_red': ('%02X' % mode_red), 'mode_green': ('%02X' % mode_green), 'mode_blue': ('%02X' % mode_blue) }, 'payload_keys': [ 'index', 'mode_red', 'mode_green', 'mode_blue' ] }
+                    elif packet_command == 5: # kg_evt_feedback_pattern
+                        output, pattern, duration, = kg_evt_feedback_pattern_struct.unpack_from(payload)
+                        return { 'type': 'event', 'name': 'kg_evt_feedback_pattern', 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'output': ('%d' % (output)), 'pattern': ('%d' % (pattern)), 'duration': ('%d' % (duration)) }, 'payload_keys': [ 'output', 'pattern', 'duration' ] }
                 elif packet_class == 4: # TOUCH
                     if packet_command == 1: # kg_evt_touch_mode
-                        mode, = struct.unpack('<B', payload[:1])
+                        mode, = kg_evt_touch_mode_struct.unpack_from(payload)
                         return { 'type': 'event', 'name': 'kg_evt_touch_mode', 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'mode': ('%02X' % mode) }, 'payload_keys': [ 'mode' ] }
                     elif packet_command == 2: # kg_evt_touch_status
-                        status_len, = struct.unpack('<B', payload[:1])
+                        status_len, = kg_evt_touch_status_struct.unpack_from(payload)
                         status_data = [ord(b) for b in payload[1:]]
                         return { 'type': 'event', 'name': 'kg_evt_touch_status', 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'status': ' '.join(['%02X' % b for b in status_data]) }, 'payload_keys': [ 'status' ] }
                 elif packet_class == 5: # MOTION
                     if packet_command == 1: # kg_evt_motion_mode
-                        index, mode, = struct.unpack('<BB', payload[:2])
+                        index, mode, = kg_evt_motion_mode_struct.unpack_from(payload)
                         return { 'type': 'event', 'name': 'kg_evt_motion_mode', 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'index': ('%d' % (index)), 'mode': ('%02X' % mode) }, 'payload_keys': [ 'index', 'mode' ] }
                     elif packet_command == 2: # kg_evt_motion_data
-                        index, flags, data_len, = struct.unpack('<BBB', payload[:3])
+                        index, flags, data_len, = kg_evt_motion_data_struct.unpack_from(payload)
                         data_data = [ord(b) for b in payload[3:]]
                         return { 'type': 'event', 'name': 'kg_evt_motion_data', 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'index': ('%d' % (index)), 'flags': ('%02X' % flags), 'data': ' '.join(['%02X' % b for b in data_data]) }, 'payload_keys': [ 'index', 'flags', 'data' ] }
                     elif packet_command == 3: # kg_evt_motion_state
-                        index, state, = struct.unpack('<BB', payload[:2])
+                        index, state, = kg_evt_motion_state_struct.unpack_from(payload)
                         return { 'type': 'event', 'name': 'kg_evt_motion_state', 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'index': ('%d' % (index)), 'state': ('%02X' % state) }, 'payload_keys': [ 'index', 'state' ] }
+                    elif packet_command == 4: # kg_evt_motion_calibration
+                        index, status, progress, = kg_evt_motion_calibration_struct.unpack_from(payload)
+                        return { 'type': 'event', 'name': 'kg_evt_motion_calibration', 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'index': ('%d' % (index)), 'status': ('%02X' % status), 'progress': ('%d' % (progress)) }, 'payload_keys': [ 'index', 'status', 'progress' ] }
+                    elif packet_command == 5: # kg_evt_motion_gesture
+                        index, gesture, axis, strength, = kg_evt_motion_gesture_struct.unpack_from(payload)
+                        return { 'type': 'event', 'name': 'kg_evt_motion_gesture', 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'index': ('%d' % (index)), 'gesture': ('%02X' % gesture), 'axis': ('%02X' % axis), 'strength': ('%d' % (strength)) }, 'payload_keys': [ 'index', 'gesture', 'axis', 'strength' ] }
+                    elif packet_command == 6: # kg_evt_motion_config
+                        index, rate, accel_range, gyro_range, filter, encoding, stream_rate, = kg_evt_motion_config_struct.unpack_from(payload)
+                        return { 'type': 'event', 'name': 'kg_evt_motion_config', 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'index': ('%d' % (index)), 'rate': ('%d' % (rate)), 'accel_range': ('%d' % (accel_range)), 'gyro_range': ('%d' % (gyro_range)), 'filter': ('%d' % (filter)), 'encoding': ('%02X' % encoding), 'stream_rate': ('%d' % (stream_rate)) }, 'payload_keys': [ 'index', 'rate', 'accel_range', 'gyro_range', 'filter', 'encoding', 'stream_rate' ] }
+                elif packet_class == 6: # FLEX
+                    if packet_command == 1: # kg_evt_flex_value
+                        index, value, = kg_evt_flex_value_struct.unpack_from(payload)
+                        return { 'type': 'event', 'name': 'kg_evt_flex_value', 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'index': ('%d' % (index)), 'value': ('%d' % (value)) }, 'payload_keys': [ 'index', 'value' ] }
+                elif packet_class == 7: # PRESSURE
+                    if packet_command == 1: # kg_evt_pressure_press
+                        index, velocity, peak, = kg_evt_pressure_press_struct.unpack_from(payload)
+                        return { 'type': 'event', 'name': 'kg_evt_pressure_press', 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'index': ('%d' % (index)), 'velocity': ('%d' % (velocity)), 'peak': ('%d' % (peak)) }, 'payload_keys': [ 'index', 'velocity', 'peak' ] }
+                    elif packet_command == 2: # kg_evt_pressure_release
+                        index, = kg_evt_pressure_release_struct.unpack_from(payload)
+                        return { 'type': 'event', 'name': 'kg_evt_pressure_release', 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'index': ('%d' % (index)) }, 'payload_keys': [ 'index' ] }
+                    elif packet_command == 3: # kg_evt_pressure_value
+                        index, value, = kg_evt_pressure_value_struct.unpack_from(payload)
+                        return { 'type': 'event', 'name': 'kg_evt_pressure_value', 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'index': ('%d' % (index)), 'value': ('%d' % (value)) }, 'payload_keys': [ 'index', 'value' ] }
+                    elif packet_command == 4: # kg_evt_pressure_config
+                        press, release, deadband, = kg_evt_pressure_config_struct.unpack_from(payload)
+                        return { 'type': 'event', 'name': 'kg_evt_pressure_config', 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'press': ('%d' % (press)), 'release': ('%d' % (release)), 'deadband': ('%d' % (deadband)) }, 'payload_keys': [ 'press', 'release', 'deadband' ] }
+                elif packet_class == 8: # TOUCHSET
+                    if packet_command == 1: # kg_evt_touchset_macro_status
+                        index, status, = kg_evt_touchset_macro_status_struct.unpack_from(payload)
+                        return { 'type': 'event', 'name': 'kg_evt_touchset_macro_status', 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'index': ('%d' % (index)), 'status': ('%02X' % status) }, 'payload_keys': [ 'index', 'status' ] }
                 elif packet_class == 0xFF: # LOG
                     if packet_command == 0xFF: # kg_log
                         level, = struct.unpack('<B', self.kgapi_rx_payload[:1])
                         message = self.kgapi_rx_payload[1:]
                         return { 'type': 'event', 'name': 'kg_log', 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'level': ('%d' % level), 'message': ''.join(['%c' % b for b in message]) }, 'payload_keys': [ 'level', 'message' ] }
+                    elif packet_command == 0xFE: # kg_log records
+                        messages = []
+                        for i in range(0, len(payload) - kg_log_record_struct.size + 1, kg_log_record_struct.size):
+                            level, message_id, arg, ticks = kg_log_record_struct.unpack_from(payload, i)
+                            messages.append('[%d @%d] %s' % (level, ticks, kg_log_record_text(message_id, arg)))
+                        return { 'type': 'event', 'name': 'kg_log', 'length': payload_length, 'class_id': packet_class, 'event_id': packet_command, 'payload': { 'records': '; '.join(messages) }, 'payload_keys': [ 'records' ] }
 
 # ======== ======== ======== ======== ======== ======== ======== ========
 # ======== ======== ======== ======== ======== ======== ======== ========
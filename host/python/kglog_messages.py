@@ -0,0 +1,15 @@
+# Keyglove log message dictionary
+# Generated by keyglove_logdict.py from support_log_messages.h, do not edit
+
+messages = {
+    0x0001: ('RECORDS_DROPPED', 'Log ring full, %d records dropped'),
+    0x0101: ('SYSTEM_ALLOC_FAILED', 'Memory allocation failed in subsystem %d'),
+    0x0201: ('BT2_IWRAP_TESTING', 'Testing iWRAP communication...'),
+    0x0202: ('BT2_IWRAP_GET_SETTINGS', 'Getting iWRAP settings...'),
+    0x0203: ('BT2_IWRAP_GET_CONNECTIONS', 'Getting active connection list...'),
+    0x0204: ('BT2_IWRAP_READY', 'iWRAP initialization complete'),
+    0x0205: ('BT2_IWRAP_NO_RESPONSE', 'Could not communicate with iWRAP module'),
+    0x0206: ('BT2_CALL_PROCESSED', 'Pending call processed'),
+    0x0207: ('BT2_CALLING', 'Calling device #%d'),
+    0x0501: ('MOTION_MPU6050_HAND_FIFO_OVERFLOW', 'MPU6050 FIFO overflow, %d bytes discarded'),
+}